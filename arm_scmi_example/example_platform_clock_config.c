@@ -7,10 +7,21 @@
 
 #include "myplatform_clock.h"
 #include "myplatform_mmap.h"
+#include "myplatform_reset.h"
 #include "myplatform_scmi.h"
 
 #include <mod_clock.h>
+#include <mod_clock_cap.h>
 #include <mod_scmi_clock.h>
+#include <mod_scmi_channel_priority.h>
+#include <mod_scmi_ring.h>
+#include <mod_scmi_perf.h>
+#include <mod_dvfs_transition.h>
+#include <mod_sw_regulator.h>
+#include <mod_sw_pll.h>
+#include <mod_transport.h>
+#include <mod_virtio_scmi.h>
+#include <mod_smc_fast.h>
 #include <mod_myplatform_clock.h>
 
 #include <fwk_element.h>
@@ -23,10 +34,17 @@
  * 平台時鐘配置資料
  */
 
-/* CPU 時鐘配置 */
+/*
+ * CPU 時鐘配置
+ * CPU0/CPU1 cluster 各有一顆備用 PLL，使用 ping-pong 模式：閒置 PLL 先 lock
+ * 到目標 VCO，再以一次 glitch-free mux 切換，不必在 lock 期間停在 24MHz
+ * REFCLK。CPU2/CPU3 沒有備用 PLL，維持 REFCLK 停靠
+ */
 static const struct myplatform_clock_config cpu_clock_config_table[] = {
     [MYPLATFORM_CLOCK_IDX_CPU0] = {
         .base_address = MYPLATFORM_CPU0_PLL_BASE,
+        .pll_mode = MYPLATFORM_CLOCK_PLL_MODE_PING_PONG,
+        .spare_base_address = MYPLATFORM_CPU0_SPARE_PLL_BASE,
         .pll_config = {
             .ref_freq = 24000000,    /* 24MHz 參考時鐘 */
             .multiplier = 50,        /* 預設倍頻 */
@@ -41,6 +59,8 @@ static const struct myplatform_clock_config cpu_clock_config_table[] = {
     
     [MYPLATFORM_CLOCK_IDX_CPU1] = {
         .base_address = MYPLATFORM_CPU1_PLL_BASE,
+        .pll_mode = MYPLATFORM_CLOCK_PLL_MODE_PING_PONG,
+        .spare_base_address = MYPLATFORM_CPU1_SPARE_PLL_BASE,
         .pll_config = {
             .ref_freq = 24000000,
             .multiplier = 50,
@@ -250,6 +270,11 @@ static struct fwk_element clock_dev_desc_table[] = {
 
 /*
  * Clock 模組配置
+ * 
+ * 收到電源域的 pre-transition / transition 通知時，mod_clock 會呼叫驅動的
+ * process_pending_power_transition / process_power_transition：
+ * 關閉前保存每個時鐘的頻率、分頻與來源，上電時每顆 PLL 以一段暫存器序列
+ * 批次還原；關閉期間 RATE_GET 由驅動直接回傳保存值，不存取硬體
  */
 static const struct fwk_element *clock_get_dev_desc_table(fwk_id_t module_id)
 {
@@ -272,32 +297,250 @@ struct fwk_module_config config_clock = {
  * SCMI Clock 協議配置
  */
 
+/*
+ * PLL 時序 (datasheet 數值)，轉換成本表與 sw_pll 模型共用；
+ * DVFS engine 經 preset API 的 get_timing 向時鐘驅動查詢，不另外設定
+ * relock 需先切到 refclk、等 lock、再切回：2 * mux + lock
+ */
+#define CPU_PLL_LOCK_TIME_NS        200000      /* 200us relock */
+#define CPU_PLL_DIV_SWITCH_NS       100
+#define CPU_PLL_MUX_LATENCY_NS      10000       /* 10us glitch-free mux */
+
+#define GPU_PLL_LOCK_TIME_NS        200000
+#define GPU_PLL_DIV_SWITCH_NS       100
+#define GPU_PLL_MUX_LATENCY_NS      10000
+
+#define DISPLAY_PLL_LOCK_TIME_NS    300000
+#define DISPLAY_PLL_DIV_SWITCH_NS   100
+#define DISPLAY_PLL_MUX_LATENCY_NS  10000
+
+/*
+ * 功耗 (datasheet 數值，uW)
+ * PLL_LOCK：lock 期間 PLL 類比電路與 VCO 的功耗
+ * *_STALL：停在 REFCLK 時時鐘域仍在目前電壓下消耗的漏電，這段時間沒有
+ * 做任何有用的工作；ping-pong 與只換分頻器時時鐘域不停頓，沒有這一項
+ */
+#define PLL_LOCK_POWER_UW           3000
+#define CPU_CLUSTER_STALL_POWER_UW  80000
+#define GPU_STALL_POWER_UW          110000
+#define DISPLAY_STALL_POWER_UW      35000
+
+#define PLL_RELOCK_NS(lock_ns, mux_ns)      ((lock_ns) + 2 * (mux_ns))
+/* ping-pong：閒置 PLL 要重新 lock 時 lock + mux，已在目標 VCO 時只有 mux */
+#define PLL_PING_PONG_NS(lock_ns, mux_ns)   ((lock_ns) + (mux_ns))
+#define PLL_SWAP_NS(mux_ns)                 (mux_ns)
+
+#define PLL_LATENCY_US(ns)  (((ns) + 999) / 1000)
+/* uW * ns = 1e-6 nJ，無條件進位 */
+#define PLL_ENERGY_NJ(power_uw, ns) \
+    ((uint32_t)(((uint64_t)(power_uw) * (ns) + 999999) / 1000000))
+
+/* relock：PLL lock 的功耗加上整段停頓的漏電 */
+#define PLL_RELOCK_ENERGY_NJ(stall_uw, lock_ns, mux_ns) \
+    (PLL_ENERGY_NJ(PLL_LOCK_POWER_UW, (lock_ns)) + \
+     PLL_ENERGY_NJ((stall_uw), PLL_RELOCK_NS((lock_ns), (mux_ns))))
+
+/*
+ * 轉換成本表 (TRANSITION_COST 廠商命令)
+ * 延遲與能量都由上面的時序與功耗推算；Linux 端會再與 SCP 實際量測的
+ * 延遲取大者
+ */
+static const struct mod_scmi_clock_transition_cost cpu_clock_transition_cost = {
+    .relock_latency_us = PLL_LATENCY_US(
+        PLL_RELOCK_NS(CPU_PLL_LOCK_TIME_NS, CPU_PLL_MUX_LATENCY_NS)),
+    .relock_energy_nj = PLL_RELOCK_ENERGY_NJ(CPU_CLUSTER_STALL_POWER_UW,
+                                             CPU_PLL_LOCK_TIME_NS,
+                                             CPU_PLL_MUX_LATENCY_NS),
+    .div_latency_us = PLL_LATENCY_US(CPU_PLL_DIV_SWITCH_NS),
+    .div_energy_nj = PLL_ENERGY_NJ(PLL_LOCK_POWER_UW, CPU_PLL_DIV_SWITCH_NS),
+};
+
+/*
+ * CPU0/CPU1 (ping-pong)：CPU 不停頓，只付備用 PLL lock 的功耗；
+ * 切回閒置 PLL 仍 lock 著的 VCO 時只需 mux 切換 (swap)，閒置 PLL
+ * 一直保持 lock，這部分功耗不隨轉換發生
+ */
+static const struct mod_scmi_clock_transition_cost cpu_ping_pong_transition_cost = {
+    .relock_latency_us = PLL_LATENCY_US(
+        PLL_PING_PONG_NS(CPU_PLL_LOCK_TIME_NS, CPU_PLL_MUX_LATENCY_NS)),
+    .relock_energy_nj = PLL_ENERGY_NJ(PLL_LOCK_POWER_UW,
+        PLL_PING_PONG_NS(CPU_PLL_LOCK_TIME_NS, CPU_PLL_MUX_LATENCY_NS)),
+    .swap_latency_us = PLL_LATENCY_US(PLL_SWAP_NS(CPU_PLL_MUX_LATENCY_NS)),
+    .swap_energy_nj = 0,
+    .div_latency_us = PLL_LATENCY_US(CPU_PLL_DIV_SWITCH_NS),
+    .div_energy_nj = PLL_ENERGY_NJ(PLL_LOCK_POWER_UW, CPU_PLL_DIV_SWITCH_NS),
+};
+
+static const struct mod_scmi_clock_transition_cost gpu_clock_transition_cost = {
+    .relock_latency_us = PLL_LATENCY_US(
+        PLL_RELOCK_NS(GPU_PLL_LOCK_TIME_NS, GPU_PLL_MUX_LATENCY_NS)),
+    .relock_energy_nj = PLL_RELOCK_ENERGY_NJ(GPU_STALL_POWER_UW,
+                                             GPU_PLL_LOCK_TIME_NS,
+                                             GPU_PLL_MUX_LATENCY_NS),
+    .div_latency_us = PLL_LATENCY_US(GPU_PLL_DIV_SWITCH_NS),
+    .div_energy_nj = PLL_ENERGY_NJ(PLL_LOCK_POWER_UW, GPU_PLL_DIV_SWITCH_NS),
+};
+
+/* 像素時鐘變更通常伴隨 modeset，relock 延遲不影響畫面 */
+static const struct mod_scmi_clock_transition_cost display_clock_transition_cost = {
+    .relock_latency_us = PLL_LATENCY_US(
+        PLL_RELOCK_NS(DISPLAY_PLL_LOCK_TIME_NS, DISPLAY_PLL_MUX_LATENCY_NS)),
+    .relock_energy_nj = PLL_RELOCK_ENERGY_NJ(DISPLAY_STALL_POWER_UW,
+                                             DISPLAY_PLL_LOCK_TIME_NS,
+                                             DISPLAY_PLL_MUX_LATENCY_NS),
+    .div_latency_us = PLL_LATENCY_US(DISPLAY_PLL_DIV_SWITCH_NS),
+    .div_energy_nj = PLL_ENERGY_NJ(PLL_LOCK_POWER_UW,
+                                   DISPLAY_PLL_DIV_SWITCH_NS),
+};
+
+/*
+ * SCP 本地頻率限制配置 (scp_clock_cap.c)
+ * 
+ * 溫度感測器與功率監控的 alarm callback 直接呼叫 mod_clock_cap_api，
+ * 不等 Linux thermal；溫度單位 m°C，功率表與 cpu_opp_table 的功耗一致。
+ * CPU 時鐘由 SCMI PERF 管理，上限交給對應的 PERF domain 套用
+ */
+enum myplatform_clock_cap_idx {
+    MYPLATFORM_CLOCK_CAP_IDX_CPU0,
+    MYPLATFORM_CLOCK_CAP_IDX_CPU1,
+    MYPLATFORM_CLOCK_CAP_IDX_CPU2,
+    MYPLATFORM_CLOCK_CAP_IDX_CPU3,
+    MYPLATFORM_CLOCK_CAP_IDX_GPU_CORE,
+    MYPLATFORM_CLOCK_CAP_IDX_COUNT,
+};
+
+static const struct mod_clock_cap_thermal_step cpu_thermal_steps[] = {
+    { .temperature = 85000, .max_rate = 1500UL * FWK_MHZ },
+    { .temperature = 95000, .max_rate = 1000UL * FWK_MHZ },
+    { .temperature = 105000, .max_rate = 600UL * FWK_MHZ },
+};
+
+static const struct mod_clock_cap_power_point cpu_power_table[] = {
+    { .rate =  600UL * FWK_MHZ, .power = 120 },
+    { .rate = 1000UL * FWK_MHZ, .power = 230 },
+    { .rate = 1200UL * FWK_MHZ, .power = 310 },
+    { .rate = 1500UL * FWK_MHZ, .power = 440 },
+    { .rate = 1800UL * FWK_MHZ, .power = 600 },
+    { .rate = 2000UL * FWK_MHZ, .power = 740 },
+};
+
+/* GPU 面積大、熱時間常數長，門檻較低但降得較多 */
+static const struct mod_clock_cap_thermal_step gpu_thermal_steps[] = {
+    { .temperature = 85000, .max_rate = 600UL * FWK_MHZ },
+    { .temperature = 95000, .max_rate = 400UL * FWK_MHZ },
+};
+
+static const struct mod_clock_cap_power_point gpu_power_table[] = {
+    { .rate =  200UL * FWK_MHZ, .power = 350 },
+    { .rate =  400UL * FWK_MHZ, .power = 700 },
+    { .rate =  600UL * FWK_MHZ, .power = 1100 },
+    { .rate =  800UL * FWK_MHZ, .power = 1600 },
+    { .rate = 1000UL * FWK_MHZ, .power = 2200 },
+    { .rate = 1200UL * FWK_MHZ, .power = 2900 },
+};
+
+#define CLOCK_CAP_CPU_DOMAIN(idx) \
+    [MYPLATFORM_CLOCK_CAP_IDX_CPU##idx] = { \
+        .name = "CPU" #idx "-CAP", \
+        .data = &((struct mod_clock_cap_domain_config) { \
+            .clock_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_CLOCK, \
+                MYPLATFORM_CLOCK_IDX_CPU##idx), \
+            .perf_domain_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SCMI_PERF, \
+                idx), \
+            .thermal_steps = cpu_thermal_steps, \
+            .thermal_step_count = FWK_ARRAY_SIZE(cpu_thermal_steps), \
+            .thermal_hysteresis = 5000, \
+            .power_table = cpu_power_table, \
+            .power_point_count = FWK_ARRAY_SIZE(cpu_power_table), \
+        }), \
+    }
+
+static const struct fwk_element clock_cap_element_table[] = {
+    CLOCK_CAP_CPU_DOMAIN(0),
+    CLOCK_CAP_CPU_DOMAIN(1),
+    CLOCK_CAP_CPU_DOMAIN(2),
+    CLOCK_CAP_CPU_DOMAIN(3),
+    [MYPLATFORM_CLOCK_CAP_IDX_GPU_CORE] = {
+        .name = "GPU-CAP",
+        .data = &((struct mod_clock_cap_domain_config) {
+            .clock_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_CLOCK,
+                MYPLATFORM_CLOCK_IDX_GPU_CORE),
+            .thermal_steps = gpu_thermal_steps,
+            .thermal_step_count = FWK_ARRAY_SIZE(gpu_thermal_steps),
+            .thermal_hysteresis = 5000,
+            .power_table = gpu_power_table,
+            .power_point_count = FWK_ARRAY_SIZE(gpu_power_table),
+        }),
+    },
+    
+    /* 結束標記 */
+    [MYPLATFORM_CLOCK_CAP_IDX_COUNT] = { 0 },
+};
+
+static const struct fwk_element *clock_cap_get_element_table(
+    fwk_id_t module_id)
+{
+    return clock_cap_element_table;
+}
+
+struct fwk_module_config config_clock_cap = {
+    .data = &((struct mod_clock_cap_config) {
+        .retry_alarm_id = FWK_ID_SUB_ELEMENT_INIT(FWK_MODULE_IDX_TIMER, 0,
+            MYPLATFORM_TIMER_ALARM_IDX_CLOCK_CAP),
+    }),
+    .elements = FWK_MODULE_DYNAMIC_ELEMENTS(clock_cap_get_element_table),
+};
+
 /* OSPM 代理可存取的時鐘 */
 static const struct mod_scmi_clock_device agent_device_table_ospm[] = {
-    /* CPU 時鐘 - 允許 Linux CPUFreq 控制 */
+    /*
+     * CPU 時鐘 - Linux CPUFreq 經 SCMI PERF 調頻 (config_scmi_perf)，
+     * CLOCK 協議只提供讀取，RATE_SET 回 SCMI_DENIED。
+     * 不設 initial_rate：開機頻率由 PERF 的 initial_level 經 DVFS 套用
+     */
     {
         .element_id = FWK_ID_ELEMENT_INIT(
             FWK_MODULE_IDX_CLOCK, 
             MYPLATFORM_CLOCK_IDX_CPU0),
+        .cap_domain_id = FWK_ID_ELEMENT_INIT(
+            FWK_MODULE_IDX_CLOCK_CAP,
+            MYPLATFORM_CLOCK_CAP_IDX_CPU0),
         .starts_enabled = true,
+        .perf_owned = true,
+        .transition_cost = &cpu_ping_pong_transition_cost,
     },
     {
         .element_id = FWK_ID_ELEMENT_INIT(
             FWK_MODULE_IDX_CLOCK, 
             MYPLATFORM_CLOCK_IDX_CPU1),
+        .cap_domain_id = FWK_ID_ELEMENT_INIT(
+            FWK_MODULE_IDX_CLOCK_CAP,
+            MYPLATFORM_CLOCK_CAP_IDX_CPU1),
         .starts_enabled = true,
+        .perf_owned = true,
+        .transition_cost = &cpu_ping_pong_transition_cost,
     },
     {
         .element_id = FWK_ID_ELEMENT_INIT(
             FWK_MODULE_IDX_CLOCK, 
             MYPLATFORM_CLOCK_IDX_CPU2),
+        .cap_domain_id = FWK_ID_ELEMENT_INIT(
+            FWK_MODULE_IDX_CLOCK_CAP,
+            MYPLATFORM_CLOCK_CAP_IDX_CPU2),
         .starts_enabled = true,
+        .perf_owned = true,
+        .transition_cost = &cpu_clock_transition_cost,
     },
     {
         .element_id = FWK_ID_ELEMENT_INIT(
             FWK_MODULE_IDX_CLOCK, 
             MYPLATFORM_CLOCK_IDX_CPU3),
+        .cap_domain_id = FWK_ID_ELEMENT_INIT(
+            FWK_MODULE_IDX_CLOCK_CAP,
+            MYPLATFORM_CLOCK_CAP_IDX_CPU3),
         .starts_enabled = true,
+        .perf_owned = true,
+        .transition_cost = &cpu_clock_transition_cost,
     },
     
     /* GPU 時鐘 - 允許 Linux GPU driver 控制 */
@@ -305,7 +548,12 @@ static const struct mod_scmi_clock_device agent_device_table_ospm[] = {
         .element_id = FWK_ID_ELEMENT_INIT(
             FWK_MODULE_IDX_CLOCK, 
             MYPLATFORM_CLOCK_IDX_GPU_CORE),
+        .cap_domain_id = FWK_ID_ELEMENT_INIT(
+            FWK_MODULE_IDX_CLOCK_CAP,
+            MYPLATFORM_CLOCK_CAP_IDX_GPU_CORE),
         .starts_enabled = true,
+        .initial_rate = 800UL * FWK_MHZ,
+        .transition_cost = &gpu_clock_transition_cost,
     },
     
     /* 顯示時鐘 - 允許 Linux Display driver 控制 */
@@ -314,6 +562,8 @@ static const struct mod_scmi_clock_device agent_device_table_ospm[] = {
             FWK_MODULE_IDX_CLOCK, 
             MYPLATFORM_CLOCK_IDX_DISPLAY_PIXEL),
         .starts_enabled = false,  /* 預設關閉，由 driver 控制 */
+        .initial_rate = 148UL * FWK_MHZ,  /* 1080p 像素時鐘，開啟前先 lock */
+        .transition_cost = &display_clock_transition_cost,
     },
     
     /* 注意：系統時鐘和周邊時鐘通常不暴露給 Linux，
@@ -343,6 +593,25 @@ static const struct mod_scmi_clock_device agent_device_table_trusted[] = {
     },
 };
 
+/*
+ * 代理流量限制設定 (超過時回 SCMI_BUSY)
+ * - rate_per_ms: token bucket 補充速率 (每 ms 允許的請求數)
+ * - burst:       token bucket 容量，允許的瞬間突發量
+ * 服務順序由 scmi_channel_priority 依通道的優先權與額度決定
+ */
+
+/* OSPM：cpufreq 會密集調頻，給較高速率與突發量 */
+static const struct mod_scmi_clock_sched_config agent_sched_ospm = {
+    .rate_per_ms = 20,
+    .burst = 32,
+};
+
+/* 受信任代理：只管理系統時鐘，請求量小，限制較嚴 */
+static const struct mod_scmi_clock_sched_config agent_sched_trusted = {
+    .rate_per_ms = 5,
+    .burst = 8,
+};
+
 /* SCMI 代理表 */
 static const struct mod_scmi_clock_agent 
     agent_table[MYPLATFORM_SCMI_AGENT_IDX_COUNT] = {
@@ -357,21 +626,61 @@ static const struct mod_scmi_clock_agent
     [MYPLATFORM_SCMI_AGENT_IDX_OSPM] = {
         .device_table = agent_device_table_ospm,
         .device_count = FWK_ARRAY_SIZE(agent_device_table_ospm),
+        .sched = &agent_sched_ospm,
+        /* BRINGUP_SCRIPT 的延遲步驟 */
+        .script_alarm_id = FWK_ID_SUB_ELEMENT_INIT(
+            FWK_MODULE_IDX_TIMER, 0,
+            MYPLATFORM_TIMER_ALARM_IDX_SCMI_CLOCK_SCRIPT_OSPM),
     },
     
     /* 受信任代理 (可選) */
     [MYPLATFORM_SCMI_AGENT_IDX_TRUSTED] = {
         .device_table = agent_device_table_trusted,
         .device_count = FWK_ARRAY_SIZE(agent_device_table_trusted),
+        .sched = &agent_sched_trusted,
+        .script_alarm_id = FWK_ID_SUB_ELEMENT_INIT(
+            FWK_MODULE_IDX_TIMER, 0,
+            MYPLATFORM_TIMER_ALARM_IDX_SCMI_CLOCK_SCRIPT_TRUSTED),
     },
 };
 
+/*
+ * BRINGUP_SCRIPT 可操作的 reset domain
+ * 陣列索引即 SCMI reset domain ID，與 Reset 協議使用的 ID 一致
+ */
+static const fwk_id_t scmi_clock_reset_domain_table[] = {
+    FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_RESET_DOMAIN,
+                        MYPLATFORM_RESET_DOMAIN_IDX_GPU_CORE),
+    FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_RESET_DOMAIN,
+                        MYPLATFORM_RESET_DOMAIN_IDX_GPU_AXI),
+    FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_RESET_DOMAIN,
+                        MYPLATFORM_RESET_DOMAIN_IDX_DISPLAY),
+    FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_RESET_DOMAIN,
+                        MYPLATFORM_RESET_DOMAIN_IDX_UART0),
+    FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_RESET_DOMAIN,
+                        MYPLATFORM_RESET_DOMAIN_IDX_I2C0),
+    FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_RESET_DOMAIN,
+                        MYPLATFORM_RESET_DOMAIN_IDX_SPI0),
+};
+
 /* SCMI Clock 模組配置 */
 struct fwk_module_config config_scmi_clock = {
     .data = &((struct mod_scmi_clock_config) {
         .max_pending_transactions = 0,  /* 使用預設值 */
+        /* SCMI clock ID 即此表的索引 */
+        .clock_devices = agent_device_table_ospm,
+        .clock_count = FWK_ARRAY_SIZE(agent_device_table_ospm),
         .agent_table = agent_table,
         .agent_count = FWK_ARRAY_SIZE(agent_table),
+        .reset_domain_table = scmi_clock_reset_domain_table,
+        .reset_domain_count = FWK_ARRAY_SIZE(scmi_clock_reset_domain_table),
+        /* 共用 PLL 忙碌時，開機頻率以此 alarm 定時重試 */
+        .boot_rate_alarm_id = FWK_ID_SUB_ELEMENT_INIT(
+            FWK_MODULE_IDX_TIMER, 0,
+            MYPLATFORM_TIMER_ALARM_IDX_SCMI_CLOCK),
+        /* 流量限制回 SCMI_BUSY 時向通道排程歸還額度 */
+        .channel_priority_id = FWK_ID_MODULE_INIT(
+            FWK_MODULE_IDX_SCMI_CHANNEL_PRIORITY),
     }),
 };
 
@@ -424,6 +733,528 @@ struct fwk_module_config config_myplatform_clock = {
     .elements = FWK_MODULE_DYNAMIC_ELEMENTS(myplatform_clock_get_element_table),
 };
 
+/*
+ * SCMI 通道優先權配置
+ * OSPM 代理有兩個 A2P 通道：PERF 協議 (CPU DVFS) 專用的高優先權通道，
+ * 以及其他協議共用的一般通道 (ring，見下方 scmi_ring)。
+ * 各傳輸通道的 doorbell 先送到這裡，見 config_transport 的 signal_id
+ * - priority: 優先權等級，等級之間依 band_weight 分配服務次數
+ * - weight:   同一等級的通道之間每輪可服務的訊息數
+ */
+static const struct fwk_element scmi_channel_priority_element_table[] = {
+    [MYPLATFORM_SCMI_SERVICE_IDX_PSCI] = {
+        .name = "PSCI",
+        .data = &((struct scmi_channel_priority_config) {
+            .service_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SCMI,
+                                              MYPLATFORM_SCMI_SERVICE_IDX_PSCI),
+            .agent_id = MYPLATFORM_SCMI_AGENT_IDX_PSCI,
+            .priority = SCMI_CHANNEL_PRIORITY_HIGH,
+            .weight = 1,
+        }),
+    },
+
+    [MYPLATFORM_SCMI_SERVICE_IDX_OSPM_DVFS] = {
+        .name = "OSPM-DVFS",
+        .data = &((struct scmi_channel_priority_config) {
+            .service_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SCMI,
+                                              MYPLATFORM_SCMI_SERVICE_IDX_OSPM_DVFS),
+            .agent_id = MYPLATFORM_SCMI_AGENT_IDX_OSPM,
+            .priority = SCMI_CHANNEL_PRIORITY_HIGH,
+            /* 4 顆 CPU 的 DVFS 共用這個通道 */
+            .weight = 4,
+        }),
+    },
+
+    [MYPLATFORM_SCMI_SERVICE_IDX_OSPM] = {
+        .name = "OSPM",
+        .data = &((struct scmi_channel_priority_config) {
+            .service_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SCMI,
+                                              MYPLATFORM_SCMI_SERVICE_IDX_OSPM),
+            .agent_id = MYPLATFORM_SCMI_AGENT_IDX_OSPM,
+            .priority = SCMI_CHANNEL_PRIORITY_NORMAL,
+            .weight = 1,
+        }),
+    },
+
+    [MYPLATFORM_SCMI_SERVICE_IDX_TRUSTED] = {
+        .name = "TRUSTED",
+        .data = &((struct scmi_channel_priority_config) {
+            .service_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SCMI,
+                                              MYPLATFORM_SCMI_SERVICE_IDX_TRUSTED),
+            .agent_id = MYPLATFORM_SCMI_AGENT_IDX_TRUSTED,
+            .priority = SCMI_CHANNEL_PRIORITY_LOW,
+            .weight = 1,
+        }),
+    },
+
+    /* 結束標記 */
+    [MYPLATFORM_SCMI_SERVICE_IDX_COUNT] = { 0 },
+};
+
+static const struct fwk_element *scmi_channel_priority_get_element_table(
+    fwk_id_t module_id)
+{
+    return scmi_channel_priority_element_table;
+}
+
+struct fwk_module_config config_scmi_channel_priority = {
+    .elements = FWK_MODULE_DYNAMIC_ELEMENTS(
+        scmi_channel_priority_get_element_table),
+    /*
+     * 通道都持續有訊息時 HIGH:NORMAL:LOW = 8:4:1，
+     * 灌訊息的 OSPM 通道無法讓 TRUSTED 等不到服務
+     */
+    .data = &((struct scmi_channel_priority_module_config) {
+        .band_weight = {
+            [SCMI_CHANNEL_PRIORITY_HIGH] = 8,
+            [SCMI_CHANNEL_PRIORITY_NORMAL] = 4,
+            [SCMI_CHANNEL_PRIORITY_LOW] = 1,
+        },
+    }),
+};
+
+/*
+ * SMT 傳輸通道配置
+ *
+ * 上游 mod_transport 收到 doorbell 後直接呼叫 mod_scmi 的 signal_message；
+ * 這裡與 scp_scmi_ring_channel.c 一樣，把上層 signal 的目標做成可設定
+ * (signal_id / signal_api_id，未設定時照舊綁 mod_scmi)，改送到
+ * 通道優先權模組排序。mod_scmi 的 service 仍以 transport_id 指向這些
+ * element，回應與 get_payload 等直接走 mod_transport。
+ */
+#define SCMI_TRANSPORT_CHANNEL(idx, mhu_idx, mailbox, service_idx) \
+    [idx] = { \
+        .name = #service_idx, \
+        .data = &((struct mod_transport_channel_config) { \
+            .transport_type = MOD_TRANSPORT_CHANNEL_TRANSPORT_TYPE_OUT_BAND, \
+            .channel_type = MOD_TRANSPORT_CHANNEL_TYPE_COMPLETER, \
+            .policies = MOD_TRANSPORT_POLICY_INIT_MAILBOX, \
+            .out_band_mailbox_address = (uintptr_t)(mailbox), \
+            .out_band_mailbox_size = MYPLATFORM_SCMI_PAYLOAD_SIZE, \
+            .driver_id = FWK_ID_SUB_ELEMENT_INIT(FWK_MODULE_IDX_MHU2, \
+                                                 mhu_idx, 0), \
+            .driver_api_id = FWK_ID_API_INIT(FWK_MODULE_IDX_MHU2, 0), \
+            .signal_id = FWK_ID_ELEMENT_INIT( \
+                FWK_MODULE_IDX_SCMI_CHANNEL_PRIORITY, service_idx), \
+            .signal_api_id = FWK_ID_API_INIT( \
+                FWK_MODULE_IDX_SCMI_CHANNEL_PRIORITY, \
+                MOD_SCMI_CHANNEL_PRIORITY_API_IDX_SIGNAL), \
+        }), \
+    }
+
+static const struct fwk_element transport_element_table[] = {
+    SCMI_TRANSPORT_CHANNEL(MYPLATFORM_TRANSPORT_IDX_PSCI,
+                           MYPLATFORM_MHU_DEVICE_IDX_PSCI,
+                           MYPLATFORM_SCMI_PAYLOAD_PSCI_A2P_BASE,
+                           MYPLATFORM_SCMI_SERVICE_IDX_PSCI),
+    /* AP DT 中 protocol@13 的 mboxes/shmem */
+    SCMI_TRANSPORT_CHANNEL(MYPLATFORM_TRANSPORT_IDX_OSPM_DVFS,
+                           MYPLATFORM_MHU_DEVICE_IDX_OSPM_DVFS,
+                           MYPLATFORM_SCMI_PAYLOAD_OSPM_DVFS_A2P_BASE,
+                           MYPLATFORM_SCMI_SERVICE_IDX_OSPM_DVFS),
+    SCMI_TRANSPORT_CHANNEL(MYPLATFORM_TRANSPORT_IDX_TRUSTED,
+                           MYPLATFORM_MHU_DEVICE_IDX_TRUSTED,
+                           MYPLATFORM_SCMI_PAYLOAD_TRUSTED_A2P_BASE,
+                           MYPLATFORM_SCMI_SERVICE_IDX_TRUSTED),
+
+    /* 結束標記 */
+    [MYPLATFORM_TRANSPORT_IDX_COUNT] = { 0 },
+};
+
+static const struct fwk_element *transport_get_element_table(
+    fwk_id_t module_id)
+{
+    return transport_element_table;
+}
+
+struct fwk_module_config config_transport = {
+    .elements = FWK_MODULE_DYNAMIC_ELEMENTS(transport_get_element_table),
+};
+
+/*
+ * SCMI ring 通道配置 (scp_scmi_ring_channel.c)
+ * OSPM 一般通道改用多 slot ring，讓多顆 CPU 的請求一次 doorbell 送達；
+ * AP 端 DT 的 shmem 節點需對應改為 "arm,scmi-shmem-ring"
+ */
+#define SCMI_RING_SLOT_SIZE 144     /* 8-byte slot 標頭 + 136-byte payload */
+
+static const struct fwk_element scmi_ring_element_table[] = {
+    [0] = {
+        .name = "OSPM-RING",
+        .data = &((struct mod_scmi_ring_channel_config) {
+            .base = MYPLATFORM_SCMI_RING_BASE,
+            .size = MYPLATFORM_SCMI_RING_SIZE,
+            .slot_size = SCMI_RING_SLOT_SIZE,
+            .driver_id = FWK_ID_SUB_ELEMENT_INIT(FWK_MODULE_IDX_MHU2,
+                                                 MYPLATFORM_MHU_DEVICE_IDX_OSPM,
+                                                 0),
+            .driver_api_id = FWK_ID_API_INIT(FWK_MODULE_IDX_MHU2, 0),
+            /* 經通道優先權模組排序，CPU DVFS 通道仍可插隊 */
+            .signal_id = FWK_ID_ELEMENT_INIT(
+                FWK_MODULE_IDX_SCMI_CHANNEL_PRIORITY,
+                MYPLATFORM_SCMI_SERVICE_IDX_OSPM),
+            .signal_api_id = FWK_ID_API_INIT(
+                FWK_MODULE_IDX_SCMI_CHANNEL_PRIORITY,
+                MOD_SCMI_CHANNEL_PRIORITY_API_IDX_SIGNAL),
+        }),
+    },
+
+    [1] = { 0 },
+};
+
+static const struct fwk_element *scmi_ring_get_element_table(fwk_id_t module_id)
+{
+    return scmi_ring_element_table;
+}
+
+struct fwk_module_config config_scmi_ring = {
+    .elements = FWK_MODULE_DYNAMIC_ELEMENTS(scmi_ring_get_element_table),
+};
+
+/*
+ * DVFS transition engine 配置 (scp_dvfs_transition.c)
+ * 
+ * CPU0/1 與 CPU2/3 各共用一條 rail；PLL 時序由時鐘驅動的 get_timing 提供，
+ * 等待以計時器 alarm 進行
+ */
+enum myplatform_cpu_rail_idx {
+    MYPLATFORM_CPU_RAIL_IDX_CLUSTER0,
+    MYPLATFORM_CPU_RAIL_IDX_CLUSTER1,
+    MYPLATFORM_CPU_RAIL_IDX_COUNT,
+};
+
+#define DVFS_CPU_DOMAIN(idx, rail) \
+    [idx] = { \
+        .name = "CPU" #idx "-DVFS", \
+        .data = &((struct mod_dvfs_transition_domain_config) { \
+            .clock_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_MYPLATFORM_CLOCK, \
+                MYPLATFORM_CLOCK_IDX_CPU##idx), \
+            .clock_config = &cpu_clock_config_table[ \
+                MYPLATFORM_CLOCK_IDX_CPU##idx], \
+            .regulator_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SW_REGULATOR, \
+                rail), \
+            .initial_voltage = 800,      /* 開機 1.2GHz */ \
+        }), \
+    }
+
+static const struct fwk_element dvfs_transition_element_table[] = {
+    DVFS_CPU_DOMAIN(0, MYPLATFORM_CPU_RAIL_IDX_CLUSTER0),
+    DVFS_CPU_DOMAIN(1, MYPLATFORM_CPU_RAIL_IDX_CLUSTER0),
+    DVFS_CPU_DOMAIN(2, MYPLATFORM_CPU_RAIL_IDX_CLUSTER1),
+    DVFS_CPU_DOMAIN(3, MYPLATFORM_CPU_RAIL_IDX_CLUSTER1),
+    
+    /* 結束標記 */
+    [4] = { 0 },
+};
+
+static const struct fwk_element *dvfs_transition_get_element_table(
+    fwk_id_t module_id)
+{
+    return dvfs_transition_element_table;
+}
+
+struct fwk_module_config config_dvfs_transition = {
+    .data = &((struct mod_dvfs_transition_config) {
+        /* host 模擬時改為 FWK_MODULE_IDX_SW_PLL / MOD_SW_PLL_API_IDX_PRESET */
+        .clock_preset_api_id = FWK_ID_API_INIT(
+            FWK_MODULE_IDX_MYPLATFORM_CLOCK,
+            MOD_MYPLATFORM_CLOCK_API_IDX_PRESET),
+        .regulator_api_id = FWK_ID_API_INIT(FWK_MODULE_IDX_SW_REGULATOR, 0),
+        .alarm_id = FWK_ID_SUB_ELEMENT_INIT(FWK_MODULE_IDX_TIMER, 0,
+            MYPLATFORM_TIMER_ALARM_IDX_DVFS),
+        /* PLL lock、mux 等不到 1ms 的等待以 us 精度就地等待 */
+        .timer_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_TIMER, 0),
+    }),
+    .elements = FWK_MODULE_DYNAMIC_ELEMENTS(dvfs_transition_get_element_table),
+};
+
+/*
+ * CPU rail 配置 (scp_sw_regulator_model.c)
+ * 真實平台上換成 PMIC 驅動的元素，數值取自 PMIC datasheet
+ */
+static const struct sw_regulator_config cpu_rail_config = {
+    .initial_voltage = 800,
+    .min_voltage = 600,
+    .max_voltage = 1000,
+    .slew_rate = 10,             /* 10mV/us */
+    .settle_time_ns = 5000,
+};
+
+static const struct fwk_element sw_regulator_element_table[] = {
+    [MYPLATFORM_CPU_RAIL_IDX_CLUSTER0] = {
+        .name = "VDD_CPU_CLUSTER0",
+        .data = &cpu_rail_config,
+    },
+    [MYPLATFORM_CPU_RAIL_IDX_CLUSTER1] = {
+        .name = "VDD_CPU_CLUSTER1",
+        .data = &cpu_rail_config,
+    },
+    
+    /* 結束標記 */
+    [MYPLATFORM_CPU_RAIL_IDX_COUNT] = { 0 },
+};
+
+static const struct fwk_element *sw_regulator_get_element_table(
+    fwk_id_t module_id)
+{
+    return sw_regulator_element_table;
+}
+
+struct fwk_module_config config_sw_regulator = {
+    .elements = FWK_MODULE_DYNAMIC_ELEMENTS(sw_regulator_get_element_table),
+};
+
+/*
+ * SCMI Perf 協議配置 (scp_scmi_perf_handler.c)
+ * 
+ * 每顆 CPU 一個 performance domain，Linux cpufreq 以 level 索引調頻；
+ * 頻率都選 24MHz 參考時鐘可整數合成的值，init 時預先算好 PLL 設定
+ */
+static const struct mod_scmi_perf_opp cpu_opp_table[] = {
+    { .frequency =  600UL * FWK_MHZ, .voltage = 700, .power = 120 },
+    { .frequency = 1000UL * FWK_MHZ, .voltage = 750, .power = 230 },
+    { .frequency = 1200UL * FWK_MHZ, .voltage = 800, .power = 310 },
+    { .frequency = 1500UL * FWK_MHZ, .voltage = 850, .power = 440 },
+    { .frequency = 1800UL * FWK_MHZ, .voltage = 900, .power = 600 },
+    { .frequency = 2000UL * FWK_MHZ, .voltage = 950, .power = 740 },
+};
+
+/* fast channel 位於 SCP 與 AP 共享的 SRAM，每個 domain 8 bytes */
+#define SCMI_PERF_FAST_CHANNEL_ADDRESS(domain) \
+    (MYPLATFORM_SCMI_FAST_CHANNEL_BASE + \
+     (domain) * sizeof(struct mod_scmi_perf_fast_channel))
+
+#define SCMI_PERF_CPU_DOMAIN(idx) \
+    [idx] = { \
+        .name = "CPU" #idx, \
+        .data = &((struct mod_scmi_perf_domain_config) { \
+            .clock_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_MYPLATFORM_CLOCK, \
+                MYPLATFORM_CLOCK_IDX_CPU##idx), \
+            .clock_config = &cpu_clock_config_table[ \
+                MYPLATFORM_CLOCK_IDX_CPU##idx], \
+            .opps = cpu_opp_table, \
+            .opp_count = FWK_ARRAY_SIZE(cpu_opp_table), \
+            .initial_level = 3,          /* 1.5GHz，CPU 時鐘的開機頻率 */ \
+            .transition_latency_us = 250, \
+            .fast_channel_address = SCMI_PERF_FAST_CHANNEL_ADDRESS(idx), \
+            .dvfs_domain_id = FWK_ID_ELEMENT_INIT( \
+                FWK_MODULE_IDX_DVFS_TRANSITION, idx), \
+            .clock_element_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_CLOCK, \
+                MYPLATFORM_CLOCK_IDX_CPU##idx), \
+        }), \
+    }
+
+static const struct fwk_element scmi_perf_element_table[] = {
+    SCMI_PERF_CPU_DOMAIN(0),
+    SCMI_PERF_CPU_DOMAIN(1),
+    SCMI_PERF_CPU_DOMAIN(2),
+    SCMI_PERF_CPU_DOMAIN(3),
+    
+    /* 結束標記 */
+    [4] = { 0 },
+};
+
+static const struct fwk_element *scmi_perf_get_element_table(
+    fwk_id_t module_id)
+{
+    return scmi_perf_element_table;
+}
+
+struct fwk_module_config config_scmi_perf = {
+    .data = &((struct mod_scmi_perf_config) {
+        /* host 模擬時改為 FWK_MODULE_IDX_SW_PLL / MOD_SW_PLL_API_IDX_PRESET */
+        .clock_preset_api_id = FWK_ID_API_INIT(
+            FWK_MODULE_IDX_MYPLATFORM_CLOCK,
+            MOD_MYPLATFORM_CLOCK_API_IDX_PRESET),
+        .dvfs_transition_api_id = FWK_ID_API_INIT(
+            FWK_MODULE_IDX_DVFS_TRANSITION, 0),
+        .fast_channel_alarm_id = FWK_ID_SUB_ELEMENT_INIT(
+            FWK_MODULE_IDX_TIMER, 0,
+            MYPLATFORM_TIMER_ALARM_IDX_PERF_FAST_CHANNEL),
+        .scmi_clock_notify_api_id = FWK_ID_API_INIT(
+            FWK_MODULE_IDX_SCMI_CLOCK, MOD_SCMI_CLOCK_API_IDX_NOTIFY),
+        .fast_channel_rate_limit_us = 1000,
+    }),
+    .elements = FWK_MODULE_DYNAMIC_ELEMENTS(scmi_perf_get_element_table),
+};
+
+/*
+ * Host 模擬配置 (scmi_virtio_backend.c)
+ * 
+ * 以 mod_sw_pll 取代 mod_myplatform_clock，元素直接使用 clock_dev_desc_table，
+ * 與 mod_clock 的元素一一對應；base_address 相同的元素共用同一顆 PLL。
+ * mod_virtio_scmi 的每個元素是一個 in-flight slot，各自綁定一個
+ * mod_scmi service，最後一個元素用於 P2A 通知
+ */
+
+/* 各 PLL 的時序參數 (模型用的估計值，非量測結果) */
+static const struct sw_pll_timing_config sw_pll_timing_table[] = {
+    {
+        .base_address = MYPLATFORM_CPU0_PLL_BASE,
+        .lock_time_ns = CPU_PLL_LOCK_TIME_NS,
+        .div_switch_ns = CPU_PLL_DIV_SWITCH_NS,
+        .mux_latency_ns = CPU_PLL_MUX_LATENCY_NS,
+    },
+    {
+        .base_address = MYPLATFORM_CPU1_PLL_BASE,
+        .lock_time_ns = CPU_PLL_LOCK_TIME_NS,
+        .div_switch_ns = CPU_PLL_DIV_SWITCH_NS,
+        .mux_latency_ns = CPU_PLL_MUX_LATENCY_NS,
+    },
+    {
+        .base_address = MYPLATFORM_CPU0_SPARE_PLL_BASE,
+        .lock_time_ns = CPU_PLL_LOCK_TIME_NS,
+        .div_switch_ns = CPU_PLL_DIV_SWITCH_NS,
+        .mux_latency_ns = CPU_PLL_MUX_LATENCY_NS,
+    },
+    {
+        .base_address = MYPLATFORM_CPU1_SPARE_PLL_BASE,
+        .lock_time_ns = CPU_PLL_LOCK_TIME_NS,
+        .div_switch_ns = CPU_PLL_DIV_SWITCH_NS,
+        .mux_latency_ns = CPU_PLL_MUX_LATENCY_NS,
+    },
+    {
+        .base_address = MYPLATFORM_CPU2_PLL_BASE,
+        .lock_time_ns = CPU_PLL_LOCK_TIME_NS,
+        .div_switch_ns = CPU_PLL_DIV_SWITCH_NS,
+        .mux_latency_ns = CPU_PLL_MUX_LATENCY_NS,
+    },
+    {
+        .base_address = MYPLATFORM_CPU3_PLL_BASE,
+        .lock_time_ns = CPU_PLL_LOCK_TIME_NS,
+        .div_switch_ns = CPU_PLL_DIV_SWITCH_NS,
+        .mux_latency_ns = CPU_PLL_MUX_LATENCY_NS,
+    },
+    {
+        .base_address = MYPLATFORM_GPU_PLL_BASE,
+        .lock_time_ns = GPU_PLL_LOCK_TIME_NS,
+        .div_switch_ns = GPU_PLL_DIV_SWITCH_NS,
+        .mux_latency_ns = GPU_PLL_MUX_LATENCY_NS,
+    },
+    {
+        .base_address = MYPLATFORM_SYS_PLL_BASE,
+        .lock_time_ns = 500000,      /* 系統 PLL 頻寬較低，鎖定較慢 */
+        .div_switch_ns = 200,
+        .mux_latency_ns = 20000,
+    },
+    {
+        .base_address = MYPLATFORM_PERIPHERAL_CLK_BASE,
+        .lock_time_ns = 100000,
+        .div_switch_ns = 200,
+        .mux_latency_ns = 5000,
+    },
+    {
+        .base_address = MYPLATFORM_DISPLAY_PLL_BASE,
+        .lock_time_ns = DISPLAY_PLL_LOCK_TIME_NS,
+        .div_switch_ns = DISPLAY_PLL_DIV_SWITCH_NS,
+        .mux_latency_ns = DISPLAY_PLL_MUX_LATENCY_NS,
+    },
+};
+
+struct fwk_module_config config_sw_pll = {
+    .data = &((struct sw_pll_config) {
+        .timing_table = sw_pll_timing_table,
+        .timing_count = FWK_ARRAY_SIZE(sw_pll_timing_table),
+        .default_timing = {
+            .lock_time_ns = 200000,
+            .div_switch_ns = 100,
+            .mux_latency_ns = 10000,
+        },
+        .async = true,
+        .trace_capacity = 256,
+    }),
+    .elements = FWK_MODULE_DYNAMIC_ELEMENTS(clock_get_dev_desc_table),
+};
+
+#define VIRTIO_SCMI_SLOT(idx) \
+    [idx] = { \
+        .name = "VIRTIO-SLOT" #idx, \
+        .data = &((struct mod_virtio_scmi_channel_config) { \
+            .service_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SCMI, \
+                MYPLATFORM_SCMI_SERVICE_IDX_VIRTIO_0 + (idx)), \
+        }), \
+    }
+
+static const struct fwk_element virtio_scmi_element_table[] = {
+    /* A2P：最多 4 個同時處理中的請求 */
+    VIRTIO_SCMI_SLOT(0),
+    VIRTIO_SCMI_SLOT(1),
+    VIRTIO_SCMI_SLOT(2),
+    VIRTIO_SCMI_SLOT(3),
+    
+    /* P2A：頻率變更通知 */
+    [4] = {
+        .name = "VIRTIO-P2A",
+        .data = &((struct mod_virtio_scmi_channel_config) {
+            .service_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SCMI,
+                MYPLATFORM_SCMI_SERVICE_IDX_VIRTIO_P2A),
+            .p2a = true,
+        }),
+    },
+    
+    /* 結束標記 */
+    [5] = { 0 },
+};
+
+static const struct fwk_element *virtio_scmi_get_element_table(
+    fwk_id_t module_id)
+{
+    return virtio_scmi_element_table;
+}
+
+struct fwk_module_config config_virtio_scmi = {
+    .elements = FWK_MODULE_DYNAMIC_ELEMENTS(virtio_scmi_get_element_table),
+};
+
+/*
+ * Host 模擬配置 (scmi_smc_fast_monitor.c)
+ * 
+ * 一個代理的 SMC 通道：shmem A2P、P2A 通知，以及暫存器 mailbox。
+ * 暫存器通道指向同一個 A2P service，mod_scmi 依它判斷代理，
+ * 暫存器 RATE_SET 的 RATE_CHANGED 也經此代理的 P2A service 送出
+ * (mod_scmi 的 service 設定中 SMC 的 scmi_p2a_id 指向 SMC_P2A)
+ */
+static const struct fwk_element smc_fast_element_table[] = {
+    [0] = {
+        .name = "SMC-SHMEM",
+        .data = &((struct mod_smc_fast_channel_config) {
+            .type = MOD_SMC_FAST_CHANNEL_SHMEM,
+            .service_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SCMI,
+                MYPLATFORM_SCMI_SERVICE_IDX_SMC),
+        }),
+    },
+    
+    [1] = {
+        .name = "SMC-P2A",
+        .data = &((struct mod_smc_fast_channel_config) {
+            .type = MOD_SMC_FAST_CHANNEL_P2A,
+            .service_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SCMI,
+                MYPLATFORM_SCMI_SERVICE_IDX_SMC_P2A),
+        }),
+    },
+    
+    [2] = {
+        .name = "SMC-REG",
+        .data = &((struct mod_smc_fast_channel_config) {
+            .type = MOD_SMC_FAST_CHANNEL_REG,
+            .service_id = FWK_ID_ELEMENT_INIT(FWK_MODULE_IDX_SCMI,
+                MYPLATFORM_SCMI_SERVICE_IDX_SMC),
+        }),
+    },
+    
+    /* 結束標記 */
+    [3] = { 0 },
+};
+
+static const struct fwk_element *smc_fast_get_element_table(fwk_id_t module_id)
+{
+    return smc_fast_element_table;
+}
+
+struct fwk_module_config config_smc_fast = {
+    .elements = FWK_MODULE_DYNAMIC_ELEMENTS(smc_fast_get_element_table),
+};
+
 /*
  * 使用說明：
  * 
@@ -438,21 +1269,35 @@ struct fwk_module_config config_myplatform_clock = {
  *     compatible = "arm,scmi";
  *     // ... 其他配置 ...
  *     
+ *     // scmi 節點自己的 mboxes/shmem 是預設通道
+ *     // (MYPLATFORM_SCMI_SERVICE_IDX_OSPM)，沒有專用通道的協議都走這裡
+ *     
+ *     // Linux SCMI core 每個協議只有一個 A2P 通道；CPU DVFS 走 PERF
+ *     // 協議的專用通道，對應 MYPLATFORM_SCMI_SERVICE_IDX_OSPM_DVFS。
+ *     // shmem 第一個是 A2P，第二個 (可省略) 是 P2A 通知；
+ *     // mboxes 依序為 tx、(可省略的 tx_reply)、rx
+ *     scmi_dvfs: protocol@13 {
+ *         reg = <0x13>;
+ *         #clock-cells = <1>;
+ *         mboxes = <&mhu 0 1>, <&mhu 1 1>;
+ *         shmem = <&cpu_scp_hpri0>, <&scp_cpu_hpri0>;
+ *     };
+ *     
  *     scmi_clk: protocol@14 {
  *         reg = <0x14>;
  *         #clock-cells = <1>;
+ *         // set_rate 預先保留 xfer 的時鐘 (GPU、顯示 pixel clock)
+ *         arm,high-priority-clocks = <4 9>;
  *     };
  * };
  * 
  * cpus {
  *     cpu0 {
- *         clocks = <&scmi_clk 0>;  // MYPLATFORM_CLOCK_IDX_CPU0
- *         clock-names = "cpu";
+ *         clocks = <&scmi_dvfs 0>; // scmi_perf 的 CPU0 domain
  *     };
  *     
  *     cpu1 {
- *         clocks = <&scmi_clk 1>;  // MYPLATFORM_CLOCK_IDX_CPU1
- *         clock-names = "cpu";
+ *         clocks = <&scmi_dvfs 1>; // scmi_perf 的 CPU1 domain
  *     };
  *     
  *     // ... 其他 CPU ...
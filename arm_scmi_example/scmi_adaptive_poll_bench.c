@@ -0,0 +1,286 @@
+/*
+ * SCMI Adaptive Polling Latency Benchmark (host simulator)
+ *
+ * 以模擬比較 scmi_adaptive_poll_example.c 的三種完成等待方式：
+ *
+ *   irq       原本的行為：一律打開 INTR_ENABLED，睡在 xfer->done 上
+ *   spin      一律 polling 到完成 (等同所有傳輸都設 poll_completion)
+ *   adaptive  依學到的 budget 先 spin，逾時再打開中斷旗標並睡眠
+ *
+ * 單一呼叫者依序送出同步請求，訊息組成與 SCP 服務時間 (doorbell 到
+ * CHANNEL_FREE) 如下：
+ *
+ *   RATE_GET         60%   3us + exp(1us)
+ *   CLOCK_ATTRIBUTES 10%   5us + exp(1us)
+ *   RATE_SET         30%   2/3 不需 relock 12us + exp(2us)，
+ *                          1/3 PLL relock 250us + exp(30us)
+ *
+ * 中斷路徑的成本 (P2A IRQ + wakeup + context switch) 為 6us + exp(2us)，
+ * 其中 2% 遇到 runqueue 上已有其他工作，再多 40us；AP 處理中斷花 3us CPU。
+ * spin 每次檢查 CHANNEL_FREE 0.2us。adaptive 直接使用範例中的
+ * scmi_poll_budget_ns / scmi_poll_learn (同樣的常數)。
+ *
+ * 處理時間取自 scmi_virtio_backend 跑 scp_firmware_clock_handler.c 的
+ * 量級與常見的 arm64 中斷喚醒延遲，只用來比較等待方式；亂數種子固定，
+ * 結果可重現。
+ *
+ * 編譯與執行：
+ *   gcc -O2 -Wall -Wextra -o scmi_adaptive_poll_bench \
+ *       scmi_adaptive_poll_bench.c -lm
+ *   ./scmi_adaptive_poll_bench [messages]
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NSEC_PER_USEC               1000ULL
+
+#define SCMI_POLL_MAX_BUDGET_NS     (20 * NSEC_PER_USEC)
+#define SCMI_POLL_IRQ_COST_NS       (8 * NSEC_PER_USEC)
+#define SCMI_POLL_EWMA_SHIFT        3
+
+#define SPIN_CHECK_NS               200
+#define IRQ_CPU_NS                  (3 * NSEC_PER_USEC)
+
+enum bench_mode {
+    MODE_IRQ,
+    MODE_SPIN,
+    MODE_ADAPTIVE,
+    MODE_COUNT,
+};
+
+static const char *const mode_names[] = { "irq", "spin", "adaptive" };
+
+enum msg_type {
+    MSG_RATE_GET,
+    MSG_ATTRIBUTES,
+    MSG_RATE_SET,
+    MSG_TYPE_COUNT,
+};
+
+static const char *const msg_names[] = { "RATE_GET", "ATTRIBUTES", "RATE_SET" };
+
+struct msg {
+    enum msg_type type;
+    uint64_t service;
+    uint64_t irq_cost;
+};
+
+/* 與 scmi_adaptive_poll_example.c 相同的統計與演算法 */
+struct scmi_poll_stat {
+    uint32_t avg_ns;
+    uint32_t dev_ns;
+    uint32_t spin_hits;
+    uint32_t irq_fallbacks;
+};
+
+static uint64_t rng_state = 0x7d2c41a98e3b5f17ULL;
+
+static double rng_uniform(void)
+{
+    /* xorshift64*，取高 53 位元 */
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+
+    return ((rng_state * 0x2545f4914f6cdd1dULL) >> 11) * (1.0 / (1ULL << 53));
+}
+
+static uint64_t rng_exp(double mean)
+{
+    return (uint64_t)(-mean * log(1.0 - rng_uniform()));
+}
+
+static uint32_t scmi_poll_budget_ns(const struct scmi_poll_stat *st)
+{
+    uint64_t budget;
+
+    if (!st->avg_ns)
+        return SCMI_POLL_MAX_BUDGET_NS;
+
+    if (st->avg_ns + SCMI_POLL_IRQ_COST_NS > SCMI_POLL_MAX_BUDGET_NS)
+        return 0;
+
+    budget = (uint64_t)st->avg_ns + 2 * (uint64_t)st->dev_ns;
+
+    return budget < SCMI_POLL_MAX_BUDGET_NS ? budget : SCMI_POLL_MAX_BUDGET_NS;
+}
+
+static void scmi_poll_learn(struct scmi_poll_stat *st, uint64_t service_ns)
+{
+    uint32_t sample = service_ns < UINT32_MAX ? service_ns : UINT32_MAX;
+    int64_t err;
+
+    if (!st->avg_ns) {
+        st->avg_ns = sample;
+        st->dev_ns = sample / 2;
+        return;
+    }
+
+    err = (int64_t)sample - st->avg_ns;
+    st->avg_ns += err >> SCMI_POLL_EWMA_SHIFT;
+    st->dev_ns += ((err < 0 ? -err : err) - (int64_t)st->dev_ns) >>
+                  SCMI_POLL_EWMA_SHIFT;
+}
+
+static void gen_msg(struct msg *m)
+{
+    double u = rng_uniform();
+
+    if (u < 0.6) {
+        m->type = MSG_RATE_GET;
+        m->service = 3 * NSEC_PER_USEC + rng_exp(1.0 * NSEC_PER_USEC);
+    } else if (u < 0.7) {
+        m->type = MSG_ATTRIBUTES;
+        m->service = 5 * NSEC_PER_USEC + rng_exp(1.0 * NSEC_PER_USEC);
+    } else {
+        m->type = MSG_RATE_SET;
+        if (rng_uniform() < 2.0 / 3)
+            m->service = 12 * NSEC_PER_USEC + rng_exp(2.0 * NSEC_PER_USEC);
+        else
+            m->service = 250 * NSEC_PER_USEC + rng_exp(30.0 * NSEC_PER_USEC);
+    }
+
+    m->irq_cost = 6 * NSEC_PER_USEC + rng_exp(2.0 * NSEC_PER_USEC);
+    if (rng_uniform() < 0.02)
+        m->irq_cost += 40 * NSEC_PER_USEC;
+}
+
+/* spin 看到 CHANNEL_FREE 的時間：下一次檢查 */
+static uint64_t spin_seen(uint64_t service)
+{
+    return (service / SPIN_CHECK_NS + 1) * SPIN_CHECK_NS;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double pct_us(const uint64_t *sorted, size_t n, double p)
+{
+    return sorted[(size_t)(p * (n - 1))] / (double)NSEC_PER_USEC;
+}
+
+static void run(enum bench_mode mode, const struct msg *msgs, size_t count)
+{
+    struct scmi_poll_stat stat[MSG_TYPE_COUNT] = { 0 };
+    uint64_t *lat[MSG_TYPE_COUNT], cpu[MSG_TYPE_COUNT] = { 0 };
+    size_t n[MSG_TYPE_COUNT] = { 0 }, i;
+    unsigned int t;
+
+    for (t = 0; t < MSG_TYPE_COUNT; t++) {
+        lat[t] = calloc(count, sizeof(*lat[t]));
+        if (!lat[t])
+            exit(1);
+    }
+
+    for (i = 0; i < count; i++) {
+        const struct msg *m = &msgs[i];
+        struct scmi_poll_stat *st = &stat[m->type];
+        uint64_t l, c;
+        uint32_t budget;
+
+        switch (mode) {
+        case MODE_IRQ:
+            l = m->service + m->irq_cost;
+            c = IRQ_CPU_NS;
+            break;
+        case MODE_SPIN:
+            l = spin_seen(m->service);
+            c = l;
+            break;
+        default:
+            budget = scmi_poll_budget_ns(st);
+            if (budget && m->service <= budget) {
+                l = spin_seen(m->service);
+                c = l;
+                st->spin_hits++;
+                scmi_poll_learn(st, l);
+            } else {
+                /* service > budget：打開旗標之後 SCP 才完成並送中斷 */
+                l = m->service + m->irq_cost;
+                c = budget + IRQ_CPU_NS;
+                if (budget)
+                    st->irq_fallbacks++;
+                scmi_poll_learn(st, l > SCMI_POLL_IRQ_COST_NS ?
+                                    l - SCMI_POLL_IRQ_COST_NS : l);
+            }
+            break;
+        }
+
+        lat[m->type][n[m->type]++] = l;
+        cpu[m->type] += c;
+    }
+
+    printf("%s\n", mode_names[mode]);
+    for (t = 0; t < MSG_TYPE_COUNT; t++) {
+        qsort(lat[t], n[t], sizeof(*lat[t]), cmp_u64);
+        printf("  %-10s  p50 %6.1f  p99 %6.1f  max %6.1f us"
+               "  | AP CPU %5.1f us/msg", msg_names[t],
+               pct_us(lat[t], n[t], 0.50), pct_us(lat[t], n[t], 0.99),
+               lat[t][n[t] - 1] / (double)NSEC_PER_USEC,
+               cpu[t] / (double)n[t] / NSEC_PER_USEC);
+        if (mode == MODE_ADAPTIVE)
+            printf("  | spin %u, fallback %u", stat[t].spin_hits,
+                   stat[t].irq_fallbacks);
+        printf("\n");
+        free(lat[t]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    struct msg *msgs;
+    unsigned int mode;
+    size_t i;
+
+    if (count == 0)
+        return 1;
+
+    msgs = calloc(count, sizeof(*msgs));
+    if (!msgs)
+        return 1;
+
+    for (i = 0; i < count; i++)
+        gen_msg(&msgs[i]);
+
+    printf("%zu msgs\n", count);
+    for (mode = 0; mode < MODE_COUNT; mode++)
+        run(mode, msgs, count);
+
+    free(msgs);
+
+    return 0;
+}
+
+/*
+ * 結果 (x86-64 host，預設參數)：
+ *
+ * 1000000 msgs
+ * irq
+ *   RATE_GET    p50   11.5  p99   51.4  max   67.2 us  | AP CPU   3.0 us/msg
+ *   ATTRIBUTES  p50   13.5  p99   53.4  max   74.1 us  | AP CPU   3.0 us/msg
+ *   RATE_SET    p50   23.6  p99  365.3  max  631.4 us  | AP CPU   3.0 us/msg
+ * spin
+ *   RATE_GET    p50    3.8  p99    7.6  max   18.8 us  | AP CPU   4.1 us/msg
+ *   ATTRIBUTES  p50    5.8  p99    9.6  max   18.0 us  | AP CPU   6.1 us/msg
+ *   RATE_SET    p50   14.8  p99  355.8  max  624.6 us  | AP CPU 103.0 us/msg
+ * adaptive
+ *   RATE_GET    p50    3.8  p99   17.3  max   66.9 us  | AP CPU   4.3 us/msg  | spin 546094, fallback 54469
+ *   ATTRIBUTES  p50    5.8  p99   19.3  max   64.5 us  | AP CPU   6.3 us/msg  | spin 91108, fallback 9010
+ *   RATE_SET    p50   23.6  p99  365.3  max  631.4 us  | AP CPU   3.0 us/msg  | spin 1, fallback 0
+ *
+ * - 短訊息的 p50 與 spin 相同，p99 從 51us 降到 17~19us；約 9% 的
+ *   服務時間落在 avg + 2*dev 之外，這些退回中斷、付出 budget + 中斷成本。
+ * - RATE_SET 混有 PLL relock，平均超過上限，學到 budget 0 後一律走中斷
+ *   (只有第一則試過 spin)，AP CPU 與 irq 模式相同；一律 spin 則每則
+ *   RATE_SET 平均燒掉 103us CPU。
+ * - 代價是不需 relock 的 RATE_SET 沒有受益：同一個 message id 的
+ *   雙峰分佈無法以單一 budget 區分。
+ */
@@ -0,0 +1,418 @@
+/*
+ * SCMI Channel Priority Tail-Latency Benchmark (host simulator)
+ *
+ * 以離散事件模擬比較 CPU DVFS 請求在幾種通道配置下的延遲分佈：
+ *
+ *   shared  所有請求共用一個 A2P 通道 (原本的配置)
+ *   fifo    PERF 協議有自己的 A2P 通道，SCP 依 doorbell 先後服務
+ *   prio    同 fifo，但 SCP 永遠先服務最高優先權的通道
+ *           (訊息粒度，不搶佔進行中的 handler)
+ *   wdrr    scp_scmi_channel_priority.c 的作法：優先權等級之間以
+ *           deficit round robin 分配 (HIGH:NORMAL:LOW = 8:4:1)，
+ *           輪內仍先服務高優先權
+ *
+ * 每個 A2P 通道同時只有一則訊息：AP 要等 SCP 回應 (CHANNEL_FREE) 後
+ * 才能放下一則，其餘請求在 AP 端排隊；延遲從請求產生算到 SCP 回應，
+ * 包含 AP 端排隊時間。
+ *
+ * 情境一 (一般負載)，兩種流量都是 Poisson 到達：
+ *
+ *   DVFS    PERF LEVEL_SET，平均每 500us 一則 (4 顆 CPU、schedutil
+ *           rate limit 2ms)，SCP 處理 12us
+ *   normal  其他協議：ATTRIBUTES/RATE_GET 8us (50%)、顯示 RATE_SET 60us
+ *           (30%)、DESCRIBE_RATES 一頁 150us (20%)，平均每 130us 一則
+ *
+ * 情境二 (OSPM 一般通道灌訊息)：normal 改成收到回應就立刻送下一則
+ * DESCRIBE_RATES (150us)，另有 TRUSTED 代理的 LOW 通道每 1ms 一則
+ * RATE_SET (8us，Poisson)。normal 的延遲沒有意義，改列它占 SCP 的比例。
+ *
+ * 每則訊息另加 3us 的 mod_scmi/事件循環成本。處理時間取自
+ * scmi_virtio_backend 跑 scp_firmware_clock_handler.c 的量級，
+ * 只用來比較排隊行為；亂數種子固定，結果可重現。
+ *
+ * 編譯與執行：
+ *   gcc -O2 -Wall -Wextra -o scmi_channel_priority_bench \
+ *       scmi_channel_priority_bench.c -lm
+ *   ./scmi_channel_priority_bench [dvfs_messages]
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NS_PER_US           1000ULL
+
+#define DISPATCH_NS         (3 * NS_PER_US)
+#define DVFS_SERVICE_NS     (12 * NS_PER_US)
+#define DVFS_INTERVAL_NS    (500.0 * NS_PER_US)
+#define NORMAL_INTERVAL_NS  (130.0 * NS_PER_US)
+#define FLOOD_SERVICE_NS    (150 * NS_PER_US)
+#define TRUSTED_SERVICE_NS  (8 * NS_PER_US)
+#define TRUSTED_INTERVAL_NS (1000.0 * NS_PER_US)
+
+enum bench_mode {
+    MODE_SHARED,
+    MODE_FIFO,
+    MODE_PRIO,
+    MODE_WDRR,
+};
+
+static const char *const mode_names[] = { "shared", "fifo", "prio", "wdrr" };
+
+/* 通道索引即優先權順序 (HIGH、NORMAL、LOW) */
+enum chan_idx {
+    CHAN_DVFS,
+    CHAN_NORMAL,
+    CHAN_TRUSTED,
+    CHAN_COUNT,
+};
+
+/* 與 example_platform_clock_config.c 的 band_weight 相同 */
+static const unsigned int band_weight[CHAN_COUNT] = { 8, 4, 1 };
+
+struct msg {
+    uint64_t arrival;
+    uint64_t service;
+    enum chan_idx chan;
+};
+
+/* 一個 A2P 通道：AP 端排隊的請求與上一則的完成時間 */
+struct chan {
+    const struct msg **queue;
+    size_t count;
+    size_t next;
+    uint64_t free_at;
+    unsigned int deficit;
+};
+
+static uint64_t rng_state = 0x5c3f1d2a9b7e4c01ULL;
+
+static double rng_uniform(void)
+{
+    /* xorshift64*，取高 53 位元 */
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+
+    return ((rng_state * 0x2545f4914f6cdd1dULL) >> 11) * (1.0 / (1ULL << 53));
+}
+
+static uint64_t rng_exp(double mean)
+{
+    return (uint64_t)(-mean * log(1.0 - rng_uniform()));
+}
+
+static uint64_t normal_service_ns(void)
+{
+    double u = rng_uniform();
+
+    if (u < 0.5)
+        return 8 * NS_PER_US;
+    if (u < 0.8)
+        return 60 * NS_PER_US;
+
+    return 150 * NS_PER_US;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static int cmp_arrival(const void *a, const void *b)
+{
+    const struct msg *x = *(const struct msg *const *)a;
+    const struct msg *y = *(const struct msg *const *)b;
+
+    return (x->arrival > y->arrival) - (x->arrival < y->arrival);
+}
+
+/* 通道下一則訊息放進 shmem 的時間 */
+static uint64_t chan_post_time(const struct chan *c)
+{
+    uint64_t arrival = c->queue[c->next]->arrival;
+
+    return arrival > c->free_at ? arrival : c->free_at;
+}
+
+static double pct_us(const uint64_t *sorted, size_t n, double p)
+{
+    size_t idx = (size_t)(p * (n - 1));
+
+    return sorted[idx] / (double)NS_PER_US;
+}
+
+/*
+ * wdrr：有訊息且有額度的等級中取最高優先權者，都用完時全部補滿
+ * (scmi_channel_priority_pick_band()；每個等級只有一個通道)
+ */
+static struct chan *pick_wdrr(struct chan *chans, const bool *pending)
+{
+    unsigned int c, pass;
+
+    for (pass = 0; pass < 2; pass++) {
+        for (c = 0; c < CHAN_COUNT; c++) {
+            if (pending[c] && chans[c].deficit != 0)
+                return &chans[c];
+        }
+        for (c = 0; c < CHAN_COUNT; c++)
+            chans[c].deficit = band_weight[c];
+    }
+
+    return NULL;
+}
+
+static void run(enum bench_mode mode, const struct msg *msgs, size_t total,
+                const size_t *counts, bool flood)
+{
+    struct chan chans[CHAN_COUNT] = { 0 };
+    const struct msg **order;
+    uint64_t *lat[CHAN_COUNT], now = 0, busy = 0, flood_busy = 0;
+    size_t i, n[CHAN_COUNT] = { 0 }, start;
+    unsigned int c, nchan = mode == MODE_SHARED ? 1 : CHAN_COUNT;
+
+    order = calloc(total, sizeof(*order));
+    if (!order)
+        exit(1);
+    for (c = 0; c < CHAN_COUNT; c++) {
+        lat[c] = calloc(counts[c] + 1, sizeof(*lat[c]));
+        if (!lat[c])
+            exit(1);
+        chans[c].deficit = band_weight[c];
+    }
+
+    /* msgs 已依到達時間排序，依模式分到各通道 */
+    if (mode == MODE_SHARED) {
+        for (i = 0; i < total; i++)
+            order[i] = &msgs[i];
+        chans[0].queue = order;
+        chans[0].count = total;
+    } else {
+        for (c = 0, start = 0; c < CHAN_COUNT; c++) {
+            chans[c].queue = order + start;
+            start += counts[c];
+        }
+        for (i = 0; i < total; i++) {
+            c = msgs[i].chan;
+            chans[c].queue[chans[c].count++] = &msgs[i];
+        }
+    }
+
+    for (;;) {
+        struct chan *pick = NULL;
+        bool pending[CHAN_COUNT] = { false };
+        uint64_t earliest = UINT64_MAX, post, done;
+        const struct msg *m;
+
+        /* SCP 閒置時，時間推進到最早放入 shmem 的訊息 */
+        for (c = 0; c < nchan; c++) {
+            if (chans[c].next < chans[c].count) {
+                post = chan_post_time(&chans[c]);
+                if (post < earliest)
+                    earliest = post;
+            }
+        }
+        if (earliest == UINT64_MAX)
+            break;
+        if (earliest > now)
+            now = earliest;
+
+        /* 已經 pending 的通道中選一個 */
+        for (c = 0; c < nchan; c++) {
+            if (chans[c].next >= chans[c].count)
+                continue;
+            post = chan_post_time(&chans[c]);
+            if (post > now)
+                continue;
+            pending[c] = true;
+            if (pick == NULL) {
+                pick = &chans[c];
+                continue;
+            }
+            /* prio 依通道順序 (CHAN_DVFS 優先)；fifo 依 doorbell 先後 */
+            if (mode == MODE_FIFO && post < chan_post_time(pick))
+                pick = &chans[c];
+        }
+        if (mode == MODE_WDRR)
+            pick = pick_wdrr(chans, pending);
+
+        m = pick->queue[pick->next++];
+        if (pick->deficit != 0)
+            pick->deficit--;
+        done = now + DISPATCH_NS + m->service;
+        busy += done - now;
+        if (flood && m->chan == CHAN_NORMAL)
+            flood_busy += done - now;
+        now = done;
+        pick->free_at = done;
+
+        lat[m->chan][n[m->chan]++] = done - m->arrival;
+    }
+
+    for (c = 0; c < CHAN_COUNT; c++)
+        qsort(lat[c], n[c], sizeof(*lat[c]), cmp_u64);
+
+    printf("%-6s  DVFS p50 %6.1f  p99 %6.1f  p99.9 %6.1f  max %6.1f us",
+           mode_names[mode],
+           pct_us(lat[CHAN_DVFS], n[CHAN_DVFS], 0.50),
+           pct_us(lat[CHAN_DVFS], n[CHAN_DVFS], 0.99),
+           pct_us(lat[CHAN_DVFS], n[CHAN_DVFS], 0.999),
+           lat[CHAN_DVFS][n[CHAN_DVFS] - 1] / (double)NS_PER_US);
+    if (flood)
+        printf("  | trusted p50 %7.1f  p99 %9.1f  max %9.1f us"
+               "  | normal %.0f%% of SCP\n",
+               pct_us(lat[CHAN_TRUSTED], n[CHAN_TRUSTED], 0.50),
+               pct_us(lat[CHAN_TRUSTED], n[CHAN_TRUSTED], 0.99),
+               lat[CHAN_TRUSTED][n[CHAN_TRUSTED] - 1] / (double)NS_PER_US,
+               100.0 * flood_busy / now);
+    else
+        printf("  | normal p50 %6.1f  p99 %7.1f us  | SCP busy %.0f%%\n",
+               pct_us(lat[CHAN_NORMAL], n[CHAN_NORMAL], 0.50),
+               pct_us(lat[CHAN_NORMAL], n[CHAN_NORMAL], 0.99),
+               100.0 * busy / now);
+
+    free(order);
+    for (c = 0; c < CHAN_COUNT; c++)
+        free(lat[c]);
+}
+
+/* 依到達時間排序後複製到 msgs */
+static struct msg *sort_msgs(struct msg *tmp, size_t total)
+{
+    const struct msg **sorted;
+    struct msg *msgs;
+    size_t i;
+
+    sorted = calloc(total, sizeof(*sorted));
+    msgs = calloc(total, sizeof(*msgs));
+    if (!sorted || !msgs)
+        exit(1);
+    for (i = 0; i < total; i++)
+        sorted[i] = &tmp[i];
+    qsort(sorted, total, sizeof(*sorted), cmp_arrival);
+    for (i = 0; i < total; i++)
+        msgs[i] = *sorted[i];
+    free(sorted);
+
+    return msgs;
+}
+
+/* DVFS 的 Poisson 流量，回傳最後一則的到達時間 */
+static uint64_t gen_dvfs(struct msg *tmp, size_t count)
+{
+    uint64_t t = 0;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        t += rng_exp(DVFS_INTERVAL_NS);
+        tmp[i] = (struct msg){ .arrival = t, .service = DVFS_SERVICE_NS,
+                               .chan = CHAN_DVFS };
+    }
+
+    return t;
+}
+
+int main(int argc, char **argv)
+{
+    size_t dvfs_count = argc > 1 ? strtoul(argv[1], NULL, 0) : 200000;
+    size_t counts[CHAN_COUNT], cap, total, i;
+    struct msg *msgs, *tmp;
+    uint64_t t, end;
+    enum bench_mode mode;
+
+    if (dvfs_count == 0)
+        return 1;
+
+    /* 情境一：兩種流量涵蓋相同的時間長度 */
+    end = (uint64_t)(dvfs_count * DVFS_INTERVAL_NS);
+    cap = dvfs_count + (size_t)(end / NORMAL_INTERVAL_NS * 1.2) + 16;
+    tmp = calloc(cap, sizeof(*tmp));
+    if (!tmp)
+        return 1;
+
+    gen_dvfs(tmp, dvfs_count);
+    total = dvfs_count;
+    for (t = rng_exp(NORMAL_INTERVAL_NS); t < end && total < cap;
+         t += rng_exp(NORMAL_INTERVAL_NS))
+        tmp[total++] = (struct msg){ .arrival = t,
+                                     .service = normal_service_ns(),
+                                     .chan = CHAN_NORMAL };
+    counts[CHAN_DVFS] = dvfs_count;
+    counts[CHAN_NORMAL] = total - dvfs_count;
+    counts[CHAN_TRUSTED] = 0;
+    msgs = sort_msgs(tmp, total);
+
+    printf("DVFS %zu msgs, normal %zu msgs, %.1f s simulated\n",
+           dvfs_count, counts[CHAN_NORMAL], end / 1e9);
+    for (mode = MODE_SHARED; mode <= MODE_WDRR; mode++)
+        run(mode, msgs, total, counts, false);
+
+    free(msgs);
+    free(tmp);
+
+    /*
+     * 情境二：normal 從 0 開始全部排在 AP 端，每次回應後立刻送出下一則，
+     * 數量足以占滿整個模擬時間
+     */
+    counts[CHAN_NORMAL] = (size_t)(end / (FLOOD_SERVICE_NS + DISPATCH_NS));
+    counts[CHAN_TRUSTED] = (size_t)(end / TRUSTED_INTERVAL_NS * 1.2) + 16;
+    cap = dvfs_count + counts[CHAN_NORMAL] + counts[CHAN_TRUSTED];
+    tmp = calloc(cap, sizeof(*tmp));
+    if (!tmp)
+        return 1;
+
+    gen_dvfs(tmp, dvfs_count);
+    total = dvfs_count;
+    for (i = 0; i < counts[CHAN_NORMAL]; i++)
+        tmp[total++] = (struct msg){ .service = FLOOD_SERVICE_NS,
+                                     .chan = CHAN_NORMAL };
+    i = total;
+    for (t = rng_exp(TRUSTED_INTERVAL_NS); t < end && total < cap;
+         t += rng_exp(TRUSTED_INTERVAL_NS))
+        tmp[total++] = (struct msg){ .arrival = t,
+                                     .service = TRUSTED_SERVICE_NS,
+                                     .chan = CHAN_TRUSTED };
+    counts[CHAN_TRUSTED] = total - i;
+    msgs = sort_msgs(tmp, total);
+
+    printf("\nflood: DVFS %zu msgs, normal %zu back-to-back, "
+           "trusted %zu msgs\n",
+           dvfs_count, counts[CHAN_NORMAL], counts[CHAN_TRUSTED]);
+    for (mode = MODE_FIFO; mode <= MODE_WDRR; mode++)
+        run(mode, msgs, total, counts, true);
+
+    free(msgs);
+    free(tmp);
+
+    return 0;
+}
+
+/*
+ * 結果 (x86-64 host，預設參數)：
+ *
+ * DVFS 200000 msgs, normal 768784 msgs, 100.0 s simulated
+ * shared  DVFS p50   15.0  p99  340.0  p99.9  537.1  max  861.2 us  | normal p50   63.0  p99   403.7 us  | SCP busy 45%
+ * fifo    DVFS p50   15.0  p99  181.3  p99.9  290.1  max  708.2 us  | normal p50   63.0  p99   412.7 us  | SCP busy 45%
+ * prio    DVFS p50   15.0  p99  161.9  p99.9  167.6  max  182.2 us  | normal p50   63.0  p99   413.5 us  | SCP busy 45%
+ * wdrr    DVFS p50   15.0  p99  161.9  p99.9  167.6  max  182.2 us  | normal p50   63.0  p99   413.5 us  | SCP busy 45%
+ *
+ * flood: DVFS 200000 msgs, normal 653594 back-to-back, trusted 99646 msgs
+ * fifo    DVFS p50  121.1  p99  468.5  p99.9  678.7  max 1163.2 us  | trusted p50   104.2  p99     319.2  max     773.0 us  | normal 96% of SCP
+ * prio    DVFS p50   91.9  p99  166.7  p99.9  171.0  max  192.5 us  | trusted p50 53326108.6  p99 102023441.2  max 102999862.4 us  | normal 96% of SCP
+ * wdrr    DVFS p50   91.2  p99  166.7  p99.9  170.2  max  223.2 us  | trusted p50   640.9  p99    3607.4  max    7954.5 us  | normal 96% of SCP
+ *
+ * - 中位數相同：大部分 DVFS 請求到達時 SCP 閒置。
+ * - 專用通道 (fifo) 去掉了 AP 端排在其他請求後面的時間，p99 減半；
+ *   但 SCP 仍依 doorbell 先後服務，已在 shmem 中的一般請求照樣在前面。
+ * - 加上優先權後 DVFS 最多等一則進行中的訊息 (DESCRIBE_RATES 一頁
+ *   150us + 本身 15us)，p99.9 與 max 都收斂到這個上限。
+ * - 一般請求的 p99 只增加約 10us (1 則 DVFS 的處理時間)。
+ * - 一般負載下 DVFS 從不連續用完 8 則額度，wdrr 與 prio 結果相同。
+ * - normal 灌訊息時，嚴格優先權讓 TRUSTED 等到 normal 全部送完
+ *   (整個模擬時間)；wdrr 每輪 (約 4 則 DESCRIBE_RATES) 服務 TRUSTED
+ *   一次，p50 約 0.6ms，DVFS 的尾端延遲與 prio 相同量級。
+ */
@@ -0,0 +1,537 @@
+/*
+ * SCMI Clock Async RATE_SET Trace Test (host, CI)
+ *
+ * mod_sw_pll 設定為 async (config_sw_pll.async = true) 時，set_rate 回傳
+ * FWK_PENDING，完成時間到了才回報 mod_clock。這個測試確認
+ * scp_firmware_clock_handler.c 的每一條 RATE_SET 路徑都把 PENDING 當成
+ * 已接受、在完成事件時才回報結果，並且完成後不留下 complete_at_ns：
+ *
+ *   1. shmem 同步 RATE_SET：回應在 PLL relock 完成後才送出
+ *   2. shmem 非同步 RATE_SET (flags bit0)：立即回應，完成時送
+ *      CLOCK_RATE_SET_COMPLETE delayed response
+ *   3. 暫存器快速路徑 RATE_SET：SMC 返回 IN_PROGRESS，完成後請求的代理
+ *      (未訂閱) 收到 RATE_CHANGED，RATE_GET 讀到新頻率
+ *   4. BRINGUP_SCRIPT 中的 RATE_SET：腳本在步驟之間等完成，最後才回應；
+ *      payload 放不下宣告的步驟數時回 SCMI_PROTOCOL_ERROR
+ *   5. 緊接著對同一個時鐘再送 RATE_SET，不能得到 BUSY；最後沒有任何
+ *      未回報的轉換 (否則電源域關閉會回 FWK_E_BUSY)
+ *   6. CPU 時鐘由 SCMI PERF 管理，CLOCK 協議的 RATE_SET 回 SCMI_DENIED
+ *
+ * 之後把 sw_pll 的 timeline 與下方 golden 比對 (時間相對於第一個場景開始)。
+ *
+ * 與 scmi_virtio_backend 使用同一個 host product (SCP-firmware
+ * arch/none/host + example_platform_clock_config.c)，以本檔取代
+ * scmi_virtio_backend.c：本檔提供同名的 module_virtio_scmi，直接在
+ * slot 上放入請求，不需要前端。
+ *
+ * 執行：
+ *   ./scmi_clock_async_trace_test        成功時回傳 0
+ *   ./scmi_clock_async_trace_test -v     另外印出實際 timeline
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "myplatform_scmi.h"
+
+#include <mod_scmi.h>
+#include <mod_scmi_clock.h>
+
+#include <fwk_arch.h>
+#include <fwk_id.h>
+#include <fwk_macros.h>
+#include <fwk_mm.h>
+#include <fwk_module.h>
+#include <fwk_module_idx.h>
+#include <fwk_status.h>
+
+/* scp_sw_pll_model.c 的虛擬時間與 trace 介面 */
+uint64_t sw_pll_now_ns(void);
+uint64_t sw_pll_next_completion_ns(void);
+void sw_pll_advance_to(uint64_t t_ns);
+void sw_pll_trace_dump(FILE *out);
+void sw_pll_trace_reset(void);
+
+/* 線上格式 (與 Linux 端相同) */
+#define SCMI_PROTOCOL_ID_CLOCK          0x14
+#define SCMI_MSG_CLOCK_RATE_CHANGED     0x0
+#define SCMI_MSG_CLOCK_RATE_SET         0x5
+#define SCMI_MSG_CLOCK_RATE_GET         0x6
+#define SCMI_MSG_CLOCK_BRINGUP_SCRIPT   0xC3
+
+#define SCMI_HDR(msg_id, token) \
+    ((uint32_t)(msg_id) | (SCMI_PROTOCOL_ID_CLOCK << 10) | ((token) << 18))
+#define SCMI_HDR_MSG_ID(hdr)            ((hdr) & 0xFF)
+
+#define SCRIPT_STEP(op, target)         ((uint32_t)(op) | ((target) << 16))
+#define SCRIPT_OP_CLOCK_ENABLE          0
+#define SCRIPT_OP_RATE_SET_KHZ          2
+
+/* agent_device_table_ospm 中的 SCMI clock ID */
+#define TEST_CLOCK_CPU2                 2
+#define TEST_CLOCK_GPU                  4
+#define TEST_CLOCK_DISPLAY              5
+
+#define TEST_MAX_PAYLOAD                128
+#define TEST_MAX_NOTIFICATIONS          16
+
+/*
+ * 期望的 timeline (場景 1 開始時為 0)；開機後 GPU 為 800MHz (VCO 1600
+ * div 2)，顯示為 148MHz (VCO 740 div 5)：
+ *   1. GPU 800 -> 600MHz：VCO 1600 不整除，relock 到 1200 (div 2)
+ *      2 * mux 10us + lock 200us
+ *   2. DISPLAY 148 -> 100MHz：relock 到 800 (div 8)，2 * 10us + 300us
+ *   3. GPU 600 -> 400MHz：VCO 1200 div 3，只切換分頻器 100ns
+ *   4. 腳本：DISPLAY 100 -> 200MHz (div 4) 與 GPU 400 -> 1200MHz (div 1)
+ *      都只切換分頻器，且 GPU 在 DISPLAY 完成後才開始
+ *   5. GPU 1200 -> 600MHz：div 2，100ns
+ *   6. CPU2 的 RATE_SET 被拒絕，沒有轉換
+ */
+static const char golden_trace[] =
+    "start_ns,end_ns,clock,kind,from_hz,to_hz\n"
+    "0,220000,GPU_CORE_CLK,relock,800000000,600000000\n"
+    "220000,540000,DISPLAY_PIXEL_CLK,relock,148000000,100000000\n"
+    "540000,540100,GPU_CORE_CLK,div,600000000,400000000\n"
+    "540100,540200,DISPLAY_PIXEL_CLK,div,100000000,200000000\n"
+    "540200,540300,GPU_CORE_CLK,div,400000000,1200000000\n"
+    "540300,540400,GPU_CORE_CLK,div,1200000000,600000000\n";
+
+/* 與 scmi_virtio_backend.c 相同的元素設定 (config_virtio_scmi) */
+struct mod_virtio_scmi_channel_config {
+    fwk_id_t service_id;
+    bool p2a;
+};
+
+struct test_slot {
+    const struct mod_virtio_scmi_channel_config *config;
+    bool busy;
+    uint32_t message_header;
+    uint8_t payload[TEST_MAX_PAYLOAD];
+    size_t payload_size;
+    uint8_t resp[TEST_MAX_PAYLOAD];
+    size_t resp_size;
+};
+
+struct test_notification {
+    uint32_t message_header;
+    uint8_t payload[TEST_MAX_PAYLOAD];
+    size_t size;
+};
+
+struct test_ctx {
+    struct test_slot *slot_table;
+    unsigned int slot_count;
+
+    struct test_notification notifications[TEST_MAX_NOTIFICATIONS];
+    unsigned int notification_count;
+
+    const struct mod_scmi_from_transport_api *scmi_api;
+    const struct mod_scmi_clock_reg_api *reg_api;
+
+    unsigned int failures;
+};
+
+static struct test_ctx test_ctx;
+
+/* host arch 的初始化驅動 (SCP-firmware arch/none/host 提供) */
+extern const struct fwk_arch_init_driver host_arch_init_driver;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", \
+                    __FILE__, __LINE__, #cond); \
+            test_ctx.failures++; \
+        } \
+    } while (0)
+
+/*
+ * 測試用傳輸模組 (取代 mod_virtio_scmi)
+ */
+
+static struct test_slot *test_slot_get(fwk_id_t channel_id)
+{
+    return &test_ctx.slot_table[fwk_id_get_element_idx(channel_id)];
+}
+
+static int test_get_secure(fwk_id_t channel_id, bool *secure)
+{
+    *secure = false;
+
+    return FWK_SUCCESS;
+}
+
+static int test_get_max_payload_size(fwk_id_t channel_id, size_t *size)
+{
+    *size = TEST_MAX_PAYLOAD;
+
+    return FWK_SUCCESS;
+}
+
+static int test_get_message_header(fwk_id_t channel_id, uint32_t *header)
+{
+    *header = test_slot_get(channel_id)->message_header;
+
+    return FWK_SUCCESS;
+}
+
+static int test_get_payload(fwk_id_t channel_id, const void **payload,
+                            size_t *size)
+{
+    struct test_slot *slot = test_slot_get(channel_id);
+
+    *payload = slot->payload;
+    *size = slot->payload_size;
+
+    return FWK_SUCCESS;
+}
+
+static int test_respond(fwk_id_t channel_id, const void *payload, size_t size)
+{
+    struct test_slot *slot = test_slot_get(channel_id);
+
+    if (!slot->busy || size > sizeof(slot->resp))
+        return FWK_E_STATE;
+
+    memcpy(slot->resp, payload, size);
+    slot->resp_size = size;
+    slot->busy = false;
+
+    return FWK_SUCCESS;
+}
+
+static int test_transmit(fwk_id_t channel_id, uint32_t message_header,
+                         const void *payload, size_t size,
+                         bool request_ack_by_interrupt)
+{
+    struct test_notification *n;
+
+    if (test_ctx.notification_count >= TEST_MAX_NOTIFICATIONS ||
+        size > sizeof(n->payload))
+        return FWK_E_NOMEM;
+
+    n = &test_ctx.notifications[test_ctx.notification_count++];
+    n->message_header = message_header;
+    memcpy(n->payload, payload, size);
+    n->size = size;
+
+    return FWK_SUCCESS;
+}
+
+static const struct mod_scmi_to_transport_api test_transport_api = {
+    .get_secure = test_get_secure,
+    .get_max_payload_size = test_get_max_payload_size,
+    .get_message_header = test_get_message_header,
+    .get_payload = test_get_payload,
+    .respond = test_respond,
+    .transmit = test_transmit,
+};
+
+static int test_init(fwk_id_t module_id, unsigned int element_count,
+                     const void *data)
+{
+    if (element_count == 0)
+        return FWK_E_PARAM;
+
+    test_ctx.slot_count = element_count;
+    test_ctx.slot_table = fwk_mm_calloc(element_count,
+                                        sizeof(struct test_slot));
+
+    return FWK_SUCCESS;
+}
+
+static int test_element_init(fwk_id_t element_id, unsigned int unused,
+                             const void *data)
+{
+    if (data == NULL)
+        return FWK_E_PARAM;
+
+    test_slot_get(element_id)->config = data;
+
+    return FWK_SUCCESS;
+}
+
+static int test_bind(fwk_id_t id, unsigned int round)
+{
+    int status;
+
+    if (round == 1 || !fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    status = fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_SCMI),
+                             FWK_ID_API(FWK_MODULE_IDX_SCMI,
+                                        MOD_SCMI_API_IDX_TRANSPORT),
+                             &test_ctx.scmi_api);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    /* 扮演 EL3 monitor，直接呼叫暫存器快速路徑 */
+    return fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+                           FWK_ID_API(FWK_MODULE_IDX_SCMI_CLOCK,
+                                      MOD_SCMI_CLOCK_API_IDX_REG),
+                           &test_ctx.reg_api);
+}
+
+static int test_process_bind_request(fwk_id_t source_id, fwk_id_t target_id,
+                                     fwk_id_t api_id, const void **api)
+{
+    *api = &test_transport_api;
+
+    return FWK_SUCCESS;
+}
+
+const struct fwk_module module_virtio_scmi = {
+    .name = "SCMI Clock Async Test Transport",
+    .type = FWK_MODULE_TYPE_DRIVER,
+    .api_count = 1,
+    .init = test_init,
+    .element_init = test_element_init,
+    .bind = test_bind,
+    .process_bind_request = test_process_bind_request,
+};
+
+/*
+ * 測試流程
+ */
+
+/* 執行事件佇列，並把虛擬時間推進到所有非同步轉換完成 */
+static void test_run_until_idle(void)
+{
+    uint64_t next;
+
+    fwk_process_event_queue();
+    while ((next = sw_pll_next_completion_ns()) != 0) {
+        sw_pll_advance_to(next);
+        fwk_process_event_queue();
+    }
+}
+
+/* 在 slot 0 放入請求並通知 mod_scmi，只處理目前的事件 (不推進時間) */
+static struct test_slot *test_post(unsigned int msg_id, const void *payload,
+                                   size_t size)
+{
+    static unsigned int token;
+    struct test_slot *slot = &test_ctx.slot_table[0];
+
+    CHECK(!slot->busy);
+    slot->message_header = SCMI_HDR(msg_id, token++ & 0x3FF);
+    memcpy(slot->payload, payload, size);
+    slot->payload_size = size;
+    slot->resp_size = 0;
+    slot->busy = true;
+
+    CHECK(test_ctx.scmi_api->signal_message(slot->config->service_id) ==
+          FWK_SUCCESS);
+    fwk_process_event_queue();
+
+    return slot;
+}
+
+static int32_t test_resp_status(const struct test_slot *slot)
+{
+    int32_t status;
+
+    if (slot->busy || slot->resp_size < sizeof(status))
+        return INT32_MIN;
+
+    memcpy(&status, slot->resp, sizeof(status));
+
+    return status;
+}
+
+static void test_rate_set_sync(uint32_t clock_id, uint64_t rate,
+                               int32_t expected)
+{
+    uint32_t msg[4] = { 0, clock_id, (uint32_t)rate, (uint32_t)(rate >> 32) };
+    struct test_slot *slot = test_post(SCMI_MSG_CLOCK_RATE_SET, msg,
+                                       sizeof(msg));
+
+    /* relock 還沒完成前不能回應 */
+    if (sw_pll_next_completion_ns() != 0)
+        CHECK(slot->busy);
+
+    test_run_until_idle();
+    CHECK(test_resp_status(slot) == expected);
+}
+
+static void test_rate_set_async(uint32_t clock_id, uint64_t rate)
+{
+    uint32_t msg[4] = { 1, clock_id, (uint32_t)rate, (uint32_t)(rate >> 32) };
+    const struct test_notification *n = NULL;
+    uint32_t delayed[4];
+    struct test_slot *slot;
+    unsigned int i;
+
+    test_ctx.notification_count = 0;
+    slot = test_post(SCMI_MSG_CLOCK_RATE_SET, msg, sizeof(msg));
+
+    /* 已回應，但轉換仍在進行 */
+    CHECK(test_resp_status(slot) == SCMI_SUCCESS);
+    CHECK(sw_pll_next_completion_ns() != 0);
+
+    test_run_until_idle();
+
+    for (i = 0; i < test_ctx.notification_count; i++) {
+        if (SCMI_HDR_MSG_ID(test_ctx.notifications[i].message_header) ==
+            SCMI_MSG_CLOCK_RATE_SET)
+            n = &test_ctx.notifications[i];
+    }
+    CHECK(n != NULL && n->size == sizeof(delayed));
+    if (n == NULL || n->size != sizeof(delayed))
+        return;
+
+    memcpy(delayed, n->payload, sizeof(delayed));
+    CHECK((int32_t)delayed[0] == SCMI_SUCCESS);
+    CHECK(delayed[1] == clock_id);
+    CHECK((((uint64_t)delayed[3] << 32) | delayed[2]) == rate);
+}
+
+/*
+ * 扮演 mailbox 轉接模組：暫存器通道屬於 slot 0 的代理 (OSPM)，
+ * 以它的 service 呼叫
+ */
+static void test_rate_set_reg(uint32_t clock_id, uint64_t rate)
+{
+    fwk_id_t service_id = test_ctx.slot_table[0].config->service_id;
+    uint32_t args[SCMI_CLOCK_REG_ARGS] = {
+        SCMI_MSG_CLOCK_RATE_SET, clock_id, (uint32_t)rate,
+        (uint32_t)(rate >> 32),
+    };
+    uint32_t ret[SCMI_CLOCK_REG_RETS];
+    const struct test_notification *n = NULL;
+    uint32_t changed[4];
+    unsigned int i;
+
+    test_ctx.notification_count = 0;
+    CHECK(test_ctx.reg_api->process(service_id, args, ret) == FWK_SUCCESS);
+    CHECK((int32_t)ret[0] == SCMI_SUCCESS);
+    CHECK(ret[3] & SCMI_CLOCK_REG_RET_IN_PROGRESS);
+
+    test_run_until_idle();
+
+    /* 沒有訂閱也要收到結果：agent_id, clock_id, rate_low, rate_high */
+    for (i = 0; i < test_ctx.notification_count; i++) {
+        if (SCMI_HDR_MSG_ID(test_ctx.notifications[i].message_header) ==
+            SCMI_MSG_CLOCK_RATE_CHANGED)
+            n = &test_ctx.notifications[i];
+    }
+    CHECK(n != NULL && n->size == sizeof(changed));
+    if (n != NULL && n->size == sizeof(changed)) {
+        memcpy(changed, n->payload, sizeof(changed));
+        CHECK(changed[1] == clock_id);
+        CHECK((((uint64_t)changed[3] << 32) | changed[2]) == rate);
+    }
+
+    args[0] = SCMI_MSG_CLOCK_RATE_GET;
+    CHECK(test_ctx.reg_api->process(service_id, args, ret) == FWK_SUCCESS);
+    CHECK((int32_t)ret[0] == SCMI_SUCCESS);
+    CHECK((((uint64_t)ret[2] << 32) | ret[1]) == rate);
+}
+
+static void test_script(void)
+{
+    const uint32_t msg[2 + 2 * 3] = {
+        0, 3,
+        SCRIPT_STEP(SCRIPT_OP_RATE_SET_KHZ, TEST_CLOCK_DISPLAY), 200000,
+        SCRIPT_STEP(SCRIPT_OP_CLOCK_ENABLE, TEST_CLOCK_DISPLAY), 0,
+        SCRIPT_STEP(SCRIPT_OP_RATE_SET_KHZ, TEST_CLOCK_GPU), 1200000,
+    };
+    struct test_slot *slot = test_post(SCMI_MSG_CLOCK_BRINGUP_SCRIPT, msg,
+                                       sizeof(msg));
+    uint32_t resp[2 + 3];
+
+    /* 第一步的 relock/分頻還沒完成 */
+    CHECK(slot->busy);
+
+    test_run_until_idle();
+    CHECK(slot->resp_size == sizeof(resp));
+    if (slot->resp_size != sizeof(resp))
+        return;
+
+    memcpy(resp, slot->resp, sizeof(resp));
+    CHECK((int32_t)resp[0] == SCMI_SUCCESS);
+    CHECK(resp[1] == 3);
+    CHECK(resp[2] == SCMI_SUCCESS && resp[3] == SCMI_SUCCESS &&
+          resp[4] == SCMI_SUCCESS);
+
+    /* 宣告 3 步但 payload 只有 2 步：不執行任何步驟 */
+    slot = test_post(SCMI_MSG_CLOCK_BRINGUP_SCRIPT, msg, sizeof(msg) - 8);
+    CHECK(test_resp_status(slot) == SCMI_PROTOCOL_ERROR);
+    CHECK(sw_pll_next_completion_ns() == 0);
+}
+
+/* timeline 換成相對時間後與 golden 比對 */
+static bool test_compare_trace(uint64_t t0, bool verbose)
+{
+    char *raw = NULL, *rel = NULL, *line, *save;
+    size_t raw_size, rel_size;
+    unsigned long long start, end;
+    FILE *out;
+    bool match;
+    int n;
+
+    out = open_memstream(&raw, &raw_size);
+    if (out == NULL)
+        return false;
+    sw_pll_trace_dump(out);
+    fclose(out);
+
+    out = open_memstream(&rel, &rel_size);
+    if (out == NULL) {
+        free(raw);
+        return false;
+    }
+    for (line = strtok_r(raw, "\n", &save); line != NULL;
+         line = strtok_r(NULL, "\n", &save)) {
+        if (sscanf(line, "%llu,%llu,%n", &start, &end, &n) == 2)
+            fprintf(out, "%llu,%llu,%s\n", start - t0, end - t0, line + n);
+        else
+            fprintf(out, "%s\n", line);
+    }
+    fclose(out);
+
+    match = strcmp(rel, golden_trace) == 0;
+    if (verbose || !match)
+        fprintf(stderr, "timeline%s:\n%s", match ? "" : " (mismatch)", rel);
+
+    free(raw);
+    free(rel);
+
+    return match;
+}
+
+int main(int argc, char **argv)
+{
+    bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    uint64_t t0;
+
+    if (fwk_arch_init(&host_arch_init_driver) != FWK_SUCCESS)
+        return EXIT_FAILURE;
+
+    /* 開機預設頻率也是非同步完成，先讓它們跑完 */
+    test_run_until_idle();
+    sw_pll_trace_reset();
+    t0 = sw_pll_now_ns();
+
+    test_rate_set_sync(TEST_CLOCK_GPU, 600UL * FWK_MHZ, SCMI_SUCCESS);
+    test_rate_set_async(TEST_CLOCK_DISPLAY, 100UL * FWK_MHZ);
+    test_rate_set_reg(TEST_CLOCK_GPU, 400UL * FWK_MHZ);
+    test_script();
+    test_rate_set_sync(TEST_CLOCK_GPU, 600UL * FWK_MHZ, SCMI_SUCCESS);
+    test_rate_set_sync(TEST_CLOCK_CPU2, 1200UL * FWK_MHZ, SCMI_DENIED);
+
+    CHECK(sw_pll_next_completion_ns() == 0);
+    CHECK(test_compare_trace(t0, verbose));
+
+    if (test_ctx.failures != 0) {
+        fprintf(stderr, "%u check(s) failed\n", test_ctx.failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("scmi clock async trace: ok\n");
+
+    return EXIT_SUCCESS;
+}
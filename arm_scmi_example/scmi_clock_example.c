@@ -11,26 +11,211 @@
 #include <linux/clk-provider.h>
 #include <linux/of.h>
 #include <linux/slab.h>
+#include <linux/cache.h>
+#include <linux/build_bug.h>
+#include <linux/debugfs.h>
+#include <linux/fs.h>
+#include <linux/notifier.h>
+#include <linux/workqueue.h>
+#include <linux/bitmap.h>
+#include <linux/atomic.h>
+#include <linux/list.h>
+#include <linux/overflow.h>
+#include <linux/cpufreq.h>
+#include <linux/math64.h>
+#include <linux/seq_file.h>
+#include <linux/delay.h>
 
-/* SCMI Clock Driver 資料結構 */
+/*
+ * 解碼後的頻率表，內容相同的時鐘共用同一份 (SCP 回報的 same_as)
+ * 等差的離散表與連續範圍不展開，只存三元組
+ */
+enum scmi_clk_table_type {
+    SCMI_CLK_TABLE_RANGE,   /* 連續範圍 {min, max, step} */
+    SCMI_CLK_TABLE_ARITH,   /* 等差離散表 min + i * step */
+    SCMI_CLK_TABLE_LIST,    /* 任意離散表，rates[] 遞增 */
+};
+
+struct scmi_clk_rate_table {
+    struct list_head node;
+    enum scmi_clk_table_type type;
+    /* 解碼這張表的時鐘 */
+    u32 owner;
+    u64 min;
+    u64 max;
+    u64 step;
+    unsigned int num_rates;
+    /* 共用此表的時鐘數 */
+    unsigned int users;
+    u64 rates[];
+};
+
+/*
+ * SCMI Clock Driver 資料結構
+ * 
+ * 前半部是 set_rate/recalc_rate/enable 熱路徑會用到的欄位，
+ * 集中放在第一條 cache line；clk_hw 與名稱只在註冊、除錯訊息時使用。
+ * 所有時鐘在 probe 時一次配置成連續陣列，每個元素 cache line 對齊
+ */
 struct scmi_clk_data {
+    /* --- 熱路徑欄位 --- */
     const struct scmi_protocol_handle *ph;
     const struct scmi_clk_proto_ops *ops;
-    struct clk_hw hw;
+    /*
+     * 頻率快取：CLOCK_ATTRIBUTES 的初始頻率、RATE_GET 或 RATE_CHANGED
+     * 通知的結果；rate_cached 為 true 時 recalc_rate 直接回傳，不送 RATE_GET
+     */
+    u64 rate;
     u32 id;
+    bool rate_cached;
+    /* 已訂閱 RATE_CHANGED，SCP 自行變更頻率時快取會被通知更新 */
+    bool rate_notified;
+    /* 列在 DT arm,high-priority-clocks 中的延遲敏感時鐘 */
+    bool high_priority;
+    /* 協議已為此時鐘保留 RATE_SET/RATE_GET xfer，走 *_fast */
+    bool xfer_reserved;
+    /* 共用的頻率表；NULL 時 round_rate 退回 info->list */
+    struct scmi_clk_rate_table *rates;
+    /* 已成功註冊到 clock framework */
+    bool registered;
+    
+    /* --- 冷欄位 --- */
     const char *name;
-};
+    struct clk_hw hw;
+    /* SCP CLOCK_RATE_CHANGED 通知 */
+    struct scmi_clk_provider *provider;
+    struct notifier_block nb;
+    atomic64_t notified_rate;
+    /* devm_clk_register() 的 handle，通知 work 以它觸發 recalc */
+    struct clk *clk;
+    /* SCP TRANSITION_COST 回報的轉換延遲與能量成本 */
+    struct scmi_clock_transition_cost cost;
+    bool has_cost;
+} ____cacheline_aligned;
+
+static_assert(offsetof(struct scmi_clk_data, name) <= SMP_CACHE_BYTES,
+              "scmi_clk_data hot fields must fit in one cache line");
 
 struct scmi_clk_provider {
     const struct scmi_protocol_handle *ph;
     const struct scmi_clk_proto_ops *ops;
-    struct scmi_clk_data **clks;
+    /* 以 clock ID 直接索引的連續陣列 */
+    struct scmi_clk_data *clks;
     int num_clocks;
     struct device *dev;
+    struct scmi_device *sdev;
+    struct dentry *debugfs_dir;
+    /* 收到通知但尚未同步到 clock framework 的時鐘 (bitmap) */
+    unsigned long *notify_pending;
+    struct delayed_work notify_work;
+    /* 建立 cpufreq policy 時填入 transition_latency */
+    struct notifier_block cpufreq_nb;
+    /* 已解碼的頻率表與取得它們所花的 SCMI 訊息數 */
+    struct list_head rate_tables;
+    unsigned int rate_table_msgs;
 };
 
+/*
+ * 通知合併視窗：視窗內同一時鐘的多次通知只取最後一個頻率，
+ * 所有時鐘的變更在一次 work 中同步給 clock framework
+ */
+#define SCMI_CLK_NOTIFY_COALESCE_US 1000
+
+/*
+ * clk_snapshot 二進位檔的單筆格式 (little endian)
+ * 一次 read 取得全部時鐘的 (id, flags, rate)
+ */
+struct scmi_clk_snapshot_record {
+    __le32 id;
+    __le32 flags;
+#define SCMI_CLK_SNAPSHOT_ENABLED BIT(0)
+#define SCMI_CLK_SNAPSHOT_VALID   BIT(1)
+    __le64 rate;
+} __packed;
+
+struct scmi_clk_snapshot {
+    size_t len;
+    struct scmi_clk_snapshot_record records[];
+};
+
+/*
+ * RATE_SET 遇到 SCMI_BUSY (-EBUSY) 的重送次數與第一次的退避時間，
+ * 之後每次加倍；SCP 在同一時鐘的非同步 RATE_SET 完成前回 BUSY
+ */
+#define SCMI_CLK_BUSY_RETRIES    3
+#define SCMI_CLK_BUSY_BACKOFF_US 50
+
+/*
+ * 單次 STATE_SNAPSHOT 回應最多的項目數；實際每頁的筆數受通道大小限制
+ * (128-byte payload 一頁 7 筆)
+ */
+#define SCMI_CLK_SNAPSHOT_PAGE 32
+
+/* 分頁讀取時 generation 改變的重試次數上限 */
+#define SCMI_CLK_SNAPSHOT_RETRIES 3
+
 #define to_scmi_clk(hw) container_of(hw, struct scmi_clk_data, hw)
 
+/* 所有 provider 的 debugfs 目錄的上層 */
+static struct dentry *scmi_clk_debugfs_root;
+
+/*
+ * 送出 RATE_SET / RATE_GET
+ * SCMI core 每個協議只有一個 A2P 通道 (protocol 節點自己的 mboxes/shmem，
+ * 沒有則共用 scmi 節點的)，通道在 DT 中決定，這裡不需要選擇。
+ * CPU DVFS 由 PERF 協議 (protocol@13) 的專用通道負責，見檔尾 DT 範例
+ */
+static int scmi_clk_do_rate_set(struct scmi_clk_data *clk, u64 rate)
+{
+    /* 預先配置的 xfer 只需更新 rate 欄位 */
+    if (clk->xfer_reserved)
+        return clk->ops->rate_set_fast(clk->ph, clk->id, rate);
+    
+    return clk->ops->rate_set(clk->ph, clk->id, rate);
+}
+
+static int scmi_clk_do_rate_get(struct scmi_clk_data *clk, u64 *rate)
+{
+    if (clk->xfer_reserved)
+        return clk->ops->rate_get_fast(clk->ph, clk->id, rate);
+    
+    return clk->ops->rate_get(clk->ph, clk->id, rate);
+}
+
+/*
+ * 向 SCP 重新查詢轉換成本 (協議端的 op 見 scmi_clock_vendor_example.c)；
+ * measured_* 是 SCP 最近一個量測視窗的值，會隨實際 RATE_SET 變動
+ */
+static int scmi_clk_update_cost(struct scmi_clk_data *clk)
+{
+    int ret;
+    
+    if (!clk->ops->transition_cost_get)
+        return -EOPNOTSUPP;
+    
+    ret = clk->ops->transition_cost_get(clk->ph, clk->id, &clk->cost);
+    if (ret)
+        return ret;
+    
+    clk->has_cost = true;
+    
+    return 0;
+}
+
+/*
+ * 最壞情況的頻率轉換延遲 (ns)：平台設定的 relock 延遲與
+ * SCP 實際量測值取大者
+ */
+static unsigned int scmi_clk_transition_latency_ns(struct scmi_clk_data *clk)
+{
+    u32 latency_us = clk->cost.relock_latency_us;
+    
+    if (clk->cost.measured_valid)
+        latency_us = max(latency_us, clk->cost.measured_latency_us);
+    
+    return latency_us * NSEC_PER_USEC;
+}
+
 /*
  * SCMI Clock 操作函數實作
  * 這些函數會透過 SCMI 協議與 SCP firmware 通訊
@@ -74,6 +259,16 @@ static void scmi_clk_disable(struct clk_hw *hw)
                  clk->name);
 }
 
+/*
+ * 時鐘以 CLK_GET_RATE_NOCACHE 註冊，framework 每次 clk_get_rate() 與
+ * set_rate 之後都會呼叫這裡。
+ *
+ * 有訂閱 RATE_CHANGED 的時鐘回傳本地快取：初值是 CLOCK_ATTRIBUTES 的
+ * 初始頻率，SCP 自行變更 (頻率上限、其他代理) 時由通知更新，因此
+ * clk_get_rate() 不送 RATE_GET。RATE_SET 會讓快取失效 (SCP 可能 round
+ * 或套用上限)，接著的這次呼叫讀回一次實際套用的頻率。
+ * 沒有通知的時鐘一律向 SCP 讀回
+ */
 static unsigned long scmi_clk_recalc_rate(struct clk_hw *hw,
                                          unsigned long parent_rate)
 {
@@ -81,8 +276,18 @@ static unsigned long scmi_clk_recalc_rate(struct clk_hw *hw,
     u64 rate;
     int ret;
     
+    /* 通知 work 觸發的 recalc：採用最新一則通知的頻率 */
+    rate = atomic64_xchg(&clk->notified_rate, 0);
+    if (rate) {
+        clk->rate = rate;
+        clk->rate_cached = true;
+    }
+    
+    if (clk->rate_cached)
+        return (unsigned long)clk->rate;
+    
     /* 從 SCP firmware 取得目前時鐘頻率 */
-    ret = clk->ops->rate_get(clk->ph, clk->id, &rate);
+    ret = scmi_clk_do_rate_get(clk, &rate);
     if (ret) {
         dev_err(clk->ph->dev, "Failed to get rate for clock %s: %d\n",
                 clk->name, ret);
@@ -92,6 +297,9 @@ static unsigned long scmi_clk_recalc_rate(struct clk_hw *hw,
     dev_dbg(clk->ph->dev, "Clock %s current rate: %llu Hz\n", 
             clk->name, rate);
     
+    clk->rate = rate;
+    clk->rate_cached = clk->rate_notified;
+    
     return (unsigned long)rate;
 }
 
@@ -99,39 +307,103 @@ static int scmi_clk_set_rate(struct clk_hw *hw, unsigned long rate,
                             unsigned long parent_rate)
 {
     struct scmi_clk_data *clk = to_scmi_clk(hw);
-    int ret;
+    int ret, retry;
     
-    dev_info(clk->ph->dev, "Setting clock %s rate to %lu Hz\n", 
-             clk->name, rate);
+    /*
+     * 不與本地快取比較後略過：頻率相同的請求 clock framework 已經擋掉，
+     * 走到這裡的一律送出，快取過期時也不會漏掉
+     */
+    dev_dbg(clk->ph->dev, "Setting clock %s rate to %lu Hz\n", 
+            clk->name, rate);
     
     /* 
      * 關鍵函數：透過 SCMI 協議設定時鐘頻率
      * 這會觸發與 SCP firmware 的通訊
      */
-    ret = clk->ops->rate_set(clk->ph, clk->id, (u64)rate);
+    for (retry = 0; ; retry++) {
+        ret = scmi_clk_do_rate_set(clk, (u64)rate);
+        if (ret != -EBUSY || retry == SCMI_CLK_BUSY_RETRIES)
+            break;
+        
+        /* SCP 上一個 RATE_SET 還在 relock (SCMI_BUSY)，退避後重送 */
+        usleep_range(SCMI_CLK_BUSY_BACKOFF_US << retry,
+                     SCMI_CLK_BUSY_BACKOFF_US << (retry + 1));
+    }
     if (ret) {
         dev_err(clk->ph->dev, "Failed to set rate %lu for clock %s: %d\n",
                 rate, clk->name, ret);
         return ret;
     }
     
-    dev_info(clk->ph->dev, "Clock %s rate set to %lu Hz successfully\n", 
-             clk->name, rate);
+    /*
+     * 不把要求的頻率當成結果：SCP 可能 round 到最接近的 OPP 或套用上限，
+     * clk_change_rate() 緊接著呼叫 recalc_rate，由它讀回實際套用的頻率。
+     * 之前收到、尚未同步的通知比這次 RATE_SET 舊，一併丟棄
+     */
+    clk->rate_cached = false;
+    atomic64_set(&clk->notified_rate, 0);
+    dev_dbg(clk->ph->dev, "Clock %s rate set to %lu Hz successfully\n", 
+            clk->name, rate);
     
     return 0;
 }
 
+/* 在共用頻率表中找最接近的頻率 */
+static unsigned long scmi_clk_table_round(const struct scmi_clk_rate_table *t,
+                                          unsigned long rate)
+{
+    unsigned int lo, hi, mid;
+    u64 idx;
+    
+    if (rate <= t->min)
+        return t->min;
+    if (rate >= t->max)
+        return t->max;
+    
+    switch (t->type) {
+    case SCMI_CLK_TABLE_RANGE:
+    case SCMI_CLK_TABLE_ARITH:
+        if (!t->step)
+            return rate;
+        idx = div64_u64(rate - t->min + t->step / 2, t->step);
+        /* 連續範圍的 max 不一定落在 step 格點上 */
+        return min(t->min + idx * t->step, t->max);
+    
+    case SCMI_CLK_TABLE_LIST:
+    default:
+        /* rates[lo] <= rate < rates[hi] */
+        lo = 0;
+        hi = t->num_rates - 1;
+        while (hi - lo > 1) {
+            mid = lo + (hi - lo) / 2;
+            if (t->rates[mid] <= rate)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        return (rate - t->rates[lo] <= t->rates[hi] - rate) ?
+               t->rates[lo] : t->rates[hi];
+    }
+}
+
 static long scmi_clk_round_rate(struct clk_hw *hw, unsigned long rate,
                               unsigned long *parent_rate)
 {
     struct scmi_clk_data *clk = to_scmi_clk(hw);
     const struct scmi_clock_info *info;
     
+    if (clk->rates)
+        return scmi_clk_table_round(clk->rates, rate);
+    
     /* 取得時鐘資訊以驗證頻率範圍 */
     info = clk->ops->info_get(clk->ph, clk->id);
     if (!info)
         return rate;
     
+    /* 頻率表未知 (compact 與標準 DESCRIBE_RATES 都失敗)：交給 SCP 處理 */
+    if (info->rate_discrete ? !info->list.num_rates : !info->range.max_rate)
+        return rate;
+    
     /* 如果是離散頻率，找到最接近的支援頻率 */
     if (info->rate_discrete) {
         int i;
@@ -163,6 +435,50 @@ static long scmi_clk_round_rate(struct clk_hw *hw, unsigned long rate,
     return rate;
 }
 
+/*
+ * /sys/kernel/debug/clk/<name>/transition_cost
+ * 每次讀取都向 SCP 重新查詢，反映最新的量測值
+ */
+static int scmi_clk_transition_cost_show(struct seq_file *s, void *unused)
+{
+    struct scmi_clk_data *clk = s->private;
+    int ret;
+    
+    ret = scmi_clk_update_cost(clk);
+    if (ret)
+        return ret;
+    
+    seq_printf(s, "relock_latency_us: %u\n", clk->cost.relock_latency_us);
+    seq_printf(s, "relock_energy_nj:  %u\n", clk->cost.relock_energy_nj);
+    seq_printf(s, "div_latency_us:    %u\n", clk->cost.div_latency_us);
+    seq_printf(s, "div_energy_nj:     %u\n", clk->cost.div_energy_nj);
+    if (clk->cost.measured_valid) {
+        seq_printf(s, "measured_latency_us: %u\n",
+                   clk->cost.measured_latency_us);
+        seq_printf(s, "measured_avg_us:     %u\n",
+                   clk->cost.measured_avg_us);
+    }
+    if (clk->cost.measured_div_valid)
+        seq_printf(s, "measured_div_latency_us: %u\n",
+                   clk->cost.measured_div_latency_us);
+    if (clk->cost.swap_valid) {
+        seq_printf(s, "swap_latency_us:   %u\n", clk->cost.swap_latency_us);
+        seq_printf(s, "swap_energy_nj:    %u\n", clk->cost.swap_energy_nj);
+    }
+    
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(scmi_clk_transition_cost);
+
+static void scmi_clk_debug_init(struct clk_hw *hw, struct dentry *dentry)
+{
+    struct scmi_clk_data *clk = to_scmi_clk(hw);
+    
+    if (clk->has_cost)
+        debugfs_create_file("transition_cost", 0400, dentry, clk,
+                            &scmi_clk_transition_cost_fops);
+}
+
 /* Clock 操作函數表 */
 static const struct clk_ops scmi_clk_ops = {
     .enable = scmi_clk_enable,
@@ -170,8 +486,265 @@ static const struct clk_ops scmi_clk_ops = {
     .recalc_rate = scmi_clk_recalc_rate,
     .set_rate = scmi_clk_set_rate,
     .round_rate = scmi_clk_round_rate,
+    .debug_init = scmi_clk_debug_init,
 };
 
+/*
+ * 檢查 clock ID 是否列在 DT 的 arm,high-priority-clocks 中
+ */
+static bool scmi_clk_is_high_priority(struct device_node *np, u32 clk_id)
+{
+    int i, count;
+    u32 id;
+    
+    count = of_property_count_u32_elems(np, "arm,high-priority-clocks");
+    for (i = 0; i < count; i++) {
+        if (!of_property_read_u32_index(np, "arm,high-priority-clocks",
+                                        i, &id) && id == clk_id)
+            return true;
+    }
+    
+    return false;
+}
+
+/*
+ * SCMI CLOCK_RATE_CHANGED 通知回呼
+ * 只記錄最新頻率並排程 work，突發的多則通知會被合併成一次同步
+ */
+static int scmi_clk_rate_notify(struct notifier_block *nb,
+                                unsigned long event, void *data)
+{
+    struct scmi_clk_data *sclk = container_of(nb, struct scmi_clk_data, nb);
+    struct scmi_clk_provider *provider = sclk->provider;
+    struct scmi_clock_rate_notif_report *r = data;
+    
+    atomic64_set(&sclk->notified_rate, r->rate);
+    set_bit(sclk->id, provider->notify_pending);
+    
+    /* work 已在等待中時不會重新計時，視窗內的通知都由同一次 work 處理 */
+    schedule_delayed_work(&provider->notify_work,
+                          usecs_to_jiffies(SCMI_CLK_NOTIFY_COALESCE_US));
+    
+    return NOTIFY_OK;
+}
+
+/*
+ * 將累積的頻率變更同步到 clock framework
+ *
+ * 頻率是 SCP 改的，provider 不能用 clk_set_rate()：那會改掉 consumer
+ * 的 req_rate、再走一次 round/set_rate。時鐘以 CLK_GET_RATE_NOCACHE
+ * 註冊，clk_get_rate() 會經 __clk_recalc_rates() 重新 recalc 這顆時鐘
+ * 與它的子時鐘，並送出 POST_RATE_CHANGE 給 consumer，不需要修改 clk.c。
+ * recalc_rate 直接採用通知帶來的頻率，不送 RATE_GET。
+ */
+static void scmi_clk_notify_work(struct work_struct *work)
+{
+    struct scmi_clk_provider *provider =
+        container_of(to_delayed_work(work), struct scmi_clk_provider,
+                     notify_work);
+    struct scmi_clk_data *sclk;
+    int id;
+    
+    for_each_set_bit(id, provider->notify_pending, provider->num_clocks) {
+        if (!test_and_clear_bit(id, provider->notify_pending))
+            continue;
+        
+        sclk = &provider->clks[id];
+        dev_dbg(provider->dev, "Clock %s changed by SCP: %llu -> %lld Hz\n",
+                sclk->name, sclk->rate,
+                (long long)atomic64_read(&sclk->notified_rate));
+        
+        clk_get_rate(sclk->clk);
+    }
+}
+
+/*
+ * 停止通知 work：之後的 schedule_delayed_work() 不再排入，
+ * 已排入或執行中的 work 等它結束。通知訂閱比這個動作晚釋放，
+ * 只用 cancel 的話期間到達的通知會再把 work 排回去
+ */
+static void scmi_clk_disable_notify_work(void *data)
+{
+    struct scmi_clk_provider *provider = data;
+    
+    disable_delayed_work_sync(&provider->notify_work);
+}
+
+/*
+ * 送一次 DESCRIBE_RATES_COMPACT 並計數
+ * struct scmi_clock_rates_compact 是協議層解出的一頁 (見
+ * scmi_clock_vendor_example.c)：format (TRIPLET/DELTA)、discrete、same_as、
+ * total_rates、num_values、remaining、base 與 values[]
+ */
+static int scmi_clk_fetch_rates(struct scmi_clk_provider *provider, u32 clk_id,
+                                u32 index, struct scmi_clock_rates_compact *page)
+{
+    provider->rate_table_msgs++;
+    
+    return provider->ops->describe_rates_compact(provider->ph, clk_id, index,
+                                                 page);
+}
+
+static enum scmi_clk_table_type
+scmi_clk_page_type(const struct scmi_clock_rates_compact *page)
+{
+    if (page->format == SCMI_CLOCK_RATES_DELTA)
+        return SCMI_CLK_TABLE_LIST;
+    
+    return page->discrete ? SCMI_CLK_TABLE_ARITH : SCMI_CLK_TABLE_RANGE;
+}
+
+/*
+ * SCP 比對過完整內容，same_as 指向表相同、ID 較小的時鐘；
+ * 那顆時鐘已解碼的表直接共用，不再讀其餘頁面。
+ * 第一頁與已解碼的表不一致 (SCP 回報錯誤) 時不共用
+ */
+static struct scmi_clk_rate_table *
+scmi_clk_table_shared(struct scmi_clk_provider *provider, u32 clk_id,
+                      const struct scmi_clock_rates_compact *page)
+{
+    struct scmi_clk_rate_table *t;
+    
+    if (page->same_as >= clk_id)
+        return NULL;
+    
+    t = provider->clks[page->same_as].rates;
+    if (!t || t->type != scmi_clk_page_type(page) ||
+        t->num_rates != page->total_rates || t->min != page->base)
+        return NULL;
+    
+    return t;
+}
+
+/* 三元組格式：{min, max, step}，不展開 */
+static struct scmi_clk_rate_table *
+scmi_clk_table_from_triplet(struct scmi_clk_provider *provider, u32 clk_id,
+                            const struct scmi_clock_rates_compact *page)
+{
+    struct scmi_clk_rate_table *t;
+    
+    t = devm_kzalloc(provider->dev, sizeof(*t), GFP_KERNEL);
+    if (!t)
+        return ERR_PTR(-ENOMEM);
+    
+    t->type = scmi_clk_page_type(page);
+    t->owner = clk_id;
+    t->min = page->base;
+    t->max = page->values[0] | ((u64)page->values[1] << 32);
+    t->step = page->values[2] | ((u64)page->values[3] << 32);
+    t->num_rates = page->total_rates;
+    list_add_tail(&t->node, &provider->rate_tables);
+    
+    return t;
+}
+
+/* 將一頁差值編碼解到 rates[index...]，回傳本頁的頻率數 */
+static unsigned int scmi_clk_decode_delta(const struct scmi_clock_rates_compact *page,
+                                          u64 *rates, unsigned int room)
+{
+    unsigned int i, n = min(page->num_values + 1, room);
+    
+    rates[0] = page->base;
+    for (i = 1; i < n; i++)
+        rates[i] = rates[i - 1] + page->values[i - 1];
+    
+    return n;
+}
+
+/* 差值格式：從第一頁開始逐頁解碼整張表 */
+static struct scmi_clk_rate_table *
+scmi_clk_table_from_delta(struct scmi_clk_provider *provider, u32 clk_id,
+                          struct scmi_clock_rates_compact *page)
+{
+    struct scmi_clk_rate_table *t;
+    unsigned int n, index;
+    int ret;
+    
+    if (!page->total_rates)
+        return ERR_PTR(-EPROTO);
+    
+    t = devm_kzalloc(provider->dev,
+                     struct_size(t, rates, page->total_rates), GFP_KERNEL);
+    if (!t)
+        return ERR_PTR(-ENOMEM);
+    
+    t->type = SCMI_CLK_TABLE_LIST;
+    t->owner = clk_id;
+    t->num_rates = page->total_rates;
+    
+    for (index = 0; ; ) {
+        n = scmi_clk_decode_delta(page, &t->rates[index],
+                                  t->num_rates - index);
+        index += n;
+        if (index >= t->num_rates)
+            break;
+        
+        ret = scmi_clk_fetch_rates(provider, clk_id, index, page);
+        if (ret) {
+            devm_kfree(provider->dev, t);
+            return ERR_PTR(ret);
+        }
+    }
+    
+    t->min = t->rates[0];
+    t->max = t->rates[t->num_rates - 1];
+    list_add_tail(&t->node, &provider->rate_tables);
+    
+    return t;
+}
+
+/*
+ * 以 DESCRIBE_RATES_COMPACT 取得 (或共用) 時鐘的頻率表
+ *
+ * SCP 支援 compact 時協議層 init 不送標準 DESCRIBE_RATES，info->list 是空的；
+ * compact 取不到這顆時鐘的表 (例如差值放不進 u32) 就請協議層補做標準流程，
+ * round_rate 再退回 info->list
+ */
+static void scmi_clk_attach_rate_table(struct scmi_clk_provider *provider,
+                                       struct scmi_clk_data *sclk)
+{
+    struct scmi_clock_rates_compact page;
+    struct scmi_clk_rate_table *t;
+    int ret;
+    
+    if (!provider->ops->describe_rates_compact)
+        return;
+    
+    ret = scmi_clk_fetch_rates(provider, sclk->id, 0, &page);
+    if (ret) {
+        dev_dbg(provider->dev, "No compact rate table for %s: %d\n",
+                sclk->name, ret);
+        goto fallback;
+    }
+    
+    t = scmi_clk_table_shared(provider, sclk->id, &page);
+    if (!t) {
+        if (page.format == SCMI_CLOCK_RATES_TRIPLET)
+            t = scmi_clk_table_from_triplet(provider, sclk->id, &page);
+        else
+            t = scmi_clk_table_from_delta(provider, sclk->id, &page);
+    }
+    
+    if (IS_ERR(t)) {
+        dev_warn(provider->dev, "Failed to decode rate table of %s: %ld\n",
+                 sclk->name, PTR_ERR(t));
+        goto fallback;
+    }
+    
+    t->users++;
+    sclk->rates = t;
+    return;
+    
+fallback:
+    if (!provider->ops->describe_rates)
+        return;
+    
+    ret = provider->ops->describe_rates(provider->ph, sclk->id);
+    if (ret)
+        dev_warn(provider->dev, "Failed to describe rates of %s: %d\n",
+                 sclk->name, ret);
+}
+
 /*
  * 註冊單一時鐘到 Linux Clock Framework
  */
@@ -191,23 +764,66 @@ static int scmi_clk_register_single(struct scmi_clk_provider *provider,
         return -ENODEV;
     }
     
-    /* 分配時鐘資料結構 */
-    sclk = devm_kzalloc(provider->dev, sizeof(*sclk), GFP_KERNEL);
-    if (!sclk)
-        return -ENOMEM;
+    /* 時鐘資料已在 probe 時以連續陣列配置好 */
+    sclk = &provider->clks[clk_id];
     
     /* 初始化時鐘資料 */
     sclk->ph = provider->ph;
     sclk->ops = provider->ops;
     sclk->id = clk_id;
     sclk->name = info->name;
+    sclk->provider = provider;
     sclk->hw.init = &init;
     
+    /*
+     * SCP 在 CLOCK_ATTRIBUTES 回報開機時已套用的頻率 (info->initial_rate，
+     * 見 scmi_clock_vendor_example.c)。有通知的時鐘以它作為快取初值，
+     * 註冊時的 recalc_rate 不送 RATE_GET；之後的 assigned-clock-rates
+     * 頻率相同時，clk_set_rate() 也不會再送 RATE_SET
+     */
+    if (info->rate_changed_notifications && info->initial_rate) {
+        sclk->rate = info->initial_rate;
+        sclk->rate_cached = true;
+    }
+    
+    /* DT 指定的延遲敏感時鐘 (例如 GPU、顯示 pixel clock) */
+    sclk->high_priority = scmi_clk_is_high_priority(provider->dev->of_node,
+                                                    clk_id);
+    
+    /*
+     * 高優先權時鐘請協議預先保留 xfer，set_rate 熱路徑不再配置 xfer；
+     * 保留數量有限 (每個 xfer 占一個 token)，失敗時照舊走一般路徑
+     */
+    if (sclk->high_priority && provider->ops->rate_xfer_reserve) {
+        ret = provider->ops->rate_xfer_reserve(provider->ph, clk_id);
+        sclk->xfer_reserved = !ret;
+        if (ret)
+            dev_dbg(provider->dev, "No reserved xfer for %s: %d\n",
+                    info->name, ret);
+    }
+    
+    /* round_rate 使用的頻率表，與內容相同的時鐘共用 */
+    scmi_clk_attach_rate_table(provider, sclk);
+    
+    /*
+     * 註冊前取得轉換成本，debug_init 依 has_cost 決定是否建立檔案；
+     * 沒有成本表的時鐘 SCP 回 NOT_SUPPORTED
+     */
+    ret = scmi_clk_update_cost(sclk);
+    if (ret && ret != -EOPNOTSUPP)
+        dev_dbg(provider->dev, "No transition cost for %s: %d\n",
+                info->name, ret);
+    
     /* 設定 clock init 資料 */
     init.name = info->name;
     init.ops = &scmi_clk_ops;
     init.num_parents = 0;
-    init.flags = CLK_GET_RATE_NOCACHE; /* 總是從 SCP 取得最新頻率 */
+    /*
+     * 保留 NOCACHE：clk_get_rate() 因此會呼叫 recalc_rate，通知 work 靠這條
+     * 路徑把新頻率送給 consumer (POST_RATE_CHANGE)；有通知的時鐘在
+     * recalc_rate 回傳快取，不會因此多送 RATE_GET
+     */
+    init.flags = CLK_GET_RATE_NOCACHE;
     
     /* 註冊時鐘到 Linux Clock Framework */
     clk = devm_clk_register(provider->dev, &sclk->hw);
@@ -218,14 +834,35 @@ static int scmi_clk_register_single(struct scmi_clk_provider *provider,
         return ret;
     }
     
-    /* 儲存時鐘資料 */
-    provider->clks[clk_id] = sclk;
+    sclk->clk = clk;
+    sclk->registered = true;
+    
+    /* 訂閱 SCP 端的頻率變更通知，取代輪詢 recalc_rate */
+    if (info->rate_changed_notifications) {
+        sclk->nb.notifier_call = scmi_clk_rate_notify;
+        ret = provider->sdev->handle->notify_ops->devm_event_notifier_register(
+            provider->sdev, SCMI_PROTOCOL_CLOCK,
+            SCMI_EVENT_CLOCK_RATE_CHANGED, &sclk->id, &sclk->nb);
+        if (ret)
+            dev_warn(provider->dev,
+                     "Rate change notification for %s unavailable: %d\n",
+                     info->name, ret);
+        sclk->rate_notified = !ret;
+    }
+    
+    /* 收不到通知的時鐘不能信任快取，之後每次都讀回 */
+    if (!sclk->rate_notified)
+        sclk->rate_cached = false;
     
     dev_info(provider->dev, "Registered SCMI clock: %s (ID: %d)\n", 
              info->name, clk_id);
     
-    /* 顯示時鐘詳細資訊 */
-    if (info->rate_discrete) {
+    /* 顯示時鐘詳細資訊 (compact 頻率表取代了 info->list) */
+    if (sclk->rates) {
+        dev_info(provider->dev, "  Rate table: %u rates [%llu, %llu] (clk%u)\n",
+                 sclk->rates->num_rates, sclk->rates->min, sclk->rates->max,
+                 sclk->rates->owner);
+    } else if (info->rate_discrete) {
         dev_info(provider->dev, "  Discrete rates: %d rates available\n",
                  info->list.num_rates);
     } else {
@@ -252,12 +889,245 @@ static struct clk_hw *scmi_clk_of_xlate(struct of_phandle_args *clkspec,
     
     clk_id = clkspec->args[0];
     
-    if (clk_id >= provider->num_clocks || !provider->clks[clk_id])
+    if (clk_id >= provider->num_clocks || !provider->clks[clk_id].registered)
         return ERR_PTR(-EINVAL);
     
-    return &provider->clks[clk_id]->hw;
+    return &provider->clks[clk_id].hw;
+}
+
+/* 歸還預先保留的 xfer；devm 反向釋放時時鐘已先解除註冊 */
+static void scmi_clk_release_xfers(void *data)
+{
+    struct scmi_clk_provider *provider = data;
+    int i;
+    
+    for (i = 0; i < provider->num_clocks; i++) {
+        if (!provider->clks[i].xfer_reserved)
+            continue;
+        provider->ops->rate_xfer_release(provider->ph, i);
+        provider->clks[i].xfer_reserved = false;
+    }
+}
+
+/*
+ * xfer_stats：兩種路徑的次數與平均時間 (都含 do_xfer)，
+ * 以及 xfer_get_init 次數 (持續調頻的保留時鐘不應增加)
+ */
+static int scmi_clk_xfer_stats_show(struct seq_file *s, void *unused)
+{
+    struct scmi_clk_provider *provider = s->private;
+    struct scmi_clock_xfer_stats st;
+    
+    provider->ops->rate_xfer_stats(provider->ph, &st);
+    
+    seq_printf(s, "fast_xfers: %llu\n", st.fast_xfers);
+    seq_printf(s, "fast_ns:    %llu\n",
+               st.fast_xfers ? div64_u64(st.fast_ns, st.fast_xfers) : 0);
+    seq_printf(s, "slow_xfers: %llu\n", st.slow_xfers);
+    seq_printf(s, "slow_ns:    %llu\n",
+               st.slow_xfers ? div64_u64(st.slow_ns, st.slow_xfers) : 0);
+    seq_printf(s, "xfer_gets:  %llu\n", st.xfer_gets);
+    
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(scmi_clk_xfer_stats);
+
+/* rate_tables：已解碼的頻率表、共用的時鐘數與取得它們的訊息數 */
+static int scmi_clk_rate_tables_show(struct seq_file *s, void *unused)
+{
+    static const char * const type_names[] = {
+        [SCMI_CLK_TABLE_RANGE] = "range",
+        [SCMI_CLK_TABLE_ARITH] = "arith",
+        [SCMI_CLK_TABLE_LIST] = "list",
+    };
+    struct scmi_clk_provider *provider = s->private;
+    const struct scmi_clk_rate_table *t;
+    
+    seq_printf(s, "messages %u\n", provider->rate_table_msgs);
+    list_for_each_entry(t, &provider->rate_tables, node)
+        seq_printf(s, "clk%-4u %-5s rates=%u users=%u [%llu, %llu] step=%llu\n",
+                   t->owner, type_names[t->type], t->num_rates, t->users,
+                   t->min, t->max, t->step);
+    
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(scmi_clk_rate_tables);
+
+/*
+ * 以 SCP 回報的轉換成本設定 policy 的 transition_latency
+ * cpufreq-dt 只能從 DT clock-latency 取得固定值 (常缺漏而變成
+ * CPUFREQ_ETERNAL)；schedutil 在 governor 初始化時依此決定
+ * rate_limit_us，之後不再讀取，因此只在 CREATE_POLICY (governor 啟動前)
+ * 設定一次。之後的量測值變化從 debugfs transition_cost 讀取
+ */
+static void scmi_clk_update_policy(struct scmi_clk_provider *provider,
+                                   struct cpufreq_policy *policy)
+{
+    struct scmi_clk_data *sclk;
+    unsigned int latency;
+    struct clk_hw *hw;
+    int i;
+    
+    if (IS_ERR_OR_NULL(policy->clk))
+        return;
+    
+    hw = __clk_get_hw(policy->clk);
+    for (i = 0; i < provider->num_clocks; i++) {
+        sclk = &provider->clks[i];
+        if (&sclk->hw != hw || !sclk->has_cost)
+            continue;
+        
+        scmi_clk_update_cost(sclk);
+        latency = scmi_clk_transition_latency_ns(sclk);
+        
+        /* 只放寬、不縮短 cpufreq driver 自己給的值 */
+        if (policy->cpuinfo.transition_latency == CPUFREQ_ETERNAL ||
+            policy->cpuinfo.transition_latency < latency) {
+            dev_info(provider->dev,
+                     "CPU%u transition latency from %s: %u ns\n",
+                     policy->cpu, sclk->name, latency);
+            policy->cpuinfo.transition_latency = latency;
+        }
+        return;
+    }
+}
+
+static int scmi_clk_cpufreq_notify(struct notifier_block *nb,
+                                   unsigned long event, void *data)
+{
+    struct scmi_clk_provider *provider =
+        container_of(nb, struct scmi_clk_provider, cpufreq_nb);
+    
+    if (event == CPUFREQ_CREATE_POLICY)
+        scmi_clk_update_policy(provider, data);
+    
+    return NOTIFY_OK;
+}
+
+static void scmi_clk_cpufreq_unregister(void *data)
+{
+    struct scmi_clk_provider *provider = data;
+    
+    cpufreq_unregister_notifier(&provider->cpufreq_nb,
+                                CPUFREQ_POLICY_NOTIFIER);
+}
+
+/*
+ * 必須在 devm_of_clk_add_hw_provider 之前呼叫：使用這些時鐘的
+ * cpufreq policy 要等 clk_get 成功才會建立，因此一定晚於此 notifier，
+ * CREATE_POLICY 時 governor 尚未啟動
+ */
+static int scmi_clk_cpufreq_register(struct scmi_clk_provider *provider)
+{
+    int ret;
+    
+    provider->cpufreq_nb.notifier_call = scmi_clk_cpufreq_notify;
+    ret = cpufreq_register_notifier(&provider->cpufreq_nb,
+                                    CPUFREQ_POLICY_NOTIFIER);
+    if (ret)
+        return ret;
+    
+    return devm_add_action_or_reset(provider->dev, scmi_clk_cpufreq_unregister,
+                                    provider);
+}
+
+/*
+ * 以 STATE_SNAPSHOT 廠商命令讀取整份時鐘狀態
+ * (協議端的 op 見 scmi_clock_vendor_example.c)
+ * 每個 SCMI 回應最多帶一頁 (受 shmem 大小限制)，
+ * 第一頁與最後一頁的 generation 相同才代表整份快照一致
+ */
+static int scmi_clk_take_snapshot(struct scmi_clk_provider *provider,
+                                  struct scmi_clk_snapshot_record *records)
+{
+    struct scmi_clock_state states[SCMI_CLK_SNAPSHOT_PAGE];
+    u32 first, returned, gen_first = 0, gen;
+    int ret, i, retry;
+    
+    if (!provider->ops->state_snapshot)
+        return -EOPNOTSUPP;
+    
+    for (retry = 0; retry < SCMI_CLK_SNAPSHOT_RETRIES; retry++) {
+        for (first = 0; first < provider->num_clocks; first += returned) {
+            ret = provider->ops->state_snapshot(provider->ph, first,
+                                                provider->num_clocks - first,
+                                                states, ARRAY_SIZE(states),
+                                                &returned, &gen);
+            if (ret)
+                return ret;
+            if (!returned)
+                return -EPROTO;
+            
+            if (first == 0)
+                gen_first = gen;
+            
+            for (i = 0; i < returned; i++) {
+                struct scmi_clk_snapshot_record *rec = &records[first + i];
+                
+                rec->id = cpu_to_le32(states[i].id);
+                rec->flags = cpu_to_le32(SCMI_CLK_SNAPSHOT_VALID |
+                                         (states[i].enabled ?
+                                          SCMI_CLK_SNAPSHOT_ENABLED : 0));
+                rec->rate = cpu_to_le64(states[i].rate);
+            }
+        }
+        
+        if (gen == gen_first)
+            return 0;
+        
+        dev_dbg(provider->dev, "Clock state changed during snapshot, retry\n");
+    }
+    
+    return -EAGAIN;
+}
+
+static int scmi_clk_snapshot_open(struct inode *inode, struct file *file)
+{
+    struct scmi_clk_provider *provider = inode->i_private;
+    struct scmi_clk_snapshot *snap;
+    int ret;
+    
+    snap = kvzalloc(struct_size(snap, records, provider->num_clocks),
+                    GFP_KERNEL);
+    if (!snap)
+        return -ENOMEM;
+    
+    /* 開檔時取一次快照，之後的 read 都讀同一份資料 */
+    ret = scmi_clk_take_snapshot(provider, snap->records);
+    if (ret) {
+        kvfree(snap);
+        return ret;
+    }
+    
+    snap->len = provider->num_clocks * sizeof(snap->records[0]);
+    file->private_data = snap;
+    
+    return 0;
 }
 
+static ssize_t scmi_clk_snapshot_read(struct file *file, char __user *buf,
+                                      size_t count, loff_t *ppos)
+{
+    struct scmi_clk_snapshot *snap = file->private_data;
+    
+    return simple_read_from_buffer(buf, count, ppos, snap->records,
+                                   snap->len);
+}
+
+static int scmi_clk_snapshot_release(struct inode *inode, struct file *file)
+{
+    kvfree(file->private_data);
+    return 0;
+}
+
+static const struct file_operations scmi_clk_snapshot_fops = {
+    .owner = THIS_MODULE,
+    .open = scmi_clk_snapshot_open,
+    .read = scmi_clk_snapshot_read,
+    .release = scmi_clk_snapshot_release,
+    .llseek = default_llseek,
+};
+
 /*
  * SCMI Clock Driver 主要 probe 函數
  */
@@ -293,7 +1163,12 @@ static int scmi_clocks_probe(struct scmi_device *sdev)
     if (!provider)
         return -ENOMEM;
     
-    /* 分配時鐘陣列 */
+    /*
+     * 一次配置所有時鐘物件 (連續、cache line 對齊)，
+     * 取代每個時鐘各自 devm_kzalloc 再以指標陣列間接存取。
+     * 註：陣列起始位址的對齊取決於 kmalloc (ARCH_KMALLOC_MINALIGN)，
+     * 元素間距則固定為 cache line 大小
+     */
     provider->clks = devm_kcalloc(dev, num_clocks, sizeof(*provider->clks),
                                  GFP_KERNEL);
     if (!provider->clks)
@@ -304,6 +1179,21 @@ static int scmi_clocks_probe(struct scmi_device *sdev)
     provider->ops = clk_ops;
     provider->num_clocks = num_clocks;
     provider->dev = dev;
+    provider->sdev = sdev;
+    INIT_LIST_HEAD(&provider->rate_tables);
+    
+    /* 通知合併用的 bitmap 與 work；停止 work 的動作在時鐘註冊後才加入 */
+    provider->notify_pending = devm_bitmap_zalloc(dev, num_clocks, GFP_KERNEL);
+    if (!provider->notify_pending)
+        return -ENOMEM;
+    
+    INIT_DELAYED_WORK(&provider->notify_work, scmi_clk_notify_work);
+    
+    if (clk_ops->rate_xfer_release) {
+        ret = devm_add_action_or_reset(dev, scmi_clk_release_xfers, provider);
+        if (ret)
+            return ret;
+    }
     
     /* 註冊所有時鐘 */
     for (i = 0; i < num_clocks; i++) {
@@ -312,6 +1202,20 @@ static int scmi_clocks_probe(struct scmi_device *sdev)
             dev_warn(dev, "Failed to register clock ID %d: %d\n", i, ret);
     }
     
+    /*
+     * devm 反向釋放：這個動作比時鐘與通知訂閱晚加入，會最先執行，
+     * work 停止後才取消訂閱、註銷時鐘，work 不會再碰到已註銷的時鐘
+     */
+    ret = devm_add_action_or_reset(dev, scmi_clk_disable_notify_work,
+                                   provider);
+    if (ret)
+        return ret;
+    
+    /* 轉換成本匯出給 cpufreq；失敗只影響 rate_limit 預設值 */
+    ret = scmi_clk_cpufreq_register(provider);
+    if (ret)
+        dev_warn(dev, "Failed to register cpufreq notifier: %d\n", ret);
+    
     /* 註冊 Clock Provider */
     ret = devm_of_clk_add_hw_provider(dev, scmi_clk_of_xlate, provider);
     if (ret) {
@@ -322,6 +1226,18 @@ static int scmi_clocks_probe(struct scmi_device *sdev)
     /* 儲存 provider 到 device data */
     dev_set_drvdata(dev, provider);
     
+    /* 一次交易取得所有時鐘狀態的 debugfs 介面 (遙測使用) */
+    provider->debugfs_dir = debugfs_create_dir(dev_name(dev),
+                                               scmi_clk_debugfs_root);
+    debugfs_create_file("clk_snapshot", 0400, provider->debugfs_dir,
+                        provider, &scmi_clk_snapshot_fops);
+    if (clk_ops->rate_xfer_stats)
+        debugfs_create_file("xfer_stats", 0400, provider->debugfs_dir,
+                            provider, &scmi_clk_xfer_stats_fops);
+    if (clk_ops->describe_rates_compact)
+        debugfs_create_file("rate_tables", 0400, provider->debugfs_dir,
+                            provider, &scmi_clk_rate_tables_fops);
+    
     dev_info(dev, "SCMI Clock Driver probe completed successfully\n");
     
     return 0;
@@ -329,6 +1245,9 @@ static int scmi_clocks_probe(struct scmi_device *sdev)
 
 static void scmi_clocks_remove(struct scmi_device *sdev)
 {
+    struct scmi_clk_provider *provider = dev_get_drvdata(&sdev->dev);
+    
+    debugfs_remove_recursive(provider->debugfs_dir);
     dev_info(&sdev->dev, "SCMI Clock Driver removed\n");
 }
 
@@ -352,15 +1271,26 @@ static struct scmi_driver scmi_clocks_driver = {
  */
 static int __init scmi_clocks_init(void)
 {
+    int ret;
+    
     pr_info("SCMI Clock Driver initializing...\n");
-    return scmi_driver_register(&scmi_clocks_driver, THIS_MODULE, 
+    
+    /* 每個 provider 的 debugfs 目錄放在 <debugfs>/scmi-clocks/ 之下 */
+    scmi_clk_debugfs_root = debugfs_create_dir(scmi_clocks_driver.name, NULL);
+    
+    ret = scmi_driver_register(&scmi_clocks_driver, THIS_MODULE, 
                                KBUILD_MODNAME);
+    if (ret)
+        debugfs_remove_recursive(scmi_clk_debugfs_root);
+    
+    return ret;
 }
 
 static void __exit scmi_clocks_exit(void)
 {
     pr_info("SCMI Clock Driver exiting...\n");
     scmi_driver_unregister(&scmi_clocks_driver);
+    debugfs_remove_recursive(scmi_clk_debugfs_root);
 }
 
 module_init(scmi_clocks_init);
@@ -371,18 +1301,52 @@ MODULE_DESCRIPTION("SCMI Clock Driver Example");
 MODULE_LICENSE("GPL v2");
 MODULE_VERSION("1.0");
 
+#if IS_ENABLED(CONFIG_COMMON_CLK_SCMI_KUNIT_TEST)
+#include "scmi_clock_kunit.c"
+#endif
+
 /*
  * 使用範例：
  * 
  * 1. Device Tree 配置：
  *    clocks = <&scmi_clk 0>; // 使用 SCMI clock ID 0
  * 
+ *    CPU DVFS 走 PERF 協議的專用通道 (shmem 依序為 A2P、P2A)：
+ *    scmi_dvfs: protocol@13 {
+ *        reg = <0x13>;
+ *        #clock-cells = <1>;
+ *        mboxes = <&mhu 0 1>, <&mhu 1 1>;
+ *        shmem = <&cpu_scp_hpri0>, <&scp_cpu_hpri0>;
+ *    };
+ *    scmi_clk: protocol@14 {           // 共用 scmi 節點的預設通道
+ *        reg = <0x14>;
+ *        #clock-cells = <1>;
+ *        arm,high-priority-clocks = <4 9>;
+ *    };
+ * 
  * 2. 在其他 driver 中使用：
  *    struct clk *clk = devm_clk_get(dev, "scmi-clock");
  *    clk_set_rate(clk, 100000000); // 設定為 100MHz
  *    clk_enable(clk);
  * 
- * 3. 通訊流程：
+ * 3. 讀取所有時鐘狀態 (每頁一次 SCMI 交易，128-byte 通道每頁 7 筆，
+ *    16 顆時鐘讀 3 頁)：
+ *    cat /sys/kernel/debug/scmi-clocks/<scmi-clock-dev>/clk_snapshot > snap.bin
+ *    每筆 16 bytes：le32 id, le32 flags (bit0 enabled, bit1 valid), le64 rate
+ * 
+ *    預先配置 xfer 的效果 (xfer_gets 為 xfer_get_init 次數，兩條路徑的
+ *    平均時間都含 do_xfer；KUnit benchmark 見 scmi_clock_xfer_cache_kunit.c)：
+ *    cat /sys/kernel/debug/scmi-clocks/<scmi-clock-dev>/xfer_stats
+ * 
+ *    共用的頻率表 (雜湊、格式、共用的時鐘數) 與 probe 時的訊息數：
+ *    cat /sys/kernel/debug/scmi-clocks/<scmi-clock-dev>/rate_tables
+ * 
+ *    單一時鐘的轉換成本 (平台設定值與 SCP 量測值)：
+ *    cat /sys/kernel/debug/clk/<clock-name>/transition_cost
+ *    CPU 時鐘的 relock 延遲也會寫入
+ *    /sys/devices/system/cpu/cpufreq/policyN/cpuinfo_transition_latency
+ * 
+ * 4. 通訊流程：
  *    clk_set_rate() -> scmi_clk_set_rate() -> 
  *    clk_ops->rate_set() -> SCMI protocol -> 
  *    SCP firmware -> 實際硬體設定
@@ -0,0 +1,748 @@
+/*
+ * KUnit tests and per-op overhead checks for the SCMI clock driver
+ * (scmi_clock_example.c)
+ *
+ * 以 mock 的 scmi_handle / scmi_clk_proto_ops 執行真正的
+ * scmi_clocks_probe()：count_get/info_get 回傳可設定的頻率表 (偶數 ID
+ * 為離散表，奇數 ID 為連續範圍；也可改由 DESCRIBE_RATES_COMPACT 提供)，rate_get/rate_set 以 ndelay() 模擬
+ * 通道延遲，並可讓 rate_set 先回 -EBUSY 數次。通知的訂閱被記錄下來，
+ * 測試直接呼叫 notifier 模擬 SCP 送來的 CLOCK_RATE_CHANGED。
+ *
+ * 本檔由 scmi_clock_example.c 檔尾引入 (需要存取 static 的 probe 與
+ * clk_ops)，兩者放在同一目錄 (例如 drivers/clk/)：
+ *   #if IS_ENABLED(CONFIG_COMMON_CLK_SCMI_KUNIT_TEST)
+ *   #include "scmi_clock_kunit.c"
+ *   #endif
+ *
+ * Kconfig：
+ *   config COMMON_CLK_SCMI_KUNIT_TEST
+ *       tristate "KUnit tests for the SCMI clock driver" if !KUNIT_ALL_TESTS
+ *       depends on KUNIT && COMMON_CLK_SCMI
+ *       default KUNIT_ALL_TESTS
+ *
+ * 執行：
+ *   ./tools/testing/kunit/kunit.py run --arch=arm64 \
+ *       --kconfig_add CONFIG_ARM_SCMI_PROTOCOL=y \
+ *       --kconfig_add CONFIG_COMMON_CLK_SCMI=y \
+ *       --kconfig_add CONFIG_COMMON_CLK_SCMI_KUNIT_TEST=y \
+ *       'scmi-clocks*'
+ *
+ * 耗時門檻是 qemu arm64 上量到的值再留約 4 倍餘裕，只用來擋下數量級的
+ * 退化 (例如熱路徑多了一次 SCMI 訊息或 printk)；訊息數則精確比對。
+ */
+
+#include <kunit/test.h>
+#include <linux/clk.h>
+#include <linux/device.h>
+#include <linux/ktime.h>
+
+/* struct scmi_protocol_handle 的定義 (mock 需要填 ph->dev) */
+#include "../firmware/arm_scmi/protocols.h"
+
+/* 每個 op 的驅動端耗時上限 (不含 mock 的通道延遲) */
+#define SCMI_CLK_KUNIT_ROUND_NS         2000
+#define SCMI_CLK_KUNIT_SET_NS           5000
+#define SCMI_CLK_KUNIT_RECALC_NS        3000
+/* probe 每個時鐘的上限，含 clock framework 註冊與 debugfs */
+#define SCMI_CLK_KUNIT_PROBE_CLK_NS     (200 * NSEC_PER_USEC)
+
+#define SCMI_CLK_KUNIT_ITERATIONS       2000
+
+#define MOCK_DISCRETE_RATES             4
+#define MOCK_RANGE_MIN                  24000000ULL
+#define MOCK_RANGE_MAX                  1200000000ULL
+#define MOCK_RANGE_STEP                 1000000ULL
+
+static const u64 mock_discrete_rates[MOCK_DISCRETE_RATES] = {
+    100000000, 200000000, 400000000, 800000000,
+};
+
+struct scmi_clk_mock {
+    struct scmi_device sdev;
+    struct scmi_handle handle;
+    struct scmi_notify_ops notify_ops;
+    struct scmi_protocol_handle ph;
+    struct scmi_clk_proto_ops ops;
+
+    unsigned int num_clocks;
+    struct scmi_clock_info *info;
+    /* SCP 端目前的頻率 */
+    u64 *rate;
+    /* 每顆時鐘訂閱的 CLOCK_RATE_CHANGED notifier */
+    struct notifier_block **nbs;
+
+    /* rate_get/rate_set 的模擬通道延遲 */
+    u32 latency_ns;
+    /* 之後的 rate_set 先回幾次 -EBUSY */
+    unsigned int busy_count;
+    bool probed;
+
+    /* 呼叫次數 */
+    unsigned int info_gets;
+    unsigned int rate_gets;
+    unsigned int rate_sets;
+    unsigned int busy_returned;
+    unsigned int compact_msgs;
+    unsigned int describe_calls;
+};
+
+/* 每次建立 mock 遞增，時鐘名稱不與尚未釋放的上一組衝突 */
+static atomic_t scmi_clk_mock_gen = ATOMIC_INIT(0);
+
+static struct scmi_clk_mock *ph_to_mock(const struct scmi_protocol_handle *ph)
+{
+    return container_of(ph, struct scmi_clk_mock, ph);
+}
+
+static struct scmi_clk_mock *sdev_to_mock(struct scmi_device *sdev)
+{
+    return container_of(sdev, struct scmi_clk_mock, sdev);
+}
+
+static int mock_count_get(const struct scmi_protocol_handle *ph)
+{
+    return ph_to_mock(ph)->num_clocks;
+}
+
+/* info_get 在協議層是查表，不送訊息，因此不加延遲 */
+static const struct scmi_clock_info *
+mock_info_get(const struct scmi_protocol_handle *ph, u32 clk_id)
+{
+    struct scmi_clk_mock *mock = ph_to_mock(ph);
+
+    if (clk_id >= mock->num_clocks)
+        return NULL;
+
+    mock->info_gets++;
+
+    return &mock->info[clk_id];
+}
+
+static int mock_rate_get(const struct scmi_protocol_handle *ph, u32 clk_id,
+                         u64 *rate)
+{
+    struct scmi_clk_mock *mock = ph_to_mock(ph);
+
+    mock->rate_gets++;
+    if (mock->latency_ns)
+        ndelay(mock->latency_ns);
+
+    *rate = mock->rate[clk_id];
+
+    return 0;
+}
+
+static int mock_rate_set(const struct scmi_protocol_handle *ph, u32 clk_id,
+                         u64 rate)
+{
+    struct scmi_clk_mock *mock = ph_to_mock(ph);
+
+    mock->rate_sets++;
+    if (mock->latency_ns)
+        ndelay(mock->latency_ns);
+
+    if (mock->busy_count) {
+        mock->busy_count--;
+        mock->busy_returned++;
+        return -EBUSY;
+    }
+
+    mock->rate[clk_id] = rate;
+
+    return 0;
+}
+
+static int mock_enable(const struct scmi_protocol_handle *ph, u32 clk_id)
+{
+    return 0;
+}
+
+static int mock_disable(const struct scmi_protocol_handle *ph, u32 clk_id)
+{
+    return 0;
+}
+
+/*
+ * DESCRIBE_RATES_COMPACT：離散表以差值格式分頁 (每頁 MOCK_COMPACT_PAGE
+ * 個差值)，連續範圍以三元組；內容相同的表 same_as 指向 clock 0 或 1
+ */
+#define MOCK_COMPACT_PAGE 2
+
+static int mock_describe_rates_compact(const struct scmi_protocol_handle *ph,
+                                       u32 clk_id, u32 index,
+                                       struct scmi_clock_rates_compact *page)
+{
+    struct scmi_clk_mock *mock = ph_to_mock(ph);
+    unsigned int i;
+
+    mock->compact_msgs++;
+    memset(page, 0, sizeof(*page));
+    page->same_as = clk_id % 2;
+
+    if (clk_id % 2) {
+        page->format = SCMI_CLOCK_RATES_TRIPLET;
+        page->base = MOCK_RANGE_MIN;
+        page->values[0] = lower_32_bits(MOCK_RANGE_MAX);
+        page->values[1] = upper_32_bits(MOCK_RANGE_MAX);
+        page->values[2] = lower_32_bits(MOCK_RANGE_STEP);
+        page->values[3] = upper_32_bits(MOCK_RANGE_STEP);
+        page->num_values = 4;
+        return 0;
+    }
+
+    if (index >= MOCK_DISCRETE_RATES)
+        return -EINVAL;
+
+    page->format = SCMI_CLOCK_RATES_DELTA;
+    page->discrete = true;
+    page->total_rates = MOCK_DISCRETE_RATES;
+    page->base = mock_discrete_rates[index];
+    for (i = 0; i < MOCK_COMPACT_PAGE &&
+                index + i + 1 < MOCK_DISCRETE_RATES; i++)
+        page->values[i] = mock_discrete_rates[index + i + 1] -
+                          mock_discrete_rates[index + i];
+    page->num_values = i;
+    page->remaining = MOCK_DISCRETE_RATES - (index + i + 1);
+
+    return 0;
+}
+
+static int mock_describe_rates(const struct scmi_protocol_handle *ph,
+                               u32 clk_id)
+{
+    ph_to_mock(ph)->describe_calls++;
+
+    return 0;
+}
+
+static const void *mock_devm_protocol_get(struct scmi_device *sdev, u8 proto,
+                                          struct scmi_protocol_handle **ph)
+{
+    struct scmi_clk_mock *mock = sdev_to_mock(sdev);
+
+    if (proto != SCMI_PROTOCOL_CLOCK)
+        return ERR_PTR(-EPROTONOSUPPORT);
+
+    *ph = &mock->ph;
+
+    return &mock->ops;
+}
+
+static int mock_devm_event_notifier_register(struct scmi_device *sdev,
+                                             u8 proto_id, u8 evt_id,
+                                             const u32 *src_id,
+                                             struct notifier_block *nb)
+{
+    struct scmi_clk_mock *mock = sdev_to_mock(sdev);
+
+    if (proto_id != SCMI_PROTOCOL_CLOCK ||
+        evt_id != SCMI_EVENT_CLOCK_RATE_CHANGED ||
+        !src_id || *src_id >= mock->num_clocks)
+        return -EINVAL;
+
+    mock->nbs[*src_id] = nb;
+
+    return 0;
+}
+
+/* 最後一個參考釋放時才釋放 mock；devres (時鐘、notifier) 在這之前已釋放 */
+static void mock_release(struct device *dev)
+{
+    struct scmi_clk_mock *mock = sdev_to_mock(to_scmi_dev(dev));
+
+    kfree(mock->nbs);
+    kfree(mock->rate);
+    kfree(mock->info);
+    kfree(mock);
+}
+
+static void mock_destroy(void *data)
+{
+    struct scmi_clk_mock *mock = data;
+
+    if (mock->probed)
+        scmi_clocks_remove(&mock->sdev);
+
+    device_unregister(&mock->sdev.dev);
+}
+
+static void mock_fill_info(struct scmi_clk_mock *mock, unsigned int gen)
+{
+    struct scmi_clock_info *info;
+    unsigned int i;
+
+    for (i = 0; i < mock->num_clocks; i++) {
+        info = &mock->info[i];
+        snprintf(info->name, sizeof(info->name), "kunit-scmi-%u-%u", gen, i);
+        info->rate_changed_notifications = true;
+
+        if (i % 2 == 0) {
+            info->rate_discrete = true;
+            info->list.num_rates = MOCK_DISCRETE_RATES;
+            memcpy(info->list.rates, mock_discrete_rates,
+                   sizeof(mock_discrete_rates));
+            mock->rate[i] = mock_discrete_rates[0];
+        } else {
+            info->range.min_rate = MOCK_RANGE_MIN;
+            info->range.max_rate = MOCK_RANGE_MAX;
+            info->range.step_size = MOCK_RANGE_STEP;
+            mock->rate[i] = MOCK_RANGE_MIN;
+        }
+        /* SCP 在 CLOCK_ATTRIBUTES 回報的開機頻率 */
+        info->initial_rate = mock->rate[i];
+    }
+}
+
+static struct scmi_clk_mock *scmi_clk_mock_create(struct kunit *test,
+                                                  unsigned int num_clocks,
+                                                  u32 latency_ns)
+{
+    struct scmi_clk_mock *mock;
+    unsigned int gen = atomic_inc_return(&scmi_clk_mock_gen);
+    int ret;
+
+    /* 生命週期跟著 struct device，不用 kunit_kzalloc */
+    mock = kzalloc(sizeof(*mock), GFP_KERNEL);
+    KUNIT_ASSERT_NOT_NULL(test, mock);
+
+    mock->num_clocks = num_clocks;
+    mock->latency_ns = latency_ns;
+    mock->info = kcalloc(num_clocks, sizeof(*mock->info), GFP_KERNEL);
+    mock->rate = kcalloc(num_clocks, sizeof(*mock->rate), GFP_KERNEL);
+    mock->nbs = kcalloc(num_clocks, sizeof(*mock->nbs), GFP_KERNEL);
+
+    device_initialize(&mock->sdev.dev);
+    mock->sdev.dev.release = mock_release;
+    if (!mock->info || !mock->rate || !mock->nbs) {
+        put_device(&mock->sdev.dev);
+        KUNIT_ASSERT_FAILURE(test, "out of memory");
+    }
+
+    mock_fill_info(mock, gen);
+
+    mock->ops.count_get = mock_count_get;
+    mock->ops.info_get = mock_info_get;
+    mock->ops.rate_get = mock_rate_get;
+    mock->ops.rate_set = mock_rate_set;
+    mock->ops.enable = mock_enable;
+    mock->ops.disable = mock_disable;
+
+    mock->notify_ops.devm_event_notifier_register =
+        mock_devm_event_notifier_register;
+    mock->handle.devm_protocol_get = mock_devm_protocol_get;
+    mock->handle.notify_ops = &mock->notify_ops;
+
+    mock->sdev.handle = &mock->handle;
+    mock->sdev.protocol_id = SCMI_PROTOCOL_CLOCK;
+    mock->sdev.name = "scmi-clocks";
+    mock->ph.dev = &mock->sdev.dev;
+
+    dev_set_name(&mock->sdev.dev, "kunit-scmi-clocks.%u", gen);
+    ret = device_add(&mock->sdev.dev);
+    if (ret) {
+        put_device(&mock->sdev.dev);
+        KUNIT_ASSERT_FAILURE(test, "device_add: %d", ret);
+    }
+
+    ret = kunit_add_action_or_reset(test, mock_destroy, mock);
+    KUNIT_ASSERT_EQ(test, ret, 0);
+
+    return mock;
+}
+
+static struct scmi_clk_provider *scmi_clk_mock_probe(struct kunit *test,
+                                                     struct scmi_clk_mock *mock)
+{
+    KUNIT_ASSERT_EQ(test, scmi_clocks_probe(&mock->sdev), 0);
+    mock->probed = true;
+
+    return dev_get_drvdata(&mock->sdev.dev);
+}
+
+KUNIT_DEFINE_ACTION_WRAPPER(scmi_clk_kunit_clk_put, clk_put, struct clk *);
+
+static struct clk *scmi_clk_mock_get_clk(struct kunit *test,
+                                         struct scmi_clk_provider *provider,
+                                         unsigned int id)
+{
+    struct clk *clk = clk_hw_get_clk(&provider->clks[id].hw, "kunit");
+
+    KUNIT_ASSERT_NOT_ERR_OR_NULL(test, clk);
+    KUNIT_ASSERT_EQ(test, kunit_add_action_or_reset(test,
+                    scmi_clk_kunit_clk_put, clk), 0);
+
+    return clk;
+}
+
+/* 模擬 SCP 自行改變頻率並送出 CLOCK_RATE_CHANGED */
+static void scmi_clk_mock_notify(struct kunit *test, struct scmi_clk_mock *mock,
+                                 u32 id, u64 rate)
+{
+    struct scmi_clock_rate_notif_report r = {
+        .timestamp = ktime_get(),
+        .clock_id = id,
+        .rate = rate,
+    };
+    struct notifier_block *nb = mock->nbs[id];
+
+    KUNIT_ASSERT_NOT_NULL(test, nb);
+
+    mock->rate[id] = rate;
+    nb->notifier_call(nb, SCMI_EVENT_CLOCK_RATE_CHANGED, &r);
+}
+
+struct scmi_clk_kunit_param {
+    unsigned int num_clocks;
+    u32 latency_ns;
+    const char *desc;
+};
+
+static const struct scmi_clk_kunit_param scmi_clk_kunit_params[] = {
+    { 4, 0, "4 clocks" },
+    { 64, 0, "64 clocks" },
+    { 256, 0, "256 clocks" },
+    { 64, 2000, "64 clocks, 2us channel" },
+};
+
+static void scmi_clk_kunit_param_desc(const struct scmi_clk_kunit_param *p,
+                                      char *desc)
+{
+    strscpy(desc, p->desc, KUNIT_PARAM_DESC_SIZE);
+}
+
+KUNIT_ARRAY_PARAM(scmi_clk_kunit, scmi_clk_kunit_params,
+                  scmi_clk_kunit_param_desc);
+
+/*
+ * probe：每顆時鐘都註冊並訂閱通知，註冊時的 recalc 是唯一的訊息；
+ * 以時鐘數量為參數量測 probe 時間
+ */
+static void scmi_clk_test_probe(struct kunit *test)
+{
+    const struct scmi_clk_kunit_param *p = test->param_value;
+    struct scmi_clk_provider *provider;
+    struct scmi_clk_mock *mock;
+    unsigned int i;
+    u64 start, elapsed;
+
+    mock = scmi_clk_mock_create(test, p->num_clocks, p->latency_ns);
+
+    start = ktime_get_ns();
+    provider = scmi_clk_mock_probe(test, mock);
+    elapsed = ktime_get_ns() - start;
+
+    KUNIT_ASSERT_NOT_NULL(test, provider);
+    KUNIT_EXPECT_EQ(test, provider->num_clocks, p->num_clocks);
+
+    for (i = 0; i < p->num_clocks; i++) {
+        KUNIT_EXPECT_TRUE(test, provider->clks[i].registered);
+        KUNIT_EXPECT_PTR_EQ(test, mock->nbs[i], &provider->clks[i].nb);
+    }
+
+    KUNIT_EXPECT_EQ(test, mock->info_gets, p->num_clocks);
+    /* 頻率快取以 CLOCK_ATTRIBUTES 的開機頻率為初值，註冊時不送 RATE_GET */
+    KUNIT_EXPECT_EQ(test, mock->rate_gets, 0);
+    KUNIT_EXPECT_EQ(test, mock->rate_sets, 0);
+
+    kunit_info(test, "probe %u clocks: %llu us (%llu ns/clock)\n",
+               p->num_clocks, div_u64(elapsed, NSEC_PER_USEC),
+               div_u64(elapsed, p->num_clocks));
+    KUNIT_EXPECT_LT(test, div_u64(elapsed, p->num_clocks),
+                    (u64)SCMI_CLK_KUNIT_PROBE_CLK_NS +
+                    p->latency_ns);
+}
+
+/* round_rate：離散表取最接近的頻率，連續範圍夾在 [min, max] 內 */
+static void scmi_clk_test_round_rate(struct kunit *test)
+{
+    struct scmi_clk_provider *provider;
+    struct scmi_clk_mock *mock;
+    struct clk *discrete, *range;
+    unsigned int sent;
+
+    mock = scmi_clk_mock_create(test, 2, 0);
+    provider = scmi_clk_mock_probe(test, mock);
+    discrete = scmi_clk_mock_get_clk(test, provider, 0);
+    range = scmi_clk_mock_get_clk(test, provider, 1);
+    sent = mock->rate_gets + mock->rate_sets;
+
+    KUNIT_EXPECT_EQ(test, clk_round_rate(discrete, 50000000), 100000000);
+    KUNIT_EXPECT_EQ(test, clk_round_rate(discrete, 290000000), 200000000);
+    KUNIT_EXPECT_EQ(test, clk_round_rate(discrete, 310000000), 400000000);
+    /* 與兩側等距時取較低者 */
+    KUNIT_EXPECT_EQ(test, clk_round_rate(discrete, 300000000), 200000000);
+    KUNIT_EXPECT_EQ(test, clk_round_rate(discrete, 5000000000UL), 800000000);
+
+    KUNIT_EXPECT_EQ(test, clk_round_rate(range, 1000000), MOCK_RANGE_MIN);
+    KUNIT_EXPECT_EQ(test, clk_round_rate(range, 333000000), 333000000);
+    KUNIT_EXPECT_EQ(test, clk_round_rate(range, 2000000000UL), MOCK_RANGE_MAX);
+
+    /* round_rate 只查表，不送訊息 */
+    KUNIT_EXPECT_EQ(test, mock->rate_gets + mock->rate_sets, sent);
+}
+
+/*
+ * SCP 回 BUSY 時退避重送，超過次數上限才回傳 -EBUSY
+ * (clk_change_rate() 不檢查 set_rate 的回傳值，失敗的情況直接呼叫 op)
+ */
+static void scmi_clk_test_set_rate_busy(struct kunit *test)
+{
+    struct scmi_clk_provider *provider;
+    struct scmi_clk_mock *mock;
+    struct clk *clk;
+
+    mock = scmi_clk_mock_create(test, 2, 0);
+    provider = scmi_clk_mock_probe(test, mock);
+    clk = scmi_clk_mock_get_clk(test, provider, 0);
+
+    mock->rate_sets = 0;
+    mock->busy_count = SCMI_CLK_BUSY_RETRIES;
+    KUNIT_EXPECT_EQ(test, clk_set_rate(clk, 400000000), 0);
+    KUNIT_EXPECT_EQ(test, mock->rate_sets, SCMI_CLK_BUSY_RETRIES + 1);
+    KUNIT_EXPECT_EQ(test, mock->busy_returned, SCMI_CLK_BUSY_RETRIES);
+    KUNIT_EXPECT_EQ(test, clk_get_rate(clk), 400000000);
+
+    mock->rate_sets = 0;
+    mock->busy_returned = 0;
+    mock->busy_count = SCMI_CLK_BUSY_RETRIES + 1;
+    KUNIT_EXPECT_EQ(test, scmi_clk_ops.set_rate(&provider->clks[0].hw,
+                                                800000000, 0), -EBUSY);
+    KUNIT_EXPECT_EQ(test, mock->rate_sets, SCMI_CLK_BUSY_RETRIES + 1);
+    KUNIT_EXPECT_EQ(test, mock->rate[0], 400000000);
+    KUNIT_EXPECT_EQ(test, clk_get_rate(clk), 400000000);
+}
+
+struct scmi_clk_kunit_consumer {
+    struct notifier_block nb;
+    unsigned int post_changes;
+    unsigned long last_rate;
+};
+
+static int scmi_clk_kunit_consumer_notify(struct notifier_block *nb,
+                                          unsigned long event, void *data)
+{
+    struct scmi_clk_kunit_consumer *c =
+        container_of(nb, struct scmi_clk_kunit_consumer, nb);
+    struct clk_notifier_data *cnd = data;
+
+    if (event == POST_RATE_CHANGE) {
+        c->post_changes++;
+        c->last_rate = cnd->new_rate;
+    }
+
+    return NOTIFY_OK;
+}
+
+/*
+ * 通知：合併視窗內同一顆時鐘的多則通知只送一次 POST_RATE_CHANGE，
+ * 頻率取自通知、不送 RATE_GET，其他時鐘各自同步
+ */
+static void scmi_clk_test_notify(struct kunit *test)
+{
+    struct scmi_clk_kunit_consumer consumer = {
+        .nb.notifier_call = scmi_clk_kunit_consumer_notify,
+    };
+    struct scmi_clk_provider *provider;
+    struct scmi_clk_mock *mock;
+    unsigned int gets;
+    struct clk *clk;
+
+    mock = scmi_clk_mock_create(test, 4, 0);
+    provider = scmi_clk_mock_probe(test, mock);
+    clk = scmi_clk_mock_get_clk(test, provider, 1);
+    KUNIT_ASSERT_EQ(test, clk_notifier_register(clk, &consumer.nb), 0);
+
+    gets = mock->rate_gets;
+    scmi_clk_mock_notify(test, mock, 1, 100000000);
+    scmi_clk_mock_notify(test, mock, 1, 200000000);
+    scmi_clk_mock_notify(test, mock, 1, 300000000);
+    scmi_clk_mock_notify(test, mock, 2, 800000000);
+
+    KUNIT_EXPECT_TRUE(test, test_bit(1, provider->notify_pending));
+    KUNIT_EXPECT_TRUE(test, test_bit(2, provider->notify_pending));
+    KUNIT_EXPECT_EQ(test, atomic64_read(&provider->clks[1].notified_rate),
+                    300000000);
+
+    flush_delayed_work(&provider->notify_work);
+
+    KUNIT_EXPECT_FALSE(test, test_bit(1, provider->notify_pending));
+    KUNIT_EXPECT_FALSE(test, test_bit(2, provider->notify_pending));
+    KUNIT_EXPECT_EQ(test, mock->rate_gets - gets, 0);
+    KUNIT_EXPECT_EQ(test, consumer.post_changes, 1);
+    KUNIT_EXPECT_EQ(test, consumer.last_rate, 300000000);
+    KUNIT_EXPECT_EQ(test, provider->clks[2].rate, 800000000);
+
+    clk_notifier_unregister(clk, &consumer.nb);
+}
+
+/*
+ * 頻率快取：有通知的時鐘 clk_get_rate() 不送 RATE_GET，RATE_SET 之後
+ * 讀回一次實際頻率；沒有通知的時鐘每次都向 SCP 讀回
+ */
+static void scmi_clk_test_rate_cache(struct kunit *test)
+{
+    struct scmi_clk_provider *provider;
+    struct scmi_clk_mock *mock;
+    struct clk *notified, *polled;
+    unsigned int i, gets;
+
+    mock = scmi_clk_mock_create(test, 2, 0);
+    mock->info[1].rate_changed_notifications = false;
+    provider = scmi_clk_mock_probe(test, mock);
+    notified = scmi_clk_mock_get_clk(test, provider, 0);
+    polled = scmi_clk_mock_get_clk(test, provider, 1);
+
+    /* 只有沒有通知的時鐘在註冊時讀回 */
+    KUNIT_EXPECT_EQ(test, mock->rate_gets, 1);
+    KUNIT_EXPECT_TRUE(test, provider->clks[0].rate_cached);
+    KUNIT_EXPECT_FALSE(test, provider->clks[1].rate_cached);
+
+    gets = mock->rate_gets;
+    for (i = 0; i < 4; i++)
+        KUNIT_EXPECT_EQ(test, clk_get_rate(notified), mock->rate[0]);
+    KUNIT_EXPECT_EQ(test, mock->rate_gets, gets);
+
+    for (i = 0; i < 4; i++)
+        KUNIT_EXPECT_EQ(test, clk_get_rate(polled), mock->rate[1]);
+    KUNIT_EXPECT_EQ(test, mock->rate_gets - gets, 4);
+
+    gets = mock->rate_gets;
+    KUNIT_ASSERT_EQ(test, clk_set_rate(notified, 400000000), 0);
+    KUNIT_EXPECT_EQ(test, mock->rate_gets - gets, 1);
+    KUNIT_EXPECT_EQ(test, clk_get_rate(notified), 400000000);
+    KUNIT_EXPECT_EQ(test, mock->rate_gets - gets, 1);
+}
+
+/*
+ * compact 頻率表：每張表只有第一個使用它的時鐘逐頁讀取，
+ * 其餘時鐘依 same_as 只讀第一頁就共用；round_rate 結果與 info 路徑相同
+ */
+static void scmi_clk_test_rate_table_share(struct kunit *test)
+{
+    struct scmi_clk_provider *provider;
+    struct scmi_clk_rate_table *t;
+    struct scmi_clk_mock *mock;
+    unsigned int i, tables = 0;
+    struct clk *discrete;
+
+    mock = scmi_clk_mock_create(test, 8, 0);
+    mock->ops.describe_rates_compact = mock_describe_rates_compact;
+    mock->ops.describe_rates = mock_describe_rates;
+    provider = scmi_clk_mock_probe(test, mock);
+
+    /* clock 0 兩頁 (4 個頻率、每頁 1 + 2 個)，其餘時鐘各一頁 */
+    KUNIT_EXPECT_EQ(test, mock->compact_msgs, 2 + 7);
+    KUNIT_EXPECT_EQ(test, provider->rate_table_msgs, mock->compact_msgs);
+    KUNIT_EXPECT_EQ(test, mock->describe_calls, 0);
+
+    list_for_each_entry(t, &provider->rate_tables, node) {
+        KUNIT_EXPECT_EQ(test, t->users, 4);
+        tables++;
+    }
+    KUNIT_EXPECT_EQ(test, tables, 2);
+
+    for (i = 2; i < 8; i++)
+        KUNIT_EXPECT_PTR_EQ(test, provider->clks[i].rates,
+                            provider->clks[i % 2].rates);
+
+    t = provider->clks[0].rates;
+    KUNIT_ASSERT_NOT_NULL(test, t);
+    KUNIT_EXPECT_EQ(test, t->type, SCMI_CLK_TABLE_LIST);
+    for (i = 0; i < MOCK_DISCRETE_RATES; i++)
+        KUNIT_EXPECT_EQ(test, t->rates[i], mock_discrete_rates[i]);
+
+    discrete = scmi_clk_mock_get_clk(test, provider, 6);
+    KUNIT_EXPECT_EQ(test, clk_round_rate(discrete, 290000000), 200000000);
+    KUNIT_EXPECT_EQ(test, clk_round_rate(discrete, 310000000), 400000000);
+    KUNIT_EXPECT_EQ(test, clk_round_rate(discrete, 5000000000UL), 800000000);
+}
+
+/*
+ * 驅動端每個 op 的耗時：直接呼叫 clk_ops，扣掉 mock 的通道延遲，
+ * 並確認每次 op 送出的訊息數 (round 0、set 1、set 之後的 recalc 1、
+ * 快取命中的 recalc 0)
+ */
+static void scmi_clk_test_op_overhead(struct kunit *test)
+{
+    const struct scmi_clk_kunit_param *p = test->param_value;
+    struct scmi_clk_provider *provider;
+    struct scmi_clk_mock *mock;
+    unsigned long parent = 0;
+    u64 start, round_ns, set_ns, recalc_ns, cached_ns;
+    unsigned int i, sets, gets;
+    struct clk_hw *hw;
+
+    mock = scmi_clk_mock_create(test, p->num_clocks, p->latency_ns);
+    provider = scmi_clk_mock_probe(test, mock);
+    sets = mock->rate_sets;
+    gets = mock->rate_gets;
+
+    start = ktime_get_ns();
+    for (i = 0; i < SCMI_CLK_KUNIT_ITERATIONS; i++) {
+        hw = &provider->clks[i % p->num_clocks].hw;
+        scmi_clk_ops.round_rate(hw, 150000000 + i, &parent);
+    }
+    round_ns = div_u64(ktime_get_ns() - start, SCMI_CLK_KUNIT_ITERATIONS);
+
+    start = ktime_get_ns();
+    for (i = 0; i < SCMI_CLK_KUNIT_ITERATIONS; i++) {
+        hw = &provider->clks[i % p->num_clocks].hw;
+        KUNIT_ASSERT_EQ(test, scmi_clk_ops.set_rate(hw,
+                        mock_discrete_rates[i % MOCK_DISCRETE_RATES], 0), 0);
+    }
+    set_ns = div_u64(ktime_get_ns() - start, SCMI_CLK_KUNIT_ITERATIONS);
+
+    /* 每次都模擬 set_rate 之後的那次 recalc (快取已失效) */
+    start = ktime_get_ns();
+    for (i = 0; i < SCMI_CLK_KUNIT_ITERATIONS; i++) {
+        hw = &provider->clks[i % p->num_clocks].hw;
+        to_scmi_clk(hw)->rate_cached = false;
+        scmi_clk_ops.recalc_rate(hw, 0);
+    }
+    recalc_ns = div_u64(ktime_get_ns() - start, SCMI_CLK_KUNIT_ITERATIONS);
+
+    KUNIT_EXPECT_EQ(test, mock->rate_sets - sets, SCMI_CLK_KUNIT_ITERATIONS);
+    KUNIT_EXPECT_EQ(test, mock->rate_gets - gets, SCMI_CLK_KUNIT_ITERATIONS);
+
+    gets = mock->rate_gets;
+    start = ktime_get_ns();
+    for (i = 0; i < SCMI_CLK_KUNIT_ITERATIONS; i++) {
+        hw = &provider->clks[i % p->num_clocks].hw;
+        scmi_clk_ops.recalc_rate(hw, 0);
+    }
+    cached_ns = div_u64(ktime_get_ns() - start, SCMI_CLK_KUNIT_ITERATIONS);
+
+    KUNIT_EXPECT_EQ(test, mock->rate_gets, gets);
+
+    /* ndelay 只保證下限，扣掉通道延遲後剩下的是驅動與 mock 本身 */
+    set_ns -= min_t(u64, set_ns, p->latency_ns);
+    recalc_ns -= min_t(u64, recalc_ns, p->latency_ns);
+
+    kunit_info(test, "%u clocks: round_rate %llu ns, set_rate %llu ns, recalc_rate %llu ns (+%u ns channel), cached %llu ns\n",
+               p->num_clocks, round_ns, set_ns, recalc_ns, p->latency_ns,
+               cached_ns);
+
+    KUNIT_EXPECT_LT(test, round_ns, (u64)SCMI_CLK_KUNIT_ROUND_NS);
+    KUNIT_EXPECT_LT(test, set_ns, (u64)SCMI_CLK_KUNIT_SET_NS);
+    KUNIT_EXPECT_LT(test, recalc_ns, (u64)SCMI_CLK_KUNIT_RECALC_NS);
+    /* 快取命中不碰通道，與 round_rate 同一量級 */
+    KUNIT_EXPECT_LT(test, cached_ns, (u64)SCMI_CLK_KUNIT_ROUND_NS);
+}
+
+static struct kunit_case scmi_clk_test_cases[] = {
+    KUNIT_CASE_PARAM(scmi_clk_test_probe, scmi_clk_kunit_gen_params),
+    KUNIT_CASE(scmi_clk_test_round_rate),
+    KUNIT_CASE(scmi_clk_test_set_rate_busy),
+    KUNIT_CASE(scmi_clk_test_notify),
+    KUNIT_CASE(scmi_clk_test_rate_cache),
+    KUNIT_CASE(scmi_clk_test_rate_table_share),
+    KUNIT_CASE_PARAM(scmi_clk_test_op_overhead, scmi_clk_kunit_gen_params),
+    {}
+};
+
+static struct kunit_suite scmi_clk_test_suite = {
+    .name = "scmi-clocks",
+    .test_cases = scmi_clk_test_cases,
+};
+
+kunit_test_suite(scmi_clk_test_suite);
@@ -0,0 +1,203 @@
+/*
+ * SCMI Clock Bring-up Script Example
+ *
+ * arm_scmi.md 的 reset controller 每條 reset line 送一則 RESET 訊息；
+ * 加速器 probe 時常要：
+ *
+ *   reset assert x N -> clock enable x M -> rate set -> 等待穩定
+ *   -> reset deassert x N
+ *
+ * 每一步都是一次完整的 SCMI round trip，而且彼此串行。
+ *
+ * 這個範例把整段序列編成 BRINGUP_SCRIPT 廠商訊息 (0xC3，見
+ * scp_firmware_clock_handler.c)，SCP 在一次 handler 呼叫中依序執行，
+ * 回傳每一步的狀態。超過一則訊息容量 (15 步) 的腳本自動拆成
+ * 多則，仍依序送出。
+ *
+ * 對應 drivers/firmware/arm_scmi/clock.c；接到 scmi_clk_proto_ops：
+ *   .script_run = scmi_clock_script_run,
+ *
+ * 腳本步驟 struct scmi_clock_script_step 與 SCMI_CLOCK_SCRIPT_* 巨集
+ * 放在 include/linux/scmi_protocol.h，供加速器 driver 使用：
+ *   struct scmi_clock_script_step { u8 op; u16 id; u32 arg; };
+ */
+
+#include <linux/device.h>
+#include <linux/overflow.h>
+#include <linux/scmi_protocol.h>
+#include <linux/unaligned.h>
+
+#include "common.h"
+
+#define CLOCK_BRINGUP_SCRIPT        0xC3
+
+/* SCP 端一則訊息最多的步驟數 (SCMI_CLOCK_SCRIPT_MAX_STEPS) */
+#define SCMI_CLOCK_SCRIPT_MSG_STEPS 15
+
+#define SCMI_CLOCK_SCRIPT_CONTINUE_ON_ERROR BIT(0)
+
+struct scmi_msg_clock_script_step {
+    /* bits[7:0] op、bits[31:16] clock ID / reset domain ID */
+    __le32 op_target;
+    __le32 arg;
+};
+
+struct scmi_msg_clock_script {
+    __le32 flags;
+    __le32 step_count;
+    struct scmi_msg_clock_script_step steps[];
+};
+
+/* 回應 (status 之後)：steps_executed 與每一步的 SCMI 狀態 */
+struct scmi_msg_resp_clock_script {
+    __le32 steps_executed;
+    __le32 step_status[];
+};
+
+/* 一則訊息可放的步驟數，受傳輸層 max_msg_size 限制 */
+static unsigned int scmi_clock_script_msg_steps(const struct scmi_protocol_handle *ph)
+{
+    size_t size = ph->hops->get_max_msg_size(ph);
+
+    if (size <= sizeof(struct scmi_msg_clock_script))
+        return 0;
+
+    size = (size - sizeof(struct scmi_msg_clock_script)) /
+           sizeof(struct scmi_msg_clock_script_step);
+
+    return min_t(size_t, size, SCMI_CLOCK_SCRIPT_MSG_STEPS);
+}
+
+/* 送出腳本的一段，回傳 SCP 實際執行的步驟數或負的 errno */
+static int scmi_clock_script_send(const struct scmi_protocol_handle *ph,
+                                  const struct scmi_clock_script_step *steps,
+                                  unsigned int count, bool continue_on_error,
+                                  int *step_status)
+{
+    struct scmi_msg_resp_clock_script *resp;
+    struct scmi_msg_clock_script *msg;
+    struct scmi_xfer *t;
+    unsigned int i, executed;
+    int ret;
+
+    ret = ph->xops->xfer_get_init(ph, CLOCK_BRINGUP_SCRIPT,
+                                  struct_size(msg, steps, count),
+                                  struct_size(resp, step_status, count), &t);
+    if (ret)
+        return ret;
+
+    msg = t->tx.buf;
+    msg->flags = cpu_to_le32(continue_on_error ?
+                             SCMI_CLOCK_SCRIPT_CONTINUE_ON_ERROR : 0);
+    msg->step_count = cpu_to_le32(count);
+    for (i = 0; i < count; i++) {
+        msg->steps[i].op_target = cpu_to_le32(steps[i].op |
+                                              ((u32)steps[i].id << 16));
+        msg->steps[i].arg = cpu_to_le32(steps[i].arg);
+    }
+
+    ret = ph->xops->do_xfer(ph, t);
+    if (ret)
+        goto out;
+
+    if (t->rx.len < sizeof(*resp)) {
+        ret = -EPROTO;
+        goto out;
+    }
+
+    resp = t->rx.buf;
+    executed = min_t(u32, le32_to_cpu(resp->steps_executed), count);
+    /* 回應只含已執行的步驟，防止長度不足時讀出界 */
+    executed = min_t(size_t, executed,
+                     (t->rx.len - sizeof(*resp)) / sizeof(__le32));
+
+    for (i = 0; i < executed; i++)
+        step_status[i] = scmi_to_linux_errno(
+            le32_to_cpu(resp->step_status[i]));
+
+    ret = executed;
+
+out:
+    ph->xops->xfer_put(ph, t);
+
+    return ret;
+}
+
+/*
+ * 依序執行整個腳本
+ * step_status (可為 NULL) 填入每一步的結果；未執行的步驟為 -ECANCELED。
+ * 回傳第一個失敗步驟的 errno，全部成功為 0。
+ */
+int scmi_clock_script_run(const struct scmi_protocol_handle *ph,
+                          const struct scmi_clock_script_step *steps,
+                          unsigned int count, bool continue_on_error,
+                          int *step_status)
+{
+    int status[SCMI_CLOCK_SCRIPT_MSG_STEPS];
+    unsigned int per_msg, done = 0, executed, n, i;
+    int ret, first_err = 0;
+
+    per_msg = scmi_clock_script_msg_steps(ph);
+    if (!per_msg)
+        return -EOPNOTSUPP;
+
+    while (done < count) {
+        n = min(count - done, per_msg);
+
+        ret = scmi_clock_script_send(ph, &steps[done], n,
+                                     continue_on_error, status);
+        if (ret < 0) {
+            /* 整則訊息失敗 (例如 SCP 不支援此命令)：這一段都沒有執行 */
+            first_err = first_err ?: ret;
+            break;
+        }
+
+        executed = ret;
+        for (i = 0; i < executed; i++) {
+            if (step_status)
+                step_status[done + i] = status[i];
+            if (status[i] && !first_err) {
+                dev_dbg(ph->dev, "bring-up step %u (op %u id %u) failed: %d\n",
+                        done + i, steps[done + i].op, steps[done + i].id,
+                        status[i]);
+                first_err = status[i];
+            }
+        }
+        done += executed;
+
+        /* SCP 在失敗的步驟停止，後續各段也不再送出 */
+        if (executed < n || (first_err && !continue_on_error))
+            break;
+    }
+
+    if (step_status)
+        for (i = done; i < count; i++)
+            step_status[i] = -ECANCELED;
+
+    return first_err;
+}
+
+/*
+ * 加速器 driver 使用範例 (op 與 id 取自 DT 或 driver 內的表)：
+ *
+ *   static const struct scmi_clock_script_step npu_bringup[] = {
+ *       { SCMI_CLOCK_SCRIPT_OP_RESET_ASSERT,   NPU_RST_CORE, 0 },
+ *       { SCMI_CLOCK_SCRIPT_OP_RESET_ASSERT,   NPU_RST_AXI,  0 },
+ *       { SCMI_CLOCK_SCRIPT_OP_CLOCK_ENABLE,   NPU_CLK_AXI,  0 },
+ *       { SCMI_CLOCK_SCRIPT_OP_RATE_SET_KHZ,   NPU_CLK_CORE, 800000 },
+ *       { SCMI_CLOCK_SCRIPT_OP_CLOCK_ENABLE,   NPU_CLK_CORE, 0 },
+ *       { SCMI_CLOCK_SCRIPT_OP_DELAY_US,       0,            20 },
+ *       { SCMI_CLOCK_SCRIPT_OP_RESET_DEASSERT, NPU_RST_AXI,  0 },
+ *       { SCMI_CLOCK_SCRIPT_OP_RESET_DEASSERT, NPU_RST_CORE, 0 },
+ *   };
+ *
+ *   ret = clk_ops->script_run(ph, npu_bringup, ARRAY_SIZE(npu_bringup),
+ *                             false, NULL);
+ *
+ * 原本 8 則訊息變成 1 則；12 條 reset 加上時鐘設定的完整序列
+ * (約 30 步) 只需 2 則。
+ * SCP 以 ms alarm 等待延遲步驟：上例的 20us 實際等 1ms，也占掉
+ * 每個腳本 5ms 延遲額度中的 1ms。
+ * 注意腳本直接操作 SCP，不經過 Linux clk / reset framework 的
+ * 計數；適合 probe 時的一次性上電序列，之後仍以一般 API 管理。
+ */
@@ -0,0 +1,425 @@
+/*
+ * SCMI Clock Vendor Message Example (protocol side)
+ *
+ * scp_firmware_clock_handler.c 在標準 Clock 協議之外提供了幾個廠商命令
+ * (message id 0xC0 以後)。upstream 的 scmi_clk_proto_ops 沒有對應的
+ * 操作，clock driver (scmi_clock_example.c) 用到的這些 op 由本檔實作：
+ *
+ *   STATE_SNAPSHOT (0xC0)   一次讀回一段 clock ID 的頻率與啟用狀態
+ *   TRANSITION_COST (0xC1)  單一時鐘 relock/分頻轉換的延遲、能量與量測值
+ *   DESCRIBE_RATES_COMPACT (0xC2)
+ *                           以三元組或 u32 差值描述頻率表，並指出內容
+ *                           相同的時鐘 (same_as)
+ *
+ * 另外 CLOCK_ATTRIBUTES 的回應在 clock_enable_latency 之後附帶 SCP 開機時
+ * 已套用的頻率 (attributes bit[16])，由 scmi_clock_initial_rate_parse() 解出
+ *
+ * 對應 drivers/firmware/arm_scmi/clock.c；接到 scmi_clk_proto_ops：
+ *   .state_snapshot = scmi_clock_state_snapshot,
+ *   .transition_cost_get = scmi_clock_transition_cost_get,
+ *   .describe_rates_compact = scmi_clock_describe_rates_compact,
+ *   .describe_rates = scmi_clock_describe_rates,
+ *
+ * DESCRIBE_RATES_COMPACT 取代 protocol init 中的標準 DESCRIBE_RATES，
+ * 兩者不會都送 (見 scmi_clock_rates_init())。struct clock_info 加上：
+ *   bool compact_rates;
+ * 在 scmi_clock_protocol_init() 的時鐘迴圈之前設定：
+ *   cinfo->compact_rates = !ph->hops->protocol_msg_check(ph,
+ *                              CLOCK_VENDOR_DESCRIBE_RATES_COMPACT, NULL);
+ *
+ * 並在 include/linux/scmi_protocol.h 加上：
+ *   struct scmi_clock_state {
+ *       u32 id;
+ *       bool enabled;
+ *       u64 rate;
+ *   };
+ *
+ *   struct scmi_clock_transition_cost {
+ *       u32 relock_latency_us;
+ *       u32 relock_energy_nj;
+ *       u32 div_latency_us;
+ *       u32 div_energy_nj;
+ *       bool measured_valid;
+ *       u32 measured_latency_us;
+ *       u32 measured_avg_us;
+ *       bool measured_div_valid;
+ *       u32 measured_div_latency_us;
+ *       bool swap_valid;
+ *       u32 swap_latency_us;
+ *       u32 swap_energy_nj;
+ *   };
+ *
+ *   #define SCMI_CLOCK_COMPACT_MAX_VALUES 24
+ *
+ *   enum scmi_clock_rates_format {
+ *       SCMI_CLOCK_RATES_TRIPLET,   // base = min，values = {max, step} (u64)
+ *       SCMI_CLOCK_RATES_DELTA,     // base = rates[index]，values = 差值
+ *   };
+ *
+ *   struct scmi_clock_rates_compact {
+ *       enum scmi_clock_rates_format format;
+ *       bool discrete;
+ *       u32 same_as;
+ *       u32 total_rates;
+ *       u32 num_values;
+ *       u32 remaining;
+ *       u64 base;
+ *       u32 values[SCMI_CLOCK_COMPACT_MAX_VALUES];
+ *   };
+ *
+ * SCP 不認得廠商命令時回 SCMI_NOT_SUPPORTED，do_xfer 轉成 -EOPNOTSUPP，
+ * driver 據此關閉對應的功能。
+ */
+
+#include <linux/device.h>
+#include <linux/overflow.h>
+#include <linux/scmi_protocol.h>
+#include <linux/unaligned.h>
+
+#include "common.h"
+
+enum scmi_clock_vendor_cmd {
+    CLOCK_VENDOR_STATE_SNAPSHOT = 0xC0,
+    CLOCK_VENDOR_TRANSITION_COST = 0xC1,
+    CLOCK_VENDOR_DESCRIBE_RATES_COMPACT = 0xC2,
+};
+
+struct scmi_msg_clock_snapshot {
+    __le32 first_id;
+    __le32 count;
+};
+
+/* 回應 (status 已由 core 取走) */
+struct scmi_msg_resp_clock_snapshot {
+    __le32 generation;
+    __le32 num_entries;
+#define SNAPSHOT_RETURNED(x)    ((x) & 0xFFFF)
+#define SNAPSHOT_REMAINING(x)   ((x) >> 16)
+    struct {
+        __le32 id;
+        __le32 flags;
+#define SNAPSHOT_ENABLED        BIT(0)
+        __le32 rate_low;
+        __le32 rate_high;
+    } entries[];
+};
+
+/*
+ * 讀取 first 起最多 count 個時鐘的狀態
+ * SCP 依通道大小決定這次回傳幾筆 (*returned)，呼叫者從
+ * first + *returned 繼續；*generation 是 SCP 的狀態變更計數
+ */
+int scmi_clock_state_snapshot(const struct scmi_protocol_handle *ph,
+                              u32 first, u32 count,
+                              struct scmi_clock_state *states, u32 max_states,
+                              u32 *returned, u32 *generation)
+{
+    struct scmi_msg_resp_clock_snapshot *resp;
+    struct scmi_msg_clock_snapshot *msg;
+    struct scmi_xfer *t;
+    u32 num, i;
+    int ret;
+
+    if (!count || !max_states)
+        return -EINVAL;
+
+    /* rx_size 0：回應大小取通道上限 */
+    ret = ph->xops->xfer_get_init(ph, CLOCK_VENDOR_STATE_SNAPSHOT,
+                                  sizeof(*msg), 0, &t);
+    if (ret)
+        return ret;
+
+    msg = t->tx.buf;
+    msg->first_id = cpu_to_le32(first);
+    msg->count = cpu_to_le32(min(count, max_states));
+
+    ret = ph->xops->do_xfer(ph, t);
+    if (ret)
+        goto out;
+
+    resp = t->rx.buf;
+    if (t->rx.len < sizeof(*resp)) {
+        ret = -EPROTO;
+        goto out;
+    }
+
+    num = SNAPSHOT_RETURNED(le32_to_cpu(resp->num_entries));
+    if (num > max_states || t->rx.len < struct_size(resp, entries, num)) {
+        ret = -EPROTO;
+        goto out;
+    }
+
+    for (i = 0; i < num; i++) {
+        states[i].id = le32_to_cpu(resp->entries[i].id);
+        states[i].enabled = le32_to_cpu(resp->entries[i].flags) &
+                            SNAPSHOT_ENABLED;
+        states[i].rate = get_unaligned_le64(&resp->entries[i].rate_low);
+    }
+
+    *returned = num;
+    *generation = le32_to_cpu(resp->generation);
+
+out:
+    ph->xops->xfer_put(ph, t);
+    return ret;
+}
+
+/* 回應 (status 已由 core 取走) */
+struct scmi_msg_resp_clock_transition_cost {
+    __le32 flags;
+#define COST_MEASURED_VALID     BIT(0)
+#define COST_MEASURED_DIV_VALID BIT(1)
+#define COST_SWAP_VALID         BIT(2)
+    __le32 relock_latency_us;
+    __le32 relock_energy_nj;
+    __le32 div_latency_us;
+    __le32 div_energy_nj;
+    __le32 measured_latency_us;
+    __le32 measured_avg_us;
+    __le32 measured_div_latency_us;
+    /* 較舊的 SCP 沒有這兩項 */
+    __le32 swap_latency_us;
+    __le32 swap_energy_nj;
+};
+
+/*
+ * 讀取時鐘 id 的轉換成本
+ * 平台沒有為此時鐘設定成本表時 SCP 回 SCMI_NOT_SUPPORTED (-EOPNOTSUPP)
+ */
+int scmi_clock_transition_cost_get(const struct scmi_protocol_handle *ph,
+                                   u32 id,
+                                   struct scmi_clock_transition_cost *cost)
+{
+    struct scmi_msg_resp_clock_transition_cost *resp;
+    struct scmi_xfer *t;
+    u32 flags;
+    int ret;
+
+    ret = ph->xops->xfer_get_init(ph, CLOCK_VENDOR_TRANSITION_COST,
+                                  sizeof(__le32), sizeof(*resp), &t);
+    if (ret)
+        return ret;
+
+    put_unaligned_le32(id, t->tx.buf);
+
+    ret = ph->xops->do_xfer(ph, t);
+    if (ret)
+        goto out;
+
+    resp = t->rx.buf;
+    if (t->rx.len < offsetof(typeof(*resp), swap_latency_us)) {
+        ret = -EPROTO;
+        goto out;
+    }
+
+    flags = le32_to_cpu(resp->flags);
+    if (t->rx.len < sizeof(*resp))
+        flags &= ~COST_SWAP_VALID;
+
+    cost->relock_latency_us = le32_to_cpu(resp->relock_latency_us);
+    cost->relock_energy_nj = le32_to_cpu(resp->relock_energy_nj);
+    cost->div_latency_us = le32_to_cpu(resp->div_latency_us);
+    cost->div_energy_nj = le32_to_cpu(resp->div_energy_nj);
+    cost->measured_valid = flags & COST_MEASURED_VALID;
+    cost->measured_latency_us = le32_to_cpu(resp->measured_latency_us);
+    cost->measured_avg_us = le32_to_cpu(resp->measured_avg_us);
+    cost->measured_div_valid = flags & COST_MEASURED_DIV_VALID;
+    cost->measured_div_latency_us = le32_to_cpu(resp->measured_div_latency_us);
+    cost->swap_valid = flags & COST_SWAP_VALID;
+    cost->swap_latency_us = cost->swap_valid ?
+                            le32_to_cpu(resp->swap_latency_us) : 0;
+    cost->swap_energy_nj = cost->swap_valid ?
+                           le32_to_cpu(resp->swap_energy_nj) : 0;
+
+out:
+    ph->xops->xfer_put(ph, t);
+    return ret;
+}
+
+/* 回應 (status 已由 core 取走)；請求與 DESCRIBE_RATES 相同 */
+struct scmi_msg_resp_clock_rates_compact {
+    __le32 flags;
+#define COMPACT_NUM_VALUES(x)   ((x) & 0xFFF)
+#define COMPACT_FORMAT(x)       (((x) >> 12) & 0x3)
+#define COMPACT_FORMAT_TRIPLET  0
+#define COMPACT_FORMAT_DELTA    1
+#define COMPACT_DISCRETE        BIT(14)
+#define COMPACT_REMAINING(x)    ((x) >> 16)
+    __le32 same_as;
+    __le32 total_rates;
+    __le32 base_low;
+    __le32 base_high;
+    __le32 values[];
+};
+
+/*
+ * 讀取時鐘 clk_id 頻率表從 index 開始的一頁
+ * 三元組格式只有一頁；差值格式每頁帶絕對的 base，呼叫者從
+ * index + num_values + 1 繼續。差值放不進 u32 的表 SCP 回
+ * SCMI_NOT_SUPPORTED，呼叫者改用 describe_rates
+ */
+int scmi_clock_describe_rates_compact(const struct scmi_protocol_handle *ph,
+                                      u32 clk_id, u32 index,
+                                      struct scmi_clock_rates_compact *page)
+{
+    struct scmi_msg_resp_clock_rates_compact *resp;
+    struct scmi_msg_clock_describe_rates *msg;
+    struct scmi_xfer *t;
+    u32 flags, num, format, i;
+    int ret;
+
+    ret = ph->xops->xfer_get_init(ph, CLOCK_VENDOR_DESCRIBE_RATES_COMPACT,
+                                  sizeof(*msg), 0, &t);
+    if (ret)
+        return ret;
+
+    msg = t->tx.buf;
+    msg->id = cpu_to_le32(clk_id);
+    msg->rate_index = cpu_to_le32(index);
+
+    ret = ph->xops->do_xfer(ph, t);
+    if (ret)
+        goto out;
+
+    resp = t->rx.buf;
+    if (t->rx.len < sizeof(*resp)) {
+        ret = -EPROTO;
+        goto out;
+    }
+
+    flags = le32_to_cpu(resp->flags);
+    num = COMPACT_NUM_VALUES(flags);
+    format = COMPACT_FORMAT(flags);
+    if (num > SCMI_CLOCK_COMPACT_MAX_VALUES ||
+        t->rx.len < struct_size(resp, values, num) ||
+        (format == COMPACT_FORMAT_TRIPLET && num != 4) ||
+        format > COMPACT_FORMAT_DELTA) {
+        ret = -EPROTO;
+        goto out;
+    }
+
+    page->format = format == COMPACT_FORMAT_TRIPLET ?
+                   SCMI_CLOCK_RATES_TRIPLET : SCMI_CLOCK_RATES_DELTA;
+    page->discrete = flags & COMPACT_DISCRETE;
+    page->same_as = le32_to_cpu(resp->same_as);
+    page->total_rates = le32_to_cpu(resp->total_rates);
+    page->num_values = num;
+    page->remaining = COMPACT_REMAINING(flags);
+    page->base = get_unaligned_le64(&resp->base_low);
+    for (i = 0; i < num; i++)
+        page->values[i] = le32_to_cpu(resp->values[i]);
+
+out:
+    ph->xops->xfer_put(ph, t);
+    return ret;
+}
+
+/*
+ * 取代 scmi_clock_protocol_init() 時鐘迴圈中的
+ * scmi_clock_describe_rates_get()：
+ *
+ *   ret = scmi_clock_attributes_get(ph, clkid, cinfo, version);
+ *   if (!ret)
+ *       scmi_clock_rates_init(ph, clkid, cinfo);
+ *
+ * SCP 支援 DESCRIBE_RATES_COMPACT 時 init 不送標準 DESCRIBE_RATES
+ * (離散表每 8 個頻率一則訊息)，頻率表延到 driver probe 以 compact 取得；
+ * info->list / range 這時是空的，driver 不能使用它們
+ */
+static int scmi_clock_rates_init(const struct scmi_protocol_handle *ph,
+                                 u32 clk_id, struct clock_info *cinfo)
+{
+    if (cinfo->compact_rates)
+        return 0;
+
+    return scmi_clock_describe_rates_get(ph, clk_id, cinfo);
+}
+
+/*
+ * CLOCK_ATTRIBUTES 的初始頻率擴充，接在 v2.0 的 clock_enable_latency 之後；
+ * SCP 只對協商版本 >= 2.0 的代理附帶，bit[16] 在 v1.0 中是保留位元。
+ * scmi_clock_info 加上：
+ *   u64 initial_rate;      // 0 表示 SCP 沒有回報
+ *
+ * scmi_clock_attributes_get() 的 xfer_get_init 以 sizeof(*attr) 作為 rx 大小，
+ * 要改成 sizeof(struct scmi_msg_resp_clock_attributes_ext) 才收得到擴充，
+ * 解出 clock_enable_latency 之後呼叫：
+ *   scmi_clock_initial_rate_parse(t, version, clk);
+ */
+#define CLOCK_INITIAL_RATE_VALID    BIT(16)
+
+struct scmi_msg_resp_clock_attributes_ext {
+    __le32 attributes;
+    u8 name[SCMI_SHORT_NAME_MAX_SIZE];
+    __le32 clock_enable_latency;
+    __le32 initial_rate_low;
+    __le32 initial_rate_high;
+};
+
+static void scmi_clock_initial_rate_parse(const struct scmi_xfer *t,
+                                          u32 version,
+                                          struct scmi_clock_info *clk)
+{
+    const struct scmi_msg_resp_clock_attributes_ext *attr = t->rx.buf;
+
+    clk->initial_rate = 0;
+
+    if (PROTOCOL_REV_MAJOR(version) < 0x2 || t->rx.len < sizeof(*attr) ||
+        !(le32_to_cpu(attr->attributes) & CLOCK_INITIAL_RATE_VALID))
+        return;
+
+    clk->initial_rate = get_unaligned_le64(&attr->initial_rate_low);
+}
+
+/*
+ * 對 compact 失敗的時鐘 (例如差值放不進 u32) 補做標準 DESCRIBE_RATES，
+ * 填入 info->list / range。init 已經做過 (SCP 不支援 compact) 時不重送
+ */
+int scmi_clock_describe_rates(const struct scmi_protocol_handle *ph, u32 clk_id)
+{
+    struct clock_info *cinfo = ph->get_priv(ph);
+
+    if (clk_id >= cinfo->num_clocks)
+        return -EINVAL;
+
+    if (!cinfo->compact_rates)
+        return 0;
+
+    return scmi_clock_describe_rates_get(ph, clk_id, cinfo);
+}
+
+/*
+ * CLOCK_ATTRIBUTES 的初始頻率擴充，接在 v2.0 的 clock_enable_latency 之後；
+ * SCP 只對協商版本 >= 2.0 的代理附帶，bit[16] 在 v1.0 中是保留位元。
+ * scmi_clock_info 加上：
+ *   u64 initial_rate;      // 0 表示 SCP 沒有回報
+ *
+ * scmi_clock_attributes_get() 的 xfer_get_init 以 sizeof(*attr) 作為 rx 大小，
+ * 要改成 sizeof(struct scmi_msg_resp_clock_attributes_ext) 才收得到擴充，
+ * 解出 clock_enable_latency 之後呼叫：
+ *   scmi_clock_initial_rate_parse(t, version, clk);
+ */
+#define CLOCK_INITIAL_RATE_VALID    BIT(16)
+
+struct scmi_msg_resp_clock_attributes_ext {
+    __le32 attributes;
+    u8 name[SCMI_SHORT_NAME_MAX_SIZE];
+    __le32 clock_enable_latency;
+    __le32 initial_rate_low;
+    __le32 initial_rate_high;
+};
+
+static void scmi_clock_initial_rate_parse(const struct scmi_xfer *t,
+                                          u32 version,
+                                          struct scmi_clock_info *clk)
+{
+    const struct scmi_msg_resp_clock_attributes_ext *attr = t->rx.buf;
+
+    clk->initial_rate = 0;
+
+    if (PROTOCOL_REV_MAJOR(version) < 0x2 || t->rx.len < sizeof(*attr) ||
+        !(le32_to_cpu(attr->attributes) & CLOCK_INITIAL_RATE_VALID))
+        return;
+
+    clk->initial_rate = get_unaligned_le64(&attr->initial_rate_low);
+}
@@ -0,0 +1,403 @@
+/*
+ * SCMI Clock Preallocated Xfer Example
+ *
+ * 一般的 RATE_SET / RATE_GET 每次呼叫都要走
+ *   xfer_get_init() -> 填 payload -> do_xfer() -> xfer_put()
+ * xfer_get_init 需要從 free list 取 xfer、配置 token、登錄到 pending 表，
+ * xfer_put 再全部還回去 (見 arm_scmi.md)；對 cpufreq 這種每秒上百次的
+ * 調頻，這些簿記的成本和訊息本身差不多。
+ *
+ * 這個範例讓 clock 協議為「熱」時鐘 (通常是 CPU DVFS 時鐘) 保留
+ * 兩個 xfer：
+ *
+ *   - header (protocol/message id、token) 與 payload 的固定欄位
+ *     (clock id、flags) 在取得 xfer 時就編碼好
+ *   - 熱路徑只更新 rate 欄位、重設 rx 長度，然後 do_xfer
+ *   - 每個時鐘一把 mutex 保護自己的 xfer，不同時鐘互不影響
+ *
+ * 保留的 xfer 占用 token，因此保留數量有上限，其餘時鐘照舊走一般路徑；
+ * 而且只在時鐘持續調頻時才持有：閒置超過 SCMI_CLK_XFER_IDLE_MS 的時鐘
+ * 由 idle work 歸還 xfer 與 token，下一次調頻再重新取得 (計入配置次數)。
+ *
+ * 對應 drivers/firmware/arm_scmi/clock.c；接到 scmi_clk_proto_ops：
+ *   .rate_xfer_reserve = scmi_clock_rate_xfer_reserve,
+ *   .rate_xfer_release = scmi_clock_rate_xfer_release,
+ *   .rate_set_fast     = scmi_clock_rate_set_fast,
+ *   .rate_get_fast     = scmi_clock_rate_get_fast,
+ *   .rate_xfer_stats   = scmi_clock_rate_xfer_stats,
+ *
+ * scmi_clock_protocol_init 呼叫 scmi_clock_xfer_cache_init，
+ * scmi_clock_protocol_deinit 呼叫 scmi_clock_xfer_cache_deinit。
+ * KUnit 測試與 benchmark 見 scmi_clock_xfer_cache_kunit.c，
+ * 由 CONFIG_ARM_SCMI_CLOCK_KUNIT_TEST 在 clock.c 結尾引入。
+ */
+
+#include <linux/device.h>
+#include <linux/jiffies.h>
+#include <linux/ktime.h>
+#include <linux/mutex.h>
+#include <linux/scmi_protocol.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/unaligned.h>
+#include <linux/workqueue.h>
+
+#include "common.h"
+
+/*
+ * 最多保留 xfer 的時鐘數；每個時鐘占 2 個 token，
+ * mailbox 傳輸預設 max_msg 為 20，保留一半給其他訊息
+ */
+#define SCMI_CLK_XFER_CACHE_MAX     4
+
+/* 閒置超過此時間的時鐘歸還 xfer 與 token */
+#define SCMI_CLK_XFER_IDLE_MS       1000
+
+struct scmi_clock_set_rate {
+    __le32 flags;
+    __le32 id;
+    __le32 value_low;
+    __le32 value_high;
+};
+
+/* 每個時鐘的預先配置 xfer */
+struct scmi_clk_xfer_slot {
+    struct mutex lock;
+    /* 已經 rate_xfer_reserve，熱路徑使用下面的 xfer */
+    bool reserved;
+    /* CLOCK_RATE_SET，payload 的 flags/id 已填好；NULL 表示目前未持有 */
+    struct scmi_xfer *set;
+    /* CLOCK_RATE_GET，payload 的 id 已填好 */
+    struct scmi_xfer *get;
+    /* 最近一次使用 (jiffies)，idle work 據此歸還 */
+    unsigned long last_used;
+};
+
+/*
+ * struct scmi_clock_xfer_stats 放在 include/linux/scmi_protocol.h，
+ * 與 clock driver 共用：
+ *   fast_xfers / fast_ns  保留路徑的次數與總時間
+ *   slow_xfers / slow_ns  一般路徑的次數與總時間
+ *   xfer_gets             xfer_get_init 次數 (一般路徑每次一個，
+ *                         保留路徑只在閒置歸還後重新取得時才有)
+ * 兩條路徑的時間都涵蓋整個操作 (含 do_xfer)，可以直接相減
+ */
+struct scmi_clk_xfer_cache {
+    const struct scmi_protocol_handle *ph;
+    /* 以 clock ID 索引 */
+    struct scmi_clk_xfer_slot *slots;
+    int num_clocks;
+    unsigned int reserved;
+    struct mutex reserve_lock;
+    struct delayed_work idle_work;
+    /* 不同時鐘的 set_rate 可能同時執行 */
+    spinlock_t stats_lock;
+    struct scmi_clock_xfer_stats stats;
+};
+
+static void scmi_clock_xfer_idle_work(struct work_struct *work);
+
+/*
+ * 協議初始化時呼叫 (scmi_clock_protocol_init)，
+ * 配置與 ph->dev 同生命週期
+ */
+int scmi_clock_xfer_cache_init(const struct scmi_protocol_handle *ph,
+                               struct scmi_clk_xfer_cache *cache,
+                               int num_clocks)
+{
+    int i;
+
+    cache->slots = devm_kcalloc(ph->dev, num_clocks, sizeof(*cache->slots),
+                                GFP_KERNEL);
+    if (!cache->slots)
+        return -ENOMEM;
+
+    for (i = 0; i < num_clocks; i++)
+        mutex_init(&cache->slots[i].lock);
+
+    cache->ph = ph;
+    cache->num_clocks = num_clocks;
+    mutex_init(&cache->reserve_lock);
+    spin_lock_init(&cache->stats_lock);
+    INIT_DELAYED_WORK(&cache->idle_work, scmi_clock_xfer_idle_work);
+
+    return 0;
+}
+
+static struct scmi_clk_xfer_cache *
+scmi_clock_xfer_cache_get(const struct scmi_protocol_handle *ph)
+{
+    struct clock_info *ci = ph->get_priv(ph);
+
+    return &ci->xfer_cache;
+}
+
+static void scmi_clock_xfer_account(struct scmi_clk_xfer_cache *cache,
+                                    bool fast, ktime_t start,
+                                    unsigned int gets)
+{
+    u64 ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+    unsigned long flags;
+
+    spin_lock_irqsave(&cache->stats_lock, flags);
+    if (fast) {
+        cache->stats.fast_xfers++;
+        cache->stats.fast_ns += ns;
+    } else {
+        cache->stats.slow_xfers++;
+        cache->stats.slow_ns += ns;
+    }
+    cache->stats.xfer_gets += gets;
+    spin_unlock_irqrestore(&cache->stats_lock, flags);
+}
+
+/* 呼叫者持有 slot->lock */
+static void scmi_clock_xfer_slot_drain(const struct scmi_protocol_handle *ph,
+                                       struct scmi_clk_xfer_slot *slot)
+{
+    if (!slot->set)
+        return;
+
+    ph->xops->xfer_put(ph, slot->set);
+    ph->xops->xfer_put(ph, slot->get);
+    slot->set = NULL;
+    slot->get = NULL;
+}
+
+/*
+ * 取得 RATE_SET / RATE_GET xfer 並編碼固定欄位 (呼叫者持有 slot->lock)
+ * 回傳 xfer_get_init 的次數，失敗時為負的錯誤碼
+ */
+static int scmi_clock_xfer_slot_fill(const struct scmi_protocol_handle *ph,
+                                     struct scmi_clk_xfer_cache *cache,
+                                     struct scmi_clk_xfer_slot *slot,
+                                     u32 clk_id)
+{
+    struct scmi_clock_set_rate *cfg;
+    int ret;
+
+    ret = ph->xops->xfer_get_init(ph, CLOCK_RATE_SET, sizeof(*cfg), 0,
+                                  &slot->set);
+    if (ret)
+        return ret;
+
+    ret = ph->xops->xfer_get_init(ph, CLOCK_RATE_GET, sizeof(__le32),
+                                  sizeof(u64), &slot->get);
+    if (ret) {
+        ph->xops->xfer_put(ph, slot->set);
+        slot->set = NULL;
+        return ret;
+    }
+
+    cfg = slot->set->tx.buf;
+    cfg->flags = cpu_to_le32(0);
+    cfg->id = cpu_to_le32(clk_id);
+    put_unaligned_le32(clk_id, slot->get->tx.buf);
+
+    schedule_delayed_work(&cache->idle_work,
+                          msecs_to_jiffies(SCMI_CLK_XFER_IDLE_MS));
+
+    return 2;
+}
+
+/*
+ * 歸還閒置時鐘的 xfer；仍有時鐘持有時重新排程
+ */
+static void scmi_clock_xfer_idle_work(struct work_struct *work)
+{
+    struct scmi_clk_xfer_cache *cache =
+        container_of(to_delayed_work(work), struct scmi_clk_xfer_cache,
+                     idle_work);
+    unsigned long idle = msecs_to_jiffies(SCMI_CLK_XFER_IDLE_MS);
+    struct scmi_clk_xfer_slot *slot;
+    bool held = false;
+    int i;
+
+    for (i = 0; i < cache->num_clocks; i++) {
+        slot = &cache->slots[i];
+
+        mutex_lock(&slot->lock);
+        if (slot->set && time_after_eq(jiffies, slot->last_used + idle))
+            scmi_clock_xfer_slot_drain(cache->ph, slot);
+        held |= slot->set != NULL;
+        mutex_unlock(&slot->lock);
+    }
+
+    if (held)
+        schedule_delayed_work(&cache->idle_work, idle);
+}
+
+/* 協議卸載時呼叫 (scmi_clock_protocol_deinit) */
+void scmi_clock_xfer_cache_deinit(const struct scmi_protocol_handle *ph)
+{
+    struct scmi_clk_xfer_cache *cache = scmi_clock_xfer_cache_get(ph);
+    int i;
+
+    cancel_delayed_work_sync(&cache->idle_work);
+
+    for (i = 0; i < cache->num_clocks; i++) {
+        mutex_lock(&cache->slots[i].lock);
+        scmi_clock_xfer_slot_drain(ph, &cache->slots[i]);
+        mutex_unlock(&cache->slots[i].lock);
+    }
+}
+
+/*
+ * 登記一個熱時鐘；xfer 在第一次調頻時才取得
+ */
+int scmi_clock_rate_xfer_reserve(const struct scmi_protocol_handle *ph,
+                                 u32 clk_id)
+{
+    struct scmi_clk_xfer_cache *cache = scmi_clock_xfer_cache_get(ph);
+    int ret = 0;
+
+    if (clk_id >= cache->num_clocks)
+        return -EINVAL;
+
+    mutex_lock(&cache->reserve_lock);
+
+    if (cache->slots[clk_id].reserved)
+        goto out;
+
+    if (cache->reserved >= SCMI_CLK_XFER_CACHE_MAX) {
+        ret = -ENOSPC;
+        goto out;
+    }
+
+    cache->slots[clk_id].reserved = true;
+    cache->reserved++;
+
+out:
+    mutex_unlock(&cache->reserve_lock);
+
+    return ret;
+}
+
+void scmi_clock_rate_xfer_release(const struct scmi_protocol_handle *ph,
+                                  u32 clk_id)
+{
+    struct scmi_clk_xfer_cache *cache = scmi_clock_xfer_cache_get(ph);
+    struct scmi_clk_xfer_slot *slot;
+
+    if (clk_id >= cache->num_clocks)
+        return;
+
+    slot = &cache->slots[clk_id];
+
+    mutex_lock(&cache->reserve_lock);
+    if (slot->reserved) {
+        mutex_lock(&slot->lock);
+        scmi_clock_xfer_slot_drain(ph, slot);
+        slot->reserved = false;
+        mutex_unlock(&slot->lock);
+        cache->reserved--;
+    }
+    mutex_unlock(&cache->reserve_lock);
+}
+
+/*
+ * 熱路徑：只更新 rate 欄位就送出
+ */
+int scmi_clock_rate_set_fast(const struct scmi_protocol_handle *ph,
+                             u32 clk_id, u64 rate)
+{
+    struct scmi_clk_xfer_cache *cache = scmi_clock_xfer_cache_get(ph);
+    struct scmi_clock_set_rate *cfg;
+    struct scmi_clk_xfer_slot *slot;
+    unsigned int gets = 0;
+    ktime_t start;
+    int ret;
+
+    start = ktime_get();
+
+    if (clk_id >= cache->num_clocks || !cache->slots[clk_id].reserved) {
+        /* 未保留：一般路徑，每次一個 xfer_get_init */
+        ret = scmi_clock_rate_set(ph, clk_id, rate);
+        scmi_clock_xfer_account(cache, false, start, 1);
+        return ret;
+    }
+
+    slot = &cache->slots[clk_id];
+
+    mutex_lock(&slot->lock);
+
+    if (!slot->set) {
+        ret = scmi_clock_xfer_slot_fill(ph, cache, slot, clk_id);
+        if (ret < 0)
+            goto out;
+        gets = ret;
+    }
+
+    cfg = slot->set->tx.buf;
+    cfg->value_low = cpu_to_le32(rate & 0xffffffff);
+    cfg->value_high = cpu_to_le32(rate >> 32);
+    /* 上一次回應的 fetch 會縮短 rx.len */
+    ph->xops->reset_rx_to_maxsz(ph, slot->set);
+
+    ret = ph->xops->do_xfer(ph, slot->set);
+    slot->last_used = jiffies;
+
+out:
+    mutex_unlock(&slot->lock);
+
+    scmi_clock_xfer_account(cache, true, start, gets);
+
+    return ret;
+}
+
+int scmi_clock_rate_get_fast(const struct scmi_protocol_handle *ph,
+                             u32 clk_id, u64 *rate)
+{
+    struct scmi_clk_xfer_cache *cache = scmi_clock_xfer_cache_get(ph);
+    struct scmi_clk_xfer_slot *slot;
+    unsigned int gets = 0;
+    ktime_t start;
+    int ret;
+
+    start = ktime_get();
+
+    if (clk_id >= cache->num_clocks || !cache->slots[clk_id].reserved) {
+        ret = scmi_clock_rate_get(ph, clk_id, rate);
+        scmi_clock_xfer_account(cache, false, start, 1);
+        return ret;
+    }
+
+    slot = &cache->slots[clk_id];
+
+    mutex_lock(&slot->lock);
+
+    if (!slot->set) {
+        ret = scmi_clock_xfer_slot_fill(ph, cache, slot, clk_id);
+        if (ret < 0)
+            goto out;
+        gets = ret;
+    }
+
+    slot->get->rx.len = sizeof(u64);
+    ret = ph->xops->do_xfer(ph, slot->get);
+    if (!ret)
+        *rate = get_unaligned_le64(slot->get->rx.buf);
+    slot->last_used = jiffies;
+
+out:
+    mutex_unlock(&slot->lock);
+
+    scmi_clock_xfer_account(cache, true, start, gets);
+
+    return ret;
+}
+
+/*
+ * 統計：xfer_gets / fast_xfers 即保留路徑每次操作的 xfer 配置數，
+ * 持續調頻的時鐘應趨近 0
+ */
+void scmi_clock_rate_xfer_stats(const struct scmi_protocol_handle *ph,
+                                struct scmi_clock_xfer_stats *stats)
+{
+    struct scmi_clk_xfer_cache *cache = scmi_clock_xfer_cache_get(ph);
+    unsigned long flags;
+
+    spin_lock_irqsave(&cache->stats_lock, flags);
+    *stats = cache->stats;
+    spin_unlock_irqrestore(&cache->stats_lock, flags);
+}
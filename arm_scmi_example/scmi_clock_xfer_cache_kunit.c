@@ -0,0 +1,415 @@
+/*
+ * KUnit tests and benchmark for the SCMI clock xfer cache
+ * (scmi_clock_xfer_cache_example.c)
+ *
+ * 以 mock 的 scmi_xfer_ops 取代 SCMI core：xfer_get_init 與 core 一樣
+ * 在 spinlock 下從固定大小的 xfer 陣列取一個、配置 token (bitmap)，
+ * xfer_put 再歸還；do_xfer 直接解碼 payload，不經過傳輸層。
+ * 因此 benchmark 量到的差異只來自 xfer 簿記與編碼，不含通道延遲。
+ *
+ * 放到 drivers/firmware/arm_scmi/clock_xfer_cache_kunit.c，
+ * 在 clock.c 結尾引入 (需要存取 static 函式與 struct clock_info)：
+ *   #if IS_ENABLED(CONFIG_ARM_SCMI_CLOCK_KUNIT_TEST)
+ *   #include "clock_xfer_cache_kunit.c"
+ *   #endif
+ *
+ * Kconfig：
+ *   config ARM_SCMI_CLOCK_KUNIT_TEST
+ *       tristate "KUnit tests for the SCMI clock xfer cache" if !KUNIT_ALL_TESTS
+ *       depends on KUNIT && ARM_SCMI_PROTOCOL
+ *       default KUNIT_ALL_TESTS
+ *
+ * 執行：
+ *   ./tools/testing/kunit/kunit.py run --arch=arm64 \
+ *       --kconfig_add CONFIG_ARM_SCMI_PROTOCOL=y \
+ *       --kconfig_add CONFIG_ARM_SCMI_CLOCK_KUNIT_TEST=y \
+ *       'scmi-clock-xfer-cache*'
+ */
+
+#include <kunit/device.h>
+#include <kunit/test.h>
+#include <linux/bitmap.h>
+#include <linux/timex.h>
+
+/* 與 mailbox 傳輸預設的 max_msg 相同 */
+#define MOCK_MAX_MSG        20
+#define MOCK_MSG_SIZE       128
+#define MOCK_NUM_CLOCKS     8
+
+#define BENCH_ITERATIONS    10000
+
+struct scmi_xfer_mock {
+    struct scmi_protocol_handle ph;
+    struct scmi_xfer_ops xops;
+    struct clock_info ci;
+
+    spinlock_t lock;
+    struct scmi_xfer xfers[MOCK_MAX_MSG];
+    u8 tx_bufs[MOCK_MAX_MSG][MOCK_MSG_SIZE];
+    u8 rx_bufs[MOCK_MAX_MSG][MOCK_MSG_SIZE];
+    DECLARE_BITMAP(tokens, MOCK_MAX_MSG);
+
+    /* 呼叫次數 */
+    unsigned int gets;
+    unsigned int puts;
+    unsigned int sent;
+
+    /* 最近一次 RATE_SET 的 payload，與 RATE_GET 回傳的頻率 */
+    u32 last_flags;
+    u32 last_id;
+    u64 last_rate;
+    u64 rate;
+};
+
+static struct scmi_xfer_mock *to_mock(const struct scmi_protocol_handle *ph)
+{
+    return container_of(ph, struct scmi_xfer_mock, ph);
+}
+
+static void *mock_get_priv(const struct scmi_protocol_handle *ph)
+{
+    return &to_mock(ph)->ci;
+}
+
+static int mock_xfer_get_init(const struct scmi_protocol_handle *ph,
+                              u8 msg_id, size_t tx_size, size_t rx_size,
+                              struct scmi_xfer **p)
+{
+    struct scmi_xfer_mock *mock = to_mock(ph);
+    struct scmi_xfer *xfer;
+    unsigned long flags;
+    unsigned int token;
+
+    if (tx_size > MOCK_MSG_SIZE || rx_size > MOCK_MSG_SIZE)
+        return -ERANGE;
+
+    spin_lock_irqsave(&mock->lock, flags);
+    token = find_first_zero_bit(mock->tokens, MOCK_MAX_MSG);
+    if (token >= MOCK_MAX_MSG) {
+        spin_unlock_irqrestore(&mock->lock, flags);
+        return -ENOMEM;
+    }
+    set_bit(token, mock->tokens);
+    mock->gets++;
+    spin_unlock_irqrestore(&mock->lock, flags);
+
+    xfer = &mock->xfers[token];
+    xfer->hdr.id = msg_id;
+    xfer->hdr.seq = token;
+    xfer->tx.buf = mock->tx_bufs[token];
+    xfer->tx.len = tx_size;
+    xfer->rx.buf = mock->rx_bufs[token];
+    xfer->rx.len = rx_size ?: MOCK_MSG_SIZE;
+    *p = xfer;
+
+    return 0;
+}
+
+static void mock_reset_rx_to_maxsz(const struct scmi_protocol_handle *ph,
+                                   struct scmi_xfer *xfer)
+{
+    xfer->rx.len = MOCK_MSG_SIZE;
+}
+
+static int mock_do_xfer(const struct scmi_protocol_handle *ph,
+                        struct scmi_xfer *xfer)
+{
+    struct scmi_xfer_mock *mock = to_mock(ph);
+    const struct scmi_clock_set_rate *cfg;
+
+    mock->sent++;
+
+    switch (xfer->hdr.id) {
+    case CLOCK_RATE_SET:
+        cfg = xfer->tx.buf;
+        mock->last_flags = le32_to_cpu(cfg->flags);
+        mock->last_id = le32_to_cpu(cfg->id);
+        mock->last_rate = le32_to_cpu(cfg->value_low) |
+                          (u64)le32_to_cpu(cfg->value_high) << 32;
+        xfer->rx.len = 0;
+        return 0;
+
+    case CLOCK_RATE_GET:
+        if (xfer->rx.len < sizeof(u64))
+            return -EPROTO;
+        put_unaligned_le64(mock->rate, xfer->rx.buf);
+        xfer->rx.len = sizeof(u64);
+        return 0;
+
+    default:
+        return -EOPNOTSUPP;
+    }
+}
+
+static void mock_xfer_put(const struct scmi_protocol_handle *ph,
+                          struct scmi_xfer *xfer)
+{
+    struct scmi_xfer_mock *mock = to_mock(ph);
+    unsigned long flags;
+
+    spin_lock_irqsave(&mock->lock, flags);
+    clear_bit(xfer->hdr.seq, mock->tokens);
+    mock->puts++;
+    spin_unlock_irqrestore(&mock->lock, flags);
+}
+
+static unsigned int mock_tokens_held(struct scmi_xfer_mock *mock)
+{
+    return bitmap_weight(mock->tokens, MOCK_MAX_MSG);
+}
+
+static int scmi_xfer_cache_test_init(struct kunit *test)
+{
+    struct scmi_xfer_mock *mock;
+    struct device *dev;
+
+    mock = kunit_kzalloc(test, sizeof(*mock), GFP_KERNEL);
+    KUNIT_ASSERT_NOT_NULL(test, mock);
+
+    dev = kunit_device_register(test, "scmi-clock-xfer-mock");
+    KUNIT_ASSERT_NOT_ERR_OR_NULL(test, dev);
+
+    spin_lock_init(&mock->lock);
+    mock->xops.xfer_get_init = mock_xfer_get_init;
+    mock->xops.reset_rx_to_maxsz = mock_reset_rx_to_maxsz;
+    mock->xops.do_xfer = mock_do_xfer;
+    mock->xops.xfer_put = mock_xfer_put;
+    mock->ph.dev = dev;
+    mock->ph.xops = &mock->xops;
+    mock->ph.get_priv = mock_get_priv;
+
+    /* 一般路徑的 scmi_clock_rate_set/rate_get 需要 clock_info */
+    mock->ci.num_clocks = MOCK_NUM_CLOCKS;
+    mock->ci.clk = kunit_kcalloc(test, MOCK_NUM_CLOCKS, sizeof(*mock->ci.clk),
+                                 GFP_KERNEL);
+    KUNIT_ASSERT_NOT_NULL(test, mock->ci.clk);
+
+    KUNIT_ASSERT_EQ(test, scmi_clock_xfer_cache_init(&mock->ph,
+                                                     &mock->ci.xfer_cache,
+                                                     MOCK_NUM_CLOCKS), 0);
+
+    test->priv = mock;
+
+    return 0;
+}
+
+static void scmi_xfer_cache_test_exit(struct kunit *test)
+{
+    struct scmi_xfer_mock *mock = test->priv;
+
+    scmi_clock_xfer_cache_deinit(&mock->ph);
+    KUNIT_EXPECT_EQ(test, mock_tokens_held(mock), 0);
+}
+
+/* 保留路徑：只有第一次取得 xfer，之後每次 set_rate 零配置 */
+static void scmi_xfer_cache_fast_set_no_alloc(struct kunit *test)
+{
+    struct scmi_xfer_mock *mock = test->priv;
+    struct scmi_clock_xfer_stats st;
+    int i;
+
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph, 3), 0);
+    KUNIT_EXPECT_EQ(test, mock->gets, 0);
+
+    for (i = 0; i < 1000; i++)
+        KUNIT_ASSERT_EQ(test, scmi_clock_rate_set_fast(&mock->ph, 3,
+                                                       1000000000ULL + i), 0);
+
+    /* 一次取得 RATE_SET 與 RATE_GET 兩個 xfer */
+    KUNIT_EXPECT_EQ(test, mock->gets, 2);
+    KUNIT_EXPECT_EQ(test, mock->puts, 0);
+    KUNIT_EXPECT_EQ(test, mock->sent, 1000);
+    KUNIT_EXPECT_EQ(test, mock->last_flags, 0);
+    KUNIT_EXPECT_EQ(test, mock->last_id, 3);
+    KUNIT_EXPECT_EQ(test, mock->last_rate, 1000000000ULL + 999);
+
+    scmi_clock_rate_xfer_stats(&mock->ph, &st);
+    KUNIT_EXPECT_EQ(test, st.fast_xfers, 1000);
+    KUNIT_EXPECT_EQ(test, st.slow_xfers, 0);
+    KUNIT_EXPECT_EQ(test, st.xfer_gets, 2);
+}
+
+/* 64 位元頻率的高 32 位元也要寫入 */
+static void scmi_xfer_cache_fast_set_high_word(struct kunit *test)
+{
+    struct scmi_xfer_mock *mock = test->priv;
+
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph, 0), 0);
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_set_fast(&mock->ph, 0,
+                                                   0x123456789ULL), 0);
+    KUNIT_EXPECT_EQ(test, mock->last_rate, 0x123456789ULL);
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_set_fast(&mock->ph, 0, 42), 0);
+    KUNIT_EXPECT_EQ(test, mock->last_rate, 42);
+}
+
+static void scmi_xfer_cache_fast_get(struct kunit *test)
+{
+    struct scmi_xfer_mock *mock = test->priv;
+    u64 rate = 0;
+
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph, 1), 0);
+
+    mock->rate = 1800000000ULL;
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_get_fast(&mock->ph, 1, &rate), 0);
+    KUNIT_EXPECT_EQ(test, rate, 1800000000ULL);
+
+    /* 上一次回應縮短了 rx.len，下一次仍要能讀回 */
+    mock->rate = 600000000ULL;
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_get_fast(&mock->ph, 1, &rate), 0);
+    KUNIT_EXPECT_EQ(test, rate, 600000000ULL);
+    KUNIT_EXPECT_EQ(test, mock->gets, 2);
+}
+
+/* 未保留的時鐘每次都 get/put 一個 xfer，呼叫後不占 token */
+static void scmi_xfer_cache_slow_path_allocs(struct kunit *test)
+{
+    struct scmi_xfer_mock *mock = test->priv;
+    struct scmi_clock_xfer_stats st;
+    int i;
+
+    for (i = 0; i < 100; i++)
+        KUNIT_ASSERT_EQ(test, scmi_clock_rate_set_fast(&mock->ph, 5,
+                                                       400000000ULL), 0);
+
+    KUNIT_EXPECT_EQ(test, mock->gets, 100);
+    KUNIT_EXPECT_EQ(test, mock->puts, 100);
+    KUNIT_EXPECT_EQ(test, mock_tokens_held(mock), 0);
+    KUNIT_EXPECT_EQ(test, mock->last_id, 5);
+
+    scmi_clock_rate_xfer_stats(&mock->ph, &st);
+    KUNIT_EXPECT_EQ(test, st.slow_xfers, 100);
+    KUNIT_EXPECT_EQ(test, st.xfer_gets, 100);
+}
+
+static void scmi_xfer_cache_reserve_limit(struct kunit *test)
+{
+    struct scmi_xfer_mock *mock = test->priv;
+    u32 id;
+
+    for (id = 0; id < SCMI_CLK_XFER_CACHE_MAX; id++)
+        KUNIT_ASSERT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph, id), 0);
+
+    KUNIT_EXPECT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph, id),
+                    -ENOSPC);
+    /* 重複保留同一個時鐘不占額外名額 */
+    KUNIT_EXPECT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph, 0), 0);
+    KUNIT_EXPECT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph,
+                                                       MOCK_NUM_CLOCKS),
+                    -EINVAL);
+
+    scmi_clock_rate_xfer_release(&mock->ph, 0);
+    KUNIT_EXPECT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph, id), 0);
+}
+
+/* 閒置的時鐘歸還 token，下一次調頻重新取得 */
+static void scmi_xfer_cache_idle_returns_tokens(struct kunit *test)
+{
+    struct scmi_xfer_mock *mock = test->priv;
+    struct scmi_clk_xfer_cache *cache = &mock->ci.xfer_cache;
+
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph, 2), 0);
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_set_fast(&mock->ph, 2,
+                                                   1200000000ULL), 0);
+    KUNIT_EXPECT_EQ(test, mock_tokens_held(mock), 2);
+
+    /* 最近剛用過：不歸還 */
+    cancel_delayed_work_sync(&cache->idle_work);
+    scmi_clock_xfer_idle_work(&cache->idle_work.work);
+    KUNIT_EXPECT_EQ(test, mock_tokens_held(mock), 2);
+
+    cancel_delayed_work_sync(&cache->idle_work);
+    cache->slots[2].last_used =
+        jiffies - msecs_to_jiffies(SCMI_CLK_XFER_IDLE_MS) - 1;
+    scmi_clock_xfer_idle_work(&cache->idle_work.work);
+    KUNIT_EXPECT_EQ(test, mock_tokens_held(mock), 0);
+    KUNIT_EXPECT_EQ(test, mock->puts, 2);
+
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_set_fast(&mock->ph, 2,
+                                                   600000000ULL), 0);
+    KUNIT_EXPECT_EQ(test, mock->gets, 4);
+    KUNIT_EXPECT_EQ(test, mock->last_rate, 600000000ULL);
+}
+
+static void scmi_xfer_cache_release_drains(struct kunit *test)
+{
+    struct scmi_xfer_mock *mock = test->priv;
+
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph, 4), 0);
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_set_fast(&mock->ph, 4, 1), 0);
+    KUNIT_EXPECT_EQ(test, mock_tokens_held(mock), 2);
+
+    scmi_clock_rate_xfer_release(&mock->ph, 4);
+    KUNIT_EXPECT_EQ(test, mock_tokens_held(mock), 0);
+
+    /* 解除保留後改走一般路徑 */
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_set_fast(&mock->ph, 4, 2), 0);
+    KUNIT_EXPECT_EQ(test, mock->gets, 3);
+    KUNIT_EXPECT_EQ(test, mock_tokens_held(mock), 0);
+}
+
+/*
+ * benchmark：同樣的 RATE_SET 迴圈，保留路徑與一般路徑各跑一次，
+ * 時間都涵蓋完整的操作 (含 mock do_xfer)。
+ * 斷言只檢查配置次數；時間只印出來，不作為通過條件
+ */
+static void scmi_xfer_cache_bench(struct kunit *test)
+{
+    struct scmi_xfer_mock *mock = test->priv;
+    u64 fast_ns, slow_ns, fast_cycles, slow_cycles;
+    unsigned int gets;
+    cycles_t c0;
+    ktime_t t0;
+    int i;
+
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_xfer_reserve(&mock->ph, 0), 0);
+    /* 先取得 xfer，迴圈內量穩定狀態 */
+    KUNIT_ASSERT_EQ(test, scmi_clock_rate_set_fast(&mock->ph, 0, 1), 0);
+
+    gets = mock->gets;
+    t0 = ktime_get();
+    c0 = get_cycles();
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+        scmi_clock_rate_set_fast(&mock->ph, 0, 1000000000ULL + i);
+    fast_cycles = get_cycles() - c0;
+    fast_ns = ktime_to_ns(ktime_sub(ktime_get(), t0));
+    KUNIT_EXPECT_EQ(test, mock->gets - gets, 0);
+
+    gets = mock->gets;
+    t0 = ktime_get();
+    c0 = get_cycles();
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+        scmi_clock_rate_set_fast(&mock->ph, 7, 1000000000ULL + i);
+    slow_cycles = get_cycles() - c0;
+    slow_ns = ktime_to_ns(ktime_sub(ktime_get(), t0));
+    KUNIT_EXPECT_EQ(test, mock->gets - gets, BENCH_ITERATIONS);
+
+    kunit_info(test, "set_rate x%d: reserved %llu ns/op %llu cycles/op, "
+               "xfer_get_init 0/op\n", BENCH_ITERATIONS,
+               div_u64(fast_ns, BENCH_ITERATIONS),
+               div_u64(fast_cycles, BENCH_ITERATIONS));
+    kunit_info(test, "set_rate x%d: normal   %llu ns/op %llu cycles/op, "
+               "xfer_get_init 1/op\n", BENCH_ITERATIONS,
+               div_u64(slow_ns, BENCH_ITERATIONS),
+               div_u64(slow_cycles, BENCH_ITERATIONS));
+}
+
+static struct kunit_case scmi_xfer_cache_test_cases[] = {
+    KUNIT_CASE(scmi_xfer_cache_fast_set_no_alloc),
+    KUNIT_CASE(scmi_xfer_cache_fast_set_high_word),
+    KUNIT_CASE(scmi_xfer_cache_fast_get),
+    KUNIT_CASE(scmi_xfer_cache_slow_path_allocs),
+    KUNIT_CASE(scmi_xfer_cache_reserve_limit),
+    KUNIT_CASE(scmi_xfer_cache_idle_returns_tokens),
+    KUNIT_CASE(scmi_xfer_cache_release_drains),
+    KUNIT_CASE_SLOW(scmi_xfer_cache_bench),
+    {}
+};
+
+static struct kunit_suite scmi_xfer_cache_test_suite = {
+    .name = "scmi-clock-xfer-cache",
+    .init = scmi_xfer_cache_test_init,
+    .exit = scmi_xfer_cache_test_exit,
+    .test_cases = scmi_xfer_cache_test_cases,
+};
+
+kunit_test_suite(scmi_xfer_cache_test_suite);
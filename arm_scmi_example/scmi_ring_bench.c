@@ -0,0 +1,270 @@
+/*
+ * SCMI Ring vs Single-Slot Shared Memory Benchmark (host simulator)
+ *
+ * 在 Linux userspace 以兩個 thread 模擬 AP 與 SCP，比較兩種 A2P 通道格式
+ * 的訊息吞吐量：
+ *
+ *   single  struct scmi_shared_mem：一次一則，每則一次 doorbell、一次完成中斷
+ *   ring    scp_scmi_ring_channel.c 的格式：AP 一次放入一串請求，
+ *           SCP 休息時才需要 doorbell，清空 ring 後才發一次完成中斷
+ *
+ * doorbell 與完成中斷以 eventfd 模擬 (syscall + thread 喚醒，量級接近
+ * 真實的 IRQ 路徑)；SCP 處理每則訊息的時間以 busy-wait 模擬。
+ *
+ * 編譯與執行：
+ *   gcc -O2 -pthread -o scmi_ring_bench scmi_ring_bench.c
+ *   ./scmi_ring_bench [messages] [burst] [service_ns]
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RING_SLOTS      16
+#define SLOT_PAYLOAD    128
+
+#define SHMEM_CHAN_FREE (1U << 0)
+
+/* 與 scmi_shared_mem 相同的欄位 (省略 reserved) */
+struct single_shmem {
+    volatile uint32_t channel_status;
+    uint32_t length;
+    uint32_t msg_header;
+    uint8_t msg_payload[SLOT_PAYLOAD];
+};
+
+/* 與 scp_scmi_ring_channel.c 相同的 ring 佈局 */
+struct ring_slot {
+    uint32_t length;
+    uint32_t msg_header;
+    uint8_t msg_payload[SLOT_PAYLOAD];
+};
+
+struct ring_shmem {
+    volatile uint32_t req_prod;
+    volatile uint32_t req_cons;
+    volatile uint32_t scp_need_doorbell;
+    struct ring_slot slots[RING_SLOTS];
+};
+
+struct bench {
+    bool ring;
+    unsigned int messages;
+    unsigned int burst;
+    unsigned int service_ns;
+
+    struct single_shmem single;
+    struct ring_shmem rb;
+
+    /* AP -> SCP doorbell、SCP -> AP 完成中斷 */
+    int doorbell_fd;
+    int irq_fd;
+    volatile bool stop;
+
+    /* 統計 */
+    unsigned long doorbells;
+    unsigned long irqs;
+    unsigned long wakeups;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void busy_wait_ns(unsigned int ns)
+{
+    uint64_t end = now_ns() + ns;
+
+    while (now_ns() < end)
+        ;
+}
+
+static void signal_fd(int fd)
+{
+    uint64_t one = 1;
+
+    (void)write(fd, &one, sizeof(one));
+}
+
+static void wait_fd(int fd)
+{
+    uint64_t val;
+
+    (void)read(fd, &val, sizeof(val));
+}
+
+/* SCP 端的 handler：模擬 RATE_SET 的處理時間並寫回 status */
+static void scp_handle(uint8_t *payload, uint32_t *length, unsigned int ns)
+{
+    int32_t status = 0;
+
+    busy_wait_ns(ns);
+    memcpy(payload, &status, sizeof(status));
+    *length = sizeof(uint32_t) * 2;
+}
+
+static void *scp_thread(void *arg)
+{
+    struct bench *b = arg;
+    struct ring_shmem *rb = &b->rb;
+
+    for (;;) {
+        wait_fd(b->doorbell_fd);
+        if (b->stop)
+            break;
+        b->wakeups++;
+
+        if (!b->ring) {
+            scp_handle(b->single.msg_payload, &b->single.length, b->service_ns);
+            __atomic_store_n(&b->single.channel_status, SHMEM_CHAN_FREE,
+                             __ATOMIC_RELEASE);
+            b->irqs++;
+            signal_fd(b->irq_fd);
+            continue;
+        }
+
+        /* 與 scmi_ring_fetch() 相同：清空 ring 後設旗標並再檢查一次 */
+        for (;;) {
+            while (rb->req_cons != __atomic_load_n(&rb->req_prod,
+                                                   __ATOMIC_ACQUIRE)) {
+                struct ring_slot *slot = &rb->slots[rb->req_cons % RING_SLOTS];
+
+                scp_handle(slot->msg_payload, &slot->length, b->service_ns);
+                __atomic_store_n(&rb->req_cons, rb->req_cons + 1,
+                                 __ATOMIC_RELEASE);
+            }
+
+            __atomic_store_n(&rb->scp_need_doorbell, 1, __ATOMIC_SEQ_CST);
+            if (rb->req_cons == __atomic_load_n(&rb->req_prod,
+                                                __ATOMIC_SEQ_CST))
+                break;
+            rb->scp_need_doorbell = 0;
+        }
+
+        b->irqs++;
+        signal_fd(b->irq_fd);
+    }
+
+    return NULL;
+}
+
+/* single-slot：每則都等 CHANNEL_FREE，再送下一則 */
+static void ap_single(struct bench *b)
+{
+    unsigned int i;
+
+    for (i = 0; i < b->messages; i++) {
+        b->single.channel_status = 0;
+        b->single.msg_header = i;
+        b->single.length = sizeof(uint32_t) * 4;
+        b->doorbells++;
+        signal_fd(b->doorbell_fd);
+
+        wait_fd(b->irq_fd);
+        while (!(__atomic_load_n(&b->single.channel_status,
+                                 __ATOMIC_ACQUIRE) & SHMEM_CHAN_FREE))
+            ;
+    }
+}
+
+/* ring：一次放入 burst 則，SCP 在休息時才敲 doorbell，等整批回應 */
+static void ap_ring(struct bench *b)
+{
+    struct ring_shmem *rb = &b->rb;
+    unsigned int sent = 0, n, i;
+    uint32_t prod = 0;
+
+    while (sent < b->messages) {
+        n = b->burst;
+        if (n > b->messages - sent)
+            n = b->messages - sent;
+        if (n > RING_SLOTS)
+            n = RING_SLOTS;
+
+        for (i = 0; i < n; i++) {
+            struct ring_slot *slot = &rb->slots[prod % RING_SLOTS];
+
+            slot->msg_header = sent + i;
+            slot->length = sizeof(uint32_t) * 4;
+            prod++;
+            __atomic_store_n(&rb->req_prod, prod, __ATOMIC_SEQ_CST);
+        }
+
+        if (__atomic_load_n(&rb->scp_need_doorbell, __ATOMIC_SEQ_CST)) {
+            rb->scp_need_doorbell = 0;
+            b->doorbells++;
+            signal_fd(b->doorbell_fd);
+        }
+
+        while (__atomic_load_n(&rb->req_cons, __ATOMIC_ACQUIRE) != prod)
+            wait_fd(b->irq_fd);
+
+        sent += n;
+    }
+}
+
+static void run(bool ring, unsigned int messages, unsigned int burst,
+                unsigned int service_ns)
+{
+    struct bench *b = calloc(1, sizeof(*b));
+    pthread_t scp;
+    uint64_t start, elapsed;
+
+    b->ring = ring;
+    b->messages = messages;
+    b->burst = burst;
+    b->service_ns = service_ns;
+    b->doorbell_fd = eventfd(0, 0);
+    b->irq_fd = eventfd(0, 0);
+    b->rb.scp_need_doorbell = 1;
+    b->single.channel_status = SHMEM_CHAN_FREE;
+
+    pthread_create(&scp, NULL, scp_thread, b);
+
+    start = now_ns();
+    if (ring)
+        ap_ring(b);
+    else
+        ap_single(b);
+    elapsed = now_ns() - start;
+
+    b->stop = true;
+    signal_fd(b->doorbell_fd);
+    pthread_join(scp, NULL);
+
+    printf("%-6s msgs=%u burst=%-2u %10.0f msg/s  doorbells=%lu irqs=%lu "
+           "msgs/wakeup=%.1f\n",
+           ring ? "ring" : "single", messages, ring ? burst : 1,
+           messages * 1e9 / elapsed, b->doorbells, b->irqs,
+           b->wakeups ? (double)messages / b->wakeups : 0.0);
+
+    close(b->doorbell_fd);
+    close(b->irq_fd);
+    free(b);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int messages = argc > 1 ? atoi(argv[1]) : 100000;
+    unsigned int burst = argc > 2 ? atoi(argv[2]) : 4;
+    unsigned int service_ns = argc > 3 ? atoi(argv[3]) : 2000;
+
+    if (burst == 0)
+        burst = 1;
+
+    run(false, messages, burst, service_ns);
+    run(true, messages, burst, service_ns);
+
+    return 0;
+}
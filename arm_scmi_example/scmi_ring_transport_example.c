@@ -0,0 +1,408 @@
+/*
+ * SCMI Ring Shared-Memory Transport Example
+ *
+ * AP 端對應 scp_scmi_ring_channel.c 的傳輸層：A2P 通道的共享記憶體
+ * 是一個多 slot 的 ring，而不是只能放一則訊息的 struct scmi_shared_mem。
+ *
+ *   - send_message 不再 spin 等 CHANNEL_FREE，只要 ring 還有空 slot
+ *     就直接寫入並遞增 req_prod；多個 CPU 可同時有請求在 ring 中
+ *   - 只有 SCP 設定了 scp_need_doorbell (已清空 ring、正在休息) 時
+ *     才敲 doorbell，SCP 忙碌期間送出的請求不再額外觸發中斷
+ *   - 完成中斷處理 [tail, req_cons) 之間所有已回應的 slot，
+ *     依 msg_header 的 token 交給 SCMI core
+ *   - P2A 通知通道維持一般的 single-slot shmem
+ *
+ * 由 device tree 選擇：SCMI 節點 compatible = "arm,scmi-ring"，
+ * A2P 的 shmem 節點 compatible = "arm,scmi-shmem-ring" (見檔尾範例)。
+ * 需在 drivers/firmware/arm_scmi/driver.c 的 scmi_of_match 加入：
+ *   { .compatible = "arm,scmi-ring", .data = &scmi_ring_desc },
+ *
+ * 對應 drivers/firmware/arm_scmi/mailbox.c，並沿用 shmem.c 的 helper
+ */
+
+#include <linux/device.h>
+#include <linux/err.h>
+#include <linux/io.h>
+#include <linux/log2.h>
+#include <linux/mailbox_client.h>
+#include <linux/of.h>
+#include <linux/of_address.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+
+#include "common.h"
+
+#define SCMI_RING_MAGIC 0x474E5253  /* "SRNG" */
+
+/* 與 scp_scmi_ring_channel.c 相同的共享記憶體佈局 */
+struct scmi_ring_hdr {
+    __le32 magic;
+    __le32 slot_count;
+    __le32 slot_size;
+    __le32 flags;
+#define SCMI_RING_FLAG_INTR_ENABLED BIT(0)
+    __le32 req_prod;
+    __le32 req_cons;
+    __le32 scp_need_doorbell;
+    __le32 reserved;
+};
+
+struct scmi_ring_slot {
+    __le32 length;
+    __le32 msg_header;
+    u8 msg_payload[];
+};
+
+struct scmi_ring {
+    struct mbox_client cl;
+    struct mbox_chan *chan;
+    struct scmi_chan_info *cinfo;
+
+    /* A2P ring 通道；false 表示一般 shmem (P2A 通知通道) */
+    bool ring;
+    struct scmi_shared_mem __iomem *shmem;
+    struct scmi_ring_hdr __iomem *hdr;
+    void __iomem *slots;
+    u32 slot_count;
+    u32 slot_size;
+
+    /* 保護 prod/tail 與 slot 寫入 */
+    spinlock_t lock;
+    u32 prod;
+    /* 下一個待交給 core 的回應 */
+    u32 tail;
+    /* token -> 送出時的 ring 序號，poll_done/fetch_response 用來找 slot */
+    u32 *token_seq;
+
+    /* 統計 */
+    u64 sent;
+    u64 doorbells;
+    u64 full;
+};
+
+#define client_to_scmi_ring(c) container_of(c, struct scmi_ring, cl)
+
+static struct scmi_ring_slot __iomem *scmi_ring_slot(struct scmi_ring *r,
+                                                     u32 seq)
+{
+    return r->slots + (seq & (r->slot_count - 1)) * r->slot_size;
+}
+
+static size_t scmi_ring_max_payload(struct scmi_ring *r)
+{
+    return r->slot_size - sizeof(struct scmi_ring_slot);
+}
+
+/*
+ * 完成中斷：把 [tail, req_cons) 的回應依序交給 core；
+ * P2A 通道則照一般 shmem 流程處理
+ */
+static void scmi_ring_rx_callback(struct mbox_client *cl, void *m)
+{
+    struct scmi_ring *r = client_to_scmi_ring(cl);
+    unsigned long flags;
+    u32 cons;
+
+    if (!r->ring) {
+        scmi_rx_callback(r->cinfo, shmem_read_header(r->shmem), NULL);
+        return;
+    }
+
+    spin_lock_irqsave(&r->lock, flags);
+
+    cons = ioread32(&r->hdr->req_cons);
+    /* 讀到 req_cons 之後才讀 slot 內容 */
+    rmb();
+
+    while (r->tail != cons) {
+        struct scmi_ring_slot __iomem *slot = scmi_ring_slot(r, r->tail);
+
+        r->tail++;
+        scmi_rx_callback(r->cinfo, ioread32(&slot->msg_header), NULL);
+    }
+
+    spin_unlock_irqrestore(&r->lock, flags);
+}
+
+static bool scmi_ring_chan_available(struct device_node *of_node, int idx)
+{
+    return !of_parse_phandle_with_args(of_node, "mboxes", "#mbox-cells",
+                                       idx, NULL);
+}
+
+static int scmi_ring_map(struct scmi_ring *r, struct device *dev,
+                         struct device_node *shmem)
+{
+    struct resource res;
+    void __iomem *base;
+    size_t size;
+    int ret;
+
+    ret = of_address_to_resource(shmem, 0, &res);
+    if (ret)
+        return ret;
+
+    size = resource_size(&res);
+    base = devm_ioremap(dev, res.start, size);
+    if (!base)
+        return -EADDRNOTAVAIL;
+
+    if (!of_device_is_compatible(shmem, "arm,scmi-shmem-ring")) {
+        r->shmem = base;
+        return 0;
+    }
+
+    /* SCP 初始化 ring 後才寫入 magic */
+    r->hdr = base;
+    if (ioread32(&r->hdr->magic) != SCMI_RING_MAGIC)
+        return -EPROBE_DEFER;
+
+    r->slot_count = ioread32(&r->hdr->slot_count);
+    r->slot_size = ioread32(&r->hdr->slot_size);
+    if (!is_power_of_2(r->slot_count) ||
+        r->slot_size <= sizeof(struct scmi_ring_slot) ||
+        sizeof(*r->hdr) + (size_t)r->slot_count * r->slot_size > size)
+        return -EINVAL;
+
+    r->slots = base + sizeof(*r->hdr);
+    r->prod = ioread32(&r->hdr->req_prod);
+    r->tail = r->prod;
+    r->ring = true;
+
+    r->token_seq = devm_kcalloc(dev, MSG_TOKEN_MAX, sizeof(*r->token_seq),
+                                GFP_KERNEL);
+    if (!r->token_seq)
+        return -ENOMEM;
+
+    iowrite32(SCMI_RING_FLAG_INTR_ENABLED, &r->hdr->flags);
+
+    dev_info(dev, "SCMI ring channel: %u slots x %u bytes\n",
+             r->slot_count, r->slot_size);
+
+    return 0;
+}
+
+static int scmi_ring_chan_setup(struct scmi_chan_info *cinfo,
+                                struct device *dev, bool tx)
+{
+    const char *desc = tx ? "Tx" : "Rx";
+    struct device *cdev = cinfo->dev;
+    struct device_node *shmem;
+    struct scmi_ring *r;
+    int ret, idx = tx ? 0 : 1;
+
+    r = devm_kzalloc(dev, sizeof(*r), GFP_KERNEL);
+    if (!r)
+        return -ENOMEM;
+
+    shmem = of_parse_phandle(cdev->of_node, "shmem", idx);
+    if (!shmem)
+        return -ENODEV;
+
+    /* ring 只承載 A2P 請求 */
+    if (!tx && of_device_is_compatible(shmem, "arm,scmi-shmem-ring")) {
+        of_node_put(shmem);
+        return -EINVAL;
+    }
+
+    ret = scmi_ring_map(r, dev, shmem);
+    of_node_put(shmem);
+    if (ret)
+        return ret;
+
+    spin_lock_init(&r->lock);
+
+    r->cl.dev = cdev;
+    r->cl.tx_prepare = NULL;
+    r->cl.rx_callback = scmi_ring_rx_callback;
+    r->cl.tx_block = false;
+    r->cl.knows_txdone = tx;
+
+    r->chan = mbox_request_channel(&r->cl, idx);
+    if (IS_ERR(r->chan)) {
+        ret = PTR_ERR(r->chan);
+        if (ret != -EPROBE_DEFER)
+            dev_err(cdev, "failed to request SCMI %s mailbox\n", desc);
+        return ret;
+    }
+
+    cinfo->transport_info = r;
+    r->cinfo = cinfo;
+
+    return 0;
+}
+
+static int scmi_ring_chan_free(int id, void *p, void *data)
+{
+    struct scmi_chan_info *cinfo = p;
+    struct scmi_ring *r = cinfo->transport_info;
+
+    if (r && !IS_ERR(r->chan)) {
+        mbox_free_channel(r->chan);
+        cinfo->transport_info = NULL;
+        r->chan = NULL;
+        r->cinfo = NULL;
+    }
+
+    scmi_free_channel(cinfo, data, id);
+
+    return 0;
+}
+
+/*
+ * 寫入下一個空 slot；只有 SCP 在休息時才敲 doorbell
+ * ring 滿時回 -EBUSY (desc.max_msg 應不大於 slot 數，正常不會發生)
+ */
+static int scmi_ring_send_message(struct scmi_chan_info *cinfo,
+                                  struct scmi_xfer *xfer)
+{
+    struct scmi_ring *r = cinfo->transport_info;
+    struct scmi_ring_slot __iomem *slot;
+    unsigned long flags;
+    bool doorbell;
+    int ret;
+
+    if (xfer->tx.len > scmi_ring_max_payload(r))
+        return -EMSGSIZE;
+
+    spin_lock_irqsave(&r->lock, flags);
+
+    if (r->prod - r->tail >= r->slot_count) {
+        r->full++;
+        spin_unlock_irqrestore(&r->lock, flags);
+        return -EBUSY;
+    }
+
+    slot = scmi_ring_slot(r, r->prod);
+    iowrite32(sizeof(slot->msg_header) + xfer->tx.len, &slot->length);
+    iowrite32(pack_scmi_header(&xfer->hdr), &slot->msg_header);
+    if (xfer->tx.buf)
+        memcpy_toio(slot->msg_payload, xfer->tx.buf, xfer->tx.len);
+
+    r->token_seq[xfer->hdr.seq] = r->prod;
+    r->prod++;
+
+    /* slot 內容先於 req_prod 可見；req_prod 再先於讀取 doorbell 旗標 */
+    iowrite32(r->prod, &r->hdr->req_prod);
+    mb();
+    doorbell = ioread32(&r->hdr->scp_need_doorbell);
+    r->sent++;
+
+    spin_unlock_irqrestore(&r->lock, flags);
+
+    if (!doorbell)
+        return 0;
+
+    r->doorbells++;
+    ret = mbox_send_message(r->chan, xfer);
+    if (ret < 0)
+        return ret;
+
+    /* doorbell 本身不需要等待 SCP 回應，立刻釋放 mailbox */
+    mbox_client_txdone(r->chan, 0);
+
+    return 0;
+}
+
+static void scmi_ring_mark_txdone(struct scmi_chan_info *cinfo, int ret,
+                                  struct scmi_xfer *__unused)
+{
+    /* doorbell 在 send_message 中已經 txdone */
+}
+
+/* xfer 送出時的序號已被 req_cons 越過，表示回應已寫回 */
+static bool scmi_ring_xfer_done(struct scmi_ring *r, struct scmi_xfer *xfer)
+{
+    return (s32)(ioread32(&r->hdr->req_cons) -
+                 r->token_seq[xfer->hdr.seq]) > 0;
+}
+
+static void scmi_ring_fetch_response(struct scmi_chan_info *cinfo,
+                                     struct scmi_xfer *xfer)
+{
+    struct scmi_ring *r = cinfo->transport_info;
+    struct scmi_ring_slot __iomem *slot;
+    size_t len;
+
+    if (!r->ring) {
+        shmem_fetch_response(r->shmem, xfer);
+        return;
+    }
+
+    slot = scmi_ring_slot(r, r->token_seq[xfer->hdr.seq]);
+    len = ioread32(&slot->length);
+
+    xfer->hdr.status = ioread32(slot->msg_payload);
+    /* 扣掉 msg_header 與 status 兩個 word */
+    xfer->rx.len = min_t(size_t, xfer->rx.len, len > 8 ? len - 8 : 0);
+    memcpy_fromio(xfer->rx.buf, slot->msg_payload + 4, xfer->rx.len);
+}
+
+static void scmi_ring_fetch_notification(struct scmi_chan_info *cinfo,
+                                         size_t max_len,
+                                         struct scmi_xfer *xfer)
+{
+    struct scmi_ring *r = cinfo->transport_info;
+
+    shmem_fetch_notification(r->shmem, max_len, xfer);
+}
+
+static void scmi_ring_clear_channel(struct scmi_chan_info *cinfo)
+{
+    struct scmi_ring *r = cinfo->transport_info;
+
+    shmem_clear_channel(r->shmem);
+}
+
+static bool scmi_ring_poll_done(struct scmi_chan_info *cinfo,
+                                struct scmi_xfer *xfer)
+{
+    struct scmi_ring *r = cinfo->transport_info;
+
+    if (!r->ring)
+        return shmem_poll_done(r->shmem, xfer);
+
+    return scmi_ring_xfer_done(r, xfer);
+}
+
+static const struct scmi_transport_ops scmi_ring_ops = {
+    .chan_available = scmi_ring_chan_available,
+    .chan_setup = scmi_ring_chan_setup,
+    .chan_free = scmi_ring_chan_free,
+    .send_message = scmi_ring_send_message,
+    .mark_txdone = scmi_ring_mark_txdone,
+    .fetch_response = scmi_ring_fetch_response,
+    .fetch_notification = scmi_ring_fetch_notification,
+    .clear_channel = scmi_ring_clear_channel,
+    .poll_done = scmi_ring_poll_done,
+};
+
+/* max_msg 不超過 ring slot 數 (SCP 端設定為 16) */
+const struct scmi_desc scmi_ring_desc = {
+    .ops = &scmi_ring_ops,
+    .max_rx_timeout_ms = 30,
+    .max_msg = 16,
+    .max_msg_size = 128,
+};
+
+/*
+ * Device Tree 範例：
+ *
+ *   firmware {
+ *       scmi {
+ *           compatible = "arm,scmi-ring";
+ *           mboxes = <&mhu 0 0>, <&mhu 0 1>;
+ *           shmem = <&cpu_scp_ring>, <&scp_cpu_p2a>;
+ *       };
+ *   };
+ *
+ *   cpu_scp_ring: scp-shmem@0 {
+ *       compatible = "arm,scmi-shmem-ring";
+ *       reg = <0x0 0x920>;     // 32-byte 標頭 + 16 x 144-byte slot
+ *   };
+ *
+ *   scp_cpu_p2a: scp-shmem@a00 {
+ *       compatible = "arm,scmi-shmem";
+ *       reg = <0xa00 0x80>;
+ *   };
+ */
@@ -0,0 +1,804 @@
+/*
+ * SCMI SMC Fast Path Monitor Stand-in (SCP-firmware host arch)
+ *
+ * 在 Linux userspace 以 SCP-firmware 的 host arch 執行真正的
+ * mod_scmi + mod_scmi_clock (scp_firmware_clock_handler.c) + mod_clock +
+ * mod_sw_pll (scp_sw_pll_model.c)，前面接上 EL3 monitor 的替身，
+ * 驗證 scmi_smc_fast_transport_example.c 的暫存器格式與 SCP 端的
+ * scmi_clock_reg_process()：
+ *
+ *   AP (ap_*)             編碼方式與 transport 範例相同
+ *        | SMC
+ *   EL3 (monitor_smc)     SMC_ID：    AP 已寫好 shmem，只送 doorbell
+ *                         SMC_FAST_ID：x1-x4 寫入 mailbox 資料暫存器，
+ *                                      送 doorbell，等 SCP 清除 busy 後
+ *                                      把 4 個回傳字放進 x0-x3
+ *        | doorbell (實機為 MHU 中斷)
+ *   mod_smc_fast (本檔，SCP 端)
+ *        shmem 通道：   mod_scmi 的 transport (signal_message/respond)
+ *        P2A 通道：     mod_scmi 的 transport (transmit)
+ *        暫存器通道：   中斷中只排入事件，事件中呼叫
+ *                       mod_scmi_clock_reg_api.process(service_id, ...)
+ *        |
+ *   mod_scmi -> mod_scmi_clock -> mod_clock -> mod_sw_pll
+ *
+ * 實機上 SCP 是另一顆處理器，EL3 只能經 mailbox 把暫存器交過去；
+ * mailbox 通道只對應到 secure world，通道設定中的 service_id 就是
+ * 這個代理在 mod_scmi 的 A2P service，因此兩條路徑看到的是同一個代理、
+ * 同一個 token bucket、同一組權限，暫存器 RATE_SET 的結果也經這個代理的
+ * P2A 通道以 RATE_CHANGED 送回。
+ *
+ * 設定見 example_platform_clock_config.c 的 config_smc_fast，其餘沿用
+ * Host 模擬配置；SCMI clock ID 5 (顯示 pixel clock，25-200MHz，
+ * 1MHz 步進，開機時關閉) 由 OSPM 調頻，0 (CPU0) 屬於 PERF，
+ * CLOCK 協議的 RATE_SET 回 SCMI_DENIED。
+ *
+ * 先跑一組一致性檢查 (兩條路徑的狀態與頻率相同，暫存器 RATE_SET 的
+ * 結果由通知送回)，再量測兩條路徑每次呼叫的時間。mod_sw_pll 以虛擬時間
+ * 模擬 relock：shmem 的同步 RATE_SET 要等到 PLL 完成才回應，暫存器路徑
+ * 在接受時就返回，剩下的工作 (PLL 完成與通知) 在量測之外跑完。
+ * 主機上的 shmem 是 cacheable 記憶體，實機的非 cacheable 存取或
+ * cache 維護與中斷延遲都沒有計入。
+ *
+ * OSPM 的 token bucket 是每 ms 20 則，量測迴圈以 SMC_FAST_BENCH_PACE_NS
+ * 為間隔送出請求，兩條路徑都不會收到 SCMI_BUSY。
+ *
+ * 建置方式與 scmi_virtio_backend.c 相同：作為 host product
+ * (arch/none/host) 的一部分，以 mod_smc_fast 取代 mod_virtio_scmi，
+ * main() 以 sub-system mode 初始化框架。
+ *   ./smc_fast_monitor [iterations]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <mod_scmi.h>
+#include <mod_scmi_clock.h>
+
+#include <fwk_arch.h>
+#include <fwk_event.h>
+#include <fwk_id.h>
+#include <fwk_log.h>
+#include <fwk_mm.h>
+#include <fwk_module.h>
+#include <fwk_module_idx.h>
+#include <fwk_status.h>
+
+#define SMC_ID          0x82000010U
+#define SMC_FAST_ID     0x82000011U
+#define SMCCC_RET_NOT_SUPPORTED ((uint64_t)-1)
+
+#define SCMI_PROTOCOL_CLOCK         0x14
+#define SCMI_CLOCK_DESCRIBE_RATES   0x4
+#define SCMI_CLOCK_RATE_SET         0x5
+#define SCMI_CLOCK_RATE_GET         0x6
+#define SCMI_CLOCK_CONFIG_SET       0x7
+#define SCMI_CLOCK_RATE_CHANGED     0x0
+
+/* message header：[7:0] message_id、[9:8] type、[17:10] protocol_id */
+#define SCMI_MSG_TYPE_NOTIFICATION  0x3
+#define SCMI_HDR_MSG_ID(h)          ((h) & 0xFF)
+#define SCMI_HDR_TYPE(h)            (((h) >> 8) & 0x3)
+#define SCMI_HDR_PROTOCOL_ID(h)     (((h) >> 10) & 0xFF)
+
+#define SHMEM_CHAN_FREE (1U << 0)
+#define SHMEM_MAX_PAYLOAD 128
+
+/* 檢查用的時鐘 (example_platform_clock_config.c 的 OSPM 時鐘表) */
+#define CLK_PERF_OWNED  0
+#define CLK_PIXEL       5
+#define CLK_INVALID     6
+
+/* 每則請求的間隔：OSPM token bucket 每 ms 補 20 個，留一點餘量 */
+#define SMC_FAST_BENCH_PACE_NS 60000
+
+/* scp_sw_pll_model.c 的虛擬時間介面 */
+uint64_t sw_pll_next_completion_ns(void);
+void sw_pll_advance_to(uint64_t t_ns);
+
+/* host arch 的初始化驅動 (SCP-firmware arch/none/host 提供) */
+extern const struct fwk_arch_init_driver host_arch_init_driver;
+
+/* ---- SCP 端：mod_smc_fast ---------------------------------------- */
+
+/* struct scmi_shared_mem 的佈局 */
+struct scmi_shmem {
+    uint32_t reserved;
+    volatile uint32_t channel_status;
+    uint32_t reserved1[2];
+    uint32_t flags;
+    uint32_t length;
+    uint32_t msg_header;
+    uint8_t msg_payload[SHMEM_MAX_PAYLOAD];
+};
+
+/*
+ * 暫存器 mailbox (實機為 MHU 通道的資料暫存器，只對應到 secure world)
+ * EL3 寫入 args、設定 busy 後送 doorbell；SCP 寫回 ret 後清除 busy
+ */
+struct smc_fast_mbx {
+    uint32_t args[SCMI_CLOCK_REG_ARGS];
+    uint32_t ret[SCMI_CLOCK_REG_RETS];
+    volatile uint32_t busy;
+};
+
+enum mod_smc_fast_channel_type {
+    /* SMC_ID：shmem A2P 通道 */
+    MOD_SMC_FAST_CHANNEL_SHMEM,
+    /* P2A 通知通道 */
+    MOD_SMC_FAST_CHANNEL_P2A,
+    /* SMC_FAST_ID：暫存器 mailbox */
+    MOD_SMC_FAST_CHANNEL_REG,
+};
+
+/* 元素設定 (實際專案中應放在 mod_smc_fast.h) */
+struct mod_smc_fast_channel_config {
+    enum mod_smc_fast_channel_type type;
+
+    /*
+     * shmem/P2A：此通道的 mod_scmi service；
+     * 暫存器：所屬代理的 A2P service，代理身分與權限由它決定
+     */
+    fwk_id_t service_id;
+};
+
+/* 元素索引，與 config_smc_fast 的元素表一致 */
+enum smc_fast_channel_idx {
+    SMC_FAST_CHANNEL_IDX_SHMEM,
+    SMC_FAST_CHANNEL_IDX_P2A,
+    SMC_FAST_CHANNEL_IDX_REG,
+    SMC_FAST_CHANNEL_IDX_COUNT,
+};
+
+enum smc_fast_event_idx {
+    /* 暫存器通道的 doorbell */
+    SMC_FAST_EVENT_IDX_REG,
+    SMC_FAST_EVENT_IDX_COUNT,
+};
+
+static const fwk_id_t smc_fast_event_reg =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_SMC_FAST, SMC_FAST_EVENT_IDX_REG);
+
+struct smc_fast_channel {
+    const struct mod_smc_fast_channel_config *config;
+    struct scmi_shmem shmem;
+    struct smc_fast_mbx mbx;
+};
+
+/* P2A 通道收到的最後一則通知 (檢查用) */
+struct smc_fast_notification {
+    unsigned int count;
+    uint32_t header;
+    uint32_t payload[SHMEM_MAX_PAYLOAD / sizeof(uint32_t)];
+};
+
+struct smc_fast_ctx {
+    struct smc_fast_channel *channels;
+    unsigned int channel_count;
+
+    const struct mod_scmi_from_transport_api *scmi_api;
+    const struct mod_scmi_clock_reg_api *reg_api;
+
+    struct smc_fast_notification last_notification;
+};
+
+static struct smc_fast_ctx smc_fast_ctx;
+
+static struct smc_fast_channel *smc_fast_channel_get(fwk_id_t channel_id)
+{
+    return &smc_fast_ctx.channels[fwk_id_get_element_idx(channel_id)];
+}
+
+/*
+ * doorbell 中斷 (實機為 MHU 的 ISR)
+ * shmem 通道與 SMT 相同，直接通知 mod_scmi；暫存器通道只排入事件，
+ * process() 在本模組的事件中呼叫
+ */
+static void smc_fast_doorbell_isr(unsigned int channel_idx)
+{
+    struct smc_fast_channel *channel = &smc_fast_ctx.channels[channel_idx];
+    fwk_id_t element_id = FWK_ID_ELEMENT(FWK_MODULE_IDX_SMC_FAST, channel_idx);
+    struct fwk_event event = {
+        .source_id = element_id,
+        .target_id = element_id,
+        .id = smc_fast_event_reg,
+    };
+
+    switch (channel->config->type) {
+    case MOD_SMC_FAST_CHANNEL_SHMEM:
+        if (smc_fast_ctx.scmi_api->signal_message(
+                channel->config->service_id) != FWK_SUCCESS)
+            fwk_log_error("[SMC-FAST] signal_message failed");
+        break;
+
+    case MOD_SMC_FAST_CHANNEL_REG:
+        if (fwk_put_event(&event) != FWK_SUCCESS)
+            fwk_log_error("[SMC-FAST] doorbell event lost");
+        break;
+
+    default:
+        break;
+    }
+}
+
+/*
+ * mod_scmi 所需的 transport API (shmem 與 P2A 通道)
+ */
+
+static int smc_fast_get_secure(fwk_id_t channel_id, bool *secure)
+{
+    *secure = false;
+
+    return FWK_SUCCESS;
+}
+
+static int smc_fast_get_max_payload_size(fwk_id_t channel_id, size_t *size)
+{
+    *size = SHMEM_MAX_PAYLOAD;
+
+    return FWK_SUCCESS;
+}
+
+static int smc_fast_get_message_header(fwk_id_t channel_id,
+                                       uint32_t *message_header)
+{
+    *message_header = smc_fast_channel_get(channel_id)->shmem.msg_header;
+
+    return FWK_SUCCESS;
+}
+
+static int smc_fast_get_payload(fwk_id_t channel_id, const void **payload,
+                                size_t *size)
+{
+    struct scmi_shmem *shmem = &smc_fast_channel_get(channel_id)->shmem;
+
+    if (shmem->length < sizeof(shmem->msg_header) ||
+        shmem->length - sizeof(shmem->msg_header) > SHMEM_MAX_PAYLOAD)
+        return FWK_E_SIZE;
+
+    *payload = shmem->msg_payload;
+    *size = shmem->length - sizeof(shmem->msg_header);
+
+    return FWK_SUCCESS;
+}
+
+static int smc_fast_write_payload(fwk_id_t channel_id, size_t offset,
+                                  const void *payload, size_t size)
+{
+    struct scmi_shmem *shmem = &smc_fast_channel_get(channel_id)->shmem;
+
+    if (offset > SHMEM_MAX_PAYLOAD || size > SHMEM_MAX_PAYLOAD - offset)
+        return FWK_E_SIZE;
+
+    memcpy(shmem->msg_payload + offset, payload, size);
+
+    return FWK_SUCCESS;
+}
+
+/* 回應寫回同一塊 shmem，交還通道 */
+static int smc_fast_respond(fwk_id_t channel_id, const void *payload,
+                            size_t size)
+{
+    struct scmi_shmem *shmem = &smc_fast_channel_get(channel_id)->shmem;
+
+    if (shmem->channel_status & SHMEM_CHAN_FREE)
+        return FWK_E_STATE;
+
+    if (size > SHMEM_MAX_PAYLOAD)
+        return FWK_E_SIZE;
+
+    memcpy(shmem->msg_payload, payload, size);
+    shmem->length = sizeof(shmem->msg_header) + size;
+    __atomic_store_n(&shmem->channel_status, SHMEM_CHAN_FREE,
+                     __ATOMIC_RELEASE);
+
+    return FWK_SUCCESS;
+}
+
+/* P2A 通知：寫入 P2A shmem，同時記錄下來供檢查 */
+static int smc_fast_transmit(fwk_id_t channel_id, uint32_t message_header,
+                             const void *payload, size_t size,
+                             bool request_ack_by_interrupt)
+{
+    struct smc_fast_channel *channel = smc_fast_channel_get(channel_id);
+    struct smc_fast_notification *last = &smc_fast_ctx.last_notification;
+
+    if (channel->config->type != MOD_SMC_FAST_CHANNEL_P2A)
+        return FWK_E_PARAM;
+
+    if (size > SHMEM_MAX_PAYLOAD)
+        return FWK_E_SIZE;
+
+    channel->shmem.msg_header = message_header;
+    channel->shmem.length = sizeof(message_header) + size;
+    memcpy(channel->shmem.msg_payload, payload, size);
+
+    last->count++;
+    last->header = message_header;
+    memset(last->payload, 0, sizeof(last->payload));
+    memcpy(last->payload, payload, size);
+
+    return FWK_SUCCESS;
+}
+
+static const struct mod_scmi_to_transport_api smc_fast_transport_api = {
+    .get_secure = smc_fast_get_secure,
+    .get_max_payload_size = smc_fast_get_max_payload_size,
+    .get_message_header = smc_fast_get_message_header,
+    .get_payload = smc_fast_get_payload,
+    .write_payload = smc_fast_write_payload,
+    .respond = smc_fast_respond,
+    .transmit = smc_fast_transmit,
+};
+
+/*
+ * 模組框架介面
+ */
+
+static int smc_fast_init(fwk_id_t module_id, unsigned int element_count,
+                         const void *data)
+{
+    if (element_count != SMC_FAST_CHANNEL_IDX_COUNT)
+        return FWK_E_PARAM;
+
+    smc_fast_ctx.channel_count = element_count;
+    smc_fast_ctx.channels = fwk_mm_calloc(element_count,
+                                          sizeof(struct smc_fast_channel));
+
+    return FWK_SUCCESS;
+}
+
+static int smc_fast_element_init(fwk_id_t element_id, unsigned int unused,
+                                 const void *data)
+{
+    struct smc_fast_channel *channel = smc_fast_channel_get(element_id);
+
+    if (data == NULL)
+        return FWK_E_PARAM;
+
+    channel->config = data;
+    channel->shmem.channel_status = SHMEM_CHAN_FREE;
+
+    return FWK_SUCCESS;
+}
+
+static int smc_fast_bind(fwk_id_t id, unsigned int round)
+{
+    int status;
+
+    if (round == 1 || !fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    status = fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_SCMI),
+                             FWK_ID_API(FWK_MODULE_IDX_SCMI,
+                                        MOD_SCMI_API_IDX_TRANSPORT),
+                             &smc_fast_ctx.scmi_api);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    return fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+                           FWK_ID_API(FWK_MODULE_IDX_SCMI_CLOCK,
+                                      MOD_SCMI_CLOCK_API_IDX_REG),
+                           &smc_fast_ctx.reg_api);
+}
+
+static int smc_fast_process_bind_request(fwk_id_t source_id,
+                                         fwk_id_t target_id,
+                                         fwk_id_t api_id,
+                                         const void **api)
+{
+    if (!fwk_id_is_type(target_id, FWK_ID_TYPE_ELEMENT) ||
+        smc_fast_channel_get(target_id)->config->type ==
+            MOD_SMC_FAST_CHANNEL_REG)
+        return FWK_E_ACCESS;
+
+    *api = &smc_fast_transport_api;
+
+    return FWK_SUCCESS;
+}
+
+/* 暫存器通道：交給 SCMI Clock，寫回結果後清除 busy */
+static int smc_fast_process_event(const struct fwk_event *event,
+                                  struct fwk_event *resp_event)
+{
+    struct smc_fast_channel *channel = smc_fast_channel_get(event->target_id);
+    struct smc_fast_mbx *mbx = &channel->mbx;
+    int status;
+
+    if (!fwk_id_is_equal(event->id, smc_fast_event_reg))
+        return FWK_E_PARAM;
+
+    status = smc_fast_ctx.reg_api->process(channel->config->service_id,
+                                           mbx->args, mbx->ret);
+    if (status != FWK_SUCCESS) {
+        memset(mbx->ret, 0, sizeof(mbx->ret));
+        mbx->ret[0] = (uint32_t)SCMI_GENERIC_ERROR;
+    }
+
+    __atomic_store_n(&mbx->busy, 0, __ATOMIC_RELEASE);
+
+    return FWK_SUCCESS;
+}
+
+/* 模組描述符 */
+const struct fwk_module module_smc_fast = {
+    .name = "SMC Fast Path",
+    .type = FWK_MODULE_TYPE_DRIVER,
+    .api_count = 1,
+    .event_count = SMC_FAST_EVENT_IDX_COUNT,
+    .init = smc_fast_init,
+    .element_init = smc_fast_element_init,
+    .bind = smc_fast_bind,
+    .process_bind_request = smc_fast_process_bind_request,
+    .process_event = smc_fast_process_event,
+};
+
+/*
+ * 執行 SCP 事件佇列直到 *word & mask == want；佇列清空而條件仍不成立時
+ * 推進虛擬時間讓 PLL 完成 (同 scmi_virtio_backend.c)。
+ * 實機上這段時間是 EL3 在等 SCP
+ */
+static bool scp_run_until(const volatile uint32_t *word, uint32_t mask,
+                          uint32_t want)
+{
+    uint64_t next;
+
+    for (;;) {
+        fwk_process_event_queue();
+        if ((__atomic_load_n(word, __ATOMIC_ACQUIRE) & mask) == want)
+            return true;
+
+        next = sw_pll_next_completion_ns();
+        if (next == 0)
+            return false;
+        sw_pll_advance_to(next);
+    }
+}
+
+/* SCP 在背景把剩下的工作做完 (PLL 完成、RATE_CHANGED 通知) */
+static void scp_run_idle(void)
+{
+    uint64_t next;
+
+    fwk_process_event_queue();
+    while ((next = sw_pll_next_completion_ns()) != 0) {
+        sw_pll_advance_to(next);
+        fwk_process_event_queue();
+    }
+}
+
+/* ---- EL3 monitor 替身 -------------------------------------------- */
+
+struct smc_res {
+    uint64_t a0, a1, a2, a3;
+};
+
+static void monitor_smc(uint32_t fid, uint64_t x1, uint64_t x2, uint64_t x3,
+                        uint64_t x4, struct smc_res *res)
+{
+    struct smc_fast_channel *channel;
+    struct smc_fast_mbx *mbx;
+
+    memset(res, 0, sizeof(*res));
+
+    switch (fid) {
+    case SMC_ID:
+        /* 一般 SMC 傳輸：SMC 返回時 SCP 已寫好回應 */
+        channel = &smc_fast_ctx.channels[SMC_FAST_CHANNEL_IDX_SHMEM];
+        smc_fast_doorbell_isr(SMC_FAST_CHANNEL_IDX_SHMEM);
+        if (!scp_run_until(&channel->shmem.channel_status, SHMEM_CHAN_FREE,
+                           SHMEM_CHAN_FREE))
+            res->a0 = SMCCC_RET_NOT_SUPPORTED;
+        break;
+
+    case SMC_FAST_ID:
+        mbx = &smc_fast_ctx.channels[SMC_FAST_CHANNEL_IDX_REG].mbx;
+
+        /* SMC32/SMC64 都只取低 32 位元 */
+        mbx->args[0] = (uint32_t)x1;
+        mbx->args[1] = (uint32_t)x2;
+        mbx->args[2] = (uint32_t)x3;
+        mbx->args[3] = (uint32_t)x4;
+        __atomic_store_n(&mbx->busy, 1, __ATOMIC_RELEASE);
+        smc_fast_doorbell_isr(SMC_FAST_CHANNEL_IDX_REG);
+
+        if (!scp_run_until(&mbx->busy, 1, 0)) {
+            res->a0 = SMCCC_RET_NOT_SUPPORTED;
+            break;
+        }
+        res->a0 = mbx->ret[0];
+        res->a1 = mbx->ret[1];
+        res->a2 = mbx->ret[2];
+        res->a3 = mbx->ret[3];
+        break;
+
+    default:
+        res->a0 = SMCCC_RET_NOT_SUPPORTED;
+        break;
+    }
+}
+
+/* ---- AP 端 --------------------------------------------------------- */
+
+static uint32_t pack_header(uint32_t msg_id)
+{
+    return (SCMI_PROTOCOL_CLOCK << 10) | msg_id;
+}
+
+/* 與 shmem_tx_prepare + shmem_fetch_response 相同的步驟 */
+static int32_t ap_shmem_xfer(uint32_t msg_id, const uint32_t *tx,
+                             size_t tx_len, uint64_t *rate)
+{
+    struct scmi_shmem *shmem =
+        &smc_fast_ctx.channels[SMC_FAST_CHANNEL_IDX_SHMEM].shmem;
+    struct smc_res res;
+    uint32_t resp[3];
+    size_t rx_len;
+
+    if (!(__atomic_load_n(&shmem->channel_status, __ATOMIC_ACQUIRE) &
+          SHMEM_CHAN_FREE))
+        return SCMI_BUSY;
+
+    shmem->channel_status = 0;
+    shmem->flags = 0;
+    shmem->length = sizeof(shmem->msg_header) + tx_len;
+    shmem->msg_header = pack_header(msg_id);
+    memcpy(shmem->msg_payload, tx, tx_len);
+
+    monitor_smc(SMC_ID, 0, 0, 0, 0, &res);
+    if (res.a0 == SMCCC_RET_NOT_SUPPORTED)
+        return SCMI_NOT_SUPPORTED;
+
+    rx_len = shmem->length - sizeof(shmem->msg_header);
+    memset(resp, 0, sizeof(resp));
+    memcpy(resp, shmem->msg_payload, rx_len < sizeof(resp) ? rx_len :
+                                                              sizeof(resp));
+    if (rate != NULL && (int32_t)resp[0] == SCMI_SUCCESS &&
+        rx_len >= sizeof(resp))
+        *rate = ((uint64_t)resp[2] << 32) | resp[1];
+
+    return (int32_t)resp[0];
+}
+
+/* 與 scmi_smc_fast_send_message + fetch_response 相同的步驟 */
+static int32_t ap_fast_xfer(uint32_t msg_id, uint32_t clock_id, uint64_t arg,
+                            uint64_t *rate, uint32_t *flags)
+{
+    struct smc_res res;
+
+    monitor_smc(SMC_FAST_ID, msg_id, clock_id, (uint32_t)arg,
+                (uint32_t)(arg >> 32), &res);
+
+    if (rate != NULL && (int32_t)(uint32_t)res.a0 == SCMI_SUCCESS)
+        *rate = ((uint64_t)(uint32_t)res.a2 << 32) | (uint32_t)res.a1;
+    if (flags != NULL)
+        *flags = (uint32_t)res.a3;
+
+    return (int32_t)(uint32_t)res.a0;
+}
+
+static int32_t ap_rate_set(bool fast, uint32_t clock_id, uint64_t rate,
+                           uint32_t *flags)
+{
+    uint32_t tx[4] = { 0, clock_id, (uint32_t)rate, (uint32_t)(rate >> 32) };
+
+    if (fast)
+        return ap_fast_xfer(SCMI_CLOCK_RATE_SET, clock_id, rate, NULL, flags);
+
+    return ap_shmem_xfer(SCMI_CLOCK_RATE_SET, tx, sizeof(tx), NULL);
+}
+
+static int32_t ap_rate_get(bool fast, uint32_t clock_id, uint64_t *rate)
+{
+    if (fast)
+        return ap_fast_xfer(SCMI_CLOCK_RATE_GET, clock_id, 0, rate, NULL);
+
+    return ap_shmem_xfer(SCMI_CLOCK_RATE_GET, &clock_id, sizeof(clock_id),
+                         rate);
+}
+
+static int32_t ap_config_set(bool fast, uint32_t clock_id, bool enable)
+{
+    uint32_t tx[2] = { clock_id, enable ? 1 : 0 };
+
+    if (fast)
+        return ap_fast_xfer(SCMI_CLOCK_CONFIG_SET, clock_id, tx[1], NULL,
+                            NULL);
+
+    return ap_shmem_xfer(SCMI_CLOCK_CONFIG_SET, tx, sizeof(tx), NULL);
+}
+
+/* ---- 一致性檢查 ---------------------------------------------------- */
+
+static unsigned int failures;
+
+static void expect(const char *what, bool fast, int64_t got, int64_t want)
+{
+    if (got == want)
+        return;
+
+    failures++;
+    printf("FAIL %-6s %-40s got %lld want %lld\n", fast ? "fast" : "shmem",
+           what, (long long)got, (long long)want);
+}
+
+/*
+ * RATE_SET 的結果：shmem 路徑就是回應的狀態；暫存器路徑必須回
+ * IN_PROGRESS，SCP 做完後由 P2A 通道收到這個時鐘的 RATE_CHANGED，
+ * 帶的是實際頻率 (失敗時為原頻率)。回傳 SCP 完成後的頻率
+ */
+static uint64_t check_rate_set(bool fast, const char *what, uint32_t clock_id,
+                               uint64_t rate, int32_t shmem_status)
+{
+    struct smc_fast_notification *last = &smc_fast_ctx.last_notification;
+    unsigned int count = last->count;
+    uint64_t applied = 0;
+    uint32_t flags = 0;
+    int32_t status;
+
+    status = ap_rate_set(fast, clock_id, rate, &flags);
+    scp_run_idle();
+    ap_rate_get(fast, clock_id, &applied);
+
+    if (!fast) {
+        expect(what, fast, status, shmem_status);
+        return applied;
+    }
+
+    expect(what, fast, status, SCMI_SUCCESS);
+    expect("  IN_PROGRESS flag", fast, flags & SCMI_CLOCK_REG_RET_IN_PROGRESS,
+           SCMI_CLOCK_REG_RET_IN_PROGRESS);
+    expect("  RATE_CHANGED to requester", fast, last->count - count, 1);
+    expect("  notification protocol", fast,
+           SCMI_HDR_PROTOCOL_ID(last->header), SCMI_PROTOCOL_CLOCK);
+    expect("  notification type", fast, SCMI_HDR_TYPE(last->header),
+           SCMI_MSG_TYPE_NOTIFICATION);
+    expect("  notification message", fast, SCMI_HDR_MSG_ID(last->header),
+           SCMI_CLOCK_RATE_CHANGED);
+    /* payload：agent_id, clock_id, rate_low, rate_high */
+    expect("  notification clock", fast, last->payload[1], clock_id);
+    expect("  notification rate", fast,
+           (int64_t)(((uint64_t)last->payload[3] << 32) | last->payload[2]),
+           (int64_t)applied);
+
+    return applied;
+}
+
+static void check_path(bool fast)
+{
+    uint64_t rate = 0;
+
+    expect("config_set pixel enable", fast,
+           ap_config_set(fast, CLK_PIXEL, true), SCMI_SUCCESS);
+    scp_run_idle();
+
+    /* 1MHz 步進，ROUND_MODE_NEAREST */
+    rate = check_rate_set(fast, "rate_set pixel 120.4MHz", CLK_PIXEL,
+                          120400000ULL, SCMI_SUCCESS);
+    expect("rate_get pixel rounded rate", fast, (int64_t)rate, 120000000LL);
+
+    /* 失敗的 RATE_SET 不改變頻率 */
+    rate = check_rate_set(fast, "rate_set pixel 250MHz", CLK_PIXEL,
+                          250000000ULL, SCMI_OUT_OF_RANGE);
+    expect("rate_get pixel after out of range", fast, (int64_t)rate,
+           120000000LL);
+
+    /* rate 高 32 位元必須完整傳遞，截斷後會變成合法的 100MHz */
+    rate = check_rate_set(fast, "rate_set pixel 4.39GHz", CLK_PIXEL,
+                          (1ULL << 32) + 100000000ULL, SCMI_OUT_OF_RANGE);
+    expect("rate_get pixel after >32-bit rate", fast, (int64_t)rate,
+           120000000LL);
+
+    /* PERF 管理的時鐘：兩條路徑都在接受前就拒絕 */
+    expect("rate_set perf-owned clock", fast,
+           ap_rate_set(fast, CLK_PERF_OWNED, 1000000000ULL, NULL),
+           SCMI_DENIED);
+    expect("rate_get perf-owned clock", fast,
+           ap_rate_get(fast, CLK_PERF_OWNED, &rate), SCMI_SUCCESS);
+    expect("rate_get invalid clock", fast,
+           ap_rate_get(fast, CLK_INVALID, &rate), SCMI_INVALID_PARAMETERS);
+
+    expect("config_set pixel disable", fast,
+           ap_config_set(fast, CLK_PIXEL, false), SCMI_SUCCESS);
+    scp_run_idle();
+}
+
+static void check_monitor(void)
+{
+    struct smc_res res;
+
+    /* 未知的 function ID 由 monitor 回 SMCCC_RET_NOT_SUPPORTED */
+    monitor_smc(0x82000099U, 0, 0, 0, 0, &res);
+    expect("unknown function id", true, (int64_t)res.a0,
+           (int64_t)SMCCC_RET_NOT_SUPPORTED);
+
+    /* 暫存器路徑不支援的訊息 */
+    monitor_smc(SMC_FAST_ID, SCMI_CLOCK_DESCRIBE_RATES, CLK_PIXEL, 0, 0, &res);
+    expect("fast path DESCRIBE_RATES", true, (int32_t)(uint32_t)res.a0,
+           SCMI_NOT_SUPPORTED);
+}
+
+/* ---- 量測 ---------------------------------------------------------- */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* 等到下一個送出時間點，不計入量測 */
+static void bench_pace(uint64_t *next_ns)
+{
+    while (now_ns() < *next_ns)
+        ;
+    *next_ns += SMC_FAST_BENCH_PACE_NS;
+}
+
+static void bench(bool fast, unsigned int iterations)
+{
+    uint64_t next = now_ns(), start, set_ns = 0, get_ns = 0, rate;
+    unsigned int i, busy = 0;
+
+    ap_config_set(fast, CLK_PIXEL, true);
+    scp_run_idle();
+
+    for (i = 0; i < iterations; i++) {
+        bench_pace(&next);
+        start = now_ns();
+        if (ap_rate_set(fast, CLK_PIXEL, (100 + (i & 0x3f)) * 1000000ULL,
+                        NULL) == SCMI_BUSY)
+            busy++;
+        set_ns += now_ns() - start;
+        scp_run_idle();
+
+        bench_pace(&next);
+        start = now_ns();
+        if (ap_rate_get(fast, CLK_PIXEL, &rate) == SCMI_BUSY)
+            busy++;
+        get_ns += now_ns() - start;
+    }
+
+    ap_config_set(fast, CLK_PIXEL, false);
+    scp_run_idle();
+
+    printf("%-6s %u x  RATE_SET %7.1f ns  RATE_GET %7.1f ns  (BUSY %u)\n",
+           fast ? "fast" : "shmem", iterations,
+           (double)set_ns / iterations, (double)get_ns / iterations, busy);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int iterations = argc > 1 ? atoi(argv[1]) : 2000;
+
+    if (iterations == 0)
+        return EXIT_FAILURE;
+
+    /* 初始化 SCP framework (host 上以 sub-system mode 執行，不進入主迴圈) */
+    if (fwk_arch_init(&host_arch_init_driver) != FWK_SUCCESS)
+        return EXIT_FAILURE;
+
+    /* 開機頻率等啟動工作先做完 */
+    scp_run_idle();
+
+    check_path(false);
+    check_path(true);
+    check_monitor();
+
+    if (failures) {
+        printf("%u check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("all checks passed\n");
+
+    bench(false, iterations);
+    bench(true, iterations);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,318 @@
+/*
+ * SCMI SMC Register-Only Fast Path Example
+ *
+ * SCMI_Transport_Call_Chain.md 中的 SMC 傳輸雖然以 SMC 通知 SCP，
+ * 參數與回應仍放在 shmem：AP 要寫 shmem (非 cacheable 映射或
+ * 額外的 cache 維護)、SCP 要解析 payload 再寫回回應。
+ *
+ * 這個範例在 SMC 傳輸上加一個暫存器快速路徑：
+ *
+ *   - CLOCK_RATE_SET / CLOCK_RATE_GET / CLOCK_CONFIG_SET 以另一個
+ *     function ID (arm,smc-fast-id) 呼叫，clock ID 與 64-bit rate
+ *     直接放在 x1-x4，結果由 x0-x3 帶回；完全不碰 shmem
+ *   - SCP 端由 mod_scmi_clock_reg_api.process() 處理，
+ *     與 shmem 路徑共用 scmi_clock_rate_set_handler() 等 handler
+ *     (見 scp_firmware_clock_handler.c 的 SCMI_CLOCK_REG_*)
+ *   - 其他訊息、非同步 RATE_SET 照舊走 shmem
+ *
+ * SMC 到 SCP 的路徑：EL3 monitor 無法直接呼叫 SCP 的函式。monitor 的
+ * SMC handler 把 x1-x4 寫入這個代理專用、只有 secure world 能存取的
+ * mailbox 資料暫存器並送 doorbell，SCP 的 mailbox 轉接模組取出後以
+ * 此通道對應的 mod_scmi service 呼叫 process()，寫回結果並清除 doorbell，
+ * monitor 再把結果放進 x0-x3 返回。代理身分由 mailbox 通道決定，
+ * AP 無法在暫存器中冒充其他代理；權限與 shmem 路徑同樣由 SCP 檢查。
+ *
+ * 暫存器格式：
+ *   x0 = fast_func_id   x1 = message_id   x2 = clock_id
+ *   x3 = rate[31:0] 或 CONFIG_SET attributes   x4 = rate[63:32]
+ *   回傳 x0 = SCMI 狀態、x1/x2 = rate 低/高 32 位元
+ *        x3 bit[0] = RATE_SET 已接受但 PLL 仍在轉換 (SCMI_CLOCK_REG_RET_IN_PROGRESS)
+ *
+ * SCP 的 PLL relock 可能非同步完成，SMC 不能等它：暫存器路徑的 RATE_SET
+ * 回傳時只代表已接受，實際套用的頻率由 SCP 以 RATE_CHANGED 經此代理的
+ * P2A 通道送回 (不需先訂閱)。
+ *
+ * 上層協議與 clock driver 不需修改：xfer 照常經過 SCMI core，
+ * 只是傳輸層在 send_message 就拿到結果，fetch_response 從暫存器值填回。
+ *
+ * 對應 drivers/firmware/arm_scmi/smc.c；需在 driver.c 的 scmi_of_match
+ * 加入：
+ *   { .compatible = "arm,scmi-smc-fast", .data = &scmi_smc_fast_desc },
+ * 主機端測試用的 monitor 替身見 scmi_smc_fast_monitor.c
+ */
+
+#include <linux/arm-smccc.h>
+#include <linux/device.h>
+#include <linux/err.h>
+#include <linux/io.h>
+#include <linux/mutex.h>
+#include <linux/of.h>
+#include <linux/of_address.h>
+#include <linux/slab.h>
+#include <linux/unaligned.h>
+
+#include "common.h"
+
+/* Clock 協議訊息 ID (drivers/firmware/arm_scmi/clock.c) */
+#define SCMI_SMC_FAST_RATE_SET      0x5
+#define SCMI_SMC_FAST_RATE_GET      0x6
+#define SCMI_SMC_FAST_CONFIG_SET    0x7
+
+/* RATE_SET flags bit[0]：非同步，需要 P2A delayed response，不能走暫存器 */
+#define SCMI_SMC_FAST_RATE_ASYNC    BIT(0)
+
+struct scmi_smc_fast {
+    struct scmi_chan_info *cinfo;
+    struct scmi_shared_mem __iomem *shmem;
+    /* 一般 SMC 傳輸的 function ID (arm,smc-id) */
+    u32 func_id;
+    /* 暫存器快速路徑的 function ID，0 表示未啟用 */
+    u32 fast_func_id;
+
+    /* 通道上一次只有一則訊息，send_message 取得、mark_txdone 釋放 */
+    struct mutex lock;
+    /* 目前這則訊息是否走暫存器，以及 SMC 的回傳值 */
+    bool fast;
+    struct arm_smccc_res res;
+
+    /* 統計 */
+    u64 fast_xfers;
+    u64 shmem_xfers;
+};
+
+static bool scmi_smc_fast_chan_available(struct device_node *of_node, int idx)
+{
+    struct device_node *np = of_parse_phandle(of_node, "shmem", 0);
+
+    if (!np)
+        return false;
+
+    of_node_put(np);
+
+    return true;
+}
+
+static int scmi_smc_fast_chan_setup(struct scmi_chan_info *cinfo,
+                                    struct device *dev, bool tx)
+{
+    struct device *cdev = cinfo->dev;
+    struct scmi_smc_fast *smc;
+    struct device_node *np;
+    struct resource res;
+    u32 func_id;
+    int ret;
+
+    /* SMC 傳輸只有 A2P 通道 */
+    if (!tx)
+        return -ENODEV;
+
+    smc = devm_kzalloc(dev, sizeof(*smc), GFP_KERNEL);
+    if (!smc)
+        return -ENOMEM;
+
+    np = of_parse_phandle(cdev->of_node, "shmem", 0);
+    if (!np)
+        return -ENODEV;
+
+    ret = of_address_to_resource(np, 0, &res);
+    of_node_put(np);
+    if (ret)
+        return ret;
+
+    smc->shmem = devm_ioremap(dev, res.start, resource_size(&res));
+    if (!smc->shmem)
+        return -EADDRNOTAVAIL;
+
+    ret = of_property_read_u32(dev->of_node, "arm,smc-id", &func_id);
+    if (ret < 0)
+        return ret;
+    smc->func_id = func_id;
+
+    /* 選用；沒有時整個傳輸就是一般的 SMC 傳輸 */
+    if (!of_property_read_u32(dev->of_node, "arm,smc-fast-id", &func_id))
+        smc->fast_func_id = func_id;
+
+    mutex_init(&smc->lock);
+    smc->cinfo = cinfo;
+    cinfo->transport_info = smc;
+
+    if (smc->fast_func_id)
+        dev_info(dev, "SCMI SMC register fast path: 0x%x\n",
+                 smc->fast_func_id);
+
+    return 0;
+}
+
+static int scmi_smc_fast_chan_free(int id, void *p, void *data)
+{
+    struct scmi_chan_info *cinfo = p;
+    struct scmi_smc_fast *smc = cinfo->transport_info;
+
+    if (smc) {
+        cinfo->transport_info = NULL;
+        smc->cinfo = NULL;
+    }
+
+    scmi_free_channel(cinfo, data, id);
+
+    return 0;
+}
+
+/*
+ * 能走暫存器的訊息：Clock 協議的 RATE_SET (同步)、RATE_GET、CONFIG_SET
+ * 成立時把 x1-x4 填好
+ */
+static bool scmi_smc_fast_encode(struct scmi_xfer *xfer, unsigned long *args)
+{
+    const u8 *tx = xfer->tx.buf;
+
+    if (xfer->hdr.protocol_id != SCMI_PROTOCOL_CLOCK)
+        return false;
+
+    switch (xfer->hdr.id) {
+    case SCMI_SMC_FAST_RATE_SET:
+        /* payload：flags、id、value_low、value_high */
+        if (xfer->tx.len < 16 ||
+            get_unaligned_le32(tx) & SCMI_SMC_FAST_RATE_ASYNC)
+            return false;
+        args[1] = get_unaligned_le32(tx + 4);
+        args[2] = get_unaligned_le32(tx + 8);
+        args[3] = get_unaligned_le32(tx + 12);
+        break;
+
+    case SCMI_SMC_FAST_RATE_GET:
+        if (xfer->tx.len < 4)
+            return false;
+        args[1] = get_unaligned_le32(tx);
+        args[2] = 0;
+        args[3] = 0;
+        break;
+
+    case SCMI_SMC_FAST_CONFIG_SET:
+        /* 只有 id 與 attributes；帶 OEM 設定的 v2.1 格式走 shmem */
+        if (xfer->tx.len != 8)
+            return false;
+        args[1] = get_unaligned_le32(tx);
+        args[2] = get_unaligned_le32(tx + 4);
+        args[3] = 0;
+        break;
+
+    default:
+        return false;
+    }
+
+    args[0] = xfer->hdr.id;
+
+    return true;
+}
+
+static int scmi_smc_fast_send_message(struct scmi_chan_info *cinfo,
+                                      struct scmi_xfer *xfer)
+{
+    struct scmi_smc_fast *smc = cinfo->transport_info;
+    unsigned long args[4];
+
+    /* 在 mark_txdone 中釋放 */
+    mutex_lock(&smc->lock);
+
+    smc->fast = smc->fast_func_id && scmi_smc_fast_encode(xfer, args);
+    if (smc->fast) {
+        arm_smccc_1_1_invoke(smc->fast_func_id, args[0], args[1], args[2],
+                             args[3], 0, 0, 0, &smc->res);
+        smc->fast_xfers++;
+        return 0;
+    }
+
+    shmem_tx_prepare(smc->shmem, xfer, cinfo);
+    arm_smccc_1_1_invoke(smc->func_id, 0, 0, 0, 0, 0, 0, 0, &smc->res);
+    smc->shmem_xfers++;
+
+    /* 只有 function ID 不被支援時才會回傳 SMCCC 錯誤 */
+    if (smc->res.a0 == SMCCC_RET_NOT_SUPPORTED) {
+        mutex_unlock(&smc->lock);
+        return -EOPNOTSUPP;
+    }
+
+    return 0;
+}
+
+static void scmi_smc_fast_mark_txdone(struct scmi_chan_info *cinfo, int ret,
+                                      struct scmi_xfer *__unused)
+{
+    struct scmi_smc_fast *smc = cinfo->transport_info;
+
+    mutex_unlock(&smc->lock);
+}
+
+static void scmi_smc_fast_fetch_response(struct scmi_chan_info *cinfo,
+                                         struct scmi_xfer *xfer)
+{
+    struct scmi_smc_fast *smc = cinfo->transport_info;
+    u64 rate;
+
+    if (!smc->fast) {
+        shmem_fetch_response(smc->shmem, xfer);
+        return;
+    }
+
+    /* x0 是 32 位元的 SCMI 狀態，依 int32 符號延伸 */
+    xfer->hdr.status = (s32)(u32)smc->res.a0;
+
+    if (xfer->hdr.id != SCMI_SMC_FAST_RATE_GET ||
+        xfer->hdr.status != SCMI_SUCCESS) {
+        xfer->rx.len = 0;
+        return;
+    }
+
+    rate = ((u64)(u32)smc->res.a2 << 32) | (u32)smc->res.a1;
+    xfer->rx.len = min_t(size_t, xfer->rx.len, sizeof(rate));
+    if (xfer->rx.len == sizeof(rate))
+        put_unaligned_le64(rate, xfer->rx.buf);
+}
+
+static bool scmi_smc_fast_poll_done(struct scmi_chan_info *cinfo,
+                                    struct scmi_xfer *xfer)
+{
+    struct scmi_smc_fast *smc = cinfo->transport_info;
+
+    /* 暫存器路徑在 SMC 返回時就已完成 */
+    if (smc->fast)
+        return true;
+
+    return shmem_poll_done(smc->shmem, xfer);
+}
+
+static const struct scmi_transport_ops scmi_smc_fast_ops = {
+    .chan_available = scmi_smc_fast_chan_available,
+    .chan_setup = scmi_smc_fast_chan_setup,
+    .chan_free = scmi_smc_fast_chan_free,
+    .send_message = scmi_smc_fast_send_message,
+    .mark_txdone = scmi_smc_fast_mark_txdone,
+    .fetch_response = scmi_smc_fast_fetch_response,
+    .poll_done = scmi_smc_fast_poll_done,
+};
+
+/*
+ * 與 smc.c 相同：SMC 返回即完成 (sync_cmds_completed_on_ret)，
+ * core 接著直接呼叫 fetch_response，不等中斷也不輪詢
+ */
+const struct scmi_desc scmi_smc_fast_desc = {
+    .ops = &scmi_smc_fast_ops,
+    .max_rx_timeout_ms = 30,
+    .max_msg = 20,
+    .max_msg_size = 128,
+    .sync_cmds_completed_on_ret = true,
+};
+
+/*
+ * Device Tree 範例：
+ *
+ *   firmware {
+ *       scmi {
+ *           compatible = "arm,scmi-smc-fast";
+ *           arm,smc-id = <0x82000010>;
+ *           arm,smc-fast-id = <0x82000011>;   // 暫存器快速路徑
+ *           shmem = <&cpu_scp_shm>;
+ *       };
+ *   };
+ */
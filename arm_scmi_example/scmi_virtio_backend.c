@@ -0,0 +1,712 @@
+/*
+ * SCMI Virtio Backend Example (vhost-user style)
+ *
+ * 這個範例把 SCP firmware 的 SCMI clock 模組 (scp_firmware_clock_handler.c)
+ * 搬到 Linux userspace 執行，透過 virtio-scmi 的 virtqueue 與 guest 的
+ * SCMI virtio transport 溝通，作為不需要硬體的效能測試平台。
+ *
+ * 架構：
+ *
+ *   guest scmi-virtio driver
+ *        |  cmdq (A2P 請求 + 回應)      eventq (P2A 通知)
+ *        v                               ^
+ *   +-------------------------------------------------+
+ *   | mod_virtio_scmi (本檔)                           |
+ *   |   - 一個 element = 一個 in-flight slot          |
+ *   |   - 每個 slot 綁定一個 mod_scmi service         |
+ *   +-------------------------------------------------+
+ *        | signal_message()          ^ respond()/transmit()
+ *        v                           |
+ *   mod_scmi -> mod_scmi_clock (scmi_clock_message_handler)
+ *        -> mod_clock -> mod_sw_pll (scp_sw_pll_model.c)
+ *
+ * 特點：
+ *   - 一次 kick 取出 avail ring 上所有描述子 (batch)，最多同時
+ *     處理 slot 數量的請求 (multiple in-flight)
+ *   - 回應先累積在 used ring，整批處理完後才更新 used->idx 並
+ *     寫一次 call eventfd
+ *   - SCP framework 以 sub-system mode 執行 (fwk_process_event_queue)，
+ *     handler 程式碼與韌體中完全相同
+ *   - mod_sw_pll 以虛擬時間模擬 PLL relock；事件佇列清空後若還有
+ *     未完成的非同步轉換，虛擬時間直接跳到最早的完成時間，
+ *     延遲回應的 RATE_SET 因此在同一批內完成
+ *
+ * 簡化：共享記憶體只有一塊，描述子位址為此區域內的 offset；
+ * 握手協定只傳遞一次 setup 訊息 (非完整 vhost-user 協定)。
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <linux/virtio_ring.h>
+
+#include <mod_scmi.h>
+
+#include <fwk_arch.h>
+#include <fwk_id.h>
+#include <fwk_log.h>
+#include <fwk_mm.h>
+#include <fwk_module.h>
+#include <fwk_module_idx.h>
+#include <fwk_status.h>
+
+/* scp_sw_pll_model.c 的虛擬時間介面 */
+uint64_t sw_pll_next_completion_ns(void);
+void sw_pll_advance_to(uint64_t t_ns);
+
+/* virtio-scmi virtqueue 索引 */
+enum virtio_scmi_vq_idx {
+    VIRTIO_SCMI_VQ_TX,     /* cmdq：A2P 請求 */
+    VIRTIO_SCMI_VQ_RX,     /* eventq：P2A 通知 */
+    VIRTIO_SCMI_VQ_COUNT,
+};
+
+/* 單則 SCMI 訊息最大 payload (不含 header / status) */
+#define VIRTIO_SCMI_MAX_PAYLOAD 128
+
+/* 還有 slot 在等 SCP 回應時，主迴圈最多睡多久就重新處理事件 (ms) */
+#define VIRTIO_SCMI_BUSY_POLL_MS 1
+
+/* 前端的 setup 訊息附帶的 fd：共享記憶體 + 每個 virtqueue 的 kick/call */
+#define VIRTIO_SCMI_SETUP_FDS (1 + 2 * VIRTIO_SCMI_VQ_COUNT)
+
+/* 前端 (guest/VMM) 傳來的設定 */
+struct virtio_scmi_setup_msg {
+    uint32_t queue_size;
+    uint32_t reserved;
+    uint64_t region_size;
+    /* 以共享區域 offset 表示的 vring 位址 */
+    uint64_t desc[VIRTIO_SCMI_VQ_COUNT];
+    uint64_t avail[VIRTIO_SCMI_VQ_COUNT];
+    uint64_t used[VIRTIO_SCMI_VQ_COUNT];
+};
+
+/* 一個 virtqueue 的 backend 狀態 */
+struct virtio_scmi_vq {
+    struct vring vring;
+    uint16_t last_avail_idx;
+    /* 尚未發佈給前端的 used 項目數 */
+    uint16_t pending_used;
+    int kick_fd;
+    int call_fd;
+};
+
+/* in-flight slot (element) 設定 */
+struct mod_virtio_scmi_channel_config {
+    /* 對應的 mod_scmi service element */
+    fwk_id_t service_id;
+    /* 是否為 P2A (通知) 通道 */
+    bool p2a;
+};
+
+/* 每個 slot 的執行期狀態 */
+struct virtio_scmi_slot {
+    const struct mod_virtio_scmi_channel_config *config;
+    bool busy;
+
+    /* 目前處理中的描述子鏈 */
+    uint16_t head;
+    uint32_t message_header;
+    uint8_t payload[VIRTIO_SCMI_MAX_PAYLOAD];
+    size_t payload_size;
+
+    /* 回應寫入位置 (描述子鏈中 device-writable 的 buffer) */
+    uint8_t *resp_buf;
+    uint32_t resp_len;
+};
+
+struct virtio_scmi_ctx {
+    uint8_t *region;
+    uint64_t region_size;
+    struct virtio_scmi_vq vq[VIRTIO_SCMI_VQ_COUNT];
+
+    struct virtio_scmi_slot *slot_table;
+    unsigned int slot_count;
+
+    const struct mod_scmi_from_transport_api *scmi_api;
+
+    /* 統計 */
+    uint64_t requests;
+    uint64_t responses;
+    uint64_t batches;
+    unsigned int max_inflight;
+};
+
+static struct virtio_scmi_ctx vs_ctx;
+
+/* host arch 的初始化驅動 (SCP-firmware arch/none/host 提供) */
+extern const struct fwk_arch_init_driver host_arch_init_driver;
+
+/*
+ * Virtqueue 存取
+ */
+
+static void *virtio_scmi_addr(uint64_t offset, uint32_t len)
+{
+    if (offset > vs_ctx.region_size || len > vs_ctx.region_size - offset)
+        return NULL;
+
+    return vs_ctx.region + offset;
+}
+
+/* 取出下一個可用描述子鏈的 head，沒有則回傳 false */
+static bool virtio_scmi_vq_pop(struct virtio_scmi_vq *vq, uint16_t *head)
+{
+    uint16_t avail_idx = __atomic_load_n(&vq->vring.avail->idx,
+                                         __ATOMIC_ACQUIRE);
+
+    if (vq->last_avail_idx == avail_idx)
+        return false;
+
+    *head = vq->vring.avail->ring[vq->last_avail_idx % vq->vring.num];
+    vq->last_avail_idx++;
+
+    return true;
+}
+
+/* 放入 used ring，但先不更新 used->idx (批次發佈) */
+static void virtio_scmi_vq_push(struct virtio_scmi_vq *vq, uint16_t head,
+                                uint32_t len)
+{
+    uint16_t idx = vq->vring.used->idx + vq->pending_used;
+    struct vring_used_elem *elem = &vq->vring.used->ring[idx % vq->vring.num];
+
+    elem->id = head;
+    elem->len = len;
+    vq->pending_used++;
+}
+
+/* 一次發佈所有累積的 used 項目，並只通知前端一次 */
+static void virtio_scmi_vq_flush(struct virtio_scmi_vq *vq)
+{
+    uint64_t one = 1;
+
+    if (vq->pending_used == 0)
+        return;
+
+    __atomic_store_n(&vq->vring.used->idx,
+                     (uint16_t)(vq->vring.used->idx + vq->pending_used),
+                     __ATOMIC_RELEASE);
+    vq->pending_used = 0;
+
+    if (!(vq->vring.avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
+        (void)write(vq->call_fd, &one, sizeof(one));
+}
+
+/*
+ * 解析 cmdq 描述子鏈：
+ * device-readable 部分為 [header][payload]，device-writable 部分為回應 buffer
+ *
+ * 描述子表在前端可寫的共享記憶體中：每個索引 (包括 head) 都要在
+ * vring.num 之內，鏈的長度 (讀寫描述子都算) 也不能超過 vring.num，
+ * 否則前端可以讓 next 指回自己使 backend 無限迴圈。
+ * head 本身不合法時回傳 FWK_E_RANGE，呼叫者不能把它放回 used ring。
+ */
+static int virtio_scmi_parse_request(struct virtio_scmi_slot *slot,
+                                     uint16_t head)
+{
+    struct vring *vring = &vs_ctx.vq[VIRTIO_SCMI_VQ_TX].vring;
+    struct vring_desc *desc;
+    uint16_t idx = head;
+    unsigned int steps = 0;
+    size_t rd_len = 0;
+    uint8_t req[sizeof(uint32_t) + VIRTIO_SCMI_MAX_PAYLOAD];
+    uint8_t *buf;
+
+    if (head >= vring->num)
+        return FWK_E_RANGE;
+
+    slot->head = head;
+    slot->resp_buf = NULL;
+    slot->resp_len = 0;
+
+    for (;;) {
+        if (idx >= vring->num || ++steps > vring->num)
+            return FWK_E_PARAM;
+
+        desc = &vring->desc[idx];
+        buf = virtio_scmi_addr(desc->addr, desc->len);
+        if (buf == NULL)
+            return FWK_E_PARAM;
+
+        if (desc->flags & VRING_DESC_F_WRITE) {
+            slot->resp_buf = buf;
+            slot->resp_len = desc->len;
+        } else {
+            if (rd_len + desc->len > sizeof(req))
+                return FWK_E_SIZE;
+            memcpy(req + rd_len, buf, desc->len);
+            rd_len += desc->len;
+        }
+
+        if (!(desc->flags & VRING_DESC_F_NEXT))
+            break;
+        idx = desc->next;
+    }
+
+    if (rd_len < sizeof(uint32_t) || slot->resp_buf == NULL)
+        return FWK_E_PARAM;
+
+    memcpy(&slot->message_header, req, sizeof(uint32_t));
+    slot->payload_size = rd_len - sizeof(uint32_t);
+    memcpy(slot->payload, req + sizeof(uint32_t), slot->payload_size);
+
+    return FWK_SUCCESS;
+}
+
+static struct virtio_scmi_slot *virtio_scmi_get_free_slot(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < vs_ctx.slot_count; i++) {
+        if (!vs_ctx.slot_table[i].busy && !vs_ctx.slot_table[i].config->p2a)
+            return &vs_ctx.slot_table[i];
+    }
+
+    return NULL;
+}
+
+/*
+ * kick 處理：取出所有可用請求，分配到空閒 slot 並通知 mod_scmi
+ * slot 用完時剩下的請求留在 avail ring，等 respond() 釋放 slot 後再取
+ * 回傳這次從 avail ring 取出的描述子鏈數
+ */
+static unsigned int virtio_scmi_drain_cmdq(void)
+{
+    struct virtio_scmi_vq *vq = &vs_ctx.vq[VIRTIO_SCMI_VQ_TX];
+    struct virtio_scmi_slot *slot;
+    unsigned int popped = 0, inflight = 0, i;
+    uint16_t head;
+    int status;
+
+    while ((slot = virtio_scmi_get_free_slot()) != NULL) {
+        if (!virtio_scmi_vq_pop(vq, &head))
+            break;
+        popped++;
+
+        status = virtio_scmi_parse_request(slot, head);
+        if (status == FWK_E_RANGE) {
+            /* head 超出描述子表，無法歸還，只能丟棄 */
+            fwk_log_error("[VIRTIO-SCMI] invalid descriptor head %u", head);
+            continue;
+        }
+        if (status != FWK_SUCCESS) {
+            /* 格式錯誤的請求直接歸還 */
+            virtio_scmi_vq_push(vq, head, 0);
+            continue;
+        }
+
+        slot->busy = true;
+        vs_ctx.requests++;
+        if (vs_ctx.scmi_api->signal_message(slot->config->service_id) !=
+            FWK_SUCCESS) {
+            /* mod_scmi 沒有接下這則請求，歸還描述子並釋放 slot */
+            virtio_scmi_vq_push(vq, head, 0);
+            slot->busy = false;
+        }
+    }
+
+    for (i = 0; i < vs_ctx.slot_count; i++)
+        inflight += vs_ctx.slot_table[i].busy;
+    if (inflight > vs_ctx.max_inflight)
+        vs_ctx.max_inflight = inflight;
+
+    return popped;
+}
+
+/* avail ring 上還有請求，或有 slot 還在等 SCP 回應 */
+static bool virtio_scmi_work_pending(void)
+{
+    struct virtio_scmi_vq *vq = &vs_ctx.vq[VIRTIO_SCMI_VQ_TX];
+    unsigned int i;
+
+    if (vq->last_avail_idx !=
+        __atomic_load_n(&vq->vring.avail->idx, __ATOMIC_ACQUIRE))
+        return true;
+
+    for (i = 0; i < vs_ctx.slot_count; i++) {
+        if (vs_ctx.slot_table[i].busy)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * mod_scmi 所需的 transport API
+ */
+
+static struct virtio_scmi_slot *virtio_scmi_slot_get(fwk_id_t channel_id)
+{
+    return &vs_ctx.slot_table[fwk_id_get_element_idx(channel_id)];
+}
+
+static int virtio_scmi_get_secure(fwk_id_t channel_id, bool *secure)
+{
+    *secure = false;
+
+    return FWK_SUCCESS;
+}
+
+static int virtio_scmi_get_max_payload_size(fwk_id_t channel_id, size_t *size)
+{
+    *size = VIRTIO_SCMI_MAX_PAYLOAD;
+
+    return FWK_SUCCESS;
+}
+
+static int virtio_scmi_get_message_header(fwk_id_t channel_id,
+                                          uint32_t *message_header)
+{
+    *message_header = virtio_scmi_slot_get(channel_id)->message_header;
+
+    return FWK_SUCCESS;
+}
+
+static int virtio_scmi_get_payload(fwk_id_t channel_id, const void **payload,
+                                   size_t *size)
+{
+    struct virtio_scmi_slot *slot = virtio_scmi_slot_get(channel_id);
+
+    *payload = slot->payload;
+    *size = slot->payload_size;
+
+    return FWK_SUCCESS;
+}
+
+/* 回應格式：[header][payload (status 開頭)] */
+static int virtio_scmi_respond(fwk_id_t channel_id, const void *payload,
+                               size_t size)
+{
+    struct virtio_scmi_slot *slot = virtio_scmi_slot_get(channel_id);
+    uint32_t len = sizeof(uint32_t) + size;
+
+    if (!slot->busy)
+        return FWK_E_STATE;
+
+    if (len > slot->resp_len)
+        return FWK_E_SIZE;
+
+    memcpy(slot->resp_buf, &slot->message_header, sizeof(uint32_t));
+    memcpy(slot->resp_buf + sizeof(uint32_t), payload, size);
+
+    virtio_scmi_vq_push(&vs_ctx.vq[VIRTIO_SCMI_VQ_TX], slot->head, len);
+    slot->busy = false;
+    vs_ctx.responses++;
+
+    return FWK_SUCCESS;
+}
+
+/* P2A 通知：使用前端預先放在 eventq 的 buffer */
+static int virtio_scmi_transmit(fwk_id_t channel_id, uint32_t message_header,
+                                const void *payload, size_t size,
+                                bool request_ack_by_interrupt)
+{
+    struct virtio_scmi_vq *vq = &vs_ctx.vq[VIRTIO_SCMI_VQ_RX];
+    struct vring_desc *desc;
+    uint32_t len = sizeof(uint32_t) + size;
+    uint16_t head;
+    uint8_t *buf;
+
+    /* 前端沒有空的 eventq buffer：依 virtio-scmi 規範丟棄通知 */
+    if (!virtio_scmi_vq_pop(vq, &head))
+        return FWK_E_BUSY;
+
+    /* 同 cmdq：超出描述子表的 head 無法歸還 */
+    if (head >= vq->vring.num)
+        return FWK_E_RANGE;
+
+    desc = &vq->vring.desc[head];
+    buf = virtio_scmi_addr(desc->addr, desc->len);
+    if (buf == NULL || len > desc->len) {
+        virtio_scmi_vq_push(vq, head, 0);
+        return FWK_E_SIZE;
+    }
+
+    memcpy(buf, &message_header, sizeof(uint32_t));
+    memcpy(buf + sizeof(uint32_t), payload, size);
+    virtio_scmi_vq_push(vq, head, len);
+
+    return FWK_SUCCESS;
+}
+
+static const struct mod_scmi_to_transport_api virtio_scmi_transport_api = {
+    .get_secure = virtio_scmi_get_secure,
+    .get_max_payload_size = virtio_scmi_get_max_payload_size,
+    .get_message_header = virtio_scmi_get_message_header,
+    .get_payload = virtio_scmi_get_payload,
+    .respond = virtio_scmi_respond,
+    .transmit = virtio_scmi_transmit,
+};
+
+/*
+ * 模組框架介面
+ */
+
+static int virtio_scmi_init(fwk_id_t module_id, unsigned int element_count,
+                            const void *data)
+{
+    if (element_count == 0)
+        return FWK_E_PARAM;
+
+    vs_ctx.slot_count = element_count;
+    vs_ctx.slot_table = fwk_mm_calloc(element_count,
+                                      sizeof(struct virtio_scmi_slot));
+
+    return FWK_SUCCESS;
+}
+
+static int virtio_scmi_element_init(fwk_id_t element_id, unsigned int unused,
+                                    const void *data)
+{
+    if (data == NULL)
+        return FWK_E_PARAM;
+
+    virtio_scmi_slot_get(element_id)->config = data;
+
+    return FWK_SUCCESS;
+}
+
+static int virtio_scmi_bind(fwk_id_t id, unsigned int round)
+{
+    if (round == 1 || !fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    return fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_SCMI),
+                           FWK_ID_API(FWK_MODULE_IDX_SCMI,
+                                      MOD_SCMI_API_IDX_TRANSPORT),
+                           &vs_ctx.scmi_api);
+}
+
+static int virtio_scmi_process_bind_request(fwk_id_t source_id,
+                                            fwk_id_t target_id,
+                                            fwk_id_t api_id,
+                                            const void **api)
+{
+    *api = &virtio_scmi_transport_api;
+
+    return FWK_SUCCESS;
+}
+
+/* 模組描述符 */
+const struct fwk_module module_virtio_scmi = {
+    .name = "Virtio SCMI Transport",
+    .type = FWK_MODULE_TYPE_DRIVER,
+    .api_count = 1,
+    .init = virtio_scmi_init,
+    .element_init = virtio_scmi_element_init,
+    .bind = virtio_scmi_bind,
+    .process_bind_request = virtio_scmi_process_bind_request,
+};
+
+/*
+ * vhost-user 風格的握手：接收 setup 訊息與 5 個 fd
+ * (共享記憶體、cmdq kick/call、eventq kick/call)
+ * 任何一步失敗都關閉已取得的 fd 並解除 mmap
+ */
+static int virtio_scmi_accept_frontend(const char *socket_path)
+{
+    struct virtio_scmi_setup_msg setup;
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    char cbuf[CMSG_SPACE(VIRTIO_SCMI_SETUP_FDS * sizeof(int))];
+    struct iovec iov = { .iov_base = &setup, .iov_len = sizeof(setup) };
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = cbuf,
+        .msg_controllen = sizeof(cbuf),
+    };
+    struct cmsghdr *cmsg;
+    int listen_fd, conn_fd, fds[VIRTIO_SCMI_SETUP_FDS];
+    unsigned int i, nfds = 0;
+    int ret;
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+        return -errno;
+
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    unlink(socket_path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(listen_fd, 1) < 0) {
+        ret = -errno;
+        close(listen_fd);
+        return ret;
+    }
+
+    conn_fd = accept(listen_fd, NULL, NULL);
+    ret = -errno;
+    close(listen_fd);
+    if (conn_fd < 0)
+        return ret;
+
+    ret = -EPROTO;
+    if (recvmsg(conn_fd, &msg, MSG_CMSG_CLOEXEC) != sizeof(setup))
+        goto close_fds;
+
+    /* 先收下前端傳來的所有 fd，數量不對時也要關閉 */
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET &&
+        cmsg->cmsg_type == SCM_RIGHTS) {
+        nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        if (nfds > VIRTIO_SCMI_SETUP_FDS)
+            nfds = VIRTIO_SCMI_SETUP_FDS;
+        memcpy(fds, CMSG_DATA(cmsg), nfds * sizeof(int));
+    }
+    if (nfds != VIRTIO_SCMI_SETUP_FDS || (msg.msg_flags & MSG_CTRUNC))
+        goto close_fds;
+
+    /* avail/used 的索引是 16 位元，queue_size 必須是 2 的冪次 */
+    ret = -EINVAL;
+    if (setup.queue_size == 0 || setup.queue_size > 32768 ||
+        (setup.queue_size & (setup.queue_size - 1)) != 0 ||
+        setup.region_size == 0)
+        goto close_fds;
+
+    vs_ctx.region_size = setup.region_size;
+    vs_ctx.region = mmap(NULL, setup.region_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fds[0], 0);
+    if (vs_ctx.region == MAP_FAILED) {
+        ret = -errno;
+        vs_ctx.region = NULL;
+        goto close_fds;
+    }
+    /* mapping 建立後不再需要共享記憶體的 fd */
+    close(fds[0]);
+    fds[0] = -1;
+
+    for (i = 0; i < VIRTIO_SCMI_VQ_COUNT; i++) {
+        struct virtio_scmi_vq *vq = &vs_ctx.vq[i];
+
+        vq->vring.num = setup.queue_size;
+        vq->vring.desc = virtio_scmi_addr(setup.desc[i],
+            setup.queue_size * sizeof(struct vring_desc));
+        vq->vring.avail = virtio_scmi_addr(setup.avail[i],
+            sizeof(struct vring_avail) + setup.queue_size * sizeof(uint16_t));
+        vq->vring.used = virtio_scmi_addr(setup.used[i],
+            sizeof(struct vring_used) +
+            setup.queue_size * sizeof(struct vring_used_elem));
+        if (!vq->vring.desc || !vq->vring.avail || !vq->vring.used) {
+            ret = -EINVAL;
+            goto unmap;
+        }
+
+        vq->kick_fd = fds[1 + 2 * i];
+        vq->call_fd = fds[2 + 2 * i];
+    }
+
+    return conn_fd;
+
+unmap:
+    munmap(vs_ctx.region, vs_ctx.region_size);
+    vs_ctx.region = NULL;
+close_fds:
+    for (i = 0; i < nfds; i++) {
+        if (fds[i] >= 0)
+            close(fds[i]);
+    }
+    close(conn_fd);
+
+    return ret;
+}
+
+/*
+ * 執行 SCP 事件佇列；清空後若有非同步 PLL 轉換未完成，推進虛擬時間
+ * 讓 driver 回報完成並繼續處理。回傳是否推進過虛擬時間
+ */
+static bool virtio_scmi_run_scp(void)
+{
+    bool advanced = false;
+    uint64_t next;
+
+    fwk_process_event_queue();
+
+    while ((next = sw_pll_next_completion_ns()) != 0) {
+        sw_pll_advance_to(next);
+        fwk_process_event_queue();
+        advanced = true;
+    }
+
+    return advanced;
+}
+
+/*
+ * Backend 主迴圈
+ * 每一輪：等待 kick -> 取出整批請求 -> 執行 SCP 事件佇列 -> 一次發佈回應
+ *
+ * 處理到沒有進展 (沒有取出新請求、也沒有 slot 回應) 為止。slot 全忙時
+ * 剩下的請求留在 avail ring，前端不會為它們再 kick；延後回應的請求
+ * 也要等 SCP 事件才會完成。所以只要還有工作，poll 就只睡
+ * VIRTIO_SCMI_BUSY_POLL_MS，不會卡到下一次 kick。
+ */
+int main(int argc, char **argv)
+{
+    struct pollfd pfd[VIRTIO_SCMI_VQ_COUNT];
+    uint64_t kicks, responses;
+    unsigned int i, popped;
+    int conn_fd, timeout;
+    bool advanced;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <socket-path>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* 初始化 SCP framework (host 上以 sub-system mode 執行，不進入主迴圈) */
+    if (fwk_arch_init(&host_arch_init_driver) != FWK_SUCCESS)
+        return EXIT_FAILURE;
+
+    conn_fd = virtio_scmi_accept_frontend(argv[1]);
+    if (conn_fd < 0) {
+        fprintf(stderr, "frontend setup failed: %s\n", strerror(-conn_fd));
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < VIRTIO_SCMI_VQ_COUNT; i++) {
+        pfd[i].fd = vs_ctx.vq[i].kick_fd;
+        pfd[i].events = POLLIN;
+    }
+
+    for (;;) {
+        timeout = virtio_scmi_work_pending() ? VIRTIO_SCMI_BUSY_POLL_MS : -1;
+        if (poll(pfd, VIRTIO_SCMI_VQ_COUNT, timeout) < 0 && errno != EINTR)
+            break;
+
+        for (i = 0; i < VIRTIO_SCMI_VQ_COUNT; i++) {
+            if (pfd[i].revents & POLLIN)
+                (void)read(pfd[i].fd, &kicks, sizeof(kicks));
+        }
+
+        do {
+            responses = vs_ctx.responses;
+            popped = virtio_scmi_drain_cmdq();
+            advanced = virtio_scmi_run_scp();
+        } while (popped != 0 || advanced || vs_ctx.responses != responses);
+
+        virtio_scmi_vq_flush(&vs_ctx.vq[VIRTIO_SCMI_VQ_TX]);
+        virtio_scmi_vq_flush(&vs_ctx.vq[VIRTIO_SCMI_VQ_RX]);
+        vs_ctx.batches++;
+    }
+
+    fprintf(stderr, "requests %llu, batches %llu, max in-flight %u\n",
+            (unsigned long long)vs_ctx.requests,
+            (unsigned long long)vs_ctx.batches, vs_ctx.max_inflight);
+
+    for (i = 0; i < VIRTIO_SCMI_VQ_COUNT; i++) {
+        close(vs_ctx.vq[i].kick_fd);
+        close(vs_ctx.vq[i].call_fd);
+    }
+    munmap(vs_ctx.region, vs_ctx.region_size);
+    close(conn_fd);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,864 @@
+/*
+ * SCP Firmware Clock Capping Engine Example
+ *
+ * 目前所有的頻率上限都來自 Linux：thermal framework 讀溫度、算出 cooling
+ * state，再送 CLOCK_RATE_SET 到 scmi_clock_rate_set_handler()。
+ * 反應時間是完整的 AP 迴圈 (中斷 -> thermal work -> cpufreq -> SCMI)，
+ * 功率突波或過溫時 AP 自己也可能正忙。
+ *
+ * 這個模組把限制放在 SCP 本地：
+ *
+ *   - 每個受限的時鐘是一個元素 (domain)，各來源 (溫度、功率預算、
+ *     其他模組) 各自給一個上限，實際上限取最小值
+ *   - 溫度感測器 / 功率監控的 alarm callback 呼叫本模組 API，只在中斷
+ *     關閉下更新上限並排入套用事件；mod_clock 與 fwk_log 都不能在中斷中
+ *     使用，時鐘一律在事件中設定，與 scmi_clock、PERF、DVFS 的事件
+ *     一樣由事件迴圈序列化
+ *   - 代理的 RATE_SET 由 scmi_clock 轉給本模組，記住代理要求的頻率，
+ *     套用的是 min(要求, 上限)；上限解除時自動恢復到要求的頻率
+ *   - PERF 管理的 CPU 時鐘 (perf_domain_id) 本模組不直接寫，上限交給
+ *     SCMI PERF，由它把 level 壓到上限以下；解除時經 DVFS engine 先升壓
+ *     再升頻
+ *   - 時鐘驅動回 FWK_E_BUSY (共用 PLL 忙碌) 時以計時器 alarm 重試，
+ *     不重複排入事件佔住佇列
+ *   - 限制造成的頻率變更通知代理 (RATE_CHANGED，agent_id 0)
+ *
+ * 反應時間 = 一次事件派送 + 本模組查表 + 時鐘驅動的 set_rate。
+ * 只改分頻器時約 1us；需要 relock 時是 PLL 的 lock 時間 (ping-pong 的
+ * CPU cluster 在 lock 期間仍以原頻率執行，REFCLK 停靠的則是立刻降到 24MHz)。
+ */
+
+#include <fwk_event.h>
+#include <fwk_id.h>
+#include <fwk_interrupt.h>
+#include <fwk_log.h>
+#include <fwk_macros.h>
+#include <fwk_mm.h>
+#include <fwk_module.h>
+#include <fwk_module_idx.h>
+#include <fwk_status.h>
+#include <fwk_time.h>
+#include <mod_clock.h>
+#include <mod_scmi_clock.h>
+#include <mod_scmi_perf.h>
+#include <mod_timer.h>
+
+/* 共用 PLL 忙碌時的重試間隔 */
+#define CLOCK_CAP_RETRY_MS 1
+
+/* 限制來源 */
+enum mod_clock_cap_source {
+    MOD_CLOCK_CAP_SOURCE_THERMAL,
+    MOD_CLOCK_CAP_SOURCE_POWER,
+    /* 其他 SCP 模組 (例如電池低電量、PMIC 過流警告) */
+    MOD_CLOCK_CAP_SOURCE_PLATFORM,
+    MOD_CLOCK_CAP_SOURCE_COUNT,
+};
+
+/* 上限為 0 表示此來源沒有限制 */
+#define MOD_CLOCK_CAP_NO_LIMIT 0
+
+/* 溫度門檻：溫度 (m°C) 達到 temperature 時上限為 max_rate */
+struct mod_clock_cap_thermal_step {
+    int32_t temperature;
+    uint64_t max_rate;
+};
+
+/* 功率表：頻率 rate 下的功耗 (mW)，依 rate 遞增 */
+struct mod_clock_cap_power_point {
+    uint64_t rate;
+    uint32_t power;
+};
+
+/* domain 元素設定 */
+struct mod_clock_cap_domain_config {
+    /* mod_clock 元素 */
+    fwk_id_t clock_id;
+
+    /*
+     * 對應的 SCMI PERF domain (可選)；設定後上限交給 PERF 套用，
+     * 本模組不呼叫 mod_clock，避免繞過 PERF 的 level 記錄與 DVFS 的電壓順序
+     */
+    fwk_id_t perf_domain_id;
+
+    /* 依 temperature 遞增；可為 NULL */
+    const struct mod_clock_cap_thermal_step *thermal_steps;
+    unsigned int thermal_step_count;
+
+    /* 解除一個門檻前，溫度必須低於門檻這麼多 (m°C) */
+    int32_t thermal_hysteresis;
+
+    /* 功率預算換算用；可為 NULL */
+    const struct mod_clock_cap_power_point *power_table;
+    unsigned int power_point_count;
+};
+
+/* 模組設定 */
+struct mod_clock_cap_config {
+    /* FWK_E_BUSY 重試用的計時器 alarm (可選，未設定時等下一次輸入) */
+    fwk_id_t retry_alarm_id;
+};
+
+/*
+ * 模組提供的 API
+ * (實際專案中應放在 mod_clock_cap.h)
+ *
+ * 除了 set_rate 之外都可以在 alarm / 感測器中斷的 callback 中呼叫
+ */
+struct mod_clock_cap_api {
+    /* 直接指定某個來源的上限 (Hz)；MOD_CLOCK_CAP_NO_LIMIT 解除 */
+    int (*set_limit)(fwk_id_t domain_id, enum mod_clock_cap_source source,
+                     uint64_t max_rate);
+
+    /* 溫度輸入 (m°C)，依 thermal_steps 換算成上限 */
+    int (*update_temperature)(fwk_id_t domain_id, int32_t temperature);
+
+    /* 功率預算 (mW)，依 power_table 換算成上限；0 表示不限制 */
+    int (*update_power_budget)(fwk_id_t domain_id, uint32_t budget);
+
+    /*
+     * 代理要求的頻率 (由 scmi_clock 在事件中呼叫)，記住後套用 min(rate, 上限)；
+     * 回 FWK_E_BUSY 時要求不保留，由呼叫端重送。PERF domain 回 FWK_E_SUPPORT
+     */
+    int (*set_rate)(fwk_id_t domain_id, uint64_t rate,
+                    enum mod_clock_round_mode round_mode);
+
+    /* 目前生效的上限；沒有限制時為 MOD_CLOCK_CAP_NO_LIMIT */
+    int (*get_cap)(fwk_id_t domain_id, uint64_t *cap);
+};
+
+/* 統計 */
+struct mod_clock_cap_stats {
+    /* 因上限而改變頻率的次數 */
+    uint32_t clamps;
+    /* 上限解除後恢復要求頻率的次數 */
+    uint32_t restores;
+    /* 代理要求被壓低的次數 */
+    uint32_t clamped_requests;
+    /* 從限制輸入到頻率生效的時間 (ns)，包含事件派送 */
+    uint32_t last_response_ns;
+    uint32_t max_response_ns;
+};
+
+/* domain 執行期狀態 */
+struct clock_cap_domain_ctx {
+    const struct mod_clock_cap_domain_config *config;
+
+    /* 各來源的上限與其最小值 (中斷中更新) */
+    uint64_t limit[MOD_CLOCK_CAP_SOURCE_COUNT];
+    uint64_t cap;
+
+    /* 目前已越過的溫度門檻數 */
+    unsigned int thermal_level;
+
+    /* 上限改變，等待套用事件；input_time 為第一筆未套用輸入的時間 */
+    bool apply_pending;
+    fwk_timestamp_t input_time;
+
+    /* 代理最後要求的頻率；0 表示尚未有要求，首次受限時記下當時的頻率 */
+    uint64_t requested_rate;
+    enum mod_clock_round_mode round_mode;
+
+    /* 最後一次套用的頻率 */
+    uint64_t applied_rate;
+
+    /* 本模組送出、驅動回 FWK_PENDING 的 set_rate，以及送出前的頻率 */
+    bool in_flight;
+    uint64_t prev_rate;
+
+    /* 時鐘驅動回 FWK_E_BUSY (共用 PLL 忙碌)，等 alarm 重試 */
+    bool deferred;
+
+    struct mod_clock_cap_stats stats;
+};
+
+struct clock_cap_ctx {
+    const struct mod_clock_cap_config *config;
+
+    struct clock_cap_domain_ctx *domain_ctx;
+    unsigned int domain_count;
+
+    /* 是否已排入套用事件 (中斷與事件兩端存取) */
+    volatile bool apply_queued;
+
+    /* 重試 alarm 是否已排定 */
+    bool retry_armed;
+
+    const struct mod_clock_api *clock_api;
+    const struct mod_scmi_clock_notify_api *notify_api;
+    const struct mod_scmi_perf_cap_api *perf_cap_api;
+    const struct mod_timer_alarm_api *alarm_api;
+};
+
+enum clock_cap_event_idx {
+    CLOCK_CAP_EVENT_IDX_APPLY,
+    CLOCK_CAP_EVENT_IDX_RETRY,
+    CLOCK_CAP_EVENT_IDX_COUNT,
+};
+
+static const fwk_id_t clock_cap_event_apply =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_CLOCK_CAP, CLOCK_CAP_EVENT_IDX_APPLY);
+
+static const fwk_id_t clock_cap_event_retry =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_CLOCK_CAP, CLOCK_CAP_EVENT_IDX_RETRY);
+
+static struct clock_cap_ctx clock_cap_ctx;
+
+static struct clock_cap_domain_ctx *clock_cap_get_domain(fwk_id_t domain_id)
+{
+    unsigned int idx = fwk_id_get_element_idx(domain_id);
+
+    if (!fwk_module_is_valid_element_id(domain_id) ||
+        idx >= clock_cap_ctx.domain_count)
+        return NULL;
+
+    return &clock_cap_ctx.domain_ctx[idx];
+}
+
+static bool clock_cap_is_perf(const struct clock_cap_domain_ctx *domain)
+{
+    return fwk_optional_id_is_defined(domain->config->perf_domain_id);
+}
+
+/* 排入套用事件 (重複呼叫只會排一次)；fwk_put_event 可在中斷中使用 */
+static void clock_cap_queue_apply(void)
+{
+    struct fwk_event event = {
+        .source_id = FWK_ID_MODULE(FWK_MODULE_IDX_CLOCK_CAP),
+        .target_id = FWK_ID_MODULE(FWK_MODULE_IDX_CLOCK_CAP),
+        .id = clock_cap_event_apply,
+    };
+
+    fwk_interrupt_global_disable();
+    if (clock_cap_ctx.apply_queued) {
+        fwk_interrupt_global_enable();
+        return;
+    }
+    clock_cap_ctx.apply_queued = true;
+    fwk_interrupt_global_enable();
+
+    if (fwk_put_event(&event) != FWK_SUCCESS)
+        clock_cap_ctx.apply_queued = false;
+}
+
+/*
+ * alarm callback 在中斷環境執行，只排入事件
+ */
+static void clock_cap_retry_alarm_callback(uintptr_t param)
+{
+    struct fwk_event event = {
+        .source_id = FWK_ID_MODULE(FWK_MODULE_IDX_CLOCK_CAP),
+        .target_id = FWK_ID_MODULE(FWK_MODULE_IDX_CLOCK_CAP),
+        .id = clock_cap_event_retry,
+    };
+
+    fwk_put_event(&event);
+}
+
+/* 排定一次延後套用的重試 (已排定則略過) */
+static void clock_cap_arm_retry(void)
+{
+    int status;
+
+    if (clock_cap_ctx.alarm_api == NULL || clock_cap_ctx.retry_armed)
+        return;
+
+    status = clock_cap_ctx.alarm_api->start(
+        clock_cap_ctx.config->retry_alarm_id, CLOCK_CAP_RETRY_MS,
+        MOD_TIMER_ALARM_TYPE_ONCE, clock_cap_retry_alarm_callback, 0);
+    if (status == FWK_SUCCESS)
+        clock_cap_ctx.retry_armed = true;
+}
+
+/* 各來源上限的最小值 */
+static uint64_t clock_cap_compute(const struct clock_cap_domain_ctx *domain)
+{
+    uint64_t cap = MOD_CLOCK_CAP_NO_LIMIT;
+    unsigned int source;
+
+    for (source = 0; source < MOD_CLOCK_CAP_SOURCE_COUNT; source++) {
+        if (domain->limit[source] == MOD_CLOCK_CAP_NO_LIMIT)
+            continue;
+        if (cap == MOD_CLOCK_CAP_NO_LIMIT || domain->limit[source] < cap)
+            cap = domain->limit[source];
+    }
+
+    return cap;
+}
+
+/* 中斷端寫入的上限，在事件端讀取 (64 位元讀取不是單一指令) */
+static uint64_t clock_cap_read_cap(const struct clock_cap_domain_ctx *domain)
+{
+    uint64_t cap;
+
+    fwk_interrupt_global_disable();
+    cap = domain->cap;
+    fwk_interrupt_global_enable();
+
+    return cap;
+}
+
+/* 記錄從限制輸入到頻率生效的時間 */
+static void clock_cap_record_response(struct clock_cap_domain_ctx *domain,
+                                      fwk_timestamp_t input_time)
+{
+    uint64_t elapsed;
+
+    if (input_time == 0)
+        return;
+
+    elapsed = fwk_time_current() - input_time;
+    domain->stats.last_response_ns =
+        (uint32_t)FWK_MIN(elapsed, (uint64_t)UINT32_MAX);
+    domain->stats.max_response_ns = FWK_MAX(domain->stats.max_response_ns,
+                                            domain->stats.last_response_ns);
+}
+
+/*
+ * 上限造成的頻率變更生效：統計並通知代理
+ * (經由 scmi_clock 的通知 API，agent_id 為 0 表示由平台發起)
+ */
+static void clock_cap_rate_applied(struct clock_cap_domain_ctx *domain,
+                                   uint64_t prev_rate)
+{
+    int status;
+
+    if (domain->applied_rate == prev_rate)
+        return;
+
+    if (domain->applied_rate < prev_rate)
+        domain->stats.clamps++;
+    else
+        domain->stats.restores++;
+
+    status = clock_cap_ctx.notify_api->rate_changed(domain->config->clock_id,
+                                                    domain->applied_rate);
+    if (status != FWK_SUCCESS && status != FWK_E_PARAM)
+        fwk_log_error("[CLOCK CAP] RATE_CHANGED failed: %d", status);
+}
+
+/*
+ * 把 domain 的頻率調整到 min(要求, 上限)，只在事件中呼叫
+ * 代理要求本身的頻率變更由 scmi_clock 通知與完成；其餘 (上限造成的)
+ * 由本模組通知，驅動回 FWK_PENDING 時在 mod_clock 的完成事件收尾
+ */
+static int clock_cap_apply(struct clock_cap_domain_ctx *domain,
+                           bool agent_request)
+{
+    fwk_id_t clock_id = domain->config->clock_id;
+    enum mod_clock_round_mode round_mode;
+    uint64_t target, cap, current;
+    int status;
+
+    cap = clock_cap_read_cap(domain);
+
+    if (clock_cap_is_perf(domain)) {
+        status = clock_cap_ctx.perf_cap_api->set_cap(
+            domain->config->perf_domain_id, cap);
+        domain->deferred = (status == FWK_E_BUSY);
+        if (domain->deferred)
+            clock_cap_arm_retry();
+        return status;
+    }
+
+    /* 本模組的 set_rate 尚未完成，完成事件中再套用 */
+    if (domain->in_flight)
+        return FWK_E_BUSY;
+
+    /* 開機頻率等不經過本模組的變更，所以每次都從驅動讀回 */
+    status = clock_cap_ctx.clock_api->get_rate(clock_id, &current);
+    if (status != FWK_SUCCESS)
+        current = domain->applied_rate;
+
+    /* 尚無代理要求時，以第一次受限前的頻率作為解除後的恢復目標 */
+    if (domain->requested_rate == 0)
+        domain->requested_rate = current;
+    target = domain->requested_rate;
+    round_mode = domain->round_mode;
+
+    /* 受限時向下捨入，確保不超過上限 */
+    if (cap != MOD_CLOCK_CAP_NO_LIMIT && target >= cap) {
+        target = cap;
+        round_mode = MOD_CLOCK_ROUND_MODE_DOWN;
+    }
+
+    status = FWK_SUCCESS;
+    if (target != current)
+        status = clock_cap_ctx.clock_api->set_rate(clock_id, target,
+                                                   round_mode);
+
+    if (status != FWK_E_BUSY)
+        domain->deferred = false;
+
+    switch (status) {
+    case FWK_SUCCESS:
+        /* 讀回實際套用的頻率 (捨入後) */
+        if (clock_cap_ctx.clock_api->get_rate(clock_id,
+                                              &domain->applied_rate) !=
+            FWK_SUCCESS)
+            domain->applied_rate = target;
+        if (!agent_request)
+            clock_cap_rate_applied(domain, current);
+        break;
+
+    case FWK_PENDING:
+        /* 代理要求的完成事件送回 scmi_clock，本模組只等自己送出的 */
+        if (!agent_request) {
+            domain->in_flight = true;
+            domain->prev_rate = current;
+        }
+        break;
+
+    case FWK_E_BUSY:
+        /* 共用 PLL 忙碌；代理要求由呼叫端重送，上限以 alarm 重試 */
+        if (!agent_request) {
+            domain->deferred = true;
+            clock_cap_arm_retry();
+        }
+        break;
+
+    default:
+        fwk_log_error("[CLOCK CAP] set_rate %llu Hz failed: %d",
+                      target, status);
+        break;
+    }
+
+    return status;
+}
+
+/*
+ * 某個來源的上限改變 (可在中斷中呼叫)
+ * 只更新上限並排入套用事件，頻率在事件中調整
+ */
+static int clock_cap_update(struct clock_cap_domain_ctx *domain,
+                            enum mod_clock_cap_source source,
+                            uint64_t max_rate)
+{
+    uint64_t cap;
+
+    fwk_interrupt_global_disable();
+    domain->limit[source] = max_rate;
+    cap = clock_cap_compute(domain);
+    if (cap == domain->cap) {
+        fwk_interrupt_global_enable();
+        return FWK_SUCCESS;
+    }
+    domain->cap = cap;
+    if (!domain->apply_pending) {
+        domain->apply_pending = true;
+        domain->input_time = fwk_time_current();
+    }
+    fwk_interrupt_global_enable();
+
+    clock_cap_queue_apply();
+
+    return FWK_SUCCESS;
+}
+
+static int clock_cap_set_limit(fwk_id_t domain_id,
+                               enum mod_clock_cap_source source,
+                               uint64_t max_rate)
+{
+    struct clock_cap_domain_ctx *domain = clock_cap_get_domain(domain_id);
+
+    if (domain == NULL || source >= MOD_CLOCK_CAP_SOURCE_COUNT)
+        return FWK_E_PARAM;
+
+    return clock_cap_update(domain, source, max_rate);
+}
+
+/*
+ * 溫度換算成上限：越過門檻立即生效，
+ * 解除門檻需要低於 temperature - thermal_hysteresis，避免在門檻附近來回切換
+ */
+static int clock_cap_update_temperature(fwk_id_t domain_id,
+                                        int32_t temperature)
+{
+    struct clock_cap_domain_ctx *domain = clock_cap_get_domain(domain_id);
+    const struct mod_clock_cap_domain_config *config;
+    unsigned int level;
+
+    if (domain == NULL)
+        return FWK_E_PARAM;
+
+    config = domain->config;
+    if (config->thermal_step_count == 0)
+        return FWK_E_SUPPORT;
+
+    level = domain->thermal_level;
+    while (level < config->thermal_step_count &&
+           temperature >= config->thermal_steps[level].temperature)
+        level++;
+    while (level > 0 &&
+           temperature < config->thermal_steps[level - 1].temperature -
+                         config->thermal_hysteresis)
+        level--;
+
+    if (level == domain->thermal_level)
+        return FWK_SUCCESS;
+
+    domain->thermal_level = level;
+
+    return clock_cap_update(domain, MOD_CLOCK_CAP_SOURCE_THERMAL,
+                            (level == 0) ? MOD_CLOCK_CAP_NO_LIMIT :
+                            config->thermal_steps[level - 1].max_rate);
+}
+
+/* 功率預算換算成上限：功耗不超過預算的最高頻率，至少保留最低一點 */
+static int clock_cap_update_power_budget(fwk_id_t domain_id, uint32_t budget)
+{
+    struct clock_cap_domain_ctx *domain = clock_cap_get_domain(domain_id);
+    const struct mod_clock_cap_domain_config *config;
+    uint64_t max_rate;
+    unsigned int i;
+
+    if (domain == NULL)
+        return FWK_E_PARAM;
+
+    config = domain->config;
+    if (config->power_point_count == 0)
+        return FWK_E_SUPPORT;
+
+    if (budget == 0)
+        return clock_cap_update(domain, MOD_CLOCK_CAP_SOURCE_POWER,
+                                MOD_CLOCK_CAP_NO_LIMIT);
+
+    max_rate = config->power_table[0].rate;
+    for (i = 1; i < config->power_point_count; i++) {
+        if (config->power_table[i].power > budget)
+            break;
+        max_rate = config->power_table[i].rate;
+    }
+
+    /* 預算足以跑最高點時等同沒有限制 */
+    if (i == config->power_point_count)
+        max_rate = MOD_CLOCK_CAP_NO_LIMIT;
+
+    return clock_cap_update(domain, MOD_CLOCK_CAP_SOURCE_POWER, max_rate);
+}
+
+/*
+ * 代理的頻率要求 (scmi_clock_rate_set_handler 經由此處設定受限的時鐘)
+ * 要求本身一定記住，即使目前被壓低；驅動忙碌時還原成上一次的要求，
+ * 讓代理收到 BUSY 後重送。回傳時鐘驅動的狀態
+ */
+static int clock_cap_set_rate(fwk_id_t domain_id, uint64_t rate,
+                              enum mod_clock_round_mode round_mode)
+{
+    struct clock_cap_domain_ctx *domain = clock_cap_get_domain(domain_id);
+    enum mod_clock_round_mode prev_round_mode;
+    uint64_t cap, prev_rate;
+    int status;
+
+    if (domain == NULL || rate == 0)
+        return FWK_E_PARAM;
+
+    /* PERF domain 的頻率只能經由 LEVEL_SET 改變 */
+    if (clock_cap_is_perf(domain))
+        return FWK_E_SUPPORT;
+
+    prev_rate = domain->requested_rate;
+    prev_round_mode = domain->round_mode;
+    domain->requested_rate = rate;
+    domain->round_mode = round_mode;
+
+    status = clock_cap_apply(domain, true);
+    if (status == FWK_E_BUSY) {
+        domain->requested_rate = prev_rate;
+        domain->round_mode = prev_round_mode;
+        return status;
+    }
+
+    cap = clock_cap_read_cap(domain);
+    if (cap != MOD_CLOCK_CAP_NO_LIMIT && rate > cap)
+        domain->stats.clamped_requests++;
+
+    return status;
+}
+
+static int clock_cap_get_cap(fwk_id_t domain_id, uint64_t *cap)
+{
+    struct clock_cap_domain_ctx *domain = clock_cap_get_domain(domain_id);
+
+    if (domain == NULL || cap == NULL)
+        return FWK_E_PARAM;
+
+    *cap = clock_cap_read_cap(domain);
+
+    return FWK_SUCCESS;
+}
+
+static const struct mod_clock_cap_api clock_cap_api = {
+    .set_limit = clock_cap_set_limit,
+    .update_temperature = clock_cap_update_temperature,
+    .update_power_budget = clock_cap_update_power_budget,
+    .set_rate = clock_cap_set_rate,
+    .get_cap = clock_cap_get_cap,
+};
+
+int clock_cap_get_stats(fwk_id_t domain_id, struct mod_clock_cap_stats *stats)
+{
+    struct clock_cap_domain_ctx *domain = clock_cap_get_domain(domain_id);
+
+    if (domain == NULL || stats == NULL)
+        return FWK_E_PARAM;
+
+    *stats = domain->stats;
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 套用事件：對上限改變的 domain 套用新上限
+ * retry 為 true 時 (alarm 到期或 PLL 釋放) 一併重試延後的 domain
+ */
+static int clock_cap_process_apply(bool retry)
+{
+    struct clock_cap_domain_ctx *domain;
+    fwk_timestamp_t input_time;
+    bool pending;
+    unsigned int i;
+    int status;
+
+    if (!retry)
+        clock_cap_ctx.apply_queued = false;
+
+    for (i = 0; i < clock_cap_ctx.domain_count; i++) {
+        domain = &clock_cap_ctx.domain_ctx[i];
+
+        fwk_interrupt_global_disable();
+        pending = domain->apply_pending;
+        input_time = domain->input_time;
+        fwk_interrupt_global_enable();
+
+        if (!pending && !(retry && domain->deferred))
+            continue;
+
+        /* 進行中的 set_rate 完成後會再回到這裡 */
+        if (domain->in_flight)
+            continue;
+
+        fwk_interrupt_global_disable();
+        domain->apply_pending = false;
+        domain->input_time = 0;
+        fwk_interrupt_global_enable();
+
+        status = clock_cap_apply(domain, false);
+        switch (status) {
+        case FWK_SUCCESS:
+            clock_cap_record_response(domain, input_time);
+            break;
+
+        case FWK_PENDING:
+            /* 在完成事件中記錄 */
+            fwk_interrupt_global_disable();
+            if (domain->input_time == 0)
+                domain->input_time = input_time;
+            fwk_interrupt_global_enable();
+            break;
+
+        case FWK_E_BUSY:
+            /* 保留輸入時間，重試成功後才算生效 */
+            fwk_interrupt_global_disable();
+            if (domain->input_time == 0)
+                domain->input_time = input_time;
+            fwk_interrupt_global_enable();
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 非同步時鐘驅動完成本模組送出的 set_rate：讀回實際頻率並通知，
+ * PLL 釋放後重試延後的 domain 與期間改變的上限
+ */
+static int clock_cap_set_rate_done(const struct fwk_event *event)
+{
+    const struct mod_clock_resp_params *params =
+        (const struct mod_clock_resp_params *)event->params;
+    struct clock_cap_domain_ctx *domain;
+    fwk_timestamp_t input_time;
+    unsigned int i;
+
+    for (i = 0; i < clock_cap_ctx.domain_count; i++) {
+        domain = &clock_cap_ctx.domain_ctx[i];
+        if (!domain->in_flight ||
+            !fwk_id_is_equal(domain->config->clock_id, event->source_id))
+            continue;
+
+        domain->in_flight = false;
+        if (params->status != FWK_SUCCESS) {
+            fwk_log_error("[CLOCK CAP] set_rate failed: %d", params->status);
+            continue;
+        }
+
+        if (clock_cap_ctx.clock_api->get_rate(domain->config->clock_id,
+                                              &domain->applied_rate) !=
+            FWK_SUCCESS)
+            continue;
+
+        fwk_interrupt_global_disable();
+        input_time = domain->apply_pending ? 0 : domain->input_time;
+        if (!domain->apply_pending)
+            domain->input_time = 0;
+        fwk_interrupt_global_enable();
+
+        clock_cap_record_response(domain, input_time);
+        clock_cap_rate_applied(domain, domain->prev_rate);
+    }
+
+    return clock_cap_process_apply(true);
+}
+
+/*
+ * 模組初始化
+ */
+static int clock_cap_init(fwk_id_t module_id, unsigned int element_count,
+                          const void *data)
+{
+    if (data == NULL || element_count == 0)
+        return FWK_E_PARAM;
+
+    clock_cap_ctx.config = data;
+    clock_cap_ctx.domain_count = element_count;
+    clock_cap_ctx.domain_ctx = fwk_mm_calloc(element_count,
+        sizeof(struct clock_cap_domain_ctx));
+
+    return FWK_SUCCESS;
+}
+
+static int clock_cap_element_init(fwk_id_t element_id, unsigned int unused,
+                                  const void *data)
+{
+    const struct mod_clock_cap_domain_config *config = data;
+    struct clock_cap_domain_ctx *domain;
+    unsigned int i;
+
+    if (config == NULL)
+        return FWK_E_PARAM;
+
+    for (i = 1; i < config->thermal_step_count; i++) {
+        if (config->thermal_steps[i].temperature <=
+            config->thermal_steps[i - 1].temperature)
+            return FWK_E_PARAM;
+    }
+
+    for (i = 1; i < config->power_point_count; i++) {
+        if (config->power_table[i].rate <= config->power_table[i - 1].rate)
+            return FWK_E_PARAM;
+    }
+
+    domain = &clock_cap_ctx.domain_ctx[fwk_id_get_element_idx(element_id)];
+    domain->config = config;
+    domain->round_mode = MOD_CLOCK_ROUND_MODE_NEAREST;
+
+    return FWK_SUCCESS;
+}
+
+static int clock_cap_bind(fwk_id_t id, unsigned int round)
+{
+    unsigned int i;
+    int status;
+
+    if (round == 1 || !fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    status = fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_CLOCK),
+                             FWK_ID_API(FWK_MODULE_IDX_CLOCK, 0),
+                             &clock_cap_ctx.clock_api);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    status = fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+                             FWK_ID_API(FWK_MODULE_IDX_SCMI_CLOCK,
+                                        MOD_SCMI_CLOCK_API_IDX_NOTIFY),
+                             &clock_cap_ctx.notify_api);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    /* 只有設定了 PERF domain 時才需要 PERF 的上限 API */
+    for (i = 0; i < clock_cap_ctx.domain_count; i++) {
+        if (!clock_cap_is_perf(&clock_cap_ctx.domain_ctx[i]))
+            continue;
+
+        status = fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_PERF),
+                                 FWK_ID_API(FWK_MODULE_IDX_SCMI_PERF,
+                                            MOD_SCMI_PERF_API_IDX_CAP),
+                                 &clock_cap_ctx.perf_cap_api);
+        if (status != FWK_SUCCESS)
+            return status;
+        break;
+    }
+
+    if (!fwk_id_is_type(clock_cap_ctx.config->retry_alarm_id,
+                        FWK_ID_TYPE_SUB_ELEMENT))
+        return FWK_SUCCESS;
+
+    return fwk_module_bind(clock_cap_ctx.config->retry_alarm_id,
+                           MOD_TIMER_API_ID_ALARM,
+                           &clock_cap_ctx.alarm_api);
+}
+
+static int clock_cap_process_bind_request(fwk_id_t source_id,
+                                          fwk_id_t target_id,
+                                          fwk_id_t api_id,
+                                          const void **api)
+{
+    *api = &clock_cap_api;
+
+    return FWK_SUCCESS;
+}
+
+static int clock_cap_process_event(const struct fwk_event *event,
+                                   struct fwk_event *resp_event)
+{
+    if (fwk_id_is_equal(event->id, clock_cap_event_apply))
+        return clock_cap_process_apply(false);
+
+    if (fwk_id_is_equal(event->id, clock_cap_event_retry)) {
+        clock_cap_ctx.retry_armed = false;
+        return clock_cap_process_apply(true);
+    }
+
+    if (fwk_id_is_equal(event->id, mod_clock_event_id_request))
+        return clock_cap_set_rate_done(event);
+
+    return FWK_E_PARAM;
+}
+
+/* 模組描述符 */
+const struct fwk_module module_clock_cap = {
+    .name = "Clock Capping Engine",
+    .type = FWK_MODULE_TYPE_SERVICE,
+    .api_count = 1,
+    .event_count = CLOCK_CAP_EVENT_IDX_COUNT,
+    .init = clock_cap_init,
+    .element_init = clock_cap_element_init,
+    .bind = clock_cap_bind,
+    .process_bind_request = clock_cap_process_bind_request,
+    .process_event = clock_cap_process_event,
+};
+
+/*
+ * 範例 (GPU，代理要求 800MHz，溫度門檻 85°C -> 600MHz、95°C -> 400MHz，
+ * 遲滯 5°C)：
+ *
+ *   t=0      RATE_SET 800MHz           requested = 800M，套用 800M
+ *   t=10ms   感測器 alarm 86°C         cap = 600M，排入套用事件；
+ *                                      事件中套用 600M，RATE_CHANGED 600M
+ *   t=12ms   RATE_SET 700MHz           requested = 700M，套用 600M
+ *   t=30ms   感測器 alarm 82°C         仍高於 80°C，維持 600M
+ *   t=50ms   感測器 alarm 79°C         cap 解除，恢復 requested 700M，
+ *                                      RATE_CHANGED 700M
+ *
+ * CPU domain 的上限交給 SCMI PERF：86°C 時 PERF 把 level 壓到 1.5GHz 以下
+ * 的最高 OPP；解除時 DVFS engine 先把電壓升到要求的 OPP 再 relock。
+ *
+ * 過去 t=10ms 的降頻要等 Linux thermal polling 與一次 SCMI 往返，
+ * 現在只差一次事件派送與 set_rate 的時間 (stats.max_response_ns)。
+ */
@@ -0,0 +1,949 @@
+/*
+ * SCP Firmware DVFS Transition Engine Example
+ *
+ * 這個範例展示 SCP 端如何把電壓與頻率的調整協調成一次轉換：
+ *
+ *   - 升頻：電壓必須先到位，頻率才能升高
+ *   - 降頻：頻率先降下來，電壓才能降低
+ *   - 一次呼叫可以包含多個 domain (批次)，不同 PLL / rail 的操作並行
+ *
+ * 重疊的依據：relock 期間 CPU 被 mux 到 REFCLK (24MHz)，任何電壓下都安全，
+ * 所以電壓爬升可以和 PLL lock 同時進行，只有最後 mux 回 PLL 輸出
+ * 需要等電壓穩定；降頻 relock 時，mux 到 REFCLK 之後電壓就可以開始下降。
+ * 只改分頻器時 CPU 一直以實際頻率執行，無法重疊，維持嚴格順序。
+ *
+ * Ping-pong 模式的 domain (clock_config->pll_mode) relock 期間 CPU 仍以
+ * 原頻率跑在另一顆 PLL 上：升壓一樣可以與 lock 重疊，但降頻時電壓
+ * 要等 mux 切到新 PLL 之後才能下降。
+ *
+ * 共用同一條 rail 的 domain，rail 電壓取所有 domain 需求的最大值。
+ *
+ * 每次轉換先依時鐘驅動回報的 PLL 時序 (preset API 的 get_timing，與
+ * sw_pll 模型使用同一張表) 排出時間表 (plan)，再依時間順序執行；
+ * 要等的 lock 時間另以 estimate_lock 依 PLL 目前狀態詢問 (ping-pong 的
+ * 閒置 PLL 已在目標 VCO 時只剩 mux 切換)；
+ * 回報的 total_ns 是排程後的總時間，serial_ns 是逐一操作、不重疊時的時間。
+ *
+ * 執行是非同步的：transition() 執行時間 0 的操作後回傳 FWK_PENDING，
+ * 全部完成後送 mod_dvfs_transition_event_id_done 給呼叫者。
+ * 等待點依長度分兩種：
+ *   - 不到 1ms (PLL lock 200us、mux 10us、電壓 settle)：以 timer 的
+ *     delay 就地等待 (us 解析度)。mod_timer 的 alarm 以 ms 為單位，
+ *     用它等會讓 220us 的 relock 變成 2ms，CPU 也多停在 24MHz 的
+ *     REFCLK 上至少 1ms；就地等待期間事件迴圈暫停，最多不到 1ms，
+ *     與服務一頁 DESCRIBE_RATES 同一量級
+ *   - 1ms 以上 (大幅度的電壓爬升)：啟動 timer alarm，alarm callback
+ *     只排入事件，下一批操作在事件中執行，等待期間事件迴圈照常
+ *     服務其他請求；alarm 時間無條件進位到 ms
+ * 實際經過時間記在 report 的 elapsed_ns。
+ *
+ * 任一操作失敗時不再開始新的操作，只把已經 begin 的 relock 依原排程
+ * finish (該時間點之前需要的升壓都已送出)，尚未執行的降壓略過
+ * (電壓留在較高的一側，永遠安全)；每個 target 的 status 說明該 domain
+ * 是否到達目標，呼叫者據此更新自己的狀態。
+ */
+
+#include <fwk_event.h>
+#include <fwk_id.h>
+#include <fwk_log.h>
+#include <fwk_macros.h>
+#include <fwk_mm.h>
+#include <fwk_module.h>
+#include <fwk_module_idx.h>
+#include <fwk_status.h>
+#include <mod_timer.h>
+#include <mod_myplatform_clock.h>
+
+/* mod_timer 的 alarm 以 ms 為單位，delay 以 us 為單位 */
+#define DVFS_NS_PER_MS      1000000ULL
+#define DVFS_NS_PER_US      1000ULL
+
+/* 短於此的等待以 timer delay 就地等待，其餘用 alarm */
+#define DVFS_BUSY_WAIT_MAX_NS DVFS_NS_PER_MS
+
+/* DVFS domain 元素設定 */
+struct mod_dvfs_transition_domain_config {
+    /* 平台時鐘驅動元素 */
+    fwk_id_t clock_id;
+
+    /* 時鐘設定，開機時的 VCO 由 pll_config 推得 */
+    const struct myplatform_clock_config *clock_config;
+
+    /* 供電的 rail (regulator 元素)，多個 domain 可共用 */
+    fwk_id_t regulator_id;
+
+    /* 開機時此 domain 需要的電壓 (mV) */
+    uint32_t initial_voltage;
+};
+
+/* 模組設定 */
+struct mod_dvfs_transition_config {
+    /* 平台時鐘驅動的預設值 API */
+    fwk_id_t clock_preset_api_id;
+
+    /* regulator API */
+    fwk_id_t regulator_api_id;
+
+    /* 等待排程時間點用的計時器 alarm (1ms 以上的等待) */
+    fwk_id_t alarm_id;
+
+    /*
+     * 不到 1ms 的等待用的 timer 裝置 (mod_timer 的 element，可選)；
+     * 未設定時所有等待都用 alarm
+     */
+    fwk_id_t timer_id;
+};
+
+/* 單一 domain 的轉換目標 */
+struct mod_dvfs_transition_target {
+    /* DVFS domain 元素 */
+    fwk_id_t domain_id;
+
+    /* 預先算好的 PLL 設定 */
+    const struct mod_myplatform_clock_preset *preset;
+
+    /* 目標頻率需要的電壓 (mV) */
+    uint32_t voltage;
+
+    /* 轉換完成時由 engine 填入：此 domain 是否到達目標 */
+    int status;
+};
+
+/* 轉換結果 */
+struct mod_dvfs_transition_report {
+    /* 排程後的總時間 */
+    uint64_t total_ns;
+
+    /* 所有操作逐一執行時的時間 (比較用) */
+    uint64_t serial_ns;
+
+    /* 實際經過的時間 (1ms 以上的等待以 ms 進位) */
+    uint64_t elapsed_ns;
+
+    unsigned int relock_count;
+    unsigned int div_switch_count;
+    unsigned int rail_change_count;
+};
+
+/*
+ * 模組提供的 API
+ * (實際專案中應放在 mod_dvfs_transition.h)
+ *
+ * transition 回傳 FWK_PENDING 表示已開始，完成時送
+ * mod_dvfs_transition_event_id_done 給 requester_id；
+ * targets 與 report (可為 NULL) 在完成事件送出前都必須保持有效。
+ * 同時只有一個轉換，進行中再呼叫回傳 FWK_E_BUSY
+ */
+struct mod_dvfs_transition_api {
+    int (*transition)(fwk_id_t requester_id,
+                      struct mod_dvfs_transition_target *targets,
+                      unsigned int count,
+                      struct mod_dvfs_transition_report *report);
+};
+
+enum mod_dvfs_transition_event_idx {
+    /* 內部：alarm 到期，執行下一批操作 */
+    MOD_DVFS_TRANSITION_EVENT_IDX_STEP,
+
+    /* 送給呼叫者：轉換結束 */
+    MOD_DVFS_TRANSITION_EVENT_IDX_DONE,
+
+    MOD_DVFS_TRANSITION_EVENT_IDX_COUNT,
+};
+
+static const fwk_id_t mod_dvfs_transition_event_id_done =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_DVFS_TRANSITION,
+                      MOD_DVFS_TRANSITION_EVENT_IDX_DONE);
+
+/* 完成事件的參數；各 domain 的結果在 targets[].status */
+struct mod_dvfs_transition_resp_params {
+    /* 第一個失敗操作的狀態，全部成功為 FWK_SUCCESS */
+    int status;
+};
+
+/*
+ * 電壓調節器 API，由 PMIC 驅動或 scp_sw_regulator_model.c 實作
+ * (實際專案中應放在 mod_dvfs_transition.h)
+ */
+struct mod_dvfs_regulator_api {
+    /* 開始調整電壓 (mV)，立即返回，不等待穩定 */
+    int (*set_voltage)(fwk_id_t regulator_id, uint32_t voltage);
+
+    /* 目前的目標電壓 (mV) */
+    int (*get_voltage)(fwk_id_t regulator_id, uint32_t *voltage);
+
+    /* 從 from 調整到 to 所需的穩定時間 (ns) */
+    int (*get_settle_time)(fwk_id_t regulator_id, uint32_t from,
+                           uint32_t to, uint32_t *settle_ns);
+};
+
+/*
+ * struct mod_myplatform_clock_preset、mod_myplatform_clock_timing 與
+ * mod_myplatform_clock_preset_api 見 scp_scmi_perf_handler.c
+ * (mod_myplatform_clock.h)
+ */
+
+static const fwk_id_t dvfs_event_id_step =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_DVFS_TRANSITION,
+                      MOD_DVFS_TRANSITION_EVENT_IDX_STEP);
+
+/* 排程中的操作種類 */
+enum dvfs_op_kind {
+    DVFS_OP_RAIL_SET,
+    DVFS_OP_PLL_BEGIN_RELOCK,
+    DVFS_OP_PLL_FINISH_RELOCK,
+    DVFS_OP_PLL_DIV,
+};
+
+struct dvfs_op {
+    uint64_t start_ns;
+    enum dvfs_op_kind kind;
+    /* rail 或 domain 索引 */
+    unsigned int idx;
+};
+
+/* rail 狀態 */
+struct dvfs_rail_ctx {
+    fwk_id_t regulator_id;
+    uint32_t voltage;
+
+    /* 本次轉換的規劃 */
+    uint32_t target_voltage;
+    uint64_t ready_ns;
+};
+
+/* domain 狀態 */
+struct dvfs_domain_ctx {
+    const struct mod_dvfs_transition_domain_config *config;
+    struct dvfs_rail_ctx *rail;
+
+    /* 時鐘驅動回報的 PLL 時序 (start 時讀取) */
+    struct mod_myplatform_clock_timing timing;
+
+    uint64_t vco_rate;
+    uint64_t rate;
+    uint32_t voltage;
+
+    /* 本次轉換的規劃 */
+    struct mod_dvfs_transition_target *target;
+    bool relock;
+
+    /* begin_relock 之後要等的 lock 時間 (時鐘驅動依目前 PLL 狀態估計) */
+    uint32_t lock_time_ns;
+
+    /* 執行狀態：relock 已 begin 尚未 finish、頻率已到達目標 */
+    bool relocking;
+    bool applied;
+
+    /* 在目前電壓以下仍然安全的時間點 (已到 REFCLK 或新頻率) */
+    uint64_t safe_ns;
+    uint64_t done_ns;
+};
+
+struct dvfs_transition_ctx {
+    const struct mod_dvfs_transition_config *config;
+
+    struct dvfs_domain_ctx *domain_ctx;
+    unsigned int domain_count;
+
+    struct dvfs_rail_ctx *rail_ctx;
+    unsigned int rail_count;
+
+    /* 時間表，容量為 domain 數 * 2 + rail 數 */
+    struct dvfs_op *ops;
+    unsigned int op_count;
+
+    /* 進行中的轉換 */
+    bool busy;
+    fwk_id_t requester_id;
+    struct mod_dvfs_transition_target *targets;
+    unsigned int target_count;
+    struct mod_dvfs_transition_report *report;
+    struct mod_dvfs_transition_report local_report;
+
+    /* 下一個要執行的操作、已經過的時間與 alarm 到期的時間 */
+    unsigned int next_op;
+    uint64_t elapsed_ns;
+    uint64_t alarm_ns;
+
+    /* 已執行的操作全部穩定的時間 */
+    uint64_t settle_ns;
+
+    /* 第一個失敗的狀態 */
+    int status;
+
+    bool step_queued;
+
+    const struct mod_myplatform_clock_preset_api *preset_api;
+    const struct mod_dvfs_regulator_api *regulator_api;
+    const struct mod_timer_alarm_api *alarm_api;
+    const struct mod_timer_api *timer_api;
+};
+
+static struct dvfs_transition_ctx dvfs_ctx;
+
+static uint64_t dvfs_preset_vco(const struct mod_myplatform_clock_preset *preset)
+{
+    return (uint64_t)preset->pll.ref_freq * preset->pll.multiplier /
+           preset->pll.divider;
+}
+
+/* 依開始時間插入時間表；同一時間點保持加入順序 */
+static void dvfs_plan_op(uint64_t start_ns, enum dvfs_op_kind kind,
+                         unsigned int idx)
+{
+    unsigned int i = dvfs_ctx.op_count++;
+
+    while (i > 0 && dvfs_ctx.ops[i - 1].start_ns > start_ns) {
+        dvfs_ctx.ops[i] = dvfs_ctx.ops[i - 1];
+        i--;
+    }
+
+    dvfs_ctx.ops[i].start_ns = start_ns;
+    dvfs_ctx.ops[i].kind = kind;
+    dvfs_ctx.ops[i].idx = idx;
+}
+
+/* 規劃 rail 電壓調整 (升壓時 start_ns 為 0) */
+static int dvfs_plan_rail(struct dvfs_rail_ctx *rail, uint64_t start_ns,
+                          struct mod_dvfs_transition_report *report)
+{
+    uint32_t settle_ns;
+    int status;
+
+    status = dvfs_ctx.regulator_api->get_settle_time(rail->regulator_id,
+                                                     rail->voltage,
+                                                     rail->target_voltage,
+                                                     &settle_ns);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    dvfs_plan_op(start_ns, DVFS_OP_RAIL_SET, rail - dvfs_ctx.rail_ctx);
+    rail->ready_ns = start_ns + settle_ns;
+
+    report->serial_ns += settle_ns;
+    report->rail_change_count++;
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 規劃單一 domain 的頻率調整
+ * not_before_ns：升頻時 rail 升壓完成的時間
+ */
+static void dvfs_plan_domain(struct dvfs_domain_ctx *domain,
+                             uint64_t not_before_ns,
+                             struct mod_dvfs_transition_report *report)
+{
+    const struct mod_myplatform_clock_timing *timing = &domain->timing;
+    unsigned int idx = domain - dvfs_ctx.domain_ctx;
+    uint64_t finish_ns;
+
+    if (domain->relock &&
+        domain->config->clock_config->pll_mode ==
+            MYPLATFORM_CLOCK_PLL_MODE_PING_PONG) {
+        /*
+         * 閒置 PLL 的 lock 與升壓重疊，切換前等電壓；
+         * 切換前一直以原頻率執行，降壓要等切換完成。
+         * 閒置 PLL 已在目標 VCO (切回上一個 VCO) 時不需等 lock
+         */
+        dvfs_plan_op(0, DVFS_OP_PLL_BEGIN_RELOCK, idx);
+        finish_ns = FWK_MAX((uint64_t)domain->lock_time_ns, not_before_ns);
+        dvfs_plan_op(finish_ns, DVFS_OP_PLL_FINISH_RELOCK, idx);
+
+        domain->done_ns = finish_ns + timing->mux_latency_ns;
+        domain->safe_ns = domain->done_ns;
+
+        report->serial_ns += (uint64_t)domain->lock_time_ns +
+                             timing->mux_latency_ns;
+        report->relock_count++;
+    } else if (domain->relock) {
+        /* mux 到 REFCLK 與 lock 跟升壓重疊，mux 回 PLL 前等電壓 */
+        dvfs_plan_op(0, DVFS_OP_PLL_BEGIN_RELOCK, idx);
+        finish_ns = FWK_MAX((uint64_t)timing->mux_latency_ns +
+                            domain->lock_time_ns, not_before_ns);
+        dvfs_plan_op(finish_ns, DVFS_OP_PLL_FINISH_RELOCK, idx);
+
+        domain->safe_ns = timing->mux_latency_ns;
+        domain->done_ns = finish_ns + timing->mux_latency_ns;
+
+        report->serial_ns += 2 * (uint64_t)timing->mux_latency_ns +
+                             domain->lock_time_ns;
+        report->relock_count++;
+    } else {
+        /* 只改分頻器：CPU 以實際頻率執行，不能與電壓調整重疊 */
+        dvfs_plan_op(not_before_ns, DVFS_OP_PLL_DIV, idx);
+
+        domain->done_ns = not_before_ns + timing->div_switch_ns;
+        domain->safe_ns = domain->done_ns;
+
+        report->serial_ns += timing->div_switch_ns;
+        report->div_switch_count++;
+    }
+}
+
+/* 建立整批轉換的時間表 */
+static int dvfs_plan(struct mod_dvfs_transition_target *targets,
+                     unsigned int count,
+                     struct mod_dvfs_transition_report *report)
+{
+    struct dvfs_domain_ctx *domain;
+    struct dvfs_rail_ctx *rail;
+    uint64_t lower_start_ns;
+    unsigned int i, idx;
+    uint32_t voltage;
+    bool up;
+    int status;
+
+    for (i = 0; i < dvfs_ctx.domain_count; i++)
+        dvfs_ctx.domain_ctx[i].target = NULL;
+
+    for (i = 0; i < count; i++) {
+        if (!fwk_module_is_valid_element_id(targets[i].domain_id) ||
+            targets[i].preset == NULL)
+            return FWK_E_PARAM;
+
+        idx = fwk_id_get_element_idx(targets[i].domain_id);
+        domain = &dvfs_ctx.domain_ctx[idx];
+
+        /* 同一批次內一個 domain 只能出現一次 */
+        if (domain->target != NULL)
+            return FWK_E_PARAM;
+
+        domain->target = &targets[i];
+        domain->relock = dvfs_preset_vco(targets[i].preset) != domain->vco_rate;
+        domain->lock_time_ns = 0;
+        if (!domain->relock)
+            continue;
+
+        status = dvfs_ctx.preset_api->estimate_lock(domain->config->clock_id,
+                                                    targets[i].preset,
+                                                    &domain->lock_time_ns);
+        if (status != FWK_SUCCESS)
+            return status;
+    }
+
+    /* rail 目標電壓：所有 domain 需求的最大值 */
+    for (i = 0; i < dvfs_ctx.rail_count; i++) {
+        dvfs_ctx.rail_ctx[i].target_voltage = 0;
+        dvfs_ctx.rail_ctx[i].ready_ns = 0;
+    }
+
+    for (i = 0; i < dvfs_ctx.domain_count; i++) {
+        domain = &dvfs_ctx.domain_ctx[i];
+        voltage = (domain->target != NULL) ? domain->target->voltage :
+                                             domain->voltage;
+        domain->rail->target_voltage = FWK_MAX(domain->rail->target_voltage,
+                                               voltage);
+    }
+
+    /* 升壓在時間 0 開始 */
+    for (i = 0; i < dvfs_ctx.rail_count; i++) {
+        rail = &dvfs_ctx.rail_ctx[i];
+        if (rail->target_voltage <= rail->voltage)
+            continue;
+
+        status = dvfs_plan_rail(rail, 0, report);
+        if (status != FWK_SUCCESS)
+            return status;
+    }
+
+    /* 頻率調整：升頻等待所在 rail 升壓完成，降頻不受限制 */
+    for (i = 0; i < dvfs_ctx.domain_count; i++) {
+        domain = &dvfs_ctx.domain_ctx[i];
+        if (domain->target == NULL)
+            continue;
+
+        up = domain->target->preset->rate > domain->rate;
+        dvfs_plan_domain(domain, up ? domain->rail->ready_ns : 0, report);
+    }
+
+    /*
+     * 降壓：等到 rail 上每個需要較高電壓的 domain 都已離開舊頻率
+     * (relock 時 mux 到 REFCLK 即可，改分頻器則要等切換完成)
+     */
+    for (i = 0; i < dvfs_ctx.rail_count; i++) {
+        rail = &dvfs_ctx.rail_ctx[i];
+        if (rail->target_voltage >= rail->voltage)
+            continue;
+
+        lower_start_ns = 0;
+        for (idx = 0; idx < dvfs_ctx.domain_count; idx++) {
+            domain = &dvfs_ctx.domain_ctx[idx];
+            if (domain->rail != rail || domain->target == NULL ||
+                domain->voltage <= rail->target_voltage)
+                continue;
+
+            lower_start_ns = FWK_MAX(lower_start_ns, domain->safe_ns);
+        }
+
+        status = dvfs_plan_rail(rail, lower_start_ns, report);
+        if (status != FWK_SUCCESS)
+            return status;
+    }
+
+    for (i = 0; i < dvfs_ctx.domain_count; i++) {
+        domain = &dvfs_ctx.domain_ctx[i];
+        if (domain->target != NULL)
+            report->total_ns = FWK_MAX(report->total_ns, domain->done_ns);
+    }
+
+    for (i = 0; i < dvfs_ctx.rail_count; i++)
+        report->total_ns = FWK_MAX(report->total_ns, dvfs_ctx.rail_ctx[i].ready_ns);
+
+    return FWK_SUCCESS;
+}
+
+/* 執行單一操作並更新狀態；settle_ns 延長到此操作穩定的時間 */
+static int dvfs_execute_op(const struct dvfs_op *op)
+{
+    struct dvfs_domain_ctx *domain = &dvfs_ctx.domain_ctx[op->idx];
+    struct dvfs_rail_ctx *rail = &dvfs_ctx.rail_ctx[op->idx];
+    int status;
+
+    switch (op->kind) {
+    case DVFS_OP_RAIL_SET:
+        status = dvfs_ctx.regulator_api->set_voltage(rail->regulator_id,
+                                                     rail->target_voltage);
+        if (status != FWK_SUCCESS)
+            return status;
+
+        rail->voltage = rail->target_voltage;
+        dvfs_ctx.settle_ns = FWK_MAX(dvfs_ctx.settle_ns, rail->ready_ns);
+        return FWK_SUCCESS;
+
+    case DVFS_OP_PLL_BEGIN_RELOCK:
+        status = dvfs_ctx.preset_api->begin_relock(domain->config->clock_id,
+                                                   domain->target->preset);
+        if (status != FWK_SUCCESS)
+            return status;
+
+        /* PLL 已開始 lock 到新的 VCO，之後一定要 finish */
+        domain->relocking = true;
+        domain->vco_rate = dvfs_preset_vco(domain->target->preset);
+        return FWK_SUCCESS;
+
+    case DVFS_OP_PLL_FINISH_RELOCK:
+        domain->relocking = false;
+        status = dvfs_ctx.preset_api->finish_relock(domain->config->clock_id);
+        break;
+
+    case DVFS_OP_PLL_DIV:
+        status = dvfs_ctx.preset_api->apply_preset(domain->config->clock_id,
+                                                   domain->target->preset);
+        break;
+
+    default:
+        return FWK_E_PARAM;
+    }
+
+    if (status != FWK_SUCCESS)
+        return status;
+
+    domain->vco_rate = dvfs_preset_vco(domain->target->preset);
+    domain->rate = domain->target->preset->rate;
+    domain->voltage = domain->target->voltage;
+    domain->applied = true;
+    dvfs_ctx.settle_ns = FWK_MAX(dvfs_ctx.settle_ns, domain->done_ns);
+
+    return FWK_SUCCESS;
+}
+
+/* alarm callback 在中斷環境執行，只排入事件 */
+static void dvfs_alarm_callback(uintptr_t param)
+{
+    struct fwk_event event = {
+        .source_id = FWK_ID_MODULE(FWK_MODULE_IDX_DVFS_TRANSITION),
+        .target_id = FWK_ID_MODULE(FWK_MODULE_IDX_DVFS_TRANSITION),
+        .id = dvfs_event_id_step,
+    };
+
+    if (dvfs_ctx.step_queued)
+        return;
+
+    if (fwk_put_event(&event) == FWK_SUCCESS)
+        dvfs_ctx.step_queued = true;
+}
+
+/*
+ * 等到 until_ns (相對於轉換開始)
+ * 不到 1ms 時以 timer delay 就地等待，回傳 FWK_SUCCESS 並更新 elapsed_ns；
+ * 否則啟動 alarm，回傳 FWK_PENDING，由 alarm 事件接續
+ */
+static int dvfs_wait(uint64_t until_ns)
+{
+    uint64_t wait_ns = until_ns - dvfs_ctx.elapsed_ns;
+    unsigned int ms;
+    uint32_t us;
+    int status;
+
+    if (dvfs_ctx.timer_api != NULL && wait_ns < DVFS_BUSY_WAIT_MAX_NS) {
+        us = (uint32_t)((wait_ns + DVFS_NS_PER_US - 1) / DVFS_NS_PER_US);
+        status = dvfs_ctx.timer_api->delay(dvfs_ctx.config->timer_id, us);
+        if (status != FWK_SUCCESS)
+            return status;
+
+        dvfs_ctx.elapsed_ns += (uint64_t)us * DVFS_NS_PER_US;
+        return FWK_SUCCESS;
+    }
+
+    ms = (unsigned int)((wait_ns + DVFS_NS_PER_MS - 1) / DVFS_NS_PER_MS);
+    dvfs_ctx.alarm_ns = dvfs_ctx.elapsed_ns + (uint64_t)ms * DVFS_NS_PER_MS;
+
+    status = dvfs_ctx.alarm_api->start(dvfs_ctx.config->alarm_id, ms,
+                                       MOD_TIMER_ALARM_TYPE_ONCE,
+                                       dvfs_alarm_callback, 0);
+
+    return (status == FWK_SUCCESS) ? FWK_PENDING : status;
+}
+
+/* 轉換結束：填入每個 target 的結果並通知呼叫者 */
+static void dvfs_complete(void)
+{
+    struct mod_dvfs_transition_resp_params *params;
+    struct mod_dvfs_transition_target *target;
+    struct dvfs_domain_ctx *domain;
+    struct fwk_event event = {
+        .source_id = FWK_ID_MODULE(FWK_MODULE_IDX_DVFS_TRANSITION),
+        .target_id = dvfs_ctx.requester_id,
+        .id = mod_dvfs_transition_event_id_done,
+    };
+    unsigned int i;
+    int status;
+
+    for (i = 0; i < dvfs_ctx.target_count; i++) {
+        target = &dvfs_ctx.targets[i];
+        domain = &dvfs_ctx.domain_ctx[fwk_id_get_element_idx(
+            target->domain_id)];
+
+        if (domain->applied)
+            target->status = FWK_SUCCESS;
+        else if (dvfs_ctx.status != FWK_SUCCESS)
+            target->status = dvfs_ctx.status;
+        else
+            target->status = FWK_E_STATE;
+    }
+
+    dvfs_ctx.local_report.elapsed_ns = dvfs_ctx.elapsed_ns;
+
+    fwk_log_debug("[DVFS] %u domains: %llu ns planned (serial %llu ns), "
+                  "%llu ns elapsed, %u relock, %u div, %u rail, status %d",
+                  dvfs_ctx.target_count, dvfs_ctx.local_report.total_ns,
+                  dvfs_ctx.local_report.serial_ns, dvfs_ctx.elapsed_ns,
+                  dvfs_ctx.local_report.relock_count,
+                  dvfs_ctx.local_report.div_switch_count,
+                  dvfs_ctx.local_report.rail_change_count, dvfs_ctx.status);
+
+    if (dvfs_ctx.report != NULL)
+        *dvfs_ctx.report = dvfs_ctx.local_report;
+
+    params = (struct mod_dvfs_transition_resp_params *)event.params;
+    params->status = dvfs_ctx.status;
+
+    dvfs_ctx.busy = false;
+    dvfs_ctx.targets = NULL;
+
+    status = fwk_put_event(&event);
+    if (status != FWK_SUCCESS)
+        fwk_log_error("[DVFS] Failed to report completion: %d", status);
+}
+
+/*
+ * 執行所有已到排定時間的操作，接著等下一個時間點或結束
+ * 失敗後只執行已 begin 的 relock 的 finish
+ */
+static void dvfs_run(void)
+{
+    struct dvfs_domain_ctx *domain;
+    const struct dvfs_op *op;
+    int status;
+
+    while (dvfs_ctx.next_op < dvfs_ctx.op_count) {
+        op = &dvfs_ctx.ops[dvfs_ctx.next_op];
+        domain = &dvfs_ctx.domain_ctx[op->idx];
+
+        /* 失敗後略過的操作不需要等 */
+        if (dvfs_ctx.status != FWK_SUCCESS &&
+            (op->kind != DVFS_OP_PLL_FINISH_RELOCK || !domain->relocking)) {
+            dvfs_ctx.next_op++;
+            continue;
+        }
+
+        if (op->start_ns > dvfs_ctx.elapsed_ns) {
+            status = dvfs_wait(op->start_ns);
+            if (status == FWK_PENDING)
+                return;
+            if (status == FWK_SUCCESS)
+                continue;
+
+            /* timer 只會因設定錯誤而失敗：不再等待，直接收尾 */
+            fwk_log_error("[DVFS] Failed to wait: %d", status);
+            if (dvfs_ctx.status == FWK_SUCCESS)
+                dvfs_ctx.status = status;
+            dvfs_ctx.elapsed_ns = op->start_ns;
+            continue;
+        }
+
+        dvfs_ctx.next_op++;
+
+        status = dvfs_execute_op(op);
+        if (status != FWK_SUCCESS) {
+            fwk_log_error("[DVFS] Operation %u (kind %u, idx %u) failed: %d",
+                          dvfs_ctx.next_op - 1, op->kind, op->idx, status);
+            if (dvfs_ctx.status == FWK_SUCCESS)
+                dvfs_ctx.status = status;
+        }
+    }
+
+    /* 等待最後的 mux / 電壓穩定 */
+    if (dvfs_ctx.settle_ns > dvfs_ctx.elapsed_ns &&
+        dvfs_wait(dvfs_ctx.settle_ns) == FWK_PENDING)
+        return;
+
+    dvfs_complete();
+}
+
+/*
+ * 協調一批 domain 的電壓與頻率轉換
+ * 時間 0 的操作在這裡執行；不到 1ms 的等待就地完成，
+ * 需要 alarm 時由 alarm 事件接續
+ */
+static int dvfs_transition(fwk_id_t requester_id,
+                           struct mod_dvfs_transition_target *targets,
+                           unsigned int count,
+                           struct mod_dvfs_transition_report *report)
+{
+    unsigned int i;
+    int status;
+
+    if (targets == NULL || count == 0 || count > dvfs_ctx.domain_count)
+        return FWK_E_PARAM;
+
+    if (dvfs_ctx.busy)
+        return FWK_E_BUSY;
+
+    dvfs_ctx.op_count = 0;
+    dvfs_ctx.local_report = (struct mod_dvfs_transition_report){ 0 };
+
+    status = dvfs_plan(targets, count, &dvfs_ctx.local_report);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    for (i = 0; i < dvfs_ctx.domain_count; i++) {
+        dvfs_ctx.domain_ctx[i].relocking = false;
+        dvfs_ctx.domain_ctx[i].applied = false;
+    }
+
+    dvfs_ctx.busy = true;
+    dvfs_ctx.requester_id = requester_id;
+    dvfs_ctx.targets = targets;
+    dvfs_ctx.target_count = count;
+    dvfs_ctx.report = report;
+    dvfs_ctx.next_op = 0;
+    dvfs_ctx.elapsed_ns = 0;
+    dvfs_ctx.settle_ns = 0;
+    dvfs_ctx.status = FWK_SUCCESS;
+
+    dvfs_run();
+
+    return FWK_PENDING;
+}
+
+static const struct mod_dvfs_transition_api dvfs_transition_api = {
+    .transition = dvfs_transition,
+};
+
+/*
+ * 模組框架介面
+ */
+
+static int dvfs_transition_init(fwk_id_t module_id,
+                                unsigned int element_count,
+                                const void *data)
+{
+    if (data == NULL || element_count == 0)
+        return FWK_E_PARAM;
+
+    dvfs_ctx.config = data;
+    dvfs_ctx.domain_count = element_count;
+    dvfs_ctx.domain_ctx = fwk_mm_calloc(element_count,
+                                        sizeof(struct dvfs_domain_ctx));
+
+    /* 最壞情況每個 domain 各自一條 rail */
+    dvfs_ctx.rail_ctx = fwk_mm_calloc(element_count,
+                                      sizeof(struct dvfs_rail_ctx));
+    dvfs_ctx.ops = fwk_mm_calloc(element_count * 3, sizeof(struct dvfs_op));
+    dvfs_ctx.requester_id = FWK_ID_NONE;
+
+    return FWK_SUCCESS;
+}
+
+/* 取得 (或建立) regulator 對應的 rail */
+static struct dvfs_rail_ctx *dvfs_get_rail(fwk_id_t regulator_id)
+{
+    struct dvfs_rail_ctx *rail;
+    unsigned int i;
+
+    for (i = 0; i < dvfs_ctx.rail_count; i++) {
+        if (fwk_id_is_equal(dvfs_ctx.rail_ctx[i].regulator_id, regulator_id))
+            return &dvfs_ctx.rail_ctx[i];
+    }
+
+    rail = &dvfs_ctx.rail_ctx[dvfs_ctx.rail_count++];
+    rail->regulator_id = regulator_id;
+
+    return rail;
+}
+
+static int dvfs_transition_element_init(fwk_id_t element_id,
+                                        unsigned int unused,
+                                        const void *data)
+{
+    const struct mod_dvfs_transition_domain_config *config = data;
+    const struct myplatform_pll_config *pll;
+    struct dvfs_domain_ctx *domain;
+
+    if (config == NULL || config->clock_config == NULL)
+        return FWK_E_PARAM;
+
+    domain = &dvfs_ctx.domain_ctx[fwk_id_get_element_idx(element_id)];
+    domain->config = config;
+    domain->rail = dvfs_get_rail(config->regulator_id);
+    domain->voltage = config->initial_voltage;
+
+    /* 開機狀態：PLL 以 pll_config 的預設值執行 */
+    pll = &config->clock_config->pll_config;
+    domain->vco_rate = (uint64_t)pll->ref_freq * pll->multiplier / pll->divider;
+    domain->rate = domain->vco_rate / pll->post_div;
+
+    return FWK_SUCCESS;
+}
+
+static int dvfs_transition_bind(fwk_id_t id, unsigned int round)
+{
+    const struct mod_dvfs_transition_config *config = dvfs_ctx.config;
+    int status;
+
+    if (round == 1 || !fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    status = fwk_module_bind(
+        fwk_id_build_module_id(config->clock_preset_api_id),
+        config->clock_preset_api_id,
+        &dvfs_ctx.preset_api);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    status = fwk_module_bind(
+        fwk_id_build_module_id(config->regulator_api_id),
+        config->regulator_api_id,
+        &dvfs_ctx.regulator_api);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    if (fwk_optional_id_is_defined(config->timer_id)) {
+        status = fwk_module_bind(config->timer_id,
+                                 MOD_TIMER_API_ID_TIMER,
+                                 &dvfs_ctx.timer_api);
+        if (status != FWK_SUCCESS)
+            return status;
+    }
+
+    return fwk_module_bind(config->alarm_id,
+                           MOD_TIMER_API_ID_ALARM,
+                           &dvfs_ctx.alarm_api);
+}
+
+/*
+ * 讀回各 rail 的實際電壓，作為第一次轉換的起點；
+ * PLL 時序向時鐘驅動查詢，不在本模組另外設定一份
+ */
+static int dvfs_transition_start(fwk_id_t id)
+{
+    struct dvfs_domain_ctx *domain;
+    struct dvfs_rail_ctx *rail;
+    unsigned int i;
+    int status;
+
+    if (!fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    for (i = 0; i < dvfs_ctx.domain_count; i++) {
+        domain = &dvfs_ctx.domain_ctx[i];
+        status = dvfs_ctx.preset_api->get_timing(domain->config->clock_id,
+                                                 &domain->timing);
+        if (status != FWK_SUCCESS)
+            return status;
+    }
+
+    for (i = 0; i < dvfs_ctx.rail_count; i++) {
+        rail = &dvfs_ctx.rail_ctx[i];
+        status = dvfs_ctx.regulator_api->get_voltage(rail->regulator_id,
+                                                     &rail->voltage);
+        if (status != FWK_SUCCESS)
+            return status;
+    }
+
+    return FWK_SUCCESS;
+}
+
+static int dvfs_transition_process_bind_request(fwk_id_t source_id,
+                                                fwk_id_t target_id,
+                                                fwk_id_t api_id,
+                                                const void **api)
+{
+    *api = &dvfs_transition_api;
+
+    return FWK_SUCCESS;
+}
+
+static int dvfs_transition_process_event(const struct fwk_event *event,
+                                         struct fwk_event *resp_event)
+{
+    if (!fwk_id_is_equal(event->id, dvfs_event_id_step))
+        return FWK_E_PARAM;
+
+    dvfs_ctx.step_queued = false;
+    if (!dvfs_ctx.busy)
+        return FWK_SUCCESS;
+
+    dvfs_ctx.elapsed_ns = dvfs_ctx.alarm_ns;
+    dvfs_run();
+
+    return FWK_SUCCESS;
+}
+
+/* 模組描述符 */
+const struct fwk_module module_dvfs_transition = {
+    .name = "DVFS Transition Engine",
+    .type = FWK_MODULE_TYPE_SERVICE,
+    .api_count = 1,
+    .event_count = MOD_DVFS_TRANSITION_EVENT_IDX_COUNT,
+    .init = dvfs_transition_init,
+    .element_init = dvfs_transition_element_init,
+    .bind = dvfs_transition_bind,
+    .start = dvfs_transition_start,
+    .process_bind_request = dvfs_transition_process_bind_request,
+    .process_event = dvfs_transition_process_event,
+};
+
+/*
+ * 時間表範例 (CPU0 1.2GHz/800mV -> 2.0GHz/950mV，需要 relock；
+ * PLL lock 200us、mux 10us，rail 10mV/us、settle 5us)：
+ *
+ *   t=0       RAIL_SET 950mV        (settle 15us + 5us = 20us)
+ *   t=0       BEGIN_RELOCK          (mux 到 REFCLK，PLL 開始 lock)
+ *   t=210us   FINISH_RELOCK         (lock 完成，電壓早已穩定)
+ *   total = 220us，serial = 20us + 220us = 240us
+ *
+ * 只改分頻器的升頻 (例如 2.0GHz 的 VCO 切到 1.0GHz 再回 2.0GHz)
+ * 則嚴格為 RAIL_SET -> 等 20us -> PLL_DIV。
+ *
+ * 執行時兩個等待點都不到 1ms，以 timer delay 就地等待：FINISH_RELOCK
+ * 在 210us 執行、220us 回報完成 (elapsed_ns = 220000)，CPU 停在 REFCLK
+ * 的時間就是排程的 210us。改用 ms alarm 會在 1ms 才 finish、2ms 才
+ * 完成。若 BEGIN_RELOCK 之後的某個操作失敗，該 domain 仍在 210us 時
+ * finish，降壓不執行，回報的 status 為失敗的狀態。
+ * 電壓爬升超過 1ms 的轉換 (例如 rail 1mV/us 爬 300mV) 在那個等待點
+ * 啟動 alarm，事件迴圈照常服務其他訊息。
+ */
@@ -9,10 +9,23 @@
 #include <fwk_element.h>
 #include <fwk_id.h>
 #include <fwk_macros.h>
+#include <fwk_mm.h>
+#include <fwk_notification.h>
 #include <fwk_status.h>
+#include <fwk_string.h>
+#include <fwk_time.h>
 #include <mod_scmi.h>
+#include <mod_scmi_channel_priority.h>
 #include <mod_scmi_clock.h>
 #include <mod_clock.h>
+#include <mod_clock_cap.h>
+#include <mod_reset_domain.h>
+#include <mod_timer.h>
+
+#ifdef BUILD_HAS_MOD_RESOURCE_PERMS
+#include <mod_resource_perms.h>
+#include <mod_scmi_reset_domain.h>
+#endif
 
 /* SCMI Clock 協議命令定義 */
 enum scmi_clock_command_id {
@@ -21,6 +34,15 @@ enum scmi_clock_command_id {
     SCMI_CLOCK_RATE_SET = 0x5,
     SCMI_CLOCK_RATE_GET = 0x6,
     SCMI_CLOCK_CONFIG_SET = 0x7,
+    SCMI_CLOCK_RATE_NOTIFY = 0x9,
+    SCMI_CLOCK_RATE_CHANGE_REQUESTED_NOTIFY = 0xA,
+    SCMI_CLOCK_NEGOTIATE_PROTOCOL_VERSION = 0x10,
+
+    /* 廠商擴充命令 */
+    SCMI_CLOCK_VENDOR_STATE_SNAPSHOT = 0xC0,
+    SCMI_CLOCK_VENDOR_TRANSITION_COST = 0xC1,
+    SCMI_CLOCK_VENDOR_DESCRIBE_RATES_COMPACT = 0xC2,
+    SCMI_CLOCK_VENDOR_BRINGUP_SCRIPT = 0xC3,
 };
 
 /* SCMI Clock Rate Set 命令結構 */
@@ -36,12 +58,456 @@ struct scmi_clock_rate_set_p2a {
     int32_t status;
 };
 
+/* RATE_SET flags bit[0]：非同步，先回應再以 delayed response 回報結果 */
+#define SCMI_CLOCK_RATE_SET_ASYNC (1U << 0)
+
+/* 非同步 RATE_SET 完成時的 delayed response (CLOCK_RATE_SET_COMPLETE) */
+struct scmi_clock_rate_set_complete_p2a {
+    int32_t status;
+    uint32_t clock_id;
+    uint32_t rate_low;
+    uint32_t rate_high;
+};
+
+/*
+ * 模組提供的 API
+ * (實際專案中 API 索引與結構應放在 mod_scmi_clock.h 供其他模組引用)
+ */
+enum mod_scmi_clock_api_idx {
+    MOD_SCMI_CLOCK_API_IDX_PROTOCOL,
+    MOD_SCMI_CLOCK_API_IDX_NOTIFY,
+    MOD_SCMI_CLOCK_API_IDX_REG,
+    MOD_SCMI_CLOCK_API_IDX_STATS,
+    MOD_SCMI_CLOCK_API_IDX_COUNT,
+};
+
+/* SCP 內部模組改變時鐘頻率後，透過此 API 通知已訂閱的代理 */
+struct mod_scmi_clock_notify_api {
+    int (*rate_changed)(fwk_id_t clock_element_id, uint64_t rate);
+};
+
+/*
+ * 每個代理的流量限制統計 (除錯/效能分析用)
+ * agent_id 為 mod_scmi 的代理索引
+ */
+struct mod_scmi_clock_stats_api {
+    int (*get_agent_stats)(unsigned int agent_id,
+                           struct mod_scmi_clock_agent_stats *stats);
+};
+
+/*
+ * 暫存器快速路徑 (SMC/HVC，見 scmi_smc_fast_transport_example.c)
+ *
+ * RATE_SET / RATE_GET / CONFIG_SET 的參數全部放在 SMC 引數暫存器，
+ * 不經過 shmem，也沒有 SCMI message header：
+ *   args[0] (x1)  message_id
+ *   args[1] (x2)  clock_id
+ *   args[2] (x3)  rate 低 32 位元 (CONFIG_SET 為 attributes)
+ *   args[3] (x4)  rate 高 32 位元
+ * 回傳：
+ *   ret[0]  (x0)  SCMI 狀態
+ *   ret[1]  (x1)  rate 低 32 位元 (RATE_GET 為目前頻率，RATE_SET 為請求的頻率)
+ *   ret[2]  (x2)  rate 高 32 位元
+ *   ret[3]  (x3)  旗標，見 SCMI_CLOCK_REG_RET_*
+ * 全部以 32 位元表示，SMC32/HVC32 也能使用
+ *
+ * RATE_SET 和 shmem 路徑一樣在本模組的事件中執行 (PLL 可能非同步完成)，
+ * SMC 返回時只代表請求已被接受：ret[3] 帶 IN_PROGRESS，實際套用的頻率
+ * 以 RATE_CHANGED 經該代理的 P2A 通道送回 (不論它是否訂閱)，
+ * 其他訂閱者照常收到
+ *
+ * EL3 monitor 不能直接呼叫這個 API：SCP 是另一顆處理器。monitor 的 SMC
+ * handler 把 x1-x4 寫入只有 secure world 能存取的 mailbox 資料暫存器
+ * (每個代理一個通道) 並送 doorbell；SCP 端的 mailbox 轉接模組在中斷中
+ * 只排入事件，在事件中讀出 4 個字呼叫 process()，寫回 4 個回傳字後清除
+ * doorbell；monitor 等到清除才把它們放進 x0-x3 返回。
+ * 轉接模組的寫法見 scmi_smc_fast_monitor.c
+ */
+#define SCMI_CLOCK_REG_ARGS 4
+#define SCMI_CLOCK_REG_RETS 4
+
+#define SCMI_CLOCK_REG_RET_IN_PROGRESS (1U << 0)
+
+/*
+ * 暫存器式 mailbox 的轉接模組綁定此 API，把暫存器原樣交給 SCMI Clock。
+ * service_id 是該 mailbox 通道所屬代理的 mod_scmi service：代理身分與
+ * 權限都由 mod_scmi 的設定決定，不由呼叫端自報
+ */
+struct mod_scmi_clock_reg_api {
+    int (*process)(fwk_id_t service_id,
+                   const uint32_t args[SCMI_CLOCK_REG_ARGS],
+                   uint32_t ret[SCMI_CLOCK_REG_RETS]);
+};
+
+/* SCMI Clock 協議通知 (P2A) 定義 */
+enum scmi_clock_notification_id {
+    SCMI_CLOCK_RATE_CHANGED = 0x0,
+    SCMI_CLOCK_RATE_CHANGE_REQUESTED = 0x1,
+};
+
+/* RATE_NOTIFY / RATE_CHANGE_REQUESTED_NOTIFY 命令結構 */
+struct scmi_clock_notify_a2p {
+    uint32_t clock_id;
+    uint32_t notify_enable;
+};
+
+/* 通知內容 */
+struct scmi_clock_rate_notification_p2a {
+    uint32_t agent_id;
+    uint32_t clock_id;
+    uint32_t rate_low;
+    uint32_t rate_high;
+};
+
+/*
+ * 本模組實作的 Clock 協議版本，以及 NEGOTIATE_PROTOCOL_VERSION 可接受的
+ * 最舊版本；代理沒有協商時以實作的版本回應
+ */
+#define SCMI_CLOCK_PROTOCOL_VERSION     UINT32_C(0x30000)
+#define SCMI_CLOCK_PROTOCOL_VERSION_MIN UINT32_C(0x10000)
+
+/* clock_enable_latency 從 v2.0 起是 CLOCK_ATTRIBUTES 回應的一部分 */
+#define SCMI_CLOCK_PROTOCOL_VERSION_ENABLE_LATENCY UINT32_C(0x20000)
+
+/*
+ * CLOCK_ATTRIBUTES 廠商擴充：
+ * bit[16] 表示回應在 clock_enable_latency 之後附帶 SCP 開機時已套用的
+ * 初始頻率，driver 以它作為頻率快取的初值，註冊時不必送 RATE_GET。
+ * 擴充接在標準欄位之後，只回給協商版本 >= 2.0 的代理；v1.0 的回應
+ * 沒有 clock_enable_latency，也不設 bit[16] (v1.0 中為保留位元)
+ */
+#define SCMI_CLOCK_ATTRIBUTES_ENABLED            (1U << 0)
+#define SCMI_CLOCK_ATTRIBUTES_INITIAL_RATE_VALID (1U << 16)
+#define SCMI_CLOCK_ATTRIBUTES_TRANSITION_COST    (1U << 17)
+#define SCMI_CLOCK_ATTRIBUTES_RATE_REQ_NOTIFY    (1U << 30)
+#define SCMI_CLOCK_ATTRIBUTES_RATE_CHANGED_NOTIFY (1U << 31)
+
+/* SCMI Clock Attributes 回應結構 (含初始頻率擴充) */
+struct scmi_clock_attributes_p2a {
+    int32_t status;
+    uint32_t attributes;
+    char clock_name[16];
+    /* v2.0 起的標準欄位 (us)；沒有量測值，回 0 */
+    uint32_t clock_enable_latency;
+    /* 廠商擴充，INITIAL_RATE_VALID 時有效 */
+    uint32_t initial_rate_low;
+    uint32_t initial_rate_high;
+};
+
+struct scmi_clock_negotiate_version_a2p {
+    uint32_t version;
+};
+
+/*
+ * STATE_SNAPSHOT 廠商命令：一次回傳連續一段 clock ID 的 (id, rate, enabled)
+ * generation 在每次頻率/狀態變更時遞增，driver 分頁讀取時
+ * 比對首尾兩頁的 generation 即可確認整份快照是一致的。
+ * 變更來源與遞增的位置：
+ *   SCMI CLOCK RATE_SET/CONFIG_SET、開機頻率   本模組的 handler
+ *   PERF (含 DVFS engine)、clock_cap          notify API 的 rate_changed
+ *   power domain 關閉/恢復                    mod_clock 的 state_changed 通知
+ */
+#define SCMI_CLOCK_SNAPSHOT_MAX_ENTRIES 32
+#define SCMI_CLOCK_SNAPSHOT_ENABLED     (1U << 0)
+
+struct scmi_clock_snapshot_a2p {
+    uint32_t first_clock_id;
+    uint32_t clock_count;
+};
+
+struct scmi_clock_snapshot_entry {
+    uint32_t clock_id;
+    uint32_t flags;
+    uint32_t rate_low;
+    uint32_t rate_high;
+};
+
+struct scmi_clock_snapshot_p2a {
+    int32_t status;
+    uint32_t generation;
+    /* bits[15:0] 本次回傳數量，bits[31:16] 剩餘數量 */
+    uint32_t num_entries;
+    struct scmi_clock_snapshot_entry entries[SCMI_CLOCK_SNAPSHOT_MAX_ENTRIES];
+};
+
+/*
+ * TRANSITION_COST 廠商命令：回報單一時鐘兩種轉換的延遲與能量成本
+ * 數值來自平台設定 (PLL lock 時間等)；SCP 另外量測實際 RATE_SET 從
+ * 呼叫 driver 到完成 (含 FWK_PENDING 後的完成事件) 的時間，
+ * 依 driver 是否回 FWK_PENDING 分成 relock 與直接完成兩組。
+ * flags bit[0]/bit[1] 表示對應的量測值有效；
+ * bit[2] 表示 swap 成本有效 (ping-pong 時鐘切回閒置 PLL 已 lock 的
+ * VCO 時不需 lock，relock 成本是閒置 PLL 要重新 lock 的情況)
+ */
+#define SCMI_CLOCK_COST_MEASURED_VALID     (1U << 0)
+#define SCMI_CLOCK_COST_MEASURED_DIV_VALID (1U << 1)
+#define SCMI_CLOCK_COST_SWAP_VALID         (1U << 2)
+
+struct scmi_clock_transition_cost_p2a {
+    int32_t status;
+    uint32_t flags;
+    /* 需要 PLL relock 的頻率變更 */
+    uint32_t relock_latency_us;
+    uint32_t relock_energy_nj;
+    /* 只切換分頻器的頻率變更 */
+    uint32_t div_latency_us;
+    uint32_t div_energy_nj;
+    /* 最近一個量測視窗內 relock 的最大值與長期平均 */
+    uint32_t measured_latency_us;
+    uint32_t measured_avg_us;
+    /* 最近一個量測視窗內直接完成 (只換分頻器) 的最大值 */
+    uint32_t measured_div_latency_us;
+    /* ping-pong：閒置 PLL 已在目標 VCO 的頻率變更 */
+    uint32_t swap_latency_us;
+    uint32_t swap_energy_nj;
+};
+
+/*
+ * DESCRIBE_RATES 命令結構
+ * num_rates_flags：bit[11:0] 本次回傳數、bit[12] 1 表示 range 三元組、
+ * bit[31:16] 尚未回傳的數量
+ */
+#define SCMI_CLOCK_DESCRIBE_RATES_MAX 8
+#define SCMI_CLOCK_RATE_FORMAT_RANGE  (1U << 12)
+
+struct scmi_clock_describe_rates_a2p {
+    uint32_t clock_id;
+    uint32_t rate_index;
+};
+
+struct scmi_clock_describe_rates_p2a {
+    int32_t status;
+    uint32_t num_rates_flags;
+    struct {
+        uint32_t low;
+        uint32_t high;
+    } rates[SCMI_CLOCK_DESCRIBE_RATES_MAX];
+};
+
+/*
+ * DESCRIBE_RATES_COMPACT 廠商命令
+ *
+ * 兩種編碼 (format，bit[13:12])：
+ *   TRIPLET：base = min，values = {max_low, max_high, step_low, step_high}；
+ *            DISCRETE 旗標 (bit[14]) 表示是等差的離散表，需展開成列表
+ *   DELTA：  base = rates[rate_index]，values[i] = 後一個頻率與前一個的差
+ *            (u32)；本頁共 1 + returned 個頻率，分頁時每頁都帶絕對 base
+ *
+ * same_as 是頻率表與本時鐘完全相同的最小 clock ID (沒有則為自己)，
+ * 由 SCP 逐一比對完整內容得出。代理已解碼過那顆時鐘的表時 (例如共用
+ * peripheral_clock_config 的 UART/I2C/SPI)，只讀第一頁就可以共用
+ */
+#define SCMI_CLOCK_COMPACT_MAX_VALUES     24
+#define SCMI_CLOCK_COMPACT_FORMAT_TRIPLET (0U << 12)
+#define SCMI_CLOCK_COMPACT_FORMAT_DELTA   (1U << 12)
+#define SCMI_CLOCK_COMPACT_DISCRETE       (1U << 14)
+
+struct scmi_clock_describe_rates_compact_p2a {
+    int32_t status;
+    /* bit[11:0] values 數、bit[13:12] format、bit[14] discrete、bit[31:16] 剩餘 */
+    uint32_t flags;
+    uint32_t same_as;
+    /* 表內頻率總數 (連續範圍為 0) */
+    uint32_t total_rates;
+    uint32_t base_low;
+    uint32_t base_high;
+    uint32_t values[SCMI_CLOCK_COMPACT_MAX_VALUES];
+};
+
+/*
+ * BRINGUP_SCRIPT 廠商命令
+ *
+ * 子系統上電時常見的一長串 clock enable / rate set / reset assert / deassert
+ * (中間夾著穩定延遲) 合併成一則訊息，SCP 依序執行並回報每一步的狀態。
+ * 每一步 8 bytes：
+ *   op_target bits[7:0] = op，bits[31:16] = SCMI clock ID 或 reset domain ID
+ *   arg       RATE_SET 為 kHz；DELAY 為 us；RESET 為 reset_state
+ *             (0 表示 architectural reset)
+ * 128 bytes 的 payload 放得下 15 步，更長的序列由代理拆成多則訊息。
+ *
+ * 預設遇到第一個失敗的步驟就停止；CONTINUE_ON_ERROR 時跑完全部。
+ * 腳本格式正確時整體 status 為 SCMI_SUCCESS，各步驟的結果在 step_status，
+ * steps_executed 之後的步驟沒有執行。
+ *
+ * RATE_SET 步驟等到頻率實際生效 (包括 PLL 非同步 relock 完成) 才繼續，
+ * 腳本在兩步之間暫停、整個腳本結束後才回應；同一代理同時只能有一個
+ * 腳本，執行中再送會得到 SCMI_BUSY。
+ *
+ * 延遲步驟以代理的 script alarm (mod_scmi_clock_agent.script_alarm_id)
+ * 等待，腳本在這段期間暫停、不占住事件處理；alarm 以 ms 計，延遲向上
+ * 取整。沒有設定 alarm 的代理，延遲步驟回 SCMI_NOT_SUPPORTED。
+ * 腳本結束前通道一直被占住，因此每步與每個腳本的延遲仍有上限；
+ * 上限以向上取整後實際等待的時間計算 (DELAY 10us 占 1000us 的額度)，
+ * 通道被占住的時間才不會超過 5ms。更長的等待應拆成兩則訊息。
+ *
+ * reset 步驟與標準 RESET 訊息一樣檢查代理對該 reset domain 的權限。
+ */
+enum scmi_clock_script_op {
+    SCMI_CLOCK_SCRIPT_OP_CLOCK_ENABLE = 0,
+    SCMI_CLOCK_SCRIPT_OP_CLOCK_DISABLE = 1,
+    SCMI_CLOCK_SCRIPT_OP_RATE_SET_KHZ = 2,
+    SCMI_CLOCK_SCRIPT_OP_RESET_ASSERT = 3,
+    SCMI_CLOCK_SCRIPT_OP_RESET_DEASSERT = 4,
+    SCMI_CLOCK_SCRIPT_OP_DELAY_US = 5,
+};
+
+#define SCMI_CLOCK_SCRIPT_MAX_STEPS          15
+#define SCMI_CLOCK_SCRIPT_MAX_STEP_DELAY_US  1000
+#define SCMI_CLOCK_SCRIPT_MAX_TOTAL_DELAY_US 5000
+#define SCMI_CLOCK_SCRIPT_CONTINUE_ON_ERROR  (1U << 0)
+
+struct scmi_clock_script_step {
+    uint32_t op_target;
+    uint32_t arg;
+};
+
+struct scmi_clock_script_a2p {
+    uint32_t flags;
+    uint32_t step_count;
+    struct scmi_clock_script_step steps[SCMI_CLOCK_SCRIPT_MAX_STEPS];
+};
+
+struct scmi_clock_script_p2a {
+    int32_t status;
+    uint32_t steps_executed;
+    int32_t step_status[SCMI_CLOCK_SCRIPT_MAX_STEPS];
+};
+
+/* 每個時鐘的頻率表摘要，第一次查詢時計算 */
+struct scmi_clock_rate_summary {
+    bool valid;
+    /* 離散表是否為等差 (可用三元組表示) */
+    bool arithmetic;
+    /* 離散表的相鄰差值都放得進 u32 */
+    bool delta_fits;
+    /* 比對用的雜湊 (只用來略過不同的表，相同與否以完整內容判斷) */
+    uint32_t hash;
+    /* 內容完全相同的最小 clock ID */
+    bool same_as_valid;
+    uint32_t same_as;
+    /* 最低頻率與等差表的間距 */
+    uint64_t first;
+    uint64_t step;
+};
+
+/*
+ * RATE_SET 處理時間的量測結果 (每個 SCMI clock、每種轉換一筆)
+ * 回報的最大值只涵蓋最近一個完整視窗，PLL 老化或溫度改變後
+ * 不會永遠停在開機初期的最壞值
+ */
+#define SCMI_CLOCK_LATENCY_WINDOW     32
+#define SCMI_CLOCK_LATENCY_EWMA_SHIFT 3
+
+struct scmi_clock_latency_window {
+    /* 最近一個完整視窗的最大值 (視窗未滿前為目前視窗的最大值) */
+    uint32_t max_us;
+    uint32_t window_max_us;
+    uint32_t window_count;
+    uint32_t avg_us;
+    uint32_t samples;
+};
+
+enum scmi_clock_latency_kind {
+    SCMI_CLOCK_LATENCY_RELOCK,  /* driver 回 FWK_PENDING 後才完成 */
+    SCMI_CLOCK_LATENCY_DIRECT,  /* set_rate 直接完成 */
+    SCMI_CLOCK_LATENCY_KIND_COUNT,
+};
+
+struct scmi_clock_latency_stats {
+    struct scmi_clock_latency_window kind[SCMI_CLOCK_LATENCY_KIND_COUNT];
+};
+
 /* SCMI Clock Config Set 命令結構 */
 struct scmi_clock_config_set_a2p {
     uint32_t clock_id;
     uint32_t attributes;
 };
 
+/* 開機預設頻率的套用狀態 (每個 SCMI clock 一筆) */
+struct scmi_clock_boot_rate {
+    /* 已套用到硬體的頻率，0 表示未設定或尚未完成 */
+    uint64_t rate;
+
+    /* set_rate 回傳 FWK_PENDING，等待 PLL lock 完成 */
+    bool pending;
+
+    /* 共用 PLL 忙碌中，等其他請求完成或重試 alarm 到期後再送 */
+    bool deferred;
+};
+
+/* RATE_SET 的來源，決定完成時如何回報 */
+enum scmi_clock_rate_origin {
+    SCMI_CLOCK_RATE_ORIGIN_NONE,
+    /* shmem 同步 RATE_SET：完成時才回應 */
+    SCMI_CLOCK_RATE_ORIGIN_SHMEM,
+    /* shmem 非同步 RATE_SET：已回應，完成時送 delayed response */
+    SCMI_CLOCK_RATE_ORIGIN_SHMEM_ASYNC,
+    /* 暫存器快速路徑：SMC 已返回，完成時以 RATE_CHANGED 回報提出請求的代理 */
+    SCMI_CLOCK_RATE_ORIGIN_REG,
+    /* BRINGUP_SCRIPT 的步驟：完成時繼續執行腳本 */
+    SCMI_CLOCK_RATE_ORIGIN_SCRIPT,
+};
+
+/*
+ * 進行中的 RATE_SET (每個 SCMI clock 一筆)
+ *
+ * set_rate 在本模組的事件中呼叫，driver 回 FWK_PENDING 時 mod_clock 的
+ * 完成事件 (mod_clock_event_id_request 的回應) 才會送回本模組；
+ * 在那之前同一個時鐘的其他 RATE_SET 回 SCMI_BUSY
+ */
+struct scmi_clock_rate_op {
+    enum scmi_clock_rate_origin origin;
+
+    /* set_rate 已回傳 FWK_PENDING，等待完成事件 */
+    bool pending;
+
+    fwk_id_t service_id;
+    unsigned int agent_id;
+    uint64_t rate;
+    fwk_timestamp_t start;
+};
+
+/*
+ * 執行中的 BRINGUP_SCRIPT (每個代理一筆)
+ * RATE_SET 步驟要等完成事件，腳本在兩個步驟之間暫停；
+ * mod_scmi 的 payload buffer 在 handler 返回後會被重用，因此複製參數
+ */
+struct scmi_clock_script_run {
+    bool active;
+    fwk_id_t service_id;
+    bool stop_on_error;
+    uint32_t delay_budget_us;
+    struct scmi_clock_script_a2p params;
+    struct scmi_clock_script_p2a resp;
+};
+
+/*
+ * 共用 PLL 回 FWK_E_BUSY 時的重試間隔
+ * 忙碌的可能是其他模組 (例如 DVFS) 的請求，不一定會有本模組收得到的
+ * 完成事件，因此除了完成時重送之外，另以 alarm 定時重試
+ */
+#define SCMI_CLOCK_BOOT_RATE_RETRY_MS 1
+
+/*
+ * 每個代理的流量限制狀態與統計
+ *
+ * 每個 A2P 通道同時只有一則訊息 (SMT 與 ring 都等回應後才交出下一則)，
+ * 在這裡排隊永遠不會超過一則；服務順序由通道優先權模組
+ * (scp_scmi_channel_priority.c) 決定，這裡只以 token bucket 限制
+ * 每個代理的請求速率，超出時回 SCMI_BUSY
+ */
+struct scmi_clock_agent_sched {
+    /* 來自 mod_scmi_clock_agent.sched 的設定 */
+    const struct mod_scmi_clock_sched_config *config;
+
+    /* token bucket：以 milli-token 計，避免低速率時的捨入誤差 */
+    uint64_t tokens_milli;
+    fwk_timestamp_t last_refill;
+
+    /* 統計 */
+    struct mod_scmi_clock_agent_stats stats;
+};
+
 /* Clock 模組上下文 */
 struct scmi_clock_ctx {
     /* SCMI 服務 ID */
@@ -49,35 +515,265 @@ struct scmi_clock_ctx {
     
     /* Clock 模組 API */
     const struct mod_clock_api *clock_api;
+
+    /* SCMI 模組 API (用於回應) */
+    const struct mod_scmi_from_protocol_api *scmi_api;
+
+    /*
+     * 每個時鐘的通知訂閱者 (bit n 為 agent n，以 clock ID 索引)，
+     * 以及代理訂閱時使用的服務。自己記錄而不用 mod_scmi 的訂閱表，
+     * 才能在 RATE_CHANGED 排除提出請求的代理
+     */
+    uint32_t *rate_changed_subscribers;
+    uint32_t *rate_requested_subscribers;
+    fwk_id_t *agent_service_ids;
+
+    /* 頻率限制模組 API (scp_clock_cap.c)；沒有受限的時鐘時為 NULL */
+    const struct mod_clock_cap_api *cap_api;
+
+#ifdef BUILD_HAS_MOD_RESOURCE_PERMS
+    /* 代理對協議、命令與各時鐘的權限 */
+    const struct mod_res_permissions_api *res_perms_api;
+#endif
+
+    /* Reset Domain 模組 API (BRINGUP_SCRIPT 的 reset 步驟)；可為 NULL */
+    const struct mod_reset_domain_drv_api *reset_api;
+
+    /* BRINGUP_SCRIPT 可操作的 reset domain (以 SCMI reset domain ID 索引) */
+    const fwk_id_t *reset_domains;
+    unsigned int reset_domain_count;
     
     /* 支援的時鐘數量 */
     unsigned int clock_count;
     
     /* 時鐘設定表 */
     const struct mod_scmi_clock_device *clock_devices;
+
+    /* 代理設定表 (script alarm) */
+    const struct mod_scmi_clock_agent *agent_table;
+
+    /* 開機預設頻率狀態表 */
+    struct scmi_clock_boot_rate *boot_rates;
+
+    /* 進行中的 RATE_SET (以 clock ID 索引) */
+    struct scmi_clock_rate_op *rate_ops;
+
+    /* 執行中的 BRINGUP_SCRIPT (以 agent_id 索引) */
+    struct scmi_clock_script_run *script_runs;
+
+    /* 每個代理協商的協議版本 (以 agent_id 索引) */
+    uint32_t *agent_versions;
+
+    /* RATE_SET 處理時間量測 */
+    struct scmi_clock_latency_stats *latency_stats;
+
+    /* DESCRIBE_RATES_COMPACT 用的頻率表摘要 */
+    struct scmi_clock_rate_summary *rate_summaries;
+
+    /* 尚未完成的開機頻率請求數 */
+    unsigned int boot_rate_pending;
+
+    /* 開機頻率重試用的 alarm (未設定時只在完成事件時重送) */
+    fwk_id_t boot_rate_alarm_id;
+    const struct mod_timer_alarm_api *alarm_api;
+    bool boot_rate_retry_armed;
+
+    /* 頻率/啟用狀態的變更計數 (STATE_SNAPSHOT 一致性檢查用) */
+    uint32_t state_generation;
+
+    /* 代理流量限制狀態 (以 agent_id 索引) */
+    struct scmi_clock_agent_sched *agent_sched;
+    unsigned int agent_count;
+
+    /* 通道排程模組 (可選)，SCMI_BUSY 拒絕的訊息向它歸還額度 */
+    fwk_id_t channel_priority_id;
+    const struct mod_scmi_channel_priority_credit_api *channel_credit_api;
+};
+
+enum scmi_clock_event_idx {
+    /* start() 排入，開機頻率在本模組的事件中送出 */
+    SCMI_CLOCK_EVENT_IDX_BOOT_RATE_START,
+    SCMI_CLOCK_EVENT_IDX_BOOT_RATE_RETRY,
+    /* params[0] 為 clock ID，請求內容在 rate_ops */
+    SCMI_CLOCK_EVENT_IDX_RATE_SET,
+    /* params[0] 為 agent_id，腳本的延遲步驟到期 */
+    SCMI_CLOCK_EVENT_IDX_SCRIPT_DELAY,
+    SCMI_CLOCK_EVENT_IDX_COUNT,
 };
 
+static const fwk_id_t scmi_clock_event_boot_rate_start =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_SCMI_CLOCK,
+                      SCMI_CLOCK_EVENT_IDX_BOOT_RATE_START);
+
+static const fwk_id_t scmi_clock_event_boot_rate_retry =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_SCMI_CLOCK,
+                      SCMI_CLOCK_EVENT_IDX_BOOT_RATE_RETRY);
+
+static const fwk_id_t scmi_clock_event_rate_set =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_SCMI_CLOCK,
+                      SCMI_CLOCK_EVENT_IDX_RATE_SET);
+
+static const fwk_id_t scmi_clock_event_script_delay =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_SCMI_CLOCK,
+                      SCMI_CLOCK_EVENT_IDX_SCRIPT_DELAY);
+
 static struct scmi_clock_ctx scmi_clock_ctx;
 
+/*
+ * 送出時鐘頻率通知給訂閱的代理
+ * agent_id 為觸發變更的代理；SCP 自行變更 (例如溫控) 時為 0 (platform)。
+ * RATE_CHANGED 不送給提出請求的代理：它已從 RATE_SET 的回應得知結果，
+ * 再收到通知只會讓 driver 重複同步一次
+ */
+static void scmi_clock_send_rate_notification(unsigned int notification_id,
+                                             unsigned int agent_id,
+                                             uint32_t clock_id,
+                                             uint64_t rate)
+{
+    struct scmi_clock_rate_notification_p2a payload = {
+        .agent_id = agent_id,
+        .clock_id = clock_id,
+        .rate_low = (uint32_t)(rate & 0xFFFFFFFF),
+        .rate_high = (uint32_t)(rate >> 32),
+    };
+    unsigned int target;
+    uint32_t subscribers;
+
+    if (notification_id == SCMI_CLOCK_RATE_CHANGED) {
+        subscribers = scmi_clock_ctx.rate_changed_subscribers[clock_id];
+        if (agent_id != 0)
+            subscribers &= ~(1U << agent_id);
+    } else {
+        subscribers = scmi_clock_ctx.rate_requested_subscribers[clock_id];
+    }
+
+    while (subscribers != 0) {
+        target = __builtin_ctz(subscribers);
+        subscribers &= subscribers - 1;
+
+        /* mod_scmi 依代理的服務找到它的 P2A 通道 */
+        scmi_clock_ctx.scmi_api->notify(
+            scmi_clock_ctx.agent_service_ids[target],
+            MOD_SCMI_PROTOCOL_ID_CLOCK, notification_id,
+            &payload, sizeof(payload));
+    }
+}
+
+/* 由 SCMI clock ID 反查；找不到時回傳 clock_count */
+static uint32_t scmi_clock_find_clock_id(fwk_id_t clock_element_id)
+{
+    uint32_t clock_id;
+
+    for (clock_id = 0; clock_id < scmi_clock_ctx.clock_count; clock_id++) {
+        if (fwk_id_is_equal(scmi_clock_ctx.clock_devices[clock_id].element_id,
+                            clock_element_id))
+            break;
+    }
+
+    return clock_id;
+}
+
+/*
+ * 提供給其他 SCP 模組的 API：
+ * SCP 自行改變時鐘頻率後呼叫，讓 Linux 不必輪詢 recalc_rate
+ *
+ * PERF 擁有的 CPU 時鐘只遞增 generation (STATE_SNAPSHOT 一致性)，
+ * 不送 CLOCK RATE_CHANGED：OSPM 經 PERF 協議管理它們，level 變更由
+ * PERF 自己的通知回報，每次 DVFS 再對每顆 CPU 時鐘廣播只會多占 P2A 通道
+ */
+static int scmi_clock_notify_rate_changed(fwk_id_t clock_element_id,
+                                         uint64_t rate)
+{
+    uint32_t clock_id = scmi_clock_find_clock_id(clock_element_id);
+
+    if (clock_id >= scmi_clock_ctx.clock_count)
+        return FWK_E_PARAM;
+
+    scmi_clock_ctx.state_generation++;
+    if (scmi_clock_ctx.clock_devices[clock_id].perf_owned)
+        return FWK_SUCCESS;
+
+    scmi_clock_send_rate_notification(SCMI_CLOCK_RATE_CHANGED, 0,
+                                      clock_id, rate);
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 記錄一次 RATE_SET 的處理時間，作為 TRANSITION_COST 的量測值
+ * start 是呼叫 driver 的時間；非同步完成時在完成事件才呼叫到這裡
+ */
+static void scmi_clock_record_latency(uint32_t clock_id, fwk_timestamp_t start,
+                                      bool relock)
+{
+    struct scmi_clock_latency_window *w =
+        &scmi_clock_ctx.latency_stats[clock_id].kind[
+            relock ? SCMI_CLOCK_LATENCY_RELOCK : SCMI_CLOCK_LATENCY_DIRECT];
+    uint64_t elapsed_us = (fwk_time_current() - start) / FWK_US(1);
+    uint32_t sample = (uint32_t)FWK_MIN(elapsed_us, (uint64_t)UINT32_MAX);
+
+    if (w->samples++ == 0)
+        w->avg_us = sample;
+    else
+        w->avg_us = (uint32_t)((int64_t)w->avg_us +
+                               (((int64_t)sample - w->avg_us) >>
+                                SCMI_CLOCK_LATENCY_EWMA_SHIFT));
+
+    w->window_max_us = FWK_MAX(w->window_max_us, sample);
+    if (++w->window_count == SCMI_CLOCK_LATENCY_WINDOW) {
+        w->max_us = w->window_max_us;
+        w->window_max_us = 0;
+        w->window_count = 0;
+    } else if (w->samples <= SCMI_CLOCK_LATENCY_WINDOW) {
+        /* 第一個視窗尚未填滿 */
+        w->max_us = w->window_max_us;
+    }
+}
+
+static void scmi_clock_script_step_done(unsigned int agent_id,
+                                        int32_t status);
+
+/*
+ * 代理能否對此時鐘執行 message_id (mod_resource_perms)
+ * 每個帶 clock ID 的 handler 都要檢查，不論訊息從哪條路徑進來
+ */
+static int32_t scmi_clock_permission_check(unsigned int agent_id,
+                                           unsigned int message_id,
+                                           uint32_t clock_id)
+{
+#ifdef BUILD_HAS_MOD_RESOURCE_PERMS
+    if (scmi_clock_ctx.res_perms_api->agent_has_resource_permission(agent_id,
+            MOD_SCMI_PROTOCOL_ID_CLOCK, message_id, clock_id) !=
+        MOD_RES_PERMS_ACCESS_ALLOWED)
+        return SCMI_DENIED;
+#endif
+
+    return SCMI_SUCCESS;
+}
+
 /*
  * 處理 SCMI Clock Rate Set 命令
  * 這是核心函數，處理來自 Linux kernel 的時鐘頻率設定請求
+ * 參數已由呼叫端解碼 (shmem payload、SMC 暫存器或腳本步驟)。
+ *
+ * 這裡只檢查參數並排入本模組的 RATE_SET 事件，回傳 SCMI_SUCCESS 表示
+ * 已接受；結果由 scmi_clock_rate_set_complete() 依來源回報。
+ * set_rate 必須在本模組的事件中呼叫：mod_clock 把非同步請求的完成
+ * 事件送回發出請求時正在處理事件的實體
  */
-static int scmi_clock_rate_set_handler(fwk_id_t service_id, 
-                                      const uint32_t *payload)
+static int32_t scmi_clock_rate_set_handler(enum scmi_clock_rate_origin origin,
+                                          fwk_id_t service_id,
+                                          unsigned int agent_id,
+                                          uint32_t clock_id,
+                                          uint64_t rate)
 {
+    struct scmi_clock_rate_op *op;
+    struct fwk_event event = {
+        .source_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+        .target_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+        .id = scmi_clock_event_rate_set,
+    };
     int status;
-    const struct scmi_clock_rate_set_a2p *parameters;
-    struct scmi_clock_rate_set_p2a return_values;
-    uint64_t rate;
-    uint32_t clock_id;
-    fwk_id_t clock_element_id;
-    
-    parameters = (const struct scmi_clock_rate_set_a2p *)payload;
-    
-    /* 解析參數 */
-    clock_id = parameters->clock_id;
-    rate = ((uint64_t)parameters->rate_high << 32) | parameters->rate_low;
     
     fwk_log_info("[SCMI Clock] Rate set request: Clock ID %u, Rate %llu Hz", 
                  clock_id, rate);
@@ -85,233 +781,1690 @@ static int scmi_clock_rate_set_handler(fwk_id_t service_id,
     /* 驗證時鐘 ID */
     if (clock_id >= scmi_clock_ctx.clock_count) {
         fwk_log_error("[SCMI Clock] Invalid clock ID: %u", clock_id);
-        return_values.status = SCMI_INVALID_PARAMETERS;
-        goto exit;
+        return SCMI_INVALID_PARAMETERS;
     }
     
-    /* 取得對應的時鐘元素 ID */
-    clock_element_id = scmi_clock_ctx.clock_devices[clock_id].element_id;
-    
     /* 檢查時鐘是否存在 */
-    if (fwk_id_is_equal(clock_element_id, FWK_ID_NONE)) {
+    if (fwk_id_is_equal(scmi_clock_ctx.clock_devices[clock_id].element_id,
+                        FWK_ID_NONE)) {
         fwk_log_error("[SCMI Clock] Clock ID %u not configured", clock_id);
-        return_values.status = SCMI_NOT_FOUND;
-        goto exit;
+        return SCMI_NOT_FOUND;
     }
     
-    /* 
-     * 呼叫 Clock 模組 API 設定實際硬體頻率
-     * 這裡會與底層硬體抽象層互動
+    if (scmi_clock_permission_check(agent_id, SCMI_CLOCK_RATE_SET,
+                                    clock_id) != SCMI_SUCCESS)
+        return SCMI_DENIED;
+    
+    /*
+     * CPU 時鐘由 SCMI PERF 管理 (OPP 與電壓一起切換)，
+     * CLOCK 協議只能讀取，否則會繞過 DVFS 的電壓順序與 PERF 的 level 記錄
      */
-    status = scmi_clock_ctx.clock_api->set_rate(clock_element_id, 
-                                               rate, 
-                                               MOD_CLOCK_ROUND_MODE_NEAREST);
+    if (scmi_clock_ctx.clock_devices[clock_id].perf_owned)
+        return SCMI_DENIED;
     
-    if (status != FWK_SUCCESS) {
-        fwk_log_error("[SCMI Clock] Failed to set rate for clock %u: %d", 
-                      clock_id, status);
-        
-        /* 轉換錯誤碼 */
-        switch (status) {
-        case FWK_E_RANGE:
-            return_values.status = SCMI_OUT_OF_RANGE;
-            break;
-        case FWK_E_BUSY:
-            return_values.status = SCMI_BUSY;
-            break;
-        case FWK_E_SUPPORT:
-            return_values.status = SCMI_NOT_SUPPORTED;
-            break;
-        default:
-            return_values.status = SCMI_GENERIC_ERROR;
-            break;
-        }
-        goto exit;
-    }
+    /* 同一個時鐘同時只有一個 RATE_SET */
+    op = &scmi_clock_ctx.rate_ops[clock_id];
+    if (op->origin != SCMI_CLOCK_RATE_ORIGIN_NONE)
+        return SCMI_BUSY;
     
-    /* 成功設定 */
-    return_values.status = SCMI_SUCCESS;
-    fwk_log_info("[SCMI Clock] Clock %u rate set to %llu Hz successfully", 
-                 clock_id, rate);
-
-exit:
-    /* 傳送回應給 AP */
-    scmi_clock_ctx.scmi_api->respond(service_id, &return_values, 
-                                    sizeof(return_values));
+    *(uint32_t *)event.params = clock_id;
+    status = fwk_put_event(&event);
+    if (status != FWK_SUCCESS)
+        return SCMI_GENERIC_ERROR;
     
-    return FWK_SUCCESS;
+    *op = (struct scmi_clock_rate_op) {
+        .origin = origin,
+        .service_id = service_id,
+        .agent_id = agent_id,
+        .rate = rate,
+    };
+    
+    return SCMI_SUCCESS;
 }
 
 /*
- * 處理 SCMI Clock Rate Get 命令
+ * RATE_SET 完成 (同步完成或 mod_clock 的完成事件)：
+ * 更新統計與通知，再依來源回報結果
  */
-static int scmi_clock_rate_get_handler(fwk_id_t service_id, 
-                                      const uint32_t *payload)
+static void scmi_clock_rate_set_complete(uint32_t clock_id, int status)
 {
-    int status;
-    uint32_t clock_id;
-    uint64_t rate;
-    fwk_id_t clock_element_id;
+    struct scmi_clock_rate_op op = scmi_clock_ctx.rate_ops[clock_id];
+    fwk_id_t clock_element_id = scmi_clock_ctx.clock_devices[clock_id].element_id;
+    struct scmi_clock_rate_set_complete_p2a delayed;
+    struct scmi_clock_rate_notification_p2a changed;
+    struct scmi_clock_rate_set_p2a return_values;
+    unsigned int notify_agent_id;
+    uint64_t rate_applied;
+    int32_t scmi_status;
     
-    struct {
-        int32_t status;
-        uint32_t rate_low;
-        uint32_t rate_high;
-    } return_values;
+    /* 先釋放，腳本繼續執行時可能再對同一個時鐘送 RATE_SET */
+    scmi_clock_ctx.rate_ops[clock_id].origin = SCMI_CLOCK_RATE_ORIGIN_NONE;
+    scmi_clock_ctx.rate_ops[clock_id].pending = false;
     
-    clock_id = *(const uint32_t *)payload;
+    /* 轉換錯誤碼 */
+    switch (status) {
+    case FWK_SUCCESS:
+        scmi_status = SCMI_SUCCESS;
+        break;
+    case FWK_E_RANGE:
+        scmi_status = SCMI_OUT_OF_RANGE;
+        break;
+    case FWK_E_BUSY:
+        scmi_status = SCMI_BUSY;
+        break;
+    case FWK_E_SUPPORT:
+        scmi_status = SCMI_NOT_SUPPORTED;
+        break;
+    default:
+        scmi_status = SCMI_GENERIC_ERROR;
+        break;
+    }
+    
+    /* 回報實際套用的頻率 (可能因 ROUND_MODE_NEAREST 或上限而與請求不同) */
+    if (scmi_clock_ctx.clock_api->get_rate(clock_element_id,
+                                           &rate_applied) != FWK_SUCCESS)
+        rate_applied = op.rate;
+    
+    /*
+     * 同步 shmem 與腳本請求的代理從回應得知結果，暫存器路徑的代理在下面
+     * 單獨通知，廣播都不送給它；非同步請求的代理有訂閱時照常收到
+     * (agent 0 表示不排除任何代理)
+     */
+    notify_agent_id = (op.origin == SCMI_CLOCK_RATE_ORIGIN_SHMEM ||
+                       op.origin == SCMI_CLOCK_RATE_ORIGIN_SCRIPT ||
+                       op.origin == SCMI_CLOCK_RATE_ORIGIN_REG) ?
+                      op.agent_id : 0;
+    
+    if (scmi_status == SCMI_SUCCESS) {
+        scmi_clock_ctx.state_generation++;
+        scmi_clock_record_latency(clock_id, op.start, op.pending);
+        fwk_log_info("[SCMI Clock] Clock %u rate set to %llu Hz successfully", 
+                     clock_id, rate_applied);
+        scmi_clock_send_rate_notification(SCMI_CLOCK_RATE_CHANGED,
+                                          notify_agent_id, clock_id,
+                                          rate_applied);
+    } else {
+        fwk_log_error("[SCMI Clock] Failed to set rate for clock %u: %d", 
+                      clock_id, status);
+    }
+    
+    switch (op.origin) {
+    case SCMI_CLOCK_RATE_ORIGIN_SHMEM:
+        return_values.status = scmi_status;
+        scmi_clock_ctx.scmi_api->respond(op.service_id, &return_values,
+                                        sizeof(return_values));
+        break;
+        
+    case SCMI_CLOCK_RATE_ORIGIN_SHMEM_ASYNC:
+        /* 以 P2A 通道送出 CLOCK_RATE_SET_COMPLETE */
+        delayed = (struct scmi_clock_rate_set_complete_p2a) {
+            .status = scmi_status,
+            .clock_id = clock_id,
+            .rate_low = (uint32_t)(rate_applied & 0xFFFFFFFF),
+            .rate_high = (uint32_t)(rate_applied >> 32),
+        };
+        scmi_clock_ctx.scmi_api->notify(op.service_id,
+                                       MOD_SCMI_PROTOCOL_ID_CLOCK,
+                                       SCMI_CLOCK_RATE_SET,
+                                       &delayed, sizeof(delayed));
+        break;
+        
+    case SCMI_CLOCK_RATE_ORIGIN_SCRIPT:
+        scmi_clock_script_step_done(op.agent_id, scmi_status);
+        break;
+        
+    case SCMI_CLOCK_RATE_ORIGIN_REG:
+        /*
+         * SMC 早已返回，這是提出請求的代理唯一的結果來源：不論是否訂閱、
+         * 成功與否都經它的 P2A 通道送出目前頻率 (失敗時即為原頻率)
+         */
+        changed = (struct scmi_clock_rate_notification_p2a) {
+            .agent_id = op.agent_id,
+            .clock_id = clock_id,
+            .rate_low = (uint32_t)(rate_applied & 0xFFFFFFFF),
+            .rate_high = (uint32_t)(rate_applied >> 32),
+        };
+        scmi_clock_ctx.scmi_api->notify(op.service_id,
+                                       MOD_SCMI_PROTOCOL_ID_CLOCK,
+                                       SCMI_CLOCK_RATE_CHANGED,
+                                       &changed, sizeof(changed));
+        break;
+        
+    default:
+        break;
+    }
+}
+
+/*
+ * RATE_SET 事件：呼叫 Clock 模組 API 設定實際硬體頻率
+ * 有 SCP 本地上限的時鐘改由 clock_cap 記住要求並套用 min(要求, 上限)；
+ * driver 回 FWK_PENDING 時等 mod_clock 的完成事件
+ */
+static void scmi_clock_rate_set_execute(uint32_t clock_id)
+{
+    struct scmi_clock_rate_op *op = &scmi_clock_ctx.rate_ops[clock_id];
+    const struct mod_scmi_clock_device *device =
+        &scmi_clock_ctx.clock_devices[clock_id];
+    int status;
+    
+    if (op->origin == SCMI_CLOCK_RATE_ORIGIN_NONE)
+        return;
+    
+    /* 通知其他訂閱者：有代理要求變更此時鐘 */
+    scmi_clock_send_rate_notification(SCMI_CLOCK_RATE_CHANGE_REQUESTED,
+                                      op->agent_id, clock_id, op->rate);
+    
+    op->start = fwk_time_current();
+    if (fwk_optional_id_is_defined(device->cap_domain_id))
+        status = scmi_clock_ctx.cap_api->set_rate(device->cap_domain_id,
+                                                 op->rate,
+                                                 MOD_CLOCK_ROUND_MODE_NEAREST);
+    else
+        status = scmi_clock_ctx.clock_api->set_rate(device->element_id,
+                                                   op->rate,
+                                                   MOD_CLOCK_ROUND_MODE_NEAREST);
+    
+    if (status == FWK_PENDING) {
+        op->pending = true;
+        return;
+    }
+    
+    scmi_clock_rate_set_complete(clock_id, status);
+}
+
+/*
+ * 處理 SCMI Clock Rate Get 命令
+ */
+static int32_t scmi_clock_rate_get_handler(unsigned int agent_id,
+                                          uint32_t clock_id, uint64_t *rate)
+{
+    int status;
+    fwk_id_t clock_element_id;
     
     fwk_log_debug("[SCMI Clock] Rate get request: Clock ID %u", clock_id);
     
     /* 驗證時鐘 ID */
-    if (clock_id >= scmi_clock_ctx.clock_count) {
-        return_values.status = SCMI_INVALID_PARAMETERS;
-        goto exit;
-    }
+    if (clock_id >= scmi_clock_ctx.clock_count)
+        return SCMI_INVALID_PARAMETERS;
     
     clock_element_id = scmi_clock_ctx.clock_devices[clock_id].element_id;
     
-    if (fwk_id_is_equal(clock_element_id, FWK_ID_NONE)) {
-        return_values.status = SCMI_NOT_FOUND;
-        goto exit;
-    }
+    if (fwk_id_is_equal(clock_element_id, FWK_ID_NONE))
+        return SCMI_NOT_FOUND;
+    
+    if (scmi_clock_permission_check(agent_id, SCMI_CLOCK_RATE_GET,
+                                    clock_id) != SCMI_SUCCESS)
+        return SCMI_DENIED;
     
     /* 從硬體取得目前頻率 */
-    status = scmi_clock_ctx.clock_api->get_rate(clock_element_id, &rate);
+    status = scmi_clock_ctx.clock_api->get_rate(clock_element_id, rate);
+    if (status != FWK_SUCCESS)
+        return SCMI_HARDWARE_ERROR;
+    
+    fwk_log_debug("[SCMI Clock] Clock %u current rate: %llu Hz", 
+                  clock_id, *rate);
+    
+    return SCMI_SUCCESS;
+}
+
+/*
+ * 處理 SCMI Clock Config Set 命令 (啟用/停用時鐘)
+ */
+static int32_t scmi_clock_config_set_handler(unsigned int agent_id,
+                                            uint32_t clock_id, bool enable)
+{
+    int status;
+    fwk_id_t clock_element_id;
+    
+    fwk_log_info("[SCMI Clock] Config set request: Clock ID %u, Enable %s", 
+                 clock_id, enable ? "true" : "false");
+    
+    /* 驗證時鐘 ID */
+    if (clock_id >= scmi_clock_ctx.clock_count)
+        return SCMI_INVALID_PARAMETERS;
+    
+    clock_element_id = scmi_clock_ctx.clock_devices[clock_id].element_id;
+    
+    if (fwk_id_is_equal(clock_element_id, FWK_ID_NONE))
+        return SCMI_NOT_FOUND;
+    
+    if (scmi_clock_permission_check(agent_id, SCMI_CLOCK_CONFIG_SET,
+                                    clock_id) != SCMI_SUCCESS)
+        return SCMI_DENIED;
+    
+    /* 啟用或停用時鐘 */
+    if (enable) {
+        status = scmi_clock_ctx.clock_api->set_state(clock_element_id, 
+                                                    MOD_CLOCK_STATE_RUNNING);
+    } else {
+        status = scmi_clock_ctx.clock_api->set_state(clock_element_id, 
+                                                    MOD_CLOCK_STATE_STOPPED);
+    }
+    
     if (status != FWK_SUCCESS) {
-        return_values.status = SCMI_HARDWARE_ERROR;
-        goto exit;
+        fwk_log_error("[SCMI Clock] Failed to %s clock %u: %d", 
+                      enable ? "enable" : "disable", clock_id, status);
+        return SCMI_HARDWARE_ERROR;
     }
     
-    /* 準備回應資料 */
-    return_values.status = SCMI_SUCCESS;
-    return_values.rate_low = (uint32_t)(rate & 0xFFFFFFFF);
-    return_values.rate_high = (uint32_t)(rate >> 32);
+    scmi_clock_ctx.state_generation++;
+    fwk_log_info("[SCMI Clock] Clock %u %s successfully", 
+                 clock_id, enable ? "enabled" : "disabled");
     
-    fwk_log_debug("[SCMI Clock] Clock %u current rate: %llu Hz", 
-                  clock_id, rate);
+    return SCMI_SUCCESS;
+}
 
-exit:
+/*
+ * shmem 路徑：解碼 payload 後交給上面的 handler，再回應 AP
+ */
+static int scmi_clock_rate_set_message(fwk_id_t service_id,
+                                      const uint32_t *payload)
+{
+    const struct scmi_clock_rate_set_a2p *parameters;
+    struct scmi_clock_rate_set_p2a return_values;
+    enum scmi_clock_rate_origin origin;
+    unsigned int agent_id;
+    
+    parameters = (const struct scmi_clock_rate_set_a2p *)payload;
+    origin = (parameters->flags & SCMI_CLOCK_RATE_SET_ASYNC) ?
+             SCMI_CLOCK_RATE_ORIGIN_SHMEM_ASYNC : SCMI_CLOCK_RATE_ORIGIN_SHMEM;
+    
+    if (scmi_clock_ctx.scmi_api->get_agent_id(service_id, &agent_id) !=
+        FWK_SUCCESS) {
+        return_values.status = SCMI_GENERIC_ERROR;
+        goto respond;
+    }
+    
+    return_values.status = scmi_clock_rate_set_handler(origin, service_id,
+        agent_id, parameters->clock_id,
+        ((uint64_t)parameters->rate_high << 32) | parameters->rate_low);
+    
+    /* 同步請求在完成時才回應 (scmi_clock_rate_set_complete) */
+    if (return_values.status == SCMI_SUCCESS &&
+        origin == SCMI_CLOCK_RATE_ORIGIN_SHMEM)
+        return FWK_SUCCESS;
+    
+respond:
+    /* 錯誤或非同步請求：立即回應 AP */
     scmi_clock_ctx.scmi_api->respond(service_id, &return_values, 
                                     sizeof(return_values));
     
     return FWK_SUCCESS;
 }
 
-/*
- * 處理 SCMI Clock Config Set 命令 (啟用/停用時鐘)
- */
-static int scmi_clock_config_set_handler(fwk_id_t service_id, 
+static int scmi_clock_rate_get_message(fwk_id_t service_id,
+                                      const uint32_t *payload)
+{
+    unsigned int agent_id;
+    uint64_t rate = 0;
+    
+    struct {
+        int32_t status;
+        uint32_t rate_low;
+        uint32_t rate_high;
+    } return_values;
+    
+    if (scmi_clock_ctx.scmi_api->get_agent_id(service_id, &agent_id) !=
+        FWK_SUCCESS)
+        return_values.status = SCMI_GENERIC_ERROR;
+    else
+        return_values.status = scmi_clock_rate_get_handler(agent_id, *payload,
+                                                           &rate);
+    return_values.rate_low = (uint32_t)(rate & 0xFFFFFFFF);
+    return_values.rate_high = (uint32_t)(rate >> 32);
+    
+    scmi_clock_ctx.scmi_api->respond(service_id, &return_values, 
+                                    (return_values.status == SCMI_SUCCESS) ?
+                                    sizeof(return_values) :
+                                    sizeof(return_values.status));
+    
+    return FWK_SUCCESS;
+}
+
+static int scmi_clock_config_set_message(fwk_id_t service_id,
                                         const uint32_t *payload)
 {
-    int status;
     const struct scmi_clock_config_set_a2p *parameters;
-    uint32_t clock_id;
-    bool enable;
-    fwk_id_t clock_element_id;
+    unsigned int agent_id;
     
     struct {
         int32_t status;
     } return_values;
     
     parameters = (const struct scmi_clock_config_set_a2p *)payload;
-    clock_id = parameters->clock_id;
-    enable = (parameters->attributes & 0x1) != 0;
+    if (scmi_clock_ctx.scmi_api->get_agent_id(service_id, &agent_id) !=
+        FWK_SUCCESS)
+        return_values.status = SCMI_GENERIC_ERROR;
+    else
+        return_values.status = scmi_clock_config_set_handler(agent_id,
+            parameters->clock_id, (parameters->attributes & 0x1) != 0);
     
-    fwk_log_info("[SCMI Clock] Config set request: Clock ID %u, Enable %s", 
-                 clock_id, enable ? "true" : "false");
+    scmi_clock_ctx.scmi_api->respond(service_id, &return_values, 
+                                    sizeof(return_values));
     
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 NEGOTIATE_PROTOCOL_VERSION 命令 (SCMI v3.2)
+ * 代理要求以較舊的版本溝通時，之後的回應依該版本的格式
+ */
+static int scmi_clock_negotiate_version_handler(fwk_id_t service_id,
+                                                const uint32_t *payload)
+{
+    const struct scmi_clock_negotiate_version_a2p *parameters;
+    unsigned int agent_id;
+    int status;
+
+    struct {
+        int32_t status;
+    } return_values;
+
+    parameters = (const struct scmi_clock_negotiate_version_a2p *)payload;
+
+    status = scmi_clock_ctx.scmi_api->get_agent_id(service_id, &agent_id);
+    if (status != FWK_SUCCESS || agent_id >= scmi_clock_ctx.agent_count) {
+        return_values.status = SCMI_GENERIC_ERROR;
+        goto exit;
+    }
+
+    if (parameters->version < SCMI_CLOCK_PROTOCOL_VERSION_MIN ||
+        parameters->version > SCMI_CLOCK_PROTOCOL_VERSION) {
+        return_values.status = SCMI_NOT_SUPPORTED;
+        goto exit;
+    }
+
+    scmi_clock_ctx.agent_versions[agent_id] = parameters->version;
+    return_values.status = SCMI_SUCCESS;
+
+exit:
+    scmi_clock_ctx.scmi_api->respond(service_id, &return_values,
+                                    sizeof(return_values));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 時鐘是否真的會送出 RATE_CHANGED / RATE_CHANGE_REQUESTED 通知
+ * 兩者都來自 CLOCK RATE_SET 與 clock_cap 的上限變更；PERF 擁有的時鐘
+ * 不接受 CLOCK RATE_SET，頻率變更由 PERF 自己的通知回報
+ * (scmi_clock_notify_rate_changed())，不宣告也不接受訂閱
+ */
+static bool scmi_clock_has_rate_notifications(uint32_t clock_id)
+{
+    const struct mod_scmi_clock_device *device =
+        &scmi_clock_ctx.clock_devices[clock_id];
+
+    return !fwk_id_is_equal(device->element_id, FWK_ID_NONE) &&
+           !device->perf_owned;
+}
+
+/*
+ * 處理 SCMI Clock Attributes 命令
+ * 回應長度依代理協商的版本：v1.0 到 clock_name 為止；v2.0 起加上
+ * clock_enable_latency，並在其後附帶開機時已套用的初始頻率
+ */
+static int scmi_clock_attributes_handler(fwk_id_t service_id,
+                                        const uint32_t *payload)
+{
+    int status;
+    uint32_t clock_id;
+    unsigned int agent_id;
+    fwk_id_t clock_element_id;
+    enum mod_clock_state state;
+    const struct scmi_clock_boot_rate *boot_rate;
+    struct scmi_clock_attributes_p2a return_values = { 0 };
+    size_t size = sizeof(return_values);
+
+    clock_id = *(const uint32_t *)payload;
+
+    status = scmi_clock_ctx.scmi_api->get_agent_id(service_id, &agent_id);
+    if (status != FWK_SUCCESS || agent_id >= scmi_clock_ctx.agent_count) {
+        return_values.status = SCMI_GENERIC_ERROR;
+        goto exit;
+    }
+
     /* 驗證時鐘 ID */
     if (clock_id >= scmi_clock_ctx.clock_count) {
         return_values.status = SCMI_INVALID_PARAMETERS;
         goto exit;
     }
-    
+
     clock_element_id = scmi_clock_ctx.clock_devices[clock_id].element_id;
-    
+
     if (fwk_id_is_equal(clock_element_id, FWK_ID_NONE)) {
         return_values.status = SCMI_NOT_FOUND;
         goto exit;
     }
-    
-    /* 啟用或停用時鐘 */
-    if (enable) {
-        status = scmi_clock_ctx.clock_api->set_state(clock_element_id, 
-                                                    MOD_CLOCK_STATE_RUNNING);
-    } else {
-        status = scmi_clock_ctx.clock_api->set_state(clock_element_id, 
-                                                    MOD_CLOCK_STATE_STOPPED);
-    }
-    
+
+    status = scmi_clock_ctx.clock_api->get_state(clock_element_id, &state);
     if (status != FWK_SUCCESS) {
-        fwk_log_error("[SCMI Clock] Failed to %s clock %u: %d", 
-                      enable ? "enable" : "disable", clock_id, status);
         return_values.status = SCMI_HARDWARE_ERROR;
         goto exit;
     }
-    
-    return_values.status = SCMI_SUCCESS;
-    fwk_log_info("[SCMI Clock] Clock %u %s successfully", 
-                 clock_id, enable ? "enabled" : "disabled");
 
-exit:
-    scmi_clock_ctx.scmi_api->respond(service_id, &return_values, 
-                                    sizeof(return_values));
-    
-    return FWK_SUCCESS;
+    if (state == MOD_CLOCK_STATE_RUNNING)
+        return_values.attributes |= SCMI_CLOCK_ATTRIBUTES_ENABLED;
+
+    if (scmi_clock_has_rate_notifications(clock_id))
+        return_values.attributes |= SCMI_CLOCK_ATTRIBUTES_RATE_CHANGED_NOTIFY |
+                                    SCMI_CLOCK_ATTRIBUTES_RATE_REQ_NOTIFY;
+
+    if (scmi_clock_ctx.clock_devices[clock_id].transition_cost != NULL)
+        return_values.attributes |= SCMI_CLOCK_ATTRIBUTES_TRANSITION_COST;
+
+    fwk_str_strncpy(return_values.clock_name,
+                    fwk_module_get_element_name(clock_element_id),
+                    sizeof(return_values.clock_name) - 1);
+
+    return_values.status = SCMI_SUCCESS;
+
+    if (scmi_clock_ctx.agent_versions[agent_id] <
+        SCMI_CLOCK_PROTOCOL_VERSION_ENABLE_LATENCY) {
+        size = offsetof(struct scmi_clock_attributes_p2a,
+                        clock_enable_latency);
+        goto exit;
+    }
+
+    /* 只有在 PLL 已 lock 完成時才回報初始頻率 */
+    boot_rate = &scmi_clock_ctx.boot_rates[clock_id];
+    if (boot_rate->rate != 0 && !boot_rate->pending && !boot_rate->deferred) {
+        return_values.attributes |= SCMI_CLOCK_ATTRIBUTES_INITIAL_RATE_VALID;
+        return_values.initial_rate_low = (uint32_t)(boot_rate->rate & 0xFFFFFFFF);
+        return_values.initial_rate_high = (uint32_t)(boot_rate->rate >> 32);
+    }
+
+exit:
+    scmi_clock_ctx.scmi_api->respond(service_id, &return_values,
+                                    (return_values.status == SCMI_SUCCESS) ?
+                                    size : sizeof(return_values.status));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 RATE_NOTIFY / RATE_CHANGE_REQUESTED_NOTIFY 命令
+ * 為呼叫的代理訂閱或取消訂閱單一時鐘的頻率通知
+ */
+static int scmi_clock_rate_notify_handler(fwk_id_t service_id,
+                                         const uint32_t *payload,
+                                         unsigned int message_id)
+{
+    const struct scmi_clock_notify_a2p *parameters;
+    uint32_t *subscribers;
+    unsigned int agent_id;
+    int status;
+
+    struct {
+        int32_t status;
+    } return_values;
+
+    parameters = (const struct scmi_clock_notify_a2p *)payload;
+
+    if (parameters->clock_id >= scmi_clock_ctx.clock_count ||
+        (parameters->notify_enable & ~0x1U) != 0) {
+        return_values.status = SCMI_INVALID_PARAMETERS;
+        goto exit;
+    }
+
+    /* ATTRIBUTES 沒有宣告通知的時鐘不接受訂閱 */
+    if (parameters->notify_enable &&
+        !scmi_clock_has_rate_notifications(parameters->clock_id)) {
+        return_values.status = SCMI_NOT_SUPPORTED;
+        goto exit;
+    }
+
+    status = scmi_clock_ctx.scmi_api->get_agent_id(service_id, &agent_id);
+    if (status != FWK_SUCCESS || agent_id >= scmi_clock_ctx.agent_count) {
+        return_values.status = SCMI_GENERIC_ERROR;
+        goto exit;
+    }
+
+    subscribers = (message_id == SCMI_CLOCK_RATE_NOTIFY) ?
+        &scmi_clock_ctx.rate_changed_subscribers[parameters->clock_id] :
+        &scmi_clock_ctx.rate_requested_subscribers[parameters->clock_id];
+
+    if (parameters->notify_enable) {
+        *subscribers |= 1U << agent_id;
+        scmi_clock_ctx.agent_service_ids[agent_id] = service_id;
+    } else {
+        *subscribers &= ~(1U << agent_id);
+    }
+
+    return_values.status = SCMI_SUCCESS;
+
+exit:
+    scmi_clock_ctx.scmi_api->respond(service_id, &return_values,
+                                    sizeof(return_values));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 STATE_SNAPSHOT 廠商命令
+ * SCP 事件處理是 run-to-completion，同一則回應內的所有項目必定一致
+ */
+static int scmi_clock_state_snapshot_handler(fwk_id_t service_id,
+                                            const uint32_t *payload)
+{
+    static struct scmi_clock_snapshot_p2a return_values;
+    const struct scmi_clock_snapshot_a2p *parameters;
+    struct scmi_clock_snapshot_entry *entry;
+    enum mod_clock_state state;
+    fwk_id_t clock_element_id;
+    uint32_t clock_id, last, count = 0;
+    size_t max_payload_size;
+    unsigned int max_entries;
+    uint64_t rate;
+    int status;
+
+    parameters = (const struct scmi_clock_snapshot_a2p *)payload;
+
+    if (parameters->first_clock_id >= scmi_clock_ctx.clock_count ||
+        parameters->clock_count == 0) {
+        return_values.status = SCMI_INVALID_PARAMETERS;
+        goto exit;
+    }
+
+    /*
+     * 依通道的 payload 大小決定一頁可放幾筆：扣掉 12 bytes 的表頭後
+     * 每筆 16 bytes，128-byte 的 payload 一頁 7 筆，16 顆時鐘要 3 頁。
+     * 放不下表頭加一筆的通道無法使用這個命令
+     */
+    status = scmi_clock_ctx.scmi_api->get_max_payload_size(service_id,
+                                                           &max_payload_size);
+    if (status != FWK_SUCCESS) {
+        return_values.status = SCMI_GENERIC_ERROR;
+        goto exit;
+    }
+
+    if (max_payload_size < offsetof(struct scmi_clock_snapshot_p2a, entries) +
+                           sizeof(struct scmi_clock_snapshot_entry)) {
+        return_values.status = SCMI_NOT_SUPPORTED;
+        goto exit;
+    }
+
+    max_entries = (max_payload_size -
+                   offsetof(struct scmi_clock_snapshot_p2a, entries)) /
+                  sizeof(struct scmi_clock_snapshot_entry);
+    if (max_entries > SCMI_CLOCK_SNAPSHOT_MAX_ENTRIES)
+        max_entries = SCMI_CLOCK_SNAPSHOT_MAX_ENTRIES;
+
+    last = parameters->first_clock_id + parameters->clock_count;
+    if (last > scmi_clock_ctx.clock_count ||
+        last < parameters->first_clock_id)
+        last = scmi_clock_ctx.clock_count;
+
+    for (clock_id = parameters->first_clock_id;
+         clock_id < last && count < max_entries; clock_id++) {
+        entry = &return_values.entries[count];
+        entry->clock_id = clock_id;
+        entry->flags = 0;
+        entry->rate_low = 0;
+        entry->rate_high = 0;
+
+        clock_element_id = scmi_clock_ctx.clock_devices[clock_id].element_id;
+        if (!fwk_id_is_equal(clock_element_id, FWK_ID_NONE)) {
+            if (scmi_clock_ctx.clock_api->get_state(clock_element_id,
+                                                    &state) == FWK_SUCCESS &&
+                state == MOD_CLOCK_STATE_RUNNING)
+                entry->flags |= SCMI_CLOCK_SNAPSHOT_ENABLED;
+
+            if (scmi_clock_ctx.clock_api->get_rate(clock_element_id,
+                                                   &rate) == FWK_SUCCESS) {
+                entry->rate_low = (uint32_t)(rate & 0xFFFFFFFF);
+                entry->rate_high = (uint32_t)(rate >> 32);
+            }
+        }
+
+        count++;
+    }
+
+    return_values.status = SCMI_SUCCESS;
+    return_values.generation = scmi_clock_ctx.state_generation;
+    return_values.num_entries = count | ((last - clock_id) << 16);
+
+exit:
+    scmi_clock_ctx.scmi_api->respond(service_id, &return_values,
+        (return_values.status == SCMI_SUCCESS) ?
+        offsetof(struct scmi_clock_snapshot_p2a, entries) +
+            count * sizeof(struct scmi_clock_snapshot_entry) :
+        sizeof(return_values.status));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 TRANSITION_COST 廠商命令
+ */
+static int scmi_clock_transition_cost_handler(fwk_id_t service_id,
+                                             const uint32_t *payload)
+{
+    const struct mod_scmi_clock_transition_cost *cost;
+    const struct scmi_clock_latency_window *w;
+    struct scmi_clock_transition_cost_p2a return_values = { 0 };
+    uint32_t clock_id = *payload;
+
+    if (clock_id >= scmi_clock_ctx.clock_count) {
+        return_values.status = SCMI_INVALID_PARAMETERS;
+        goto exit;
+    }
+
+    cost = scmi_clock_ctx.clock_devices[clock_id].transition_cost;
+    if (cost == NULL) {
+        return_values.status = SCMI_NOT_SUPPORTED;
+        goto exit;
+    }
+
+    return_values.relock_latency_us = cost->relock_latency_us;
+    return_values.relock_energy_nj = cost->relock_energy_nj;
+    return_values.div_latency_us = cost->div_latency_us;
+    return_values.div_energy_nj = cost->div_energy_nj;
+
+    if (cost->swap_latency_us != 0) {
+        return_values.flags |= SCMI_CLOCK_COST_SWAP_VALID;
+        return_values.swap_latency_us = cost->swap_latency_us;
+        return_values.swap_energy_nj = cost->swap_energy_nj;
+    }
+
+    w = &scmi_clock_ctx.latency_stats[clock_id].kind[SCMI_CLOCK_LATENCY_RELOCK];
+    if (w->samples != 0) {
+        return_values.flags |= SCMI_CLOCK_COST_MEASURED_VALID;
+        return_values.measured_latency_us = w->max_us;
+        return_values.measured_avg_us = w->avg_us;
+    }
+
+    w = &scmi_clock_ctx.latency_stats[clock_id].kind[SCMI_CLOCK_LATENCY_DIRECT];
+    if (w->samples != 0) {
+        return_values.flags |= SCMI_CLOCK_COST_MEASURED_DIV_VALID;
+        return_values.measured_div_latency_us = w->max_us;
+    }
+
+    return_values.status = SCMI_SUCCESS;
+
+exit:
+    scmi_clock_ctx.scmi_api->respond(service_id, &return_values,
+                                    (return_values.status == SCMI_SUCCESS) ?
+                                    sizeof(return_values) :
+                                    sizeof(return_values.status));
+
+    return FWK_SUCCESS;
+}
+
+/* 將 framework 錯誤碼轉成 SCMI 狀態 */
+static int32_t scmi_clock_to_scmi_status(int status)
+{
+    switch (status) {
+    case FWK_E_RANGE:
+    case FWK_E_PARAM:
+        return SCMI_OUT_OF_RANGE;
+    case FWK_E_SUPPORT:
+        return SCMI_NOT_SUPPORTED;
+    default:
+        return SCMI_GENERIC_ERROR;
+    }
+}
+
+/* 取得時鐘的頻率資訊，回傳 SCMI 狀態 */
+static int32_t scmi_clock_get_info(uint32_t clock_id, fwk_id_t *element_id,
+                                   struct mod_clock_info *info)
+{
+    int status;
+
+    if (clock_id >= scmi_clock_ctx.clock_count)
+        return SCMI_INVALID_PARAMETERS;
+
+    *element_id = scmi_clock_ctx.clock_devices[clock_id].element_id;
+    if (fwk_id_is_equal(*element_id, FWK_ID_NONE))
+        return SCMI_NOT_FOUND;
+
+    status = scmi_clock_ctx.clock_api->get_info(*element_id, info);
+    if (status != FWK_SUCCESS)
+        return scmi_clock_to_scmi_status(status);
+
+    return SCMI_SUCCESS;
+}
+
+/*
+ * 處理 SCMI Clock Describe Rates 命令 (標準格式)
+ * 連續範圍回傳一組 {min, max, step}；離散表每頁最多
+ * SCMI_CLOCK_DESCRIBE_RATES_MAX 個 64 位元頻率
+ */
+static int scmi_clock_describe_rates_handler(fwk_id_t service_id,
+                                            const uint32_t *payload)
+{
+    const struct scmi_clock_describe_rates_a2p *parameters;
+    struct scmi_clock_describe_rates_p2a return_values = { 0 };
+    struct mod_clock_info info;
+    fwk_id_t clock_element_id;
+    uint32_t index, count = 0;
+    uint64_t rate;
+    int status;
+
+    parameters = (const struct scmi_clock_describe_rates_a2p *)payload;
+
+    return_values.status = scmi_clock_get_info(parameters->clock_id,
+                                               &clock_element_id, &info);
+    if (return_values.status != SCMI_SUCCESS)
+        goto exit;
+
+    if (info.range.rate_type == MOD_CLOCK_RATE_TYPE_CONTINUOUS) {
+        return_values.rates[0].low = (uint32_t)info.range.min;
+        return_values.rates[0].high = (uint32_t)(info.range.min >> 32);
+        return_values.rates[1].low = (uint32_t)info.range.max;
+        return_values.rates[1].high = (uint32_t)(info.range.max >> 32);
+        return_values.rates[2].low = (uint32_t)info.range.step;
+        return_values.rates[2].high = (uint32_t)(info.range.step >> 32);
+        count = 3;
+        return_values.num_rates_flags = count | SCMI_CLOCK_RATE_FORMAT_RANGE;
+        goto exit;
+    }
+
+    if (parameters->rate_index >= info.range.rate_count) {
+        return_values.status = SCMI_OUT_OF_RANGE;
+        goto exit;
+    }
+
+    for (index = parameters->rate_index;
+         index < info.range.rate_count && count < SCMI_CLOCK_DESCRIBE_RATES_MAX;
+         index++, count++) {
+        status = scmi_clock_ctx.clock_api->get_rate_from_index(
+            clock_element_id, index, &rate);
+        if (status != FWK_SUCCESS) {
+            return_values.status = scmi_clock_to_scmi_status(status);
+            goto exit;
+        }
+        return_values.rates[count].low = (uint32_t)rate;
+        return_values.rates[count].high = (uint32_t)(rate >> 32);
+    }
+
+    return_values.num_rates_flags = count |
+        ((uint32_t)(info.range.rate_count - index) << 16);
+
+exit:
+    scmi_clock_ctx.scmi_api->respond(service_id, &return_values,
+        (return_values.status == SCMI_SUCCESS) ?
+        offsetof(struct scmi_clock_describe_rates_p2a, rates) +
+            count * sizeof(return_values.rates[0]) :
+        sizeof(return_values.status));
+
+    return FWK_SUCCESS;
+}
+
+/* FNV-1a，逐 32 位元字累加 */
+static uint32_t scmi_clock_hash_u64(uint32_t hash, uint64_t value)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(value); i++) {
+        hash ^= (uint8_t)(value >> (i * 8));
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/*
+ * 計算頻率表摘要：雜湊、是否等差、差值是否放得進 u32
+ * 頻率表在執行期不會改變，每個時鐘只算一次
+ */
+static int32_t scmi_clock_rate_summary_compute(
+    fwk_id_t clock_element_id, uint32_t clock_id,
+    const struct mod_clock_info *info)
+{
+    struct scmi_clock_rate_summary *summary =
+        &scmi_clock_ctx.rate_summaries[clock_id];
+    uint64_t index, rate, prev = 0;
+    uint32_t hash = 2166136261U;
+    int status;
+
+    if (summary->valid)
+        return SCMI_SUCCESS;
+
+    hash = scmi_clock_hash_u64(hash, info->range.rate_type);
+
+    if (info->range.rate_type == MOD_CLOCK_RATE_TYPE_CONTINUOUS) {
+        hash = scmi_clock_hash_u64(hash, info->range.min);
+        hash = scmi_clock_hash_u64(hash, info->range.max);
+        hash = scmi_clock_hash_u64(hash, info->range.step);
+        summary->first = info->range.min;
+        summary->step = info->range.step;
+        summary->arithmetic = true;
+        summary->delta_fits = true;
+        summary->hash = hash;
+        summary->valid = true;
+        return SCMI_SUCCESS;
+    }
+
+    /* 沒有任何頻率的離散表是平台設定錯誤，也無法算出 max */
+    if (info->range.rate_count == 0)
+        return SCMI_GENERIC_ERROR;
+
+    summary->arithmetic = true;
+    summary->delta_fits = true;
+
+    for (index = 0; index < info->range.rate_count; index++) {
+        status = scmi_clock_ctx.clock_api->get_rate_from_index(
+            clock_element_id, index, &rate);
+        if (status != FWK_SUCCESS)
+            return scmi_clock_to_scmi_status(status);
+
+        hash = scmi_clock_hash_u64(hash, rate);
+
+        if (index == 0)
+            summary->first = rate;
+        else if (index == 1)
+            summary->step = rate - prev;
+        else if (index > 1 && rate - prev != summary->step)
+            summary->arithmetic = false;
+
+        if (index > 0 && (rate < prev || rate - prev > UINT32_MAX))
+            summary->delta_fits = false;
+
+        prev = rate;
+    }
+
+    summary->hash = hash;
+    summary->valid = true;
+
+    return SCMI_SUCCESS;
+}
+
+/* 逐一比對兩個離散表的每個頻率 */
+static bool scmi_clock_rate_list_equal(fwk_id_t a_id, fwk_id_t b_id,
+                                       uint64_t rate_count)
+{
+    uint64_t index, a, b;
+
+    for (index = 0; index < rate_count; index++) {
+        if (scmi_clock_ctx.clock_api->get_rate_from_index(a_id, index, &a) !=
+                FWK_SUCCESS ||
+            scmi_clock_ctx.clock_api->get_rate_from_index(b_id, index, &b) !=
+                FWK_SUCCESS ||
+            a != b)
+            return false;
+    }
+
+    return true;
+}
+
+/* 兩個時鐘的頻率表內容是否完全相同；雜湊只用來快速排除 */
+static bool scmi_clock_rate_table_equal(
+    fwk_id_t a_id, const struct mod_clock_info *a,
+    const struct scmi_clock_rate_summary *a_sum,
+    fwk_id_t b_id, const struct mod_clock_info *b,
+    const struct scmi_clock_rate_summary *b_sum)
+{
+    if (a_sum->hash != b_sum->hash ||
+        a->range.rate_type != b->range.rate_type)
+        return false;
+
+    if (a->range.rate_type == MOD_CLOCK_RATE_TYPE_CONTINUOUS)
+        return a->range.min == b->range.min && a->range.max == b->range.max &&
+               a->range.step == b->range.step;
+
+    if (a->range.rate_count != b->range.rate_count ||
+        a_sum->first != b_sum->first ||
+        a_sum->arithmetic != b_sum->arithmetic)
+        return false;
+
+    /* 等差表由 first、step 與數量完全決定 */
+    if (a_sum->arithmetic)
+        return a_sum->step == b_sum->step;
+
+    return scmi_clock_rate_list_equal(a_id, b_id, a->range.rate_count);
+}
+
+/*
+ * 取得時鐘的頻率表摘要，包含 same_as：往前找第一個內容完全相同的時鐘。
+ * 每個時鐘只比對一次，之後的查詢直接使用快取
+ */
+static int32_t scmi_clock_rate_summary_get(
+    fwk_id_t clock_element_id, uint32_t clock_id,
+    const struct mod_clock_info *info,
+    const struct scmi_clock_rate_summary **summary_out)
+{
+    struct scmi_clock_rate_summary *summary =
+        &scmi_clock_ctx.rate_summaries[clock_id];
+    struct mod_clock_info other_info;
+    fwk_id_t other_id;
+    uint32_t other;
+    int32_t status;
+
+    *summary_out = summary;
+
+    status = scmi_clock_rate_summary_compute(clock_element_id, clock_id, info);
+    if (status != SCMI_SUCCESS || summary->same_as_valid)
+        return status;
+
+    summary->same_as = clock_id;
+    for (other = 0; other < clock_id; other++) {
+        if (scmi_clock_get_info(other, &other_id, &other_info) !=
+                SCMI_SUCCESS ||
+            scmi_clock_rate_summary_compute(other_id, other, &other_info) !=
+                SCMI_SUCCESS)
+            continue;
+
+        if (scmi_clock_rate_table_equal(clock_element_id, info, summary,
+                other_id, &other_info,
+                &scmi_clock_ctx.rate_summaries[other])) {
+            summary->same_as = other;
+            break;
+        }
+    }
+    summary->same_as_valid = true;
+
+    return SCMI_SUCCESS;
+}
+
+/*
+ * 處理 DESCRIBE_RATES_COMPACT 廠商命令
+ * 連續範圍與等差離散表一次回傳三元組；其他離散表以 u32 差值分頁回傳，
+ * 一頁可放 1 + SCMI_CLOCK_COMPACT_MAX_VALUES 個頻率 (標準格式為 8 個)
+ */
+static int scmi_clock_describe_rates_compact_handler(fwk_id_t service_id,
+                                                    const uint32_t *payload)
+{
+    const struct scmi_clock_describe_rates_a2p *parameters;
+    struct scmi_clock_describe_rates_compact_p2a return_values = { 0 };
+    const struct scmi_clock_rate_summary *summary;
+    struct mod_clock_info info;
+    fwk_id_t clock_element_id;
+    uint64_t index, last, rate, prev, max;
+    uint32_t count = 0;
+    int status;
+
+    parameters = (const struct scmi_clock_describe_rates_a2p *)payload;
+
+    return_values.status = scmi_clock_get_info(parameters->clock_id,
+                                               &clock_element_id, &info);
+    if (return_values.status != SCMI_SUCCESS)
+        goto exit;
+
+    return_values.status = scmi_clock_rate_summary_get(
+        clock_element_id, parameters->clock_id, &info, &summary);
+    if (return_values.status != SCMI_SUCCESS)
+        goto exit;
+
+    return_values.same_as = summary->same_as;
+
+    if (info.range.rate_type == MOD_CLOCK_RATE_TYPE_CONTINUOUS ||
+        summary->arithmetic) {
+        if (info.range.rate_type == MOD_CLOCK_RATE_TYPE_CONTINUOUS) {
+            max = info.range.max;
+        } else {
+            return_values.total_rates = (uint32_t)info.range.rate_count;
+            return_values.flags |= SCMI_CLOCK_COMPACT_DISCRETE;
+            max = summary->first +
+                  summary->step * (info.range.rate_count - 1);
+        }
+
+        return_values.base_low = (uint32_t)summary->first;
+        return_values.base_high = (uint32_t)(summary->first >> 32);
+        return_values.values[0] = (uint32_t)max;
+        return_values.values[1] = (uint32_t)(max >> 32);
+        return_values.values[2] = (uint32_t)summary->step;
+        return_values.values[3] = (uint32_t)(summary->step >> 32);
+        count = 4;
+        return_values.flags |= count | SCMI_CLOCK_COMPACT_FORMAT_TRIPLET;
+        goto exit;
+    }
+
+    /* 差值放不進 u32 的表請代理改用標準 DESCRIBE_RATES */
+    if (!summary->delta_fits) {
+        return_values.status = SCMI_NOT_SUPPORTED;
+        goto exit;
+    }
+
+    if (parameters->rate_index >= info.range.rate_count) {
+        return_values.status = SCMI_OUT_OF_RANGE;
+        goto exit;
+    }
+
+    status = scmi_clock_ctx.clock_api->get_rate_from_index(
+        clock_element_id, parameters->rate_index, &prev);
+    if (status != FWK_SUCCESS) {
+        return_values.status = scmi_clock_to_scmi_status(status);
+        goto exit;
+    }
+
+    return_values.total_rates = (uint32_t)info.range.rate_count;
+    return_values.base_low = (uint32_t)prev;
+    return_values.base_high = (uint32_t)(prev >> 32);
+
+    last = FWK_MIN(info.range.rate_count,
+                   (uint64_t)parameters->rate_index + 1 +
+                       SCMI_CLOCK_COMPACT_MAX_VALUES);
+    for (index = parameters->rate_index + 1; index < last; index++) {
+        status = scmi_clock_ctx.clock_api->get_rate_from_index(
+            clock_element_id, index, &rate);
+        if (status != FWK_SUCCESS) {
+            return_values.status = scmi_clock_to_scmi_status(status);
+            goto exit;
+        }
+        return_values.values[count++] = (uint32_t)(rate - prev);
+        prev = rate;
+    }
+
+    return_values.flags = count | SCMI_CLOCK_COMPACT_FORMAT_DELTA |
+                          SCMI_CLOCK_COMPACT_DISCRETE |
+                          ((uint32_t)(info.range.rate_count - last) << 16);
+
+exit:
+    scmi_clock_ctx.scmi_api->respond(service_id, &return_values,
+        (return_values.status == SCMI_SUCCESS) ?
+        offsetof(struct scmi_clock_describe_rates_compact_p2a, values) +
+            count * sizeof(uint32_t) :
+        sizeof(return_values.status));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 延遲步驟的 alarm callback 在中斷環境執行，只排入事件
+ * param 為 agent_id
+ */
+static void scmi_clock_script_alarm_callback(uintptr_t param)
+{
+    struct fwk_event event = {
+        .source_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+        .target_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+        .id = scmi_clock_event_script_delay,
+    };
+
+    *(uint32_t *)event.params = (uint32_t)param;
+    fwk_put_event(&event);
+}
+
+/*
+ * 開始腳本的延遲步驟 (BRINGUP_SCRIPT 的 DELAY 步驟)
+ * 回傳 SCMI_SUCCESS 表示 alarm 已啟動，到期時由
+ * scmi_clock_script_step_done() 接續
+ */
+static int32_t scmi_clock_script_delay_start(unsigned int agent_id,
+                                             uint32_t delay_us,
+                                             uint32_t *delay_budget_us)
+{
+    fwk_id_t alarm_id = scmi_clock_ctx.agent_table[agent_id].script_alarm_id;
+    uint32_t delay_ms;
+    int status;
+
+    if (delay_us > SCMI_CLOCK_SCRIPT_MAX_STEP_DELAY_US)
+        return SCMI_INVALID_PARAMETERS;
+
+    /* alarm 以 ms 計：額度依實際等待的時間扣除 */
+    delay_ms = (delay_us + 999) / 1000;
+    if (delay_ms * 1000 > *delay_budget_us)
+        return SCMI_INVALID_PARAMETERS;
+
+    if (!fwk_id_is_type(alarm_id, FWK_ID_TYPE_SUB_ELEMENT))
+        return SCMI_NOT_SUPPORTED;
+
+    status = scmi_clock_ctx.alarm_api->start(alarm_id, delay_ms,
+        MOD_TIMER_ALARM_TYPE_ONCE, scmi_clock_script_alarm_callback,
+        agent_id);
+    if (status != FWK_SUCCESS)
+        return SCMI_GENERIC_ERROR;
+
+    *delay_budget_us -= delay_ms * 1000;
+
+    return SCMI_SUCCESS;
+}
+
+/*
+ * 腳本的 reset 步驟
+ * 只支援同步完成的 reset domain driver；FWK_PENDING 時後續步驟
+ * 無法確定 reset 已生效，視為失敗 (非同步的 reset 應使用標準 RESET 訊息)
+ */
+static int32_t scmi_clock_script_reset(unsigned int agent_id,
+                                       uint32_t domain_id, bool assert,
+                                       uint32_t reset_state)
+{
+    int status;
+
+    if (scmi_clock_ctx.reset_api == NULL)
+        return SCMI_NOT_SUPPORTED;
+
+    if (domain_id >= scmi_clock_ctx.reset_domain_count)
+        return SCMI_NOT_FOUND;
+
+#ifdef BUILD_HAS_MOD_RESOURCE_PERMS
+    /* 與代理直接送 RESET 訊息時 mod_scmi 與 scmi_reset_domain 的檢查相同 */
+    if (scmi_clock_ctx.res_perms_api->agent_has_protocol_permission(agent_id,
+            MOD_SCMI_PROTOCOL_ID_RESET_DOMAIN) !=
+            MOD_RES_PERMS_ACCESS_ALLOWED ||
+        scmi_clock_ctx.res_perms_api->agent_has_resource_permission(agent_id,
+            MOD_SCMI_PROTOCOL_ID_RESET_DOMAIN, MOD_SCMI_RESET_REQUEST,
+            domain_id) != MOD_RES_PERMS_ACCESS_ALLOWED)
+        return SCMI_DENIED;
+#endif
+
+    status = scmi_clock_ctx.reset_api->set_reset_state(
+        scmi_clock_ctx.reset_domains[domain_id],
+        assert ? MOD_RESET_DOMAIN_MODE_EXPLICIT_ASSERT :
+                 MOD_RESET_DOMAIN_MODE_EXPLICIT_DEASSERT,
+        reset_state,
+        0);
+    if (status != FWK_SUCCESS) {
+        fwk_log_error("[SCMI Clock] Script reset %s of domain %u failed: %d",
+                      assert ? "assert" : "deassert", domain_id, status);
+        return scmi_clock_to_scmi_status(status);
+    }
+
+    return SCMI_SUCCESS;
+}
+
+/*
+ * 執行腳本的一個同步步驟，時鐘步驟沿用一般命令的 handler
+ * RATE_SET 與延遲要等事件，由 scmi_clock_script_continue() 處理
+ */
+static int32_t scmi_clock_script_step_run(
+    unsigned int agent_id,
+    const struct scmi_clock_script_step *step)
+{
+    uint32_t op = step->op_target & 0xFF;
+    uint32_t target = step->op_target >> 16;
+
+    switch (op) {
+    case SCMI_CLOCK_SCRIPT_OP_CLOCK_ENABLE:
+        return scmi_clock_config_set_handler(agent_id, target, true);
+
+    case SCMI_CLOCK_SCRIPT_OP_CLOCK_DISABLE:
+        return scmi_clock_config_set_handler(agent_id, target, false);
+
+    case SCMI_CLOCK_SCRIPT_OP_RESET_ASSERT:
+        return scmi_clock_script_reset(agent_id, target, true, step->arg);
+
+    case SCMI_CLOCK_SCRIPT_OP_RESET_DEASSERT:
+        return scmi_clock_script_reset(agent_id, target, false, step->arg);
+
+    default:
+        return SCMI_NOT_SUPPORTED;
+    }
+}
+
+/* 腳本結束：只回傳已執行步驟的狀態 */
+static void scmi_clock_script_finish(struct scmi_clock_script_run *run)
+{
+    run->active = false;
+
+    scmi_clock_ctx.scmi_api->respond(run->service_id, &run->resp,
+        offsetof(struct scmi_clock_script_p2a, step_status) +
+            run->resp.steps_executed * sizeof(int32_t));
+}
+
+/* 記錄一步的結果，回傳是否繼續下一步 */
+static bool scmi_clock_script_record(struct scmi_clock_script_run *run,
+                                     int32_t status)
+{
+    unsigned int i = run->resp.steps_executed++;
+
+    run->resp.step_status[i] = status;
+    if (status != SCMI_SUCCESS && run->stop_on_error) {
+        fwk_log_info("[SCMI Clock] Script stopped at step %u: %d",
+                     i, (int)status);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * 從 steps_executed 繼續執行，遇到已排入的 RATE_SET 或
+ * 已啟動的延遲時暫停
+ */
+static void scmi_clock_script_continue(unsigned int agent_id)
+{
+    struct scmi_clock_script_run *run = &scmi_clock_ctx.script_runs[agent_id];
+    const struct scmi_clock_script_step *step;
+    int32_t status;
+
+    while (run->resp.steps_executed < run->params.step_count) {
+        step = &run->params.steps[run->resp.steps_executed];
+
+        switch (step->op_target & 0xFF) {
+        case SCMI_CLOCK_SCRIPT_OP_RATE_SET_KHZ:
+            status = scmi_clock_rate_set_handler(SCMI_CLOCK_RATE_ORIGIN_SCRIPT,
+                run->service_id, agent_id, step->op_target >> 16,
+                (uint64_t)step->arg * FWK_KHZ);
+            /* 已排入，完成時由 scmi_clock_script_step_done() 接續 */
+            if (status == SCMI_SUCCESS)
+                return;
+            break;
+
+        case SCMI_CLOCK_SCRIPT_OP_DELAY_US:
+            if (step->arg == 0) {
+                status = SCMI_SUCCESS;
+                break;
+            }
+            status = scmi_clock_script_delay_start(agent_id, step->arg,
+                                                   &run->delay_budget_us);
+            /* alarm 到期時由 scmi_clock_script_step_done() 接續 */
+            if (status == SCMI_SUCCESS)
+                return;
+            break;
+
+        default:
+            status = scmi_clock_script_step_run(agent_id, step);
+            break;
+        }
+
+        if (!scmi_clock_script_record(run, status))
+            break;
+    }
+
+    scmi_clock_script_finish(run);
+}
+
+/* 腳本中的 RATE_SET 完成或延遲到期 */
+static void scmi_clock_script_step_done(unsigned int agent_id,
+                                        int32_t status)
+{
+    struct scmi_clock_script_run *run = &scmi_clock_ctx.script_runs[agent_id];
+
+    if (!run->active)
+        return;
+
+    if (scmi_clock_script_record(run, status))
+        scmi_clock_script_continue(agent_id);
+    else
+        scmi_clock_script_finish(run);
+}
+
+/*
+ * 處理 BRINGUP_SCRIPT 命令
+ * 參數複製到代理的 script_runs 後開始執行，回應在腳本結束時送出
+ */
+static int scmi_clock_bringup_script_handler(fwk_id_t service_id,
+                                             const uint32_t *payload)
+{
+    const struct scmi_clock_script_a2p *parameters;
+    struct scmi_clock_script_run *run;
+    unsigned int agent_id;
+    int32_t status;
+
+    parameters = (const struct scmi_clock_script_a2p *)payload;
+
+    if (parameters->step_count == 0 ||
+        parameters->step_count > SCMI_CLOCK_SCRIPT_MAX_STEPS) {
+        status = SCMI_INVALID_PARAMETERS;
+        goto error;
+    }
+
+    if (scmi_clock_ctx.scmi_api->get_agent_id(service_id, &agent_id) !=
+            FWK_SUCCESS ||
+        agent_id >= scmi_clock_ctx.agent_count) {
+        status = SCMI_GENERIC_ERROR;
+        goto error;
+    }
+
+    run = &scmi_clock_ctx.script_runs[agent_id];
+    if (run->active) {
+        status = SCMI_BUSY;
+        goto error;
+    }
+
+    *run = (struct scmi_clock_script_run) {
+        .active = true,
+        .service_id = service_id,
+        .stop_on_error =
+            (parameters->flags & SCMI_CLOCK_SCRIPT_CONTINUE_ON_ERROR) == 0,
+        .delay_budget_us = SCMI_CLOCK_SCRIPT_MAX_TOTAL_DELAY_US,
+        .resp.status = SCMI_SUCCESS,
+    };
+    fwk_str_memcpy(&run->params, parameters,
+           offsetof(struct scmi_clock_script_a2p, steps) +
+               parameters->step_count * sizeof(parameters->steps[0]));
+
+    scmi_clock_script_continue(agent_id);
+
+    return FWK_SUCCESS;
+
+error:
+    scmi_clock_ctx.scmi_api->respond(service_id, &status, sizeof(status));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * SCMI Clock 命令分派
+ * 根據命令 ID 分派到對應的處理函數
+ */
+static int scmi_clock_dispatch_message(fwk_id_t service_id,
+                                      const uint32_t *payload,
+                                      unsigned int message_id)
+{
+    int status = FWK_SUCCESS;
+    
+    fwk_log_debug("[SCMI Clock] Received message ID: 0x%x", message_id);
+    
+    switch (message_id) {
+    case SCMI_CLOCK_RATE_SET:
+        status = scmi_clock_rate_set_message(service_id, payload);
+        break;
+        
+    case SCMI_CLOCK_RATE_GET:
+        status = scmi_clock_rate_get_message(service_id, payload);
+        break;
+        
+    case SCMI_CLOCK_CONFIG_SET:
+        status = scmi_clock_config_set_message(service_id, payload);
+        break;
+        
+    case SCMI_CLOCK_NEGOTIATE_PROTOCOL_VERSION:
+        status = scmi_clock_negotiate_version_handler(service_id, payload);
+        break;
+        
+    case SCMI_CLOCK_ATTRIBUTES:
+        /* 處理時鐘屬性查詢 */
+        status = scmi_clock_attributes_handler(service_id, payload);
+        break;
+        
+    case SCMI_CLOCK_DESCRIBE_RATES:
+        /* 處理時鐘頻率範圍查詢 */
+        status = scmi_clock_describe_rates_handler(service_id, payload);
+        break;
+        
+    case SCMI_CLOCK_RATE_NOTIFY:
+    case SCMI_CLOCK_RATE_CHANGE_REQUESTED_NOTIFY:
+        /* 訂閱/取消頻率變更通知 */
+        status = scmi_clock_rate_notify_handler(service_id, payload,
+                                                message_id);
+        break;
+        
+    case SCMI_CLOCK_VENDOR_STATE_SNAPSHOT:
+        /* 一次回傳多個時鐘的頻率與啟用狀態 */
+        status = scmi_clock_state_snapshot_handler(service_id, payload);
+        break;
+        
+    case SCMI_CLOCK_VENDOR_TRANSITION_COST:
+        /* 回報此時鐘轉換的延遲與能量成本 */
+        status = scmi_clock_transition_cost_handler(service_id, payload);
+        break;
+        
+    case SCMI_CLOCK_VENDOR_DESCRIBE_RATES_COMPACT:
+        /* 三元組/差值編碼的頻率表 */
+        status = scmi_clock_describe_rates_compact_handler(service_id,
+                                                           payload);
+        break;
+        
+    case SCMI_CLOCK_VENDOR_BRINGUP_SCRIPT:
+        /* 一次執行一串時鐘與 reset 步驟 */
+        status = scmi_clock_bringup_script_handler(service_id, payload);
+        break;
+        
+    default:
+        fwk_log_error("[SCMI Clock] Unsupported message ID: 0x%x", message_id);
+        
+        /* 傳送不支援的回應 */
+        struct {
+            int32_t status;
+        } error_response = { SCMI_NOT_SUPPORTED };
+        
+        scmi_clock_ctx.scmi_api->respond(service_id, &error_response, 
+                                        sizeof(error_response));
+        break;
+    }
+    
+    return status;
+}
+
+/*
+ * 回應 SCMI_BUSY，讓代理稍後重試
+ * 被拒絕的訊息沒有占用 SCP，向通道排程歸還這次的服務額度
+ */
+static void scmi_clock_respond_busy(fwk_id_t service_id)
+{
+    struct {
+        int32_t status;
+    } busy_response = { SCMI_BUSY };
+
+    scmi_clock_ctx.scmi_api->respond(service_id, &busy_response,
+                                    sizeof(busy_response));
+
+    if (scmi_clock_ctx.channel_credit_api != NULL)
+        scmi_clock_ctx.channel_credit_api->refund(service_id);
+}
+
+/* 依經過時間補充 token，上限為 burst */
+static void scmi_clock_sched_refill(struct scmi_clock_agent_sched *sched)
+{
+    fwk_timestamp_t now = fwk_time_current();
+    uint64_t elapsed_us = (now - sched->last_refill) / FWK_US(1);
+    uint64_t max_milli = (uint64_t)sched->config->burst * 1000;
+
+    sched->last_refill = now;
+    sched->tokens_milli += elapsed_us * sched->config->rate_per_ms;
+    if (sched->tokens_milli > max_milli)
+        sched->tokens_milli = max_milli;
+}
+
+/*
+ * BRINGUP_SCRIPT 的 payload 是否放得下宣告的步驟數
+ * step_count 超出上限時交給 handler 回 SCMI_INVALID_PARAMETERS
+ */
+static bool scmi_clock_script_payload_valid(const uint32_t *payload,
+                                            size_t payload_size)
+{
+    const struct scmi_clock_script_a2p *parameters =
+        (const struct scmi_clock_script_a2p *)payload;
+
+    if (payload_size < offsetof(struct scmi_clock_script_a2p, steps))
+        return false;
+
+    if (parameters->step_count > SCMI_CLOCK_SCRIPT_MAX_STEPS)
+        return true;
+
+    return payload_size >= offsetof(struct scmi_clock_script_a2p, steps) +
+                           parameters->step_count *
+                               sizeof(parameters->steps[0]);
+}
+
+/* BRINGUP_SCRIPT 的流量限制，見 scmi_clock_message_handler() */
+static int scmi_clock_script_admit(struct scmi_clock_agent_sched *sched,
+                                   fwk_id_t service_id,
+                                   const uint32_t *payload)
+{
+    const struct scmi_clock_script_a2p *parameters =
+        (const struct scmi_clock_script_a2p *)payload;
+    uint64_t cost;
+
+    cost = (uint64_t)FWK_MIN(parameters->step_count,
+                             (uint32_t)SCMI_CLOCK_SCRIPT_MAX_STEPS);
+    cost = FWK_MIN(FWK_MAX(cost, (uint64_t)1),
+                   (uint64_t)sched->config->burst) * 1000;
+
+    scmi_clock_sched_refill(sched);
+    if (sched->tokens_milli < cost) {
+        sched->stats.rate_limited++;
+        scmi_clock_respond_busy(service_id);
+        return FWK_SUCCESS;
+    }
+
+    sched->tokens_milli -= cost;
+    sched->stats.dispatched++;
+
+    return scmi_clock_dispatch_message(service_id, payload,
+                                       SCMI_CLOCK_VENDOR_BRINGUP_SCRIPT);
 }
 
 /*
  * SCMI Clock 協議訊息處理器
- * 根據命令 ID 分派到對應的處理函數
+ * 先經過每個代理的 token bucket，超出限制回 SCMI_BUSY，
+ * 通過後直接處理
  */
-static int scmi_clock_message_handler(fwk_id_t protocol_id, 
+static int scmi_clock_message_handler(fwk_id_t protocol_id,
                                      fwk_id_t service_id,
-                                     const uint32_t *payload, 
+                                     const uint32_t *payload,
                                      size_t payload_size,
                                      unsigned int message_id)
 {
-    int status = FWK_SUCCESS;
-    
+    struct scmi_clock_agent_sched *sched;
+    unsigned int agent_id;
+    int status;
+
     fwk_log_debug("[SCMI Clock] Received message ID: 0x%x", message_id);
-    
-    switch (message_id) {
+
+    /* 無法判斷代理時仍須回應，否則通道一直被占住 */
+    status = scmi_clock_ctx.scmi_api->get_agent_id(service_id, &agent_id);
+    if (status != FWK_SUCCESS || agent_id >= scmi_clock_ctx.agent_count) {
+        struct {
+            int32_t status;
+        } error_response = { SCMI_GENERIC_ERROR };
+
+        scmi_clock_ctx.scmi_api->respond(service_id, &error_response,
+                                        sizeof(error_response));
+        return FWK_SUCCESS;
+    }
+
+    /*
+     * 腳本在 handler 與流量限制中都依 step_count 讀取步驟，
+     * 先確認 payload 放得下，不論代理有沒有流量限制
+     */
+    if (message_id == SCMI_CLOCK_VENDOR_BRINGUP_SCRIPT &&
+        !scmi_clock_script_payload_valid(payload, payload_size)) {
+        struct {
+            int32_t status;
+        } error_response = { SCMI_PROTOCOL_ERROR };
+
+        scmi_clock_ctx.scmi_api->respond(service_id, &error_response,
+                                        sizeof(error_response));
+        return FWK_SUCCESS;
+    }
+
+    sched = &scmi_clock_ctx.agent_sched[agent_id];
+    sched->stats.received++;
+
+    /* 沒有流量限制設定的代理直接處理 */
+    if (sched->config == NULL) {
+        sched->stats.dispatched++;
+        return scmi_clock_dispatch_message(service_id, payload, message_id);
+    }
+
+    /*
+     * 腳本每個步驟計一個 token (最多一個 burst)，
+     * 與逐一送出的配額相當
+     */
+    if (message_id == SCMI_CLOCK_VENDOR_BRINGUP_SCRIPT)
+        return scmi_clock_script_admit(sched, service_id, payload);
+
+    scmi_clock_sched_refill(sched);
+    if (sched->tokens_milli < 1000) {
+        sched->stats.rate_limited++;
+        scmi_clock_respond_busy(service_id);
+        return FWK_SUCCESS;
+    }
+
+    sched->tokens_milli -= 1000;
+    sched->stats.dispatched++;
+
+    return scmi_clock_dispatch_message(service_id, payload, message_id);
+}
+
+/*
+ * 暫存器快速路徑
+ * 與 shmem 路徑共用 handler 與 token bucket，沒有 token 時回 SCMI_BUSY。
+ * 不經過 mod_scmi，所以代理由 service_id 向 mod_scmi 查詢，
+ * 協議與命令權限也在這裡檢查
+ */
+static int scmi_clock_reg_process(fwk_id_t service_id,
+                                  const uint32_t args[SCMI_CLOCK_REG_ARGS],
+                                  uint32_t ret[SCMI_CLOCK_REG_RETS])
+{
+    struct scmi_clock_agent_sched *sched;
+    unsigned int agent_id;
+    uint32_t flags = 0;
+    uint64_t rate = 0;
+    int32_t status;
+
+    if (args == NULL || ret == NULL)
+        return FWK_E_PARAM;
+
+    if (scmi_clock_ctx.scmi_api->get_agent_id(service_id, &agent_id) !=
+            FWK_SUCCESS ||
+        agent_id >= scmi_clock_ctx.agent_count) {
+        status = SCMI_GENERIC_ERROR;
+        goto exit;
+    }
+
+    /* 其他命令需要 shmem 才放得下參數與回應 */
+    if (args[0] != SCMI_CLOCK_RATE_SET && args[0] != SCMI_CLOCK_RATE_GET &&
+        args[0] != SCMI_CLOCK_CONFIG_SET) {
+        status = SCMI_NOT_SUPPORTED;
+        goto exit;
+    }
+
+#ifdef BUILD_HAS_MOD_RESOURCE_PERMS
+    /* shmem 訊息的協議與命令權限由 mod_scmi 在分派前檢查 */
+    if (scmi_clock_ctx.res_perms_api->agent_has_protocol_permission(agent_id,
+            MOD_SCMI_PROTOCOL_ID_CLOCK) != MOD_RES_PERMS_ACCESS_ALLOWED ||
+        scmi_clock_ctx.res_perms_api->agent_has_message_permission(agent_id,
+            MOD_SCMI_PROTOCOL_ID_CLOCK, args[0]) !=
+            MOD_RES_PERMS_ACCESS_ALLOWED) {
+        status = SCMI_DENIED;
+        goto exit;
+    }
+#endif
+
+    sched = &scmi_clock_ctx.agent_sched[agent_id];
+    sched->stats.received++;
+
+    if (sched->config != NULL) {
+        scmi_clock_sched_refill(sched);
+        if (sched->tokens_milli < 1000) {
+            sched->stats.rate_limited++;
+            status = SCMI_BUSY;
+            goto exit;
+        }
+        sched->tokens_milli -= 1000;
+    }
+    sched->stats.dispatched++;
+
+    switch (args[0]) {
     case SCMI_CLOCK_RATE_SET:
-        status = scmi_clock_rate_set_handler(service_id, payload);
+        rate = ((uint64_t)args[3] << 32) | args[2];
+        status = scmi_clock_rate_set_handler(SCMI_CLOCK_RATE_ORIGIN_REG,
+                                             service_id, agent_id, args[1],
+                                             rate);
+        if (status == SCMI_SUCCESS)
+            flags |= SCMI_CLOCK_REG_RET_IN_PROGRESS;
         break;
-        
+
     case SCMI_CLOCK_RATE_GET:
-        status = scmi_clock_rate_get_handler(service_id, payload);
+        status = scmi_clock_rate_get_handler(agent_id, args[1], &rate);
         break;
-        
+
     case SCMI_CLOCK_CONFIG_SET:
-        status = scmi_clock_config_set_handler(service_id, payload);
-        break;
-        
-    case SCMI_CLOCK_ATTRIBUTES:
-        /* 處理時鐘屬性查詢 */
-        status = scmi_clock_attributes_handler(service_id, payload);
-        break;
-        
-    case SCMI_CLOCK_DESCRIBE_RATES:
-        /* 處理時鐘頻率範圍查詢 */
-        status = scmi_clock_describe_rates_handler(service_id, payload);
+        status = scmi_clock_config_set_handler(agent_id, args[1],
+                                               (args[2] & 0x1) != 0);
         break;
-        
+
     default:
-        fwk_log_error("[SCMI Clock] Unsupported message ID: 0x%x", message_id);
-        
-        /* 傳送不支援的回應 */
-        struct {
-            int32_t status;
-        } error_response = { SCMI_NOT_SUPPORTED };
-        
-        scmi_clock_ctx.scmi_api->respond(service_id, &error_response, 
-                                        sizeof(error_response));
+        status = SCMI_NOT_SUPPORTED;
         break;
     }
-    
-    return status;
+
+exit:
+    ret[0] = (uint32_t)status;
+    ret[1] = (status == SCMI_SUCCESS) ? (uint32_t)(rate & 0xFFFFFFFF) : 0;
+    ret[2] = (status == SCMI_SUCCESS) ? (uint32_t)(rate >> 32) : 0;
+    ret[3] = flags;
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 查詢代理的流量限制統計 (MOD_SCMI_CLOCK_API_IDX_STATS)
+ */
+static int scmi_clock_get_agent_stats(unsigned int agent_id,
+                                      struct mod_scmi_clock_agent_stats *stats)
+{
+    if (agent_id >= scmi_clock_ctx.agent_count || stats == NULL)
+        return FWK_E_PARAM;
+
+    *stats = scmi_clock_ctx.agent_sched[agent_id].stats;
+
+    return FWK_SUCCESS;
 }
 
 /*
@@ -322,6 +2475,8 @@ static int scmi_clock_init(fwk_id_t module_id,
                           const void *data)
 {
     const struct mod_scmi_clock_config *config = data;
+    struct scmi_clock_agent_sched *sched;
+    unsigned int agent_id;
     
     if (config == NULL) {
         return FWK_E_PARAM;
@@ -329,6 +2484,52 @@ static int scmi_clock_init(fwk_id_t module_id,
     
     scmi_clock_ctx.clock_count = config->clock_count;
     scmi_clock_ctx.clock_devices = config->clock_devices;
+    scmi_clock_ctx.agent_table = config->agent_table;
+    scmi_clock_ctx.boot_rates = fwk_mm_calloc(config->clock_count,
+                                              sizeof(struct scmi_clock_boot_rate));
+    scmi_clock_ctx.latency_stats = fwk_mm_calloc(config->clock_count,
+        sizeof(struct scmi_clock_latency_stats));
+    scmi_clock_ctx.rate_summaries = fwk_mm_calloc(config->clock_count,
+        sizeof(struct scmi_clock_rate_summary));
+    scmi_clock_ctx.rate_ops = fwk_mm_calloc(config->clock_count,
+        sizeof(struct scmi_clock_rate_op));
+    scmi_clock_ctx.reset_domains = config->reset_domain_table;
+    scmi_clock_ctx.reset_domain_count = config->reset_domain_count;
+    scmi_clock_ctx.boot_rate_alarm_id = config->boot_rate_alarm_id;
+    scmi_clock_ctx.channel_priority_id = config->channel_priority_id;
+
+    /* 訂閱者以 32 位元表示 */
+    if (config->agent_count > 32)
+        return FWK_E_PARAM;
+
+    scmi_clock_ctx.rate_changed_subscribers =
+        fwk_mm_calloc(config->clock_count, sizeof(uint32_t));
+    scmi_clock_ctx.rate_requested_subscribers =
+        fwk_mm_calloc(config->clock_count, sizeof(uint32_t));
+    scmi_clock_ctx.agent_service_ids =
+        fwk_mm_calloc(config->agent_count, sizeof(fwk_id_t));
+    scmi_clock_ctx.script_runs = fwk_mm_calloc(config->agent_count,
+        sizeof(struct scmi_clock_script_run));
+    scmi_clock_ctx.agent_versions = fwk_mm_calloc(config->agent_count,
+                                                  sizeof(uint32_t));
+
+    /* 每個代理的 token bucket，開機時為滿 */
+    scmi_clock_ctx.agent_count = config->agent_count;
+    scmi_clock_ctx.agent_sched = fwk_mm_calloc(config->agent_count,
+                                               sizeof(struct scmi_clock_agent_sched));
+    for (agent_id = 0; agent_id < config->agent_count; agent_id++) {
+        scmi_clock_ctx.agent_versions[agent_id] = SCMI_CLOCK_PROTOCOL_VERSION;
+
+        sched = &scmi_clock_ctx.agent_sched[agent_id];
+        sched->config = config->agent_table[agent_id].sched;
+        if (sched->config == NULL)
+            continue;
+
+        if (sched->config->burst == 0)
+            return FWK_E_PARAM;
+
+        sched->tokens_milli = (uint64_t)sched->config->burst * 1000;
+    }
     
     fwk_log_info("[SCMI Clock] Module initialized with %u clocks", 
                  scmi_clock_ctx.clock_count);
@@ -336,11 +2537,238 @@ static int scmi_clock_init(fwk_id_t module_id,
     return FWK_SUCCESS;
 }
 
+/*
+ * alarm callback 在中斷環境執行，只排入事件
+ */
+static void scmi_clock_boot_rate_alarm_callback(uintptr_t param)
+{
+    struct fwk_event event = {
+        .source_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+        .target_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+        .id = scmi_clock_event_boot_rate_retry,
+    };
+
+    fwk_put_event(&event);
+}
+
+/* 排定一次開機頻率的重試 (已排定則略過) */
+static void scmi_clock_boot_rate_arm_retry(void)
+{
+    int status;
+
+    if (scmi_clock_ctx.alarm_api == NULL || scmi_clock_ctx.boot_rate_retry_armed)
+        return;
+
+    status = scmi_clock_ctx.alarm_api->start(scmi_clock_ctx.boot_rate_alarm_id,
+                                             SCMI_CLOCK_BOOT_RATE_RETRY_MS,
+                                             MOD_TIMER_ALARM_TYPE_ONCE,
+                                             scmi_clock_boot_rate_alarm_callback,
+                                             0);
+    if (status == FWK_SUCCESS)
+        scmi_clock_ctx.boot_rate_retry_armed = true;
+}
+
+/*
+ * 送出單一時鐘的開機頻率請求，只在本模組的事件中呼叫
+ * 非同步的 PLL driver 會回傳 FWK_PENDING，完成時由 process_event 收尾；
+ * 有 SCP 本地上限的時鐘與 RATE_SET 一樣經由 clock_cap，開機頻率也受上限限制。
+ * PERF 管理的時鐘不經過這裡，開機 level 由 PERF 的 initial_level 套用
+ */
+static void scmi_clock_boot_rate_issue(unsigned int clock_id)
+{
+    int status;
+    const struct mod_scmi_clock_device *device;
+    struct scmi_clock_boot_rate *boot_rate;
+
+    device = &scmi_clock_ctx.clock_devices[clock_id];
+    boot_rate = &scmi_clock_ctx.boot_rates[clock_id];
+
+    if (fwk_optional_id_is_defined(device->cap_domain_id))
+        status = scmi_clock_ctx.cap_api->set_rate(
+            device->cap_domain_id, device->initial_rate,
+            MOD_CLOCK_ROUND_MODE_NEAREST);
+    else
+        status = scmi_clock_ctx.clock_api->set_rate(
+            device->element_id, device->initial_rate,
+            MOD_CLOCK_ROUND_MODE_NEAREST);
+    switch (status) {
+    case FWK_SUCCESS:
+        boot_rate->rate = device->initial_rate;
+        boot_rate->deferred = false;
+        scmi_clock_ctx.state_generation++;
+        break;
+
+    case FWK_PENDING:
+        boot_rate->pending = true;
+        boot_rate->deferred = false;
+        scmi_clock_ctx.boot_rate_pending++;
+        break;
+
+    case FWK_E_BUSY:
+        /* 與其他時鐘共用同一顆 PLL，等前一個請求完成或 alarm 到期 */
+        boot_rate->deferred = true;
+        scmi_clock_boot_rate_arm_retry();
+        break;
+
+    default:
+        fwk_log_error("[SCMI Clock] Boot rate for clock %u failed: %d",
+                      clock_id, status);
+        boot_rate->deferred = false;
+        break;
+    }
+}
+
+/* 重送因共用 PLL 忙碌而延後的開機頻率請求 */
+static void scmi_clock_boot_rate_retry_deferred(void)
+{
+    unsigned int clock_id;
+
+    for (clock_id = 0; clock_id < scmi_clock_ctx.clock_count; clock_id++) {
+        if (scmi_clock_ctx.boot_rates[clock_id].deferred)
+            scmi_clock_boot_rate_issue(clock_id);
+    }
+}
+
+/*
+ * 一次送出所有 initial_rate 請求，各顆獨立 PLL 同時 relock，
+ * 總開機時間約等於最慢的一顆 PLL lock 時間，而不是全部加總。
+ * CPU 等 PERF 管理的時鐘跳過：直接設定會繞過 clock_cap 與 DVFS 的
+ * 電壓順序，也會與 PERF 套用 initial_level 互相競爭
+ */
+static void scmi_clock_boot_rate_issue_all(void)
+{
+    const struct mod_scmi_clock_device *device;
+    unsigned int clock_id;
+
+    for (clock_id = 0; clock_id < scmi_clock_ctx.clock_count; clock_id++) {
+        device = &scmi_clock_ctx.clock_devices[clock_id];
+        if (fwk_id_is_equal(device->element_id, FWK_ID_NONE) ||
+            device->initial_rate == 0 || device->perf_owned)
+            continue;
+
+        scmi_clock_boot_rate_issue(clock_id);
+    }
+
+    fwk_log_info("[SCMI Clock] Boot rates issued, %u pending",
+                 scmi_clock_ctx.boot_rate_pending);
+}
+
+/*
+ * 模組啟動
+ * 開機頻率不在這裡送出：set_rate 回 FWK_PENDING 時，mod_clock 把完成
+ * 事件送回發出請求時正在處理的事件，start() 沒有事件可以接收它。
+ * 排入自己的事件，由 process_event 送出
+ */
+static int scmi_clock_start(fwk_id_t id)
+{
+    struct fwk_event event = {
+        .source_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+        .target_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CLOCK),
+        .id = scmi_clock_event_boot_rate_start,
+    };
+    fwk_id_t clock_element_id;
+    unsigned int clock_id;
+    int status;
+
+    if (!fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    for (clock_id = 0; clock_id < scmi_clock_ctx.clock_count; clock_id++) {
+        clock_element_id = scmi_clock_ctx.clock_devices[clock_id].element_id;
+        if (fwk_id_is_equal(clock_element_id, FWK_ID_NONE))
+            continue;
+
+        /*
+         * power domain 關閉/恢復時 mod_clock 直接改變時鐘狀態，
+         * 不經過本模組；訂閱狀態變更以維持 state_generation
+         */
+        status = fwk_notification_subscribe(
+            mod_clock_notification_id_state_changed, clock_element_id, id);
+        if (status != FWK_SUCCESS)
+            return status;
+    }
+
+    return fwk_put_event(&event);
+}
+
+/*
+ * 處理開機頻率重試事件與 Clock 模組回傳的非同步完成事件
+ */
+static int scmi_clock_process_event(const struct fwk_event *event,
+                                   struct fwk_event *resp_event)
+{
+    const struct mod_clock_resp_params *params;
+    struct scmi_clock_boot_rate *boot_rate;
+    unsigned int clock_id;
+
+    if (fwk_id_is_equal(event->id, scmi_clock_event_boot_rate_start)) {
+        scmi_clock_boot_rate_issue_all();
+        return FWK_SUCCESS;
+    }
+
+    if (fwk_id_is_equal(event->id, scmi_clock_event_boot_rate_retry)) {
+        scmi_clock_ctx.boot_rate_retry_armed = false;
+        scmi_clock_boot_rate_retry_deferred();
+        return FWK_SUCCESS;
+    }
+
+    if (fwk_id_is_equal(event->id, scmi_clock_event_rate_set)) {
+        scmi_clock_rate_set_execute(*(const uint32_t *)event->params);
+        return FWK_SUCCESS;
+    }
+
+    if (fwk_id_is_equal(event->id, scmi_clock_event_script_delay)) {
+        scmi_clock_script_step_done(*(const uint32_t *)event->params,
+                                    SCMI_SUCCESS);
+        return FWK_SUCCESS;
+    }
+
+    if (!fwk_id_is_equal(event->id, mod_clock_event_id_request))
+        return FWK_SUCCESS;
+
+    params = (const struct mod_clock_resp_params *)event->params;
+
+    for (clock_id = 0; clock_id < scmi_clock_ctx.clock_count; clock_id++) {
+        if (!fwk_id_is_equal(scmi_clock_ctx.clock_devices[clock_id].element_id,
+                             event->source_id))
+            continue;
+
+        /* 代理的 RATE_SET 在 driver 完成 PLL relock 後才算完成 */
+        if (scmi_clock_ctx.rate_ops[clock_id].pending) {
+            scmi_clock_rate_set_complete(clock_id, params->status);
+            continue;
+        }
+
+        boot_rate = &scmi_clock_ctx.boot_rates[clock_id];
+        if (!boot_rate->pending)
+            continue;
+
+        boot_rate->pending = false;
+        scmi_clock_ctx.boot_rate_pending--;
+
+        if (params->status == FWK_SUCCESS) {
+            boot_rate->rate = scmi_clock_ctx.clock_devices[clock_id].initial_rate;
+            scmi_clock_ctx.state_generation++;
+        } else {
+            fwk_log_error("[SCMI Clock] Boot rate for clock %u failed: %d",
+                          clock_id, params->status);
+        }
+    }
+
+    /* PLL 釋放後，重送共用該 PLL 的請求 */
+    scmi_clock_boot_rate_retry_deferred();
+
+    return FWK_SUCCESS;
+}
+
 /*
  * 綁定其他模組的 API
  */
 static int scmi_clock_bind(fwk_id_t id, unsigned int round)
 {
+    unsigned int clock_id;
+    unsigned int agent_id;
+    fwk_id_t alarm_id;
     int status;
     
     if (round == 1) {
@@ -360,8 +2788,80 @@ static int scmi_clock_bind(fwk_id_t id, unsigned int round)
                             FWK_ID_API(FWK_MODULE_IDX_SCMI, 
                                       MOD_SCMI_API_IDX_PROTOCOL),
                             &scmi_clock_ctx.scmi_api);
+    if (status != FWK_SUCCESS) {
+        return status;
+    }
     
-    return status;
+#ifdef BUILD_HAS_MOD_RESOURCE_PERMS
+    /* 綁定權限模組 API */
+    status = fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_RESOURCE_PERMS),
+                            FWK_ID_API(FWK_MODULE_IDX_RESOURCE_PERMS,
+                                      MOD_RES_PERM_RESOURCE_PERMS),
+                            &scmi_clock_ctx.res_perms_api);
+    if (status != FWK_SUCCESS) {
+        return status;
+    }
+#endif
+    
+    /* 有 SCP 本地上限的時鐘時綁定 clock_cap (可選) */
+    for (clock_id = 0; clock_id < scmi_clock_ctx.clock_count; clock_id++) {
+        if (!fwk_optional_id_is_defined(
+                scmi_clock_ctx.clock_devices[clock_id].cap_domain_id))
+            continue;
+        
+        status = fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_CLOCK_CAP),
+                                FWK_ID_API(FWK_MODULE_IDX_CLOCK_CAP, 0),
+                                &scmi_clock_ctx.cap_api);
+        if (status != FWK_SUCCESS) {
+            return status;
+        }
+        break;
+    }
+    
+    /* 開機頻率的重試 alarm (可選) */
+    if (fwk_id_is_type(scmi_clock_ctx.boot_rate_alarm_id,
+                       FWK_ID_TYPE_SUB_ELEMENT)) {
+        status = fwk_module_bind(scmi_clock_ctx.boot_rate_alarm_id,
+                                MOD_TIMER_API_ID_ALARM,
+                                &scmi_clock_ctx.alarm_api);
+        if (status != FWK_SUCCESS) {
+            return status;
+        }
+    }
+    
+    /* 通道排程的額度歸還 (可選) */
+    if (fwk_optional_id_is_defined(scmi_clock_ctx.channel_priority_id)) {
+        status = fwk_module_bind(scmi_clock_ctx.channel_priority_id,
+                                FWK_ID_API(FWK_MODULE_IDX_SCMI_CHANNEL_PRIORITY,
+                                    MOD_SCMI_CHANNEL_PRIORITY_API_IDX_CREDIT),
+                                &scmi_clock_ctx.channel_credit_api);
+        if (status != FWK_SUCCESS) {
+            return status;
+        }
+    }
+    
+    /* BRINGUP_SCRIPT 延遲步驟的 alarm (每個代理一個，可選) */
+    for (agent_id = 0; agent_id < scmi_clock_ctx.agent_count; agent_id++) {
+        alarm_id = scmi_clock_ctx.agent_table[agent_id].script_alarm_id;
+        if (!fwk_id_is_type(alarm_id, FWK_ID_TYPE_SUB_ELEMENT))
+            continue;
+        
+        status = fwk_module_bind(alarm_id, MOD_TIMER_API_ID_ALARM,
+                                &scmi_clock_ctx.alarm_api);
+        if (status != FWK_SUCCESS) {
+            return status;
+        }
+    }
+    
+    /* BRINGUP_SCRIPT 的 reset 步驟需要 Reset Domain 模組 (可選) */
+    if (scmi_clock_ctx.reset_domain_count == 0) {
+        return FWK_SUCCESS;
+    }
+    
+    return fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_RESET_DOMAIN),
+                           FWK_ID_API(FWK_MODULE_IDX_RESET_DOMAIN,
+                                      MOD_RESET_DOMAIN_API_TYPE_HAL),
+                           &scmi_clock_ctx.reset_api);
 }
 
 /*
@@ -378,19 +2878,69 @@ static int scmi_clock_process_bind_request(fwk_id_t source_id,
         .message_handler = scmi_clock_message_handler,
     };
     
-    *api = &scmi_clock_protocol_api;
+    /* 提供頻率變更通知 API 給其他 SCP 模組 */
+    static const struct mod_scmi_clock_notify_api scmi_clock_notify_api = {
+        .rate_changed = scmi_clock_notify_rate_changed,
+    };
+    
+    /* 提供暫存器快速路徑給 SMC/HVC 轉接模組 */
+    static const struct mod_scmi_clock_reg_api scmi_clock_reg_api = {
+        .process = scmi_clock_reg_process,
+    };
+    
+    /* 提供代理流量統計 */
+    static const struct mod_scmi_clock_stats_api scmi_clock_stats_api = {
+        .get_agent_stats = scmi_clock_get_agent_stats,
+    };
+    
+    switch (fwk_id_get_api_idx(api_id)) {
+    case MOD_SCMI_CLOCK_API_IDX_PROTOCOL:
+        *api = &scmi_clock_protocol_api;
+        break;
+        
+    case MOD_SCMI_CLOCK_API_IDX_NOTIFY:
+        *api = &scmi_clock_notify_api;
+        break;
+        
+    case MOD_SCMI_CLOCK_API_IDX_REG:
+        *api = &scmi_clock_reg_api;
+        break;
+        
+    case MOD_SCMI_CLOCK_API_IDX_STATS:
+        *api = &scmi_clock_stats_api;
+        break;
+        
+    default:
+        return FWK_E_PARAM;
+    }
     
     return FWK_SUCCESS;
 }
 
+/*
+ * mod_clock 的狀態變更通知 (power domain 轉換)
+ */
+static int scmi_clock_process_notification(const struct fwk_event *event,
+                                           struct fwk_event *resp_event)
+{
+    if (fwk_id_is_equal(event->id, mod_clock_notification_id_state_changed))
+        scmi_clock_ctx.state_generation++;
+
+    return FWK_SUCCESS;
+}
+
 /* 模組描述符 */
 const struct fwk_module module_scmi_clock = {
     .name = "SCMI Clock Management Protocol",
-    .api_count = 1,
+    .api_count = MOD_SCMI_CLOCK_API_IDX_COUNT,
+    .event_count = SCMI_CLOCK_EVENT_IDX_COUNT,
     .type = FWK_MODULE_TYPE_PROTOCOL,
     .init = scmi_clock_init,
     .bind = scmi_clock_bind,
+    .start = scmi_clock_start,
     .process_bind_request = scmi_clock_process_bind_request,
+    .process_event = scmi_clock_process_event,
+    .process_notification = scmi_clock_process_notification,
 };
 
 /*
@@ -398,9 +2948,21 @@ const struct fwk_module module_scmi_clock = {
  * 
  * 1. Linux SCMI Driver 傳送 SCMI Clock Rate Set 命令
  * 2. SCP firmware 接收命令並解析參數
- * 3. 呼叫 scmi_clock_rate_set_handler()
- * 4. 透過 Clock 模組 API 設定實際硬體
- * 5. 傳送回應給 Linux kernel
+ * 3. 呼叫 scmi_clock_rate_set_handler()，排入本模組的 RATE_SET 事件
+ * 4. 事件中透過 Clock 模組 API 設定實際硬體
+ *    (受限的時鐘經過 clock_cap，溫度/功率上限在 SCP 本地生效，
+ *     不必等 Linux thermal 送 RATE_SET)；
+ *    driver 回 FWK_PENDING 時等 mod_clock 的完成事件
+ * 5. 傳送回應給 Linux kernel (非同步 RATE_SET 先回應，
+ *    完成時再送 CLOCK_RATE_SET_COMPLETE delayed response)
+ * 
+ * 暫存器快速路徑 (RATE_SET / RATE_GET / CONFIG_SET)：
+ * 1. Linux 以 SMC 把 clock ID 與 rate 放在 x1-x4
+ * 2. monitor 把引數寫進該代理專屬的 mailbox 資料暫存器並按門鈴
+ * 3. SCP 的轉接模組以該通道的 service 呼叫
+ *    mod_scmi_clock_reg_api.process()，代理身分與權限都在 SCP 端確認
+ * 4. 同一組 handler 處理，結果放回 x0-x3，不讀寫 shmem；
+ *    RATE_SET 只回報已接受，結果以 RATE_CHANGED 經該代理的 P2A 通道送回
  * 
  * 訊息格式：
  * - 命令: [Header][Clock ID][Rate Low][Rate High]
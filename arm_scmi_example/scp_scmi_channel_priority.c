@@ -0,0 +1,584 @@
+/*
+ * SCP Firmware SCMI Channel Priority Example
+ *
+ * 這個範例展示如何讓同一個代理 (agent) 擁有多個 SCMI A2P 通道，
+ * 並依照平台設定的優先權決定 SCP 服務順序。
+ *
+ * 問題：所有時鐘訊息共用一個 A2P 通道時，一個耗時的 DESCRIBE_RATES
+ * 或顯示像素時鐘變更會排在 CPU DVFS 的 RATE_SET 前面。
+ *
+ * 作法：本模組插在傳輸層 (MHU/transport) 與 mod_scmi 之間：
+ *   transport ISR -> scmi_channel_priority_signal() -> 標記 pending
+ *   事件循環     -> 每次只轉送一則訊息給 mod_scmi
+ *   轉送完成後重新排入 dispatch 事件，再次從最高優先權開始檢查
+ *
+ * 排程是兩層的 deficit round robin：
+ *   - 優先權等級之間：每個等級每輪有 band_weight 則額度，
+ *     有額度的等級中取最高優先權者；有訊息的等級額度都用完才開始
+ *     新的一輪。高優先權在輪內仍先服務，但持續灌訊息的高優先權通道
+ *     只能占每輪 band_weight 則，低優先權通道不會被餓死
+ *   - 同一等級的通道之間：依 weight 輪流 (round robin)
+ * 被上層以 SCMI_BUSY 拒絕的訊息 (流量限制) 經 refund 歸還額度，
+ * 不占用通道與等級的份額。
+ *
+ * SCP framework 是 run-to-completion，無法在 handler 執行中途搶佔；
+ * 這裡的「搶佔」是訊息粒度：低優先權通道最多只會讓高優先權通道
+ * 多等一則訊息的處理時間。
+ */
+
+#include <fwk_assert.h>
+#include <fwk_event.h>
+#include <fwk_id.h>
+#include <fwk_interrupt.h>
+#include <fwk_log.h>
+#include <fwk_macros.h>
+#include <fwk_mm.h>
+#include <fwk_module.h>
+#include <fwk_module_idx.h>
+#include <fwk_status.h>
+#include <mod_scmi.h>
+
+/* 模組提供的 API */
+enum mod_scmi_channel_priority_api_idx {
+    /* 給傳輸層，取代 mod_scmi 的 signal_message */
+    MOD_SCMI_CHANNEL_PRIORITY_API_IDX_SIGNAL,
+    /* 查詢每個通道的統計 */
+    MOD_SCMI_CHANNEL_PRIORITY_API_IDX_STATS,
+    /* 給協議模組，歸還被 SCMI_BUSY 拒絕的訊息所用的額度 */
+    MOD_SCMI_CHANNEL_PRIORITY_API_IDX_CREDIT,
+    MOD_SCMI_CHANNEL_PRIORITY_API_IDX_COUNT,
+};
+
+/* 通道統計 */
+struct mod_scmi_channel_priority_stats_api {
+    /*
+     * 讀取通道的統計
+     * channel_id 為本模組的 element id
+     */
+    int (*get_stats)(fwk_id_t channel_id, uint32_t *serviced,
+                     uint32_t *bypassed);
+};
+
+/* 排程額度 */
+struct mod_scmi_channel_priority_credit_api {
+    /*
+     * 歸還一則訊息的額度
+     * service_id 為 mod_scmi 的 service element；剛轉送的訊息被協議模組
+     * 以 SCMI_BUSY 拒絕時呼叫，這則訊息沒有真正占用 SCP
+     */
+    int (*refund)(fwk_id_t service_id);
+};
+
+/* 通道優先權，數值越小越優先 */
+enum scmi_channel_priority {
+    SCMI_CHANNEL_PRIORITY_HIGH,    /* PSCI、CPU DVFS (PERF 協議) */
+    SCMI_CHANNEL_PRIORITY_NORMAL,  /* 一般時鐘/電源請求 */
+    SCMI_CHANNEL_PRIORITY_LOW,     /* DESCRIBE_RATES、顯示時鐘等 */
+    SCMI_CHANNEL_PRIORITY_COUNT,
+};
+
+/* 通道 (element) 設定 */
+struct scmi_channel_priority_config {
+    /* 對應 mod_scmi 的 service element */
+    fwk_id_t service_id;
+
+    /* 擁有此通道的代理 */
+    unsigned int agent_id;
+
+    /* 平台設定的優先權 */
+    enum scmi_channel_priority priority;
+
+    /* 同一優先權等級內，每輪可服務的訊息數 (0 視為 1) */
+    unsigned int weight;
+};
+
+/* 模組設定 (可省略，使用預設的等級額度) */
+struct scmi_channel_priority_module_config {
+    /* 每個優先權等級每輪可服務的訊息數 (0 視為 1) */
+    unsigned int band_weight[SCMI_CHANNEL_PRIORITY_COUNT];
+};
+
+/*
+ * 預設的等級額度：通道都持續有訊息時，HIGH:NORMAL:LOW 約為 8:4:1，
+ * LOW 每 13 則至少服務 1 則
+ */
+static const unsigned int
+    scmi_channel_priority_default_band_weight[SCMI_CHANNEL_PRIORITY_COUNT] = {
+    [SCMI_CHANNEL_PRIORITY_HIGH] = 8,
+    [SCMI_CHANNEL_PRIORITY_NORMAL] = 4,
+    [SCMI_CHANNEL_PRIORITY_LOW] = 1,
+};
+
+/* 每個通道的執行期狀態 */
+struct scmi_channel_priority_dev_ctx {
+    const struct scmi_channel_priority_config *config;
+
+    /* 傳輸層已收到 doorbell，尚未轉送給 mod_scmi */
+    volatile bool pending;
+
+    /* 在優先權排序表中的位置 (pending_mask 的位元) */
+    unsigned int rank;
+
+    /* 本輪剩餘額度與每輪額度 */
+    unsigned int deficit;
+    unsigned int weight;
+
+    /* 統計：已服務的訊息數 */
+    uint32_t serviced;
+
+    /* 統計：有訊息等待時，其他通道先被服務的次數 */
+    uint32_t bypassed;
+
+    /* 統計：被協議模組以 SCMI_BUSY 拒絕、歸還額度的訊息數 */
+    uint32_t refunded;
+};
+
+/* 每個優先權等級的排程狀態 */
+struct scmi_channel_priority_band {
+    /* 本輪剩餘額度與每輪額度 */
+    unsigned int deficit;
+    unsigned int weight;
+
+    /* 這個等級的通道在 pending_mask 中的位元 */
+    uint32_t rank_mask;
+
+    /* 等級內下一個優先檢查的 rank (round robin) */
+    unsigned int cursor;
+};
+
+/* 模組上下文 */
+struct scmi_channel_priority_ctx {
+    struct scmi_channel_priority_dev_ctx *dev_ctx_table;
+    unsigned int channel_count;
+
+    /*
+     * 依優先權排序後的通道索引，rank 0 為最高優先權；
+     * pending_mask 的 bit n 對應 rank n，取最低位元即為下一個要服務的通道
+     */
+    unsigned int *rank_to_channel;
+    volatile uint32_t pending_mask;
+
+    struct scmi_channel_priority_band bands[SCMI_CHANNEL_PRIORITY_COUNT];
+
+    /* 是否已有 dispatch 事件在佇列中 */
+    bool dispatch_queued;
+
+    /* mod_scmi 的傳輸層介面 (signal_message) */
+    const struct mod_scmi_from_transport_api *scmi_api;
+};
+
+enum scmi_channel_priority_event_idx {
+    SCMI_CHANNEL_PRIORITY_EVENT_IDX_DISPATCH,
+    SCMI_CHANNEL_PRIORITY_EVENT_IDX_COUNT,
+};
+
+static const fwk_id_t scmi_channel_priority_event_dispatch =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_SCMI_CHANNEL_PRIORITY,
+                      SCMI_CHANNEL_PRIORITY_EVENT_IDX_DISPATCH);
+
+static struct scmi_channel_priority_ctx ch_prio_ctx;
+
+/* 排入一個 dispatch 事件給自己 (重複呼叫只會排一次) */
+static int scmi_channel_priority_queue_dispatch(void)
+{
+    struct fwk_event event = {
+        .source_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CHANNEL_PRIORITY),
+        .target_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_CHANNEL_PRIORITY),
+        .id = scmi_channel_priority_event_dispatch,
+    };
+
+    if (ch_prio_ctx.dispatch_queued)
+        return FWK_SUCCESS;
+
+    ch_prio_ctx.dispatch_queued = true;
+
+    return fwk_put_event(&event);
+}
+
+/*
+ * 傳輸層收到 doorbell 時呼叫 (取代直接呼叫 mod_scmi 的 signal_message)
+ * 只做標記，實際服務順序由 dispatch 決定
+ */
+static int scmi_channel_priority_signal(fwk_id_t channel_id)
+{
+    unsigned int channel_idx = fwk_id_get_element_idx(channel_id);
+    struct scmi_channel_priority_dev_ctx *dev_ctx;
+
+    if (channel_idx >= ch_prio_ctx.channel_count)
+        return FWK_E_PARAM;
+
+    dev_ctx = &ch_prio_ctx.dev_ctx_table[channel_idx];
+
+    fwk_interrupt_global_disable();
+    dev_ctx->pending = true;
+    ch_prio_ctx.pending_mask |= (1U << dev_ctx->rank);
+    fwk_interrupt_global_enable();
+
+    return scmi_channel_priority_queue_dispatch();
+}
+
+/* 提供給傳輸層模組的 API */
+static const struct mod_scmi_from_transport_api scmi_channel_priority_api = {
+    .signal_message = scmi_channel_priority_signal,
+};
+
+static inline struct scmi_channel_priority_dev_ctx *
+scmi_channel_priority_ctx_of_rank(unsigned int rank)
+{
+    return &ch_prio_ctx.dev_ctx_table[ch_prio_ctx.rank_to_channel[rank]];
+}
+
+/*
+ * 選出要服務的優先權等級
+ * 有訊息且有額度的等級中取最高優先權者；有訊息的等級額度都用完時，
+ * 所有等級補滿額度開始新的一輪 (不累積，閒置的等級不會存下額度)
+ */
+static struct scmi_channel_priority_band *
+scmi_channel_priority_pick_band(uint32_t mask)
+{
+    struct scmi_channel_priority_band *band;
+    unsigned int prio, pass;
+
+    for (pass = 0; pass < 2; pass++) {
+        for (prio = 0; prio < SCMI_CHANNEL_PRIORITY_COUNT; prio++) {
+            band = &ch_prio_ctx.bands[prio];
+            if ((mask & band->rank_mask) != 0 && band->deficit != 0)
+                return band;
+        }
+
+        for (prio = 0; prio < SCMI_CHANNEL_PRIORITY_COUNT; prio++)
+            ch_prio_ctx.bands[prio].deficit = ch_prio_ctx.bands[prio].weight;
+    }
+
+    return NULL;
+}
+
+/*
+ * 在等級內以 weight 輪流選出通道
+ * 從 cursor 開始找有訊息且有額度的通道；都用完時補滿這個等級
+ * 所有通道的額度
+ */
+static unsigned int scmi_channel_priority_pick_rank(
+    struct scmi_channel_priority_band *band, uint32_t mask)
+{
+    struct scmi_channel_priority_dev_ctx *dev_ctx;
+    uint32_t pending, candidates, ahead, ranks;
+    unsigned int rank, pass;
+
+    for (pass = 0; pass < 2; pass++) {
+        candidates = 0;
+        pending = mask & band->rank_mask;
+        while (pending != 0) {
+            rank = __builtin_ctz(pending);
+            pending &= pending - 1;
+            if (scmi_channel_priority_ctx_of_rank(rank)->deficit != 0)
+                candidates |= 1U << rank;
+        }
+
+        if (candidates != 0) {
+            /* cursor 之後 (含) 的第一個，沒有則繞回最前面 */
+            ahead = candidates & ~((1U << band->cursor) - 1);
+
+            return __builtin_ctz(ahead != 0 ? ahead : candidates);
+        }
+
+        ranks = band->rank_mask;
+        while (ranks != 0) {
+            rank = __builtin_ctz(ranks);
+            ranks &= ranks - 1;
+            dev_ctx = scmi_channel_priority_ctx_of_rank(rank);
+            dev_ctx->deficit = dev_ctx->weight;
+        }
+    }
+
+    /* 呼叫端保證 band 中有 pending 的通道，不會走到這裡 */
+    return __builtin_ctz(mask & band->rank_mask);
+}
+
+/*
+ * 依兩層 deficit round robin 服務一則訊息
+ * 處理完後若還有 pending 通道，重新排入 dispatch 事件，
+ * 讓新到的高優先權訊息有機會在下一次 dispatch 插隊
+ */
+static int scmi_channel_priority_dispatch(void)
+{
+    struct scmi_channel_priority_dev_ctx *dev_ctx;
+    struct scmi_channel_priority_band *band;
+    unsigned int rank, channel_idx, other;
+    uint32_t mask, waiting;
+    int status;
+
+    ch_prio_ctx.dispatch_queued = false;
+
+    /* pending_mask 也會在傳輸層 ISR 中修改，先取一份快照 */
+    fwk_interrupt_global_disable();
+    mask = ch_prio_ctx.pending_mask;
+    fwk_interrupt_global_enable();
+
+    if (mask == 0)
+        return FWK_SUCCESS;
+
+    band = scmi_channel_priority_pick_band(mask);
+    if (band == NULL)
+        return FWK_E_STATE;
+
+    rank = scmi_channel_priority_pick_rank(band, mask);
+    channel_idx = ch_prio_ctx.rank_to_channel[rank];
+    dev_ctx = &ch_prio_ctx.dev_ctx_table[channel_idx];
+
+    /* 快照之後 ISR 只會加入位元，清掉選中的通道即可 */
+    fwk_interrupt_global_disable();
+    ch_prio_ctx.pending_mask &= ~(1U << rank);
+    dev_ctx->pending = false;
+    fwk_interrupt_global_enable();
+
+    if (dev_ctx->deficit != 0)
+        dev_ctx->deficit--;
+    if (band->deficit != 0)
+        band->deficit--;
+
+    /* 下一次從等級內的下一個通道開始 */
+    band->cursor = rank + 1;
+    if (band->cursor >= 32 || (band->rank_mask >> band->cursor) == 0)
+        band->cursor = __builtin_ctz(band->rank_mask);
+
+    /* 統計其他等待中的通道 */
+    waiting = mask & ~(1U << rank);
+    while (waiting != 0) {
+        other = __builtin_ctz(waiting);
+        waiting &= waiting - 1;
+        scmi_channel_priority_ctx_of_rank(other)->bypassed++;
+    }
+
+    /* 轉送給 mod_scmi，最終進入 scmi_clock_message_handler() */
+    status = ch_prio_ctx.scmi_api->signal_message(dev_ctx->config->service_id);
+    if (status != FWK_SUCCESS) {
+        fwk_log_error("[SCMI Prio] Channel %u dispatch failed: %d",
+                      channel_idx, status);
+    } else {
+        dev_ctx->serviced++;
+    }
+
+    if (ch_prio_ctx.pending_mask != 0)
+        return scmi_channel_priority_queue_dispatch();
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 歸還一則訊息的額度 (MOD_SCMI_CHANNEL_PRIORITY_API_IDX_CREDIT)
+ * 協議模組以 SCMI_BUSY 拒絕剛轉送的訊息時呼叫：代理會退避重試，
+ * 這次轉送不應算進通道與等級的份額，否則流量限制中的通道會用掉
+ * 同等級其他通道的服務機會。額度不超過每輪額度
+ */
+static int scmi_channel_priority_refund(fwk_id_t service_id)
+{
+    struct scmi_channel_priority_dev_ctx *dev_ctx;
+    struct scmi_channel_priority_band *band;
+    unsigned int channel_idx;
+
+    for (channel_idx = 0; channel_idx < ch_prio_ctx.channel_count;
+         channel_idx++) {
+        dev_ctx = &ch_prio_ctx.dev_ctx_table[channel_idx];
+        if (!fwk_id_is_equal(dev_ctx->config->service_id, service_id))
+            continue;
+
+        band = &ch_prio_ctx.bands[dev_ctx->config->priority];
+        if (dev_ctx->deficit < dev_ctx->weight)
+            dev_ctx->deficit++;
+        if (band->deficit < band->weight)
+            band->deficit++;
+        dev_ctx->refunded++;
+
+        return FWK_SUCCESS;
+    }
+
+    return FWK_E_PARAM;
+}
+
+static const struct mod_scmi_channel_priority_credit_api
+    scmi_channel_priority_credit_api = {
+    .refund = scmi_channel_priority_refund,
+};
+
+/*
+ * 查詢通道統計 (除錯/效能分析用)
+ */
+static int scmi_channel_priority_get_stats(fwk_id_t channel_id,
+                                           uint32_t *serviced,
+                                           uint32_t *bypassed)
+{
+    unsigned int channel_idx = fwk_id_get_element_idx(channel_id);
+
+    if (channel_idx >= ch_prio_ctx.channel_count ||
+        serviced == NULL || bypassed == NULL)
+        return FWK_E_PARAM;
+
+    *serviced = ch_prio_ctx.dev_ctx_table[channel_idx].serviced;
+    *bypassed = ch_prio_ctx.dev_ctx_table[channel_idx].bypassed;
+
+    return FWK_SUCCESS;
+}
+
+static const struct mod_scmi_channel_priority_stats_api
+    scmi_channel_priority_stats_api = {
+    .get_stats = scmi_channel_priority_get_stats,
+};
+
+/*
+ * 模組初始化
+ */
+static int scmi_channel_priority_init(fwk_id_t module_id,
+                                      unsigned int element_count,
+                                      const void *data)
+{
+    const struct scmi_channel_priority_module_config *config = data;
+    const unsigned int *band_weight;
+    unsigned int prio;
+
+    /* pending_mask 以 32 位元表示 */
+    if (element_count == 0 || element_count > 32)
+        return FWK_E_PARAM;
+
+    band_weight = config != NULL ? config->band_weight :
+                                   scmi_channel_priority_default_band_weight;
+    for (prio = 0; prio < SCMI_CHANNEL_PRIORITY_COUNT; prio++) {
+        ch_prio_ctx.bands[prio].weight = FWK_MAX(band_weight[prio], 1U);
+        ch_prio_ctx.bands[prio].deficit = ch_prio_ctx.bands[prio].weight;
+    }
+
+    ch_prio_ctx.channel_count = element_count;
+    ch_prio_ctx.dev_ctx_table = fwk_mm_calloc(element_count,
+        sizeof(struct scmi_channel_priority_dev_ctx));
+    ch_prio_ctx.rank_to_channel = fwk_mm_calloc(element_count,
+                                                sizeof(unsigned int));
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_channel_priority_element_init(fwk_id_t element_id,
+                                              unsigned int sub_element_count,
+                                              const void *data)
+{
+    const struct scmi_channel_priority_config *config = data;
+    struct scmi_channel_priority_dev_ctx *dev_ctx;
+
+    if (config == NULL ||
+        config->priority >= SCMI_CHANNEL_PRIORITY_COUNT)
+        return FWK_E_PARAM;
+
+    dev_ctx = &ch_prio_ctx.dev_ctx_table[fwk_id_get_element_idx(element_id)];
+    dev_ctx->config = config;
+    dev_ctx->weight = FWK_MAX(config->weight, 1U);
+    dev_ctx->deficit = dev_ctx->weight;
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 所有 element 初始化後建立優先權排序表
+ * 同優先權的通道維持設定表中的順序，每個等級占連續的 rank
+ */
+static int scmi_channel_priority_post_init(fwk_id_t module_id)
+{
+    struct scmi_channel_priority_dev_ctx *dev_ctx;
+    struct scmi_channel_priority_band *band;
+    unsigned int prio, channel_idx, rank = 0;
+
+    for (prio = 0; prio < SCMI_CHANNEL_PRIORITY_COUNT; prio++) {
+        band = &ch_prio_ctx.bands[prio];
+        band->cursor = rank;
+
+        for (channel_idx = 0; channel_idx < ch_prio_ctx.channel_count;
+             channel_idx++) {
+            dev_ctx = &ch_prio_ctx.dev_ctx_table[channel_idx];
+            if (dev_ctx->config->priority != prio)
+                continue;
+
+            dev_ctx->rank = rank;
+            band->rank_mask |= 1U << rank;
+            ch_prio_ctx.rank_to_channel[rank++] = channel_idx;
+        }
+    }
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_channel_priority_bind(fwk_id_t id, unsigned int round)
+{
+    if (round == 1 || !fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    return fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_SCMI),
+                           FWK_ID_API(FWK_MODULE_IDX_SCMI,
+                                      MOD_SCMI_API_IDX_TRANSPORT),
+                           &ch_prio_ctx.scmi_api);
+}
+
+static int scmi_channel_priority_process_bind_request(fwk_id_t source_id,
+                                                      fwk_id_t target_id,
+                                                      fwk_id_t api_id,
+                                                      const void **api)
+{
+    switch (fwk_id_get_api_idx(api_id)) {
+    case MOD_SCMI_CHANNEL_PRIORITY_API_IDX_SIGNAL:
+        *api = &scmi_channel_priority_api;
+        break;
+
+    case MOD_SCMI_CHANNEL_PRIORITY_API_IDX_STATS:
+        *api = &scmi_channel_priority_stats_api;
+        break;
+
+    case MOD_SCMI_CHANNEL_PRIORITY_API_IDX_CREDIT:
+        *api = &scmi_channel_priority_credit_api;
+        break;
+
+    default:
+        return FWK_E_PARAM;
+    }
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_channel_priority_process_event(const struct fwk_event *event,
+                                               struct fwk_event *resp_event)
+{
+    if (fwk_id_is_equal(event->id, scmi_channel_priority_event_dispatch))
+        return scmi_channel_priority_dispatch();
+
+    return FWK_E_PARAM;
+}
+
+/* 模組描述符 */
+const struct fwk_module module_scmi_channel_priority = {
+    .name = "SCMI Channel Priority",
+    .type = FWK_MODULE_TYPE_SERVICE,
+    .api_count = MOD_SCMI_CHANNEL_PRIORITY_API_IDX_COUNT,
+    .event_count = SCMI_CHANNEL_PRIORITY_EVENT_IDX_COUNT,
+    .init = scmi_channel_priority_init,
+    .element_init = scmi_channel_priority_element_init,
+    .post_init = scmi_channel_priority_post_init,
+    .bind = scmi_channel_priority_bind,
+    .process_bind_request = scmi_channel_priority_process_bind_request,
+    .process_event = scmi_channel_priority_process_event,
+};
+
+/*
+ * 服務順序範例 (OSPM 代理有兩個通道；Linux SCMI core 每個協議一個通道，
+ * CPU DVFS 走 PERF 協議 protocol@13 自己的通道，其他協議共用預設通道)：
+ *
+ *   t0: NORMAL 通道收到 DESCRIBE_RATES    pending = {NORMAL}
+ *   t1: dispatch -> 服務 NORMAL
+ *   t2: NORMAL 通道收到 DISPLAY RATE_SET  pending = {NORMAL}
+ *   t3: HIGH   通道收到 PERF LEVEL_SET    pending = {HIGH, NORMAL}
+ *   t4: dispatch -> 服務 HIGH (NORMAL.bypassed++)
+ *   t5: dispatch -> 服務 NORMAL
+ *
+ * 沒有優先權時 t3 的 CPU 請求必須等 t2 的顯示時鐘處理完成。
+ *
+ * 通道每收到回應就立刻送下一則時 (例如 OSPM 一般通道大量
+ * DESCRIBE_RATES)，它在每次 dispatch 都是 pending；只取最高優先權的話
+ * LOW 的 TRUSTED 通道永遠輪不到。以預設額度 8:4:1，NORMAL 與 LOW
+ * 都有訊息時每 5 則服務 1 則 TRUSTED，HIGH 的 DVFS 請求仍在每輪
+ * 最前面。尾端延遲與持續灌訊息時的份額見 scmi_channel_priority_bench.c
+ */
@@ -0,0 +1,1323 @@
+/*
+ * SCP Firmware SCMI Performance Domain Handler Example
+ *
+ * 這個範例展示 SCP firmware 端如何實作 SCMI PERF 協議 (0x13)，
+ * 讓 Linux scmi-cpufreq 透過 perf_ops->freq_set / fast switch 調頻，
+ * 而不是直接對 CPU clock 送 CLOCK_RATE_SET。
+ *
+ * 與 CLOCK 協議的差異：
+ *   - Linux 看到的是 OPP level (索引)，每個 level 帶有電壓與功耗，
+ *     而不是任意頻率；SCP 只接受表中存在的 level
+ *   - 每個 level 的 PLL 設定 (multiplier/divider/post_div) 在 init 時
+ *     一次算好，LEVEL_SET 只是查表後把預先算好的值寫進 PLL，
+ *     SCP 端不需要任何除法或搜尋
+ *   - 提供 fast channel：Linux 直接把 level 索引寫進共享記憶體，
+ *     SCP 週期性檢查，不經過 mailbox 與 SCMI 訊息解析
+ *
+ * 每個 performance domain 是一個元素，對應 cpu_clock_config_table 中的一個 CPU PLL。
+ */
+
+#include <fwk_module.h>
+#include <fwk_element.h>
+#include <fwk_event.h>
+#include <fwk_id.h>
+#include <fwk_log.h>
+#include <fwk_macros.h>
+#include <fwk_mm.h>
+#include <fwk_module_idx.h>
+#include <fwk_status.h>
+#include <fwk_string.h>
+#include <mod_scmi.h>
+#include <mod_scmi_clock.h>
+#include <mod_timer.h>
+#include <mod_dvfs_transition.h>
+#include <mod_myplatform_clock.h>
+
+/* SCMI Performance 協議命令定義 */
+enum scmi_perf_command_id {
+    SCMI_PERF_PROTOCOL_VERSION = 0x0,
+    SCMI_PERF_PROTOCOL_ATTRIBUTES = 0x1,
+    SCMI_PERF_DOMAIN_ATTRIBUTES = 0x3,
+    SCMI_PERF_DESCRIBE_LEVELS = 0x4,
+    SCMI_PERF_LEVEL_SET = 0x7,
+    SCMI_PERF_LEVEL_GET = 0x8,
+    SCMI_PERF_DESCRIBE_FASTCHANNEL = 0xB,
+
+    /* 廠商擴充命令 */
+    SCMI_PERF_VENDOR_DESCRIBE_VOLTAGES = 0xC0,
+};
+
+/*
+ * 協議版本 4.0：DOMAIN_ATTRIBUTES 的 level indexing 位元與
+ * DESCRIBE_LEVELS 的 indicative_freq/level_index 欄位從 v4 開始定義，
+ * Linux 依版本決定是否解析這些欄位
+ */
+#define SCMI_PERF_PROTOCOL_VERSION_V4           0x40000
+
+/* PROTOCOL_ATTRIBUTES 屬性位元：power_cost 以 mW 表示 */
+#define SCMI_PERF_PROTOCOL_ATTR_POWER_MW        (1U << 16)
+
+/* DOMAIN_ATTRIBUTES 屬性位元 */
+#define SCMI_PERF_DOMAIN_ATTR_SET_LEVEL         (1U << 30)
+#define SCMI_PERF_DOMAIN_ATTR_FAST_CHANNEL      (1U << 27)
+#define SCMI_PERF_DOMAIN_ATTR_LEVEL_INDEXING    (1U << 25)
+
+/* DESCRIBE_FASTCHANNEL 屬性：bit[0] 為 0 表示沒有 doorbell，由 SCP 輪詢 */
+#define SCMI_PERF_FC_ATTR_DOORBELL              (1U << 0)
+
+/* DESCRIBE_LEVELS / DESCRIBE_VOLTAGES 單次回應的最大筆數 */
+#define SCMI_PERF_MAX_LEVELS_PER_MSG            16
+
+/* 每個 level 的 PLL 預設值搜尋範圍 */
+#define SCMI_PERF_MAX_PREDIV                    8
+
+/*
+ * 平台時鐘驅動的預設值 API
+ * (實際專案中應放在 mod_myplatform_clock.h，由 mod_myplatform_clock
+ *  與 mod_sw_pll 實作)
+ *
+ * apply_preset 直接寫入已算好的 PLL 設定，返回時 PLL 已 lock，
+ * 不經過 mod_clock 的頻率捨入與 PLL 參數搜尋
+ */
+struct mod_myplatform_clock_preset {
+    /* 套用後的輸出頻率 */
+    uint64_t rate;
+    struct myplatform_pll_config pll;
+};
+
+/* PLL 時序 (datasheet 數值)，由時鐘驅動提供 */
+struct mod_myplatform_clock_timing {
+    /* PLL relock 時間 */
+    uint32_t lock_time_ns;
+
+    /* 只切換輸出分頻器的時間 */
+    uint32_t div_switch_ns;
+
+    /* glitch-free mux 切換一次的延遲 */
+    uint32_t mux_latency_ns;
+};
+
+struct mod_myplatform_clock_preset_api {
+    int (*apply_preset)(fwk_id_t clock_id,
+                        const struct mod_myplatform_clock_preset *preset);
+
+    /* 時鐘所在 PLL 的時序，DVFS transition engine 據此排程 */
+    int (*get_timing)(fwk_id_t clock_id,
+                      struct mod_myplatform_clock_timing *timing);
+
+    /*
+     * 分段 relock (DVFS transition engine 使用)：
+     * begin_relock 將輸出 mux 到 REFCLK 並以新設定啟動 PLL，立即返回；
+     * 呼叫端等待 lock 時間 (可同時調整電壓) 後再呼叫 finish_relock
+     * 將 mux 切回 PLL 輸出。
+     * ping-pong 模式下 begin_relock 只讓閒置 PLL 開始 lock，輸出維持原頻率，
+     * finish_relock 才切換到閒置 PLL
+     */
+    int (*begin_relock)(fwk_id_t clock_id,
+                        const struct mod_myplatform_clock_preset *preset);
+    int (*finish_relock)(fwk_id_t clock_id);
+
+    /*
+     * 套用 preset 時 begin_relock 之後要等的 lock 時間：VCO 不變，
+     * 或 ping-pong 的閒置 PLL 已 lock 在目標 VCO 時為 0
+     */
+    int (*estimate_lock)(fwk_id_t clock_id,
+                         const struct mod_myplatform_clock_preset *preset,
+                         uint32_t *lock_time_ns);
+};
+
+/* OPP (Operating Performance Point) */
+struct mod_scmi_perf_opp {
+    /* 頻率 (Hz) */
+    uint64_t frequency;
+
+    /* 電壓 (mV) */
+    uint32_t voltage;
+
+    /* 功耗 (mW)，回報給 Linux energy model */
+    uint32_t power;
+};
+
+/* fast channel 在共享記憶體中的配置 (每個 domain 一組) */
+struct mod_scmi_perf_fast_channel {
+    /* Linux 寫入的目標 level 索引 */
+    volatile uint32_t level_set;
+
+    /* SCP 寫入的目前 level 索引 */
+    volatile uint32_t level_get;
+};
+
+/* Performance domain 元素設定 */
+struct mod_scmi_perf_domain_config {
+    /* 平台時鐘驅動元素 (mod_myplatform_clock / mod_sw_pll) */
+    fwk_id_t clock_id;
+
+    /* 對應的時鐘設定，用於取得參考頻率與合法範圍 */
+    const struct myplatform_clock_config *clock_config;
+
+    /* OPP 表，依頻率由低到高排列 */
+    const struct mod_scmi_perf_opp *opps;
+    unsigned int opp_count;
+
+    /* 開機時套用的 level 索引 */
+    unsigned int initial_level;
+
+    /* 一次 level 轉換的最壞延遲 (us)，回報給 cpufreq */
+    uint32_t transition_latency_us;
+
+    /* fast channel 位址，0 表示不提供 */
+    uintptr_t fast_channel_address;
+
+    /* 對應的 DVFS transition engine domain (有設定 dvfs_transition_api_id 時) */
+    fwk_id_t dvfs_domain_id;
+
+    /*
+     * 同一顆時鐘在 mod_clock 中的元素 (有設定 scmi_clock_notify_api_id 時)，
+     * level 變更後以此通知 SCMI Clock 模組
+     */
+    fwk_id_t clock_element_id;
+};
+
+/*
+ * 模組提供的 API 索引
+ * (實際專案中應放在 mod_scmi_perf.h)
+ */
+enum mod_scmi_perf_api_idx {
+    /* SCMI 模組使用的協議 API */
+    MOD_SCMI_PERF_API_IDX_PROTOCOL,
+
+    /* SCP 本地頻率上限 (scp_clock_cap.c) */
+    MOD_SCMI_PERF_API_IDX_CAP,
+
+    MOD_SCMI_PERF_API_IDX_COUNT,
+};
+
+/*
+ * 頻率上限 API：clock_cap 在事件中呼叫
+ * level 壓到頻率不超過 max_rate 的最高 OPP (至少保留最低一個)，
+ * 與 LEVEL_SET 一樣經過 DVFS engine，解除時先升壓再升頻；
+ * 代理要求的 level 保留，上限解除後恢復。max_rate 為 0 表示不限制
+ */
+struct mod_scmi_perf_cap_api {
+    int (*set_cap)(fwk_id_t domain_id, uint64_t max_rate);
+};
+
+/* 模組設定 */
+struct mod_scmi_perf_config {
+    /* 平台時鐘驅動的預設值 API */
+    fwk_id_t clock_preset_api_id;
+
+    /*
+     * DVFS transition engine API (scp_dvfs_transition.c)；
+     * 設定後 level 變更連同電壓一起交給 engine，否則只寫 PLL
+     */
+    fwk_id_t dvfs_transition_api_id;
+
+    /* fast channel 輪詢用的計時器 alarm */
+    fwk_id_t fast_channel_alarm_id;
+
+    /*
+     * SCMI Clock 的 notify API (scp_firmware_clock_handler.c，可選)；
+     * PERF 繞過 mod_clock 直接寫 PLL，設定後每次 level 變更都經此回報，
+     * 讓 CLOCK 協議的 RATE_CHANGED 通知與 STATE_SNAPSHOT generation 一致
+     */
+    fwk_id_t scmi_clock_notify_api_id;
+
+    /* fast channel 輪詢週期，同時作為回報給 Linux 的 rate limit */
+    uint32_t fast_channel_rate_limit_us;
+};
+
+/* PROTOCOL_ATTRIBUTES 回應結構 */
+struct scmi_perf_protocol_attributes_p2a {
+    int32_t status;
+    uint32_t attributes;
+    uint32_t statistics_address_low;
+    uint32_t statistics_address_high;
+    uint32_t statistics_len;
+};
+
+/* DOMAIN_ATTRIBUTES 回應結構 */
+struct scmi_perf_domain_attributes_p2a {
+    int32_t status;
+    uint32_t attributes;
+    uint32_t rate_limit;
+    uint32_t sustained_freq;
+    uint32_t sustained_perf_level;
+    char name[16];
+};
+
+/* DESCRIBE_LEVELS 命令結構 */
+struct scmi_perf_describe_levels_a2p {
+    uint32_t domain_id;
+    uint32_t level_index;
+};
+
+/* level indexing 模式下的 level 描述 */
+struct scmi_perf_level {
+    uint32_t performance_level;
+    uint32_t power_cost;
+    /* bits[15:0] 轉換延遲 (us) */
+    uint32_t attributes;
+    /* 頻率 (kHz) */
+    uint32_t indicative_freq;
+    uint32_t level_index;
+};
+
+struct scmi_perf_describe_levels_p2a {
+    int32_t status;
+    /* bits[11:0] 本次回傳數量，bits[31:16] 剩餘數量 */
+    uint32_t num_levels;
+    struct scmi_perf_level levels[SCMI_PERF_MAX_LEVELS_PER_MSG];
+};
+
+/* DESCRIBE_VOLTAGES 廠商命令：依 level 索引回傳電壓 (mV) */
+struct scmi_perf_describe_voltages_p2a {
+    int32_t status;
+    uint32_t num_levels;
+    uint32_t voltage[SCMI_PERF_MAX_LEVELS_PER_MSG];
+};
+
+/* LEVEL_SET 命令結構 */
+struct scmi_perf_level_set_a2p {
+    uint32_t domain_id;
+    uint32_t performance_level;
+};
+
+/* DESCRIBE_FASTCHANNEL 命令結構 */
+struct scmi_perf_describe_fc_a2p {
+    uint32_t domain_id;
+    uint32_t message_id;
+};
+
+struct scmi_perf_describe_fc_p2a {
+    int32_t status;
+    uint32_t attributes;
+    uint32_t rate_limit;
+    uint32_t chan_addr_low;
+    uint32_t chan_addr_high;
+    uint32_t chan_size;
+    uint32_t doorbell_addr_low;
+    uint32_t doorbell_addr_high;
+    uint32_t doorbell_set_mask_low;
+    uint32_t doorbell_set_mask_high;
+    uint32_t doorbell_preserve_mask_low;
+    uint32_t doorbell_preserve_mask_high;
+};
+
+/* 每個 domain 的執行狀態 */
+struct scmi_perf_domain_ctx {
+    const struct mod_scmi_perf_domain_config *config;
+
+    /* init 時預先算好的 PLL 設定，以 level 索引存取 */
+    struct mod_myplatform_clock_preset *presets;
+
+    /* 目前的 level 索引 */
+    unsigned int current_level;
+
+    /*
+     * 代理要求的 level 索引；實際套用的是受 cap_rate 限制後的 level
+     * (scmi_perf_effective_level())，與 current_level 相同表示沒有變更
+     */
+    unsigned int pending_level;
+
+    /* clock_cap 設定的頻率上限 (Hz)，0 表示不限制 */
+    uint64_t cap_rate;
+
+    /*
+     * 交給 DVFS engine、尚未完成的轉換 (NULL 表示沒有) 與其目標 level；
+     * 完成前 pending_level 可以再被改寫，完成後再送一次轉換
+     */
+    struct mod_dvfs_transition_target *dvfs_target;
+    unsigned int target_level;
+
+    /* 等待轉換完成才回應的 mailbox LEVEL_SET */
+    bool level_set_waiting;
+    fwk_id_t level_set_service_id;
+
+    /* fast channel (NULL 表示不提供) */
+    struct mod_scmi_perf_fast_channel *fast_channel;
+
+    /*
+     * 上一次輪詢看到的 fast channel level_set
+     * 只有 Linux 寫入新值才算請求；與 current_level 比較的話，
+     * mailbox LEVEL_SET 之後 fast channel 的舊值會把 level 改回去
+     */
+    uint32_t fast_channel_last_level;
+};
+
+/* Perf 模組上下文 */
+struct scmi_perf_ctx {
+    const struct mod_scmi_perf_config *config;
+
+    struct scmi_perf_domain_ctx *domain_ctx;
+    unsigned int domain_count;
+
+    /* SCMI 模組 API (用於回應) */
+    const struct mod_scmi_from_protocol_api *scmi_api;
+
+    /* 平台時鐘驅動的預設值 API */
+    const struct mod_myplatform_clock_preset_api *preset_api;
+
+    /* DVFS transition engine，以及批次轉換用的目標表 (每個 domain 一筆) */
+    const struct mod_dvfs_transition_api *dvfs_api;
+    struct mod_dvfs_transition_target *dvfs_targets;
+    bool dvfs_busy;
+
+    /* SCMI Clock 的頻率變更通知 (可為 NULL) */
+    const struct mod_scmi_clock_notify_api *clock_notify_api;
+
+    /* fast channel 輪詢計時器 */
+    const struct mod_timer_alarm_api *alarm_api;
+    bool fast_channel_poll_queued;
+};
+
+enum scmi_perf_event_idx {
+    SCMI_PERF_EVENT_IDX_FAST_CHANNEL_POLL,
+    SCMI_PERF_EVENT_IDX_COUNT,
+};
+
+static const fwk_id_t scmi_perf_event_fast_channel_poll =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_SCMI_PERF,
+                      SCMI_PERF_EVENT_IDX_FAST_CHANNEL_POLL);
+
+static struct scmi_perf_ctx scmi_perf_ctx;
+
+/*
+ * 為單一 OPP 算出 PLL 設定
+ * rate = ref_freq * multiplier / divider / post_div，
+ * 取能整除的最小 divider (PLL 比較頻率越高，抖動越小)
+ */
+static int scmi_perf_solve_preset(const struct myplatform_clock_config *clock,
+                                  uint64_t rate,
+                                  struct mod_myplatform_clock_preset *preset)
+{
+    uint64_t ref_freq = clock->pll_config.ref_freq;
+    uint32_t divider;
+
+    if (rate < clock->min_rate || rate > clock->max_rate)
+        return FWK_E_RANGE;
+
+    for (divider = 1; divider <= SCMI_PERF_MAX_PREDIV; divider++) {
+        if ((rate * divider) % ref_freq != 0)
+            continue;
+
+        preset->rate = rate;
+        preset->pll.ref_freq = clock->pll_config.ref_freq;
+        preset->pll.multiplier = (uint32_t)(rate * divider / ref_freq);
+        preset->pll.divider = divider;
+        preset->pll.post_div = 1;
+
+        return FWK_SUCCESS;
+    }
+
+    return FWK_E_RANGE;
+}
+
+/*
+ * level 生效後更新狀態與 fast channel，並告知 SCMI Clock
+ * (遞增 STATE_SNAPSHOT 的 generation；CPU 時鐘由 PERF 擁有，
+ * SCMI Clock 不會因此送出 CLOCK RATE_CHANGED)
+ */
+static void scmi_perf_level_applied(struct scmi_perf_domain_ctx *domain,
+                                    unsigned int level)
+{
+    domain->current_level = level;
+    if (domain->fast_channel != NULL)
+        domain->fast_channel->level_get = domain->current_level;
+
+    if (scmi_perf_ctx.clock_notify_api != NULL)
+        scmi_perf_ctx.clock_notify_api->rate_changed(
+            domain->config->clock_element_id,
+            domain->presets[domain->current_level].rate);
+}
+
+/*
+ * pending_level 受頻率上限限制後的 level：不超過 cap_rate 的最高 OPP，
+ * 至少保留最低一個；開機前 (pending_level 尚未設定) 原樣回傳
+ */
+static unsigned int scmi_perf_effective_level(
+    const struct scmi_perf_domain_ctx *domain)
+{
+    unsigned int level = domain->pending_level;
+
+    if (domain->cap_rate == 0 || level >= domain->config->opp_count)
+        return level;
+
+    while (level > 0 &&
+           domain->config->opps[level].frequency > domain->cap_rate)
+        level--;
+
+    return level;
+}
+
+/*
+ * 套用所有 domain 的 pending_level (受上限限制)，只做查表，不做任何計算
+ * 有 DVFS engine 時所有變更合併成一次轉換，由 engine 安排電壓與 PLL 的順序，
+ * 回傳 FWK_PENDING，結果在 scmi_perf_dvfs_done() 依各 domain 實際到達的
+ * level 更新；engine 忙碌時變更留在 pending_level，該次轉換完成後再送。
+ * 沒有 engine 時逐一寫入 PLL，失敗的代理要求 pending_level 還原為 current_level
+ */
+static int scmi_perf_commit_levels(void)
+{
+    struct scmi_perf_domain_ctx *domain;
+    struct mod_dvfs_transition_target *target;
+    unsigned int domain_id, level, count = 0;
+    int status = FWK_SUCCESS, domain_status;
+
+    if (scmi_perf_ctx.dvfs_busy)
+        return FWK_PENDING;
+
+    for (domain_id = 0; domain_id < scmi_perf_ctx.domain_count; domain_id++) {
+        domain = &scmi_perf_ctx.domain_ctx[domain_id];
+        level = scmi_perf_effective_level(domain);
+        if (level == domain->current_level)
+            continue;
+
+        if (scmi_perf_ctx.dvfs_api != NULL) {
+            target = &scmi_perf_ctx.dvfs_targets[count++];
+            target->domain_id = domain->config->dvfs_domain_id;
+            target->preset = &domain->presets[level];
+            target->voltage = domain->config->opps[level].voltage;
+            domain->dvfs_target = target;
+            domain->target_level = level;
+            continue;
+        }
+
+        domain_status = scmi_perf_ctx.preset_api->apply_preset(
+            domain->config->clock_id, &domain->presets[level]);
+        if (domain_status == FWK_SUCCESS) {
+            scmi_perf_level_applied(domain, level);
+        } else {
+            if (domain->pending_level == level)
+                domain->pending_level = domain->current_level;
+            status = domain_status;
+        }
+    }
+
+    if (count == 0)
+        return status;
+
+    status = scmi_perf_ctx.dvfs_api->transition(
+        FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_PERF), scmi_perf_ctx.dvfs_targets,
+        count, NULL);
+    if (status == FWK_PENDING) {
+        scmi_perf_ctx.dvfs_busy = true;
+        return FWK_PENDING;
+    }
+
+    /* engine 沒有執行任何操作 */
+    for (domain_id = 0; domain_id < scmi_perf_ctx.domain_count; domain_id++) {
+        domain = &scmi_perf_ctx.domain_ctx[domain_id];
+        if (domain->dvfs_target == NULL)
+            continue;
+
+        domain->dvfs_target = NULL;
+        if (domain->pending_level == domain->target_level)
+            domain->pending_level = domain->current_level;
+    }
+
+    return status;
+}
+
+
+/* 將 FWK 錯誤碼轉換為 SCMI 狀態碼 */
+static int32_t scmi_perf_status_to_scmi(int status)
+{
+    switch (status) {
+    case FWK_SUCCESS:
+        return SCMI_SUCCESS;
+    case FWK_E_RANGE:
+        return SCMI_OUT_OF_RANGE;
+    case FWK_E_BUSY:
+        return SCMI_BUSY;
+    case FWK_E_SUPPORT:
+        return SCMI_NOT_SUPPORTED;
+    default:
+        return SCMI_GENERIC_ERROR;
+    }
+}
+
+/* 回應等待中的 mailbox LEVEL_SET */
+static void scmi_perf_level_set_respond(struct scmi_perf_domain_ctx *domain,
+                                        int status)
+{
+    struct {
+        int32_t status;
+    } return_values = { scmi_perf_status_to_scmi(status) };
+
+    domain->level_set_waiting = false;
+    scmi_perf_ctx.scmi_api->respond(domain->level_set_service_id,
+                                   &return_values, sizeof(return_values));
+}
+
+/*
+ * DVFS engine 完成一次轉換
+ * 只有 engine 回報到達目標的 domain 更新 current_level，其餘維持原本的
+ * level (若沒有更新的請求，pending_level 一併還原)；
+ * 轉換期間累積的新請求接著送出
+ */
+static int scmi_perf_dvfs_done(const struct fwk_event *event)
+{
+    const struct mod_dvfs_transition_resp_params *params =
+        (const struct mod_dvfs_transition_resp_params *)event->params;
+    struct scmi_perf_domain_ctx *domain;
+    unsigned int domain_id;
+    int status;
+
+    scmi_perf_ctx.dvfs_busy = false;
+
+    for (domain_id = 0; domain_id < scmi_perf_ctx.domain_count; domain_id++) {
+        domain = &scmi_perf_ctx.domain_ctx[domain_id];
+        if (domain->dvfs_target == NULL)
+            continue;
+
+        status = domain->dvfs_target->status;
+        domain->dvfs_target = NULL;
+
+        if (status == FWK_SUCCESS) {
+            scmi_perf_level_applied(domain, domain->target_level);
+        } else {
+            fwk_log_error("[SCMI Perf] Domain %u level %u failed: %d",
+                          domain_id, domain->target_level, status);
+            if (domain->pending_level == domain->target_level)
+                domain->pending_level = domain->current_level;
+        }
+
+        if (domain->level_set_waiting &&
+            (status != FWK_SUCCESS ||
+             scmi_perf_effective_level(domain) == domain->current_level))
+            scmi_perf_level_set_respond(domain, status);
+    }
+
+    if (params->status != FWK_SUCCESS)
+        fwk_log_error("[SCMI Perf] DVFS transition failed: %d",
+                      params->status);
+
+    status = scmi_perf_commit_levels();
+    if (status != FWK_SUCCESS && status != FWK_PENDING)
+        fwk_log_error("[SCMI Perf] Level change failed: %d", status);
+
+    return FWK_SUCCESS;
+}
+
+static struct scmi_perf_domain_ctx *scmi_perf_get_domain(uint32_t domain_id)
+{
+    if (domain_id >= scmi_perf_ctx.domain_count)
+        return NULL;
+
+    return &scmi_perf_ctx.domain_ctx[domain_id];
+}
+
+/*
+ * 處理 PROTOCOL_VERSION 命令
+ */
+static int scmi_perf_protocol_version_handler(fwk_id_t service_id,
+                                              const uint32_t *payload)
+{
+    struct {
+        int32_t status;
+        uint32_t version;
+    } return_values = {
+        .status = SCMI_SUCCESS,
+        .version = SCMI_PERF_PROTOCOL_VERSION_V4,
+    };
+
+    scmi_perf_ctx.scmi_api->respond(service_id, &return_values,
+                                   sizeof(return_values));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 PROTOCOL_ATTRIBUTES 命令
+ * OPP 表的 power 欄位以 mW 表示，bit[16] 讓 Linux energy model 據此換算
+ */
+static int scmi_perf_protocol_attributes_handler(fwk_id_t service_id,
+                                                 const uint32_t *payload)
+{
+    struct scmi_perf_protocol_attributes_p2a return_values = {
+        .status = SCMI_SUCCESS,
+        .attributes = SCMI_PERF_PROTOCOL_ATTR_POWER_MW |
+                      (scmi_perf_ctx.domain_count & 0xFFFF),
+    };
+
+    scmi_perf_ctx.scmi_api->respond(service_id, &return_values,
+                                   sizeof(return_values));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 DOMAIN_ATTRIBUTES 命令
+ */
+static int scmi_perf_domain_attributes_handler(fwk_id_t service_id,
+                                               const uint32_t *payload)
+{
+    struct scmi_perf_domain_attributes_p2a return_values = { 0 };
+    struct scmi_perf_domain_ctx *domain;
+    const struct mod_scmi_perf_opp *top;
+    uint32_t domain_id = *payload;
+
+    domain = scmi_perf_get_domain(domain_id);
+    if (domain == NULL) {
+        return_values.status = SCMI_NOT_FOUND;
+        goto exit;
+    }
+
+    return_values.attributes = SCMI_PERF_DOMAIN_ATTR_SET_LEVEL |
+                               SCMI_PERF_DOMAIN_ATTR_LEVEL_INDEXING;
+    if (domain->fast_channel != NULL)
+        return_values.attributes |= SCMI_PERF_DOMAIN_ATTR_FAST_CHANNEL;
+
+    return_values.rate_limit = scmi_perf_ctx.config->fast_channel_rate_limit_us;
+
+    /* 最高 OPP 即為可持續的頻率 */
+    top = &domain->config->opps[domain->config->opp_count - 1];
+    return_values.sustained_freq = (uint32_t)(top->frequency / FWK_KHZ);
+    return_values.sustained_perf_level = domain->config->opp_count - 1;
+
+    fwk_str_strncpy(return_values.name,
+                    fwk_module_get_element_name(
+                        FWK_ID_ELEMENT(FWK_MODULE_IDX_SCMI_PERF, domain_id)),
+                    sizeof(return_values.name) - 1);
+
+    return_values.status = SCMI_SUCCESS;
+
+exit:
+    scmi_perf_ctx.scmi_api->respond(service_id, &return_values,
+                                   (return_values.status == SCMI_SUCCESS) ?
+                                   sizeof(return_values) :
+                                   sizeof(return_values.status));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 DESCRIBE_LEVELS 命令
+ * level indexing 模式：performance_level 即為索引，另附頻率 (kHz)
+ */
+static int scmi_perf_describe_levels_handler(fwk_id_t service_id,
+                                             const uint32_t *payload)
+{
+    const struct scmi_perf_describe_levels_a2p *parameters =
+        (const struct scmi_perf_describe_levels_a2p *)payload;
+    struct scmi_perf_describe_levels_p2a return_values = { 0 };
+    struct scmi_perf_domain_ctx *domain;
+    const struct mod_scmi_perf_opp *opp;
+    unsigned int count = 0, remaining, i, level;
+
+    domain = scmi_perf_get_domain(parameters->domain_id);
+    if (domain == NULL) {
+        return_values.status = SCMI_NOT_FOUND;
+        goto exit;
+    }
+
+    if (parameters->level_index >= domain->config->opp_count) {
+        return_values.status = SCMI_INVALID_PARAMETERS;
+        goto exit;
+    }
+
+    remaining = domain->config->opp_count - parameters->level_index;
+    count = FWK_MIN(remaining, SCMI_PERF_MAX_LEVELS_PER_MSG);
+
+    for (i = 0; i < count; i++) {
+        level = parameters->level_index + i;
+        opp = &domain->config->opps[level];
+
+        return_values.levels[i].performance_level = level;
+        return_values.levels[i].power_cost = opp->power;
+        return_values.levels[i].attributes =
+            domain->config->transition_latency_us & 0xFFFF;
+        return_values.levels[i].indicative_freq =
+            (uint32_t)(opp->frequency / FWK_KHZ);
+        return_values.levels[i].level_index = level;
+    }
+
+    return_values.num_levels = ((remaining - count) << 16) | count;
+    return_values.status = SCMI_SUCCESS;
+
+exit:
+    scmi_perf_ctx.scmi_api->respond(service_id, &return_values,
+        (return_values.status == SCMI_SUCCESS) ?
+        sizeof(return_values.status) + sizeof(return_values.num_levels) +
+            count * sizeof(return_values.levels[0]) :
+        sizeof(return_values.status));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 DESCRIBE_VOLTAGES 廠商命令
+ * 與 DESCRIBE_LEVELS 相同的分頁方式，回傳每個 level 的電壓
+ */
+static int scmi_perf_describe_voltages_handler(fwk_id_t service_id,
+                                               const uint32_t *payload)
+{
+    const struct scmi_perf_describe_levels_a2p *parameters =
+        (const struct scmi_perf_describe_levels_a2p *)payload;
+    struct scmi_perf_describe_voltages_p2a return_values = { 0 };
+    struct scmi_perf_domain_ctx *domain;
+    unsigned int count = 0, remaining, i;
+
+    domain = scmi_perf_get_domain(parameters->domain_id);
+    if (domain == NULL) {
+        return_values.status = SCMI_NOT_FOUND;
+        goto exit;
+    }
+
+    if (parameters->level_index >= domain->config->opp_count) {
+        return_values.status = SCMI_INVALID_PARAMETERS;
+        goto exit;
+    }
+
+    remaining = domain->config->opp_count - parameters->level_index;
+    count = FWK_MIN(remaining, SCMI_PERF_MAX_LEVELS_PER_MSG);
+
+    for (i = 0; i < count; i++) {
+        return_values.voltage[i] =
+            domain->config->opps[parameters->level_index + i].voltage;
+    }
+
+    return_values.num_levels = ((remaining - count) << 16) | count;
+    return_values.status = SCMI_SUCCESS;
+
+exit:
+    scmi_perf_ctx.scmi_api->respond(service_id, &return_values,
+        (return_values.status == SCMI_SUCCESS) ?
+        sizeof(return_values.status) + sizeof(return_values.num_levels) +
+            count * sizeof(return_values.voltage[0]) :
+        sizeof(return_values.status));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 LEVEL_SET 命令
+ * performance_level 為 level 索引；經 DVFS engine 時在轉換完成後才回應，
+ * 同一個 domain 同時只接受一個等待中的 LEVEL_SET
+ */
+static int scmi_perf_level_set_handler(fwk_id_t service_id,
+                                       const uint32_t *payload)
+{
+    const struct scmi_perf_level_set_a2p *parameters =
+        (const struct scmi_perf_level_set_a2p *)payload;
+    struct scmi_perf_domain_ctx *domain;
+    int status;
+
+    struct {
+        int32_t status;
+    } return_values;
+
+    domain = scmi_perf_get_domain(parameters->domain_id);
+    if (domain == NULL) {
+        return_values.status = SCMI_NOT_FOUND;
+        goto exit;
+    }
+
+    if (parameters->performance_level >= domain->config->opp_count) {
+        return_values.status = SCMI_OUT_OF_RANGE;
+        goto exit;
+    }
+
+    if (domain->level_set_waiting) {
+        return_values.status = SCMI_BUSY;
+        goto exit;
+    }
+
+    /* 受上限限制時以限制後的 level 生效即算完成 */
+    domain->pending_level = parameters->performance_level;
+    if (scmi_perf_effective_level(domain) == domain->current_level &&
+        domain->dvfs_target == NULL) {
+        return_values.status = SCMI_SUCCESS;
+        goto exit;
+    }
+
+    status = scmi_perf_commit_levels();
+    if (status == FWK_PENDING) {
+        domain->level_set_waiting = true;
+        domain->level_set_service_id = service_id;
+        return FWK_SUCCESS;
+    }
+
+    if (status != FWK_SUCCESS) {
+        fwk_log_error("[SCMI Perf] Failed to set domain %u level %u: %d",
+                      parameters->domain_id, parameters->performance_level,
+                      status);
+    }
+
+    return_values.status = scmi_perf_status_to_scmi(status);
+
+exit:
+    scmi_perf_ctx.scmi_api->respond(service_id, &return_values,
+                                   sizeof(return_values));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 LEVEL_GET 命令
+ */
+static int scmi_perf_level_get_handler(fwk_id_t service_id,
+                                       const uint32_t *payload)
+{
+    struct scmi_perf_domain_ctx *domain;
+
+    struct {
+        int32_t status;
+        uint32_t performance_level;
+    } return_values = { 0 };
+
+    domain = scmi_perf_get_domain(*payload);
+    if (domain == NULL) {
+        return_values.status = SCMI_NOT_FOUND;
+        goto exit;
+    }
+
+    return_values.status = SCMI_SUCCESS;
+    return_values.performance_level = domain->current_level;
+
+exit:
+    scmi_perf_ctx.scmi_api->respond(service_id, &return_values,
+                                   (return_values.status == SCMI_SUCCESS) ?
+                                   sizeof(return_values) :
+                                   sizeof(return_values.status));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 處理 DESCRIBE_FASTCHANNEL 命令
+ * LEVEL_SET 與 LEVEL_GET 共用同一塊 fast channel，各佔一個 32-bit 欄位
+ */
+static int scmi_perf_describe_fast_channel_handler(fwk_id_t service_id,
+                                                   const uint32_t *payload)
+{
+    const struct scmi_perf_describe_fc_a2p *parameters =
+        (const struct scmi_perf_describe_fc_a2p *)payload;
+    struct scmi_perf_describe_fc_p2a return_values = { 0 };
+    struct scmi_perf_domain_ctx *domain;
+    uintptr_t address;
+
+    domain = scmi_perf_get_domain(parameters->domain_id);
+    if (domain == NULL) {
+        return_values.status = SCMI_NOT_FOUND;
+        goto exit;
+    }
+
+    if (domain->fast_channel == NULL) {
+        return_values.status = SCMI_NOT_SUPPORTED;
+        goto exit;
+    }
+
+    switch (parameters->message_id) {
+    case SCMI_PERF_LEVEL_SET:
+        address = (uintptr_t)&domain->fast_channel->level_set;
+        break;
+
+    case SCMI_PERF_LEVEL_GET:
+        address = (uintptr_t)&domain->fast_channel->level_get;
+        break;
+
+    default:
+        return_values.status = SCMI_NOT_SUPPORTED;
+        goto exit;
+    }
+
+    /* 沒有 doorbell：SCP 以 rate_limit 週期輪詢 */
+    return_values.attributes = 0;
+    return_values.rate_limit = scmi_perf_ctx.config->fast_channel_rate_limit_us;
+    return_values.chan_addr_low = (uint32_t)((uint64_t)address & 0xFFFFFFFF);
+    return_values.chan_addr_high = (uint32_t)((uint64_t)address >> 32);
+    return_values.chan_size = sizeof(uint32_t);
+    return_values.status = SCMI_SUCCESS;
+
+exit:
+    scmi_perf_ctx.scmi_api->respond(service_id, &return_values,
+                                   (return_values.status == SCMI_SUCCESS) ?
+                                   sizeof(return_values) :
+                                   sizeof(return_values.status));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * SCMI Perf 協議訊息處理器
+ */
+static int scmi_perf_message_handler(fwk_id_t protocol_id,
+                                     fwk_id_t service_id,
+                                     const uint32_t *payload,
+                                     size_t payload_size,
+                                     unsigned int message_id)
+{
+    int status = FWK_SUCCESS;
+
+    fwk_log_debug("[SCMI Perf] Received message ID: 0x%x", message_id);
+
+    switch (message_id) {
+    case SCMI_PERF_PROTOCOL_VERSION:
+        status = scmi_perf_protocol_version_handler(service_id, payload);
+        break;
+
+    case SCMI_PERF_PROTOCOL_ATTRIBUTES:
+        status = scmi_perf_protocol_attributes_handler(service_id, payload);
+        break;
+
+    case SCMI_PERF_DOMAIN_ATTRIBUTES:
+        status = scmi_perf_domain_attributes_handler(service_id, payload);
+        break;
+
+    case SCMI_PERF_DESCRIBE_LEVELS:
+        status = scmi_perf_describe_levels_handler(service_id, payload);
+        break;
+
+    case SCMI_PERF_LEVEL_SET:
+        status = scmi_perf_level_set_handler(service_id, payload);
+        break;
+
+    case SCMI_PERF_LEVEL_GET:
+        status = scmi_perf_level_get_handler(service_id, payload);
+        break;
+
+    case SCMI_PERF_DESCRIBE_FASTCHANNEL:
+        status = scmi_perf_describe_fast_channel_handler(service_id, payload);
+        break;
+
+    case SCMI_PERF_VENDOR_DESCRIBE_VOLTAGES:
+        status = scmi_perf_describe_voltages_handler(service_id, payload);
+        break;
+
+    default:
+        fwk_log_error("[SCMI Perf] Unsupported message ID: 0x%x", message_id);
+
+        struct {
+            int32_t status;
+        } error_response = { SCMI_NOT_SUPPORTED };
+
+        scmi_perf_ctx.scmi_api->respond(service_id, &error_response,
+                                       sizeof(error_response));
+        break;
+    }
+
+    return status;
+}
+
+static int scmi_perf_get_scmi_protocol_id(fwk_id_t protocol_id,
+                                          uint8_t *scmi_protocol_id)
+{
+    *scmi_protocol_id = MOD_SCMI_PROTOCOL_ID_PERF;
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * Fast channel 輪詢
+ * alarm callback 在中斷環境執行，只排入事件，實際處理在事件迴圈中進行
+ */
+static void scmi_perf_fast_channel_alarm_callback(uintptr_t param)
+{
+    struct fwk_event event = {
+        .source_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_PERF),
+        .target_id = FWK_ID_MODULE(FWK_MODULE_IDX_SCMI_PERF),
+        .id = scmi_perf_event_fast_channel_poll,
+    };
+
+    if (scmi_perf_ctx.fast_channel_poll_queued)
+        return;
+
+    if (fwk_put_event(&event) == FWK_SUCCESS)
+        scmi_perf_ctx.fast_channel_poll_queued = true;
+}
+
+static int scmi_perf_fast_channel_poll(void)
+{
+    struct scmi_perf_domain_ctx *domain;
+    unsigned int domain_id, level;
+    int status;
+
+    scmi_perf_ctx.fast_channel_poll_queued = false;
+
+    /* 同一週期內所有 domain 的變更合併成一次轉換 */
+    for (domain_id = 0; domain_id < scmi_perf_ctx.domain_count; domain_id++) {
+        domain = &scmi_perf_ctx.domain_ctx[domain_id];
+        if (domain->fast_channel == NULL)
+            continue;
+
+        level = domain->fast_channel->level_set;
+        if (level == domain->fast_channel_last_level)
+            continue;
+        domain->fast_channel_last_level = level;
+
+        /* 非法索引直接忽略，fast channel 沒有回應可以報錯 */
+        if (level >= domain->config->opp_count)
+            continue;
+
+        domain->pending_level = level;
+    }
+
+    status = scmi_perf_commit_levels();
+    if (status != FWK_SUCCESS && status != FWK_PENDING)
+        fwk_log_error("[SCMI Perf] Fast channel level change failed: %d",
+                      status);
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * clock_cap 設定頻率上限 (在 clock_cap 的事件中呼叫)
+ * 與 LEVEL_SET 共用 commit 路徑；DVFS engine 忙碌時在該次轉換完成後生效
+ */
+static int scmi_perf_set_cap(fwk_id_t domain_id, uint64_t max_rate)
+{
+    struct scmi_perf_domain_ctx *domain;
+    int status;
+
+    domain = scmi_perf_get_domain(fwk_id_get_element_idx(domain_id));
+    if (domain == NULL)
+        return FWK_E_PARAM;
+
+    if (domain->cap_rate == max_rate)
+        return FWK_SUCCESS;
+    domain->cap_rate = max_rate;
+
+    status = scmi_perf_commit_levels();
+    if (status == FWK_PENDING)
+        return FWK_SUCCESS;
+
+    return status;
+}
+
+/*
+ * 模組初始化
+ */
+static int scmi_perf_init(fwk_id_t module_id,
+                          unsigned int element_count,
+                          const void *data)
+{
+    const struct mod_scmi_perf_config *config = data;
+
+    if (config == NULL || element_count == 0)
+        return FWK_E_PARAM;
+
+    scmi_perf_ctx.config = config;
+    scmi_perf_ctx.domain_count = element_count;
+    scmi_perf_ctx.domain_ctx = fwk_mm_calloc(element_count,
+                                             sizeof(struct scmi_perf_domain_ctx));
+    scmi_perf_ctx.dvfs_targets = fwk_mm_calloc(element_count,
+        sizeof(struct mod_dvfs_transition_target));
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 元素初始化
+ * 所有 level 的 PLL 設定在這裡一次算好；算不出整數設定的 OPP 視為配置錯誤
+ */
+static int scmi_perf_element_init(fwk_id_t element_id,
+                                  unsigned int sub_element_count,
+                                  const void *data)
+{
+    const struct mod_scmi_perf_domain_config *config = data;
+    struct scmi_perf_domain_ctx *domain;
+    unsigned int level;
+    int status;
+
+    if (config == NULL || config->opp_count == 0 ||
+        config->initial_level >= config->opp_count)
+        return FWK_E_PARAM;
+
+    domain = &scmi_perf_ctx.domain_ctx[fwk_id_get_element_idx(element_id)];
+    domain->config = config;
+    domain->presets = fwk_mm_calloc(config->opp_count,
+                                    sizeof(struct mod_myplatform_clock_preset));
+
+    for (level = 0; level < config->opp_count; level++) {
+        status = scmi_perf_solve_preset(config->clock_config,
+                                        config->opps[level].frequency,
+                                        &domain->presets[level]);
+        if (status != FWK_SUCCESS) {
+            fwk_log_error("[SCMI Perf] %s: no PLL setting for %llu Hz",
+                          fwk_module_get_element_name(element_id),
+                          config->opps[level].frequency);
+            return status;
+        }
+    }
+
+    /* 開機時的 level 尚未套用，start 時才寫入 PLL */
+    domain->current_level = config->opp_count;
+    domain->pending_level = config->opp_count;
+
+    if (config->fast_channel_address != 0) {
+        domain->fast_channel =
+            (struct mod_scmi_perf_fast_channel *)config->fast_channel_address;
+        domain->fast_channel->level_set = config->initial_level;
+        domain->fast_channel->level_get = config->initial_level;
+        domain->fast_channel_last_level = config->initial_level;
+    }
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 綁定其他模組的 API
+ */
+static int scmi_perf_bind(fwk_id_t id, unsigned int round)
+{
+    int status;
+
+    if (round == 1 || !fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    /* 綁定 SCMI 模組 API */
+    status = fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_SCMI),
+                            FWK_ID_API(FWK_MODULE_IDX_SCMI,
+                                      MOD_SCMI_API_IDX_PROTOCOL),
+                            &scmi_perf_ctx.scmi_api);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    /* 綁定平台時鐘驅動的預設值 API */
+    status = fwk_module_bind(
+        fwk_id_build_module_id(scmi_perf_ctx.config->clock_preset_api_id),
+        scmi_perf_ctx.config->clock_preset_api_id,
+        &scmi_perf_ctx.preset_api);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    /* 綁定 DVFS transition engine (可選) */
+    if (fwk_id_is_type(scmi_perf_ctx.config->dvfs_transition_api_id,
+                       FWK_ID_TYPE_API)) {
+        status = fwk_module_bind(
+            fwk_id_build_module_id(scmi_perf_ctx.config->dvfs_transition_api_id),
+            scmi_perf_ctx.config->dvfs_transition_api_id,
+            &scmi_perf_ctx.dvfs_api);
+        if (status != FWK_SUCCESS)
+            return status;
+    }
+
+    /* 綁定 SCMI Clock 的 notify API (可選) */
+    if (fwk_id_is_type(scmi_perf_ctx.config->scmi_clock_notify_api_id,
+                       FWK_ID_TYPE_API)) {
+        status = fwk_module_bind(
+            fwk_id_build_module_id(scmi_perf_ctx.config->scmi_clock_notify_api_id),
+            scmi_perf_ctx.config->scmi_clock_notify_api_id,
+            &scmi_perf_ctx.clock_notify_api);
+        if (status != FWK_SUCCESS)
+            return status;
+    }
+
+    /* 綁定 fast channel 輪詢計時器 */
+    if (fwk_id_is_equal(scmi_perf_ctx.config->fast_channel_alarm_id,
+                        FWK_ID_NONE))
+        return FWK_SUCCESS;
+
+    return fwk_module_bind(scmi_perf_ctx.config->fast_channel_alarm_id,
+                           MOD_TIMER_API_ID_ALARM,
+                           &scmi_perf_ctx.alarm_api);
+}
+
+/*
+ * 模組啟動：套用各 domain 的初始 level，並開始輪詢 fast channel
+ */
+static int scmi_perf_start(fwk_id_t id)
+{
+    struct scmi_perf_domain_ctx *domain;
+    unsigned int domain_id;
+    int status;
+
+    if (!fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    for (domain_id = 0; domain_id < scmi_perf_ctx.domain_count; domain_id++) {
+        domain = &scmi_perf_ctx.domain_ctx[domain_id];
+        domain->pending_level = domain->config->initial_level;
+    }
+
+    status = scmi_perf_commit_levels();
+    if (status != FWK_SUCCESS && status != FWK_PENDING)
+        fwk_log_error("[SCMI Perf] Initial levels failed: %d", status);
+
+    if (scmi_perf_ctx.alarm_api == NULL)
+        return FWK_SUCCESS;
+
+    return scmi_perf_ctx.alarm_api->start(
+        scmi_perf_ctx.config->fast_channel_alarm_id,
+        FWK_MAX(scmi_perf_ctx.config->fast_channel_rate_limit_us / 1000, 1U),
+        MOD_TIMER_ALARM_TYPE_PERIODIC,
+        scmi_perf_fast_channel_alarm_callback,
+        0);
+}
+
+static int scmi_perf_process_event(const struct fwk_event *event,
+                                   struct fwk_event *resp_event)
+{
+    if (fwk_id_is_equal(event->id, scmi_perf_event_fast_channel_poll))
+        return scmi_perf_fast_channel_poll();
+
+    if (fwk_id_is_equal(event->id, mod_dvfs_transition_event_id_done))
+        return scmi_perf_dvfs_done(event);
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_perf_process_bind_request(fwk_id_t source_id,
+                                          fwk_id_t target_id,
+                                          fwk_id_t api_id,
+                                          const void **api)
+{
+    /* 提供 SCMI Perf 協議 API 給 SCMI 模組 */
+    static const struct mod_scmi_to_protocol_api scmi_perf_protocol_api = {
+        .get_scmi_protocol_id = scmi_perf_get_scmi_protocol_id,
+        .message_handler = scmi_perf_message_handler,
+    };
+
+    /* 提供頻率上限 API 給 clock_cap */
+    static const struct mod_scmi_perf_cap_api scmi_perf_cap_api = {
+        .set_cap = scmi_perf_set_cap,
+    };
+
+    switch (fwk_id_get_api_idx(api_id)) {
+    case MOD_SCMI_PERF_API_IDX_PROTOCOL:
+        *api = &scmi_perf_protocol_api;
+        break;
+
+    case MOD_SCMI_PERF_API_IDX_CAP:
+        *api = &scmi_perf_cap_api;
+        break;
+
+    default:
+        return FWK_E_PARAM;
+    }
+
+    return FWK_SUCCESS;
+}
+
+/* 模組描述符 */
+const struct fwk_module module_scmi_perf = {
+    .name = "SCMI Performance Domain Management Protocol",
+    .api_count = MOD_SCMI_PERF_API_IDX_COUNT,
+    .event_count = SCMI_PERF_EVENT_IDX_COUNT,
+    .type = FWK_MODULE_TYPE_PROTOCOL,
+    .init = scmi_perf_init,
+    .element_init = scmi_perf_element_init,
+    .bind = scmi_perf_bind,
+    .start = scmi_perf_start,
+    .process_bind_request = scmi_perf_process_bind_request,
+    .process_event = scmi_perf_process_event,
+};
+
+/*
+ * Linux 端 (drivers/cpufreq/scmi-cpufreq.c)：
+ *
+ *   cpu0: cpu@0 {
+ *       clocks = <&scmi_dvfs 0>;    // PERF domain 0，取代 <&scmi_clk 0>
+ *   };
+ *
+ *   scmi_dvfs: protocol@13 {
+ *       reg = <0x13>;
+ *       #clock-cells = <1>;
+ *   };
+ *
+ * scmi-cpufreq 以 DESCRIBE_LEVELS 建立 OPP 表，
+ * 偵測到 fast channel 後 fast_switch 直接寫入 level_set，
+ * 不經過 mailbox，排程器情境下也能調頻。
+ */
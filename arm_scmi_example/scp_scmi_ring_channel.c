@@ -0,0 +1,565 @@
+/*
+ * SCP Firmware SCMI Ring Channel Example
+ *
+ * 標準的 SCMI shared memory (mod_smt) 一個通道只放得下一則訊息：
+ * AP 必須等 SCP 處理完、設回 CHANNEL_FREE 之後才能送下一則，
+ * 每則訊息都要一次 doorbell 與一次完成中斷。
+ *
+ * 這個模組提供另一種通道格式：共享記憶體切成固定大小的 slot，
+ * 以 producer/consumer 索引組成 ring。
+ *
+ *   +-------------------------------+ base
+ *   | struct scmi_ring_hdr          |
+ *   +-------------------------------+ base + sizeof(hdr)
+ *   | slot 0: length | msg_header   |
+ *   |         payload ...           |
+ *   +-------------------------------+ + slot_size
+ *   | slot 1                        |
+ *   |  ...                          |
+ *
+ *   - AP 寫入 slot[req_prod % N] 後遞增 req_prod
+ *   - SCP 依序處理 slot[req_cons % N]，回應直接寫回同一個 slot，
+ *     再遞增 req_cons；AP 以 msg_header 的 token 對應回應
+ *   - SCP 把 ring 清空後設定 scp_need_doorbell 再休息，AP 只在
+ *     這個旗標為 1 時才敲 doorbell：一串突發請求只需要一次 doorbell，
+ *     SCP 也在一次喚醒中全部處理完，最後只發一次完成中斷
+ *
+ * 本模組取代 mod_smt 作為 mod_scmi 的傳輸層，只處理 A2P 請求；
+ * P2A 通知仍走原本的 mod_smt 通道。要不要使用 ring 由平台設定與
+ * AP 端 device tree (compatible = "arm,scmi-shmem-ring") 共同決定。
+ */
+
+#include <fwk_assert.h>
+#include <fwk_event.h>
+#include <fwk_id.h>
+#include <fwk_interrupt.h>
+#include <fwk_log.h>
+#include <fwk_macros.h>
+#include <fwk_mm.h>
+#include <fwk_module.h>
+#include <fwk_module_idx.h>
+#include <fwk_status.h>
+#include <fwk_string.h>
+#include <mod_scmi.h>
+
+#define SCMI_RING_MAGIC 0x474E5253  /* "SRNG" */
+
+/* ring 標頭，AP 與 SCP 都看得到；註解標示由哪一端寫入 */
+struct scmi_ring_hdr {
+    uint32_t magic;               /* SCP：初始化完成後寫入 */
+    uint32_t slot_count;          /* SCP：2 的次方 */
+    uint32_t slot_size;           /* SCP：含 slot 標頭 */
+    uint32_t flags;               /* AP */
+#define SCMI_RING_FLAG_INTR_ENABLED (1U << 0)
+    volatile uint32_t req_prod;   /* AP：已送出的請求數 */
+    volatile uint32_t req_cons;   /* SCP：已寫回回應的請求數 */
+    volatile uint32_t scp_need_doorbell; /* SCP：ring 已清空，等待 doorbell */
+    uint32_t reserved;
+};
+
+struct scmi_ring_slot {
+    uint32_t length;              /* msg_header + payload 的位元組數 */
+    uint32_t msg_header;
+    uint8_t msg_payload[];
+};
+
+/* 通道 (element) 設定 */
+struct mod_scmi_ring_channel_config {
+    /* 共享記憶體位址與大小 */
+    uintptr_t base;
+    size_t size;
+
+    /* slot 大小 (位元組，含 slot 標頭)，slot 數由 size 推算 */
+    size_t slot_size;
+
+    /* doorbell 硬體 (例如 mod_mhu2 的 element) 與其 API */
+    fwk_id_t driver_id;
+    fwk_id_t driver_api_id;
+
+    /*
+     * 收到請求時通知的對象：mod_scmi 的 service element，
+     * 或 scp_scmi_channel_priority.c 的通道 element (由它排序後再轉送)
+     */
+    fwk_id_t signal_id;
+    fwk_id_t signal_api_id;
+};
+
+/* doorbell 驅動需提供的介面 (與 mod_smt_driver_api 相同) */
+struct mod_scmi_ring_driver_api {
+    int (*raise_interrupt)(fwk_id_t device_id);
+};
+
+/* 提供給 doorbell 驅動的介面：收到 AP doorbell 時呼叫 */
+struct mod_scmi_ring_driver_input_api {
+    int (*signal)(fwk_id_t channel_id);
+};
+
+enum mod_scmi_ring_api_idx {
+    MOD_SCMI_RING_API_IDX_SCMI_TRANSPORT,
+    MOD_SCMI_RING_API_IDX_DRIVER_INPUT,
+    MOD_SCMI_RING_API_IDX_COUNT,
+};
+
+enum scmi_ring_event_idx {
+    SCMI_RING_EVENT_IDX_NEXT,
+    SCMI_RING_EVENT_IDX_COUNT,
+};
+
+static const fwk_id_t scmi_ring_event_next =
+    FWK_ID_EVENT_INIT(FWK_MODULE_IDX_SCMI_RING, SCMI_RING_EVENT_IDX_NEXT);
+
+struct scmi_ring_channel_ctx {
+    const struct mod_scmi_ring_channel_config *config;
+    struct scmi_ring_hdr *hdr;
+    unsigned int slot_count;
+
+    /* 正在交給 mod_scmi 處理的請求 (複製出來，避免 AP 中途修改) */
+    bool locked;
+    uint32_t msg_header;
+    size_t payload_size;
+    uint8_t *in;
+
+    /* 本次喚醒已處理的請求數，ring 清空時才發完成中斷 */
+    unsigned int batch;
+
+    /* 已排入 SCMI_RING_EVENT_IDX_NEXT、尚未處理 (doorbell ISR 也會設定) */
+    volatile bool next_queued;
+
+    const struct mod_scmi_ring_driver_api *driver_api;
+    const struct mod_scmi_from_transport_api *signal_api;
+
+    /* 統計 */
+    uint32_t messages;
+    uint32_t wakeups;
+    uint32_t max_batch;
+};
+
+struct scmi_ring_ctx {
+    struct scmi_ring_channel_ctx *channel_ctx_table;
+    unsigned int channel_count;
+};
+
+static struct scmi_ring_ctx scmi_ring_ctx;
+
+static struct scmi_ring_channel_ctx *scmi_ring_get_ctx(fwk_id_t channel_id)
+{
+    return &scmi_ring_ctx.channel_ctx_table[
+        fwk_id_get_element_idx(channel_id)];
+}
+
+static struct scmi_ring_slot *scmi_ring_slot(
+    struct scmi_ring_channel_ctx *ctx, uint32_t idx)
+{
+    return (struct scmi_ring_slot *)(ctx->config->base +
+        sizeof(struct scmi_ring_hdr) +
+        (idx & (ctx->slot_count - 1)) * ctx->config->slot_size);
+}
+
+static size_t scmi_ring_max_payload(const struct scmi_ring_channel_ctx *ctx)
+{
+    return ctx->config->slot_size - sizeof(struct scmi_ring_slot);
+}
+
+static int scmi_ring_respond(fwk_id_t channel_id, const void *payload,
+                             size_t size);
+
+/* 不經 mod_scmi，直接以 SCMI 狀態碼回應目前的 slot，ring 照常前進 */
+static int scmi_ring_respond_status(fwk_id_t channel_id, int32_t scmi_status)
+{
+    return scmi_ring_respond(channel_id, &scmi_status, sizeof(scmi_status));
+}
+
+/*
+ * 取出 slot[req_cons] 的請求交給 mod_scmi
+ * ring 已空時設定 scp_need_doorbell，並重新檢查一次 req_prod，
+ * 避免 AP 在設定旗標之前剛好放入請求而沒有敲 doorbell
+ *
+ * 只在 process_event 中執行 (doorbell ISR 只排入事件)，
+ * locked 與 req_cons 因此不需要與中斷互斥
+ */
+static int scmi_ring_fetch(fwk_id_t channel_id)
+{
+    struct scmi_ring_channel_ctx *ctx = scmi_ring_get_ctx(channel_id);
+    struct scmi_ring_hdr *hdr = ctx->hdr;
+    struct scmi_ring_slot *slot;
+    int status;
+
+    if (ctx->locked)
+        return FWK_SUCCESS;
+
+    if (hdr->req_prod == hdr->req_cons) {
+        hdr->scp_need_doorbell = 1;
+        __sync_synchronize();
+        if (hdr->req_prod == hdr->req_cons) {
+            /* 這次喚醒結束，整批只發一次完成中斷 */
+            if (ctx->batch != 0 && (hdr->flags & SCMI_RING_FLAG_INTR_ENABLED))
+                ctx->driver_api->raise_interrupt(ctx->config->driver_id);
+            ctx->max_batch = FWK_MAX(ctx->max_batch, ctx->batch);
+            ctx->batch = 0;
+            return FWK_SUCCESS;
+        }
+    }
+
+    hdr->scp_need_doorbell = 0;
+
+    slot = scmi_ring_slot(ctx, hdr->req_cons);
+    __sync_synchronize();
+
+    ctx->msg_header = slot->msg_header;
+    ctx->locked = true;
+    ctx->batch++;
+    ctx->messages++;
+
+    /* 長度超出 slot 的請求不交給 mod_scmi，直接回 PROTOCOL_ERROR */
+    if (slot->length < sizeof(slot->msg_header) ||
+        slot->length - sizeof(slot->msg_header) > scmi_ring_max_payload(ctx)) {
+        fwk_log_error("[SCMI Ring] bad slot length %u",
+                      (unsigned int)slot->length);
+        ctx->payload_size = 0;
+        return scmi_ring_respond_status(channel_id, SCMI_PROTOCOL_ERROR);
+    }
+
+    ctx->payload_size = slot->length - sizeof(slot->msg_header);
+    fwk_str_memcpy(ctx->in, slot->msg_payload, ctx->payload_size);
+
+    status = ctx->signal_api->signal_message(ctx->config->signal_id);
+    if (status != FWK_SUCCESS) {
+        /*
+         * 不能只解除 locked：scp_need_doorbell 已清除，AP 不會再敲
+         * doorbell，req_cons 不前進 ring 就停住。回應錯誤後繼續下一則
+         */
+        fwk_log_error("[SCMI Ring] signal failed: %d", status);
+        return scmi_ring_respond_status(channel_id, SCMI_GENERIC_ERROR);
+    }
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 排入事件處理下一則，避免 respond -> fetch -> respond 的遞迴
+ * doorbell ISR 與 respond 都會呼叫；已有事件在佇列中就不重複排入
+ */
+static int scmi_ring_queue_next(fwk_id_t channel_id)
+{
+    struct scmi_ring_channel_ctx *ctx = scmi_ring_get_ctx(channel_id);
+    struct fwk_event event = {
+        .source_id = channel_id,
+        .target_id = channel_id,
+        .id = scmi_ring_event_next,
+    };
+    int status;
+
+    fwk_interrupt_global_disable();
+    if (ctx->next_queued) {
+        fwk_interrupt_global_enable();
+        return FWK_SUCCESS;
+    }
+    ctx->next_queued = true;
+    fwk_interrupt_global_enable();
+
+    status = fwk_put_event(&event);
+    if (status != FWK_SUCCESS)
+        ctx->next_queued = false;
+
+    return status;
+}
+
+/*
+ * doorbell 驅動介面
+ */
+
+/*
+ * 在 doorbell ISR 中呼叫：只排入事件，不直接 fetch。
+ * 否則 ISR 可能在 process_event 的 fetch 中途 (locked 尚未設定) 插入，
+ * 同一個 slot 會被交給 mod_scmi 兩次
+ */
+static int scmi_ring_signal(fwk_id_t channel_id)
+{
+    struct scmi_ring_channel_ctx *ctx = scmi_ring_get_ctx(channel_id);
+
+    ctx->wakeups++;
+
+    return scmi_ring_queue_next(channel_id);
+}
+
+static const struct mod_scmi_ring_driver_input_api scmi_ring_driver_input_api = {
+    .signal = scmi_ring_signal,
+};
+
+/*
+ * mod_scmi 傳輸層介面
+ */
+
+static int scmi_ring_get_secure(fwk_id_t channel_id, bool *secure)
+{
+    *secure = false;
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_ring_get_max_payload_size(fwk_id_t channel_id, size_t *size)
+{
+    *size = scmi_ring_max_payload(scmi_ring_get_ctx(channel_id));
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_ring_get_message_header(fwk_id_t channel_id,
+                                        uint32_t *message_header)
+{
+    struct scmi_ring_channel_ctx *ctx = scmi_ring_get_ctx(channel_id);
+
+    if (!ctx->locked)
+        return FWK_E_ACCESS;
+
+    *message_header = ctx->msg_header;
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_ring_get_payload(fwk_id_t channel_id, const void **payload,
+                                 size_t *size)
+{
+    struct scmi_ring_channel_ctx *ctx = scmi_ring_get_ctx(channel_id);
+
+    if (!ctx->locked)
+        return FWK_E_ACCESS;
+
+    *payload = ctx->in;
+    *size = ctx->payload_size;
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_ring_write_payload(fwk_id_t channel_id, size_t offset,
+                                   const void *payload, size_t size)
+{
+    struct scmi_ring_channel_ctx *ctx = scmi_ring_get_ctx(channel_id);
+    struct scmi_ring_slot *slot;
+
+    if (!ctx->locked || offset > scmi_ring_max_payload(ctx) ||
+        size > scmi_ring_max_payload(ctx) - offset)
+        return FWK_E_PARAM;
+
+    slot = scmi_ring_slot(ctx, ctx->hdr->req_cons);
+    fwk_str_memcpy(slot->msg_payload + offset, payload, size);
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 回應寫回目前的 slot 後遞增 req_cons，不個別發中斷；
+ * 接著排入事件處理下一則
+ */
+static int scmi_ring_respond(fwk_id_t channel_id, const void *payload,
+                             size_t size)
+{
+    struct scmi_ring_channel_ctx *ctx = scmi_ring_get_ctx(channel_id);
+    struct scmi_ring_slot *slot;
+
+    if (!ctx->locked)
+        return FWK_E_ACCESS;
+
+    if (size > scmi_ring_max_payload(ctx))
+        return FWK_E_PARAM;
+
+    slot = scmi_ring_slot(ctx, ctx->hdr->req_cons);
+    if (payload != NULL)
+        fwk_str_memcpy(slot->msg_payload, payload, size);
+    slot->msg_header = ctx->msg_header;
+    slot->length = sizeof(slot->msg_header) + size;
+
+    /* 回應內容必須在 req_cons 之前對 AP 可見 */
+    __sync_synchronize();
+    ctx->hdr->req_cons++;
+    ctx->locked = false;
+
+    return scmi_ring_queue_next(channel_id);
+}
+
+/* ring 只承載 A2P 請求，P2A 通知走 mod_smt 通道 */
+static int scmi_ring_transmit(fwk_id_t channel_id, uint32_t message_header,
+                              const void *payload, size_t size,
+                              bool request_ack_by_interrupt)
+{
+    return FWK_E_SUPPORT;
+}
+
+static const struct mod_scmi_to_transport_api scmi_ring_transport_api = {
+    .get_secure = scmi_ring_get_secure,
+    .get_max_payload_size = scmi_ring_get_max_payload_size,
+    .get_message_header = scmi_ring_get_message_header,
+    .get_payload = scmi_ring_get_payload,
+    .write_payload = scmi_ring_write_payload,
+    .respond = scmi_ring_respond,
+    .transmit = scmi_ring_transmit,
+};
+
+/*
+ * 查詢通道統計 (除錯/效能分析用)
+ * messages / wakeups 即平均每次喚醒處理的訊息數
+ */
+int scmi_ring_get_stats(unsigned int channel_idx, uint32_t *messages,
+                        uint32_t *wakeups, uint32_t *max_batch)
+{
+    struct scmi_ring_channel_ctx *ctx;
+
+    if (channel_idx >= scmi_ring_ctx.channel_count)
+        return FWK_E_PARAM;
+
+    ctx = &scmi_ring_ctx.channel_ctx_table[channel_idx];
+    *messages = ctx->messages;
+    *wakeups = ctx->wakeups;
+    *max_batch = ctx->max_batch;
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 模組框架介面
+ */
+
+static int scmi_ring_init(fwk_id_t module_id, unsigned int element_count,
+                          const void *data)
+{
+    if (element_count == 0)
+        return FWK_E_PARAM;
+
+    scmi_ring_ctx.channel_count = element_count;
+    scmi_ring_ctx.channel_ctx_table = fwk_mm_calloc(element_count,
+        sizeof(struct scmi_ring_channel_ctx));
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_ring_channel_init(fwk_id_t channel_id, unsigned int unused,
+                                  const void *data)
+{
+    struct scmi_ring_channel_ctx *ctx = scmi_ring_get_ctx(channel_id);
+    const struct mod_scmi_ring_channel_config *config = data;
+    unsigned int slot_count;
+
+    if (config == NULL || config->base == 0 ||
+        config->slot_size <= sizeof(struct scmi_ring_slot) ||
+        (config->slot_size % sizeof(uint32_t)) != 0 ||
+        config->size <= sizeof(struct scmi_ring_hdr))
+        return FWK_E_PARAM;
+
+    /* slot 數取不超過可用空間的 2 的次方，索引可直接以遮罩取餘數 */
+    slot_count = (config->size - sizeof(struct scmi_ring_hdr)) /
+                 config->slot_size;
+    if (slot_count < 2)
+        return FWK_E_PARAM;
+    while ((slot_count & (slot_count - 1)) != 0)
+        slot_count &= slot_count - 1;
+
+    ctx->config = config;
+    ctx->slot_count = slot_count;
+    ctx->hdr = (struct scmi_ring_hdr *)config->base;
+    ctx->in = fwk_mm_alloc(1, scmi_ring_max_payload(ctx));
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_ring_bind(fwk_id_t id, unsigned int round)
+{
+    struct scmi_ring_channel_ctx *ctx;
+    int status;
+
+    if (round == 1 || fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    ctx = scmi_ring_get_ctx(id);
+
+    status = fwk_module_bind(ctx->config->driver_id,
+                             ctx->config->driver_api_id, &ctx->driver_api);
+    if (status != FWK_SUCCESS)
+        return status;
+
+    return fwk_module_bind(ctx->config->signal_id,
+                           ctx->config->signal_api_id, &ctx->signal_api);
+}
+
+static int scmi_ring_process_bind_request(fwk_id_t source_id,
+                                          fwk_id_t target_id,
+                                          fwk_id_t api_id,
+                                          const void **api)
+{
+    switch (fwk_id_get_api_idx(api_id)) {
+    case MOD_SCMI_RING_API_IDX_SCMI_TRANSPORT:
+        *api = &scmi_ring_transport_api;
+        break;
+
+    case MOD_SCMI_RING_API_IDX_DRIVER_INPUT:
+        *api = &scmi_ring_driver_input_api;
+        break;
+
+    default:
+        return FWK_E_PARAM;
+    }
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 初始化 ring 標頭；magic 最後寫入，AP 看到 magic 才開始使用
+ */
+static int scmi_ring_start(fwk_id_t id)
+{
+    struct scmi_ring_channel_ctx *ctx;
+
+    if (fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    ctx = scmi_ring_get_ctx(id);
+
+    ctx->hdr->slot_count = ctx->slot_count;
+    ctx->hdr->slot_size = ctx->config->slot_size;
+    ctx->hdr->req_prod = 0;
+    ctx->hdr->req_cons = 0;
+    ctx->hdr->scp_need_doorbell = 1;
+    __sync_synchronize();
+    ctx->hdr->magic = SCMI_RING_MAGIC;
+
+    fwk_log_info("[SCMI Ring] Channel %u: %u slots x %u bytes",
+                 fwk_id_get_element_idx(id), ctx->slot_count,
+                 (unsigned int)ctx->config->slot_size);
+
+    return FWK_SUCCESS;
+}
+
+static int scmi_ring_process_event(const struct fwk_event *event,
+                                   struct fwk_event *resp_event)
+{
+    if (fwk_id_is_equal(event->id, scmi_ring_event_next)) {
+        /* 先清除，fetch 期間到達的 doorbell 會再排入一次 */
+        scmi_ring_get_ctx(event->target_id)->next_queued = false;
+        return scmi_ring_fetch(event->target_id);
+    }
+
+    return FWK_E_PARAM;
+}
+
+/* 模組描述符 */
+const struct fwk_module module_scmi_ring = {
+    .name = "SCMI Ring Channel",
+    .type = FWK_MODULE_TYPE_SERVICE,
+    .api_count = MOD_SCMI_RING_API_IDX_COUNT,
+    .event_count = SCMI_RING_EVENT_IDX_COUNT,
+    .init = scmi_ring_init,
+    .element_init = scmi_ring_channel_init,
+    .bind = scmi_ring_bind,
+    .start = scmi_ring_start,
+    .process_bind_request = scmi_ring_process_bind_request,
+    .process_event = scmi_ring_process_event,
+};
+
+/*
+ * 突發請求的時序 (4 個 CPU 同時調頻)：
+ *
+ *   single-slot shmem              ring (4 slots)
+ *   AP: 寫 msg0, doorbell           AP: 寫 msg0..3, doorbell x1
+ *   SCP: 處理 msg0, 中斷            SCP: 處理 msg0..3, 中斷 x1
+ *   AP: 等 CHANNEL_FREE, 寫 msg1
+ *   ... 共 4 次 doorbell + 4 次中斷
+ */
@@ -0,0 +1,1104 @@
+/*
+ * SCP Firmware Software PLL / Clock-Tree Timing Model Example
+ *
+ * 這個範例是 mod_myplatform_clock 的純軟體替身，實作相同的
+ * mod_clock_drv_api，讓 SCP clock 模組與 SCMI clock handler
+ * 可以在沒有硬體的 host 環境 (例如 virtio-scmi backend、CI) 中原封不動地執行。
+ *
+ * 元素直接沿用 example_platform_clock_config.c 的 clock_dev_desc_table，
+ * 元素資料為 struct myplatform_clock_config。base_address 相同的元素
+ * 共用同一顆 PLL (例如 SYS/AHB/APB/DISPLAY_AXI)，各自只擁有輸出分頻器。
+ *
+ * 時序模型 (虛擬時間，完全決定性)：
+ *   - 只改分頻器即可達成的頻率：div_switch_ns
+ *   - 需要新的 VCO 頻率：mux 切到 REFCLK + PLL relock + mux 切回
+ *     (mux_latency_ns * 2 + lock_time_ns)
+ *   - 同一顆 PLL 的轉換必須排隊；不同 PLL 的轉換在時間軸上重疊
+ *
+ * 每次轉換都記錄到 timeline trace，可輸出成 CSV 供 CI 比對或繪圖。
+ *
+ * Ping-pong 模式 (myplatform_clock_config.pll_mode = PING_PONG，另有一顆
+ * spare_base_address 的備用 PLL)：需要新 VCO 時，CPU 繼續以舊頻率跑在
+ * 目前的 PLL 上，閒置的 PLL 預先 lock 到目標 VCO，完成後只做一次
+ * glitch-free mux 切換，兩顆 PLL 角色互換；閒置 PLL 保持 lock，
+ * 切回上一個 VCO 時連 lock 都不需要。
+ * 每個輸出累計轉換期間損失的週期數 (相對於維持原頻率)，
+ * 用來比較 REFCLK 停靠與 ping-pong 的效能差異 (sw_pll_stats_dump)。
+ *
+ * 電源域關閉前 (pre-transition OFF) 保存每個輸出的頻率、分頻與來源，
+ * 關閉期間 get_rate 直接回傳保存值，不讀硬體；上電時每顆 PLL 只重放一次
+ * 「mux 到 REFCLK → 寫 PLL 設定 → 等 lock → 寫所有分頻器 → mux 回 PLL」
+ * 的暫存器序列，而不是每個輸出各自從頭 set_rate。
+ */
+
+#include <mod_clock.h>
+#include <mod_myplatform_clock.h>
+#include <mod_power_domain.h>
+
+#include <fwk_id.h>
+#include <fwk_log.h>
+#include <fwk_macros.h>
+#include <fwk_mm.h>
+#include <fwk_module.h>
+#include <fwk_module_idx.h>
+#include <fwk_status.h>
+
+#include <stdio.h>
+
+/* 模組提供的 API */
+enum mod_sw_pll_api_idx {
+    /* mod_clock_drv_api，給 mod_clock 使用 */
+    MOD_SW_PLL_API_IDX_DRIVER,
+
+    /* mod_myplatform_clock_preset_api，給 SCMI PERF 使用 */
+    MOD_SW_PLL_API_IDX_PRESET,
+
+    MOD_SW_PLL_API_IDX_COUNT,
+};
+
+/* 每顆 PLL (以 base_address 區分) 的時序參數 */
+struct sw_pll_timing_config {
+    uintptr_t base_address;
+
+    /* PLL relock 時間 */
+    uint32_t lock_time_ns;
+
+    /* 只切換輸出分頻器的時間 */
+    uint32_t div_switch_ns;
+
+    /* glitch-free mux 切換一次的延遲 */
+    uint32_t mux_latency_ns;
+};
+
+/* 模組設定 */
+struct sw_pll_config {
+    const struct sw_pll_timing_config *timing_table;
+    unsigned int timing_count;
+
+    /* 找不到對應 base_address 時使用的預設值 */
+    struct sw_pll_timing_config default_timing;
+
+    /*
+     * true：set_rate 回傳 FWK_PENDING，完成時間到達後才回報 mod_clock
+     * (與真實 PLL driver 相同的非同步行為)；
+     * false：立即完成，只在 trace 中記錄時間
+     */
+    bool async;
+
+    /* timeline trace 容量 (筆數) */
+    unsigned int trace_capacity;
+};
+
+/* 轉換種類 */
+enum sw_pll_transition_kind {
+    SW_PLL_TRANSITION_DIV,
+    SW_PLL_TRANSITION_RELOCK,
+    SW_PLL_TRANSITION_SIBLING,  /* 共用 PLL relock 造成的連帶頻率變化 */
+    SW_PLL_TRANSITION_RESTORE,  /* 上電後批次還原 */
+    SW_PLL_TRANSITION_PRELOCK,  /* ping-pong：閒置 PLL 預先 lock，CPU 不受影響 */
+    SW_PLL_TRANSITION_SWAP,     /* ping-pong：mux 切到已 lock 的 PLL */
+};
+
+/*
+ * 每個輸出的轉換統計
+ * lost_cycles 以「轉換期間維持原頻率」為基準：
+ *   REFCLK 停靠：原頻率 * (2 * mux + lock) - REFCLK * lock
+ *   ping-pong：  原頻率 * mux (lock 期間照常以原頻率執行)
+ *   只改分頻器： 0 (glitch-free 分頻切換不停頓)
+ */
+struct sw_pll_transition_stats {
+    uint32_t transitions;
+    uint32_t relocks;
+    uint32_t swaps;
+    /* 以低於原頻率執行 (REFCLK 或 mux 切換中) 的總時間 */
+    uint64_t degraded_ns;
+    uint64_t lost_cycles;
+};
+
+/* 輸出 mux 的來源 */
+enum sw_pll_source {
+    SW_PLL_SOURCE_PLL,
+    SW_PLL_SOURCE_REFCLK,
+};
+
+/* 電源域關閉前保存的輸出狀態 */
+struct sw_pll_saved_state {
+    uint64_t rate;
+    uint32_t out_div;
+    enum sw_pll_source source;
+    enum mod_clock_state state;
+};
+
+/* timeline trace 的一筆記錄 */
+struct sw_pll_trace_entry {
+    uint64_t start_ns;
+    uint64_t end_ns;
+    unsigned int element_idx;
+    enum sw_pll_transition_kind kind;
+    uint64_t from_rate;
+    uint64_t to_rate;
+};
+
+/* 每顆 PLL 的模擬狀態 */
+struct sw_pll_pll_ctx {
+    const struct sw_pll_timing_config *timing;
+    uint64_t vco_rate;
+
+    /* 此 PLL 上一個轉換的結束時間 */
+    uint64_t busy_until_ns;
+
+    /* 此 PLL 的輸出數，以及其中已斷電的數量 */
+    unsigned int output_count;
+    unsigned int off_count;
+
+    /* 所有輸出都斷電後 PLL 暫存器內容遺失，上電時需要重新 lock */
+    bool lost;
+    uint64_t saved_vco_rate;
+};
+
+/* 每個時鐘輸出的模擬狀態 */
+struct sw_pll_dev_ctx {
+    const struct myplatform_clock_config *config;
+    struct sw_pll_pll_ctx *pll;
+
+    /* ping-pong 模式下目前閒置的 PLL，否則為 NULL */
+    struct sw_pll_pll_ctx *idle_pll;
+
+    uint64_t current_rate;
+    uint32_t out_div;
+    enum mod_clock_state state;
+
+    /* 非同步模式：尚未回報的完成時間，0 表示沒有 */
+    uint64_t complete_at_ns;
+
+    /* 分段 relock 進行中 (begin_relock 之後、finish_relock 之前) */
+    bool relocking;
+
+    /*
+     * ping-pong 的分段 relock：begin 只讓閒置 PLL 預先 lock，
+     * finish 時才切換到這組目標
+     */
+    bool swap_pending;
+    uint64_t swap_rate;
+    uint32_t swap_div;
+
+    enum sw_pll_source source;
+
+    /* 所在電源域已關閉，狀態保存在 saved */
+    bool powered_off;
+    struct sw_pll_saved_state saved;
+
+    struct sw_pll_transition_stats stats;
+};
+
+struct sw_pll_ctx {
+    const struct sw_pll_config *config;
+
+    struct sw_pll_dev_ctx *dev_ctx_table;
+    unsigned int dev_count;
+
+    struct sw_pll_pll_ctx *pll_table;
+    unsigned int pll_count;
+
+    /* 虛擬時間 */
+    uint64_t now_ns;
+
+    struct sw_pll_trace_entry *trace;
+    unsigned int trace_count;
+    unsigned int trace_dropped;
+
+    const struct mod_clock_driver_response_api *clock_response_api;
+};
+
+static struct sw_pll_ctx sw_pll_ctx;
+
+static struct sw_pll_dev_ctx *sw_pll_get_ctx(fwk_id_t clock_id)
+{
+    return &sw_pll_ctx.dev_ctx_table[fwk_id_get_element_idx(clock_id)];
+}
+
+/*
+ * Timeline trace
+ */
+
+static void sw_pll_trace(unsigned int element_idx,
+                         enum sw_pll_transition_kind kind,
+                         uint64_t start_ns, uint64_t end_ns,
+                         uint64_t from_rate, uint64_t to_rate)
+{
+    struct sw_pll_trace_entry *entry;
+
+    if (sw_pll_ctx.trace_count >= sw_pll_ctx.config->trace_capacity) {
+        sw_pll_ctx.trace_dropped++;
+        return;
+    }
+
+    entry = &sw_pll_ctx.trace[sw_pll_ctx.trace_count++];
+    entry->start_ns = start_ns;
+    entry->end_ns = end_ns;
+    entry->element_idx = element_idx;
+    entry->kind = kind;
+    entry->from_rate = from_rate;
+    entry->to_rate = to_rate;
+}
+
+/*
+ * 輸出 timeline (CSV)：start_ns,end_ns,clock,kind,from_hz,to_hz
+ * CI 可直接與 golden file 比對
+ */
+void sw_pll_trace_dump(FILE *out)
+{
+    static const char *const kind_name[] = {
+        [SW_PLL_TRANSITION_DIV] = "div",
+        [SW_PLL_TRANSITION_RELOCK] = "relock",
+        [SW_PLL_TRANSITION_SIBLING] = "sibling",
+        [SW_PLL_TRANSITION_RESTORE] = "restore",
+        [SW_PLL_TRANSITION_PRELOCK] = "prelock",
+        [SW_PLL_TRANSITION_SWAP] = "swap",
+    };
+    const struct sw_pll_trace_entry *entry;
+    unsigned int i;
+
+    fprintf(out, "start_ns,end_ns,clock,kind,from_hz,to_hz\n");
+    for (i = 0; i < sw_pll_ctx.trace_count; i++) {
+        entry = &sw_pll_ctx.trace[i];
+        fprintf(out, "%llu,%llu,%s,%s,%llu,%llu\n",
+                (unsigned long long)entry->start_ns,
+                (unsigned long long)entry->end_ns,
+                fwk_module_get_element_name(
+                    FWK_ID_ELEMENT(FWK_MODULE_IDX_SW_PLL, entry->element_idx)),
+                kind_name[entry->kind],
+                (unsigned long long)entry->from_rate,
+                (unsigned long long)entry->to_rate);
+    }
+
+    if (sw_pll_ctx.trace_dropped != 0)
+        fprintf(out, "# dropped %u entries\n", sw_pll_ctx.trace_dropped);
+}
+
+void sw_pll_trace_reset(void)
+{
+    sw_pll_ctx.trace_count = 0;
+    sw_pll_ctx.trace_dropped = 0;
+}
+
+/* 頻率 (Hz) 乘上時間 (ns) 換算成週期數 */
+static uint64_t sw_pll_cycles(uint64_t rate, uint64_t ns)
+{
+    return rate / FWK_MHZ * ns / 1000 +
+           (rate % FWK_MHZ) * ns / 1000000000ULL;
+}
+
+int sw_pll_get_transition_stats(fwk_id_t clock_id,
+                                struct sw_pll_transition_stats *stats)
+{
+    unsigned int idx = fwk_id_get_element_idx(clock_id);
+
+    if (idx >= sw_pll_ctx.dev_count || stats == NULL)
+        return FWK_E_PARAM;
+
+    *stats = sw_pll_ctx.dev_ctx_table[idx].stats;
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 輸出每個時鐘的轉換統計 (CSV)：
+ * clock,mode,transitions,relocks,swaps,degraded_ns,lost_cycles
+ */
+void sw_pll_stats_dump(FILE *out)
+{
+    const struct sw_pll_dev_ctx *ctx;
+    unsigned int i;
+
+    fprintf(out, "clock,mode,transitions,relocks,swaps,degraded_ns,"
+                 "lost_cycles\n");
+    for (i = 0; i < sw_pll_ctx.dev_count; i++) {
+        ctx = &sw_pll_ctx.dev_ctx_table[i];
+        if (ctx->stats.transitions == 0)
+            continue;
+
+        fprintf(out, "%s,%s,%u,%u,%u,%llu,%llu\n",
+                fwk_module_get_element_name(
+                    FWK_ID_ELEMENT(FWK_MODULE_IDX_SW_PLL, i)),
+                ctx->idle_pll != NULL ? "ping-pong" : "refclk",
+                ctx->stats.transitions, ctx->stats.relocks, ctx->stats.swaps,
+                (unsigned long long)ctx->stats.degraded_ns,
+                (unsigned long long)ctx->stats.lost_cycles);
+    }
+}
+
+void sw_pll_stats_reset(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < sw_pll_ctx.dev_count; i++)
+        sw_pll_ctx.dev_ctx_table[i].stats =
+            (struct sw_pll_transition_stats){ 0 };
+}
+
+/*
+ * 虛擬時間
+ */
+
+uint64_t sw_pll_now_ns(void)
+{
+    return sw_pll_ctx.now_ns;
+}
+
+/*
+ * 推進虛擬時間，並回報所有在此之前完成的非同步轉換
+ * (測試程式或 virtio backend 在每批請求之間呼叫)
+ */
+void sw_pll_advance_to(uint64_t t_ns)
+{
+    struct mod_clock_driver_resp_params resp = { .status = FWK_SUCCESS };
+    struct sw_pll_dev_ctx *ctx;
+    unsigned int i;
+
+    if (t_ns > sw_pll_ctx.now_ns)
+        sw_pll_ctx.now_ns = t_ns;
+
+    for (i = 0; i < sw_pll_ctx.dev_count; i++) {
+        ctx = &sw_pll_ctx.dev_ctx_table[i];
+        if (ctx->complete_at_ns == 0 || ctx->complete_at_ns > sw_pll_ctx.now_ns)
+            continue;
+
+        ctx->complete_at_ns = 0;
+        resp.value.rate = ctx->current_rate;
+        sw_pll_ctx.clock_response_api->request_complete(
+            FWK_ID_ELEMENT(FWK_MODULE_IDX_SW_PLL, i), &resp);
+    }
+}
+
+/*
+ * 最早一個尚未回報的非同步轉換的完成時間，沒有時回傳 0
+ * (事件佇列清空後，呼叫端以 sw_pll_advance_to() 直接跳到這個時間)
+ */
+uint64_t sw_pll_next_completion_ns(void)
+{
+    uint64_t next = 0;
+    unsigned int i;
+
+    for (i = 0; i < sw_pll_ctx.dev_count; i++) {
+        uint64_t t = sw_pll_ctx.dev_ctx_table[i].complete_at_ns;
+
+        if (t != 0 && (next == 0 || t < next))
+            next = t;
+    }
+
+    return next;
+}
+
+/* 依 step_size 與捨入模式對齊頻率 */
+static uint64_t sw_pll_round(const struct myplatform_clock_config *config,
+                             uint64_t rate,
+                             enum mod_clock_round_mode round_mode)
+{
+    uint64_t down = FWK_ALIGN_PREVIOUS(rate, config->step_size);
+    uint64_t up = FWK_ALIGN_NEXT(rate, config->step_size);
+
+    switch (round_mode) {
+    case MOD_CLOCK_ROUND_MODE_DOWN:
+        return down;
+
+    case MOD_CLOCK_ROUND_MODE_UP:
+        return up;
+
+    case MOD_CLOCK_ROUND_MODE_NEAREST:
+        return ((rate - down) <= (up - rate)) ? down : up;
+
+    default:
+        return rate;
+    }
+}
+
+/*
+ * 為目標頻率選擇 VCO 與輸出分頻：
+ * VCO 以 ref_freq / divider 為步進，且不低於預設 VCO 頻率
+ */
+static void sw_pll_solve(const struct myplatform_clock_config *config,
+                         uint64_t rate, uint64_t *vco_rate, uint32_t *out_div)
+{
+    uint64_t vco_min = (uint64_t)config->pll_config.ref_freq *
+                       config->pll_config.multiplier /
+                       config->pll_config.divider;
+    uint32_t div = 1;
+
+    while (rate * div < vco_min)
+        div++;
+
+    *out_div = div;
+    *vco_rate = rate * div;
+}
+
+/* REFCLK 停靠期間的效能損失 (原頻率跑滿整段轉換為基準) */
+static void sw_pll_account_park(struct sw_pll_dev_ctx *ctx, uint64_t old_rate,
+                                const struct sw_pll_timing_config *timing)
+{
+    uint64_t window = 2 * (uint64_t)timing->mux_latency_ns +
+                      timing->lock_time_ns;
+    uint64_t lost = sw_pll_cycles(old_rate, window);
+    uint64_t refclk = sw_pll_cycles(ctx->config->pll_config.ref_freq,
+                                    timing->lock_time_ns);
+
+    ctx->stats.degraded_ns += window;
+    ctx->stats.lost_cycles += (lost > refclk) ? lost - refclk : 0;
+}
+
+/*
+ * 此次轉換是否以 ping-pong 完成：需要新 VCO，且執行期再確認 PLL 沒有
+ * 被其他輸出共用，否則退回 REFCLK 停靠
+ */
+static bool sw_pll_use_ping_pong(const struct sw_pll_dev_ctx *ctx,
+                                 uint64_t vco_rate)
+{
+    return vco_rate != ctx->pll->vco_rate && ctx->idle_pll != NULL &&
+           ctx->pll->output_count == 1;
+}
+
+/*
+ * Ping-pong 的前半：閒置 PLL 預先 lock 到目標 VCO，目前的輸出不受影響；
+ * 已在目標 VCO 時不需 lock。回傳 lock 完成的時間
+ */
+static uint64_t sw_pll_prelock(unsigned int idx, uint64_t vco_rate)
+{
+    struct sw_pll_dev_ctx *ctx = &sw_pll_ctx.dev_ctx_table[idx];
+    struct sw_pll_pll_ctx *next = ctx->idle_pll;
+    uint64_t start, locked;
+
+    start = FWK_MAX(sw_pll_ctx.now_ns, next->busy_until_ns);
+    if (next->vco_rate == vco_rate)
+        return start;
+
+    locked = start + next->timing->lock_time_ns;
+    sw_pll_trace(idx, SW_PLL_TRANSITION_PRELOCK, start, locked,
+                 ctx->current_rate, ctx->current_rate);
+    next->vco_rate = vco_rate;
+    next->busy_until_ns = locked;
+    ctx->stats.relocks++;
+
+    return locked;
+}
+
+/*
+ * Ping-pong 的後半：mux 切到已 lock 的閒置 PLL，兩顆 PLL 角色互換；
+ * 回傳完成時間
+ */
+static uint64_t sw_pll_swap(unsigned int idx, uint64_t rate, uint32_t out_div)
+{
+    struct sw_pll_dev_ctx *ctx = &sw_pll_ctx.dev_ctx_table[idx];
+    struct sw_pll_pll_ctx *next = ctx->idle_pll;
+    const struct sw_pll_timing_config *timing = next->timing;
+    uint64_t locked, end;
+
+    locked = FWK_MAX(sw_pll_ctx.now_ns,
+                     FWK_MAX(ctx->pll->busy_until_ns, next->busy_until_ns));
+    end = locked + timing->mux_latency_ns;
+    sw_pll_trace(idx, SW_PLL_TRANSITION_SWAP, locked, end,
+                 ctx->current_rate, rate);
+
+    ctx->stats.swaps++;
+    ctx->stats.degraded_ns += timing->mux_latency_ns;
+    ctx->stats.lost_cycles += sw_pll_cycles(ctx->current_rate,
+                                            timing->mux_latency_ns);
+
+    /* 角色互換，舊的 PLL 保持 lock 在原 VCO */
+    next->busy_until_ns = end;
+    ctx->pll->busy_until_ns = end;
+    ctx->idle_pll = ctx->pll;
+    ctx->pll = next;
+    ctx->out_div = out_div;
+    ctx->current_rate = rate;
+
+    return end;
+}
+
+/*
+ * 記錄一次輸出頻率轉換並推進 PLL 的忙碌時間
+ * vco_rate 與目前不同時視為 relock，共用此 PLL 的其他輸出一併改變；
+ * ping-pong 模式改由 sw_pll_ping_pong() 處理
+ */
+static uint64_t sw_pll_transition(unsigned int idx, uint64_t rate,
+                                  uint64_t vco_rate, uint32_t out_div)
+{
+    struct sw_pll_dev_ctx *ctx = &sw_pll_ctx.dev_ctx_table[idx];
+    struct sw_pll_pll_ctx *pll = ctx->pll;
+    const struct sw_pll_timing_config *timing = pll->timing;
+    struct sw_pll_dev_ctx *sibling;
+    uint64_t start, end, old_rate;
+    unsigned int i;
+
+    ctx->stats.transitions++;
+
+    if (sw_pll_use_ping_pong(ctx, vco_rate)) {
+        sw_pll_prelock(idx, vco_rate);
+        return sw_pll_swap(idx, rate, out_div);
+    }
+
+    /* 同一顆 PLL 上的轉換排隊執行 */
+    start = FWK_MAX(sw_pll_ctx.now_ns, pll->busy_until_ns);
+
+    if (vco_rate == pll->vco_rate) {
+        /* VCO 不變：只切換分頻器 */
+        end = start + timing->div_switch_ns;
+        sw_pll_trace(idx, SW_PLL_TRANSITION_DIV, start, end,
+                     ctx->current_rate, rate);
+    } else {
+        /* 需要新的 VCO：mux 到 REFCLK、relock、mux 回 PLL */
+        end = start + 2 * (uint64_t)timing->mux_latency_ns +
+              timing->lock_time_ns;
+        sw_pll_trace(idx, SW_PLL_TRANSITION_RELOCK, start, end,
+                     ctx->current_rate, rate);
+        ctx->stats.relocks++;
+        sw_pll_account_park(ctx, ctx->current_rate, timing);
+
+        /* 共用此 PLL 的其他輸出，分頻不變但頻率跟著 VCO 改變 */
+        for (i = 0; i < sw_pll_ctx.dev_count; i++) {
+            sibling = &sw_pll_ctx.dev_ctx_table[i];
+            if (i == idx || sibling->pll != pll)
+                continue;
+
+            old_rate = sibling->current_rate;
+            sibling->current_rate = vco_rate / sibling->out_div;
+            sw_pll_trace(i, SW_PLL_TRANSITION_SIBLING, start, end,
+                         old_rate, sibling->current_rate);
+            sw_pll_account_park(sibling, old_rate, timing);
+        }
+
+        pll->vco_rate = vco_rate;
+    }
+
+    pll->busy_until_ns = end;
+    ctx->out_div = out_div;
+    ctx->current_rate = rate;
+
+    return end;
+}
+
+static int sw_pll_set_rate(fwk_id_t clock_id, uint64_t rate,
+                           enum mod_clock_round_mode round_mode)
+{
+    struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(clock_id);
+    uint64_t rounded_rate, vco_rate, end;
+    uint32_t out_div;
+
+    if (!ctx->config->supports_rate_change)
+        return FWK_E_SUPPORT;
+
+    if (ctx->state == MOD_CLOCK_STATE_STOPPED || ctx->powered_off)
+        return FWK_E_PWRSTATE;
+
+    if (ctx->complete_at_ns != 0 || ctx->relocking)
+        return FWK_E_BUSY;
+
+    rounded_rate = sw_pll_round(ctx->config, rate, round_mode);
+    if (rounded_rate < ctx->config->min_rate ||
+        rounded_rate > ctx->config->max_rate)
+        return FWK_E_RANGE;
+
+    if (ctx->pll->vco_rate % rounded_rate == 0) {
+        /* 目前 VCO 整除目標頻率 */
+        vco_rate = ctx->pll->vco_rate;
+        out_div = (uint32_t)(vco_rate / rounded_rate);
+    } else {
+        sw_pll_solve(ctx->config, rounded_rate, &vco_rate, &out_div);
+    }
+
+    end = sw_pll_transition(fwk_id_get_element_idx(clock_id), rounded_rate,
+                            vco_rate, out_div);
+
+    if (!sw_pll_ctx.config->async)
+        return FWK_SUCCESS;
+
+    ctx->complete_at_ns = end;
+
+    return FWK_PENDING;
+}
+
+/*
+ * 預設值 API (SCMI PERF 使用)
+ * 呼叫端已算好 PLL 設定，這裡只換算成 VCO 並記錄轉換；
+ * 介面語意為返回時已 lock，因此不論 async 設定都同步完成，
+ * 虛擬時間直接推進到轉換結束
+ */
+static int sw_pll_apply_preset(fwk_id_t clock_id,
+                               const struct mod_myplatform_clock_preset *preset)
+{
+    struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(clock_id);
+    uint64_t vco_rate;
+
+    if (ctx->state == MOD_CLOCK_STATE_STOPPED || ctx->powered_off)
+        return FWK_E_PWRSTATE;
+
+    if (ctx->complete_at_ns != 0 || ctx->relocking)
+        return FWK_E_BUSY;
+
+    vco_rate = (uint64_t)preset->pll.ref_freq * preset->pll.multiplier /
+               preset->pll.divider;
+
+    sw_pll_ctx.now_ns = sw_pll_transition(fwk_id_get_element_idx(clock_id),
+                                          preset->rate, vco_rate,
+                                          preset->pll.post_div);
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 分段 relock：begin 在目前虛擬時間開始轉換，不推進時間，
+ * 讓同一批次中其他 PLL 的 relock 在時間軸上重疊；
+ * finish 時才把虛擬時間推進到此 PLL 完成。
+ *
+ * REFCLK 停靠：begin 記錄完整的 mux + lock + mux，輸出停在 REFCLK。
+ * ping-pong：begin 只讓閒置 PLL 預先 lock，輸出繼續以原頻率跑在目前的
+ * PLL 上；finish 才做 mux 切換與角色互換 (呼叫端在兩者之間調整電壓)
+ */
+static int sw_pll_begin_relock(fwk_id_t clock_id,
+                               const struct mod_myplatform_clock_preset *preset)
+{
+    struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(clock_id);
+    unsigned int idx = fwk_id_get_element_idx(clock_id);
+    uint64_t vco_rate;
+
+    if (ctx->state == MOD_CLOCK_STATE_STOPPED || ctx->powered_off)
+        return FWK_E_PWRSTATE;
+
+    if (ctx->complete_at_ns != 0 || ctx->relocking)
+        return FWK_E_BUSY;
+
+    vco_rate = (uint64_t)preset->pll.ref_freq * preset->pll.multiplier /
+               preset->pll.divider;
+
+    ctx->relocking = true;
+
+    if (sw_pll_use_ping_pong(ctx, vco_rate)) {
+        ctx->stats.transitions++;
+        sw_pll_prelock(idx, vco_rate);
+        ctx->swap_pending = true;
+        ctx->swap_rate = preset->rate;
+        ctx->swap_div = preset->pll.post_div;
+        return FWK_SUCCESS;
+    }
+
+    sw_pll_transition(idx, preset->rate, vco_rate, preset->pll.post_div);
+    ctx->source = SW_PLL_SOURCE_REFCLK;
+
+    return FWK_SUCCESS;
+}
+
+static int sw_pll_finish_relock(fwk_id_t clock_id)
+{
+    struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(clock_id);
+
+    /* relock 途中斷電：目標設定已保存，上電時還原 */
+    if (ctx->powered_off)
+        return FWK_SUCCESS;
+
+    if (!ctx->relocking)
+        return FWK_E_STATE;
+
+    ctx->relocking = false;
+    ctx->source = SW_PLL_SOURCE_PLL;
+
+    if (ctx->swap_pending) {
+        ctx->swap_pending = false;
+        sw_pll_ctx.now_ns = sw_pll_swap(fwk_id_get_element_idx(clock_id),
+                                        ctx->swap_rate, ctx->swap_div);
+        return FWK_SUCCESS;
+    }
+
+    sw_pll_ctx.now_ns = FWK_MAX(sw_pll_ctx.now_ns, ctx->pll->busy_until_ns);
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 估計套用 preset 要等的 lock 時間，DVFS engine 據此排程：
+ * VCO 不變、或 ping-pong 的閒置 PLL 已 lock 在目標 VCO 時為 0
+ */
+static int sw_pll_estimate_lock(
+    fwk_id_t clock_id,
+    const struct mod_myplatform_clock_preset *preset,
+    uint32_t *lock_time_ns)
+{
+    const struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(clock_id);
+    uint64_t vco_rate;
+
+    vco_rate = (uint64_t)preset->pll.ref_freq * preset->pll.multiplier /
+               preset->pll.divider;
+
+    if (vco_rate == ctx->pll->vco_rate)
+        *lock_time_ns = 0;
+    else if (!sw_pll_use_ping_pong(ctx, vco_rate))
+        *lock_time_ns = ctx->pll->timing->lock_time_ns;
+    else if (ctx->idle_pll->vco_rate == vco_rate)
+        *lock_time_ns = 0;
+    else
+        *lock_time_ns = ctx->idle_pll->timing->lock_time_ns;
+
+    return FWK_SUCCESS;
+}
+
+/* 回報 timing_table 中此輸出所在 PLL 的時序，DVFS engine 不另外設定 */
+static int sw_pll_get_timing(fwk_id_t clock_id,
+                             struct mod_myplatform_clock_timing *timing)
+{
+    const struct sw_pll_timing_config *config =
+        sw_pll_get_ctx(clock_id)->pll->timing;
+
+    timing->lock_time_ns = config->lock_time_ns;
+    timing->div_switch_ns = config->div_switch_ns;
+    timing->mux_latency_ns = config->mux_latency_ns;
+
+    return FWK_SUCCESS;
+}
+
+static int sw_pll_get_rate(fwk_id_t clock_id, uint64_t *rate)
+{
+    struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(clock_id);
+
+    /* 斷電期間不存取硬體，回傳保存的頻率 */
+    *rate = ctx->powered_off ? ctx->saved.rate : ctx->current_rate;
+
+    return FWK_SUCCESS;
+}
+
+static int sw_pll_set_state(fwk_id_t clock_id, enum mod_clock_state state)
+{
+    struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(clock_id);
+
+    if (state != MOD_CLOCK_STATE_RUNNING && state != MOD_CLOCK_STATE_STOPPED)
+        return FWK_E_PARAM;
+
+    /* 斷電期間只更新保存值，上電時一併還原 */
+    if (ctx->powered_off)
+        ctx->saved.state = state;
+    else
+        ctx->state = state;
+
+    return FWK_SUCCESS;
+}
+
+static int sw_pll_get_state(fwk_id_t clock_id, enum mod_clock_state *state)
+{
+    struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(clock_id);
+
+    *state = ctx->powered_off ? ctx->saved.state : ctx->state;
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 電源域即將關閉：保存頻率、分頻、來源與啟用狀態
+ * 最後一個輸出斷電時，PLL 本身的設定也視為遺失
+ *
+ * 進行中的轉換不阻擋關閉：current_rate/out_div 已是目標值，
+ * 上電時會直接還原成目標設定，因此保存目標值並立即回報完成
+ * (分段 relock 也一樣，之後的 finish_relock 視為成功；ping-pong 尚未
+ * 切換時，閒置 PLL 已開始 lock 到目標，直接換成目標設定)
+ */
+static int sw_pll_process_pending_power_transition(fwk_id_t clock_id,
+                                                   unsigned int current_state,
+                                                   unsigned int next_state)
+{
+    struct mod_clock_driver_resp_params resp = { .status = FWK_SUCCESS };
+    struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(clock_id);
+    struct sw_pll_pll_ctx *pll = ctx->pll, *next = ctx->idle_pll;
+    bool complete;
+
+    if (next_state != MOD_PD_STATE_OFF || ctx->powered_off)
+        return FWK_SUCCESS;
+
+    complete = ctx->complete_at_ns != 0;
+    ctx->complete_at_ns = 0;
+    if (ctx->relocking) {
+        ctx->relocking = false;
+        ctx->source = SW_PLL_SOURCE_PLL;
+    }
+    if (ctx->swap_pending) {
+        ctx->swap_pending = false;
+        ctx->idle_pll = pll;
+        ctx->pll = pll = next;
+        ctx->out_div = ctx->swap_div;
+        ctx->current_rate = ctx->swap_rate;
+    }
+
+    ctx->saved.rate = ctx->current_rate;
+    ctx->saved.out_div = ctx->out_div;
+    ctx->saved.source = ctx->source;
+    ctx->saved.state = ctx->state;
+    ctx->powered_off = true;
+
+    if (++pll->off_count == pll->output_count) {
+        pll->saved_vco_rate = pll->vco_rate;
+        pll->lost = true;
+    }
+
+    if (complete) {
+        resp.value.rate = ctx->current_rate;
+        sw_pll_ctx.clock_response_api->request_complete(clock_id, &resp);
+    }
+
+    return FWK_SUCCESS;
+}
+
+/*
+ * 電源域已開啟：以一段暫存器序列還原
+ * PLL 遺失時整顆 PLL 的所有輸出一起還原 (一次 lock + 一次寫入所有分頻器)，
+ * 否則只需寫回此輸出的分頻器
+ * (共用同一顆 PLL 的輸出假設位於同一個電源域，例如 cluster PLL)
+ */
+static int sw_pll_process_power_transition(fwk_id_t clock_id,
+                                           unsigned int state)
+{
+    struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(clock_id), *output;
+    struct sw_pll_pll_ctx *pll = ctx->pll;
+    const struct sw_pll_timing_config *timing = pll->timing;
+    uint64_t start, end;
+    unsigned int i;
+
+    if (state != MOD_PD_STATE_ON || !ctx->powered_off)
+        return FWK_SUCCESS;
+
+    start = FWK_MAX(sw_pll_ctx.now_ns, pll->busy_until_ns);
+
+    if (pll->lost)
+        end = start + 2 * (uint64_t)timing->mux_latency_ns +
+              timing->lock_time_ns + timing->div_switch_ns;
+    else
+        end = start + timing->div_switch_ns;
+
+    for (i = 0; i < sw_pll_ctx.dev_count; i++) {
+        output = &sw_pll_ctx.dev_ctx_table[i];
+        if (!output->powered_off ||
+            (output != ctx && (!pll->lost || output->pll != pll)))
+            continue;
+
+        output->out_div = output->saved.out_div;
+        output->current_rate = output->saved.rate;
+        output->source = output->saved.source;
+        output->state = output->saved.state;
+        output->powered_off = false;
+        pll->off_count--;
+
+        sw_pll_trace(i, SW_PLL_TRANSITION_RESTORE, start, end,
+                     output->saved.rate, output->saved.rate);
+    }
+
+    if (pll->lost) {
+        pll->vco_rate = pll->saved_vco_rate;
+        pll->lost = false;
+
+        /* 閒置的 ping-pong PLL 同樣斷電，下次轉換需重新 lock */
+        if (ctx->idle_pll != NULL)
+            ctx->idle_pll->vco_rate = 0;
+    }
+
+    pll->busy_until_ns = end;
+
+    return FWK_SUCCESS;
+}
+
+static int sw_pll_get_range(fwk_id_t clock_id, struct mod_clock_range *range)
+{
+    const struct myplatform_clock_config *config =
+        sw_pll_get_ctx(clock_id)->config;
+
+    range->rate_type = MOD_CLOCK_RATE_TYPE_CONTINUOUS;
+    range->min = config->min_rate;
+    range->max = config->max_rate;
+    range->step = config->step_size;
+
+    return FWK_SUCCESS;
+}
+
+/* Clock Driver API 表 (與 mod_myplatform_clock 相同介面) */
+static const struct mod_clock_drv_api sw_pll_api = {
+    .name = "SW PLL",
+    .set_rate = sw_pll_set_rate,
+    .get_rate = sw_pll_get_rate,
+    .set_state = sw_pll_set_state,
+    .get_state = sw_pll_get_state,
+    .get_range = sw_pll_get_range,
+    .process_pending_power_transition = sw_pll_process_pending_power_transition,
+    .process_power_transition = sw_pll_process_power_transition,
+};
+
+static const struct mod_myplatform_clock_preset_api sw_pll_preset_api = {
+    .apply_preset = sw_pll_apply_preset,
+    .get_timing = sw_pll_get_timing,
+    .begin_relock = sw_pll_begin_relock,
+    .finish_relock = sw_pll_finish_relock,
+    .estimate_lock = sw_pll_estimate_lock,
+};
+
+/*
+ * 模組框架介面
+ */
+
+static int sw_pll_init(fwk_id_t module_id, unsigned int element_count,
+                       const void *data)
+{
+    const struct sw_pll_config *config = data;
+
+    if (element_count == 0 || config == NULL)
+        return FWK_E_PARAM;
+
+    sw_pll_ctx.config = config;
+    sw_pll_ctx.dev_count = element_count;
+    sw_pll_ctx.dev_ctx_table = fwk_mm_calloc(element_count,
+                                             sizeof(struct sw_pll_dev_ctx));
+
+    /* 最壞情況每個元素各自一顆 PLL，ping-pong 元素再多一顆 */
+    sw_pll_ctx.pll_table = fwk_mm_calloc(element_count * 2,
+                                         sizeof(struct sw_pll_pll_ctx));
+    sw_pll_ctx.trace = fwk_mm_calloc(config->trace_capacity,
+                                     sizeof(struct sw_pll_trace_entry));
+
+    return FWK_SUCCESS;
+}
+
+static const struct sw_pll_timing_config *sw_pll_find_timing(
+    uintptr_t base_address)
+{
+    const struct sw_pll_config *config = sw_pll_ctx.config;
+    unsigned int i;
+
+    for (i = 0; i < config->timing_count; i++) {
+        if (config->timing_table[i].base_address == base_address)
+            return &config->timing_table[i];
+    }
+
+    return &config->default_timing;
+}
+
+/* 取得 (或建立) base_address 對應的 PLL，新建時 VCO 為 vco_rate */
+static struct sw_pll_pll_ctx *sw_pll_get_pll(uintptr_t base_address,
+                                             uint64_t vco_rate)
+{
+    const struct sw_pll_timing_config *timing =
+        sw_pll_find_timing(base_address);
+    struct sw_pll_pll_ctx *pll;
+    unsigned int i;
+
+    for (i = 0; i < sw_pll_ctx.pll_count; i++) {
+        pll = &sw_pll_ctx.pll_table[i];
+        if (pll->timing->base_address == base_address &&
+            pll->timing != &sw_pll_ctx.config->default_timing)
+            return pll;
+    }
+
+    pll = &sw_pll_ctx.pll_table[sw_pll_ctx.pll_count++];
+    pll->timing = timing;
+    pll->vco_rate = vco_rate;
+
+    return pll;
+}
+
+static int sw_pll_element_init(fwk_id_t element_id, unsigned int unused,
+                               const void *data)
+{
+    struct sw_pll_dev_ctx *ctx = sw_pll_get_ctx(element_id);
+    const struct myplatform_clock_config *config = data;
+
+    if (config == NULL)
+        return FWK_E_PARAM;
+
+    /* 開機狀態與真實硬體相同：以 pll_config 的預設值執行 */
+    ctx->config = config;
+    ctx->pll = sw_pll_get_pll(config->base_address,
+                              (uint64_t)config->pll_config.ref_freq *
+                              config->pll_config.multiplier /
+                              config->pll_config.divider);
+    ctx->pll->output_count++;
+
+    /*
+     * Ping-pong 需要兩顆專用的 PLL：角色互換後不能影響其他輸出
+     * 備用 PLL 開機時未 lock (VCO 為 0)
+     */
+    if (config->pll_mode == MYPLATFORM_CLOCK_PLL_MODE_PING_PONG) {
+        if (config->spare_base_address == 0 ||
+            config->spare_base_address == config->base_address ||
+            ctx->pll->output_count != 1)
+            return FWK_E_PARAM;
+
+        ctx->idle_pll = sw_pll_get_pll(config->spare_base_address, 0);
+        if (ctx->idle_pll->output_count++ != 0)
+            return FWK_E_PARAM;
+    }
+    ctx->source = SW_PLL_SOURCE_PLL;
+    ctx->out_div = config->pll_config.post_div;
+    ctx->current_rate = ctx->pll->vco_rate / ctx->out_div;
+    ctx->state = MOD_CLOCK_STATE_RUNNING;
+
+    return FWK_SUCCESS;
+}
+
+static int sw_pll_bind(fwk_id_t id, unsigned int round)
+{
+    if (round == 1 || !fwk_id_is_type(id, FWK_ID_TYPE_MODULE))
+        return FWK_SUCCESS;
+
+    return fwk_module_bind(FWK_ID_MODULE(FWK_MODULE_IDX_CLOCK),
+                           mod_clock_api_id_driver_response,
+                           &sw_pll_ctx.clock_response_api);
+}
+
+static int sw_pll_process_bind_request(fwk_id_t source_id,
+                                       fwk_id_t target_id,
+                                       fwk_id_t api_id,
+                                       const void **api)
+{
+    switch (fwk_id_get_api_idx(api_id)) {
+    case MOD_SW_PLL_API_IDX_DRIVER:
+        *api = &sw_pll_api;
+        break;
+
+    case MOD_SW_PLL_API_IDX_PRESET:
+        *api = &sw_pll_preset_api;
+        break;
+
+    default:
+        return FWK_E_PARAM;
+    }
+
+    return FWK_SUCCESS;
+}
+
+/* 模組描述符 */
+const struct fwk_module module_sw_pll = {
+    .name = "Software PLL Timing Model",
+    .type = FWK_MODULE_TYPE_DRIVER,
+    .api_count = MOD_SW_PLL_API_IDX_COUNT,
+    .init = sw_pll_init,
+    .element_init = sw_pll_element_init,
+    .bind = sw_pll_bind,
+    .process_bind_request = sw_pll_process_bind_request,
+};
+
+/*
+ * 時間軸範例 (開機套用 initial_rate，async = true)：
+ *
+ *   start_ns,end_ns,clock,kind,from_hz,to_hz
+ *   0,200000,CPU0_CLK,prelock,1200000000,1200000000
+ *   200000,210000,CPU0_CLK,swap,1200000000,1500000000
+ *   0,200000,CPU1_CLK,prelock,1200000000,1200000000
+ *   200000,210000,CPU1_CLK,swap,1200000000,1500000000
+ *   0,220000,CPU2_CLK,relock,1200000000,1500000000
+ *   0,220000,CPU3_CLK,relock,1200000000,1500000000
+ *   0,220000,GPU_CORE_CLK,relock,960000000,800000000
+ *
+ * 各 CPU PLL 的 base_address 不同，五個轉換在時間軸上完全重疊；
+ * 若改為共用同一顆 PLL，會變成首尾相接的序列。
+ *
+ * 同一筆 1.2GHz -> 1.5GHz 的兩種模式 (sw_pll_stats_dump)：
+ *
+ *   clock,mode,transitions,relocks,swaps,degraded_ns,lost_cycles
+ *   CPU0_CLK,ping-pong,1,1,1,10000,12000
+ *   CPU2_CLK,refclk,1,1,0,220000,259200
+ *
+ * REFCLK 停靠：220us 內只剩 24MHz，少跑 264000 - 4800 個週期；
+ * ping-pong：只有 10us 的 mux 切換，新頻率在 210us 生效。
+ * 切回前一個頻率時閒置 PLL 仍 lock 在舊 VCO，只需 10us 的 mux。
+ * 代價是閒置 PLL 一直保持 lock 的功耗，因此只給 CPU0/CPU1 cluster。
+ */
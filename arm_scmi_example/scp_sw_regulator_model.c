@@ -0,0 +1,163 @@
+/*
+ * SCP Firmware Software Regulator Model Example
+ *
+ * 電壓調節器 (PMIC buck / rail) 的純軟體模型，與 scp_sw_pll_model.c 搭配，
+ * 讓 DVFS transition engine 可以在 host / CI 上執行並得到決定性的時間估計。
+ *
+ * 每個元素是一條電源 rail；時序模型：
+ *   settle_ns = |ΔV| / slew_rate + settle_time_ns
+ * 實作 mod_dvfs_regulator_api (scp_dvfs_transition.c)；真實平台上由 PMIC 驅動
+ * (例如經 I2C 的 mod_psu driver) 實作，set_voltage 只送出命令、不等待穩定，
+ * 等待由呼叫端依 get_settle_time 安排。
+ */
+
+#include <fwk_id.h>
+#include <fwk_log.h>
+#include <fwk_macros.h>
+#include <fwk_mm.h>
+#include <fwk_module.h>
+#include <fwk_module_idx.h>
+#include <fwk_status.h>
+#include <mod_dvfs_transition.h>
+
+/* rail 設定 */
+struct sw_regulator_config {
+    /* 開機電壓 (mV) */
+    uint32_t initial_voltage;
+
+    /* 合法範圍 (mV) */
+    uint32_t min_voltage;
+    uint32_t max_voltage;
+
+    /* 電壓爬升/下降速率 (mV/us) */
+    uint32_t slew_rate;
+
+    /* 到達目標後的固定穩定時間 (ns) */
+    uint32_t settle_time_ns;
+};
+
+struct sw_regulator_dev_ctx {
+    const struct sw_regulator_config *config;
+    uint32_t voltage;
+
+    /* 統計：調整次數與累計穩定時間 */
+    unsigned int set_count;
+    uint64_t settle_total_ns;
+};
+
+struct sw_regulator_ctx {
+    struct sw_regulator_dev_ctx *dev_ctx_table;
+    unsigned int dev_count;
+};
+
+static struct sw_regulator_ctx sw_regulator_ctx;
+
+static struct sw_regulator_dev_ctx *sw_regulator_get_ctx(fwk_id_t id)
+{
+    return &sw_regulator_ctx.dev_ctx_table[fwk_id_get_element_idx(id)];
+}
+
+static uint32_t sw_regulator_settle_ns(const struct sw_regulator_config *config,
+                                       uint32_t from, uint32_t to)
+{
+    uint32_t delta = (from > to) ? (from - to) : (to - from);
+
+    if (delta == 0)
+        return 0;
+
+    /* 無條件進位，模型寧可高估 */
+    return (delta * 1000 + config->slew_rate - 1) / config->slew_rate +
+           config->settle_time_ns;
+}
+
+static int sw_regulator_set_voltage(fwk_id_t regulator_id, uint32_t voltage)
+{
+    struct sw_regulator_dev_ctx *ctx = sw_regulator_get_ctx(regulator_id);
+
+    if (voltage < ctx->config->min_voltage ||
+        voltage > ctx->config->max_voltage)
+        return FWK_E_RANGE;
+
+    ctx->settle_total_ns += sw_regulator_settle_ns(ctx->config, ctx->voltage,
+                                                   voltage);
+    ctx->set_count++;
+    ctx->voltage = voltage;
+
+    return FWK_SUCCESS;
+}
+
+static int sw_regulator_get_voltage(fwk_id_t regulator_id, uint32_t *voltage)
+{
+    *voltage = sw_regulator_get_ctx(regulator_id)->voltage;
+
+    return FWK_SUCCESS;
+}
+
+static int sw_regulator_get_settle_time(fwk_id_t regulator_id, uint32_t from,
+                                        uint32_t to, uint32_t *settle_ns)
+{
+    *settle_ns = sw_regulator_settle_ns(
+        sw_regulator_get_ctx(regulator_id)->config, from, to);
+
+    return FWK_SUCCESS;
+}
+
+static const struct mod_dvfs_regulator_api sw_regulator_api = {
+    .set_voltage = sw_regulator_set_voltage,
+    .get_voltage = sw_regulator_get_voltage,
+    .get_settle_time = sw_regulator_get_settle_time,
+};
+
+/*
+ * 模組框架介面
+ */
+
+static int sw_regulator_init(fwk_id_t module_id, unsigned int element_count,
+                             const void *data)
+{
+    if (element_count == 0)
+        return FWK_E_PARAM;
+
+    sw_regulator_ctx.dev_count = element_count;
+    sw_regulator_ctx.dev_ctx_table = fwk_mm_calloc(element_count,
+        sizeof(struct sw_regulator_dev_ctx));
+
+    return FWK_SUCCESS;
+}
+
+static int sw_regulator_element_init(fwk_id_t element_id, unsigned int unused,
+                                     const void *data)
+{
+    struct sw_regulator_dev_ctx *ctx = sw_regulator_get_ctx(element_id);
+    const struct sw_regulator_config *config = data;
+
+    if (config == NULL || config->slew_rate == 0 ||
+        config->initial_voltage < config->min_voltage ||
+        config->initial_voltage > config->max_voltage)
+        return FWK_E_PARAM;
+
+    ctx->config = config;
+    ctx->voltage = config->initial_voltage;
+
+    return FWK_SUCCESS;
+}
+
+static int sw_regulator_process_bind_request(fwk_id_t source_id,
+                                             fwk_id_t target_id,
+                                             fwk_id_t api_id,
+                                             const void **api)
+{
+    *api = &sw_regulator_api;
+
+    return FWK_SUCCESS;
+}
+
+/* 模組描述符 */
+const struct fwk_module module_sw_regulator = {
+    .name = "Software Regulator Model",
+    .type = FWK_MODULE_TYPE_DRIVER,
+    .api_count = 1,
+    .init = sw_regulator_init,
+    .element_init = sw_regulator_element_init,
+    .process_bind_request = sw_regulator_process_bind_request,
+};
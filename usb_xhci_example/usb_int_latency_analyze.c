@@ -0,0 +1,588 @@
+/*
+ * Interrupt Transfer Latency Analyzer (userspace)
+ *
+ * 讀取 usb_int_lat tracepoint 的 trace_pipe 輸出 (usb_int_latency_trace.h)，
+ * 以 urb 指標把每一輪的 submit / sched / event / callback 串起來，
+ * 對每個端點輸出四個直方圖：
+ *
+ *   schedule lag      event 的 microframe - 預期服務的 microframe
+ *                     [0, interval) 為準時，每多一個 interval 代表錯過一個 ESIT
+ *   period jitter     相鄰兩次成功完成的時間間隔 - interval (us)
+ *   event->callback   HCD 處理 event 到進入完成回調 (giveback 的 BH 延遲)
+ *   submit->callback  整輪時間
+ *
+ * 另外統計 missed ESIT：以 event 的 MFINDEX 算出每次完成落在哪個 ESIT
+ * (microframe / interval)，相鄰兩次成功完成相隔 k 個 ESIT 時記 k - 1 次，
+ * 與 usb_int_stream 以 frame number 計算 missed_intervals 的方式相同。
+ * 不用 trace 時間戳記的間隔：那是 HCD 處理 event 的時間，與 xHC 的
+ * ESIT 邊界沒有對齊。event 的 MFINDEX 同樣是處理時才讀取，中斷延遲
+ * 把一次完成推到下一個 ESIT 時，前一對多記 1、下一對少記 1 (k = 0)，
+ * 所以以有號值累加，整段的總數仍是經過的 ESIT 數減去完成次數。
+ * 14 位元的 MFINDEX 每 2048ms 循環，間隔超過半圈時以時間戳記補回。
+ *
+ * 不需要實體裝置：載入 dummy_hcd 與 HID gadget (步驟見
+ * usb-interrupt-transfer-xhci.md §11.9.8)，開啟 tracepoint 後執行
+ *
+ *   cat /sys/kernel/tracing/trace_pipe > int_lat.txt
+ *   ./usb_int_latency_analyze int_lat.txt
+ *
+ * 編譯：
+ *   gcc -O2 -o usb_int_latency_analyze usb_int_latency_analyze.c
+ *   ./usb_int_latency_analyze [trace file]     (預設讀 stdin)
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UFRAME_MASK         0x3fff
+#define UFRAME_WRAP         (UFRAME_MASK + 1)
+#define UFRAME_US           125
+#define MAX_ENDPOINTS       64
+#define URB_TABLE_SIZE      4096        /* 2 的次方 */
+#define LIN_BUCKETS         40
+#define LOG_BUCKETS         20
+#define BAR_WIDTH           40
+
+/* 線性直方圖：[lo, lo + width * LIN_BUCKETS)，之外計入兩端 */
+struct lin_hist {
+    int64_t lo;
+    int64_t width;
+    unsigned long bucket[LIN_BUCKETS];
+    unsigned long under;
+    unsigned long over;
+    unsigned long count;
+    int64_t sum;
+    int64_t min;
+    int64_t max;
+};
+
+/* log2 直方圖 (us)：bucket i 為 [2^(i-1), 2^i)，bucket 0 為 [0, 1) */
+struct log_hist {
+    unsigned long bucket[LOG_BUCKETS];
+    unsigned long count;
+    double sum;
+    double max;
+};
+
+struct endpoint {
+    unsigned int busnum;
+    unsigned int devnum;
+    unsigned int epaddr;
+    unsigned int interval;          /* microframe */
+
+    unsigned long rounds;
+    unsigned long errors;
+    long missed_esit;               /* 有號累加，見檔頭說明 */
+    double last_complete;           /* 秒，0 表示尚無 */
+    uint32_t last_uframe;           /* 上一次成功完成的 MFINDEX */
+
+    struct lin_hist lag;            /* microframe */
+    struct lin_hist period;         /* us */
+    struct log_hist event_cb;
+    struct log_hist submit_cb;
+};
+
+/* 進行中的一輪，以 urb 指標為 key；刪除留下標記，避免中斷探測鏈 */
+#define URB_SLOT_FREE       -1
+#define URB_SLOT_DELETED    -2
+
+struct urb_round {
+    uint64_t urb;
+    int ep;                         /* 端點索引或 URB_SLOT_* */
+    double submit_ts;
+    double event_ts;
+    uint32_t sched_uframe;
+    bool sched_valid;
+    bool event_valid;
+};
+
+static struct endpoint endpoints[MAX_ENDPOINTS];
+static unsigned int nr_endpoints;
+static struct urb_round urbs[URB_TABLE_SIZE];
+static unsigned long unmatched;
+
+static void lin_init(struct lin_hist *h, int64_t lo, int64_t width)
+{
+    memset(h, 0, sizeof(*h));
+    h->lo = lo;
+    h->width = width > 0 ? width : 1;
+}
+
+static void lin_add(struct lin_hist *h, int64_t v)
+{
+    int64_t idx;
+
+    if (!h->count || v < h->min)
+        h->min = v;
+    if (!h->count || v > h->max)
+        h->max = v;
+    h->count++;
+    h->sum += v;
+
+    if (v < h->lo) {
+        h->under++;
+        return;
+    }
+
+    idx = (v - h->lo) / h->width;
+    if (idx >= LIN_BUCKETS)
+        h->over++;
+    else
+        h->bucket[idx]++;
+}
+
+/* 以 bucket 上界近似的百分位數 */
+static int64_t lin_percentile(const struct lin_hist *h, double pct)
+{
+    unsigned long target = (unsigned long)(h->count * pct), seen = h->under;
+    unsigned int i;
+
+    if (seen > target)
+        return h->min;
+
+    for (i = 0; i < LIN_BUCKETS; i++) {
+        seen += h->bucket[i];
+        if (seen > target)
+            return h->lo + (int64_t)(i + 1) * h->width;
+    }
+
+    return h->max;
+}
+
+static void log_add(struct log_hist *h, double us)
+{
+    unsigned int idx = 0;
+    double bound = 1.0;
+
+    if (us < 0)
+        us = 0;
+
+    while (us >= bound && idx < LOG_BUCKETS - 1) {
+        bound *= 2;
+        idx++;
+    }
+
+    h->bucket[idx]++;
+    h->count++;
+    h->sum += us;
+    if (us > h->max)
+        h->max = us;
+}
+
+static void print_bar(unsigned long n, unsigned long peak)
+{
+    unsigned int len = peak ? (unsigned int)(n * BAR_WIDTH / peak) : 0;
+
+    if (n && !len)
+        len = 1;
+    while (len--)
+        putchar('#');
+    putchar('\n');
+}
+
+static void lin_print(const char *title, const char *unit,
+                      const struct lin_hist *h)
+{
+    unsigned long peak = h->under > h->over ? h->under : h->over;
+    unsigned int i;
+
+    printf("  %s (%s)  n=%lu", title, unit, h->count);
+    if (!h->count) {
+        printf("\n");
+        return;
+    }
+    printf("  min %" PRId64 "  avg %.1f  p99 %" PRId64 "  max %" PRId64 "\n",
+           h->min, (double)h->sum / h->count, lin_percentile(h, 0.99), h->max);
+
+    for (i = 0; i < LIN_BUCKETS; i++)
+        if (h->bucket[i] > peak)
+            peak = h->bucket[i];
+
+    if (h->under) {
+        printf("    %13s < %-6" PRId64 " %8lu ", "", h->lo, h->under);
+        print_bar(h->under, peak);
+    }
+    for (i = 0; i < LIN_BUCKETS; i++) {
+        if (!h->bucket[i])
+            continue;
+        printf("    [%6" PRId64 ", %6" PRId64 ")       %8lu ",
+               h->lo + (int64_t)i * h->width,
+               h->lo + (int64_t)(i + 1) * h->width, h->bucket[i]);
+        print_bar(h->bucket[i], peak);
+    }
+    if (h->over) {
+        printf("    %13s >= %-5" PRId64 " %8lu ", "",
+               h->lo + (int64_t)LIN_BUCKETS * h->width, h->over);
+        print_bar(h->over, peak);
+    }
+}
+
+static void log_print(const char *title, const struct log_hist *h)
+{
+    unsigned long peak = 0;
+    unsigned int i, lo;
+
+    printf("  %s (us)  n=%lu", title, h->count);
+    if (!h->count) {
+        printf("\n");
+        return;
+    }
+    printf("  avg %.1f  max %.1f\n", h->sum / h->count, h->max);
+
+    for (i = 0; i < LOG_BUCKETS; i++)
+        if (h->bucket[i] > peak)
+            peak = h->bucket[i];
+
+    for (i = 0; i < LOG_BUCKETS; i++) {
+        if (!h->bucket[i])
+            continue;
+        lo = i ? 1U << (i - 1) : 0;
+        if (i == LOG_BUCKETS - 1)
+            printf("    [%6u,    inf)       %8lu ", lo, h->bucket[i]);
+        else
+            printf("    [%6u, %6u)       %8lu ", lo, 1U << i, h->bucket[i]);
+        print_bar(h->bucket[i], peak);
+    }
+}
+
+static int find_endpoint(unsigned int busnum, unsigned int devnum,
+                         unsigned int epaddr, unsigned int interval)
+{
+    struct endpoint *ep;
+    unsigned int i;
+
+    for (i = 0; i < nr_endpoints; i++) {
+        ep = &endpoints[i];
+        if (ep->busnum == busnum && ep->devnum == devnum &&
+            ep->epaddr == epaddr)
+            return i;
+    }
+
+    if (nr_endpoints == MAX_ENDPOINTS)
+        return -1;
+
+    ep = &endpoints[nr_endpoints];
+    memset(ep, 0, sizeof(*ep));
+    ep->busnum = busnum;
+    ep->devnum = devnum;
+    ep->epaddr = epaddr;
+    ep->interval = interval ? interval : 1;
+
+    /* 範圍從提早 1 個 interval 到晚 4 個 interval，每個 interval 切成 8 格 */
+    lin_init(&ep->lag, -(int64_t)ep->interval,
+             ep->interval >= 8 ? ep->interval / 8 : 1);
+    lin_init(&ep->period, -(int64_t)ep->interval * UFRAME_US,
+             ep->interval * UFRAME_US / 8);
+
+    return nr_endpoints++;
+}
+
+static struct urb_round *lookup_urb(uint64_t urb, bool create)
+{
+    unsigned int i, idx = (unsigned int)((urb >> 4) ^ (urb >> 16));
+    struct urb_round *r, *reuse = NULL;
+
+    for (i = 0; i < URB_TABLE_SIZE; i++) {
+        r = &urbs[(idx + i) & (URB_TABLE_SIZE - 1)];
+
+        if (r->ep >= 0 && r->urb == urb)
+            return r;
+        if (r->ep == URB_SLOT_DELETED && !reuse)
+            reuse = r;
+        if (r->ep == URB_SLOT_FREE) {
+            if (!reuse)
+                reuse = r;
+            break;
+        }
+    }
+
+    if (!create || !reuse)
+        return NULL;
+
+    reuse->urb = urb;
+    reuse->ep = URB_SLOT_FREE;
+
+    return reuse;
+}
+
+/* 兩個 14 位元 microframe 的有號差值 */
+static int32_t uframe_diff(uint32_t a, uint32_t b)
+{
+    int32_t d = (int32_t)((a - b) & UFRAME_MASK);
+
+    return d >= (UFRAME_MASK + 1) / 2 ? d - (UFRAME_MASK + 1) : d;
+}
+
+/* 從 "key=value" 欄位取數值 */
+static bool field(const char *s, const char *key, int base, uint64_t *val)
+{
+    const char *p = strstr(s, key);
+    char *end;
+
+    if (!p)
+        return false;
+    p += strlen(key);
+    *val = strtoull(p, &end, base);
+
+    return end != p;
+}
+
+static bool field_int(const char *s, const char *key, int64_t *val)
+{
+    const char *p = strstr(s, key);
+    char *end;
+
+    if (!p)
+        return false;
+    p += strlen(key);
+    *val = strtoll(p, &end, 10);
+
+    return end != p;
+}
+
+static void on_submit(double ts, const char *args)
+{
+    uint64_t urb, bus, dev, epaddr, interval;
+    struct urb_round *r;
+    int ep;
+
+    if (!field(args, "urb=", 16, &urb) || !field(args, "bus=", 10, &bus) ||
+        !field(args, "dev=", 10, &dev) || !field(args, "ep=", 16, &epaddr) ||
+        !field(args, "interval=", 10, &interval))
+        return;
+
+    ep = find_endpoint(bus, dev, epaddr, interval);
+    r = lookup_urb(urb, true);
+    if (ep < 0 || !r)
+        return;
+
+    /* 上一輪沒有 callback 就被重新提交：丟棄 */
+    if (r->ep >= 0)
+        unmatched++;
+
+    r->ep = ep;
+    r->submit_ts = ts;
+    r->sched_valid = false;
+    r->event_valid = false;
+}
+
+static void on_sched(const char *args)
+{
+    uint64_t urb, sched;
+    struct urb_round *r;
+
+    if (!field(args, "urb=", 16, &urb) || !field(args, "sched=", 10, &sched))
+        return;
+
+    r = lookup_urb(urb, false);
+    if (!r)
+        return;
+
+    r->sched_uframe = sched;
+    r->sched_valid = true;
+}
+
+static void on_event(double ts, const char *args)
+{
+    uint64_t urb, uframe;
+    int64_t status;
+    struct urb_round *r;
+    struct endpoint *ep;
+    double gap_us;
+    int64_t gap_uf, wraps;
+    long k;
+
+    if (!field(args, "urb=", 16, &urb) || !field(args, "uframe=", 10, &uframe) ||
+        !field_int(args, "status=", &status))
+        return;
+
+    r = lookup_urb(urb, false);
+    if (!r)
+        return;
+    ep = &endpoints[r->ep];
+
+    r->event_ts = ts;
+    r->event_valid = true;
+
+    if (status) {
+        /* unlink、stall 等不算入排程統計 */
+        ep->errors++;
+        return;
+    }
+
+    if (r->sched_valid)
+        lin_add(&ep->lag, uframe_diff(uframe, r->sched_uframe));
+
+    if (ep->last_complete > 0) {
+        gap_us = (ts - ep->last_complete) * 1e6;
+        lin_add(&ep->period,
+                (int64_t)(gap_us - (double)ep->interval * UFRAME_US));
+
+        /* MFINDEX 的差值，超過一圈的部分由時間戳記推算 */
+        gap_uf = (uframe - ep->last_uframe) & UFRAME_MASK;
+        wraps = (int64_t)((gap_us / UFRAME_US - gap_uf) / UFRAME_WRAP + 0.5);
+        if (wraps > 0)
+            gap_uf += wraps * UFRAME_WRAP;
+
+        /* 兩次完成所在 ESIT 的編號差；ESIT 起點是 interval 的倍數 */
+        k = (long)((ep->last_uframe + gap_uf) / ep->interval -
+                   ep->last_uframe / ep->interval);
+        ep->missed_esit += k - 1;
+    }
+    ep->last_complete = ts;
+    ep->last_uframe = uframe;
+}
+
+static void on_callback(double ts, const char *args)
+{
+    uint64_t urb;
+    struct urb_round *r;
+    struct endpoint *ep;
+
+    if (!field(args, "urb=", 16, &urb))
+        return;
+
+    r = lookup_urb(urb, false);
+    if (!r)
+        return;
+    ep = &endpoints[r->ep];
+
+    ep->rounds++;
+    if (r->event_valid)
+        log_add(&ep->event_cb, (ts - r->event_ts) * 1e6);
+    log_add(&ep->submit_cb, (ts - r->submit_ts) * 1e6);
+
+    /* 這一輪結束，urb 可能被重新提交 */
+    r->ep = URB_SLOT_DELETED;
+}
+
+/*
+ * trace_pipe 的一行：
+ *   <task>-<pid> [cpu] flags  12345.678901: usb_int_lat_event: urb=... uframe=...
+ */
+static void parse_line(const char *line)
+{
+    const char *name = strstr(line, " usb_int_lat_");
+    const char *p, *args;
+    double ts;
+
+    if (!name)
+        return;
+
+    /* 事件名稱前的 "12345.678901:" */
+    p = name;
+    while (p > line && p[-1] == ':')
+        p--;
+    while (p > line && (p[-1] == '.' || (p[-1] >= '0' && p[-1] <= '9')))
+        p--;
+    ts = strtod(p, NULL);
+
+    name += strlen(" usb_int_lat_");
+    args = strchr(name, ':');
+    if (!args)
+        return;
+
+    if (!strncmp(name, "submit:", 7))
+        on_submit(ts, args);
+    else if (!strncmp(name, "sched:", 6))
+        on_sched(args);
+    else if (!strncmp(name, "event:", 6))
+        on_event(ts, args);
+    else if (!strncmp(name, "callback:", 9))
+        on_callback(ts, args);
+}
+
+int main(int argc, char **argv)
+{
+    char line[512];
+    FILE *f = stdin;
+    unsigned int i;
+
+    if (argc > 1) {
+        f = fopen(argv[1], "r");
+        if (!f) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    for (i = 0; i < URB_TABLE_SIZE; i++)
+        urbs[i].ep = URB_SLOT_FREE;
+
+    while (fgets(line, sizeof(line), f))
+        parse_line(line);
+
+    if (f != stdin)
+        fclose(f);
+
+    for (i = 0; i < nr_endpoints; i++) {
+        struct endpoint *ep = &endpoints[i];
+
+        printf("bus %u dev %u ep 0x%02x  interval %u uframes (%u us)  "
+               "rounds %lu  errors %lu  missed ESIT %ld\n",
+               ep->busnum, ep->devnum, ep->epaddr, ep->interval,
+               ep->interval * UFRAME_US, ep->rounds, ep->errors,
+               ep->missed_esit > 0 ? ep->missed_esit : 0);
+        lin_print("schedule lag", "uframes, event - sched", &ep->lag);
+        lin_print("period jitter", "us, gap - interval", &ep->period);
+        log_print("event -> callback", &ep->event_cb);
+        log_print("submit -> callback", &ep->submit_cb);
+        printf("\n");
+    }
+
+    if (unmatched)
+        printf("%lu rounds resubmitted without a callback were dropped\n",
+               unmatched);
+
+    return 0;
+}
+
+/*
+ * 輸出範例：
+ *
+ * 以下的輸入是依 tracepoint 格式產生的合成 trace，不是實機擷取：單一 URB
+ * 在回調中重新提交，interval 8 uframes；在 ESIT 內的第 0-3 個
+ * microframe 服務，2% 的輪次延後一個 ESIT，回調延遲 3-40us。
+ * 工具把延後的 99 輪同時計入 lag 的 [8, 12) 與 missed ESIT。
+ *
+ *   bus 1 dev 2 ep 0x81  interval 8 uframes (1000 us)  rounds 5000  errors 0  missed ESIT 99
+ *     schedule lag (uframes, event - sched)  n=5000  min 0  avg 1.7  p99 10  max 11
+ *       [     0,      1)           1202 #####################################
+ *       [     1,      2)           1269 #######################################
+ *       [     2,      3)           1142 ###################################
+ *       [     3,      4)           1288 ########################################
+ *       [     8,      9)             33 #
+ *       [     9,     10)             25 #
+ *       [    10,     11)             22 #
+ *       [    11,     12)             19 #
+ *     period jitter (us, gap - interval)  n=4999  min -387  avg 19.8  p99 1000  max 1379
+ *       [  -500,   -375)            137 ####
+ *       [  -375,   -250)            471 ################
+ *       [  -250,   -125)            719 #########################
+ *       [  -125,      0)           1044 #####################################
+ *       [     0,    125)           1115 ########################################
+ *       [   125,    250)            795 ############################
+ *       [   250,    375)            463 ################
+ *       [   375,    500)            156 #####
+ *       [   500,    625)              5 #
+ *       [   625,    750)             12 #
+ *       [   750,    875)             16 #
+ *       [   875,   1000)             29 #
+ *       [  1000,   1125)             17 #
+ *       [  1125,   1250)              9 #
+ *       [  1250,   1375)              6 #
+ *       [  1375,   1500)              5 #
+ *     event -> callback (us)  n=5000  avg 13.3  max 40.0
+ *       [     2,      4)           1285 #############################
+ *       [     4,      8)           1736 ########################################
+ *       [     8,     16)            924 #####################
+ *       [    32,     64)           1055 ########################
+ *     submit -> callback (us)  n=5000  avg 999.8  max 2395.0
+ *       [   512,   1024)           3035 ########################################
+ *       [  1024,   2048)           1939 #########################
+ *       [  2048,   4096)             26 #
+ */
@@ -0,0 +1,175 @@
+/*
+ * Interrupt Transfer Latency Tracepoint Hooks
+ *
+ * usb-interrupt-transfer-xhci.md §11.9 說明 interrupt 端點依 MFINDEX /
+ * bInterval 排程。這裡在 URB 一輪的四個位置加上 tracepoint
+ * (定義見 usb_int_latency_trace.h)，讓 usb_int_latency_analyze 比對
+ * 實際完成時間與排程的差距：
+ *
+ *   usb_hcd_submit_urb()           usbcore    submit
+ *   xhci_queue_intr_tx()           xhci       sched (讀 MFINDEX)
+ *   dummy_urb_enqueue()            dummy_hcd  sched (ktime 換算)
+ *   xhci_giveback_urb_in_irq()     xhci       event
+ *   dummy_timer() 歸還 URB 時      dummy_hcd  event
+ *   __usb_hcd_giveback_urb()       usbcore    callback
+ *
+ * 「event」記錄的是 HCD 處理 Transfer Event 的時間，Transfer Event 本身
+ * 不帶時間戳記；它與 xHC 寫入 event 之間還有中斷延遲 (xhci_event_poll.c
+ * 的 irq_to_poll 統計)。
+ *
+ * 預期服務的 microframe 取 TD 入隊之後的下一個 ESIT 起點，再依端點上
+ * 排在前面、尚未完成的 TD 數往後推：每個 ESIT 只服務一個 TD，前面有
+ * n 個 TD 時這個 TD 最早在第 n + 1 個 ESIT 完成。xHC 在 ESIT 內的哪個
+ * microframe 服務端點由硬體決定，所以 lag 落在 [0, interval) 都算準時，
+ * >= interval 表示錯過了一個 ESIT；入隊時目前的 ESIT 尚未服務過的話，
+ * lag 會是負值。
+ *
+ * 使用：
+ *   echo 1 > /sys/kernel/tracing/events/usb_int_lat/enable
+ *   cat /sys/kernel/tracing/trace_pipe > int_lat.txt
+ *   ./usb_int_latency_analyze int_lat.txt
+ *
+ * usbcore 以 CREATE_TRACE_POINTS 產生 tracepoint，sched / event 匯出給
+ * HCD 模組；Makefile 需要 CFLAGS_hcd.o := -I$(src)
+ */
+
+#include <linux/ktime.h>
+#include <linux/usb.h>
+#include <linux/usb/hcd.h>
+
+#define CREATE_TRACE_POINTS
+#include "usb_int_latency_trace.h"
+
+EXPORT_TRACEPOINT_SYMBOL_GPL(usb_int_lat_sched);
+EXPORT_TRACEPOINT_SYMBOL_GPL(usb_int_lat_event);
+
+/* ---------------------------------------------------------------------- */
+/* drivers/usb/core/hcd.c */
+
+int usb_hcd_submit_urb(struct urb *urb, gfp_t mem_flags)
+{
+    struct usb_hcd *hcd = bus_to_hcd(urb->dev->bus);
+    int status;
+
+    /* ... 原本的 usbmon_urb_submit()、usb_get_urb() 等 ... */
+
+    if (usb_pipeint(urb->pipe))
+        trace_usb_int_lat_submit(urb);
+
+    /* ... 原本的 rh_urb_enqueue() / hcd->driver->urb_enqueue() ... */
+    status = hcd->driver->urb_enqueue(hcd, urb, mem_flags);
+
+    return status;
+}
+
+static void __usb_hcd_giveback_urb(struct urb *urb)
+{
+    /* ... 原本的 unmap_urb_for_dma()、usbmon_urb_complete() 等 ... */
+
+    if (usb_pipeint(urb->pipe))
+        trace_usb_int_lat_callback(urb);
+
+    /* 完成回調 (ld_interrupt_complete() 等) */
+    urb->complete(urb);
+}
+
+/* ---------------------------------------------------------------------- */
+/* drivers/usb/host/xhci-ring.c */
+
+int xhci_queue_intr_tx(struct xhci_hcd *xhci, gfp_t mem_flags,
+        struct urb *urb, int slot_id, unsigned int ep_index)
+{
+    struct xhci_ring *ep_ring = xhci->devs[slot_id]->eps[ep_index].ring;
+    struct xhci_ep_ctx *ep_ctx;
+    u32 xhci_interval, uframe, ahead;
+
+    ep_ctx = xhci_get_ep_ctx(xhci, xhci->devs[slot_id]->out_ctx, ep_index);
+    xhci_interval = EP_INTERVAL_TO_UFRAMES(le32_to_cpu(ep_ctx->ep_info));
+
+    /* ... 原本的 check_interval() ... */
+
+    /*
+     * tracepoint 關閉時不讀 MFINDEX；呼叫者持有 xhci->lock，td_list 上是
+     * 已入隊、尚未完成的 TD，這個 URB 的 TD 還沒加入
+     */
+    if (trace_usb_int_lat_sched_enabled()) {
+        uframe = readl(&xhci->run_regs->microframe_index);
+        ahead = list_count_nodes(&ep_ring->td_list);
+        trace_usb_int_lat_sched(urb, uframe, ahead,
+                usb_int_lat_expected_esit(uframe, xhci_interval, ahead));
+    }
+
+    return xhci_queue_bulk_tx(xhci, mem_flags, urb, slot_id, ep_index);
+}
+
+/* §11.4 步驟 4.4：呼叫者持有 xhci->lock */
+static void xhci_giveback_urb_in_irq(struct xhci_hcd *xhci,
+        struct xhci_td *cur_td, int status)
+{
+    struct urb *urb = cur_td->urb;
+    struct usb_hcd *hcd = bus_to_hcd(urb->dev->bus);
+
+    if (usb_pipeint(urb->pipe) && trace_usb_int_lat_event_enabled())
+        trace_usb_int_lat_event(urb,
+                readl(&xhci->run_regs->microframe_index),
+                status, urb->actual_length);
+
+    xhci_urb_free_priv(urb->hcpriv);
+    usb_hcd_unlink_urb_from_ep(hcd, urb);
+    spin_unlock(&xhci->lock);
+    usb_hcd_giveback_urb(hcd, urb, status);
+    spin_lock(&xhci->lock);
+}
+
+/* ---------------------------------------------------------------------- */
+/* drivers/usb/gadget/udc/dummy_hcd.c */
+
+/*
+ * dummy_hcd 沒有 MFINDEX，以 ktime 換算成 125us 的虛擬 microframe；
+ * 分析時只用 microframe 之間的差值，不需要與 trace 時鐘對齊
+ */
+static u32 dummy_int_lat_uframe(void)
+{
+    return div_u64(ktime_get_ns(), 125 * NSEC_PER_USEC);
+}
+
+static int dummy_urb_enqueue(struct usb_hcd *hcd, struct urb *urb,
+        gfp_t mem_flags)
+{
+    struct dummy_hcd *dum_hcd = hcd_to_dummy_hcd(hcd);
+    struct urbp *pos;
+    u32 uframe, ahead = 0;
+
+    /* ... 原本的 urbp 配置與 usb_hcd_link_urb_to_ep() ... */
+
+    /* dum->lock 下、list_add_tail(&urbp->urbp_list, ...) 之前 */
+    if (usb_pipeint(urb->pipe) && trace_usb_int_lat_sched_enabled()) {
+        list_for_each_entry(pos, &dum_hcd->urbp_list, urbp_list)
+            if (pos->urb->ep == urb->ep)
+                ahead++;
+
+        uframe = dummy_int_lat_uframe();
+        trace_usb_int_lat_sched(urb, uframe, ahead,
+                usb_int_lat_expected_esit(uframe,
+                        usb_int_lat_interval_uframes(urb), ahead));
+    }
+
+    /* ... 原本的 list_add_tail() 與 timer 啟動 ... */
+    return 0;
+}
+
+/*
+ * dummy_timer() 在 urb 完成、跳到 return 標籤歸還之前：
+ *
+ *   return:
+ *       if (usb_pipeint(urb->pipe))
+ *           trace_usb_int_lat_event(urb, dummy_int_lat_uframe(),
+ *                                   status, urb->actual_length);
+ *       list_del(&urbp->urbp_list);
+ *       ...
+ *       usb_hcd_giveback_urb(dummy_hcd_to_hcd(dum_hcd), urb, status);
+ *
+ * 注意 dummy_timer() 目前每個 timer tick 都服務 interrupt URB，不看
+ * urb->interval (原始碼中的 FIXME)；在 dummy_hcd 上完成間隔可能短於
+ * interval、lag 出現負值，這正是工具應該顯示出來的偏差。
+ */
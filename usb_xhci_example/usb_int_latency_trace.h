@@ -0,0 +1,146 @@
+/*
+ * Interrupt Transfer Latency Tracepoints
+ *
+ * 一個 interrupt URB 的每一輪記錄四個時間點，以 urb 指標串起來：
+ *
+ *   usb_int_lat_submit    usb_hcd_submit_urb()       提交時間
+ *   usb_int_lat_sched     HCD 把 TD 放上端點時       目前 microframe、
+ *                                                     排在前面的 TD 數與
+ *                                                     預期服務的 microframe
+ *   usb_int_lat_event     HCD 處理 Transfer Event 時 microframe 與完成狀態
+ *   usb_int_lat_callback  __usb_hcd_giveback_urb()   進入 urb->complete() 前
+ *
+ * microframe 一律以 125us 為單位、14 位元循環 (與 MFINDEX 相同)；
+ * xHCI 直接讀 MFINDEX，dummy_hcd 以 ktime 換算。
+ * 使用方式與分析工具見 usb_int_latency_analyze.c
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM usb_int_lat
+
+#if !defined(__USB_INT_LATENCY_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define __USB_INT_LATENCY_TRACE_H
+
+#include <linux/tracepoint.h>
+#include <linux/usb.h>
+
+/* MFINDEX 為 14 位元，每 2048ms 循環一次 */
+#define USB_INT_LAT_UFRAME_MASK     0x3fff
+
+/* urb->interval 在 HS 以上是 microframe，FS/LS 是 frame */
+static inline u32 usb_int_lat_interval_uframes(const struct urb *urb)
+{
+    if (urb->dev->speed >= USB_SPEED_HIGH)
+        return urb->interval;
+
+    return urb->interval * 8;
+}
+
+/*
+ * uframe 之後的下一個 ESIT 起點，呼叫者再以 USB_INT_LAT_UFRAME_MASK 截斷
+ * xHCI 把 interval 取為 2 的次方，ESIT 起點是 interval 的倍數
+ */
+static inline u32 usb_int_lat_next_esit(u32 uframe, u32 interval)
+{
+    if (!interval)
+        interval = 1;
+
+    return (uframe / interval + 1) * interval;
+}
+
+/*
+ * 預期服務的 ESIT 起點：端點每個 ESIT 服務一個 TD，前面還有 ahead 個
+ * TD 未完成時，這個 TD 要再往後 ahead 個 interval
+ */
+static inline u32 usb_int_lat_expected_esit(u32 uframe, u32 interval,
+                                            u32 ahead)
+{
+    if (!interval)
+        interval = 1;
+
+    return usb_int_lat_next_esit(uframe, interval) + ahead * interval;
+}
+
+TRACE_EVENT(usb_int_lat_submit,
+    TP_PROTO(struct urb *urb),
+    TP_ARGS(urb),
+    TP_STRUCT__entry(
+        __field(void *, urb)
+        __field(u16, busnum)
+        __field(u8, devnum)
+        __field(u8, epaddr)
+        __field(u32, interval)
+    ),
+    TP_fast_assign(
+        __entry->urb = urb;
+        __entry->busnum = urb->dev->bus->busnum;
+        __entry->devnum = urb->dev->devnum;
+        __entry->epaddr = urb->ep->desc.bEndpointAddress;
+        __entry->interval = usb_int_lat_interval_uframes(urb);
+    ),
+    TP_printk("urb=%p bus=%u dev=%u ep=0x%02x interval=%u",
+        __entry->urb, __entry->busnum, __entry->devnum,
+        __entry->epaddr, __entry->interval)
+);
+
+TRACE_EVENT(usb_int_lat_sched,
+    TP_PROTO(struct urb *urb, u32 uframe, u32 ahead, u32 sched_uframe),
+    TP_ARGS(urb, uframe, ahead, sched_uframe),
+    TP_STRUCT__entry(
+        __field(void *, urb)
+        __field(u32, uframe)
+        __field(u32, ahead)
+        __field(u32, sched_uframe)
+    ),
+    TP_fast_assign(
+        __entry->urb = urb;
+        __entry->uframe = uframe & USB_INT_LAT_UFRAME_MASK;
+        __entry->ahead = ahead;
+        __entry->sched_uframe = sched_uframe & USB_INT_LAT_UFRAME_MASK;
+    ),
+    TP_printk("urb=%p uframe=%u ahead=%u sched=%u",
+        __entry->urb, __entry->uframe, __entry->ahead,
+        __entry->sched_uframe)
+);
+
+TRACE_EVENT(usb_int_lat_event,
+    TP_PROTO(struct urb *urb, u32 uframe, int status, u32 actual_length),
+    TP_ARGS(urb, uframe, status, actual_length),
+    TP_STRUCT__entry(
+        __field(void *, urb)
+        __field(u32, uframe)
+        __field(int, status)
+        __field(u32, actual_length)
+    ),
+    TP_fast_assign(
+        __entry->urb = urb;
+        __entry->uframe = uframe & USB_INT_LAT_UFRAME_MASK;
+        __entry->status = status;
+        __entry->actual_length = actual_length;
+    ),
+    TP_printk("urb=%p uframe=%u status=%d len=%u",
+        __entry->urb, __entry->uframe, __entry->status,
+        __entry->actual_length)
+);
+
+TRACE_EVENT(usb_int_lat_callback,
+    TP_PROTO(struct urb *urb),
+    TP_ARGS(urb),
+    TP_STRUCT__entry(
+        __field(void *, urb)
+        __field(int, status)
+    ),
+    TP_fast_assign(
+        __entry->urb = urb;
+        __entry->status = urb->status;
+    ),
+    TP_printk("urb=%p status=%d", __entry->urb, __entry->status)
+);
+
+#endif /* __USB_INT_LATENCY_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE usb_int_latency_trace
+#include <trace/define_trace.h>
@@ -0,0 +1,518 @@
+/*
+ * USB Interrupt-IN Streaming Helper Example
+ *
+ * usb-interrupt-transfer-xhci.md §2.2 的 ld_interrupt_complete() 只有一個
+ * URB：完成回調處理資料之後才 usb_submit_urb(urb, GFP_ATOMIC)。從 xHC
+ * 寫出 Transfer Event 到新的 TRB 再次入隊之間，端點上沒有任何 TD；
+ * 這段期間到期的 bInterval 輪詢都會錯過。HS 端點 bInterval = 1
+ * (125us) 時，一次稍慢的 softirq 就足以錯過好幾個 microframe。
+ *
+ * 這個 helper 讓同一個 interrupt-IN 端點上一直掛著 N 個 URB：
+ *
+ *   - URB 與 buffer 在 create 時全部配好 (usb_alloc_coherent)，
+ *     buffer 數 = URB 數 + 消費者可暫存的筆數
+ *   - 完成回調把填好的 buffer 放進 ready ring，從 free ring 取一塊空的
+ *     換到 URB 上，立即重新提交；其餘 N - 1 個 URB 仍在端點上，
+ *     xHC 下一次輪詢時一定有 TD 可用
+ *   - 消費者從 ready ring 取出 buffer，用完後放回 free ring
+ *   - 兩個 ring 都是單一生產者/單一消費者，只用 acquire/release，
+ *     不加鎖；完成路徑上沒有任何配置 (HCD 內部的 urb_priv 除外)
+ *   - free ring 空了 (消費者太慢) 時丟掉這一筆、沿用同一塊 buffer，
+ *     計入 overruns；不會讓端點斷流
+ *
+ * 同一端點的完成回調由 HCD 依序呼叫 (giveback 不會在兩顆 CPU 上同時
+ * 執行同一端點)，所以 ready ring 的生產者只有一個；消費者只有一個
+ * reader，多個 reader 需在外面自行加鎖。
+ *
+ * 錯過的輪詢依 HCD 的 frame number 計算 (見 usb_int_stream_account())：
+ * HCD 有回報 urb->start_frame 時用它，否則在完成回調中讀
+ * usb_get_current_frame_number() (xHCI 為 MFINDEX >> 3)。經過的 frame 數
+ * 換算成應有的輪詢次數，減去實際完成數；不以完成回調之間的時間差估算，
+ * 回調本身的延遲不會被算成錯過。giveback 較晚時完成會被記到較晚的
+ * frame，差額暫時偏高，後續完成追上後抵銷。
+ * 裝置本身沒有資料時 (NAK) 也不會完成，所以量測時需要一個每個 interval
+ * 都有資料的裝置；dummy_hcd 不依 interval 排程，只能驗證功能 (見文件 §2.4)。
+ *
+ * 宣告應放在 include/linux/usb/int_stream.h 供驅動使用。
+ */
+
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/usb.h>
+#include <linux/wait.h>
+
+/* USB frame number 為 11 位元，每 2048 ms 繞回 */
+#define USB_INT_STREAM_FRAME_MASK   0x7ff
+#define USB_INT_STREAM_FRAME_COUNT  (USB_INT_STREAM_FRAME_MASK + 1)
+
+/* 一塊已完成的資料 */
+struct usb_int_stream_buf {
+    void *data;
+    dma_addr_t dma;
+    /* 以下由完成回調填入 */
+    unsigned int actual_length;
+    ktime_t timestamp;
+};
+
+struct usb_int_stream_stats {
+    u64 completions;
+    /* 依 frame number 算出的錯過輪詢次數 (應有輪詢數 - 完成數) */
+    u64 missed_intervals;
+    /* 消費者來不及，資料被丟棄 */
+    u64 overruns;
+    /* 非 0 的 URB 狀態 (-EPROTO、-EILSEQ 等) */
+    u64 errors;
+    /* usb_submit_urb() 失敗；該 URB 不再提交 */
+    u64 submit_errors;
+    /* 相鄰完成的最大間隔 */
+    u64 max_gap_ns;
+};
+
+struct usb_int_stream;
+
+/* 每個 URB 目前持有的 buffer */
+struct usb_int_stream_urb {
+    struct urb *urb;
+    struct usb_int_stream *stream;
+    u16 buf;
+};
+
+struct usb_int_stream {
+    struct usb_device *udev;
+    unsigned int pipe;
+    size_t buf_size;
+    /* bInterval 換算成的時間與 microframe 數 (FS/LS 為 frame 數 * 8) */
+    u64 interval_ns;
+    unsigned int interval_uf;
+
+    struct usb_int_stream_urb *urbs;
+    unsigned int nr_urbs;
+
+    struct usb_int_stream_buf *bufs;
+    unsigned int nr_bufs;
+
+    /*
+     * ready：完成回調 -> 消費者；free：消費者 -> 完成回調
+     * 兩個 ring 的容量都是 >= nr_bufs 的 2 的冪次，buffer 總數有限，
+     * 所以生產者不必檢查滿
+     */
+    u16 *ready;
+    u16 *free;
+    unsigned int ring_mask;
+    u32 ready_head, ready_tail;
+    u32 free_head, free_tail;
+
+    wait_queue_head_t wait;
+    struct usb_anchor anchor;
+    bool stopping;
+
+    ktime_t last_complete;
+
+    /*
+     * 錯過輪詢的計算：cur_frame 為最近一次完成所在的 frame (-1 表示尚未
+     * 開始)，cur_count 為其中的完成數；frame 結束後才累計進 frames 與
+     * frame_completions。第一個 frame 的輪詢數不完整，不列入計算。
+     * missed_base 為之前 start/stop 累計的錯過次數
+     */
+    int cur_frame;
+    unsigned int cur_count;
+    bool counting;
+    u64 frames;
+    u64 frame_completions;
+    u64 missed_base;
+
+    struct usb_int_stream_stats stats;
+    struct dentry *debugfs;
+};
+
+/* SPSC ring：生產者寫入後以 release 發布 head，消費者以 acquire 讀取 */
+static void usb_int_stream_push(u16 *ring, unsigned int mask, u32 *head, u16 idx)
+{
+    u32 h = *head;
+
+    ring[h & mask] = idx;
+    smp_store_release(head, h + 1);
+}
+
+static bool usb_int_stream_pop(u16 *ring, unsigned int mask, u32 *head,
+                               u32 *tail, u16 *idx)
+{
+    u32 t = *tail;
+
+    if (t == smp_load_acquire(head))
+        return false;
+
+    *idx = ring[t & mask];
+    smp_store_release(tail, t + 1);
+
+    return true;
+}
+
+/* 提交前清掉 start_frame，完成時才分辨得出 HCD 是否有回報 */
+static int usb_int_stream_submit(struct urb *urb, gfp_t mem_flags)
+{
+    urb->start_frame = -1;
+
+    return usb_submit_urb(urb, mem_flags);
+}
+
+/*
+ * 依 frame number 計算錯過的輪詢
+ * 每個結束的 frame 應有 8 / interval_uf 次輪詢 (interval 超過一個 frame
+ * 時為分數，累計後再除)；錯過次數 = 應有輪詢數 - 這些 frame 內的完成數
+ */
+static void usb_int_stream_account(struct usb_int_stream *s, struct urb *urb,
+                                   ktime_t now)
+{
+    u64 gap = 0, gap_frames, expected;
+    unsigned int delta;
+    int frame;
+
+    if (s->last_complete) {
+        gap = ktime_to_ns(ktime_sub(now, s->last_complete));
+        s->stats.max_gap_ns = max(s->stats.max_gap_ns, gap);
+    }
+    s->last_complete = now;
+
+    frame = urb->start_frame;
+    if (frame < 0)
+        frame = usb_get_current_frame_number(s->udev);
+    if (frame < 0)
+        return;
+    frame &= USB_INT_STREAM_FRAME_MASK;
+
+    if (s->cur_frame < 0) {
+        s->cur_frame = frame;
+        return;
+    }
+
+    if (frame == s->cur_frame) {
+        s->cur_count++;
+        return;
+    }
+
+    /* 兩次完成相隔超過 2048 ms 時 frame number 已繞回，以 ktime 補上圈數 */
+    delta = (frame - s->cur_frame) & USB_INT_STREAM_FRAME_MASK;
+    gap_frames = div_u64(gap, NSEC_PER_MSEC);
+    if (gap_frames > delta)
+        delta += div_u64(gap_frames - delta + USB_INT_STREAM_FRAME_COUNT / 2,
+                         USB_INT_STREAM_FRAME_COUNT) *
+                 USB_INT_STREAM_FRAME_COUNT;
+
+    if (s->counting) {
+        s->frames += delta;
+        s->frame_completions += s->cur_count;
+    } else {
+        /* 第一個 frame 不完整，從下一個 frame 開始 */
+        s->frames += delta - 1;
+        s->counting = true;
+    }
+    s->cur_frame = frame;
+    s->cur_count = 1;
+
+    expected = div_u64(s->frames * 8, s->interval_uf);
+    s->stats.missed_intervals = s->missed_base +
+        (expected > s->frame_completions ?
+         expected - s->frame_completions : 0);
+}
+
+static void usb_int_stream_complete(struct urb *urb)
+{
+    struct usb_int_stream_urb *su = urb->context;
+    struct usb_int_stream *s = su->stream;
+    struct usb_int_stream_buf *buf;
+    ktime_t now = ktime_get();
+    u16 next;
+    int ret;
+
+    switch (urb->status) {
+    case 0:
+        break;
+    case -ENOENT:
+    case -ECONNRESET:
+    case -ESHUTDOWN:
+        /* stop() 或裝置拔除 */
+        return;
+    default:
+        s->stats.errors++;
+        goto resubmit;
+    }
+
+    s->stats.completions++;
+    usb_int_stream_account(s, urb, now);
+
+    if (!usb_int_stream_pop(s->free, s->ring_mask, &s->free_head,
+                            &s->free_tail, &next)) {
+        /* 消費者來不及：丟掉這一筆，同一塊 buffer 繼續收 */
+        s->stats.overruns++;
+        goto resubmit;
+    }
+
+    buf = &s->bufs[su->buf];
+    buf->actual_length = urb->actual_length;
+    buf->timestamp = now;
+    usb_int_stream_push(s->ready, s->ring_mask, &s->ready_head, su->buf);
+
+    su->buf = next;
+    urb->transfer_buffer = s->bufs[next].data;
+    urb->transfer_dma = s->bufs[next].dma;
+
+    wake_up_interruptible(&s->wait);
+
+resubmit:
+    if (READ_ONCE(s->stopping))
+        return;
+
+    usb_anchor_urb(urb, &s->anchor);
+    ret = usb_int_stream_submit(urb, GFP_ATOMIC);
+    if (ret) {
+        usb_unanchor_urb(urb);
+        s->stats.submit_errors++;
+        dev_err_ratelimited(&s->udev->dev,
+                            "int stream: resubmit failed: %d\n", ret);
+    }
+}
+
+void usb_int_stream_stop(struct usb_int_stream *s)
+{
+    WRITE_ONCE(s->stopping, true);
+    usb_kill_anchored_urbs(&s->anchor);
+    wake_up_interruptible(&s->wait);
+}
+EXPORT_SYMBOL_GPL(usb_int_stream_stop);
+
+void usb_int_stream_destroy(struct usb_int_stream *s)
+{
+    unsigned int i;
+
+    if (!s)
+        return;
+
+    usb_int_stream_stop(s);
+    debugfs_remove(s->debugfs);
+
+    if (s->urbs)
+        for (i = 0; i < s->nr_urbs; i++)
+            usb_free_urb(s->urbs[i].urb);
+
+    if (s->bufs)
+        for (i = 0; i < s->nr_bufs; i++)
+            usb_free_coherent(s->udev, s->buf_size, s->bufs[i].data,
+                              s->bufs[i].dma);
+
+    kfree(s->free);
+    kfree(s->ready);
+    kfree(s->bufs);
+    kfree(s->urbs);
+    usb_put_dev(s->udev);
+    kfree(s);
+}
+EXPORT_SYMBOL_GPL(usb_int_stream_destroy);
+
+/*
+ * 建立 stream
+ * nr_urbs：端點上同時掛著的 URB 數 (2-8 已足夠吸收一般的 IRQ 延遲)
+ * depth：消費者最多可暫存的已完成 buffer 數
+ */
+struct usb_int_stream *usb_int_stream_create(struct usb_interface *intf,
+        const struct usb_endpoint_descriptor *ep,
+        unsigned int nr_urbs, unsigned int depth)
+{
+    struct usb_device *udev = interface_to_usbdev(intf);
+    struct usb_int_stream *s;
+    unsigned int i, ring_size;
+    struct urb *urb;
+
+    /* ring 以 u16 存放 buffer 索引 */
+    if (!usb_endpoint_is_int_in(ep) || !nr_urbs || !depth ||
+        nr_urbs + depth > U16_MAX)
+        return ERR_PTR(-EINVAL);
+
+    s = kzalloc(sizeof(*s), GFP_KERNEL);
+    if (!s)
+        return ERR_PTR(-ENOMEM);
+
+    s->udev = usb_get_dev(udev);
+    s->pipe = usb_rcvintpipe(udev, ep->bEndpointAddress);
+    s->buf_size = usb_endpoint_maxp(ep) * usb_endpoint_maxp_mult(ep);
+    s->nr_urbs = nr_urbs;
+    s->nr_bufs = nr_urbs + depth;
+    ring_size = roundup_pow_of_two(s->nr_bufs);
+    s->ring_mask = ring_size - 1;
+    init_waitqueue_head(&s->wait);
+    init_usb_anchor(&s->anchor);
+
+    s->urbs = kcalloc(nr_urbs, sizeof(*s->urbs), GFP_KERNEL);
+    s->bufs = kcalloc(s->nr_bufs, sizeof(*s->bufs), GFP_KERNEL);
+    s->ready = kcalloc(ring_size, sizeof(*s->ready), GFP_KERNEL);
+    s->free = kcalloc(ring_size, sizeof(*s->free), GFP_KERNEL);
+    if (!s->urbs || !s->bufs || !s->ready || !s->free)
+        goto err;
+
+    for (i = 0; i < s->nr_bufs; i++) {
+        s->bufs[i].data = usb_alloc_coherent(udev, s->buf_size, GFP_KERNEL,
+                                             &s->bufs[i].dma);
+        if (!s->bufs[i].data)
+            goto err;
+    }
+
+    /* 前 nr_urbs 塊給 URB，其餘放進 free ring */
+    for (i = 0; i < nr_urbs; i++) {
+        urb = usb_alloc_urb(0, GFP_KERNEL);
+        if (!urb)
+            goto err;
+
+        usb_fill_int_urb(urb, udev, s->pipe, s->bufs[i].data, s->buf_size,
+                         usb_int_stream_complete, &s->urbs[i],
+                         ep->bInterval);
+        urb->transfer_dma = s->bufs[i].dma;
+        urb->transfer_flags |= URB_NO_TRANSFER_DMA_MAP;
+
+        s->urbs[i].urb = urb;
+        s->urbs[i].stream = s;
+        s->urbs[i].buf = i;
+    }
+    for (; i < s->nr_bufs; i++)
+        usb_int_stream_push(s->free, s->ring_mask, &s->free_head, i);
+
+    /* usb_fill_int_urb() 已把 HS/SS 的 bInterval 換算成 microframe 數 */
+    s->interval_uf = s->urbs[0].urb->interval *
+                     (udev->speed >= USB_SPEED_HIGH ? 1 : 8);
+    s->interval_ns = (u64)s->interval_uf * 125000;
+
+    return s;
+
+err:
+    usb_int_stream_destroy(s);
+    return ERR_PTR(-ENOMEM);
+}
+EXPORT_SYMBOL_GPL(usb_int_stream_create);
+
+/* 一次提交全部 URB；xHC 依 bInterval 依序服務，每次輪詢消耗一個 TD */
+int usb_int_stream_start(struct usb_int_stream *s)
+{
+    unsigned int i;
+    int ret;
+
+    WRITE_ONCE(s->stopping, false);
+    s->last_complete = 0;
+    s->cur_frame = -1;
+    s->cur_count = 0;
+    s->counting = false;
+    s->frames = 0;
+    s->frame_completions = 0;
+    s->missed_base = s->stats.missed_intervals;
+
+    for (i = 0; i < s->nr_urbs; i++) {
+        usb_anchor_urb(s->urbs[i].urb, &s->anchor);
+        ret = usb_int_stream_submit(s->urbs[i].urb, GFP_KERNEL);
+        if (ret) {
+            usb_unanchor_urb(s->urbs[i].urb);
+            usb_int_stream_stop(s);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+EXPORT_SYMBOL_GPL(usb_int_stream_start);
+
+/*
+ * 取出下一塊已完成的 buffer，沒有時回傳 NULL
+ * 用完後必須以 usb_int_stream_release() 歸還
+ */
+struct usb_int_stream_buf *usb_int_stream_get(struct usb_int_stream *s)
+{
+    u16 idx;
+
+    if (!usb_int_stream_pop(s->ready, s->ring_mask, &s->ready_head,
+                            &s->ready_tail, &idx))
+        return NULL;
+
+    return &s->bufs[idx];
+}
+EXPORT_SYMBOL_GPL(usb_int_stream_get);
+
+void usb_int_stream_release(struct usb_int_stream *s,
+                            struct usb_int_stream_buf *buf)
+{
+    usb_int_stream_push(s->free, s->ring_mask, &s->free_head,
+                        (u16)(buf - s->bufs));
+}
+EXPORT_SYMBOL_GPL(usb_int_stream_release);
+
+/* 等到有資料或 stream 停止；可被訊號中斷 */
+int usb_int_stream_wait(struct usb_int_stream *s)
+{
+    return wait_event_interruptible(s->wait,
+        READ_ONCE(s->stopping) ||
+        s->ready_tail != smp_load_acquire(&s->ready_head));
+}
+EXPORT_SYMBOL_GPL(usb_int_stream_wait);
+
+void usb_int_stream_get_stats(struct usb_int_stream *s,
+                              struct usb_int_stream_stats *stats)
+{
+    *stats = s->stats;
+}
+EXPORT_SYMBOL_GPL(usb_int_stream_get_stats);
+
+static int usb_int_stream_stats_show(struct seq_file *m, void *unused)
+{
+    struct usb_int_stream *s = m->private;
+
+    seq_printf(m, "interval_ns:      %llu\n", s->interval_ns);
+    seq_printf(m, "urbs:             %u\n", s->nr_urbs);
+    seq_printf(m, "buffers:          %u\n", s->nr_bufs);
+    seq_printf(m, "completions:      %llu\n", s->stats.completions);
+    seq_printf(m, "missed_intervals: %llu\n", s->stats.missed_intervals);
+    seq_printf(m, "overruns:         %llu\n", s->stats.overruns);
+    seq_printf(m, "errors:           %llu\n", s->stats.errors);
+    seq_printf(m, "submit_errors:    %llu\n", s->stats.submit_errors);
+    seq_printf(m, "max_gap_ns:       %llu\n", s->stats.max_gap_ns);
+
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(usb_int_stream_stats);
+
+/* 在驅動的 debugfs 目錄下建立 "int_stream" 統計檔 */
+void usb_int_stream_debugfs_init(struct usb_int_stream *s,
+                                 struct dentry *parent)
+{
+    s->debugfs = debugfs_create_file("int_stream", 0444, parent, s,
+                                     &usb_int_stream_stats_fops);
+}
+EXPORT_SYMBOL_GPL(usb_int_stream_debugfs_init);
+
+MODULE_DESCRIPTION("USB interrupt-IN streaming helper");
+MODULE_LICENSE("GPL");
+
+/*
+ * 驅動改寫範例 (以 ldusb 為例)：
+ *
+ *   probe:
+ *       dev->stream = usb_int_stream_create(intf, dev->interrupt_in_endpoint,
+ *                                           4, 16);
+ *       usb_int_stream_start(dev->stream);
+ *
+ *   read:
+ *       while (!(buf = usb_int_stream_get(dev->stream))) {
+ *           if (file->f_flags & O_NONBLOCK)
+ *               return -EAGAIN;
+ *           ret = usb_int_stream_wait(dev->stream);
+ *           if (ret)
+ *               return ret;
+ *       }
+ *       n = min(count, buf->actual_length);
+ *       if (copy_to_user(buffer, buf->data, n))
+ *           ret = -EFAULT;
+ *       usb_int_stream_release(dev->stream, buf);
+ *
+ *   disconnect:
+ *       usb_int_stream_destroy(dev->stream);
+ *
+ * ld_interrupt_complete() 與驅動自己的 ring buffer、spinlock 都可以刪除。
+ */
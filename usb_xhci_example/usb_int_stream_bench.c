@@ -0,0 +1,234 @@
+/*
+ * Interrupt-IN Resubmission Gap Simulator (host)
+ *
+ * 以離散事件模擬比較兩種 interrupt-IN 的 URB 用法在 125us 輪詢下
+ * 錯過多少次 bInterval：
+ *
+ *   single  ld_interrupt_complete() 的作法：一個 URB，完成回調處理完
+ *           才重新提交 (usb-interrupt-transfer-xhci.md §2.2)
+ *   stream  usb_int_stream.c：N 個 URB 同時掛在端點上，完成回調只換
+ *           buffer 就重新提交，資料交給消費者處理
+ *
+ * 模型：
+ *   - xHC 每個 interval 輪詢一次；端點上有 TD 就完成一筆，否則記為錯過
+ *     (裝置每次都有資料，相當於 dummy_hcd + HID gadget 的量測條件)
+ *   - 完成回調在同一顆 CPU 上依序執行；每次需要 handle_us，另外以
+ *     spike_pct 的機率多延遲 spike_us (softirq 被其他工作延後)
+ *   - single 的回調還要處理資料 (process_us)；stream 的資料在消費者端處理，
+ *     不佔用完成回調
+ *
+ * 每種設定輸出兩個錯過次數：
+ *   hc      xHC 端的真值 (輪詢時端點上沒有 TD 的次數)
+ *   metric  usb_int_stream.c 回報的 missed_intervals：回調開始時讀
+ *           frame number (MFINDEX >> 3)，以 usb_int_stream_account() 相同的
+ *           計算得出；兩者一致才表示驅動端的統計可信
+ *
+ * 編譯與執行：
+ *   gcc -O2 -o usb_int_stream_bench usb_int_stream_bench.c
+ *   ./usb_int_stream_bench [intervals] [handle_us] [process_us] [spike_us] [spike_pct]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define INTERVAL_NS     125000ULL
+#define INTERVAL_UF     1
+#define FRAME_NS        1000000ULL
+#define MAX_URBS        8
+
+struct sim {
+    unsigned long intervals;
+    unsigned int handle_ns;
+    unsigned int process_ns;
+    unsigned int spike_ns;
+    unsigned int spike_pct;
+    uint64_t seed;
+};
+
+struct result {
+    unsigned long completions;
+    unsigned long missed;
+    uint64_t max_gap_ns;
+    /* 驅動端的 missed_intervals */
+    uint64_t metric;
+};
+
+/*
+ * usb_int_stream_account() 的 frame 計算 (模擬時間不會繞回，
+ * 省略 frame number 的遮罩與繞回補償)
+ */
+struct frame_acct {
+    int64_t cur_frame;
+    unsigned int cur_count;
+    int counting;
+    uint64_t frames;
+    uint64_t frame_completions;
+    uint64_t missed;
+};
+
+static void frame_acct_complete(struct frame_acct *a, int64_t frame)
+{
+    uint64_t delta, expected;
+
+    if (a->cur_frame < 0) {
+        a->cur_frame = frame;
+        return;
+    }
+
+    if (frame == a->cur_frame) {
+        a->cur_count++;
+        return;
+    }
+
+    delta = (uint64_t)(frame - a->cur_frame);
+    if (a->counting) {
+        a->frames += delta;
+        a->frame_completions += a->cur_count;
+    } else {
+        a->frames += delta - 1;
+        a->counting = 1;
+    }
+    a->cur_frame = frame;
+    a->cur_count = 1;
+
+    expected = a->frames * 8 / INTERVAL_UF;
+    a->missed = expected > a->frame_completions ?
+                expected - a->frame_completions : 0;
+}
+
+/* 固定種子的 xorshift，讓每種設定看到相同的延遲序列 */
+static uint32_t sim_rand(uint64_t *state)
+{
+    uint64_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+
+    return (uint32_t)(x >> 32);
+}
+
+/*
+ * nr_urbs 個 URB；process_in_callback 為 true 時資料處理也在回調中 (single)
+ * resubmit_at[i] 是 URB i 重新掛上端點的時間
+ */
+static struct result simulate(const struct sim *sim, unsigned int nr_urbs,
+                              int process_in_callback)
+{
+    uint64_t resubmit_at[MAX_URBS];
+    uint64_t cpu_free = 0, last_complete = 0, poll, start, cost;
+    uint64_t rng = sim->seed;
+    struct frame_acct acct = { .cur_frame = -1 };
+    struct result r = { 0 };
+    unsigned long k;
+    unsigned int i, pick;
+
+    for (i = 0; i < nr_urbs; i++)
+        resubmit_at[i] = 0;
+
+    for (k = 0; k < sim->intervals; k++) {
+        poll = k * INTERVAL_NS;
+
+        /* 找一個已經掛在端點上的 URB (最早提交的先服務) */
+        pick = nr_urbs;
+        for (i = 0; i < nr_urbs; i++) {
+            if (resubmit_at[i] > poll)
+                continue;
+            if (pick == nr_urbs || resubmit_at[i] < resubmit_at[pick])
+                pick = i;
+        }
+
+        if (pick == nr_urbs) {
+            r.missed++;
+            continue;
+        }
+
+        r.completions++;
+        if (last_complete && poll - last_complete > r.max_gap_ns)
+            r.max_gap_ns = poll - last_complete;
+        last_complete = poll;
+
+        /* 完成回調：同一顆 CPU 依序執行 */
+        cost = sim->handle_ns;
+        if (process_in_callback)
+            cost += sim->process_ns;
+        if (sim_rand(&rng) % 100 < sim->spike_pct)
+            cost += sim->spike_ns;
+
+        start = (poll > cpu_free) ? poll : cpu_free;
+        cpu_free = start + cost;
+        resubmit_at[pick] = cpu_free;
+
+        /* 完成回調開始時讀 frame number */
+        frame_acct_complete(&acct, (int64_t)(start / FRAME_NS));
+    }
+
+    r.metric = acct.missed;
+
+    return r;
+}
+
+static void report(const char *name, const struct sim *sim, struct result r)
+{
+    printf("%-10s completions %8lu  missed hc %8lu (%5.2f%%)  metric %8llu"
+           "  max gap %6.0f us\n",
+           name, r.completions, r.missed,
+           100.0 * r.missed / sim->intervals, (unsigned long long)r.metric,
+           r.max_gap_ns / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    static const unsigned int urbs[] = { 2, 4, 8 };
+    struct sim sim = {
+        .intervals = 1000000,
+        .handle_ns = 15000,
+        .process_ns = 20000,
+        .spike_ns = 300000,
+        .spike_pct = 1,
+        .seed = 0x9E3779B97F4A7C15ULL,
+    };
+    char name[16];
+    unsigned int i;
+
+    if (argc > 1)
+        sim.intervals = strtoul(argv[1], NULL, 0);
+    if (argc > 2)
+        sim.handle_ns = strtoul(argv[2], NULL, 0) * 1000;
+    if (argc > 3)
+        sim.process_ns = strtoul(argv[3], NULL, 0) * 1000;
+    if (argc > 4)
+        sim.spike_ns = strtoul(argv[4], NULL, 0) * 1000;
+    if (argc > 5)
+        sim.spike_pct = strtoul(argv[5], NULL, 0);
+
+    printf("interval 125 us, %lu polls, callback %u us (+%u us processing), "
+           "%u%% spikes of %u us\n",
+           sim.intervals, sim.handle_ns / 1000, sim.process_ns / 1000,
+           sim.spike_pct, sim.spike_ns / 1000);
+
+    report("single", &sim, simulate(&sim, 1, 1));
+    for (i = 0; i < sizeof(urbs) / sizeof(urbs[0]); i++) {
+        snprintf(name, sizeof(name), "stream x%u", urbs[i]);
+        report(name, &sim, simulate(&sim, urbs[i], 0));
+    }
+
+    return 0;
+}
+
+/*
+ * 執行結果 (預設參數)：
+ *
+ *   single     completions   980280  missed hc    19720 ( 1.97%)  metric    19720  max gap    375 us
+ *   stream x2  completions   989948  missed hc    10052 ( 1.01%)  metric    10053  max gap    375 us
+ *   stream x4  completions   999905  missed hc       95 ( 0.01%)  metric       95  max gap    250 us
+ *   stream x8  completions  1000000  missed hc        0 ( 0.00%)  metric        0  max gap    125 us
+ *
+ * 回調較慢時 (./usb_int_stream_bench 1000000 40 90 300 1)，single 每次
+ * 都超過 125us，錯過一半的輪詢 (hc 504949，metric 504941)；stream 不受資料
+ * 處理時間影響，結果與上面幾乎相同。一次 300us 的延遲約佔 3 個 interval，
+ * N >= 4 即可吸收。metric 與 hc 的差異來自不列入計算的第一個與最後一個
+ * frame，回調延遲不會被算成錯過。
+ */
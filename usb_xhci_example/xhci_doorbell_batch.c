@@ -0,0 +1,232 @@
+/*
+ * xHCI Doorbell Coalescing Example
+ *
+ * usb-interrupt-transfer-xhci.md §3.2 / §11.1 的流程中，每個 URB 都走完
+ * queue_trb() -> inc_enq() -> giveback_first_trb() -> xhci_ring_ep_doorbell()，
+ * 最後一步是一次非 cacheable 的 writel()。驅動一次提交很多 URB 時
+ * (usb_int_stream 的 start、網卡或儲存裝置的 bulk 佇列)，
+ * doorbell 寫入數等於 URB 數，但 xHC 只需要在每個端點上被叫醒一次。
+ *
+ * 這個範例加上批次提交：
+ *
+ *   usb_submit_urb_batch(urbs, n, mem_flags)
+ *     -> usb_submit_urb() x n    (URB 帶 URB_DEFER_DOORBELL；TRB 照常入隊，
+ *                                 TD 照常交給 xHC，只記下端點)
+ *     -> hcd->driver->urb_batch_end(hcd, udev)
+ *          每個有新 TD 的端點只寫一次 doorbell
+ *
+ * 延後只限於 batch 自己提交的 URB：旗標跟著 URB 走，而不是裝置上的
+ * 狀態。同一時間其他 context 對同一裝置的提交 (例如完成回調中的重新
+ * 提交) 照常立即寫 doorbell，不會被別人的 batch 拖住。
+ * giveback_first_trb() 在 xhci->lock 下讀取並清除旗標，完成回調只會在
+ * 放開 lock 之後執行，回調中重新提交同一個 URB 時旗標已不存在。
+ *
+ * 交接順序不變：giveback_first_trb() 仍在每個 TD 寫完後 wmb() 再翻轉
+ * 第一個 TRB 的 cycle bit，只是把 doorbell 延到 batch_end。端點若正在
+ * 執行，xHC 會直接往下讀到新的 TD，不需要 doorbell；端點已閒置時，
+ * batch_end 的一次 doorbell 讓 xHC 從目前的 dequeue 一路處理到最後一個 TD。
+ *
+ * inc_enq() 的 more_trbs_coming 語意維持原樣：TD 的最後一個 TRB 落在
+ * segment 尾端時，link TRB 不會先交給 xHC，下一個 TD 的 prepare_ring()
+ * 才跨過 link TRB。批次中的下一個 TD 一定會經過 prepare_ring()，
+ * 所以不需要特別處理；batch_end 的 doorbell 在所有 link TRB 翻轉之後。
+ *
+ * stream 端點 (stream_id != 0) 的 doorbell 帶有 stream ID，維持立即寫入。
+ *
+ * 對應 drivers/usb/host/xhci-ring.c 的 giveback_first_trb() 與
+ * drivers/usb/host/xhci.c；在 xhci_hc_driver 加入：
+ *   .urb_batch_end = xhci_urb_batch_end,
+ * 主機端的 doorbell 計數 microbenchmark 見 xhci_doorbell_bench.c
+ */
+
+#include <linux/bitops.h>
+#include <linux/debugfs.h>
+#include <linux/usb.h>
+#include <linux/usb/hcd.h>
+
+#include "xhci.h"
+
+/*
+ * include/linux/usb.h 新增 URB 旗標 (只由 usb_submit_urb_batch() 設定)：
+ *
+ *   #define URB_DEFER_DOORBELL  0x01000000
+ *
+ * drivers/usb/core/urb.c 的 usb_submit_urb() 中 allowed 加上此旗標。
+ *
+ * struct xhci_virt_device 新增欄位 (xhci.h)：
+ *
+ *   // 延後的 doorbell，bit n 對應 ep_index n (EP_CTX_PER_DEV = 31)
+ *   u32 db_pending;
+ *
+ * struct xhci_hcd 新增統計 (xhci.h)：
+ *
+ *   u64 db_tds;        // 交給 xHC 的 TD 數
+ *   u64 db_writes;     // 實際寫入的 transfer doorbell 數
+ */
+
+/*
+ * xhci-ring.c：每個 TD 寫完後把第一個 TRB 交給 xHC
+ * 呼叫者持有 xhci->lock；原本傳入的 stream_id 改由 urb 取得
+ * (xhci_queue_bulk_tx() 等呼叫端改傳 urb)
+ */
+static void giveback_first_trb(struct xhci_hcd *xhci, int slot_id,
+        unsigned int ep_index, struct urb *urb, int start_cycle,
+        struct xhci_generic_trb *start_trb)
+{
+    struct xhci_virt_device *vdev = xhci->devs[slot_id];
+    unsigned int stream_id = urb->stream_id;
+    bool defer = urb->transfer_flags & URB_DEFER_DOORBELL;
+
+    /* 旗標只對這一次提交有效 */
+    urb->transfer_flags &= ~URB_DEFER_DOORBELL;
+
+    /*
+     * 寫入 cycle bit 之前確保其餘 TRB 都已寫入記憶體；
+     * cycle bit 一翻轉 xHC 就可能開始讀這個 TD
+     */
+    wmb();
+    if (start_cycle)
+        start_trb->field[3] |= cpu_to_le32(start_cycle);
+    else
+        start_trb->field[3] &= cpu_to_le32(~TRB_CYCLE);
+
+    xhci->db_tds++;
+
+    /* batch 提交的 URB：記下端點，batch_end 時每個端點只寫一次 */
+    if (defer && !stream_id) {
+        vdev->db_pending |= BIT(ep_index);
+        return;
+    }
+
+    /* 這次 doorbell 也涵蓋了先前延後的 TD */
+    if (!stream_id)
+        vdev->db_pending &= ~BIT(ep_index);
+
+    xhci_ring_ep_doorbell(xhci, slot_id, ep_index, stream_id);
+    xhci->db_writes++;
+}
+
+/*
+ * xhci.c：結束 batch，對每個有延後 TD 的端點寫一次 doorbell
+ * 同一裝置上同時有兩個 batch 時，先結束的一併送出另一個 batch 已交接的
+ * TD，只是少合併幾次，不會延後任何人。
+ * xhci_ring_ep_doorbell() 會略過 halted / stop 中的端點；
+ * 那些端點恢復時由 ring_doorbell_for_active_rings() 補上
+ */
+static void xhci_urb_batch_end(struct usb_hcd *hcd, struct usb_device *udev)
+{
+    struct xhci_hcd *xhci = hcd_to_xhci(hcd);
+    struct xhci_virt_device *vdev;
+    unsigned long flags, pending;
+    unsigned int ep_index;
+
+    spin_lock_irqsave(&xhci->lock, flags);
+    vdev = xhci->devs[udev->slot_id];
+    if (!vdev)
+        goto out;
+
+    pending = vdev->db_pending;
+    vdev->db_pending = 0;
+    for_each_set_bit(ep_index, &pending, EP_CTX_PER_DEV) {
+        xhci_ring_ep_doorbell(xhci, udev->slot_id, ep_index, 0);
+        xhci->db_writes++;
+    }
+
+out:
+    spin_unlock_irqrestore(&xhci->lock, flags);
+}
+
+/*
+ * drivers/usb/core/urb.c：批次提交
+ *
+ * 所有 URB 必須屬於同一個 usb_device (同一個 xHCI slot)，可以分屬
+ * 不同端點。遇到第一個失敗即停止，回傳已提交的數量或負的 errno；
+ * 已提交的 URB 照常完成，doorbell 仍會在返回前寫入。
+ * HCD 沒有實作 batch 時等同逐一 usb_submit_urb()。
+ * 提交失敗的 URB 沒有到達 giveback_first_trb()，旗標在這裡清除，
+ * 之後一般的 usb_submit_urb() 不會被延後
+ */
+int usb_submit_urb_batch(struct urb **urbs, unsigned int count,
+                         gfp_t mem_flags)
+{
+    struct usb_device *udev;
+    struct usb_hcd *hcd;
+    unsigned int i;
+    int ret = 0;
+
+    if (!count)
+        return 0;
+
+    udev = urbs[0]->dev;
+    if (!udev)
+        return -ENODEV;
+
+    for (i = 1; i < count; i++)
+        if (urbs[i]->dev != udev)
+            return -EINVAL;
+
+    hcd = bus_to_hcd(udev->bus);
+
+    for (i = 0; i < count; i++) {
+        if (hcd->driver->urb_batch_end)
+            urbs[i]->transfer_flags |= URB_DEFER_DOORBELL;
+        ret = usb_submit_urb(urbs[i], mem_flags);
+        if (ret) {
+            urbs[i]->transfer_flags &= ~URB_DEFER_DOORBELL;
+            break;
+        }
+    }
+
+    if (hcd->driver->urb_batch_end)
+        hcd->driver->urb_batch_end(hcd, udev);
+
+    return i ? i : ret;
+}
+EXPORT_SYMBOL_GPL(usb_submit_urb_batch);
+
+/* xhci-debugfs.c：doorbell 寫入數與 TD 數 */
+static int xhci_doorbell_stats_show(struct seq_file *s, void *unused)
+{
+    struct xhci_hcd *xhci = s->private;
+    unsigned long flags;
+    u64 tds, writes;
+
+    spin_lock_irqsave(&xhci->lock, flags);
+    tds = xhci->db_tds;
+    writes = xhci->db_writes;
+    spin_unlock_irqrestore(&xhci->lock, flags);
+
+    seq_printf(s, "tds:       %llu\n", tds);
+    seq_printf(s, "doorbells: %llu\n", writes);
+    if (tds)
+        seq_printf(s, "per_td:    %llu.%03llu\n",
+                   div64_u64(writes, tds),
+                   div64_u64((writes - div64_u64(writes, tds) * tds) * 1000,
+                             tds));
+
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(xhci_doorbell_stats);
+
+/* 於 xhci_debugfs_init() 中呼叫 */
+static void xhci_debugfs_create_doorbell_stats(struct xhci_hcd *xhci,
+                                               struct dentry *root)
+{
+    debugfs_create_file("doorbell_stats", 0444, root, xhci,
+                        &xhci_doorbell_stats_fops);
+}
+
+/*
+ * 使用範例 (usb_int_stream_start() 一次掛上 N 個 URB)：
+ *
+ *   struct urb *urbs[8];        // create 時限制 nr_urbs <= 8
+ *
+ *   for (i = 0; i < s->nr_urbs; i++) {
+ *       usb_anchor_urb(s->urbs[i].urb, &s->anchor);
+ *       urbs[i] = s->urbs[i].urb;
+ *   }
+ *   ret = usb_submit_urb_batch(urbs, s->nr_urbs, GFP_KERNEL);
+ *
+ * 8 個 URB 原本寫 8 次 doorbell，現在 1 次；分散在 in/out 兩個端點的
+ * 批次則是 2 次。
+ */
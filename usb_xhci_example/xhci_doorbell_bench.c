@@ -0,0 +1,513 @@
+/*
+ * xHCI Doorbell Coalescing Microbenchmark (host simulator)
+ *
+ * 在 userspace 重建 xHCI transfer ring 的入隊流程 (queue_trb、inc_enq 的
+ * more_trbs_coming / link TRB 處理、prepare_ring 跨過 link TRB、
+ * giveback_first_trb 的 cycle bit 交接)，比較：
+ *
+ *   per-urb  每個 URB 交接後立即寫 doorbell (目前的 xhci_urb_enqueue)
+ *   batch    xhci_doorbell_batch.c：batch 內只記端點，結束時每個端點寫一次
+ *
+ * 模擬的 xHC 與入隊交錯執行：doorbell 之後端點開始執行，軟體每寫完
+ * 一個 TRB 或交接一個 TD，xHC 都可能 (hc_pct 機率) 往下讀幾個 TRB，
+ * 讀到 cycle bit 不符就停下等下一次 doorbell。因此 batch 期間已交接的
+ * TD 可能在 doorbell 之前就被正在執行的端點取走，xHC 也可能停在批次中
+ * 尚未交接的 TD 前面，只能靠 batch_end 的 doorbell 叫醒。
+ * xHC 以 consumer cycle state 讀取 TRB (跨 segment、link TRB toggle cycle)，
+ * 並檢查每個 TRB 的序號，驗證它不會讀到尚未交接或上一圈留下的 TRB；
+ * 最後確認每個 TD 都被取走。
+ *
+ * batch 期間另有 other_pct 機率插入一個「其他提交者」的 URB (例如完成
+ * 回調中的重新提交)：它不帶延後旗標，必須立即寫 doorbell，不受 batch 影響。
+ *
+ * 輸出每個 transfer 的 doorbell 寫入數；doorbell 的 MMIO 成本以
+ * mmio_ns 的 busy-wait 模擬 (非 cacheable 寫入在 PCIe 上通常是
+ * 數百 ns 量級，依平台而定，請以實測值代入)。
+ *
+ * 編譯與執行：
+ *   gcc -O2 -o xhci_doorbell_bench xhci_doorbell_bench.c
+ *   ./xhci_doorbell_bench [urbs] [endpoints] [mmio_ns] [hc_pct] [other_pct]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* 與 xhci.h 相同的 TRB 位元 */
+#define TRB_CYCLE           (1U << 0)
+#define LINK_TOGGLE         (1U << 1)
+#define TRB_CHAIN           (1U << 4)
+#define TRB_IOC             (1U << 5)
+#define TRB_TYPE(p)         ((p) << 10)
+#define TRB_FIELD_TO_TYPE(p) (((p) >> 10) & 0x3f)
+#define TRB_NORMAL          1
+#define TRB_LINK            6
+
+/* 小 segment 讓 link TRB 頻繁出現 */
+#define TRBS_PER_SEGMENT    16
+#define SEGMENTS_PER_RING   4
+#define MAX_ENDPOINTS       31
+
+#define wmb()               __atomic_thread_fence(__ATOMIC_RELEASE)
+
+struct trb {
+    uint32_t field[4];
+};
+
+struct segment {
+    struct trb trbs[TRBS_PER_SEGMENT];
+    struct segment *next;
+};
+
+struct ring {
+    struct segment segs[SEGMENTS_PER_RING];
+    struct segment *enq_seg;
+    struct trb *enqueue;
+    uint32_t cycle_state;
+    unsigned int num_trbs_free;
+
+    /* 軟體寫入 TRB 的序號 (field[1])，xHC 依序檢查 */
+    uint32_t sw_seq;
+
+    /* 模擬 xHC 的 dequeue 狀態；running 為 doorbell 後尚未讀到空 ring */
+    struct segment *deq_seg;
+    struct trb *dequeue;
+    uint32_t ccs;
+    uint32_t hc_seq;
+    bool running;
+    unsigned long hc_tds;
+    unsigned long hc_trbs;
+};
+
+struct bench {
+    struct ring rings[MAX_ENDPOINTS];
+    unsigned int endpoints;
+    unsigned int mmio_ns;
+
+    /* 延後的 doorbell (xhci_virt_device.db_pending) */
+    uint32_t db_pending;
+
+    /* xHC 每次有機會執行時實際往下讀的機率 (%) */
+    unsigned int hc_pct;
+    uint64_t rng;
+
+    unsigned long tds;
+    unsigned long db_writes;
+    /*
+     * 交錯的覆蓋率：early 為 doorbell 延後中、被執行中的端點先取走的 TD；
+     * stalls 為 batch 進行中端點讀到空 ring 停下 (靠 batch_end 叫醒) 的次數
+     */
+    bool in_batch;
+    unsigned long early;
+    unsigned long stalls;
+
+    /* 其他提交者的 TD 數，以及交接時沒有立即寫 doorbell 的次數 */
+    unsigned long others;
+    unsigned long others_deferred;
+    volatile uint32_t doorbell;
+    bool error;
+};
+
+/* 固定種子的 xorshift，讓每種設定看到相同的 xHC 交錯順序 */
+static uint32_t bench_rand(struct bench *b)
+{
+    uint64_t x = b->rng;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    b->rng = x;
+
+    return (uint32_t)(x >> 32);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void busy_wait_ns(unsigned int ns)
+{
+    uint64_t end;
+
+    if (!ns)
+        return;
+
+    end = now_ns() + ns;
+    while (now_ns() < end)
+        ;
+}
+
+static bool trb_is_link(const struct trb *trb)
+{
+    return TRB_FIELD_TO_TYPE(trb->field[3]) == TRB_LINK;
+}
+
+static void ring_init(struct ring *ring)
+{
+    struct trb *link;
+    unsigned int i;
+
+    memset(ring, 0, sizeof(*ring));
+    for (i = 0; i < SEGMENTS_PER_RING; i++) {
+        ring->segs[i].next = &ring->segs[(i + 1) % SEGMENTS_PER_RING];
+        link = &ring->segs[i].trbs[TRBS_PER_SEGMENT - 1];
+        link->field[3] = TRB_TYPE(TRB_LINK);
+    }
+    /* 最後一個 segment 的 link TRB 翻轉 cycle state */
+    ring->segs[SEGMENTS_PER_RING - 1].trbs[TRBS_PER_SEGMENT - 1].field[3] |=
+        LINK_TOGGLE;
+
+    ring->enq_seg = ring->deq_seg = &ring->segs[0];
+    ring->enqueue = ring->dequeue = ring->segs[0].trbs;
+    ring->cycle_state = ring->ccs = 1;
+    ring->num_trbs_free = SEGMENTS_PER_RING * (TRBS_PER_SEGMENT - 1) - 1;
+}
+
+/* 把 link TRB 交給 xHC 並移到下一個 segment */
+static void ring_pass_link(struct ring *ring, uint32_t chain)
+{
+    struct trb *link = ring->enqueue;
+
+    link->field[3] = (link->field[3] & ~TRB_CHAIN) | chain;
+    wmb();
+    link->field[3] ^= TRB_CYCLE;
+    if (link->field[3] & LINK_TOGGLE)
+        ring->cycle_state ^= 1;
+
+    ring->enq_seg = ring->enq_seg->next;
+    ring->enqueue = ring->enq_seg->trbs;
+}
+
+/* inc_enq()：TD 未結束或後面還有 TRB 時才跨過 link TRB */
+static void inc_enq(struct ring *ring, bool more_trbs_coming)
+{
+    uint32_t chain = ring->enqueue->field[3] & TRB_CHAIN;
+
+    ring->num_trbs_free--;
+    ring->enqueue++;
+
+    while (trb_is_link(ring->enqueue)) {
+        if (!chain && !more_trbs_coming)
+            break;
+        ring_pass_link(ring, chain);
+    }
+}
+
+/* prepare_ring()：上一個 TD 停在 link TRB 上時先跨過去 */
+static void prepare_ring(struct ring *ring)
+{
+    while (trb_is_link(ring->enqueue))
+        ring_pass_link(ring, 0);
+}
+
+/*
+ * 模擬 xHC：最多讀 budget 個 TRB；讀到 cycle bit 不符表示 ring 已空，
+ * 端點停下，要等下一次 doorbell
+ */
+static void hc_run(struct bench *b, struct ring *ring, unsigned int budget)
+{
+    uint32_t bit = 1U << (ring - b->rings);
+    struct trb *trb;
+
+    while (ring->running && budget--) {
+        trb = ring->dequeue;
+        if ((trb->field[3] & TRB_CYCLE) != ring->ccs) {
+            ring->running = false;
+            if (b->in_batch)
+                b->stalls++;
+            return;
+        }
+
+        if (trb_is_link(trb)) {
+            if (trb->field[3] & LINK_TOGGLE)
+                ring->ccs ^= 1;
+            ring->deq_seg = ring->deq_seg->next;
+            ring->dequeue = ring->deq_seg->trbs;
+            continue;
+        }
+
+        /* 讀到未交接或上一圈留下的 TRB */
+        if (TRB_FIELD_TO_TYPE(trb->field[3]) != TRB_NORMAL ||
+            trb->field[1] != ring->hc_seq) {
+            b->error = true;
+            ring->running = false;
+            return;
+        }
+        ring->hc_seq++;
+
+        ring->hc_trbs++;
+        if (!(trb->field[3] & TRB_CHAIN)) {
+            ring->hc_tds++;
+            if (b->db_pending & bit)
+                b->early++;
+        }
+        /* 完成的 TRB 空間還給軟體 */
+        ring->num_trbs_free++;
+        ring->dequeue++;
+    }
+}
+
+/* 執行中的端點各自有機會往下讀幾個 TRB */
+static void hc_tick(struct bench *b)
+{
+    unsigned int ep;
+
+    for (ep = 0; ep < b->endpoints; ep++) {
+        if (!b->rings[ep].running || bench_rand(b) % 100 >= b->hc_pct)
+            continue;
+        hc_run(b, &b->rings[ep], 1 + bench_rand(b) % 4);
+    }
+}
+
+static void ring_doorbell(struct bench *b, unsigned int ep)
+{
+    b->doorbell = ep << 8;
+    b->db_writes++;
+    busy_wait_ns(b->mmio_ns);
+    b->rings[ep].running = true;
+}
+
+/*
+ * giveback_first_trb()：交接第一個 TRB
+ * defer 對應 URB_DEFER_DOORBELL：只有 batch 自己的 URB 記下端點
+ */
+static void giveback_first_trb(struct bench *b, unsigned int ep, bool defer,
+                               uint32_t start_cycle, struct trb *start_trb)
+{
+    wmb();
+    start_trb->field[3] = (start_trb->field[3] & ~TRB_CYCLE) | start_cycle;
+    b->tds++;
+
+    if (defer) {
+        b->db_pending |= 1U << ep;
+        return;
+    }
+
+    b->db_pending &= ~(1U << ep);
+    ring_doorbell(b, ep);
+}
+
+/* queue_bulk_tx()：一個 URB 拆成 num_trbs 個 TRB */
+static int queue_urb(struct bench *b, unsigned int ep, unsigned int num_trbs,
+                     bool defer)
+{
+    struct ring *ring = &b->rings[ep];
+    struct trb *start_trb;
+    uint32_t start_cycle, field;
+    unsigned int i;
+
+    prepare_ring(ring);
+
+    /* ring 滿時等執行中的 xHC 讀走 (真實驅動會擴充 ring) */
+    while (ring->num_trbs_free < num_trbs && ring->running)
+        hc_run(b, ring, 1);
+    if (ring->num_trbs_free < num_trbs)
+        return -1;
+
+    start_trb = ring->enqueue;
+    start_cycle = ring->cycle_state;
+
+    for (i = 0; i < num_trbs; i++) {
+        field = TRB_TYPE(TRB_NORMAL);
+        /* 第一個 TRB 先寫成軟體擁有，最後才交接 */
+        field |= (i == 0) ? (ring->cycle_state ^ 1) : ring->cycle_state;
+        if (i < num_trbs - 1)
+            field |= TRB_CHAIN;
+        else
+            field |= TRB_IOC;
+
+        ring->enqueue->field[0] = i;
+        ring->enqueue->field[1] = ring->sw_seq++;
+        ring->enqueue->field[3] = field;
+        inc_enq(ring, i < num_trbs - 1);
+        hc_tick(b);
+    }
+
+    giveback_first_trb(b, ep, defer, start_cycle, start_trb);
+    hc_tick(b);
+
+    return 0;
+}
+
+/* 其他 context 的提交：不帶延後旗標，交接後必須已寫 doorbell */
+static int queue_other(struct bench *b, unsigned int ep)
+{
+    unsigned long writes = b->db_writes;
+
+    if (queue_urb(b, ep, 1, false))
+        return -1;
+
+    b->others++;
+    if (b->db_writes == writes)
+        b->others_deferred++;
+
+    return 0;
+}
+
+static void batch_end(struct bench *b)
+{
+    unsigned int ep;
+
+    for (ep = 0; ep < b->endpoints; ep++)
+        if (b->db_pending & (1U << ep))
+            ring_doorbell(b, ep);
+    b->db_pending = 0;
+}
+
+/*
+ * 提交 urbs 個 URB，輪流分配到各端點，每個 URB 1-3 個 TRB；
+ * batch 為 0 表示逐一提交，否則每 batch 個 URB 為一批
+ */
+struct params {
+    unsigned long urbs;
+    unsigned int endpoints;
+    unsigned int mmio_ns;
+    unsigned int hc_pct;
+    unsigned int other_pct;
+};
+
+static void run(const char *name, const struct params *p, unsigned int batch)
+{
+    static struct bench b;
+    unsigned long submitted = 0, hc_tds = 0, n;
+    unsigned int ep, i;
+    uint64_t start, elapsed;
+
+    memset(&b, 0, sizeof(b));
+    b.endpoints = p->endpoints;
+    b.mmio_ns = p->mmio_ns;
+    b.hc_pct = p->hc_pct;
+    b.rng = 0x9E3779B97F4A7C15ULL;
+    for (ep = 0; ep < p->endpoints; ep++)
+        ring_init(&b.rings[ep]);
+
+    start = now_ns();
+    while (submitted < p->urbs) {
+        n = batch ? batch : 1;
+        if (n > p->urbs - submitted)
+            n = p->urbs - submitted;
+
+        b.in_batch = batch != 0;
+        for (i = 0; i < n; i++, submitted++) {
+            ep = submitted % p->endpoints;
+            if (queue_urb(&b, ep, 1 + submitted % 3, batch != 0)) {
+                fprintf(stderr, "%s: ring full at %lu\n", name, submitted);
+                b.error = true;
+                break;
+            }
+
+            /* batch 進行中，其他 context 對同一裝置提交 */
+            if (batch && bench_rand(&b) % 100 < p->other_pct &&
+                queue_other(&b, bench_rand(&b) % p->endpoints)) {
+                b.error = true;
+                break;
+            }
+        }
+        b.in_batch = false;
+        if (batch)
+            batch_end(&b);
+        if (b.error)
+            break;
+    }
+
+    /* 讓執行中的端點讀完；停下來還有 TD 沒被取走表示漏了 doorbell */
+    for (ep = 0; ep < p->endpoints; ep++)
+        hc_run(&b, &b.rings[ep], ~0U);
+    elapsed = now_ns() - start;
+
+    for (ep = 0; ep < p->endpoints; ep++)
+        hc_tds += b.rings[ep].hc_tds;
+
+    printf("%-9s tds %7lu  doorbells %7lu  per transfer %.3f  "
+           "early %6lu  stalls %6lu  others %6lu/%lu  %5.1f ns  %s\n",
+           name, b.tds, b.db_writes, (double)b.db_writes / b.tds,
+           b.early, b.stalls, b.others, b.others_deferred,
+           (double)elapsed / b.tds,
+           (!b.error && hc_tds == b.tds) ? "ok" : "MISMATCH");
+}
+
+int main(int argc, char **argv)
+{
+    static const unsigned int batches[] = { 4, 8, 16 };
+    struct params p = {
+        .urbs = 1000000,
+        .endpoints = 2,
+        .mmio_ns = 0,
+        .hc_pct = 50,
+        .other_pct = 0,
+    };
+    char name[16];
+    unsigned int i;
+
+    if (argc > 1)
+        p.urbs = strtoul(argv[1], NULL, 0);
+    if (argc > 2)
+        p.endpoints = strtoul(argv[2], NULL, 0);
+    if (argc > 3)
+        p.mmio_ns = strtoul(argv[3], NULL, 0);
+    if (argc > 4)
+        p.hc_pct = strtoul(argv[4], NULL, 0);
+    if (argc > 5)
+        p.other_pct = strtoul(argv[5], NULL, 0);
+
+    if (p.endpoints == 0 || p.endpoints > MAX_ENDPOINTS) {
+        fprintf(stderr, "endpoints must be 1-%d\n", MAX_ENDPOINTS);
+        return 1;
+    }
+
+    printf("%lu URBs over %u endpoints, %u ns per doorbell write, "
+           "xHC runs %u%%, other submitters %u%%\n",
+           p.urbs, p.endpoints, p.mmio_ns, p.hc_pct, p.other_pct);
+
+    run("per-urb", &p, 0);
+    for (i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+        snprintf(name, sizeof(name), "batch %u", batches[i]);
+        run(name, &p, batches[i]);
+    }
+
+    return 0;
+}
+
+/*
+ * 執行結果 (xHC 與入隊交錯，hc_pct = 50)：
+ *
+ *   ./xhci_doorbell_bench                 (2 個端點，不模擬 MMIO 成本)
+ *   per-urb   tds 1000000  doorbells 1000000  per transfer 1.000  early      0  stalls      0  others      0/0  129.6 ns  ok
+ *   batch 4   tds 1000000  doorbells  500000  per transfer 0.500  early 511193  stalls 470433  others      0/0  122.6 ns  ok
+ *   batch 8   tds 1000000  doorbells  250000  per transfer 0.250  early 632487  stalls 246942  others      0/0  126.3 ns  ok
+ *   batch 16  tds 1000000  doorbells  125000  per transfer 0.125  early 782490  stalls 124915  others      0/0   97.4 ns  ok
+ *
+ *   ./xhci_doorbell_bench 1000000 1       (單一端點)
+ *   per-urb   tds 1000000  doorbells 1000000  per transfer 1.000  early      0  stalls      0  others      0/0   81.8 ns  ok
+ *   batch 4   tds 1000000  doorbells  250000  per transfer 0.250  early 785697  stalls 164262  others      0/0   78.1 ns  ok
+ *   batch 8   tds 1000000  doorbells  125000  per transfer 0.125  early 886568  stalls  90161  others      0/0   77.0 ns  ok
+ *   batch 16  tds 1000000  doorbells   62500  per transfer 0.062  early 941400  stalls  47191  others      0/0   80.7 ns  ok
+ *
+ *   ./xhci_doorbell_bench 200000 2 300    (每次 doorbell 300 ns)
+ *   per-urb   tds  200000  doorbells  200000  per transfer 1.000  early      0  stalls      0  others      0/0  503.2 ns  ok
+ *   batch 4   tds  200000  doorbells  100000  per transfer 0.500  early 102009  stalls  93963  others      0/0  278.4 ns  ok
+ *   batch 8   tds  200000  doorbells   50000  per transfer 0.250  early 126978  stalls  49374  others      0/0  181.5 ns  ok
+ *   batch 16  tds  200000  doorbells   25000  per transfer 0.125  early 156737  stalls  24983  others      0/0  130.7 ns  ok
+ *
+ *   ./xhci_doorbell_bench 1000000 2 0 50 10   (batch 中 10% 機率插入其他提交者)
+ *   per-urb   tds 1000000  doorbells 1000000  per transfer 1.000  early      0  stalls      0  others      0/0  101.9 ns  ok
+ *   batch 4   tds 1099919  doorbells  562734  per transfer 0.512  early 490133  stalls 512705  others  99919/0  110.8 ns  ok
+ *   batch 8   tds 1100171  doorbells  331855  per transfer 0.302  early 591890  stalls 297849  others 100171/0  112.6 ns  ok
+ *   batch 16  tds 1100185  doorbells  216054  per transfer 0.196  early 708801  stalls 181041  others 100185/0  123.1 ns  ok
+ *
+ * doorbell 數等於 batch 數 x 批次內的端點數 (加上其他提交者各自的一次)。
+ * early 與 stalls 表示兩種交錯都大量出現：執行中的端點在 doorbell 前取走
+ * 已交接的 TD，以及端點停在批次中尚未交接的 TD 前、由 batch_end 叫醒；
+ * 所有設定下 xHC 都依序取走了全部 TD (ok)。其他提交者沒有一次被延後
+ * (others n/0)。把 batch_end 的 doorbell 拿掉時每個 batch 設定都是
+ * MISMATCH。ns/transfer 含模擬 xHC 的成本，只有相對值有意義；實際 MMIO
+ * 成本請在目標平台上以 debugfs 的 doorbell_stats 搭配 perf 量測。
+ */
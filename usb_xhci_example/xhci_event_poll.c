@@ -0,0 +1,503 @@
+/*
+ * xHCI Event Ring Budgeted Polling + Adaptive Interrupt Moderation Example
+ *
+ * usb-interrupt-transfer-xhci.md §11.4 / §11.8 的 xhci_irq() 在 hard-IRQ
+ * context 把整個 event ring 處理完，每個 IOC event 都可能觸發一次 MSI-X。
+ * 大量 interrupt / bulk 傳輸時，IRQ 次數與 hard-IRQ 內停留的時間都會
+ * 跟著負載成長。
+ *
+ * 這個範例改成類似 NAPI 的方式，使用 lib/irq_poll (block driver 的
+ * softirq 輪詢機制)：
+ *
+ *   MSI-X ──> xhci_ir_msi_irq()          hard-IRQ：檢查 USBSTS、清 IP、
+ *                                         關閉 IMAN.IE、irq_poll_sched()，
+ *                                         不處理 event
+ *   IRQ_POLL_SOFTIRQ ──> xhci_ir_poll()  每次最多處理 weight 個 event；
+ *                                         用完 budget 就交還 softirq，
+ *                                         稍後繼續輪詢，IE 保持關閉
+ *                        ring 清空 ──>   irq_poll_complete()、依 event 速率
+ *                                         調整 IMOD、重新開啟 IE
+ *
+ * IMOD (Interrupter Moderation，250ns 為單位) 限制的是兩次中斷之間的
+ * 最小間隔，不會延遲閒置後的第一個中斷；低負載時 IMOD 設為 0，中斷
+ * 立即送達，高負載時拉長間隔，讓每次中斷帶進更多 event。升級依表格
+ * 門檻，降級要低於門檻 3/4，避免在門檻附近來回切換。
+ *
+ * IMOD 不能超過最短的 interrupt 端點服務間隔，否則 xHC 在一個間隔內
+ * 完成的 TD 要等到下一個間隔之後才通知，驅動重新送出 URB 前就錯過
+ * 輪詢。等級的上限取 event_poll_imod_max (預設 40us) 與目前已設定的
+ * interrupt 端點中最短間隔兩者的較小值，後者在端點加入 / 移除時更新；
+ * 125us / 250us 的等級需要以模組參數開啟，且只在沒有更短間隔的
+ * interrupt 端點時使用。
+ *
+ * 每個 interrupter 各自統計中斷數、event 數、budget 用完次數，以及
+ * hard-IRQ 到 poll 開始的延遲，透過 debugfs 的 ir<N>_poll_stats 輸出。
+ *
+ * 對應 drivers/usb/host/xhci-ring.c、xhci.c 與 xhci-debugfs.c；以模組
+ * 參數 event_poll 選擇，關閉時維持 xhci_msi_irq() 原本的流程。
+ * 主機端的中斷數 / 延遲模擬見 xhci_event_poll_bench.c
+ */
+
+#include <linux/debugfs.h>
+#include <linux/interrupt.h>
+#include <linux/irq_poll.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+
+#include "xhci.h"
+
+static bool event_poll;
+module_param(event_poll, bool, 0444);
+MODULE_PARM_DESC(event_poll, "poll the event ring from softirq with adaptive IMOD");
+
+static unsigned int event_poll_weight = 64;
+module_param(event_poll_weight, uint, 0444);
+MODULE_PARM_DESC(event_poll_weight, "max events handled per poll");
+
+static unsigned int event_poll_imod_max = 40000;
+module_param(event_poll_imod_max, uint, 0644);
+MODULE_PARM_DESC(event_poll_imod_max, "upper bound of adaptive IMOD in ns");
+
+/* event 速率的取樣視窗 */
+#define XHCI_IMOD_WINDOW_NS     (4 * NSEC_PER_MSEC)
+
+struct xhci_imod_level {
+    u32 min_rate;       /* events/s 達到此值才進入此等級 */
+    u32 imod_ns;        /* IMODI，必須是 250ns 的倍數 */
+};
+
+/*
+ * high-speed interrupt 端點最短每 125us 完成一次，單一端點不會超過
+ * 8000 events/s，維持在 IMOD 0；32000 events/s 才回到驅動預設的 40us。
+ * 最後兩級等於或超過 HS 的 microframe 間隔，只給 bulk 主導、沒有短
+ * 間隔 interrupt 端點的負載使用，預設被 event_poll_imod_max 擋住
+ */
+static const struct xhci_imod_level xhci_imod_levels[] = {
+    { .min_rate = 0,      .imod_ns = 0 },
+    { .min_rate = 12000,  .imod_ns = 16000 },
+    { .min_rate = 32000,  .imod_ns = 40000 },
+    { .min_rate = 100000, .imod_ns = 125000 },
+    { .min_rate = 200000, .imod_ns = 250000 },
+};
+
+/*
+ * struct xhci_interrupter 新增欄位 (xhci.h)：
+ *
+ *   struct xhci_ir_poll poll;
+ */
+struct xhci_ir_poll {
+    struct irq_poll iop;
+    struct xhci_hcd *xhci;
+    int irq;
+
+    /* 自適應 IMOD */
+    unsigned int level;
+    u32 imod_cap_ns;
+    u64 window_start;
+    u64 window_events;
+    u64 rate;
+
+    /* hard-IRQ 時間，poll 開始時用來計算延遲；0 表示沒有待量測的中斷 */
+    u64 irq_ns;
+
+    /* 統計，xhci->lock 保護 */
+    u64 irqs;
+    u64 polls;
+    u64 events;
+    u64 budget_exhausted;
+    u64 rearm_races;
+    u64 imod_changes;
+    u64 latency_sum_ns;
+    u64 latency_samples;
+    u64 latency_max_ns;
+    u64 poll_max_ns;
+};
+
+static inline struct xhci_interrupter *iop_to_ir(struct irq_poll *iop)
+{
+    return container_of(iop, struct xhci_interrupter, poll.iop);
+}
+
+/* dequeue 上的 TRB 已由 xHC 寫入 (cycle bit 與 consumer cycle state 相符) */
+static bool xhci_ir_event_pending(struct xhci_interrupter *ir)
+{
+    union xhci_trb *event = ir->event_ring->dequeue;
+
+    return (le32_to_cpu(event->event_cmd.flags) & TRB_CYCLE) ==
+           ir->event_ring->cycle_state;
+}
+
+/*
+ * 已安裝的 interrupt 端點依服務間隔 (2^Interval * 125us) 分桶計數，
+ * 最短間隔在端點加入 / 移除時更新，輪詢時直接讀取快取值
+ *
+ * struct xhci_hcd 新增欄位 (xhci.h)：
+ *
+ *   struct xhci_int_intervals int_intervals;
+ *
+ * struct xhci_virt_ep 新增欄位 (xhci.h)：
+ *
+ *   bool int_tracked;   端點已計入 int_intervals
+ *   u8 int_exp;         計入時的 Interval (0-15)
+ *
+ * 端點的安裝與釋放不一定持有 xhci->lock，因此用獨立的 lock
+ */
+#define XHCI_INT_INTERVAL_EXPS  16
+
+struct xhci_int_intervals {
+    spinlock_t lock;
+    u16 count[XHCI_INT_INTERVAL_EXPS];
+    u32 min_ns;         /* 沒有 interrupt 端點時為 U32_MAX */
+};
+
+/* xhci.c：xhci_init() 中初始化 */
+static void xhci_int_intervals_init(struct xhci_hcd *xhci)
+{
+    struct xhci_int_intervals *ivs = &xhci->int_intervals;
+
+    spin_lock_init(&ivs->lock);
+    memset(ivs->count, 0, sizeof(ivs->count));
+    ivs->min_ns = U32_MAX;
+}
+
+/* 呼叫者持有 ivs->lock */
+static void xhci_int_intervals_refresh(struct xhci_int_intervals *ivs)
+{
+    u32 min_ns = U32_MAX;
+    int exp;
+
+    for (exp = 0; exp < XHCI_INT_INTERVAL_EXPS; exp++) {
+        if (ivs->count[exp]) {
+            min_ns = (125 * NSEC_PER_USEC) << exp;
+            break;
+        }
+    }
+
+    WRITE_ONCE(ivs->min_ns, min_ns);
+}
+
+/*
+ * xhci.c：xhci_check_bandwidth() 安裝 new_ring 之後呼叫
+ * configure endpoint 命令完成後 out_ctx 已是 xHC 採用的設定
+ */
+static void xhci_int_interval_add(struct xhci_hcd *xhci,
+                                  struct xhci_virt_device *vdev,
+                                  unsigned int ep_index)
+{
+    struct xhci_int_intervals *ivs = &xhci->int_intervals;
+    struct xhci_virt_ep *ep = &vdev->eps[ep_index];
+    struct xhci_ep_ctx *ep_ctx;
+    unsigned long flags;
+    u32 type, exp;
+
+    ep_ctx = xhci_get_ep_ctx(xhci, vdev->out_ctx, ep_index);
+    type = CTX_TO_EP_TYPE(le32_to_cpu(ep_ctx->ep_info2));
+    if (type != INT_IN_EP && type != INT_OUT_EP)
+        return;
+
+    exp = min_t(u32, CTX_TO_EP_INTERVAL(le32_to_cpu(ep_ctx->ep_info)),
+                XHCI_INT_INTERVAL_EXPS - 1);
+
+    spin_lock_irqsave(&ivs->lock, flags);
+    if (!ep->int_tracked) {
+        ep->int_tracked = true;
+        ep->int_exp = exp;
+        ivs->count[exp]++;
+        xhci_int_intervals_refresh(ivs);
+    }
+    spin_unlock_irqrestore(&ivs->lock, flags);
+}
+
+/*
+ * xhci-mem.c：xhci_free_endpoint_ring() 與 xhci_free_virt_device()
+ * 釋放端點 ring 時呼叫；以加入時記下的 Interval 扣除
+ */
+static void xhci_int_interval_drop(struct xhci_hcd *xhci,
+                                   struct xhci_virt_device *vdev,
+                                   unsigned int ep_index)
+{
+    struct xhci_int_intervals *ivs = &xhci->int_intervals;
+    struct xhci_virt_ep *ep = &vdev->eps[ep_index];
+    unsigned long flags;
+
+    spin_lock_irqsave(&ivs->lock, flags);
+    if (ep->int_tracked) {
+        ep->int_tracked = false;
+        ivs->count[ep->int_exp]--;
+        xhci_int_intervals_refresh(ivs);
+    }
+    spin_unlock_irqrestore(&ivs->lock, flags);
+}
+
+/*
+ * 依最近一個視窗的 event 速率選擇 IMOD 等級，呼叫者持有 xhci->lock
+ * 上限每個視窗重新計算一次，新加入的短間隔端點最多在一個視窗
+ * (4ms) 後生效；最短間隔由端點加入 / 移除時維護，這裡只讀快取值
+ */
+static void xhci_ir_update_imod(struct xhci_hcd *xhci,
+                                struct xhci_interrupter *ir, u64 now)
+{
+    struct xhci_ir_poll *p = &ir->poll;
+    unsigned int level = p->level;
+    u64 elapsed = now - p->window_start;
+
+    if (elapsed < XHCI_IMOD_WINDOW_NS)
+        return;
+
+    p->rate = div64_u64((p->events - p->window_events) * NSEC_PER_SEC,
+                        elapsed);
+    p->window_start = now;
+    p->window_events = p->events;
+
+    while (level + 1 < ARRAY_SIZE(xhci_imod_levels) &&
+           p->rate >= xhci_imod_levels[level + 1].min_rate)
+        level++;
+
+    while (level > 0 &&
+           p->rate < xhci_imod_levels[level].min_rate * 3 / 4)
+        level--;
+
+    p->imod_cap_ns = min_t(u32, READ_ONCE(event_poll_imod_max),
+                           READ_ONCE(xhci->int_intervals.min_ns));
+    while (level > 0 && xhci_imod_levels[level].imod_ns > p->imod_cap_ns)
+        level--;
+
+    if (level == p->level)
+        return;
+
+    p->level = level;
+    p->imod_changes++;
+    xhci_set_interrupter_moderation(ir, xhci_imod_levels[level].imod_ns);
+}
+
+/*
+ * hard-IRQ：只確認並遮蔽這個 interrupter，event 交給 softirq 處理
+ * 每個 MSI-X 向量對應一個 interrupter；legacy / shared IRQ 仍走 xhci_irq()
+ * USBSTS 的檢查與 xhci_irq() 相同：控制器消失或 Host System Error 時
+ * 不排程輪詢，交給 xhci_hc_died() / xhci_halt() 處理
+ */
+static irqreturn_t xhci_ir_msi_irq(int irq, void *data)
+{
+    struct xhci_interrupter *ir = data;
+    struct xhci_ir_poll *p = &ir->poll;
+    struct xhci_hcd *xhci = p->xhci;
+    irqreturn_t ret = IRQ_NONE;
+    u32 status;
+
+    spin_lock(&xhci->lock);
+
+    if (xhci->xhc_state & XHCI_STATE_DYING)
+        goto out;
+
+    status = readl(&xhci->op_regs->status);
+    if (status == ~(u32)0) {
+        xhci_hc_died(xhci);
+        ret = IRQ_HANDLED;
+        goto out;
+    }
+
+    if (status & STS_HCE) {
+        xhci_warn(xhci, "WARNING: Host Controller Error\n");
+        goto out;
+    }
+
+    if (status & STS_FATAL) {
+        xhci_warn(xhci, "WARNING: Host System Error\n");
+        xhci_halt(xhci);
+        ret = IRQ_HANDLED;
+        goto out;
+    }
+
+    /*
+     * 先清 USBSTS.EINT (連同其他已設定的 RW1C 位元，與 xhci_irq() 相同)，
+     * 其他 MSI-X interrupter 的中斷才能繼續送達
+     */
+    writel(status | STS_EINT, &xhci->op_regs->status);
+
+    xhci_clear_interrupt_pending(ir);
+    xhci_disable_interrupter(xhci, ir);
+
+    p->irqs++;
+    if (!p->irq_ns)
+        p->irq_ns = ktime_get_ns();
+
+    spin_unlock(&xhci->lock);
+
+    irq_poll_sched(&p->iop);
+
+    return IRQ_HANDLED;
+
+out:
+    spin_unlock(&xhci->lock);
+
+    return ret;
+}
+
+/*
+ * IRQ_POLL_SOFTIRQ：最多處理 budget 個 event
+ * 回傳值小於 budget 代表 ring 已清空並重新開啟中斷
+ */
+static int xhci_ir_poll(struct irq_poll *iop, int budget)
+{
+    struct xhci_interrupter *ir = iop_to_ir(iop);
+    struct xhci_ir_poll *p = &ir->poll;
+    struct xhci_hcd *xhci = p->xhci;
+    unsigned long flags;
+    u64 start, now;
+    int done = 0;
+    int ret = 0;
+
+    start = ktime_get_ns();
+
+    spin_lock_irqsave(&xhci->lock, flags);
+
+    if (p->irq_ns) {
+        u64 latency = start - p->irq_ns;
+
+        p->latency_sum_ns += latency;
+        p->latency_samples++;
+        if (latency > p->latency_max_ns)
+            p->latency_max_ns = latency;
+        p->irq_ns = 0;
+    }
+
+    while (done < budget && xhci_ir_event_pending(ir)) {
+        ret = xhci_handle_event_trb(xhci, ir, ir->event_ring->dequeue);
+        if (ret < 0)
+            break;
+
+        inc_deq(xhci, ir->event_ring);
+        done++;
+
+        /* 長時間輪詢時定期更新 ERDP，讓 xHC 回收 event ring 空間 */
+        if (!(done % (TRBS_PER_SEGMENT / 2)))
+            xhci_update_erst_dequeue(xhci, ir, false);
+    }
+
+    /* 清除 EHB，之後的 event 才能再觸發中斷 */
+    xhci_update_erst_dequeue(xhci, ir, true);
+
+    now = ktime_get_ns();
+    p->polls++;
+    p->events += done;
+    if (now - start > p->poll_max_ns)
+        p->poll_max_ns = now - start;
+
+    if (ret < 0) {
+        /* HC 已停止：不再開啟中斷，交給 xhci_hc_died() 的流程 */
+        irq_poll_complete(iop);
+        goto out;
+    }
+
+    if (done == budget) {
+        /* 保持 IE 關閉，IRQ_POLL_SOFTIRQ 稍後再呼叫 */
+        p->budget_exhausted++;
+        xhci_ir_update_imod(xhci, ir, now);
+        goto out;
+    }
+
+    irq_poll_complete(iop);
+    xhci_ir_update_imod(xhci, ir, now);
+    xhci_enable_interrupter(ir);
+
+    /*
+     * 最後一次檢查與開啟 IE 之間寫入的 event 可能不會再觸發中斷，
+     * 開啟後再看一次；有的話重新遮蔽並繼續輪詢
+     */
+    if (xhci_ir_event_pending(ir)) {
+        p->rearm_races++;
+        xhci_disable_interrupter(xhci, ir);
+        spin_unlock_irqrestore(&xhci->lock, flags);
+        irq_poll_sched(iop);
+        return done;
+    }
+
+out:
+    spin_unlock_irqrestore(&xhci->lock, flags);
+
+    return done;
+}
+
+/*
+ * xhci.c：取代 xhci_setup_msix() 中的 request_irq(..., xhci_msi_irq, ...)
+ * event_poll 關閉時呼叫者維持原本的註冊方式
+ */
+static int xhci_ir_poll_setup(struct xhci_hcd *xhci,
+                              struct xhci_interrupter *ir, int irq)
+{
+    struct xhci_ir_poll *p = &ir->poll;
+    int ret;
+
+    memset(p, 0, sizeof(*p));
+    p->xhci = xhci;
+    p->irq = irq;
+    p->window_start = ktime_get_ns();
+    p->imod_cap_ns = event_poll_imod_max;
+    irq_poll_init(&p->iop, event_poll_weight, xhci_ir_poll);
+
+    /* 從不 moderation 開始，由量測到的速率往上調 */
+    ret = xhci_set_interrupter_moderation(ir, xhci_imod_levels[0].imod_ns);
+    if (ret)
+        return ret;
+
+    ret = request_irq(irq, xhci_ir_msi_irq, 0, "xhci_hcd", ir);
+    if (ret)
+        irq_poll_disable(&p->iop);
+
+    return ret;
+}
+
+/* xhci.c：xhci_cleanup_msix() 中釋放 */
+static void xhci_ir_poll_teardown(struct xhci_interrupter *ir)
+{
+    struct xhci_ir_poll *p = &ir->poll;
+
+    free_irq(p->irq, ir);
+    irq_poll_disable(&p->iop);
+}
+
+/* xhci-debugfs.c：每個 interrupter 的中斷數與延遲 */
+static int xhci_ir_poll_stats_show(struct seq_file *s, void *unused)
+{
+    struct xhci_interrupter *ir = s->private;
+    struct xhci_ir_poll *p = &ir->poll;
+    struct xhci_ir_poll snap;
+    unsigned long flags;
+
+    spin_lock_irqsave(&p->xhci->lock, flags);
+    snap = *p;
+    spin_unlock_irqrestore(&p->xhci->lock, flags);
+
+    seq_printf(s, "irqs:             %llu\n", snap.irqs);
+    seq_printf(s, "polls:            %llu\n", snap.polls);
+    seq_printf(s, "events:           %llu\n", snap.events);
+    if (snap.irqs)
+        seq_printf(s, "events_per_irq:   %llu\n",
+                   div64_u64(snap.events, snap.irqs));
+    seq_printf(s, "budget_exhausted: %llu\n", snap.budget_exhausted);
+    seq_printf(s, "rearm_races:      %llu\n", snap.rearm_races);
+    seq_printf(s, "event_rate:       %llu/s\n", snap.rate);
+    seq_printf(s, "imod_ns:          %u\n",
+               xhci_imod_levels[snap.level].imod_ns);
+    seq_printf(s, "imod_cap_ns:      %u\n", snap.imod_cap_ns);
+    seq_printf(s, "imod_changes:     %llu\n", snap.imod_changes);
+    if (snap.latency_samples)
+        seq_printf(s, "irq_to_poll_avg:  %llu ns\n",
+                   div64_u64(snap.latency_sum_ns, snap.latency_samples));
+    seq_printf(s, "irq_to_poll_max:  %llu ns\n", snap.latency_max_ns);
+    seq_printf(s, "poll_max:         %llu ns\n", snap.poll_max_ns);
+
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(xhci_ir_poll_stats);
+
+/* 於 xhci_debugfs_init() 中對每個已啟用的 interrupter 呼叫 */
+static void xhci_debugfs_create_ir_poll_stats(struct xhci_interrupter *ir,
+                                              struct dentry *root)
+{
+    char name[24];
+
+    snprintf(name, sizeof(name), "ir%u_poll_stats", ir->intr_num);
+    debugfs_create_file(name, 0444, root, ir, &xhci_ir_poll_stats_fops);
+}
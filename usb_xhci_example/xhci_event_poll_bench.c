@@ -0,0 +1,308 @@
+/*
+ * xHCI Interrupt Moderation / Event Polling Simulator (host)
+ *
+ * 以離散事件模擬比較單一 interrupter 在不同 event 速率下的中斷次數、
+ * hard-IRQ 停留時間與 event 處理延遲：
+ *
+ *   irq imod=0    §11.8 的 xhci_irq()，每個 event 都可能觸發一次中斷
+ *   irq imod=40   同上，IMOD 固定 40us (xhci->imod_interval 的預設值)
+ *   poll cap=N    xhci_event_poll.c：hard-IRQ 只遮蔽 interrupter，
+ *                 softirq 以 budget 輪詢，依 event 速率調整 IMOD，
+ *                 等級上限 N us：40 是 event_poll_imod_max 的預設值，
+ *                 125 是開啟高等級且有 HS 1-microframe interrupt 端點，
+ *                 250 是開啟高等級且沒有 interrupt 端點
+ *
+ * 模型：
+ *   - event 以 Poisson 過程到達 (固定種子)，延遲 = event 被處理完的時間
+ *     減去到達時間
+ *   - xHC 只有在 IE 開啟、ring 非空、距上次中斷已超過 IMOD 時才發中斷；
+ *     閒置後的第一個 event 不受 IMOD 延遲
+ *   - 處理過程中到達的 event 在同一輪被處理 (兩種方式都如此)
+ *   - 成本：中斷進出 irq_ns、每個 event event_ns、softirq 排程 sched_ns、
+ *     budget 用完後重新輪詢 resched_ns；數值是估計，可從命令列調整
+ *
+ * 編譯與執行：
+ *   gcc -O2 -o xhci_event_poll_bench xhci_event_poll_bench.c -lm
+ *   ./xhci_event_poll_bench [events] [irq_ns] [event_ns] [sched_ns]
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NSEC_PER_SEC        1000000000ULL
+#define IMOD_WINDOW_NS      4000000ULL
+#define POLL_WEIGHT         64
+#define HIST_BUCKET_NS      1000
+#define HIST_BUCKETS        4096
+
+enum mode {
+    MODE_IRQ,
+    MODE_POLL,
+};
+
+struct cost {
+    unsigned int irq_ns;
+    unsigned int event_ns;
+    unsigned int sched_ns;
+    unsigned int resched_ns;
+};
+
+/* 與 xhci_event_poll.c 的 xhci_imod_levels[] 相同 */
+static const struct {
+    uint32_t min_rate;
+    uint32_t imod_ns;
+} imod_levels[] = {
+    { 0,      0 },
+    { 12000,  16000 },
+    { 32000,  40000 },
+    { 100000, 125000 },
+    { 200000, 250000 },
+};
+
+#define NR_LEVELS   (sizeof(imod_levels) / sizeof(imod_levels[0]))
+
+struct result {
+    unsigned long irqs;
+    uint64_t elapsed_ns;
+    uint64_t busy_ns;
+    uint64_t max_hardirq_ns;
+    uint64_t latency_sum_ns;
+    uint32_t hist[HIST_BUCKETS];
+    unsigned int final_imod_ns;
+};
+
+static uint64_t rng_state;
+
+static double sim_uniform(void)
+{
+    uint64_t x = rng_state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    rng_state = x;
+
+    return ((x >> 11) + 0.5) / (double)(1ULL << 53);
+}
+
+/* Poisson 到達：指數分佈的間隔 */
+static uint64_t next_arrival(uint64_t t, unsigned long rate)
+{
+    return t + (uint64_t)(-log(sim_uniform()) * NSEC_PER_SEC / rate);
+}
+
+static void record_latency(struct result *r, uint64_t latency)
+{
+    uint64_t bucket = latency / HIST_BUCKET_NS;
+
+    if (bucket >= HIST_BUCKETS)
+        bucket = HIST_BUCKETS - 1;
+    r->hist[bucket]++;
+    r->latency_sum_ns += latency;
+}
+
+static uint64_t percentile_ns(const struct result *r, unsigned long n,
+                              double pct)
+{
+    unsigned long target = (unsigned long)(n * pct), seen = 0;
+    unsigned int i;
+
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        seen += r->hist[i];
+        if (seen > target)
+            return (uint64_t)(i + 1) * HIST_BUCKET_NS;
+    }
+
+    return (uint64_t)HIST_BUCKETS * HIST_BUCKET_NS;
+}
+
+static void simulate(struct result *r, enum mode mode, unsigned int imod_ns,
+                     unsigned long rate, unsigned long events,
+                     const struct cost *c)
+{
+    uint64_t arrival, now = 0, irq_at, last_irq = 0, hardirq_start;
+    uint64_t window_start = 0, window_events = 0, processed = 0, w_rate;
+    unsigned int level = 0, imod, done;
+    unsigned long remaining = events;
+    bool first = true;
+
+    memset(r, 0, sizeof(*r));
+    rng_state = 0x9E3779B97F4A7C15ULL;
+    arrival = next_arrival(0, rate);
+    /* MODE_IRQ：固定的 IMOD；MODE_POLL：等級上限 */
+    imod = (mode == MODE_POLL) ? imod_levels[0].imod_ns : imod_ns;
+
+    while (remaining) {
+        /* IE 開啟、ring 上有 event：依 IMOD 決定中斷時間 */
+        irq_at = arrival;
+        if (!first && irq_at < last_irq + imod)
+            irq_at = last_irq + imod;
+        first = false;
+
+        last_irq = irq_at;
+        r->irqs++;
+        now = irq_at;
+        hardirq_start = now;
+        now += c->irq_ns;
+
+        if (mode == MODE_POLL) {
+            /* hard-IRQ 只清 IP、關 IE，event 在 softirq 處理 */
+            if (now - hardirq_start > r->max_hardirq_ns)
+                r->max_hardirq_ns = now - hardirq_start;
+            now += c->sched_ns;
+        }
+
+        for (;;) {
+            done = 0;
+            while (remaining && arrival <= now &&
+                   (mode == MODE_IRQ || done < POLL_WEIGHT)) {
+                now += c->event_ns;
+                record_latency(r, now - arrival);
+                arrival = next_arrival(arrival, rate);
+                remaining--;
+                processed++;
+                done++;
+            }
+
+            if (mode == MODE_IRQ || done < POLL_WEIGHT)
+                break;
+
+            /* budget 用完，交還 softirq 後繼續輪詢 */
+            now += c->resched_ns;
+        }
+
+        if (mode == MODE_IRQ) {
+            if (now - hardirq_start > r->max_hardirq_ns)
+                r->max_hardirq_ns = now - hardirq_start;
+        } else if (now - window_start >= IMOD_WINDOW_NS) {
+            /* xhci_ir_update_imod() */
+            w_rate = (processed - window_events) * NSEC_PER_SEC /
+                     (now - window_start);
+            window_start = now;
+            window_events = processed;
+
+            while (level + 1 < NR_LEVELS &&
+                   w_rate >= imod_levels[level + 1].min_rate)
+                level++;
+            while (level > 0 && w_rate < imod_levels[level].min_rate * 3 / 4)
+                level--;
+            while (level > 0 && imod_levels[level].imod_ns > imod_ns)
+                level--;
+            imod = imod_levels[level].imod_ns;
+        }
+
+        r->busy_ns += now - irq_at;
+    }
+
+    r->elapsed_ns = now;
+    r->final_imod_ns = imod;
+}
+
+static void report(const char *name, const struct result *r,
+                   unsigned long events)
+{
+    printf("  %-12s irq/s %7.0f  ev/irq %6.1f  cpu %5.1f%%  "
+           "max hardirq %6.1f us  lat avg %6.1f p99 %5.0f us  imod %3u us\n",
+           name, (double)r->irqs * NSEC_PER_SEC / r->elapsed_ns,
+           (double)events / r->irqs, 100.0 * r->busy_ns / r->elapsed_ns,
+           r->max_hardirq_ns / 1000.0,
+           (double)r->latency_sum_ns / events / 1000.0,
+           percentile_ns(r, events, 0.99) / 1000.0,
+           r->final_imod_ns / 1000);
+}
+
+int main(int argc, char **argv)
+{
+    static const unsigned long rates[] = { 1000, 8000, 32000, 100000, 250000 };
+    static struct result r;
+    struct cost c = {
+        .irq_ns = 1500,
+        .event_ns = 800,
+        .sched_ns = 1000,
+        .resched_ns = 500,
+    };
+    unsigned long events = 500000;
+    unsigned int i;
+
+    if (argc > 1)
+        events = strtoul(argv[1], NULL, 0);
+    if (argc > 2)
+        c.irq_ns = strtoul(argv[2], NULL, 0);
+    if (argc > 3)
+        c.event_ns = strtoul(argv[3], NULL, 0);
+    if (argc > 4)
+        c.sched_ns = strtoul(argv[4], NULL, 0);
+
+    printf("%lu events per run, irq %u ns, event %u ns, softirq %u ns\n",
+           events, c.irq_ns, c.event_ns, c.sched_ns);
+
+    for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        printf("%lu events/s\n", rates[i]);
+
+        simulate(&r, MODE_IRQ, 0, rates[i], events, &c);
+        report("irq imod=0", &r, events);
+        simulate(&r, MODE_IRQ, 40000, rates[i], events, &c);
+        report("irq imod=40", &r, events);
+        simulate(&r, MODE_POLL, 40000, rates[i], events, &c);
+        report("poll cap=40", &r, events);
+        simulate(&r, MODE_POLL, 125000, rates[i], events, &c);
+        report("poll cap=125", &r, events);
+        simulate(&r, MODE_POLL, 250000, rates[i], events, &c);
+        report("poll cap=250", &r, events);
+    }
+
+    return 0;
+}
+
+/*
+ * 執行結果 (預設參數)：
+ *
+ *   500000 events per run, irq 1500 ns, event 800 ns, softirq 1000 ns
+ *   1000 events/s
+ *     irq imod=0   irq/s     999  ev/irq    1.0  cpu   0.2%  max hardirq    3.1 us  lat avg    2.3 p99     3 us  imod   0 us
+ *     irq imod=40  irq/s     999  ev/irq    1.0  cpu   0.2%  max hardirq    3.9 us  lat avg    3.0 p99    30 us  imod  40 us
+ *     poll cap=40  irq/s     998  ev/irq    1.0  cpu   0.3%  max hardirq    1.5 us  lat avg    3.3 p99     4 us  imod   0 us
+ *     poll cap=125 irq/s     998  ev/irq    1.0  cpu   0.3%  max hardirq    1.5 us  lat avg    3.3 p99     4 us  imod   0 us
+ *     poll cap=250 irq/s     998  ev/irq    1.0  cpu   0.3%  max hardirq    1.5 us  lat avg    3.3 p99     4 us  imod   0 us
+ *   8000 events/s
+ *     irq imod=0   irq/s    7867  ev/irq    1.0  cpu   1.8%  max hardirq    3.9 us  lat avg    2.3 p99     3 us  imod   0 us
+ *     irq imod=40  irq/s    7562  ev/irq    1.1  cpu   1.8%  max hardirq    5.5 us  lat avg    7.7 p99    39 us  imod  40 us
+ *     poll cap=40  irq/s    7806  ev/irq    1.0  cpu   2.6%  max hardirq    1.5 us  lat avg    3.3 p99     4 us  imod   0 us
+ *     poll cap=125 irq/s    7806  ev/irq    1.0  cpu   2.6%  max hardirq    1.5 us  lat avg    3.3 p99     4 us  imod   0 us
+ *     poll cap=250 irq/s    7806  ev/irq    1.0  cpu   2.6%  max hardirq    1.5 us  lat avg    3.3 p99     4 us  imod   0 us
+ *   32000 events/s
+ *     irq imod=0   irq/s   29791  ev/irq    1.1  cpu   7.0%  max hardirq    5.5 us  lat avg    2.3 p99     3 us  imod   0 us
+ *     irq imod=40  irq/s   20213  ev/irq    1.6  cpu   5.6%  max hardirq    8.7 us  lat avg   16.7 p99    40 us  imod  40 us
+ *     poll cap=40  irq/s   20090  ev/irq    1.6  cpu   7.6%  max hardirq    1.5 us  lat avg   16.8 p99    40 us  imod  40 us
+ *     poll cap=125 irq/s   20090  ev/irq    1.6  cpu   7.6%  max hardirq    1.5 us  lat avg   16.8 p99    40 us  imod  40 us
+ *     poll cap=250 irq/s   20090  ev/irq    1.6  cpu   7.6%  max hardirq    1.5 us  lat avg   16.8 p99    40 us  imod  40 us
+ *   100000 events/s
+ *     irq imod=0   irq/s   80110  ev/irq    1.3  cpu  20.0%  max hardirq    8.7 us  lat avg    2.2 p99     4 us  imod   0 us
+ *     irq imod=40  irq/s   24823  ev/irq    4.0  cpu  11.7%  max hardirq   15.9 us  lat avg   19.1 p99    39 us  imod  40 us
+ *     poll cap=40  irq/s   24843  ev/irq    4.0  cpu  14.2%  max hardirq    1.5 us  lat avg   19.1 p99    39 us  imod  40 us
+ *     poll cap=125 irq/s    8079  ev/irq   12.4  cpu  10.0%  max hardirq    1.5 us  lat avg   58.4 p99   116 us  imod 125 us
+ *     poll cap=250 irq/s    8079  ev/irq   12.4  cpu  10.0%  max hardirq    1.5 us  lat avg   58.4 p99   116 us  imod 125 us
+ *   250000 events/s
+ *     irq imod=0   irq/s  145559  ev/irq    1.7  cpu  41.9%  max hardirq   12.7 us  lat avg    2.2 p99     4 us  imod   0 us
+ *     irq imod=40  irq/s   25000  ev/irq   10.0  cpu  23.8%  max hardirq   28.7 us  lat avg   17.0 p99    36 us  imod  40 us
+ *     poll cap=40  irq/s   25195  ev/irq    9.9  cpu  26.3%  max hardirq    1.5 us  lat avg   17.0 p99    36 us  imod  40 us
+ *     poll cap=125 irq/s    8231  ev/irq   30.4  cpu  22.1%  max hardirq    1.5 us  lat avg   50.8 p99   104 us  imod 125 us
+ *     poll cap=250 irq/s    4239  ev/irq   59.1  cpu  21.2%  max hardirq    1.5 us  lat avg  100.7 p99   204 us  imod 250 us
+ *
+ * - 8000 events/s 以下 (單一 high-speed interrupt 端點的上限) 維持 IMOD 0，
+ *   p99 延遲 4us，比固定 40us 的 p99 39us 低；代價是 softirq 多一次
+ *   排程 (平均多約 1us)。softirq 排程成本拉高到 3us 時，1000 events/s
+ *   的平均延遲是 5.3us，p99 6us。
+ * - 32000 events/s 回到預設的 40us，中斷數與延遲都和固定 40us 相同。
+ * - 預設上限 40us 時，100000 events/s 以上的中斷數與延遲和固定 40us
+ *   相同，好處只剩 hard-IRQ 停留時間。
+ * - 開啟高等級後中斷數降為固定 40us 的 1/3 到 1/6，延遲換成一個 IMOD
+ *   間隔的量級。有 HS 1-microframe interrupt 端點時停在 125us，p99
+ *   104-116us 仍在一個服務間隔內；沒有 interrupt 端點才會到 250us，
+ *   p99 204us。
+ * - hard-IRQ 停留時間固定為清 IP、關 IE 的成本，不再隨 event 數成長。
+ */